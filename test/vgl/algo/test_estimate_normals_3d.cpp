@@ -0,0 +1,122 @@
+// Test vgl_estimate_normals_3d
+#include <iostream>
+#include <vector>
+#include <random>
+#include <cmath>
+#include <vgl/algo/vgl_estimate_normals_3d.h>
+#include <vgl/vgl_pointset_3d.h>
+
+#include <gtest/gtest.h>
+
+// n points on the sphere of radius r about c, without normals
+static vgl_pointset_3d<double> make_sphere(unsigned n, vgl_point_3d<double> const& c, double r, double noise)
+{
+  std::mt19937 rng(3);
+  std::uniform_real_distribution<double> u(0.0, 1.0);
+  std::normal_distribution<double> g(0.0, noise > 0.0 ? noise : 1.0);
+  const double pi = 3.14159265358979323846;
+  std::vector<vgl_point_3d<double> > pts;
+  for (unsigned i = 0; i < n; ++i) {
+    const double z = 2 * u(rng) - 1, a = 2 * pi * u(rng), s = std::sqrt(1 - z * z);
+    const vgl_vector_3d<double> d(s * std::cos(a), s * std::sin(a), z);
+    pts.push_back(c + (r + (noise > 0.0 ? g(rng) : 0.0)) * d);
+  }
+  return vgl_pointset_3d<double>(pts);
+}
+
+TEST(vgl_estimate_normals_3d, sphere)
+{
+  const vgl_point_3d<double> c(1, 2, 3);
+  vgl_pointset_3d<double> ptset = make_sphere(5000, c, 2.0, 0.0);
+  std::vector<double> variation;
+  EXPECT_EQ(0u, vgl_estimate_normals(ptset, 12, 0.0, 0, &variation));
+  ASSERT_TRUE(ptset.has_normals());
+  for (unsigned i = 0; i < ptset.size(); ++i) {
+    EXPECT_NEAR(1.0, length(ptset.n(i)), 1e-9);
+    EXPECT_GT(std::fabs(dot_product(ptset.n(i), normalized(ptset.p(i) - c))), 0.99);
+    EXPECT_LT(variation[i], 0.02);
+  }
+  // seen from the centre, all normals point inwards
+  vgl_orient_normals(ptset, c);
+  for (unsigned i = 0; i < ptset.size(); ++i)
+    EXPECT_LT(dot_product(ptset.n(i), ptset.p(i) - c), 0.0);
+}
+
+TEST(vgl_estimate_normals_3d, orient_mst)
+{
+  const vgl_point_3d<double> c(0, 0, 0);
+  vgl_pointset_3d<double> ptset = make_sphere(5000, c, 1.0, 0.002);
+  vgl_estimate_normals(ptset, 10);
+  EXPECT_EQ(1u, vgl_orient_normals_mst(ptset, 8));
+  // the top is rooted upwards, so all normals point outwards
+  unsigned outward = 0;
+  for (unsigned i = 0; i < ptset.size(); ++i)
+    if (dot_product(ptset.n(i), ptset.p(i) - c) > 0.0)
+      ++outward;
+  EXPECT_EQ(ptset.size(), outward);
+
+  // two far apart spheres are two components
+  vgl_pointset_3d<double> other = make_sphere(1000, vgl_point_3d<double>(10, 0, 0), 1.0, 0.0);
+  std::vector<vgl_point_3d<double> > pts = ptset.points();
+  pts.insert(pts.end(), other.points().begin(), other.points().end());
+  vgl_pointset_3d<double> both(pts);
+  vgl_estimate_normals(both, 10);
+  EXPECT_EQ(2u, vgl_orient_normals_mst(both, 8));
+}
+
+TEST(vgl_estimate_normals_3d, plane_radius)
+{
+  std::mt19937 rng(5);
+  std::uniform_real_distribution<double> u(0.0, 10.0);
+  std::vector<vgl_point_3d<double> > pts;
+  for (unsigned i = 0; i < 3000; ++i)
+    pts.push_back(vgl_point_3d<double>(u(rng), u(rng), 4.0));
+  pts.push_back(vgl_point_3d<double>(100, 100, 100)); // isolated
+  vgl_pointset_3d<double> ptset(pts);
+  std::vector<double> variation;
+  EXPECT_EQ(1u, vgl_estimate_normals(ptset, 0, 0.5, 0, &variation));
+  for (unsigned i = 0; i < 3000; ++i) {
+    EXPECT_NEAR(1.0, std::fabs(ptset.n(i).z()), 1e-9);
+    EXPECT_NEAR(0.0, variation[i], 1e-12);
+  }
+  EXPECT_EQ(0.0, length(ptset.n(3000)));
+  // at most k of the neighbours in the radius
+  EXPECT_EQ(1u, vgl_estimate_normals(ptset, 6, 0.5));
+  for (unsigned i = 0; i < 3000; ++i)
+    EXPECT_NEAR(1.0, std::fabs(ptset.n(i).z()), 1e-9);
+}
+
+TEST(vgl_estimate_normals_3d, old_normals)
+{
+  // normals there before are replaced, with zero where none can be estimated
+  std::mt19937 rng(6);
+  std::uniform_real_distribution<double> u(0.0, 10.0);
+  std::vector<vgl_point_3d<double> > pts;
+  for (unsigned i = 0; i < 1000; ++i)
+    pts.push_back(vgl_point_3d<double>(u(rng), u(rng), 4.0));
+  pts.push_back(vgl_point_3d<double>(100, 100, 100)); // isolated
+  for (unsigned i = 0; i < 3; ++i)
+    pts.push_back(vgl_point_3d<double>(-50, 0, 0));   // coincident
+  std::vector<vgl_vector_3d<double> > normals(pts.size(), vgl_vector_3d<double>(1, 0, 0));
+  vgl_pointset_3d<double> ptset(pts, normals);
+  EXPECT_EQ(4u, vgl_estimate_normals(ptset, 0, 1.0));
+  for (unsigned i = 0; i < 1000; ++i)
+    EXPECT_NEAR(1.0, std::fabs(ptset.n(i).z()), 1e-9);
+  for (unsigned i = 1000; i < 1004; ++i)
+    EXPECT_EQ(0.0, length(ptset.n(i)));
+}
+
+TEST(vgl_estimate_normals_3d, threads)
+{
+  vgl_pointset_3d<double> a = make_sphere(40000, vgl_point_3d<double>(0, 0, 0), 1.0, 0.01);
+  vgl_pointset_3d<double> b = a;
+  std::vector<double> va, vb;
+  vgl_estimate_normals(a, 10, 0.0, 1, &va);
+  vgl_estimate_normals(b, 10, 0.0, 4, &vb);
+  vgl_orient_normals(a, vgl_point_3d<double>(0, 0, 0), 1);
+  vgl_orient_normals(b, vgl_point_3d<double>(0, 0, 0), 4);
+  for (unsigned i = 0; i < a.size(); ++i) {
+    EXPECT_EQ(a.n(i), b.n(i));
+    EXPECT_EQ(va[i], vb[i]);
+  }
+}
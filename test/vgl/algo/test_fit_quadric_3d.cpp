@@ -0,0 +1,98 @@
+// Test vgl_fit_quadric_3d
+#include <iostream>
+#include <sstream>
+#include <random>
+#include <cmath>
+#include <vgl/algo/vgl_fit_quadric_3d.h>
+#include <vgl/vgl_pointset_3d_soa.h>
+
+#include <gtest/gtest.h>
+
+// the coefficients of q scaled to unit norm, with a positive x^2 term
+static std::vector<double> normalized(vgl_quadric_3d<double> const& q)
+{
+  std::vector<double> c = { q.a(), q.b(), q.c(), q.d(), q.e(), q.f(), q.g(), q.h(), q.i(), q.j() };
+  double s = 0.0;
+  for (double v : c)
+    s += v * v;
+  s = std::sqrt(s);
+  if (c[0] < 0)
+    s = -s;
+  for (double& v : c)
+    v /= s;
+  return c;
+}
+
+TEST(fit_quadric_3d, ellipsoid)
+{
+  // an ellipsoid with semi-axes 3, 2, 1, rotated about z and centered far from the origin
+  const double cx = 100.0, cy = -50.0, cz = 20.0, th = 0.4;
+  const double ct = std::cos(th), st = std::sin(th);
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<double> u(0.0, 6.28318530717958648);
+  vgl_pointset_3d_soa<double> pts;
+  vgl_fit_quadric_3d<double> fit, half0, half1;
+  for (unsigned i = 0; i < 2000; ++i) {
+    const double a = u(rng), b = u(rng) / 2;
+    const double ex = 3 * std::cos(a) * std::sin(b), ey = 2 * std::sin(a) * std::sin(b), ez = std::cos(b);
+    vgl_point_3d<double> p(cx + ct * ex - st * ey, cy + st * ex + ct * ey, cz + ez);
+    pts.add_point(p);
+    fit.add_point(p);
+    (i % 2 ? half1 : half0).add_point(p);
+  }
+  EXPECT_EQ(fit.size(), 2000u);
+  EXPECT_NEAR(fit.fit_linear_algebraic(), 0.0, 1e-6);
+  vgl_quadric_3d<double> q = fit.quadric_fit();
+  EXPECT_EQ(q.type(), vgl_quadric_3d<double>::real_ellipsoid);
+  vgl_point_3d<double> c;
+  ASSERT_TRUE(q.center(c));
+  EXPECT_NEAR(c.x(), cx, 1e-6);
+  EXPECT_NEAR(c.y(), cy, 1e-6);
+  EXPECT_NEAR(c.z(), cz, 1e-6);
+  std::vector<double> dist;
+  q.sampson_dist(pts, dist);
+  for (double d : dist)
+    EXPECT_NEAR(d, 0.0, 1e-6);
+
+  // the batch interface and merged accumulators give the same quadric
+  vgl_fit_quadric_3d<double> batch;
+  batch.add_points(pts);
+  half0.add(half1);
+  EXPECT_EQ(half0.size(), 2000u);
+  batch.fit_linear_algebraic();
+  half0.fit_linear_algebraic();
+  std::vector<double> n0 = normalized(q), n1 = normalized(batch.quadric_fit()), n2 = normalized(half0.quadric_fit());
+  for (unsigned k = 0; k < 10; ++k) {
+    EXPECT_NEAR(n1[k], n0[k], 1e-9);
+    EXPECT_NEAR(n2[k], n0[k], 1e-9);
+  }
+}
+
+TEST(fit_quadric_3d, noise_and_failure)
+{
+  // a noisy cylinder x^2 + y^2 = 4 along z
+  std::mt19937 rng(2);
+  std::uniform_real_distribution<double> u(0.0, 6.28318530717958648), h(-5.0, 5.0);
+  std::normal_distribution<double> noise(0.0, 0.01);
+  vgl_fit_quadric_3d<float> fit;
+  for (unsigned i = 0; i < 5000; ++i) {
+    const double a = u(rng), r = 2.0 + noise(rng);
+    fit.add_point(float(r * std::cos(a)), float(r * std::sin(a)), float(h(rng)));
+  }
+  EXPECT_GT(fit.fit_linear_algebraic(), 0.0f);
+  vgl_quadric_3d<float> q = fit.quadric_fit();
+  EXPECT_NEAR(q.b() / q.a(), 1.0f, 0.02f);
+  EXPECT_NEAR(q.j() / q.a(), -4.0f, 0.05f);
+  EXPECT_NEAR(q.c() / q.a(), 0.0f, 0.02f);
+
+  std::stringstream ss;
+  vgl_fit_quadric_3d<double> few;
+  for (unsigned i = 0; i < 8; ++i)
+    few.add_point(double(i), 0.0, 1.0);
+  EXPECT_EQ(few.fit_linear_algebraic(&ss), -1.0);
+  EXPECT_FALSE(ss.str().empty());
+  few.clear();
+  for (unsigned i = 0; i < 10; ++i)
+    few.add_point(1.0, 2.0, 3.0);
+  EXPECT_EQ(few.fit_linear_algebraic(), -1.0);
+}
@@ -0,0 +1,118 @@
+// Test vgl_icp_3d
+#include <iostream>
+#include <vector>
+#include <random>
+#include <cmath>
+#include <vgl/algo/vgl_icp_3d.h>
+#include <vgl/algo/vgl_rotation_3d.h>
+#include <vgl/vgl_pointset_3d.h>
+
+#include <gtest/gtest.h>
+
+// a wavy surface z = sin(x) cos(y) over [-3,3]^2
+static vgl_pointset_3d<double> make_surface(unsigned n, unsigned seed)
+{
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> u(-3.0, 3.0);
+  std::vector<vgl_point_3d<double> > pts;
+  for (unsigned i = 0; i < n; ++i) {
+    const double x = u(rng), y = u(rng);
+    pts.push_back(vgl_point_3d<double>(x, y, std::sin(x) * std::cos(y)));
+  }
+  return vgl_pointset_3d<double>(pts);
+}
+
+// the known motion used to displace the source
+static vgl_h_matrix_3d<double> motion()
+{
+  vgl_rotation_3d<double> R(0.08, -0.05, 0.1);
+  vgl_h_matrix_3d<double> H = R.as_h_matrix_3d();
+  H.set_translation(0.2, -0.15, 0.1);
+  return H;
+}
+
+static double transform_error(vgl_h_matrix_3d<double> const& A, vgl_h_matrix_3d<double> const& B)
+{
+  double e = 0.0;
+  for (unsigned r = 0; r < 3; ++r)
+    for (unsigned c = 0; c < 4; ++c)
+      e = std::max(e, std::fabs(A.get(r, c) - B.get(r, c)));
+  return e;
+}
+
+TEST(vgl_icp_3d, point_to_point)
+{
+  vgl_pointset_3d<double> target = make_surface(20000, 1);
+  vgl_h_matrix_3d<double> H = motion();
+  // the source is the target moved by the inverse motion, so registering it recovers H
+  vgl_pointset_3d<double> source = H.get_inverse()(target);
+  vgl_icp_3d<double> icp(target);
+  icp.set_max_iterations(200);
+  ASSERT_TRUE(icp.register_points(source));
+  EXPECT_TRUE(icp.converged());
+  EXPECT_LT(transform_error(icp.transform(), H), 1e-4);
+  EXPECT_LT(icp.rms_error(), 1e-4);
+  EXPECT_EQ(source.size(), icp.n_pairs());
+  EXPECT_LT(std::fabs(icp.rotation().angle() - vgl_rotation_3d<double>(0.08, -0.05, 0.1).angle()), 1e-4);
+  EXPECT_NEAR(0.2, icp.translation().x(), 1e-4);
+}
+
+TEST(vgl_icp_3d, point_to_plane)
+{
+  // different samples of the same surface, so no exact point pairs exist
+  vgl_pointset_3d<double> target = make_surface(20000, 1);
+  vgl_h_matrix_3d<double> H = motion();
+  vgl_pointset_3d<double> source = H.get_inverse()(make_surface(5000, 2));
+  vgl_icp_3d<double> icp(target);
+  icp.set_metric(vgl_icp_3d<double>::point_to_plane);
+  ASSERT_TRUE(icp.register_points(source));
+  EXPECT_TRUE(icp.target().has_normals());
+  EXPECT_LT(transform_error(icp.transform(), H), 5e-3);
+  EXPECT_LT(icp.rms_error(), 1e-3);
+  // far fewer iterations than point to point on the same data
+  vgl_icp_3d<double> p2p(target);
+  p2p.register_points(source);
+  EXPECT_LT(icp.iterations(), p2p.iterations());
+}
+
+TEST(vgl_icp_3d, coarse_to_fine_and_trimming)
+{
+  vgl_pointset_3d<double> target = make_surface(20000, 1);
+  vgl_h_matrix_3d<double> H = motion();
+  // a source covering only part of the target, with outliers
+  std::vector<vgl_point_3d<double> > pts;
+  vgl_pointset_3d<double> surface = make_surface(8000, 3);
+  std::vector<vgl_point_3d<double> > const& all = surface.points();
+  for (unsigned i = 0; i < all.size(); ++i)
+    if (all[i].x() < 1.0)
+      pts.push_back(all[i]);
+  std::mt19937 rng(4);
+  std::uniform_real_distribution<double> u(-3.0, 3.0);
+  for (unsigned i = 0; i < 300; ++i)
+    pts.push_back(vgl_point_3d<double>(u(rng), u(rng), 2.0 + u(rng)));
+  vgl_pointset_3d<double> source = H.get_inverse()(vgl_pointset_3d<double>(pts));
+
+  vgl_icp_3d<double> icp(target);
+  icp.set_metric(vgl_icp_3d<double>::point_to_plane);
+  icp.set_levels(3);
+  icp.set_trim_fraction(0.9);
+  icp.set_rejection_sigma(3.0);
+  ASSERT_TRUE(icp.register_points(source));
+  EXPECT_LT(transform_error(icp.transform(), H), 5e-3);
+  std::vector<vgl_icp_3d<double>::iteration_stats> const& s = icp.statistics();
+  ASSERT_FALSE(s.empty());
+  EXPECT_EQ(2u, s.front().level);
+  EXPECT_EQ(0u, s.back().level);
+  EXPECT_LT(s.front().n_source, s.back().n_source);
+  // the outliers are rejected
+  EXPECT_LT(icp.n_pairs(), source.size() - 300);
+}
+
+TEST(vgl_icp_3d, max_distance)
+{
+  vgl_pointset_3d<double> target = make_surface(2000, 1);
+  std::vector<vgl_point_3d<double> > far(10, vgl_point_3d<double>(100, 100, 100));
+  vgl_icp_3d<double> icp(target);
+  icp.set_max_distance(1.0);
+  EXPECT_FALSE(icp.register_points(vgl_pointset_3d<double>(far)));
+}
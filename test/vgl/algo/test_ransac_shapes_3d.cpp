@@ -0,0 +1,158 @@
+// Test vgl_ransac_shapes_3d
+#include <iostream>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include <vgl/algo/vgl_ransac_shapes_3d.h>
+#include <vgl/vgl_pointset_3d.h>
+
+#include <gtest/gtest.h>
+
+// a plane patch, a sphere and a cylinder with small noise, then uniform outliers;
+// first[s] is the index of the first point of shape s
+static vgl_pointset_3d<double> make_scene(bool normals, unsigned first[4])
+{
+  std::mt19937 rng(7);
+  std::uniform_real_distribution<double> u(0.0, 1.0);
+  std::normal_distribution<double> noise(0.0, 0.005);
+  const double pi = 3.14159265358979323846;
+  std::vector<vgl_point_3d<double> > pts;
+  std::vector<vgl_vector_3d<double> > nrm;
+  // z = 0.5 x + 1 over [0,10]^2
+  first[0] = 0;
+  const vgl_vector_3d<double> pn = normalized(vgl_vector_3d<double>(-0.5, 0.0, 1.0));
+  for (unsigned i = 0; i < 4000; ++i) {
+    const double x = 10 * u(rng), y = 10 * u(rng);
+    pts.push_back(vgl_point_3d<double>(x, y, 0.5 * x + 1) + noise(rng) * pn);
+    nrm.push_back(pn);
+  }
+  // sphere of radius 2 about (5, 5, 10)
+  first[1] = unsigned(pts.size());
+  for (unsigned i = 0; i < 3000; ++i) {
+    const double z = 2 * u(rng) - 1, a = 2 * pi * u(rng), r = std::sqrt(1 - z * z);
+    vgl_vector_3d<double> n(r * std::cos(a), r * std::sin(a), z);
+    pts.push_back(vgl_point_3d<double>(5, 5, 10) + (2 + noise(rng)) * n);
+    nrm.push_back(-n);
+  }
+  // cylinder of radius 1.5 and length 8 about the line through (15, 5, 4) along y
+  first[2] = unsigned(pts.size());
+  for (unsigned i = 0; i < 3000; ++i) {
+    const double a = 2 * pi * u(rng), y = 1 + 8 * u(rng);
+    vgl_vector_3d<double> n(std::cos(a), 0.0, std::sin(a));
+    pts.push_back(vgl_point_3d<double>(15, y, 4) + (1.5 + noise(rng)) * n);
+    nrm.push_back(n);
+  }
+  first[3] = unsigned(pts.size());
+  for (unsigned i = 0; i < 500; ++i) {
+    pts.push_back(vgl_point_3d<double>(20 * u(rng), 10 * u(rng), 14 * u(rng)));
+    nrm.push_back(normalized(vgl_vector_3d<double>(u(rng) - 0.5, u(rng) - 0.5, u(rng) - 0.5)));
+  }
+  return normals ? vgl_pointset_3d<double>(pts, nrm) : vgl_pointset_3d<double>(pts);
+}
+
+// the number of inliers that belong to shape s
+static unsigned overlap(std::vector<unsigned> const& inliers, unsigned const first[4], unsigned s)
+{
+  unsigned n = 0;
+  for (std::size_t i = 0; i < inliers.size(); ++i)
+    n += inliers[i] >= first[s] && inliers[i] < first[s + 1];
+  return n;
+}
+
+TEST(ransac_shapes_3d, with_normals)
+{
+  unsigned first[4];
+  vgl_pointset_3d<double> ptset = make_scene(true, first);
+  vgl_ransac_shapes_3d<double> ransac(ptset);
+  ransac.set_epsilon(0.05);
+  ransac.set_min_support(500);
+  EXPECT_TRUE(ransac.has_normals());
+  EXPECT_EQ(ransac.detect(), 3u);
+  ASSERT_EQ(ransac.shapes().size(), 3u);
+  bool seen[3] = { false, false, false };
+  for (unsigned k = 0; k < 3; ++k) {
+    vgl_ransac_shapes_3d<double>::shape const& s = ransac.shapes()[k];
+    const unsigned which = s.type == vgl_ransac_shapes_3d<double>::plane ? 0 : s.type == vgl_ransac_shapes_3d<double>::sphere ? 1 : 2;
+    EXPECT_FALSE(seen[which]);
+    seen[which] = true;
+    // nearly all the points of the shape, and few others
+    const unsigned mine = overlap(s.inliers, first, which);
+    EXPECT_GE(mine, (first[which + 1] - first[which]) * 98 / 100);
+    EXPECT_LE(s.inliers.size() - mine, 30u);
+    for (std::size_t i = 0; i < s.inliers.size(); ++i)
+      EXPECT_LT(vgl_ransac_shapes_3d<double>::distance(s, ptset.p(s.inliers[i])), 0.05);
+    if (which == 0) {
+      vgl_vector_3d<double> n = normalized(s.plane.normal());
+      EXPECT_NEAR(std::fabs(dot_product(n, normalized(vgl_vector_3d<double>(-0.5, 0.0, 1.0)))), 1.0, 1e-5);
+      EXPECT_NEAR(-s.plane.d() / s.plane.c(), 1.0, 1e-3);
+    }
+    else if (which == 1) {
+      EXPECT_NEAR((s.sphere.centre() - vgl_point_3d<double>(5, 5, 10)).length(), 0.0, 2e-3);
+      EXPECT_NEAR(s.sphere.radius(), 2.0, 2e-3);
+    }
+    else {
+      EXPECT_NEAR(std::fabs(normalized(s.cylinder.orientation()).y()), 1.0, 1e-5);
+      EXPECT_NEAR(s.cylinder.center().x(), 15.0, 2e-3);
+      EXPECT_NEAR(s.cylinder.center().y(), 5.0, 0.05);
+      EXPECT_NEAR(s.cylinder.center().z(), 4.0, 2e-3);
+      EXPECT_NEAR(s.cylinder.radius(), 1.5, 2e-3);
+      EXPECT_NEAR(s.cylinder.length(), 8.0, 0.1);
+    }
+  }
+  // every point is in at most one shape, or left unassigned
+  std::vector<unsigned> all, rest;
+  ransac.unassigned(rest);
+  all = rest;
+  for (unsigned k = 0; k < 3; ++k)
+    all.insert(all.end(), ransac.shapes()[k].inliers.begin(), ransac.shapes()[k].inliers.end());
+  std::sort(all.begin(), all.end());
+  ASSERT_EQ(all.size(), ptset.size());
+  for (unsigned i = 0; i < all.size(); ++i)
+    EXPECT_EQ(all[i], i);
+
+  // the result does not depend on the number of threads
+  vgl_ransac_shapes_3d<double> serial(ptset, 1);
+  serial.set_epsilon(0.05);
+  serial.set_min_support(500);
+  serial.detect();
+  ASSERT_EQ(serial.shapes().size(), 3u);
+  for (unsigned k = 0; k < 3; ++k)
+    EXPECT_EQ(serial.shapes()[k].inliers, ransac.shapes()[k].inliers);
+}
+
+TEST(ransac_shapes_3d, without_normals)
+{
+  unsigned first[4];
+  vgl_pointset_3d<double> ptset = make_scene(false, first);
+  vgl_ransac_shapes_3d<double> ransac(ptset);
+  ransac.set_epsilon(0.03);
+  ransac.set_min_support(1500);
+  EXPECT_FALSE(ransac.has_normals());
+  ransac.detect();
+  // no cylinders without normals: the plane and the sphere
+  ASSERT_EQ(ransac.shapes().size(), 2u);
+  for (unsigned k = 0; k < 2; ++k) {
+    vgl_ransac_shapes_3d<double>::shape const& s = ransac.shapes()[k];
+    ASSERT_NE(s.type, vgl_ransac_shapes_3d<double>::cylinder);
+    const unsigned which = s.type == vgl_ransac_shapes_3d<double>::plane ? 0 : 1;
+    EXPECT_GE(overlap(s.inliers, first, which), (first[which + 1] - first[which]) * 98 / 100);
+    if (which == 1) {
+      EXPECT_NEAR(s.sphere.radius(), 2.0, 2e-3);
+    }
+  }
+  EXPECT_NE(ransac.shapes()[0].type, ransac.shapes()[1].type);
+
+  // only planes
+  vgl_ransac_shapes_3d<double> planes(ptset);
+  planes.set_epsilon(0.03);
+  planes.set_min_support(1500);
+  planes.set_shape_types(vgl_ransac_shapes_3d<double>::plane);
+  planes.detect();
+  ASSERT_EQ(planes.shapes().size(), 1u);
+  EXPECT_EQ(planes.shapes()[0].type, vgl_ransac_shapes_3d<double>::plane);
+
+  // an empty set
+  vgl_ransac_shapes_3d<double> none((vgl_pointset_3d<double>()));
+  EXPECT_EQ(none.detect(), 0u);
+}
@@ -0,0 +1,161 @@
+// Some tests for vgl_box_rtree
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <vgl/vgl_box_2d.h>
+#include <vgl/vgl_box_3d.h>
+#include <vgl/vgl_intersection.h>
+#include <vgl/vgl_box_rtree.h>
+
+#include <gtest/gtest.h>
+
+static std::vector<vgl_box_2d<double> > random_boxes_2d(unsigned n, unsigned seed)
+{
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> u(0.0, 100.0), s(0.0, 3.0);
+  std::vector<vgl_box_2d<double> > boxes;
+  for (unsigned i = 0; i < n; ++i) {
+    double x = u(rng), y = u(rng);
+    boxes.push_back(vgl_box_2d<double>(x, x + s(rng), y, y + s(rng)));
+  }
+  return boxes;
+}
+
+static double dist2(vgl_box_2d<double> const& b, vgl_point_2d<double> const& p)
+{
+  double dx = std::max(0.0, std::max(b.min_x() - p.x(), p.x() - b.max_x()));
+  double dy = std::max(0.0, std::max(b.min_y() - p.y(), p.y() - b.max_y()));
+  return dx * dx + dy * dy;
+}
+
+TEST(box_rtree, queries_2d)
+{
+  std::vector<vgl_box_2d<double> > boxes = random_boxes_2d(5000, 1);
+  boxes[17] = vgl_box_2d<double>(); // an empty box is not indexed
+  vgl_box_rtree_2d<double> tree(boxes, 8);
+  EXPECT_EQ(tree.size(), boxes.size() - 1);
+
+  std::mt19937 rng(2);
+  std::uniform_real_distribution<double> u(-5.0, 105.0);
+  std::vector<unsigned> found;
+  for (unsigned q = 0; q < 200; ++q) {
+    double x = u(rng), y = u(rng);
+    vgl_box_2d<double> window(x, x + 4, y, y + 2);
+    tree.query(window, found);
+    std::sort(found.begin(), found.end());
+    std::vector<unsigned> expected;
+    for (unsigned i = 0; i < boxes.size(); ++i)
+      if (!boxes[i].is_empty() && !vgl_intersection(boxes[i], window).is_empty())
+        expected.push_back(i);
+    EXPECT_EQ(found, expected);
+
+    vgl_point_2d<double> p(x, y);
+    tree.query(p, found);
+    std::sort(found.begin(), found.end());
+    expected.clear();
+    for (unsigned i = 0; i < boxes.size(); ++i)
+      if (boxes[i].contains(p))
+        expected.push_back(i);
+    EXPECT_EQ(found, expected);
+
+    double d2;
+    int nn = tree.nearest(p, &d2);
+    ASSERT_GE(nn, 0);
+    double best = 1e300;
+    for (unsigned i = 0; i < boxes.size(); ++i)
+      if (!boxes[i].is_empty())
+        best = std::min(best, dist2(boxes[i], p));
+    EXPECT_EQ(d2, best);
+    EXPECT_EQ(dist2(boxes[nn], p), best);
+
+    std::vector<double> kd2;
+    EXPECT_EQ(tree.k_nearest(p, 5, found, &kd2), 5u);
+    for (unsigned k = 0; k < 5; ++k) {
+      EXPECT_EQ(kd2[k], dist2(boxes[found[k]], p));
+      if (k > 0) {
+        EXPECT_LE(kd2[k - 1], kd2[k]);
+      }
+    }
+  }
+  EXPECT_TRUE(vgl_box_rtree_2d<double>().nearest(vgl_point_2d<double>(0, 0)) < 0);
+}
+
+TEST(box_rtree, join)
+{
+  std::vector<vgl_box_2d<double> > a = random_boxes_2d(3000, 3), b = random_boxes_2d(2000, 4);
+  vgl_box_rtree_2d<double> ta(a), tb(b, 4);
+  std::vector<std::pair<unsigned, unsigned> > serial, threaded, expected;
+  vgl_box_rtree_join(ta, tb, serial, 1);
+  vgl_box_rtree_join(ta, tb, threaded, 4);
+  EXPECT_EQ(serial, threaded);
+  for (unsigned i = 0; i < a.size(); ++i)
+    for (unsigned j = 0; j < b.size(); ++j)
+      if (!vgl_intersection(a[i], b[j]).is_empty())
+        expected.push_back(std::make_pair(i, j));
+  std::sort(serial.begin(), serial.end());
+  EXPECT_EQ(serial, expected);
+  EXPECT_FALSE(expected.empty());
+}
+
+TEST(box_rtree, boxes_3d)
+{
+  std::mt19937 rng(5);
+  std::uniform_real_distribution<double> u(0.0, 20.0), s(0.0, 2.0);
+  std::vector<vgl_box_3d<float> > boxes;
+  for (unsigned i = 0; i < 2000; ++i) {
+    float x = float(u(rng)), y = float(u(rng)), z = float(u(rng));
+    boxes.push_back(vgl_box_3d<float>(x, y, z, x + float(s(rng)), y + float(s(rng)), z + float(s(rng))));
+  }
+  vgl_box_rtree_3d<float> tree(boxes);
+  vgl_box_3d<float> window(5, 5, 5, 8, 7, 9);
+  std::vector<unsigned> found, expected;
+  tree.query(window, found);
+  std::sort(found.begin(), found.end());
+  for (unsigned i = 0; i < boxes.size(); ++i)
+    if (!vgl_intersection(boxes[i], window).is_empty())
+      expected.push_back(i);
+  EXPECT_EQ(found, expected);
+  vgl_box_3d<float> all = tree.bounds();
+  for (unsigned i = 0; i < boxes.size(); ++i)
+    EXPECT_TRUE(all.contains(boxes[i]));
+}
+
+TEST(box_rtree, write_read_attach)
+{
+  std::vector<vgl_box_2d<double> > boxes = random_boxes_2d(1000, 6);
+  vgl_box_rtree_2d<double> tree(boxes);
+  std::ostringstream os;
+  tree.write(os);
+  const std::string data = os.str();
+
+  std::istringstream is(data);
+  vgl_box_rtree_2d<double> copy;
+  ASSERT_TRUE(copy.read(is));
+  // a tree of another type refuses the data
+  std::istringstream is3(data);
+  vgl_box_rtree_3d<double> other;
+  EXPECT_FALSE(other.read(is3));
+
+  // attach to an aligned copy of the bytes, as if mapped from a file
+  std::vector<double> buffer((data.size() + sizeof(double) - 1) / sizeof(double));
+  std::copy(data.begin(), data.end(), reinterpret_cast<char*>(&buffer[0]));
+  vgl_box_rtree_2d<double> view;
+  ASSERT_TRUE(view.attach(&buffer[0], data.size()));
+  EXPECT_FALSE(view.attach(&buffer[0], data.size() / 2));
+  ASSERT_TRUE(view.attach(&buffer[0], data.size()));
+  vgl_box_rtree_2d<double> view_copy(view);
+
+  vgl_box_2d<double> window(40, 60, 40, 60);
+  std::vector<unsigned> r0, r1, r2, r3;
+  tree.query(window, r0);
+  copy.query(window, r1);
+  view.query(window, r2);
+  view_copy.query(window, r3);
+  EXPECT_FALSE(r0.empty());
+  EXPECT_EQ(r0, r1);
+  EXPECT_EQ(r0, r2);
+  EXPECT_EQ(r0, r3);
+  EXPECT_EQ(view.size(), tree.size());
+}
@@ -1,5 +1,9 @@
 #include <cmath>
+#include <cstdlib>
+#include <vector>
 #include <vgl/vgl_polygon.h>
+#include <vgl/vgl_box_2d.h>
+#include <vgl/vgl_predicates.h>
 #include <vgl/vgl_clip.h>
 
 #include <gtest/gtest.h>
@@ -40,9 +44,7 @@ TEST(vgl_clip, union)
              result.num_sheets() == 2 && result.num_vertices() == 7, true)<<"disjoint union\n";
     }
     
-    #ifdef BUILD_NONCOMMERCIAL
     {
-        // @todo this TEST case failed
         double cont2[] = { 4,1,  8,1,  8,6,  4,6 };
         vgl_polygon<double> poly2(cont2, 4);
         
@@ -51,70 +53,291 @@ TEST(vgl_clip, union)
              result.num_sheets() == 1 && result.num_vertices() == 8 &&
              is_vertex(result, 5.0,1.0) && is_vertex(result, 4.0,6.0), true)<<"overlapping union\n";
     }
-    #endif // BUILD_NONCOMMERCIAL
-    
 }
 
 
 
-/*
+TEST(vgl_clip, intersection)
+{
+    float cont1[] = { 0,0,  5,0,  5,5,  0,5 };
+    vgl_polygon<float> poly1(cont1, 4);
+
+    {
+        vgl_polygon<float> poly2;
+
+        vgl_polygon<float> result = vgl_clip( poly1, poly2, vgl_clip_type_intersect );
+        EXPECT_EQ(
+             result.num_sheets() == 0 && result.num_vertices() == 0, true)<<"intersection with null polygon\n";
+    }
+
+    {
+        float cont2[] = { 6,0,  8,1,  6,2 };
+        vgl_polygon<float> poly2(cont2, 3);
+
+        vgl_polygon<float> result = vgl_clip( poly1, poly2, vgl_clip_type_intersect );
+        EXPECT_EQ(
+             result.num_sheets() == 0 && result.num_vertices() == 0, true)<<"disjoint simple intersection\n";
+    }
+
+    {
+        float cont2[] = { 4,1,  8,1,  8,6,  4,6 };
+        vgl_polygon<float> poly2(cont2, 4);
+
+        vgl_polygon<float> result = vgl_clip( poly1, poly2, vgl_clip_type_intersect );
+        EXPECT_EQ(
+             result.num_sheets() == 1 && result.num_vertices() == 4 &&
+             is_vertex(result, 4.f,1.f) && is_vertex(result, 5.f,5.f), true)<<"overlapping simple intersection\n";
+    }
+
+    {
+        float cont2[] = { -3,-3,  8,-3,  8,8,  -3,8 };
+        float cont3[] = { -1,-1,  6,-1,  6,6,  -1,6 };
+        vgl_polygon<float> poly2(cont2, 4);
+        poly2.add_contour(cont3, 4);
+
+        vgl_polygon<float> result = vgl_clip( poly1, poly2, vgl_clip_type_intersect );
+        EXPECT_EQ(
+             result.num_sheets() == 0 && result.num_vertices() == 0, true)<<"disjoint holey intersection\n";
+    }
+}
 
-static void test_intersection()
+TEST(vgl_clip, difference_and_xor)
 {
-  float cont1[] = { 0,0,  5,0,  5,5,  0,5 };
-  vgl_polygon<float> poly1(cont1, 4);
+    double cont1[] = { 0,0,  5,0,  5,5,  0,5 };
+    double cont2[] = { 1,1,  4,1,  4,4,  1,4 };
+    vgl_polygon<double> poly1(cont1, 4), poly2(cont2, 4);
+
+    // a square with a square hole
+    vgl_polygon<double> result = vgl_clip( poly1, poly2, vgl_clip_type_difference );
+    EXPECT_EQ(result.num_sheets(), 2u);
+    EXPECT_EQ(result.num_vertices(), 8u);
+    EXPECT_FALSE(result.contains(2.5, 2.5));
+    EXPECT_TRUE(result.contains(0.5, 2.5));
+
+    result = vgl_clip( poly2, poly1, vgl_clip_type_difference );
+    EXPECT_EQ(result.num_sheets(), 0u);
+
+    result = vgl_clip( poly1, poly2, vgl_clip_type_xor );
+    EXPECT_EQ(result.num_sheets(), 2u);
+    EXPECT_FALSE(result.contains(2.5, 2.5));
+
+    // squares sharing an edge merge into a rectangle
+    double cont3[] = { 5,0,  9,0,  9,5,  5,5 };
+    vgl_polygon<double> poly3(cont3, 4);
+    result = vgl_clip( poly1, poly3, vgl_clip_type_union );
+    EXPECT_EQ(result.num_sheets(), 1u);
+    EXPECT_EQ(result.num_vertices(), 4u);
+    EXPECT_TRUE(is_vertex(result, 9.0,5.0));
+    result = vgl_clip( poly1, poly3, vgl_clip_type_intersect );
+    EXPECT_EQ(result.num_sheets(), 0u);
+
+    // identical polygons
+    EXPECT_EQ(vgl_clip( poly1, poly1, vgl_clip_type_xor ).num_sheets(), 0u);
+    result = vgl_clip( poly1, poly1, vgl_clip_type_intersect );
+    EXPECT_EQ(result.num_sheets(), 1u);
+    EXPECT_EQ(result.num_vertices(), 4u);
+}
 
+static bool clip_op(vgl_clip_type op, bool in1, bool in2)
+{
+  switch (op)
   {
-    vgl_polygon<float> poly2;
+    case vgl_clip_type_intersect:  return in1 && in2;
+    case vgl_clip_type_union:      return in1 || in2;
+    case vgl_clip_type_difference: return in1 && !in2;
+    default:                       return in1 != in2;
+  }
+}
+
+static double rnd() { return std::rand() / (RAND_MAX + 1.0); }
 
-    vgl_polygon<float> result = vgl_clip( poly1, poly2, vgl_clip_type_intersect );
-    TEST("intersection with null polygon 1",
-         result.num_sheets() == 0 && result.num_vertices() == 0, true);
+// Count the sample points where result disagrees with op applied to poly1 and poly2
+static unsigned mismatches(vgl_polygon<double> const& poly1, vgl_polygon<double> const& poly2,
+                           vgl_clip_type op, std::vector<vgl_point_2d<double> > const& samples)
+{
+  vgl_polygon<double> result = vgl_clip(poly1, poly2, op);
+  unsigned bad = 0;
+  for (auto const& p : samples)
+    if (result.contains(p) != clip_op(op, poly1.contains(p), poly2.contains(p)))
+      ++bad;
+  return bad;
+}
+
+TEST(vgl_clip, random)
+{
+  std::srand(7);
+  const vgl_clip_type ops[] = { vgl_clip_type_intersect, vgl_clip_type_union,
+                                vgl_clip_type_difference, vgl_clip_type_xor };
+  std::vector<vgl_point_2d<double> > samples;
+  for (int i = 0; i < 400; ++i)
+    samples.emplace_back(10 * rnd(), 10 * rnd());
 
-#if 0  //This test is identical to the previous.  Why?
-    vgl_polygon<float> result2 = vgl_clip( poly1, poly2, vgl_clip_type_intersect );
-    TEST("intersection with null polygon 2",
-         result2.num_sheets() == 0 && result2.num_vertices() == 0, true);
-#endif
+  // random, generally self-intersecting, polygons with two sheets
+  for (int trial = 0; trial < 30; ++trial) {
+    vgl_polygon<double> poly[2];
+    for (auto & pl : poly)
+      for (int s = 0; s < 2; ++s) {
+        pl.new_sheet();
+        const int n = 3 + std::rand() % 8;
+        for (int i = 0; i < n; ++i)
+          pl.push_back(10 * rnd(), 10 * rnd());
+      }
+    for (vgl_clip_type op : ops)
+      EXPECT_EQ(mismatches(poly[0], poly[1], op, samples), 0u) << "trial " << trial << " op " << op;
   }
-  {
-    float cont2[] = { 6,0,  8,1,  6,2 };
-    vgl_polygon<float> poly2(cont2, 3);
 
-    vgl_polygon<float> result = vgl_clip( poly1, poly2, vgl_clip_type_intersect );
-    TEST("disjoint simple intersection",
-         result.num_sheets() == 0 && result.num_vertices() == 0, true);
+  // unions of grid cells, with shared and overlapping edges and vertices
+  std::vector<vgl_point_2d<double> > cell_samples;
+  for (int i = 0; i < 10; ++i)
+    for (int j = 0; j < 10; ++j)
+      cell_samples.emplace_back(i + 0.25 + 0.5 * rnd(), j + 0.25 + 0.5 * rnd());
+  for (int trial = 0; trial < 30; ++trial) {
+    vgl_polygon<double> poly[2];
+    for (auto & pl : poly)
+      for (int s = 0; s < 3; ++s) {
+        const double x0 = std::rand() % 8, y0 = std::rand() % 8;
+        const double x1 = x0 + 1 + std::rand() % 3, y1 = y0 + 1 + std::rand() % 3;
+        double c[] = { x0,y0, x1,y0, x1,y1, x0,y1 };
+        pl.add_contour(c, 4);
+      }
+    for (vgl_clip_type op : ops)
+      EXPECT_EQ(mismatches(poly[0], poly[1], op, cell_samples), 0u) << "grid trial " << trial << " op " << op;
   }
+}
 
-#ifdef BUILD_NONCOMMERCIAL
-  {
-    float cont2[] = { 4,1,  8,1,  8,6,  4,6 };
-    vgl_polygon<float> poly2(cont2, 4);
+// Cases where rounded intersection points used to break the subdivision
+TEST(vgl_clip, degenerate)
+{
+  const vgl_clip_type ops[] = { vgl_clip_type_intersect, vgl_clip_type_union,
+                                vgl_clip_type_difference, vgl_clip_type_xor };
+  std::vector<vgl_point_2d<double> > samples;
+  for (int i = 0; i < 100; ++i)
+    for (int j = 0; j < 100; ++j)
+      samples.emplace_back(0.1 * i + 0.0371, 0.1 * j + 0.0583);
 
-    vgl_polygon<float> result = vgl_clip( poly1, poly2, vgl_clip_type_intersect );
-    TEST("overlapping simple intersection",
-         result.num_sheets() == 1 && result.num_vertices() == 4 &&
-         is_vertex(result, 4.f,1.f), true);
-  }
-#endif // BUILD_NONCOMMERCIAL
+  // three edges through (3,5), one of them vertical
+  double a1[] = { 0,9,  6,1,  7,6 }, a2[] = { 3,3,  3,9,  5,2 }, b1[] = { 5,4,  1,6,  0,1 };
+  // a zero-area sheet whose two edges coincide
+  double c1[] = { 0,10,  9,0,  0,10 }, d1[] = { 2,9,  0,7,  1,1 }, d2[] = { 10,4,  1,3,  7,5 };
+  // a vertex on an edge that is split at rounded points
+  double e1[] = { 1.75,6.25,  7,5.5,  2,8.25,  5.75,0,  2.75,9.5 }, e2[] = { 3.5,6,  2.5,4,  5.75,8.25,  8.5,4 },
+         e3[] = { 2.75,9.75,  7,5.5,  0.5,7.25 }, f1[] = { 9,1,  0.25,6.5,  3.75,1.5 };
 
-  {
-    float cont2[] = { -3,-3,  8,-3,  8,8,  -3,8 };
-    float cont3[] = { -1,-1,  6,-1,  6,6,  -1,6 };
-    vgl_polygon<float> poly2(cont2, 4);
-    poly2.add_contour(cont3, 4);
-
-    vgl_polygon<float> result = vgl_clip( poly1, poly2, vgl_clip_type_intersect );
-    TEST("disjoint holey intersection",
-         result.num_sheets() == 0 && result.num_vertices() == 0, true);
+  vgl_polygon<double> a(a1, 3), b(b1, 3), c(c1, 3), d(d1, 3), e(e1, 5), f(f1, 3);
+  a.add_contour(a2, 3);
+  d.add_contour(d2, 3);
+  e.add_contour(e2, 4);
+  e.add_contour(e3, 3);
+  for (vgl_clip_type op : ops) {
+    EXPECT_EQ(mismatches(a, b, op, samples), 0u) << "concurrent edges, op " << op;
+    EXPECT_EQ(mismatches(c, d, op, samples), 0u) << "coincident edges, op " << op;
+    EXPECT_EQ(mismatches(e, f, op, samples), 0u) << "vertex on edge, op " << op;
   }
 }
 
-static void test_clip()
+// Count the sample points where the clip to box disagrees with poly inside the box
+static unsigned box_mismatches(vgl_polygon<double> const& result, vgl_polygon<double> const& poly,
+                               vgl_box_2d<double> const& box, std::vector<vgl_point_2d<double> > const& samples)
 {
-  test_union();
-  test_intersection();
+  unsigned bad = 0;
+  for (auto const& p : samples)
+    if (result.contains(p) != (poly.contains(p) && box.contains(p)))
+      ++bad;
+  return bad;
 }
 
-TESTMAIN(test_clip);
-*/
+TEST(vgl_clip, box)
+{
+  // a U shape whose gap the box cuts across: one piece, running along the box edge under the gap
+  double u[] = { 0,0,  6,0,  6,6,  4,6,  4,2,  2,2,  2,6,  0,6 };
+  vgl_polygon<double> poly(u, 8);
+  vgl_box_2d<double> box(1.0, 5.0, 1.0, 4.0);
+  vgl_polygon<double> result = vgl_clip(poly, box);
+  ASSERT_EQ(result.num_sheets(), 1u);
+  EXPECT_EQ(result[0].size(), 8u);
+  EXPECT_NEAR(vgl_orient_2d(result[0]) / 2, 12.0 - 4.0, 1e-12);
+  EXPECT_TRUE(is_vertex(result, 2.0, 4.0));
+  EXPECT_TRUE(is_vertex(result, 4.0, 2.0));
+
+  // a ring around the box gives the box, with its orientation; a hole around it too gives nothing
+  double big[] = { -1,-1,  -1,9,  9,9,  9,-1 }, bigger[] = { -2,-2,  10,-2,  10,10,  -2,10 };
+  vgl_polygon<double> around(big, 4);
+  result = vgl_clip(around, box);
+  ASSERT_EQ(result.num_sheets(), 1u);
+  EXPECT_EQ(result[0].size(), 4u);
+  EXPECT_NEAR(vgl_orient_2d(result[0]) / 2, -12.0, 1e-12);
+  around.add_contour(bigger, 4);
+  EXPECT_EQ(vgl_clip(around, box).num_sheets(), 0u);
+  // disjoint, and touching the box at an edge
+  double far[] = { 7,7,  8,7,  8,8 }, touch[] = { 5,1,  7,1,  7,4,  5,4 };
+  EXPECT_EQ(vgl_clip(vgl_polygon<double>(far, 3), box).num_sheets(), 0u);
+  EXPECT_EQ(vgl_clip(vgl_polygon<double>(touch, 4), box).num_sheets(), 0u);
+
+  // random, generally self-intersecting, polygons with two sheets, against the even-odd rule
+  std::srand(11);
+  std::vector<vgl_point_2d<double> > samples;
+  for (int i = 0; i < 400; ++i)
+    samples.emplace_back(10 * rnd(), 10 * rnd());
+  for (int trial = 0; trial < 50; ++trial) {
+    vgl_polygon<double> pl;
+    for (int s = 0; s < 2; ++s) {
+      pl.new_sheet();
+      const int n = 3 + std::rand() % 20;
+      for (int i = 0; i < n; ++i)
+        pl.push_back(10 * rnd(), 10 * rnd());
+    }
+    vgl_box_2d<double> b(10 * rnd(), 10 * rnd(), 10 * rnd(), 10 * rnd());
+    EXPECT_EQ(box_mismatches(vgl_clip(pl, b), pl, b, samples), 0u) << "trial " << trial;
+  }
+
+  // integer coordinates, where the crossings are integers too
+  int ix[] = { 0, 8, 8, 0 }, iy[] = { 0, 0, 4, 8 };
+  vgl_polygon<int> ipoly(ix, iy, 4);
+  vgl_polygon<int> iresult = vgl_clip(ipoly, vgl_box_2d<int>(2, 6, 2, 10));
+  ASSERT_EQ(iresult.num_sheets(), 1u);
+  EXPECT_TRUE(is_vertex(iresult, 2, 7));
+  EXPECT_TRUE(is_vertex(iresult, 6, 5));
+}
+
+TEST(vgl_clip, grid)
+{
+  std::srand(13);
+  std::vector<vgl_point_2d<double> > samples;
+  for (int i = 0; i < 2000; ++i)
+    samples.emplace_back(12 * rnd() - 1, 12 * rnd() - 1);
+  vgl_box_2d<double> area(0.5, 9.5, 1.0, 9.0);
+  for (int trial = 0; trial < 20; ++trial) {
+    vgl_polygon<double> pl;
+    for (int s = 0; s < 3; ++s) {
+      pl.new_sheet();
+      const int n = 3 + std::rand() % 30;
+      for (int i = 0; i < n; ++i)
+        pl.push_back(12 * rnd() - 1, 12 * rnd() - 1);
+    }
+    std::vector<vgl_polygon<double> > tiles;
+    vgl_clip_to_grid(pl, area, 7, 5, tiles);
+    ASSERT_EQ(tiles.size(), 35u);
+    for (unsigned j = 0; j < 5; ++j)
+      for (unsigned i = 0; i < 7; ++i) {
+        vgl_box_2d<double> tile(0.5 + 9.0 * i / 7, i == 6 ? 9.5 : 0.5 + 9.0 * (i + 1) / 7,
+                                1.0 + 8.0 * j / 5, j == 4 ? 9.0 : 1.0 + 8.0 * (j + 1) / 5);
+        EXPECT_EQ(box_mismatches(tiles[j * 7 + i], pl, tile, samples), 0u) << "trial " << trial << " tile " << i << ' ' << j;
+      }
+  }
+
+  // cuts through vertices and along edges of a grid-aligned polygon
+  double cross[] = { 1,0,  2,0,  2,1,  3,1,  3,2,  2,2,  2,3,  1,3,  1,2,  0,2,  0,1,  1,1 };
+  vgl_polygon<double> plus(cross, 12);
+  std::vector<double> xs = { 0.0, 1.0, 2.0, 3.0 }, ys = { 0.0, 1.0, 2.0, 3.0 };
+  std::vector<vgl_polygon<double> > tiles;
+  vgl_clip_to_grid(plus, xs, ys, tiles);
+  ASSERT_EQ(tiles.size(), 9u);
+  for (unsigned t = 0; t < 9; ++t) {
+    const bool arm = t % 2 == 1 || t == 4; // the middle and its four neighbours
+    ASSERT_EQ(tiles[t].num_sheets(), arm ? 1u : 0u) << "tile " << t;
+    if (arm) {
+      EXPECT_EQ(tiles[t][0].size(), 4u);
+      EXPECT_NEAR(vgl_orient_2d(tiles[t][0]) / 2, 1.0, 1e-12);
+    }
+  }
+}
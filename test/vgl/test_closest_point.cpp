@@ -17,8 +17,11 @@
 #include <vgl/vgl_line_segment_3d.h>
 //#include <vgl/vgl_infinite_line_3d.h>
 #include <vgl/vgl_plane_3d.h>
+#include <vgl/vgl_pointset_3d.h>
+#include <vgl/vgl_kd_tree_3d.h>
 //#include <vgl/vgl_sphere_3d.h>
-//#include <vgl/vgl_cubic_spline_3d.h>
+#include <vgl/vgl_cubic_spline_3d.h>
+#include <vgl/vgl_prepared_cubic_spline.h>
 
 #include <gtest/gtest.h>
 
@@ -106,6 +109,43 @@ TEST(closest_point, HomgLine3D)
     ASSERT_NEAR(vgl_distance(pts.first,l2),1/std::sqrt(3.0),1e-8)<<"Skew lines distance test\n";
 }
 
+TEST(closest_point, PointSet3D)
+{
+    std::vector<vgl_point_3d<double> > pts;
+    std::vector<vgl_vector_3d<double> > normals;
+    for (int i = 0; i < 10; ++i)
+      for (int j = 0; j < 10; ++j) {
+        pts.push_back(vgl_point_3d<double>(i, j, 0.0));
+        normals.push_back(vgl_vector_3d<double>(0.0, 0.0, 1.0));
+      }
+    vgl_pointset_3d<double> ptset(pts), ptset_n(pts, normals);
+    vgl_kd_tree_3d<double> index(ptset);
+
+    vgl_point_3d<double> p(3.2, 6.9, 0.5);
+    EXPECT_EQ(vgl_closest_point(ptset, p), vgl_point_3d<double>(3, 7, 0))<<"Closest point in pointset\n";
+    EXPECT_EQ(vgl_closest_point(ptset, p, 1e10, &index), vgl_point_3d<double>(3, 7, 0))<<"Closest point via kd-tree\n";
+    // with normals the point is projected onto the tangent plane
+    vgl_point_3d<double> cp = vgl_closest_point(ptset_n, p, 1e10, &index);
+    ASSERT_NEAR((cp - vgl_point_3d<double>(3.2, 6.9, 0.0)).length(), 0.0, 1e-12)<<"Closest point on tangent plane\n";
+}
+
+TEST(closest_point, Spline3D)
+{
+    std::vector<vgl_point_3d<double> > knots;
+    knots.push_back(vgl_point_3d<double>(1.0, 0.0, 0.0));
+    knots.push_back(vgl_point_3d<double>(1.0, 3.0, 2.0));
+    knots.push_back(vgl_point_3d<double>(2.0, 2.0, 4.0));
+    vgl_cubic_spline_3d<double> spl(knots, 0.5, true);
+    vgl_point_3d<double> p(1.5, 2.5, 3.0);
+    vgl_point_3d<double> cp = vgl_closest_point(spl, p);
+    // near t = 1.43, and at least as close as that point
+    ASSERT_NEAR((cp - spl(1.43)).length(), 0.0, 0.005)<<"Closest point on spline\n";
+    EXPECT_LE((cp - p).length(), (spl(1.43) - p).length());
+    // the offset is normal to the curve
+    vgl_vector_3d<double> d = spl(1.4301) - spl(1.4299);
+    EXPECT_NEAR(dot_product(cp - p, d) / d.length(), 0.0, 1e-3);
+}
+
 /*
 static void testHomgPlane3DClosestPoint()
 {
@@ -1,6 +1,10 @@
 // Some tests for vgl_convex
 // Ian Scott, Feb 2004.
 #include <iostream>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <cmath>
 #include <vgl/vgl_convex.h>
 
 #include <gtest/gtest.h>
@@ -34,3 +38,72 @@ TEST(convex, simple)
     EXPECT_EQ(poly.contains( pts[4] ), true )<<"inside \n";
 }
 
+
+//: true if hull lists, clockwise and without collinear vertices, a convex polygon containing pts
+template <class T>
+static bool is_hull_of(vgl_polygon<T> const& hull, std::vector<vgl_point_2d<T> > const& pts)
+{
+    std::vector<vgl_point_2d<T> > const& h = hull[0];
+    const std::size_t n = h.size();
+    for (std::size_t i = 0; i < n; ++i) {
+        if (std::find(pts.begin(), pts.end(), h[i]) == pts.end()) return false;
+        if (n < 3) continue;
+        vgl_point_2d<T> const& a = h[i];
+        vgl_point_2d<T> const& b = h[(i + 1) % n];
+        if (vgl_orient_2d(a, b, h[(i + 2) % n]) >= 0) return false;
+        for (std::size_t j = 0; j < pts.size(); ++j)
+            if (vgl_orient_2d(a, b, pts[j]) > 0) return false;
+    }
+    return true;
+}
+
+TEST(convex, random)
+{
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<double> u(-1.0, 1.0);
+    std::vector<vgl_point_2d<double> > pts;
+    for (unsigned i = 0; i < 200000; ++i) {
+        double x = u(rng), y = u(rng);
+        if (x * x + y * y <= 1.0) pts.emplace_back(x, y);
+    }
+    vgl_polygon<double> serial = vgl_convex_hull(pts, 1);
+    EXPECT_TRUE(is_hull_of(serial, pts));
+    vgl_polygon<double> parallel = vgl_convex_hull(pts, 4);
+    EXPECT_EQ(parallel[0], serial[0]);
+    // starts at the leftmost point
+    for (auto const& p : pts)
+        EXPECT_GE(p.x(), serial[0][0].x());
+}
+
+TEST(convex, degenerate)
+{
+    std::vector<vgl_point_2d<int> > pts;
+    EXPECT_EQ(vgl_convex_hull(pts)[0].size(), 0u);
+    pts.emplace_back(3, 4);
+    pts.emplace_back(3, 4);
+    EXPECT_EQ(vgl_convex_hull(pts)[0].size(), 1u);
+    // collinear points: the two ends
+    for (int i = -5; i <= 5; ++i)
+        pts.emplace_back(3 + 2 * i, 4 + i);
+    vgl_polygon<int> seg = vgl_convex_hull(pts);
+    ASSERT_EQ(seg[0].size(), 2u);
+    EXPECT_EQ(seg[0][0], vgl_point_2d<int>(-7, -1));
+    EXPECT_EQ(seg[0][1], vgl_point_2d<int>(13, 9));
+    // integer square with points on its edges
+    for (int i = 0; i <= 4; ++i)
+        for (int j = 0; j <= 4; ++j)
+            pts.emplace_back(i * 10, j * 10 - 20);
+    vgl_polygon<int> hull = vgl_convex_hull(pts);
+    EXPECT_TRUE(is_hull_of(hull, pts));
+
+    // nearly collinear points that fool a plain double evaluation
+    std::vector<vgl_point_2d<double> > near;
+    for (int i = 0; i < 64; ++i) {
+        double t = 0.5 + i * std::ldexp(1.0, -50);
+        near.emplace_back(t, t);
+        near.emplace_back(t, std::nextafter(t, 1.0));
+    }
+    near.emplace_back(12.0, 12.0);
+    near.emplace_back(24.0, 24.0);
+    EXPECT_TRUE(is_hull_of(vgl_convex_hull(near), near));
+}
@@ -0,0 +1,96 @@
+// Some tests for vgl_convex_hull_3d
+#include <iostream>
+#include <vector>
+#include <random>
+#include <cmath>
+#include <vgl/vgl_point_3d.h>
+#include <vgl/vgl_box_3d.h>
+#include <vgl/vgl_pointset_3d.h>
+#include <vgl/vgl_convex_hull_3d.h>
+
+#include <gtest/gtest.h>
+
+//: the mesh is closed, consistently oriented and convex, and contains pts
+static void check_hull(vgl_convex_hull_3d<double> const& hull, std::vector<vgl_point_3d<double> > const& pts)
+{
+  ASSERT_TRUE(hull.is_valid());
+  for (unsigned h = 0; h < hull.n_half_edges(); ++h) {
+    EXPECT_EQ(hull.twin(hull.twin(h)), h);
+    EXPECT_EQ(hull.origin(hull.twin(h)), hull.origin(hull.next(h)));
+    EXPECT_EQ(hull.next(hull.prev(h)), h);
+  }
+  // Euler characteristic of a sphere
+  EXPECT_EQ(long(hull.n_vertices()) - long(hull.n_half_edges() / 2) + long(hull.n_faces()), 2);
+  for (unsigned v = 0; v < hull.n_vertices(); ++v)
+    EXPECT_EQ(hull.vertex(v), pts[hull.input_index(v)]);
+  for (unsigned f = 0; f < hull.n_faces(); ++f) {
+    vgl_plane_3d<double> pl = hull.plane(f);
+    for (auto const& p : pts)
+      ASSERT_LE(pl.a() * p.x() + pl.b() * p.y() + pl.c() * p.z() + pl.d(), 1e-12) << "face " << f << '\n';
+  }
+}
+
+TEST(convex_hull_3d, cube)
+{
+  std::vector<vgl_point_3d<double> > pts;
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<double> u(0.0, 2.0);
+  for (unsigned i = 0; i < 1000; ++i)
+    pts.emplace_back(u(rng), u(rng), 3.0 * u(rng) / 2.0);
+  for (int i = 0; i < 8; ++i)
+    pts.emplace_back(2.0 * (i & 1), 2.0 * ((i >> 1) & 1), 3.0 * ((i >> 2) & 1));
+  vgl_convex_hull_3d<double> hull(pts);
+  check_hull(hull, pts);
+  EXPECT_EQ(hull.n_vertices(), 8u);
+  EXPECT_EQ(hull.n_faces(), 12u);
+  EXPECT_NEAR(hull.volume(), 12.0, 1e-12);
+  EXPECT_NEAR(hull.area(), 2 * (4.0 + 6.0 + 6.0), 1e-12);
+  EXPECT_TRUE(hull.bounding_box() == vgl_box_3d<double>(0, 0, 0, 2, 2, 3));
+  EXPECT_TRUE(hull.contains(vgl_point_3d<double>(1.0, 1.0, 1.0)));
+  EXPECT_TRUE(hull.contains(vgl_point_3d<double>(2.0, 1.0, 3.0)));
+  EXPECT_FALSE(hull.contains(vgl_point_3d<double>(2.1, 1.0, 1.0)));
+  EXPECT_TRUE(hull.contains(vgl_point_3d<double>(2.1, 1.0, 1.0), 0.2));
+  std::vector<bool> in = hull.contains(pts);
+  for (bool b : in) EXPECT_TRUE(b);
+}
+
+TEST(convex_hull_3d, random)
+{
+  std::mt19937 rng(2);
+  std::normal_distribution<double> g(0.0, 1.0);
+  std::vector<vgl_point_3d<double> > ball, sphere;
+  for (unsigned i = 0; i < 200000; ++i) {
+    double x = g(rng), y = g(rng), z = g(rng);
+    double r = std::sqrt(x * x + y * y + z * z);
+    ball.emplace_back(x, y, z);
+    if (i < 3000) sphere.emplace_back(x / r, y / r, z / r);
+  }
+  vgl_convex_hull_3d<double> serial(ball, 1);
+  check_hull(serial, ball);
+  vgl_convex_hull_3d<double> parallel(vgl_pointset_3d<double>(ball), 4);
+  EXPECT_EQ(parallel.n_vertices(), serial.n_vertices());
+  EXPECT_NEAR(parallel.volume(), serial.volume(), 1e-9);
+
+  // every point of a sphere is a hull vertex
+  vgl_convex_hull_3d<double> sh(sphere);
+  check_hull(sh, sphere);
+  EXPECT_EQ(sh.n_vertices(), sphere.size());
+  EXPECT_NEAR(sh.volume(), 4.0 * std::acos(-1.0) / 3.0, 0.03);
+}
+
+TEST(convex_hull_3d, degenerate)
+{
+  std::vector<vgl_point_3d<double> > pts;
+  EXPECT_FALSE(vgl_convex_hull_3d<double>(pts).is_valid());
+  for (int i = 0; i < 10; ++i)
+    pts.emplace_back(i, 2 * i, i % 3);
+  EXPECT_FALSE(vgl_convex_hull_3d<double>(std::vector<vgl_point_3d<double> >(pts.begin(), pts.begin() + 3)).is_valid());
+  // coplanar points: no faces, no volume
+  vgl_convex_hull_3d<double> flat(pts);
+  EXPECT_FALSE(flat.is_valid());
+  EXPECT_EQ(flat.volume(), 0.0);
+  EXPECT_FALSE(flat.contains(pts[0]));
+  // one point off the plane makes a valid hull
+  pts.emplace_back(1.0, 0.0, 5.0);
+  check_hull(vgl_convex_hull_3d<double>(pts), pts);
+}
@@ -0,0 +1,259 @@
+// Some tests for vgl_delaunay_2d
+#include <iostream>
+#include <vector>
+#include <utility>
+#include <random>
+#include <cmath>
+#include <vgl/vgl_point_2d.h>
+#include <vgl/vgl_polygon.h>
+#include <vgl/vgl_predicates.h>
+#include <vgl/vgl_delaunay_2d.h>
+
+#include <gtest/gtest.h>
+
+//: the triangles are counterclockwise, consistently adjacent and tile the convex hull;
+//  unless constrained, every edge is locally Delaunay
+static void check_triangulation(vgl_delaunay_2d<double> const& dt, std::size_t n_hull = 0)
+{
+  std::vector<unsigned> tri;
+  std::vector<int> adj;
+  std::vector<unsigned char> con;
+  dt.triangles(tri, &adj, &con);
+  const std::size_t nt = tri.size() / 3;
+  ASSERT_EQ(nt, dt.num_triangles());
+  std::size_t nv = 0, hull = 0;
+  for (unsigned v = 0; v < dt.num_vertices(); ++v)
+    if (dt.in_triangulation(v)) ++nv;
+  for (std::size_t t = 0; t < nt; ++t) {
+    vgl_point_2d<double> a = dt.vertex(tri[3 * t]), b = dt.vertex(tri[3 * t + 1]), c = dt.vertex(tri[3 * t + 2]);
+    ASSERT_GT(vgl_orient_2d(a, b, c), 0.0) << "triangle " << t;
+    for (unsigned k = 0; k < 3; ++k) {
+      const int u = adj[3 * t + k];
+      if (u < 0) { ++hull; continue; }
+      // u has the edge the other way
+      const unsigned a0 = tri[3 * t + (k + 1) % 3], b0 = tri[3 * t + (k + 2) % 3];
+      unsigned j = 0;
+      while (j < 3 && !(tri[3 * u + (j + 1) % 3] == b0 && tri[3 * u + (j + 2) % 3] == a0)) ++j;
+      ASSERT_LT(j, 3u);
+      EXPECT_EQ(adj[3 * u + j], int(t));
+      EXPECT_EQ(con[3 * u + j], con[3 * t + k]);
+      if (!con[3 * t + k]) {
+        vgl_point_2d<double> q = dt.vertex(tri[3 * u + j]);
+        EXPECT_LE(vgl_incircle(a, b, c, q), 0.0) << "edge " << a0 << ' ' << b0;
+      }
+    }
+  }
+  // Euler: a triangulation of nv points with h on the hull boundary has 2 nv - h - 2 triangles
+  EXPECT_EQ(nt, 2 * nv - hull - 2);
+  if (n_hull) {
+    EXPECT_EQ(hull, n_hull);
+  }
+}
+
+TEST(delaunay_2d, random)
+{
+  std::mt19937 rng(3);
+  std::uniform_real_distribution<double> u(-1.0, 1.0);
+  std::vector<vgl_point_2d<double> > pts;
+  for (unsigned i = 0; i < 5000; ++i)
+    pts.emplace_back(u(rng), u(rng));
+  vgl_delaunay_2d<double> dt(pts);
+  check_triangulation(dt);
+  // brute force empty circumcircles on a subset
+  std::vector<unsigned> tri;
+  dt.triangles(tri);
+  for (std::size_t t = 0; t < tri.size() / 3; t += 97)
+    for (auto const& p : pts)
+      ASSERT_LE(vgl_incircle(dt.vertex(tri[3 * t]), dt.vertex(tri[3 * t + 1]), dt.vertex(tri[3 * t + 2]), p), 0.0);
+  // point location and nearest vertex
+  for (unsigned i = 0; i < 200; ++i) {
+    vgl_point_2d<double> p(u(rng), u(rng));
+    unsigned a, b, c;
+    if (dt.locate(p, a, b, c)) {
+      EXPECT_GE(vgl_orient_2d(dt.vertex(a), dt.vertex(b), p), 0.0);
+      EXPECT_GE(vgl_orient_2d(dt.vertex(b), dt.vertex(c), p), 0.0);
+      EXPECT_GE(vgl_orient_2d(dt.vertex(c), dt.vertex(a), p), 0.0);
+    }
+    double best = 1e9;
+    for (auto const& q : pts)
+      best = std::min(best, (q - p).sqr_length());
+    const int v = dt.nearest_vertex(p);
+    ASSERT_GE(v, 0);
+    EXPECT_EQ((dt.vertex(unsigned(v)) - p).sqr_length(), best);
+  }
+  // outside the hull
+  unsigned a, b, c;
+  EXPECT_FALSE(dt.locate(vgl_point_2d<double>(3.0, 0.5), a, b, c));
+}
+
+TEST(delaunay_2d, degenerate)
+{
+  // a grid, with every point repeated: cocircular everywhere, collinear on the hull
+  std::vector<vgl_point_2d<double> > pts;
+  for (int r = 0; r < 2; ++r)
+    for (int i = 0; i < 20; ++i)
+      for (int j = 0; j < 20; ++j)
+        pts.emplace_back(0.1 * i, 0.1 * j);
+  vgl_delaunay_2d<double> dt(pts);
+  EXPECT_EQ(dt.num_vertices(), 800u);
+  EXPECT_EQ(dt.num_triangles(), 2u * 19u * 19u);
+  for (unsigned v = 400; v < 800; ++v) {
+    EXPECT_EQ(dt.representative(v), v - 400);
+    EXPECT_FALSE(dt.in_triangulation(v));
+  }
+  check_triangulation(dt, 76);
+
+  // collinear points wait for the first point off the line
+  vgl_delaunay_2d<double> line;
+  for (int i = 0; i < 10; ++i)
+    line.insert(vgl_point_2d<double>(i, 2 * i));
+  EXPECT_EQ(line.num_triangles(), 0u);
+  EXPECT_EQ(line.nearest_vertex(vgl_point_2d<double>(3.2, 6.0)), 3);
+  EXPECT_EQ(line.insert(vgl_point_2d<double>(4.0, 8.0)), 4u);
+  line.insert(vgl_point_2d<double>(5.0, 0.0));
+  EXPECT_EQ(line.num_triangles(), 9u);
+  check_triangulation(line, 11);
+  // points on the hull edges and on its extension
+  line.insert(vgl_point_2d<double>(2.5, 0.5));
+  line.insert(vgl_point_2d<double>(-1.0, -2.0));
+  line.insert(vgl_point_2d<double>(11.0, 22.0));
+  check_triangulation(line);
+}
+
+TEST(delaunay_2d, constraints)
+{
+  // a square with a square hole, and a segment through two corners of the hole
+  std::mt19937 rng(5);
+  std::uniform_real_distribution<double> u(0.0, 10.0);
+  std::vector<vgl_point_2d<double> > pts;
+  for (unsigned i = 0; i < 2000; ++i)
+    pts.emplace_back(u(rng), u(rng));
+  vgl_delaunay_2d<double> dt(pts);
+  vgl_polygon<double> poly(1);
+  poly.push_back(1.0, 1.0); poly.push_back(9.0, 1.0); poly.push_back(9.0, 9.0); poly.push_back(1.0, 9.0);
+  poly.new_sheet();
+  poly.push_back(4.0, 4.0); poly.push_back(4.0, 6.0); poly.push_back(6.0, 6.0); poly.push_back(6.0, 4.0);
+  EXPECT_TRUE(dt.insert_polygon(poly));
+  const unsigned a = unsigned(dt.insert(vgl_point_2d<double>(2.0, 2.0)));
+  const unsigned b = 2002; // (9, 9)
+  // split at the vertices (4, 4) and (6, 6)
+  EXPECT_TRUE(dt.insert_constraint(a, b));
+  check_triangulation(dt);
+  // a new point on a constrained edge splits it
+  dt.insert(vgl_point_2d<double>(5.0, 6.0));
+  check_triangulation(dt);
+
+  // every constrained sub-edge lies on one of the segments, and they cover them
+  std::vector<unsigned> tri;
+  std::vector<int> adj;
+  std::vector<unsigned char> con;
+  dt.triangles(tri, &adj, &con);
+  std::vector<std::pair<vgl_point_2d<double>, vgl_point_2d<double> > > segs;
+  for (unsigned s = 0; s < poly.num_sheets(); ++s)
+    for (unsigned i = 0; i < poly[s].size(); ++i)
+      segs.emplace_back(poly[s][i], poly[s][(i + 1) % poly[s].size()]);
+  segs.emplace_back(dt.vertex(a), dt.vertex(b));
+  std::vector<double> covered(segs.size(), 0.0);
+  for (std::size_t h = 0; h < con.size(); ++h)
+    if (con[h]) {
+      vgl_point_2d<double> p = dt.vertex(tri[h / 3 * 3 + (h + 1) % 3]), q = dt.vertex(tri[h / 3 * 3 + (h + 2) % 3]);
+      bool on = false;
+      for (std::size_t s = 0; s < segs.size() && !on; ++s)
+        if (vgl_orient_2d(segs[s].first, segs[s].second, p) == 0.0 && vgl_orient_2d(segs[s].first, segs[s].second, q) == 0.0) {
+          on = true;
+          covered[s] += (q - p).length() / 2; // each edge is seen from both sides, or once on the hull
+        }
+      EXPECT_TRUE(on) << p << ' ' << q;
+    }
+  for (std::size_t s = 0; s + 1 < segs.size(); ++s)
+    EXPECT_NEAR(covered[s], (segs[s].second - segs[s].first).length(), 1e-9);
+  EXPECT_NEAR(covered.back(), (segs.back().second - segs.back().first).length(), 1e-9);
+
+  // a segment crossing a constrained one is refused
+  const unsigned c = unsigned(dt.insert(vgl_point_2d<double>(5.0, 0.5)));
+  const unsigned d = unsigned(dt.insert(vgl_point_2d<double>(5.0, 2.0)));
+  EXPECT_FALSE(dt.insert_constraint(c, d));
+  check_triangulation(dt);
+}
+
+TEST(delaunay_2d, crossing_constraint)
+{
+  // a segment through two vertices, then across a constrained edge, leaves
+  // no constrained part behind, and the triangulation Delaunay around it
+  std::mt19937 rng(7);
+  std::uniform_real_distribution<double> u(0.0, 10.0);
+  std::vector<vgl_point_2d<double> > pts;
+  for (unsigned i = 0; i < 1000; ++i)
+    pts.emplace_back(u(rng), u(rng));
+  vgl_delaunay_2d<double> dt(pts);
+  const unsigned a = dt.insert(vgl_point_2d<double>(5.0, 1.0)), b = dt.insert(vgl_point_2d<double>(5.0, 9.0));
+  EXPECT_TRUE(dt.insert_constraint(a, b));
+  const unsigned c = dt.insert(vgl_point_2d<double>(1.0, 5.0)), d = dt.insert(vgl_point_2d<double>(8.0, 5.0));
+  dt.insert(vgl_point_2d<double>(2.0, 5.0));
+  dt.insert(vgl_point_2d<double>(3.0, 5.0));
+  EXPECT_FALSE(dt.insert_constraint(c, d));
+  check_triangulation(dt);
+
+  std::vector<unsigned> tri;
+  std::vector<int> adj;
+  std::vector<unsigned char> con;
+  dt.triangles(tri, &adj, &con);
+  double length = 0.0;
+  for (std::size_t h = 0; h < con.size(); ++h)
+    if (con[h]) {
+      vgl_point_2d<double> p = dt.vertex(tri[h / 3 * 3 + (h + 1) % 3]), q = dt.vertex(tri[h / 3 * 3 + (h + 2) % 3]);
+      EXPECT_EQ(5.0, p.x());
+      EXPECT_EQ(5.0, q.x());
+      length += (q - p).length() / 2;
+    }
+  EXPECT_NEAR(8.0, length, 1e-9);
+}
+
+TEST(delaunay_2d, voronoi)
+{
+  std::mt19937 rng(7);
+  std::uniform_real_distribution<double> u(0.0, 1.0);
+  std::vector<vgl_point_2d<double> > pts;
+  for (unsigned i = 0; i < 1000; ++i)
+    pts.emplace_back(u(rng), u(rng));
+  pts.push_back(pts[10]);
+  vgl_delaunay_2d<double> dt(pts);
+  vgl_delaunay_2d<double>::voronoi_diagram vd;
+  dt.voronoi(vd);
+  ASSERT_EQ(vd.vertices.size(), dt.num_triangles());
+  ASSERT_EQ(vd.cell_start.size(), pts.size() + 1);
+  EXPECT_EQ(vd.cell_start[1001], vd.cell_start[1000]); // the duplicate
+  std::vector<unsigned> tri;
+  dt.triangles(tri);
+  // each Voronoi vertex is equidistant from the vertices of its triangle, and in the cell of each
+  for (std::size_t t = 0; t < tri.size() / 3; ++t) {
+    vgl_point_2d<double> c = vd.vertices[t];
+    const double r = (c - dt.vertex(tri[3 * t])).length();
+    EXPECT_NEAR((c - dt.vertex(tri[3 * t + 1])).length(), r, 1e-9);
+    EXPECT_NEAR((c - dt.vertex(tri[3 * t + 2])).length(), r, 1e-9);
+  }
+  std::size_t n_open = 0;
+  for (unsigned v = 0; v < 1000; ++v) {
+    for (unsigned k = vd.cell_start[v]; k < vd.cell_start[v + 1]; ++k) {
+      const unsigned t = vd.cells[k];
+      EXPECT_TRUE(tri[3 * t] == v || tri[3 * t + 1] == v || tri[3 * t + 2] == v);
+    }
+    if (!vd.bounded[v]) { ++n_open; continue; }
+    // closed cells are convex, counterclockwise, and the site is nearer than any other to their vertices
+    std::vector<vgl_point_2d<double> > poly;
+    for (unsigned k = vd.cell_start[v]; k < vd.cell_start[v + 1]; ++k)
+      poly.push_back(vd.vertices[vd.cells[k]]);
+    ASSERT_GE(poly.size(), 3u);
+    for (std::size_t i = 0; i < poly.size(); ++i)
+      EXPECT_GE(vgl_orient_2d(poly[i], poly[(i + 1) % poly.size()], poly[(i + 2) % poly.size()]), -1e-12);
+    EXPECT_GT(vgl_orient_2d(poly), 0.0);
+    for (auto const& c : poly)
+      for (unsigned w = 0; w < 1000; w += 7)
+        EXPECT_LE((c - pts[v]).length(), (c - pts[w]).length() + 1e-9);
+  }
+  std::vector<int> adj;
+  dt.triangles(tri, &adj);
+  std::size_t hull = 0;
+  for (int a : adj) hull += a < 0;
+  EXPECT_EQ(n_open, hull);
+}
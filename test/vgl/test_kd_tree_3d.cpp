@@ -0,0 +1,124 @@
+// Some tests for vgl_kd_tree_3d
+#include <iostream>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <vgl/vgl_point_3d.h>
+#include <vgl/vgl_pointset_3d.h>
+#include <vgl/vgl_kd_tree_3d.h>
+
+#include <gtest/gtest.h>
+
+static std::vector<vgl_point_3d<double> > random_points(unsigned n, unsigned seed)
+{
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> u(-10.0, 10.0);
+  std::vector<vgl_point_3d<double> > pts;
+  for (unsigned i = 0; i < n; ++i) {
+    double x = u(rng), y = u(rng);
+    pts.push_back(vgl_point_3d<double>(x, y, 0.1 * u(rng)));
+  }
+  return pts;
+}
+
+static double dist2(vgl_point_3d<double> const& a, vgl_point_3d<double> const& b)
+{
+  return (a - b).sqr_length();
+}
+
+TEST(kd_tree_3d, nearest)
+{
+  std::vector<vgl_point_3d<double> > pts = random_points(5000, 1);
+  std::vector<vgl_point_3d<double> > queries = random_points(200, 2);
+  vgl_kd_tree_3d<double> tree(pts, 8, 4);
+  vgl_kd_tree_3d<double> serial(pts, 8, 1);
+  EXPECT_EQ(tree.size(), pts.size());
+
+  std::vector<int> batch;
+  tree.nearest(queries, batch, 0, 3);
+  for (unsigned q = 0; q < queries.size(); ++q) {
+    unsigned best = 0;
+    for (unsigned i = 1; i < pts.size(); ++i)
+      if (dist2(pts[i], queries[q]) < dist2(pts[best], queries[q])) best = i;
+    double d2 = -1;
+    int i = tree.nearest(queries[q], &d2);
+    ASSERT_EQ(i, int(best)) << "query " << q;
+    ASSERT_NEAR(d2, dist2(pts[best], queries[q]), 1e-12);
+    ASSERT_EQ(serial.nearest(queries[q]), int(best));
+    ASSERT_EQ(batch[q], int(best));
+  }
+
+  vgl_kd_tree_3d<double> empty(std::vector<vgl_point_3d<double> >{});
+  EXPECT_EQ(empty.nearest(queries[0]), -1);
+}
+
+TEST(kd_tree_3d, k_nearest_and_radius)
+{
+  std::vector<vgl_point_3d<double> > pts = random_points(3000, 3);
+  vgl_pointset_3d<double> ptset(pts);
+  vgl_kd_tree_3d<double> tree(ptset);
+  vgl_point_3d<double> q(1.0, -2.0, 0.0);
+
+  // brute force order by distance
+  std::vector<std::pair<double, unsigned> > all;
+  for (unsigned i = 0; i < pts.size(); ++i)
+    all.push_back(std::make_pair(dist2(pts[i], q), i));
+  std::sort(all.begin(), all.end());
+
+  std::vector<unsigned> idx;
+  std::vector<double> d2;
+  ASSERT_EQ(tree.k_nearest(q, 25, idx, &d2), 25u);
+  for (unsigned k = 0; k < 25; ++k) {
+    EXPECT_EQ(idx[k], all[k].second);
+    ASSERT_NEAR(d2[k], all[k].first, 1e-12);
+  }
+  EXPECT_EQ(tree.k_nearest(q, 5000, idx), 3000u);
+
+  const double r = 1.5;
+  tree.radius_search(q, r, idx, &d2);
+  std::sort(idx.begin(), idx.end());
+  std::vector<unsigned> expected;
+  for (unsigned i = 0; i < pts.size(); ++i)
+    if (dist2(pts[i], q) <= r * r) expected.push_back(i);
+  EXPECT_EQ(idx, expected);
+  for (double d : d2)
+    EXPECT_LE(d, r * r);
+}
+
+TEST(kd_tree_3d, approximate)
+{
+  std::vector<vgl_point_3d<double> > pts = random_points(20000, 4);
+  std::vector<vgl_point_3d<double> > queries = random_points(500, 5);
+  vgl_kd_tree_3d<double> tree(pts);
+  // a single leaf gives a point of that leaf; more leaves converge to the exact answer
+  unsigned exact1 = 0, exact8 = 0;
+  for (unsigned q = 0; q < queries.size(); ++q) {
+    double d_exact, d1, d8;
+    int i = tree.nearest(queries[q], &d_exact);
+    int i1 = tree.nearest(queries[q], &d1, 1);
+    int i8 = tree.nearest(queries[q], &d8, 8);
+    ASSERT_GE(i1, 0);
+    EXPECT_GE(d1, d_exact);
+    EXPECT_LE(d8, d1);
+    exact1 += i1 == i;
+    exact8 += i8 == i;
+  }
+  EXPECT_GE(exact8, exact1);
+  EXPECT_GE(exact8, 9 * queries.size() / 10);
+
+  std::vector<unsigned> idx;
+  std::vector<double> d2;
+  EXPECT_EQ(tree.k_nearest(queries[0], 10, idx, &d2, 1), 10u);
+  EXPECT_TRUE(std::is_sorted(d2.begin(), d2.end()));
+}
+
+TEST(kd_tree_3d, duplicates)
+{
+  // many equal coordinates must not unbalance the tree or break the search
+  std::vector<vgl_point_3d<double> > pts(1000, vgl_point_3d<double>(1, 2, 3));
+  pts.push_back(vgl_point_3d<double>(0, 0, 0));
+  vgl_kd_tree_3d<double> tree(pts, 4);
+  EXPECT_EQ(tree.nearest(vgl_point_3d<double>(0.1, 0, 0)), 1000);
+  std::vector<unsigned> idx;
+  EXPECT_EQ(tree.radius_search(vgl_point_3d<double>(1, 2, 3), 0.0, idx), 1000u);
+}
@@ -0,0 +1,143 @@
+// Some tests for vgl_octree_3d
+#include <iostream>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <vgl/vgl_point_3d.h>
+#include <vgl/vgl_box_3d.h>
+#include <vgl/vgl_ray_3d.h>
+#include <vgl/vgl_frustum_3d.h>
+#include <vgl/vgl_pointset_3d.h>
+#include <vgl/vgl_octree_3d.h>
+
+#include <gtest/gtest.h>
+
+static std::vector<vgl_point_3d<double> > random_points(unsigned n, unsigned seed)
+{
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> u(-10.0, 10.0);
+  std::vector<vgl_point_3d<double> > pts;
+  for (unsigned i = 0; i < n; ++i) {
+    double x = u(rng), y = u(rng);
+    pts.push_back(vgl_point_3d<double>(x, y, u(rng)));
+  }
+  return pts;
+}
+
+static bool less_xyz(vgl_point_3d<double> const& a, vgl_point_3d<double> const& b)
+{
+  if (a.x() != b.x()) return a.x() < b.x();
+  if (a.y() != b.y()) return a.y() < b.y();
+  return a.z() < b.z();
+}
+
+static std::vector<vgl_point_3d<double> > sorted(std::vector<vgl_point_3d<double> > pts)
+{
+  std::sort(pts.begin(), pts.end(), less_xyz);
+  return pts;
+}
+
+TEST(octree_3d, morton)
+{
+  unsigned i, j, k;
+  vgl_octree_3d<double>::morton_decode(vgl_octree_3d<double>::morton_encode(5, 0, 3), i, j, k);
+  EXPECT_EQ(i, 5u); EXPECT_EQ(j, 0u); EXPECT_EQ(k, 3u);
+  EXPECT_EQ(vgl_octree_3d<double>::morton_encode(1, 0, 0), 1u);
+  EXPECT_EQ(vgl_octree_3d<double>::morton_encode(0, 1, 0), 2u);
+  EXPECT_EQ(vgl_octree_3d<double>::morton_encode(0, 0, 1), 4u);
+  EXPECT_EQ(vgl_octree_3d<double>::morton_encode(1, 1, 1), 7u);
+  vgl_octree_3d<double>::morton_decode(vgl_octree_3d<double>::morton_encode(0x1fffff, 12345, 0x100000), i, j, k);
+  EXPECT_EQ(i, 0x1fffffu); EXPECT_EQ(j, 12345u); EXPECT_EQ(k, 0x100000u);
+
+  vgl_octree_3d<double> grid(vgl_box_3d<double>(0.0, 0.0, 0.0, 10.0, 5.0, 2.0), 1.0);
+  EXPECT_EQ(grid.depth(), 4u);
+  vgl_octree_3d<double>::key_type key;
+  EXPECT_TRUE(grid.key(vgl_point_3d<double>(10.0, 5.0, 2.0), key));
+  EXPECT_TRUE(grid.cell_box(key).contains(10.0, 5.0, 2.0));
+  EXPECT_FALSE(grid.key(vgl_point_3d<double>(-0.1, 0.0, 0.0), key));
+  EXPECT_FALSE(grid.insert(vgl_point_3d<double>(16.0, 0.0, 0.0)));
+}
+
+TEST(octree_3d, box_query)
+{
+  std::vector<vgl_point_3d<double> > pts = random_points(20000, 1);
+  vgl_octree_3d<double> tree(vgl_point_3d<double>(-10.0, -10.0, -10.0), 0.25, 7);
+  // streaming insertion, with queries in between
+  EXPECT_EQ(tree.insert(vgl_pointset_3d<double>(std::vector<vgl_point_3d<double> >(pts.begin(), pts.begin() + 5000))), 5000u);
+  vgl_box_3d<double> box(-3.0, -1.0, 2.0, 4.5, 7.0, 2.1);
+  EXPECT_EQ(tree.points_in(box).npts(),
+            std::size_t(std::count_if(pts.begin(), pts.begin() + 5000,
+                                      [&box](vgl_point_3d<double> const& p) { return box.contains(p); })));
+  for (unsigned i = 5000; i < pts.size(); ++i)
+    tree.insert(pts[i]);
+  EXPECT_EQ(tree.size(), pts.size());
+
+  std::mt19937 rng(2);
+  std::uniform_real_distribution<double> u(-12.0, 12.0);
+  for (unsigned q = 0; q < 20; ++q) {
+    vgl_box_3d<double> b;
+    b.add(vgl_point_3d<double>(u(rng), u(rng), u(rng)));
+    b.add(vgl_point_3d<double>(u(rng), u(rng), u(rng)));
+    std::vector<vgl_point_3d<double> > expected;
+    for (unsigned i = 0; i < pts.size(); ++i)
+      if (b.contains(pts[i])) expected.push_back(pts[i]);
+    EXPECT_EQ(sorted(tree.points_in(b).points()), sorted(expected)) << "box " << q << '\n';
+  }
+}
+
+TEST(octree_3d, frustum_query)
+{
+  vgl_point_3d<double> apex(0.0, 0.0, 10.0);
+  std::vector<vgl_ray_3d<double> > rays;
+  rays.push_back(vgl_ray_3d<double>(apex, vgl_point_3d<double>(10.0, 10.0, 0.0) - apex));
+  rays.push_back(vgl_ray_3d<double>(apex, vgl_point_3d<double>(-10.0, 10.0, 0.0) - apex));
+  rays.push_back(vgl_ray_3d<double>(apex, vgl_point_3d<double>(-10.0, -10.0, 0.0) - apex));
+  rays.push_back(vgl_ray_3d<double>(apex, vgl_point_3d<double>(10.0, -10.0, 0.0) - apex));
+  vgl_frustum_3d<double> f(rays, vgl_vector_3d<double>(0.0, 0.0, 1.0), 5.0, 10.0);
+
+  std::vector<vgl_point_3d<double> > pts = random_points(20000, 3);
+  vgl_octree_3d<double> tree(vgl_box_3d<double>(-10.0, -10.0, -10.0, 10.0, 10.0, 10.0), 0.5);
+  for (unsigned i = 0; i < pts.size(); ++i)
+    tree.insert(pts[i]);
+  std::vector<vgl_point_3d<double> > expected;
+  for (unsigned i = 0; i < pts.size(); ++i)
+    if (f.contains(pts[i])) expected.push_back(pts[i]);
+  EXPECT_GT(expected.size(), 0u);
+  EXPECT_EQ(sorted(tree.points_in(f).points()), sorted(expected));
+}
+
+TEST(octree_3d, downsample)
+{
+  std::vector<vgl_point_3d<double> > pts = random_points(50000, 4);
+  vgl_box_3d<double> bounds(-10.0, -10.0, -10.0, 10.0, 10.0, 10.0);
+  vgl_octree_3d<double> all(bounds, 2.0);
+  vgl_octree_3d<double> streamed(bounds, 2.0, false);
+  for (unsigned i = 0; i < pts.size(); ++i) {
+    all.insert(pts[i]);
+    streamed.insert(pts[i]);
+  }
+  EXPECT_EQ(streamed.size(), pts.size());
+  EXPECT_EQ(all.n_cells(), 1000u);
+  EXPECT_EQ(streamed.n_cells(), 1000u);
+
+  // centroid per voxel by brute force
+  std::vector<double> sx(1000, 0.0), sy(1000, 0.0), sz(1000, 0.0), n(1000, 0.0);
+  for (unsigned i = 0; i < pts.size(); ++i) {
+    unsigned c = unsigned((pts[i].x() + 10) / 2) + 10 * unsigned((pts[i].y() + 10) / 2) + 100 * unsigned((pts[i].z() + 10) / 2);
+    sx[c] += pts[i].x(); sy[c] += pts[i].y(); sz[c] += pts[i].z(); n[c] += 1;
+  }
+  vgl_pointset_3d<double> down = all.downsample(true);
+  vgl_pointset_3d<double> down_streamed = streamed.downsample(true);
+  ASSERT_EQ(down.npts(), 1000u);
+  ASSERT_EQ(down_streamed.npts(), 1000u);
+  for (unsigned i = 0; i < down.npts(); ++i) {
+    vgl_point_3d<double> p = down.p(i);
+    unsigned c = unsigned((p.x() + 10) / 2) + 10 * unsigned((p.y() + 10) / 2) + 100 * unsigned((p.z() + 10) / 2);
+    EXPECT_NEAR(p.x(), sx[c] / n[c], 1e-12);
+    EXPECT_NEAR(p.y(), sy[c] / n[c], 1e-12);
+    EXPECT_NEAR(p.z(), sz[c] / n[c], 1e-12);
+    EXPECT_EQ(down.sc(i), n[c]);
+    EXPECT_NEAR((down_streamed.p(i) - p).length(), 0.0, 1e-12);
+    EXPECT_EQ(down_streamed.sc(i), n[c]);
+  }
+}
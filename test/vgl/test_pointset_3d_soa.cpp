@@ -0,0 +1,112 @@
+// Some tests for vgl_pointset_3d_soa
+#include <iostream>
+#include <vector>
+#include <random>
+#include <cstdint>
+#include <vgl/vgl_point_3d.h>
+#include <vgl/vgl_vector_3d.h>
+#include <vgl/vgl_box_3d.h>
+#include <vgl/vgl_plane_3d.h>
+#include <vgl/vgl_pointset_3d.h>
+#include <vgl/vgl_pointset_3d_soa.h>
+#include <vgl/vgl_kd_tree_3d.h>
+#include <vgl/vgl_intersection.h>
+#include <vgl/vgl_closest_point.h>
+
+#include <gtest/gtest.h>
+
+static vgl_pointset_3d<double> random_pointset(unsigned n, unsigned seed, bool with_normals)
+{
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> u(-1.0, 1.0);
+  std::vector<vgl_point_3d<double> > pts;
+  std::vector<vgl_vector_3d<double> > normals;
+  for (unsigned i = 0; i < n; ++i) {
+    pts.push_back(vgl_point_3d<double>(u(rng), u(rng), u(rng)));
+    normals.push_back(normalized(vgl_vector_3d<double>(u(rng), u(rng), 2.0)));
+  }
+  if (with_normals)
+    return vgl_pointset_3d<double>(pts, normals);
+  return vgl_pointset_3d<double>(pts);
+}
+
+static bool aligned(void const* p)
+{
+  return reinterpret_cast<std::uintptr_t>(p) % 64 == 0;
+}
+
+TEST(pointset_3d_soa, storage)
+{
+  vgl_pointset_3d<double> aos = random_pointset(1000, 1, true);
+  vgl_pointset_3d_soa<double> soa(aos);
+  EXPECT_EQ(soa.npts(), aos.npts());
+  EXPECT_TRUE(soa.has_normals());
+  EXPECT_FALSE(soa.has_scalars());
+  EXPECT_TRUE(aligned(soa.x().data()) && aligned(soa.y().data()) && aligned(soa.z().data()));
+  EXPECT_TRUE(aligned(soa.nx().data()) && aligned(soa.ny().data()) && aligned(soa.nz().data()));
+  for (unsigned i = 0; i < aos.npts(); i += 97) {
+    EXPECT_EQ(soa.p(i), aos.p(i));
+    EXPECT_EQ(soa.n(i), aos.n(i));
+    EXPECT_EQ(soa.x()[i], aos.p(i).x());
+  }
+  EXPECT_TRUE(soa.to_pointset() == aos);
+
+  // bulk append of raw arrays and of another set
+  vgl_pointset_3d_soa<double> bulk;
+  bulk.append(soa.x().data(), soa.y().data(), soa.z().data(), 500,
+              soa.nx().data(), soa.ny().data(), soa.nz().data());
+  EXPECT_EQ(bulk.npts(), 500u);
+  bulk.append(soa);
+  EXPECT_EQ(bulk.npts(), 1500u);
+  EXPECT_EQ(bulk.p(700), soa.p(200));
+
+  // moving columns in does not copy them
+  vgl_pointset_3d_soa<double>::column x(3, 1.0), y(3, 2.0), z(3, 3.0), sc(3, 0.5);
+  double const* xdata = x.data();
+  vgl_pointset_3d_soa<double> moved(std::move(x), std::move(y), std::move(z));
+  moved.set_scalars(std::move(sc));
+  EXPECT_EQ(moved.x().data(), xdata);
+  EXPECT_TRUE(moved.has_scalars());
+  EXPECT_EQ(moved.sc(2), 0.5);
+  EXPECT_EQ(moved.p(1), vgl_point_3d<double>(1.0, 2.0, 3.0));
+
+  // adding a bare point drops the attributes, as in vgl_pointset_3d
+  moved.add_point(vgl_point_3d<double>(0.0, 0.0, 0.0));
+  EXPECT_FALSE(moved.has_scalars());
+  EXPECT_EQ(moved.npts(), 4u);
+}
+
+TEST(pointset_3d_soa, intersection)
+{
+  vgl_pointset_3d<double> aos = random_pointset(5000, 2, true);
+  vgl_pointset_3d_soa<double> soa(aos);
+
+  vgl_box_3d<double> box(-0.5, -0.25, 0.0, 0.5, 0.75, 1.0);
+  vgl_pointset_3d<double> in_box = vgl_intersection(box, aos);
+  vgl_pointset_3d_soa<double> in_box_soa = vgl_intersection(soa, box);
+  EXPECT_GT(in_box.npts(), 0u);
+  EXPECT_TRUE(in_box_soa.to_pointset() == in_box);
+
+  vgl_plane_3d<double> plane(1.0, 2.0, -1.0, 0.3);
+  vgl_pointset_3d<double> on_plane = vgl_intersection(plane, aos, 0.05);
+  vgl_pointset_3d_soa<double> on_plane_soa = vgl_intersection(plane, soa, 0.05);
+  EXPECT_GT(on_plane.npts(), 0u);
+  EXPECT_TRUE(on_plane_soa.to_pointset() == on_plane);
+}
+
+TEST(pointset_3d_soa, closest_point)
+{
+  for (int with_normals = 0; with_normals < 2; ++with_normals) {
+    vgl_pointset_3d<double> aos = random_pointset(3000, 3, with_normals != 0);
+    vgl_pointset_3d_soa<double> soa(aos);
+    vgl_kd_tree_3d<double> index(soa.x().data(), soa.y().data(), soa.z().data(), soa.npts());
+    std::mt19937 rng(4);
+    std::uniform_real_distribution<double> u(-1.2, 1.2);
+    for (unsigned q = 0; q < 100; ++q) {
+      vgl_point_3d<double> p(u(rng), u(rng), u(rng));
+      vgl_point_3d<double> expected = vgl_closest_point(aos, p, 0.1);
+      EXPECT_EQ(vgl_closest_point(soa, p, 0.1), expected);
+      EXPECT_EQ(vgl_closest_point(soa, p, 0.1, &index), expected);
+    }
+  }
+}
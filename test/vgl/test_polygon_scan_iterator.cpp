@@ -0,0 +1,183 @@
+// Some tests for vgl_polygon_scan_iterator
+#include <iostream>
+#include <vector>
+#include <random>
+#include <cmath>
+#include <vgl/vgl_polygon.h>
+#include <vgl/vgl_polygon_scan_iterator.h>
+#include <vbl/vbl_array_2d.h>
+
+#include <gtest/gtest.h>
+
+// winding number (non_zero) or crossing parity (even-odd) of the edges
+// crossed by the ray from (x,y) towards -x, an edge counting if y0 <= y < y1
+static bool inside(vgl_polygon<double> const& p, double x, double y, vgl_fill_rule rule)
+{
+  int w = 0;
+  for (unsigned s = 0; s < p.num_sheets(); ++s)
+    for (unsigned i = 0; i < p[s].size(); ++i) {
+      vgl_point_2d<double> a = p[s][i], b = p[s][(i + 1) % p[s].size()];
+      int dir = 1;
+      if (a.y() > b.y()) { std::swap(a, b); dir = -1; }
+      if (a.y() <= y && y < b.y() && a.x() + (y - a.y()) * (b.x() - a.x()) / (b.y() - a.y()) <= x)
+        w += rule == vgl_fill_rule_even_odd ? 1 : dir;
+    }
+  return rule == vgl_fill_rule_even_odd ? (w % 2) != 0 : w != 0;
+}
+
+// does segment ab meet the closed square of pixel (x,y)?
+static bool touches(vgl_point_2d<double> a, vgl_point_2d<double> b, double x, double y)
+{
+  double t0 = 0, t1 = 1;
+  const double d[2] = { b.x() - a.x(), b.y() - a.y() }, o[2] = { a.x(), a.y() }, c[2] = { x, y };
+  for (int k = 0; k < 2; ++k) {
+    if (d[k] == 0) {
+      if (o[k] < c[k] - 0.5 || o[k] > c[k] + 0.5) return false;
+      continue;
+    }
+    double ta = (c[k] - 0.5 - o[k]) / d[k], tb = (c[k] + 0.5 - o[k]) / d[k];
+    if (ta > tb) std::swap(ta, tb);
+    t0 = std::max(t0, ta);
+    t1 = std::min(t1, tb);
+  }
+  return t0 <= t1;
+}
+
+static bool covered(vgl_polygon<double> const& p, int x, int y, bool boundary, vgl_fill_rule rule)
+{
+  if (inside(p, x, y, rule))
+    return true;
+  if (!boundary)
+    return false;
+  for (unsigned s = 0; s < p.num_sheets(); ++s)
+    for (unsigned i = 0; i < p[s].size(); ++i)
+      if (touches(p[s][i], p[s][(i + 1) % p[s].size()], x, y))
+        return true;
+  return false;
+}
+
+TEST(polygon_scan_iterator, triangle)
+{
+  vgl_polygon<double> p;
+  p.new_sheet();
+  p.push_back(0.0, 0.0);
+  p.push_back(4.0, 0.0);
+  p.push_back(0.0, 4.0);
+
+  // centres: (x,y) with x,y >= 0 and x+y < 4
+  vgl_polygon_scan_iterator<double> it(p, false);
+  int n = 0, rows = 0;
+  while (it.next()) {
+    EXPECT_EQ(it.scany(), rows);
+    EXPECT_EQ(it.startx(), 0);
+    EXPECT_EQ(it.endx(), 3 - it.scany());
+    n += it.endx() - it.startx() + 1;
+    ++rows;
+  }
+  EXPECT_EQ(rows, 4);
+  EXPECT_EQ(n, 10);
+  // and again after reset
+  it.reset();
+  EXPECT_TRUE(it.next());
+  EXPECT_EQ(it.scany(), 0);
+
+  // with boundary: also the pixels the hypotenuse passes through or touches
+  vgl_polygon_scan_iterator<double> ib(p, true);
+  const int ends[] = { 4, 4, 3, 2, 1 };
+  rows = 0;
+  while (ib.next()) {
+    ASSERT_EQ(ib.scany(), rows);
+    EXPECT_EQ(ib.startx(), 0);
+    EXPECT_EQ(ib.endx(), ends[rows]);
+    ++rows;
+  }
+  EXPECT_EQ(rows, 5);
+
+  // windowed
+  vgl_polygon_scan_iterator<double> iw(p, false, vgl_box_2d<double>(1.0, 2.0, 1.0, 5.0));
+  n = 0;
+  while (iw.next()) {
+    EXPECT_GE(iw.startx(), 1);
+    EXPECT_LE(iw.endx(), 2);
+    n += iw.endx() - iw.startx() + 1;
+  }
+  EXPECT_EQ(n, 3); // (1,1) (2,1) (1,2)
+}
+
+TEST(polygon_scan_iterator, random)
+{
+  std::mt19937 rng(7);
+  std::uniform_real_distribution<double> u(-1.0, 9.0);
+  for (unsigned trial = 0; trial < 300; ++trial) {
+    // one or two self-intersecting sheets, some with integer vertices
+    vgl_polygon<double> p;
+    for (unsigned s = 0; s < 1 + trial % 2; ++s) {
+      p.new_sheet();
+      for (unsigned i = 0; i < 3 + rng() % 6; ++i) {
+        double x = u(rng), y = u(rng);
+        if (trial % 3 == 0) { x = std::floor(x); y = std::floor(y) + 0.5 * (rng() % 2); }
+        p.push_back(x, y);
+      }
+    }
+    for (int b = 0; b < 2; ++b)
+      for (int r = 0; r < 2; ++r) {
+        const vgl_fill_rule rule = r ? vgl_fill_rule_non_zero : vgl_fill_rule_even_odd;
+        vbl_array_2d<unsigned char> mask(12, 12, 0);
+        vgl_polygon_rasterize(p, mask, (unsigned char)1, b != 0, rule);
+        for (int y = 0; y < 12; ++y)
+          for (int x = 0; x < 12; ++x)
+            ASSERT_EQ(mask(y, x) != 0, covered(p, x, y, b != 0, rule))
+              << "trial " << trial << " pixel " << x << ',' << y << " boundary " << b << " rule " << r;
+      }
+  }
+}
+
+TEST(polygon_scan_iterator, spans_and_rules)
+{
+  // two overlapping squares, the same way round: the overlap is a hole
+  // under even-odd but filled under non-zero
+  vgl_polygon<double> p;
+  p.new_sheet();
+  p.push_back(0.0, 0.0); p.push_back(4.0, 0.0); p.push_back(4.0, 4.0); p.push_back(0.0, 4.0);
+  p.new_sheet();
+  p.push_back(2.0, 2.0); p.push_back(6.0, 2.0); p.push_back(6.0, 6.0); p.push_back(2.0, 6.0);
+  int even_odd = 0, non_zero = 0, spans = 0;
+  vgl_polygon_scan_spans(p, [&](int, int x0, int x1) { even_odd += x1 - x0 + 1; ++spans; }, false);
+  vgl_polygon_scan_spans(p, [&](int, int x0, int x1) { non_zero += x1 - x0 + 1; }, false,
+                         vgl_fill_rule_non_zero);
+  EXPECT_EQ(non_zero, 16 + 16 - 4);
+  EXPECT_EQ(even_odd, non_zero - 4);
+  EXPECT_EQ(spans, 2 + 2 * 2 + 2); // rows 2 and 3 are split by the hole
+}
+
+TEST(polygon_scan_iterator, coverage)
+{
+  // a square at 45 degrees, and a rectangle with fractional sides
+  const double pi = 3.14159265358979323846;
+  vgl_polygon<double> p;
+  p.new_sheet();
+  for (int i = 0; i < 4; ++i)
+    p.push_back(10 + 6 * std::cos(i * pi / 2), 10 + 6 * std::sin(i * pi / 2));
+  p.new_sheet();
+  p.push_back(20.25, 2.5); p.push_back(27.75, 2.5); p.push_back(27.75, 6.5); p.push_back(20.25, 6.5);
+
+  vbl_array_2d<float> cov(30, 30, 0.0f);
+  vgl_polygon_coverage(p, cov, 16);
+  double sum = 0;
+  for (int y = 0; y < 30; ++y)
+    for (int x = 0; x < 30; ++x) {
+      EXPECT_GE(cov(y, x), 0.0f);
+      EXPECT_LE(cov(y, x), 1.0f);
+      sum += cov(y, x);
+    }
+  EXPECT_NEAR(sum, 72.0 + 7.5 * 4.0, 0.5);
+  // the rectangle's rows are whole pixels, so its coverage is exact
+  EXPECT_FLOAT_EQ(cov(4, 20), 0.25f); // [19.5, 20.5] from 20.25
+  EXPECT_FLOAT_EQ(cov(4, 24), 1.0f);
+  EXPECT_FLOAT_EQ(cov(4, 27), 1.0f);
+  EXPECT_FLOAT_EQ(cov(4, 28), 0.25f); // [27.5, 28.5] to 27.75
+  EXPECT_FLOAT_EQ(cov(7, 24), 0.0f);
+  EXPECT_FLOAT_EQ(cov(10, 10), 1.0f);
+  // a pixel cut in half by the diagonal edge from (16,10) to (10,16)
+  EXPECT_NEAR(cov(13, 13), 0.5, 0.05);
+}
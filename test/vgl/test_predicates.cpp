@@ -0,0 +1,237 @@
+// Tests for vgl_predicates, against exact integer arithmetic
+#include <iostream>
+#include <vector>
+#include <random>
+#include <cmath>
+#include <vgl/vgl_predicates.h>
+#include <vgl/vgl_lineseg_test.h>
+#include <vgl/vgl_triangle_test.h>
+#include <vgl/vgl_polygon.h>
+
+#include <gtest/gtest.h>
+
+typedef __int128 big;
+
+static int sign(double v) { return (v > 0) - (v < 0); }
+static int sign(big v) { return (v > 0) - (v < 0); }
+
+TEST(predicates, orient_2d)
+{
+  // Shewchuk's example: a grid of points within a few ulps of the line through b and c
+  const double u = std::ldexp(1.0, -53);
+  int naive_wrong = 0;
+  for (int i = 0; i < 64; ++i)
+    for (int j = 0; j < 64; ++j) {
+      const double ax = 0.5 + i * u, ay = 0.5 + j * u;
+      // in units of u the coordinates are integers
+      const big X = (big(1) << 52) + i, Y = (big(1) << 52) + j, B = big(12) << 53, C = big(24) << 53;
+      const big exact = (X - C) * (B - C) - (Y - C) * (B - C);
+      EXPECT_EQ(sign(exact), sign(vgl_orient_2d(ax, ay, 12.0, 12.0, 24.0, 24.0)));
+      const double naive = (ax - 24.0) * (12.0 - 24.0) - (ay - 24.0) * (12.0 - 24.0);
+      naive_wrong += sign(naive) != sign(exact);
+    }
+  EXPECT_GT(naive_wrong, 0);
+  // and for points
+  EXPECT_GT(vgl_orient_2d(vgl_point_2d<float>(0, 0), vgl_point_2d<float>(1, 0), vgl_point_2d<float>(0, 1)), 0);
+}
+
+TEST(predicates, orient_3d)
+{
+  // points near the plane of b, c, d on a grid of 2^-40, so the exact value fits in 128 bits
+  std::mt19937 rng(1);
+  std::uniform_int_distribution<long long> coord(-(1LL << 40), 1LL << 40);
+  std::uniform_int_distribution<int> nudge(-3, 3);
+  const double u = std::ldexp(1.0, -40);
+  for (int trial = 0; trial < 2000; ++trial) {
+    long long P[4][3];
+    for (int k = 1; k < 4; ++k)
+      for (int c = 0; c < 3; ++c)
+        P[k][c] = coord(rng);
+    // a = b + (c - b) / 3 + (d - b) / 5 rounded, then nudged
+    for (int c = 0; c < 3; ++c)
+      P[0][c] = P[1][c] + (P[2][c] - P[1][c]) / 3 + (P[3][c] - P[1][c]) / 5 + nudge(rng);
+    big D[3][3];
+    for (int r = 0; r < 3; ++r)
+      for (int c = 0; c < 3; ++c)
+        D[r][c] = big(P[r][c]) - big(P[3][c]);
+    const big exact = D[0][0] * (D[1][1] * D[2][2] - D[1][2] * D[2][1]) -
+                      D[0][1] * (D[1][0] * D[2][2] - D[1][2] * D[2][0]) +
+                      D[0][2] * (D[1][0] * D[2][1] - D[1][1] * D[2][0]);
+    vgl_point_3d<double> p[4];
+    for (int k = 0; k < 4; ++k)
+      p[k].set(P[k][0] * u, P[k][1] * u, P[k][2] * u);
+    ASSERT_EQ(sign(exact), sign(vgl_orient_3d(p[0], p[1], p[2], p[3])));
+  }
+  // d below the counterclockwise a, b, c is positive
+  EXPECT_GT(vgl_orient_3d(vgl_point_3d<double>(0, 0, 0), vgl_point_3d<double>(1, 0, 0),
+                          vgl_point_3d<double>(0, 1, 0), vgl_point_3d<double>(0, 0, -1)), 0);
+}
+
+TEST(predicates, incircle)
+{
+  // integer points near a circle of radius 2^25, exact in 128 bits
+  std::mt19937 rng(2);
+  std::uniform_real_distribution<double> angle(0.0, 6.283185307179586);
+  const double R = std::ldexp(1.0, 25);
+  for (int trial = 0; trial < 2000; ++trial) {
+    long long P[4][2];
+    for (int k = 0; k < 4; ++k) {
+      const double t = angle(rng);
+      P[k][0] = std::llround(R * std::cos(t));
+      P[k][1] = std::llround(R * std::sin(t));
+    }
+    big d[3][3];
+    for (int k = 0; k < 3; ++k) {
+      d[k][0] = P[k][0] - P[3][0];
+      d[k][1] = P[k][1] - P[3][1];
+      d[k][2] = d[k][0] * d[k][0] + d[k][1] * d[k][1];
+    }
+    const big exact = d[0][2] * (d[1][0] * d[2][1] - d[2][0] * d[1][1]) +
+                      d[1][2] * (d[2][0] * d[0][1] - d[0][0] * d[2][1]) +
+                      d[2][2] * (d[0][0] * d[1][1] - d[1][0] * d[0][1]);
+    ASSERT_EQ(sign(exact), sign(vgl_incircle(double(P[0][0]), double(P[0][1]), double(P[1][0]), double(P[1][1]),
+                                             double(P[2][0]), double(P[2][1]), double(P[3][0]), double(P[3][1]))));
+  }
+  // cocircular points on x^2 + y^2 = 25, then inside and outside
+  vgl_point_2d<double> a(5, 0), b(3, 4), c(-4, 3);
+  EXPECT_EQ(0.0, vgl_incircle(a, b, c, vgl_point_2d<double>(0, -5)));
+  EXPECT_GT(vgl_incircle(a, b, c, vgl_point_2d<double>(0, 0)), 0);
+  EXPECT_LT(vgl_incircle(a, b, c, vgl_point_2d<double>(6, 0)), 0);
+  EXPECT_LT(vgl_incircle(b, a, c, vgl_point_2d<double>(0, 0)), 0);
+
+  // points within a few ulps of (5, 0): inside exactly if 10 i u > (i^2 + j^2) u^2
+  const double u = std::ldexp(1.0, -50);
+  vgl_point_2d<double> e(0, -5);
+  int naive_wrong = 0;
+  for (int i = -8; i <= 8; ++i)
+    for (int j = -8; j <= 8; ++j) {
+      const double px = 5.0 - i * u, py = j * u;
+      const int expected = i != 0 ? (i > 0 ? 1 : -1) : (j != 0 ? -1 : 0);
+      EXPECT_EQ(expected, sign(vgl_incircle(b, c, e, vgl_point_2d<double>(px, py))));
+      const double adx = 3 - px, ady = 4 - py, bdx = -4 - px, bdy = 3 - py, cdx = -px, cdy = -5 - py;
+      const double naive = (adx * adx + ady * ady) * (bdx * cdy - cdx * bdy) +
+                           (bdx * bdx + bdy * bdy) * (cdx * ady - adx * cdy) +
+                           (cdx * cdx + cdy * cdy) * (adx * bdy - bdx * ady);
+      naive_wrong += sign(naive) != expected;
+    }
+  EXPECT_GT(naive_wrong, 0);
+}
+
+TEST(predicates, insphere)
+{
+  // integer points near a sphere of radius 2^19, exact in 128 bits
+  std::mt19937 rng(3);
+  std::normal_distribution<double> g(0.0, 1.0);
+  const double R = std::ldexp(1.0, 19);
+  for (int trial = 0; trial < 1000; ++trial) {
+    long long P[5][3];
+    for (int k = 0; k < 5; ++k) {
+      double v[3] = { g(rng), g(rng), g(rng) };
+      const double l = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+      for (int c = 0; c < 3; ++c)
+        P[k][c] = std::llround(R * v[c] / l);
+    }
+    big d[4][4];
+    for (int k = 0; k < 4; ++k) {
+      for (int c = 0; c < 3; ++c)
+        d[k][c] = big(P[k][c]) - big(P[4][c]);
+      d[k][3] = d[k][0] * d[k][0] + d[k][1] * d[k][1] + d[k][2] * d[k][2];
+    }
+    // the 4x4 determinant of the rows (dx, dy, dz, lift), by expansion along the last column
+    big exact = 0;
+    for (int k = 0; k < 4; ++k) {
+      big m[3][3];
+      for (int r = 0, rr = 0; r < 4; ++r) {
+        if (r == k) continue;
+        for (int c = 0; c < 3; ++c) m[rr][c] = d[r][c];
+        ++rr;
+      }
+      const big minor = m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1]) -
+                        m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0]) +
+                        m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+      exact += ((k + 3) % 2 ? -1 : 1) * d[k][3] * minor;
+    }
+    vgl_point_3d<double> p[5];
+    for (int k = 0; k < 5; ++k)
+      p[k].set(double(P[k][0]), double(P[k][1]), double(P[k][2]));
+    ASSERT_EQ(sign(exact), sign(vgl_insphere(p[0], p[1], p[2], p[3], p[4])));
+  }
+  // cospherical points on x^2 + y^2 + z^2 = 25
+  vgl_point_3d<double> a(5, 0, 0), b(0, 5, 0), c(0, 0, 5), d(-3, -4, 0);
+  const double o = vgl_orient_3d(a, b, c, d);
+  ASSERT_NE(0.0, o);
+  EXPECT_EQ(0.0, vgl_insphere(a, b, c, d, vgl_point_3d<double>(0, 0, -5)));
+  EXPECT_GT(o * vgl_insphere(a, b, c, d, vgl_point_3d<double>(0, 0, 0)), 0);
+  EXPECT_LT(o * vgl_insphere(a, b, c, d, vgl_point_3d<double>(0, 0, 6)), 0);
+
+  // points within a few ulps of (-5, 0, 0), away from a, b, c, d
+  const double u = std::ldexp(1.0, -50);
+  for (int i = -4; i <= 4; ++i)
+    for (int j = -4; j <= 4; ++j)
+      for (int k = -4; k <= 4; ++k) {
+        const vgl_point_3d<double> e(-5.0 + i * u, j * u, k * u);
+        const int inside = i != 0 ? (i > 0 ? 1 : -1) : (j != 0 || k != 0 ? -1 : 0);
+        EXPECT_EQ(inside * sign(o), sign(vgl_insphere(a, b, c, d, e)));
+      }
+}
+
+TEST(predicates, inexact_differences)
+{
+  // coordinates of different magnitudes, so that their differences are rounded
+  // and the signs come from the later stages; degenerate cases are exactly zero
+  const double up = 1e300, down = -1e300;
+  const double x0 = 0.1, x1 = 1e7 + 0.3, y0 = -0.7, y1 = 3e-5, z0 = 1e-9 + 0.2, z1 = 5e6 / 3;
+
+  // on the line y = x, and an ulp above it
+  EXPECT_EQ(0.0, vgl_orient_2d(x0, x0, x1, x1, z1, z1));
+  EXPECT_GT(vgl_orient_2d(x0, x0, x1, x1, z1, std::nextafter(z1, up)), 0);
+  EXPECT_LT(vgl_orient_2d(x0, x0, x1, x1, std::nextafter(z1, up), z1), 0);
+
+  // the corners of a rectangle are cocircular; an ulp towards its centre is inside
+  EXPECT_EQ(0.0, vgl_incircle(x0, y0, x1, y0, x1, y1, x0, y1));
+  EXPECT_GT(vgl_incircle(x0, y0, x1, y0, x1, y1, std::nextafter(x0, up), y1), 0);
+  EXPECT_LT(vgl_incircle(x0, y0, x1, y0, x1, y1, x0, std::nextafter(y1, up)), 0);
+
+  // on the plane z = x, and an ulp off it, on the side of a point far off it
+  EXPECT_EQ(0.0, vgl_orient_3d(x0, y0, x0, x1, y1, x1, z0, z1, z0, y1, x1, y1));
+  const int below = vgl_orient_3d(x0, y0, x0, x1, y1, x1, z0, z1, z0, y1, x1, y1 + 1.0) > 0 ? 1 : -1;
+  EXPECT_EQ(below, vgl_orient_3d(x0, y0, x0, x1, y1, x1, z0, z1, z0, y1, x1, std::nextafter(y1, up)) > 0 ? 1 : -1);
+  EXPECT_EQ(-below, vgl_orient_3d(x0, y0, x0, x1, y1, x1, z0, z1, z0, y1, x1, std::nextafter(y1, down)) > 0 ? 1 : -1);
+
+  // the corners of a box are cospherical; an ulp towards its centre is inside
+  vgl_point_3d<double> a(x0, y0, z0), b(x1, y0, z0), c(x0, y1, z0), d(x0, y0, z1);
+  const double o = vgl_orient_3d(a, b, c, d);
+  ASSERT_NE(0.0, o);
+  EXPECT_EQ(0.0, vgl_insphere(a, b, c, d, vgl_point_3d<double>(x1, y1, z1)));
+  EXPECT_GT(o * vgl_insphere(a, b, c, d, vgl_point_3d<double>(x1, y1, std::nextafter(z1, down))), 0);
+  EXPECT_LT(o * vgl_insphere(a, b, c, d, vgl_point_3d<double>(std::nextafter(x1, up), y1, z1)), 0);
+}
+
+TEST(predicates, users)
+{
+  // a tiny crossing far from the origin, then the same segments apart
+  const double s = 1e-8;
+  EXPECT_TRUE(vgl_lineseg_test_lineseg(1000.0, 1000.0, 1000.0 + s, 1000.0 + s, 1000.0, 1000.0 + s, 1000.0 + s, 1000.0));
+  EXPECT_FALSE(vgl_lineseg_test_lineseg(1000.0, 1000.0, 1000.0 + s, 1000.0 + s,
+                                        1000.0 + 2 * s, 1000.0 + s, 1000.0 + 3 * s, 1000.0));
+  // collinear and overlapping, and collinear apart
+  EXPECT_TRUE(vgl_lineseg_test_lineseg(0.1, 0.1, 0.7, 0.7, 0.3, 0.3, 0.9, 0.9));
+  EXPECT_FALSE(vgl_lineseg_test_lineseg(0.1, 0.1, 0.3, 0.3, 0.7, 0.7, 0.9, 0.9));
+
+  // a sliver far from the origin, whose area is below the rounding of the shoelace sum
+  std::vector<vgl_point_2d<double> > sliver;
+  sliver.push_back(vgl_point_2d<double>(1e9, 1e9));
+  sliver.push_back(vgl_point_2d<double>(3e9, 3e9));
+  sliver.push_back(vgl_point_2d<double>(2e9, 2e9 + 1e-6));
+  EXPECT_GT(vgl_orient_2d(sliver), 0);
+  EXPECT_TRUE(vgl_polygon_sheet_is_counter_clockwise(sliver));
+  std::swap(sliver[0], sliver[1]);
+  EXPECT_FALSE(vgl_polygon_sheet_is_counter_clockwise(sliver));
+
+  // a float triangle whose doubled area, 1e-60, underflows float
+  const float t = 1e-30f;
+  EXPECT_GT(vgl_triangle_test_discriminant(0.0f, 0.0f, t, 0.0f, 0.0f, t), 0.0f);
+  EXPECT_LT(vgl_triangle_test_discriminant(0.0f, 0.0f, 0.0f, t, t, 0.0f), 0.0f);
+  EXPECT_TRUE(vgl_triangle_test_inside(0.0f, 0.0f, t, 0.0f, 0.0f, t, t / 4, t / 4));
+  EXPECT_FALSE(vgl_triangle_test_inside(0.0f, 0.0f, t, 0.0f, 0.0f, t, t, t));
+}
@@ -0,0 +1,159 @@
+// Some tests for vgl_prepared_cubic_spline
+#include <iostream>
+#include <vector>
+#include <random>
+#include <cmath>
+#include <vgl/vgl_cubic_spline_2d.h>
+#include <vgl/vgl_cubic_spline_3d.h>
+#include <vgl/vgl_prepared_cubic_spline.h>
+#include <vgl/vgl_closest_point.h>
+
+#include <gtest/gtest.h>
+
+static vgl_cubic_spline_3d<double> random_spline_3d(unsigned n, bool closed, unsigned seed)
+{
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> u(-10.0, 10.0);
+  std::vector<vgl_point_3d<double> > knots;
+  for (unsigned i = 0; i < n; ++i)
+    knots.push_back(vgl_point_3d<double>(u(rng), u(rng), u(rng)));
+  return vgl_cubic_spline_3d<double>(knots, 0.5, closed);
+}
+
+TEST(prepared_cubic_spline, evaluate)
+{
+  for (int closed = 0; closed < 2; ++closed) {
+    vgl_cubic_spline_3d<double> spl = random_spline_3d(20, closed != 0, 1);
+    vgl_prepared_cubic_spline_3d<double> prep(spl);
+    EXPECT_EQ(prep.num_segments(), 19u);
+    EXPECT_EQ(prep.max_t(), spl.max_t());
+
+    std::vector<double> t, x(1001), y(1001), z(1001), dx(1001), dy(1001), dz(1001), tx(1001), ty(1001), tz(1001);
+    for (unsigned i = 0; i <= 1000; ++i)
+      t.push_back(spl.max_t() * i / 1000.0);
+    prep.evaluate(&t[0], t.size(), &x[0], &y[0], &z[0]);
+    prep.derivatives(&t[0], t.size(), &dx[0], &dy[0], &dz[0]);
+    prep.tangents(&t[0], t.size(), &tx[0], &ty[0], &tz[0]);
+    for (unsigned i = 0; i <= 1000; ++i) {
+      vgl_point_3d<double> p = spl(t[i]);
+      EXPECT_NEAR((prep(t[i]) - p).length(), 0.0, 1e-12);
+      EXPECT_NEAR(x[i], p.x(), 1e-12);
+      EXPECT_NEAR(y[i], p.y(), 1e-12);
+      EXPECT_NEAR(z[i], p.z(), 1e-12);
+      vgl_vector_3d<double> d = prep.derivative(t[i]);
+      EXPECT_EQ(d.x(), dx[i]);
+      EXPECT_EQ(d.y(), dy[i]);
+      EXPECT_EQ(d.z(), dz[i]);
+      EXPECT_NEAR(std::sqrt(tx[i] * tx[i] + ty[i] * ty[i] + tz[i] * tz[i]), 1.0, 1e-12);
+      // against a central difference inside the segment
+      const double h = 1e-6;
+      double tm = t[i] - h, tp = t[i] + h;
+      if (tm < std::floor(t[i])) { tm = t[i]; tp = t[i] + 2 * h; }
+      if (tp > spl.max_t()) { tm = t[i] - 2 * h; tp = t[i]; }
+      vgl_vector_3d<double> fd = (spl(tp) - spl(tm)) / (tp - tm);
+      EXPECT_NEAR((fd - d).length(), 0.0, 1e-4 * (1 + d.length()));
+    }
+  }
+  // parameters outside the curve are clamped
+  vgl_prepared_cubic_spline_3d<double> prep(random_spline_3d(5, false, 2));
+  double t[2] = { -1.0, 7.0 }, x[2], y[2], z[2];
+  prep.evaluate(t, 2, x, y, z);
+  EXPECT_EQ(x[0], prep(0.0).x());
+  EXPECT_EQ(z[1], prep(4.0).z());
+}
+
+TEST(prepared_cubic_spline, closest_point)
+{
+  vgl_cubic_spline_3d<double> spl = random_spline_3d(40, false, 3);
+  vgl_prepared_cubic_spline_3d<double> prep(spl);
+  std::mt19937 rng(4);
+  std::uniform_real_distribution<double> u(-12.0, 12.0);
+  std::vector<vgl_point_3d<double> > pts;
+  for (unsigned q = 0; q < 100; ++q)
+    pts.push_back(vgl_point_3d<double>(u(rng), u(rng), u(rng)));
+  // dense samples of the curve
+  std::vector<vgl_point_3d<double> > samples;
+  const unsigned per_segment = 400;
+  for (unsigned i = 0; i <= 39 * per_segment; ++i)
+    samples.push_back(prep(double(i) / per_segment));
+
+  for (unsigned q = 0; q < pts.size(); ++q) {
+    double d2, t = prep.closest_parameter(pts[q], &d2);
+    ASSERT_GE(t, 0.0);
+    ASSERT_LE(t, prep.max_t());
+    EXPECT_NEAR((prep(t) - pts[q]).sqr_length(), d2, 1e-9);
+    double best = 1e300;
+    for (unsigned i = 0; i < samples.size(); ++i)
+      best = std::min(best, (samples[i] - pts[q]).sqr_length());
+    // no sample is closer, and the closest sample is near the minimum
+    EXPECT_LE(d2, best + 1e-12);
+    EXPECT_NEAR(std::sqrt(d2), std::sqrt(best), 1e-3);
+    EXPECT_EQ(prep.closest_point(pts[q]), prep(t));
+  }
+  // a point on the curve is its own closest point
+  double d2;
+  double t = prep.closest_parameter(prep(17.3), &d2);
+  EXPECT_NEAR(d2, 0.0, 1e-20);
+  EXPECT_NEAR(t, 17.3, 1e-6);
+
+  std::vector<double> serial, threaded;
+  prep.closest_parameters(pts, serial, 1);
+  prep.closest_parameters(pts, threaded, 4);
+  EXPECT_EQ(serial, threaded);
+  for (unsigned q = 0; q < pts.size(); ++q)
+    EXPECT_EQ(serial[q], prep.closest_parameter(pts[q]));
+
+  // vgl_closest_point searches the whole curve
+  EXPECT_EQ(vgl_closest_point(spl, pts[0]), prep.closest_point(pts[0]));
+  EXPECT_EQ(vgl_prepared_cubic_spline_3d<double>().closest_parameter(pts[0], &d2), 0.0);
+  EXPECT_TRUE(std::isinf(d2));
+}
+
+TEST(prepared_cubic_spline, arc_length)
+{
+  // equally spaced knots on a line: the curve runs along the line, length 3
+  std::vector<vgl_point_2d<double> > line;
+  for (int i = 0; i < 4; ++i)
+    line.push_back(vgl_point_2d<double>(2.0 + i, 1.0));
+  vgl_cubic_spline_2d<double> line_spl(line);
+  vgl_prepared_cubic_spline_2d<double> straight(line_spl);
+  EXPECT_NEAR(straight.length(), 3.0, 1e-12);
+  std::vector<vgl_point_2d<double> > pts;
+  straight.resample(7, pts);
+  ASSERT_EQ(pts.size(), 7u);
+  for (unsigned i = 0; i < 7; ++i) {
+    EXPECT_NEAR(pts[i].x(), 2.0 + 0.5 * i, 1e-10);
+    EXPECT_NEAR(pts[i].y(), 1.0, 1e-12);
+  }
+
+  // a closed curve through the points of a circle
+  const double pi = 3.14159265358979323846;
+  std::vector<vgl_point_2d<double> > circle;
+  for (int i = 0; i <= 12; ++i)
+    circle.push_back(vgl_point_2d<double>(5 * std::cos(i * pi / 6), 5 * std::sin(i * pi / 6)));
+  vgl_cubic_spline_2d<double> spl(circle, 0.5, true);
+  vgl_prepared_cubic_spline_2d<double> prep(spl);
+  double polyline = 0.0;
+  for (unsigned i = 1; i <= 120000; ++i)
+    polyline += (spl(12.0 * i / 120000) - spl(12.0 * (i - 1) / 120000)).length();
+  EXPECT_NEAR(prep.length(), polyline, 1e-6);
+  EXPECT_NEAR(prep.length(), 2 * pi * 5, 0.1);
+  EXPECT_EQ(prep.arc_length(0.0), 0.0);
+  EXPECT_NEAR(prep.arc_length(prep.max_t()), prep.length(), 1e-12);
+  for (double s = 0.0; s <= prep.length(); s += 0.37) {
+    const double t = prep.parameter(s);
+    EXPECT_NEAR(prep.arc_length(t), s, 1e-10);
+  }
+  std::vector<double> t;
+  prep.uniform_parameters(50, t);
+  ASSERT_EQ(t.size(), 50u);
+  EXPECT_EQ(t.front(), 0.0);
+  EXPECT_EQ(t.back(), prep.max_t());
+  for (unsigned i = 0; i < 50; ++i)
+    EXPECT_NEAR(prep.arc_length(t[i]), prep.length() * i / 49, 1e-10);
+
+  // 2-d closest point
+  vgl_point_2d<double> p(0.3, 7.0);
+  vgl_point_2d<double> cp = vgl_closest_point(spl, p);
+  EXPECT_NEAR((cp - vgl_point_2d<double>(0.0, 5.0)).length(), 0.0, 0.3);
+}
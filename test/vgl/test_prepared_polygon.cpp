@@ -0,0 +1,126 @@
+// Some tests for vgl_prepared_polygon
+#include <iostream>
+#include <vector>
+#include <random>
+#include <cmath>
+#include <vgl/vgl_polygon.h>
+#include <vgl/vgl_prepared_polygon.h>
+
+#include <gtest/gtest.h>
+
+// a wavy ring with a wavy hole, n vertices on each boundary
+static vgl_polygon<double> ring(unsigned n)
+{
+  const double pi = 3.14159265358979323846;
+  vgl_polygon<double> p;
+  p.new_sheet();
+  for (unsigned i = 0; i < n; ++i) {
+    double a = 2 * pi * i / n, r = 1 + 0.3 * std::sin(17 * a);
+    p.push_back(r * std::cos(a), r * std::sin(a));
+  }
+  p.new_sheet();
+  for (unsigned i = 0; i < n; ++i) {
+    double a = 2 * pi * i / n, r = 0.4 + 0.1 * std::cos(9 * a);
+    p.push_back(r * std::cos(a), r * std::sin(a));
+  }
+  return p;
+}
+
+TEST(prepared_polygon, same_as_contains)
+{
+  vgl_polygon<double> p = ring(500);
+  vgl_prepared_polygon<double> pp(p);
+  EXPECT_EQ(pp.num_edges(), 1000u);
+  EXPECT_GT(pp.cols() * pp.rows(), 1u);
+
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<double> u(-1.5, 1.5), t(0.0, 1.0);
+  for (unsigned q = 0; q < 20000; ++q) {
+    double x = u(rng), y = u(rng);
+    EXPECT_EQ(pp.contains(x, y), p.contains(x, y));
+  }
+  // vertices and points on edges are inside
+  for (unsigned s = 0; s < p.num_sheets(); ++s)
+    for (unsigned i = 0; i < p[s].size(); ++i) {
+      vgl_point_2d<double> const& a = p[s][i];
+      vgl_point_2d<double> const& b = p[s][(i + 1) % p[s].size()];
+      double f = t(rng);
+      vgl_point_2d<double> m(a.x() + f * (b.x() - a.x()), a.y() + f * (b.y() - a.y()));
+      EXPECT_TRUE(pp.contains(a));
+      EXPECT_EQ(pp.contains(m), p.contains(m));
+    }
+}
+
+TEST(prepared_polygon, degenerate)
+{
+  // collinear edges, a vertex on another edge and horizontal runs through
+  // grid lines, with queries on the integer lattice and between it
+  vgl_polygon<float> p;
+  p.new_sheet();
+  float const xy[] = { 0,0, 2,0, 4,0, 4,2, 2,2, 2,4, 0,4, 0,2, 2,2, 1,1 };
+  for (unsigned i = 0; i < 10; ++i)
+    p.push_back(xy[2 * i], xy[2 * i + 1]);
+  p.new_sheet();
+  p.push_back(3, 3); // a single point
+  for (double cpe : { 0.5, 4.0, 50.0 }) {
+    vgl_prepared_polygon<float> pp(p, cpe);
+    for (int i = -2; i <= 18; ++i)
+      for (int j = -2; j <= 18; ++j) {
+        float x = 0.25f * i, y = 0.25f * j;
+        EXPECT_EQ(pp.contains(x, y), p.contains(x, y)) << x << ' ' << y << " cells/edge " << cpe;
+      }
+  }
+
+  vgl_polygon<float> empty;
+  vgl_prepared_polygon<float> pe(empty);
+  EXPECT_FALSE(pe.contains(0.0f, 0.0f));
+  unsigned char m = 1;
+  float z = 0;
+  pe.contains(&z, &z, 1, &m);
+  EXPECT_EQ(m, 0);
+}
+
+TEST(prepared_polygon, batch)
+{
+  vgl_polygon<double> p = ring(2000);
+  vgl_prepared_polygon<double> pp(p);
+  std::mt19937 rng(2);
+  std::uniform_real_distribution<double> u(-1.5, 1.5);
+  const std::size_t n = 50000;
+  std::vector<double> x(n), y(n);
+  for (std::size_t i = 0; i < n; ++i) { x[i] = u(rng); y[i] = u(rng); }
+  std::vector<unsigned char> serial(n), threaded(n);
+  pp.contains(x.data(), y.data(), n, serial.data(), 1);
+  pp.contains(x.data(), y.data(), n, threaded.data(), 4);
+  unsigned inside = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    EXPECT_EQ(serial[i] != 0, pp.contains(x[i], y[i]));
+    EXPECT_EQ(serial[i], threaded[i]);
+    inside += serial[i];
+  }
+  EXPECT_GT(inside, 0u);
+  EXPECT_LT(inside, n);
+  for (std::size_t i = 0; i < n; i += 97)
+    EXPECT_EQ(serial[i] != 0, p.contains(x[i], y[i]));
+}
+
+TEST(prepared_polygon, integer)
+{
+  // the ring on an integer lattice, where vgl_polygon<int>::contains()
+  // truncates the crossing abscissa; every lattice point of the box is queried
+  vgl_polygon<double> r = ring(300);
+  vgl_polygon<int> p;
+  for (unsigned s = 0; s < r.num_sheets(); ++s) {
+    p.new_sheet();
+    for (unsigned i = 0; i < r[s].size(); ++i)
+      p.push_back(int(std::floor(150 * r[s][i].x() + 0.5)), int(std::floor(150 * r[s][i].y() + 0.5)));
+  }
+  for (double cpe : { 1.0, 4.0, 20.0 }) {
+    vgl_prepared_polygon<int> pp(p, cpe);
+    unsigned diff = 0;
+    for (int y = -200; y <= 200; ++y)
+      for (int x = -200; x <= 200; ++x)
+        diff += pp.contains(x, y) != p.contains(x, y);
+    EXPECT_EQ(diff, 0u) << "cells/edge " << cpe;
+  }
+}
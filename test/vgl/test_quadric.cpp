@@ -2,37 +2,22 @@
 // J.L. Mundy, June 2017.
 #include <iostream>
 #include <sstream>
+#include <vector>
+#include <random>
+#include <cmath>
 
 #include <vgl/vgl_quadric_3d.h>
 #include <vgl/vgl_tolerance.h>
+#include <vgl/vgl_pointset_3d_soa.h>
+#include <vnl/vnl_matrix_fixed.h>
 
 #include <gtest/gtest.h>
 
-// multiply square matrices
-static std::vector<std::vector<double> > mul(std::vector<std::vector<double> > const& a,
-                                             std::vector<std::vector<double> > const& b){
-  size_t N = a.size();
-  std::vector<std::vector<double> > out(N,std::vector<double>(N,0.0));
-  for (unsigned i = 0; i < N; ++i)
-    for (unsigned j = 0; j < N; ++j)
-    {
-      double accum = a[i][0] * b[0][j];
-      for (unsigned k = 1; k < N; ++k)
-        accum += a[i][k] * b[k][j];
-      out[i][j] = accum;
-    }
-  return out;
-}
-static std::vector<std::vector<double> > transform_quadric(std::vector<std::vector<double> > const& T,
-                                                           std::vector<std::vector<double> > const& Q){
-  std::vector<std::vector<double> > Tt(4,std::vector<double>(4,0.0));
-  for(size_t r = 0; r<4; ++r)
-    for(size_t c = 0; c<4; ++c)
-      Tt[r][c]=T[c][r];
-  std::vector<std::vector<double> > temp(4,std::vector<double>(4,0.0));
-  temp = mul(Q,T);
-  temp = mul(Tt,temp);
-  return temp;
+static vnl_matrix_fixed<double, 4, 4> transform_quadric(vnl_matrix_fixed<double, 4, 4> const& T,
+                                                         vnl_matrix_fixed<double, 4, 4> const& Q){
+  const vnl_matrix_fixed<double, 4, 4> Tt(T.transpose());
+  const vnl_matrix_fixed<double, 4, 4> TtQ(Tt * Q);
+  return vnl_matrix_fixed<double, 4, 4>(TtQ * T);
 }
 
 TEST(quadric, simple)
@@ -94,8 +79,8 @@ TEST(quadric, simple)
   good = good && real_parallel_planes.type()==vgl_quadric_3d<double>::real_parallel_planes;
   EXPECT_EQ(good, true)<<"Quadric classification \n";
 
-  std::vector<std::vector<double> >  Q = elliptic_paraboloid.coef_matrix(), Qtrans;
-  std::vector<std::vector< double> > T(4, std::vector<double>(4, 0.0));
+  vnl_matrix_fixed<double, 4, 4> Q = elliptic_paraboloid.coef_matrix();
+  vnl_matrix_fixed<double, 4, 4> T(0.0);
   double p = 0.785, q = 0.866;
   double cp = cos(p), sp = sin(p);
   double cq = cos(q), sq = sin(q);
@@ -104,12 +89,12 @@ TEST(quadric, simple)
   T[1][0] = cq*sp; T[1][1] = cp*cq; T[1][2]=-sq; T[1][3]=ty;
   T[2][0] = sp*sq; T[2][1] = cp*sq; T[2][2]= cq; T[2][3]=tz;
   T[3][3] = 1.0;
-  Qtrans = transform_quadric(T,Q);//Note T is actually the inverse transformation since transform_quadric == T^tQT
+  vnl_matrix_fixed<double, 4, 4> Qtrans(transform_quadric(T,Q));//Note T is actually the inverse transformation since transform_quadric == T^tQT
   vgl_quadric_3d<double> test(Qtrans);
   good = test.type() == vgl_quadric_3d<double>::elliptic_paraboloid;
   Q = real_elliptic_cone.coef_matrix();
-  Qtrans = transform_quadric(T, Q);
-  vgl_quadric_3d<double> test2(Qtrans);
+  vnl_matrix_fixed<double, 4, 4> Qtrans2(transform_quadric(T, Q));
+  vgl_quadric_3d<double> test2(Qtrans2);
   good = good && test2.type() == vgl_quadric_3d<double>::real_elliptic_cone;
   EXPECT_EQ(good, true)<<"Transformed quadric classification\n";
   std::string name = test2.type_by_number(test2.type());
@@ -124,41 +109,125 @@ TEST(quadric, simple)
   // test translation
   // note transform quadric is T^t Q T to avoid inverses but should be T^-t Q T^-1 to translate the quadric
   // to a new center, so use negative translations
-  std::vector<std::vector<double> >  Qe = real_ellipsoid.coef_matrix(), Qet, QeE,QeET, QeETT;
-  std::vector<std::vector< double> > Te(4, std::vector<double>(4, 0.0));
+  vnl_matrix_fixed<double, 4, 4> Qe = real_ellipsoid.coef_matrix();
+  vnl_matrix_fixed<double, 4, 4> Te(0.0);
   Te[0][0] = 1.0; Te[1][1] = 1.0; Te[2][2] = 1.0; Te[0][3]=-tx;
   Te[1][3]=-ty;
   Te[2][3]=-tz;
   Te[3][3] = 1.0;
   // a simple sphere case
-  Qet = transform_quadric(Te,Qe);
+  vnl_matrix_fixed<double, 4, 4> Qet(transform_quadric(Te,Qe));
   vgl_quadric_3d<double> tran_quad(Qet);
   vgl_point_3d<double> cent, true_cent(tx, ty, tz);
   good = tran_quad.center(cent) && cent == true_cent;
   // full eccentric ellipsoid
   vgl_quadric_3d<double> eccentric_ellipsoid(0.5, 0.25, 0.125, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, -1.0);
-   QeE = eccentric_ellipsoid.coef_matrix();
-   QeET = transform_quadric(T,QeE);
+   vnl_matrix_fixed<double, 4, 4> QeE(eccentric_ellipsoid.coef_matrix());
+   vnl_matrix_fixed<double, 4, 4> QeET(transform_quadric(T,QeE));
    vgl_quadric_3d<double> tran_ecc_quad(QeET);
-   vgl_point_3d<double> rot_cent;
+   vgl_point_3d<double> rot_cent(0.0, 0.0, 0.0);
    good = good &&  tran_ecc_quad.center(rot_cent);
    // to prove the center is correct, translate to move the center to the origin
    // and show that the translation dependent terms of the quadric vanish.
    Te[0][3]=rot_cent.x(); Te[1][3] = rot_cent.y(); Te[2][3] = rot_cent.z();
    // note again the tranform quadric function requires the inverse of the desired translation,
    // which is just the center itself.
-   QeETT = transform_quadric(Te,QeET);//should have g = h = i == 0
+   vnl_matrix_fixed<double, 4, 4> QeETT(transform_quadric(Te,QeET));//should have g = h = i == 0
    double sum_ghi = fabs(QeETT[0][3])+ fabs(QeETT[1][3])+ fabs(QeETT[2][3]);
    good = good && sum_ghi < 1.0e-8;
    EXPECT_EQ(good , true)<<"center\n";
    Q = elliptic_paraboloid.coef_matrix();
-   std::vector<std::vector<double> > Tq(4, std::vector<double>(4, 0.0));
+   vnl_matrix_fixed<double, 4, 4> Tq(0.0);
    Tq[0][0]=0.5;Tq[1][1]=1.0;Tq[2][2]=0.5;Tq[3][3]=1.0;
    Tq[0][2] = -0.866;Tq[2][0] = 0.866;
    Tq[0][3] = 1.0; Tq[2][3] = 2.0; Tq[2][3] = 3.0;
    vgl_quadric_3d<double> tr_elliptic_para(Q,Tq);
-   std::vector<std::vector<double> > Hg;
-   std::vector<std::vector<double> > Qg = tr_elliptic_para.canonical_quadric(Hg);
+   vnl_matrix_fixed<double, 4, 4> Hg;
+   vnl_matrix_fixed<double, 4, 4> Qg = tr_elliptic_para.canonical_quadric(Hg);
    vgl_quadric_3d<double> pqst_q(Qg);
     EXPECT_EQ(pqst_q.type() == vgl_quadric_3d<double>::elliptic_paraboloid, true)<<"canonical frame \n";
 }
+
+TEST(quadric, batch)
+{
+  vgl_quadric_3d<double> ellipsoid(0.5, 0.25, 0.125, 0.1, -0.2, 0.05, 0.3, -0.1, 0.2, -1.0);
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<double> u(-3.0, 3.0);
+  vgl_pointset_3d_soa<double> pts;
+  for (unsigned i = 0; i < 1000; ++i)
+    pts.add_point(vgl_point_3d<double>(u(rng), u(rng), u(rng)));
+  // points on the surface along rays from the center
+  vgl_point_3d<double> c;
+  ASSERT_TRUE(ellipsoid.center(c));
+  for (unsigned i = 0; i < 300; ++i) {
+    vgl_vector_3d<double> d(u(rng), u(rng), u(rng));
+    // Q(c + t d) = a t^2 + k, as the gradient vanishes at the center
+    vnl_matrix_fixed<double, 4, 4> Q = ellipsoid.coef_matrix();
+    double vc[4] = { c.x(), c.y(), c.z(), 1.0 }, vd[4] = { d.x(), d.y(), d.z(), 0.0 };
+    double a = 0.0, k = 0.0;
+    for (unsigned r = 0; r < 4; ++r)
+      for (unsigned s = 0; s < 4; ++s) {
+        a += vd[r] * Q[r][s] * vd[s];
+        k += vc[r] * Q[r][s] * vc[s];
+      }
+    double t = std::sqrt(-k / a);
+    pts.add_point(c + t * d);
+  }
+  std::vector<double> dist;
+  std::vector<unsigned char> on;
+  ellipsoid.sampson_dist(pts, dist);
+  ellipsoid.on(pts, on, 1e-6);
+  ASSERT_EQ(dist.size(), pts.size());
+  ASSERT_EQ(on.size(), pts.size());
+  unsigned n_on = 0;
+  for (std::size_t i = 0; i < pts.size(); ++i) {
+    vgl_homg_point_3d<double> p(pts.x()[i], pts.y()[i], pts.z()[i]);
+    EXPECT_NEAR(dist[i], ellipsoid.sampson_dist(p), 1e-12 * (1 + dist[i]));
+    EXPECT_EQ(on[i] != 0, ellipsoid.on(p, 1e-6));
+    n_on += on[i];
+  }
+  EXPECT_GE(n_on, 300u);
+}
+
+TEST(quadric, sampson_gradient)
+{
+  // for a sphere of radius 2 the Sampson distance of (x,0,0) is |x^2-4|/(2|x|)
+  vgl_quadric_3d<double> sphere(1.0, 1.0, 1.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, -4.0);
+  EXPECT_NEAR(sphere.sampson_dist(vgl_homg_point_3d<double>(3.0, 0.0, 0.0)), 5.0 / 6.0, 1e-12);
+  // and a mixed term contributes to the gradient additively
+  vgl_quadric_3d<double> q(1.0, 1.0, 1.0, 1.0, 0.0, 0.0, 0.0, 0.0, 0.0, -4.0);
+  // f = x^2 + y^2 + z^2 + xy - 4, grad = (2x + y, 2y + x, 2z)
+  const double x = 1.0, y = 2.0, z = 0.5;
+  const double f = x * x + y * y + z * z + x * y - 4.0;
+  const double g = std::sqrt((2 * x + y) * (2 * x + y) + (2 * y + x) * (2 * y + x) + 4 * z * z);
+  EXPECT_NEAR(q.sampson_dist(vgl_homg_point_3d<double>(x, y, z)), std::fabs(f) / g, 1e-12);
+}
+
+TEST(quadric, canonical_with_rotation)
+{
+  // the ellipsoid x^2/4 + y^2/9 + z^2 = 1, rotated about (1,2,3) and moved
+  vnl_matrix_fixed<double, 4, 4> Qc(0.0);
+  Qc[0][0] = 1.0 / 4.0; Qc[1][1] = 1.0 / 9.0; Qc[2][2] = 1.0; Qc[3][3] = -1.0;
+  double ax[3] = { 1.0, 2.0, 3.0 };
+  const double len = std::sqrt(14.0), ang = 0.7, c = std::cos(ang), s = std::sin(ang);
+  for (double& a : ax) a /= len;
+  vnl_matrix_fixed<double, 4, 4> H(0.0);
+  for (int r = 0; r < 3; ++r)
+    for (int k = 0; k < 3; ++k)
+      H[r][k] = (r == k ? c : 0.0) + (1 - c) * ax[r] * ax[k];
+  H[0][1] -= s * ax[2]; H[1][0] += s * ax[2];
+  H[0][2] += s * ax[1]; H[2][0] -= s * ax[1];
+  H[1][2] -= s * ax[0]; H[2][1] += s * ax[0];
+  H[0][3] = 1.0; H[1][3] = -2.0; H[2][3] = 0.5; H[3][3] = 1.0;
+  vgl_quadric_3d<double> q(Qc, H);
+  for (int i = 0; i < 20; ++i) {
+    const double u = 0.3 * i, v = 0.17 * i + 0.2;
+    const double p[3] = { 2.0 * std::cos(u) * std::sin(v), 3.0 * std::sin(u) * std::sin(v), std::cos(v) };
+    double g[3];
+    for (int r = 0; r < 3; ++r)
+      g[r] = H[r][0] * p[0] + H[r][1] * p[1] + H[r][2] * p[2] + H[r][3];
+    vgl_homg_point_3d<double> pt(g[0], g[1], g[2]);
+    EXPECT_NEAR(q.sampson_dist(pt), 0.0, 1e-12) << "point " << i;
+    EXPECT_TRUE(q.on(pt, 1e-9)) << "point " << i;
+  }
+}
@@ -0,0 +1,180 @@
+// Some tests for vgl_simplify
+#include <iostream>
+#include <vector>
+#include <random>
+#include <cmath>
+#include <vgl/vgl_point_2d.h>
+#include <vgl/vgl_point_3d.h>
+#include <vgl/vgl_polygon.h>
+#include <vgl/vgl_predicates.h>
+#include <vgl/vgl_simplify.h>
+
+#include <gtest/gtest.h>
+
+static double sqr_distance(vgl_point_2d<double> const& p, vgl_point_2d<double> const& a, vgl_point_2d<double> const& b)
+{
+  vgl_vector_2d<double> d = b - a;
+  double t = dot_product(p - a, d) / d.sqr_length();
+  t = t < 0 ? 0 : t > 1 ? 1 : t;
+  return (a + t * d - p).sqr_length();
+}
+
+//: the segments of the sheets of poly, and whether any two that are not neighbours meet
+static bool self_intersecting(vgl_polygon<double> const& poly)
+{
+  std::vector<std::pair<vgl_point_2d<double>, vgl_point_2d<double> > > segs;
+  std::vector<std::pair<unsigned, unsigned> > id;
+  for (unsigned s = 0; s < poly.num_sheets(); ++s)
+    for (unsigned i = 0; i < poly[s].size(); ++i) {
+      segs.emplace_back(poly[s][i], poly[s][(i + 1) % poly[s].size()]);
+      id.emplace_back(s, i);
+    }
+  for (std::size_t i = 0; i < segs.size(); ++i)
+    for (std::size_t j = i + 1; j < segs.size(); ++j) {
+      const unsigned n = poly[id[i].first].size();
+      if (id[i].first == id[j].first && ((id[i].second + 1) % n == id[j].second || (id[j].second + 1) % n == id[i].second))
+        continue;
+      const double o1 = vgl_orient_2d(segs[i].first, segs[i].second, segs[j].first);
+      const double o2 = vgl_orient_2d(segs[i].first, segs[i].second, segs[j].second);
+      const double o3 = vgl_orient_2d(segs[j].first, segs[j].second, segs[i].first);
+      const double o4 = vgl_orient_2d(segs[j].first, segs[j].second, segs[i].second);
+      if (o1 * o2 <= 0 && o3 * o4 <= 0)
+        return true;
+    }
+  return false;
+}
+
+//: a wobbly circle of n vertices
+static vgl_polygon<double> wobbly_ring(std::mt19937& rng, int n, double cx, double cy, double r, double noise, bool ccw)
+{
+  std::uniform_real_distribution<double> u(-noise, noise);
+  vgl_polygon<double> poly(1);
+  for (int i = 0; i < n; ++i) {
+    const double a = (ccw ? 2 : -2) * 3.14159265358979 * i / n, rr = r + u(rng);
+    poly.push_back(cx + rr * std::cos(a), cy + rr * std::sin(a));
+  }
+  return poly;
+}
+
+TEST(simplify, douglas_peucker)
+{
+  // a noisy line keeps its end points only, unless the tolerance is below the noise
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<double> u(-0.01, 0.01);
+  std::vector<vgl_point_2d<double> > line;
+  for (int i = 0; i <= 1000; ++i)
+    line.emplace_back(0.01 * i, u(rng));
+  std::vector<unsigned> kept = vgl_simplify_indices(line, 0.02);
+  ASSERT_EQ(kept.size(), 2u);
+  EXPECT_EQ(kept[1], 1000u);
+  kept = vgl_simplify_indices(line, 0.005);
+  EXPECT_GT(kept.size(), 10u);
+  // every dropped vertex is within the tolerance of the segment that replaces it
+  for (std::size_t k = 0; k + 1 < kept.size(); ++k)
+    for (unsigned i = kept[k] + 1; i < kept[k + 1]; ++i)
+      EXPECT_LE(sqr_distance(line[i], line[kept[k]], line[kept[k + 1]]), 0.005 * 0.005);
+
+  // a square ring with points along its edges keeps its corners
+  std::vector<vgl_point_2d<double> > ring;
+  for (int i = 0; i < 4; ++i) ring.emplace_back(i, 0.0);
+  for (int i = 0; i < 4; ++i) ring.emplace_back(4.0, i);
+  for (int i = 4; i > 0; --i) ring.emplace_back(i, 4.0);
+  for (int i = 4; i > 0; --i) ring.emplace_back(0.0, i);
+  std::vector<vgl_point_2d<double> > square = vgl_simplify(ring, 0.1, vgl_simplify_douglas_peucker, true);
+  ASSERT_EQ(square.size(), 4u);
+  EXPECT_EQ(square[0], vgl_point_2d<double>(0.0, 0.0));
+  EXPECT_EQ(square[2], vgl_point_2d<double>(4.0, 4.0));
+  // a huge tolerance still leaves a triangle
+  EXPECT_EQ(vgl_simplify(ring, 100.0, vgl_simplify_douglas_peucker, true).size(), 3u);
+
+  // 3-d: a helix with few turns
+  std::vector<vgl_point_3d<double> > helix;
+  for (int i = 0; i <= 400; ++i)
+    helix.emplace_back(std::cos(0.05 * i), std::sin(0.05 * i), 0.01 * i);
+  std::vector<vgl_point_3d<double> > h = vgl_simplify(helix, 0.01);
+  EXPECT_GT(h.size(), 10u);
+  EXPECT_LT(h.size(), 200u);
+  EXPECT_EQ(h.front(), helix.front());
+  EXPECT_EQ(h.back(), helix.back());
+}
+
+TEST(simplify, visvalingam)
+{
+  // a zigzag whose teeth have area 0.05, then a bump of area 8
+  std::vector<vgl_point_2d<double> > line;
+  for (int i = 0; i <= 20; ++i)
+    line.emplace_back(i, i % 2 ? 0.1 : 0.0);
+  line.emplace_back(22.0, 8.0);
+  line.emplace_back(24.0, 0.0);
+  std::vector<unsigned> kept = vgl_simplify_indices(line, 0.04, vgl_simplify_visvalingam);
+  EXPECT_EQ(kept.size(), line.size());
+  kept = vgl_simplify_indices(line, 2.0, vgl_simplify_visvalingam);
+  ASSERT_EQ(kept.size(), 4u);
+  EXPECT_EQ(kept[1], 20u);
+  EXPECT_EQ(kept[2], 21u);
+
+  // a ring goes down to a triangle at most
+  std::mt19937 rng(2);
+  vgl_polygon<double> ring = wobbly_ring(rng, 500, 0.0, 0.0, 10.0, 0.1, true);
+  vgl_polygon<double> tri = vgl_simplify(ring, 1e6, vgl_simplify_visvalingam);
+  EXPECT_EQ(tri[0].size(), 3u);
+  vgl_polygon<double> some = vgl_simplify(ring, 0.5, vgl_simplify_visvalingam);
+  EXPECT_GT(some[0].size(), 10u);
+  EXPECT_LT(some[0].size(), 200u);
+
+  // 3-d chains use the area of the triangle in space
+  std::vector<vgl_point_3d<double> > bent;
+  bent.emplace_back(0.0, 0.0, 0.0);
+  bent.emplace_back(1.0, 0.0, 0.1);
+  bent.emplace_back(2.0, 0.0, 0.0);
+  bent.emplace_back(2.0, 0.0, 5.0);
+  EXPECT_EQ(vgl_simplify(bent, 0.2, vgl_simplify_visvalingam).size(), 3u);
+}
+
+TEST(simplify, preserve_topology)
+{
+  // a wobbly ring with a hole near its edge, and a second ring close outside it
+  for (int m = 0; m < 2; ++m) {
+    const vgl_simplify_method method = m ? vgl_simplify_visvalingam : vgl_simplify_douglas_peucker;
+    const double tol = m ? 40.0 : 3.0;
+    std::mt19937 rng(4);
+    vgl_polygon<double> poly = wobbly_ring(rng, 400, 0.0, 0.0, 10.0, 0.5, true);
+    vgl_polygon<double> hole = wobbly_ring(rng, 40, 6.2, 6.2, 0.5, 0.1, false);
+    vgl_polygon<double> other = wobbly_ring(rng, 100, 21.0, 0.0, 9.0, 1.0, true);
+    poly.push_back(hole[0]);
+    poly.push_back(other[0]);
+    ASSERT_FALSE(self_intersecting(poly));
+    vgl_polygon<double> loose = vgl_simplify(poly, tol, method);
+    vgl_polygon<double> tight = vgl_simplify(poly, tol, method, true);
+    EXPECT_TRUE(self_intersecting(loose) || !vgl_polygon<double>(loose[0]).contains(hole[0][0])) << "method " << m;
+    EXPECT_FALSE(self_intersecting(tight)) << "method " << m;
+    // the hole stays inside the outer ring
+    vgl_polygon<double> outer(tight[0]);
+    for (auto const& p : tight[1])
+      EXPECT_TRUE(outer.contains(p)) << "method " << m;
+    EXPECT_LT(tight.num_vertices(), poly.num_vertices() / 2);
+  }
+}
+
+TEST(simplify, batch)
+{
+  std::mt19937 rng(6);
+  std::vector<vgl_polygon<double> > polys;
+  std::vector<std::vector<vgl_point_2d<double> > > chains;
+  for (int i = 0; i < 50; ++i) {
+    polys.push_back(wobbly_ring(rng, 200 + i, 0.0, 0.0, 5.0, 0.5, true));
+    chains.push_back(polys.back()[0]);
+  }
+  std::vector<vgl_polygon<double> > out;
+  vgl_simplify_batch(polys, out, 0.3, vgl_simplify_douglas_peucker, true, 4);
+  ASSERT_EQ(out.size(), polys.size());
+  for (std::size_t i = 0; i < polys.size(); ++i) {
+    vgl_polygon<double> one = vgl_simplify(polys[i], 0.3, vgl_simplify_douglas_peucker, true);
+    EXPECT_EQ(out[i][0], one[0]);
+  }
+  std::vector<std::vector<vgl_point_2d<double> > > out_chains;
+  vgl_simplify_batch(chains, out_chains, 0.1, vgl_simplify_visvalingam, true, false, 3);
+  ASSERT_EQ(out_chains.size(), chains.size());
+  for (std::size_t i = 0; i < chains.size(); ++i)
+    EXPECT_EQ(out_chains[i], vgl_simplify(chains[i], 0.1, vgl_simplify_visvalingam, true));
+}
@@ -0,0 +1,125 @@
+// Some tests for vgl_triangulate
+#include <iostream>
+#include <vector>
+#include <random>
+#include <cmath>
+#include <vgl/vgl_point_2d.h>
+#include <vgl/vgl_polygon.h>
+#include <vgl/vgl_area.h>
+#include <vgl/vgl_predicates.h>
+#include <vgl/vgl_triangulate.h>
+
+#include <gtest/gtest.h>
+
+static std::vector<vgl_point_2d<double> > vertices(vgl_polygon<double> const& poly)
+{
+  std::vector<vgl_point_2d<double> > v;
+  for (unsigned s = 0; s < poly.num_sheets(); ++s)
+    v.insert(v.end(), poly[s].begin(), poly[s].end());
+  return v;
+}
+
+//: the triangles are counterclockwise, their area is that of the polygon and their centroids are inside it
+static void check_triangulation(vgl_polygon<double> const& poly, std::vector<unsigned> const& tri, double area)
+{
+  ASSERT_EQ(tri.size() % 3, 0u);
+  std::vector<vgl_point_2d<double> > v = vertices(poly);
+  double sum = 0.0;
+  for (std::size_t t = 0; t < tri.size(); t += 3) {
+    ASSERT_LT(tri[t + 2], v.size());
+    vgl_point_2d<double> const& a = v[tri[t]];
+    vgl_point_2d<double> const& b = v[tri[t + 1]];
+    vgl_point_2d<double> const& c = v[tri[t + 2]];
+    const double a2 = vgl_orient_2d(a, b, c);
+    EXPECT_GE(a2, 0.0);
+    sum += a2 / 2;
+    if (a2 > 1e-9 * area) {
+      EXPECT_TRUE(poly.contains((a.x() + b.x() + c.x()) / 3, (a.y() + b.y() + c.y()) / 3)) << "triangle " << t / 3;
+    }
+  }
+  EXPECT_NEAR(sum, area, 1e-9 * area);
+}
+
+TEST(triangulate, square_and_orientation)
+{
+  vgl_polygon<double> poly(1);
+  poly.push_back(0.0, 0.0); poly.push_back(2.0, 0.0); poly.push_back(2.0, 2.0); poly.push_back(0.0, 2.0);
+  std::vector<unsigned> tri = vgl_triangulate(poly);
+  EXPECT_EQ(tri.size(), 6u);
+  check_triangulation(poly, tri, 4.0);
+
+  // clockwise input, with a repeated vertex and collinear ones along the edges
+  vgl_polygon<double> cw(1);
+  cw.push_back(0.0, 0.0); cw.push_back(0.0, 1.0); cw.push_back(0.0, 2.0); cw.push_back(1.0, 2.0);
+  cw.push_back(2.0, 2.0); cw.push_back(2.0, 2.0); cw.push_back(2.0, 0.0); cw.push_back(1.0, 0.0);
+  vgl_triangulate(cw, tri);
+  check_triangulation(cw, tri, 4.0);
+
+  // degenerate sheets give nothing
+  vgl_polygon<double> flat(1);
+  flat.push_back(0.0, 0.0); flat.push_back(1.0, 1.0); flat.push_back(3.0, 3.0);
+  EXPECT_TRUE(vgl_triangulate(flat).empty());
+}
+
+TEST(triangulate, holes_and_islands)
+{
+  // a square, a hole in it and an island in the hole, and a second outer square
+  vgl_polygon<double> poly(1);
+  poly.push_back(0.0, 0.0); poly.push_back(10.0, 0.0); poly.push_back(10.0, 10.0); poly.push_back(0.0, 10.0);
+  poly.new_sheet();
+  poly.push_back(2.0, 2.0); poly.push_back(8.0, 2.0); poly.push_back(8.0, 8.0); poly.push_back(2.0, 8.0);
+  poly.new_sheet();
+  poly.push_back(4.0, 4.0); poly.push_back(6.0, 4.0); poly.push_back(6.0, 6.0); poly.push_back(4.0, 6.0);
+  poly.new_sheet();
+  poly.push_back(20.0, 0.0); poly.push_back(21.0, 0.0); poly.push_back(21.0, 1.0); poly.push_back(20.0, 1.0);
+  poly.new_sheet(); // a second hole, touching the first at a corner, clockwise
+  poly.push_back(8.0, 8.0); poly.push_back(8.0, 9.0); poly.push_back(9.0, 9.0); poly.push_back(9.0, 8.0);
+  std::vector<unsigned> tri = vgl_triangulate(poly);
+  check_triangulation(poly, tri, 100.0 - 36.0 + 4.0 + 1.0 - 1.0);
+  // the island is its own piece: every triangle with an island vertex has only island vertices
+  for (std::size_t t = 0; t < tri.size(); t += 3) {
+    const int n = (tri[t] >= 8 && tri[t] < 12) + (tri[t + 1] >= 8 && tri[t + 1] < 12) + (tri[t + 2] >= 8 && tri[t + 2] < 12);
+    EXPECT_TRUE(n == 0 || n == 3);
+  }
+}
+
+TEST(triangulate, near_collinear)
+{
+  // a comb whose teeth tips lie one ulp off a line, and a long almost straight edge
+  vgl_polygon<double> poly(1);
+  const int n = 200;
+  for (int i = 0; i <= n; ++i) {
+    const double x = i;
+    poly.push_back(x, i % 2 ? 1.0 : std::nextafter(1.0, 2.0));
+  }
+  poly.push_back(double(n), 0.0);
+  for (int i = n - 1; i > 0; --i)
+    poly.push_back(i + 0.5, i % 2 ? 0.0 : std::nextafter(0.0, 1.0));
+  poly.push_back(0.0, 0.0);
+  std::vector<unsigned> tri = vgl_triangulate(poly);
+  check_triangulation(poly, tri, std::abs(vgl_area_signed(poly)));
+}
+
+TEST(triangulate, large_random)
+{
+  // a star-shaped ring of 10000 vertices with 144 holes
+  std::mt19937 rng(11);
+  std::uniform_real_distribution<double> u(0.0, 1.0);
+  vgl_polygon<double> poly(1);
+  const int n = 10000;
+  for (int i = 0; i < n; ++i) {
+    const double a = 2 * 3.14159265358979 * i / n, r = 100.0 + 20.0 * u(rng);
+    poly.push_back(r * std::cos(a), r * std::sin(a));
+  }
+  double holes = 0.0;
+  for (int i = -6; i < 6; ++i)
+    for (int j = -6; j < 6; ++j) {
+      poly.new_sheet();
+      const double x = 10.0 * i + 2.0 + u(rng), y = 10.0 * j + 2.0 + u(rng);
+      poly.push_back(x, y); poly.push_back(x + 3.0 + u(rng), y); poly.push_back(x + 3.0, y + 4.0); poly.push_back(x, y + 2.0 + u(rng));
+      holes += std::abs(vgl_orient_2d(poly[poly.num_sheets() - 1])) / 2;
+    }
+  std::vector<unsigned> tri = vgl_triangulate(poly);
+  EXPECT_EQ(tri.size(), 3u * (poly.num_vertices() + 2 * (poly.num_sheets() - 1) - 2));
+  check_triangulation(poly, tri, std::abs(vgl_orient_2d(poly[0])) / 2 - holes);
+}
@@ -0,0 +1,106 @@
+// This is core/vnl/algo/tests/test_convolve.cxx
+#include <iostream>
+#include <chrono>
+
+#include <vnl/vnl_vector.h>
+#include <vnl/vnl_random.h>
+#include <vnl/algo/vnl_convolve.h>
+
+#include <gtest/gtest.h>
+
+static vnl_vector<double> random_vector(vnl_random& rng, int n)
+{
+    vnl_vector<double> v(n);
+    for (int i = 0; i < n; ++i)
+        v[i] = rng.drand64(-1.0, 1.0);
+    return v;
+}
+
+static vnl_vector<double> naive_convolve(vnl_vector<double> const& a, vnl_vector<double> const& b)
+{
+    const int n = int(a.size()), m = int(b.size());
+    vnl_vector<double> r(n + m - 1, 0.0);
+    for (int k = 0; k < n + m - 1; ++k)
+        for (int i = 0; i < n; ++i)
+            if (k - i >= 0 && k - i < m)
+                r[k] += a[i] * b[k - i];
+    return r;
+}
+
+TEST(vnl_convolve, direct_and_fft)
+{
+    vnl_random rng(2024);
+    const int sizes[][2] = { {1, 1}, {5, 3}, {3, 5}, {100, 7}, {257, 31}, {1000, 200}, {64, 64}, {3000, 40} };
+    for (auto const& s : sizes) {
+        vnl_vector<double> a = random_vector(rng, s[0]);
+        vnl_vector<double> b = random_vector(rng, s[1]);
+        vnl_vector<double> ref = naive_convolve(a, b);
+        const vnl_convolve_method methods[] = { vnl_convolve_direct, vnl_convolve_fft, vnl_convolve_auto };
+        for (vnl_convolve_method method : methods) {
+            vnl_vector<double> r = vnl_convolve(a, b, method);
+            ASSERT_EQ(r.size(), ref.size());
+            for (unsigned k = 0; k < r.size(); ++k)
+                ASSERT_NEAR(r[k], ref[k], 1e-10) << s[0] << " x " << s[1] << ", method " << method;
+        }
+    }
+    EXPECT_TRUE(vnl_convolve(vnl_vector<double>(), vnl_vector<double>(3, 1.0)).empty());
+}
+
+TEST(vnl_convolve, correlate)
+{
+    vnl_random rng(5);
+    vnl_vector<double> signal = random_vector(rng, 500);
+    vnl_vector<double> kernel = signal.extract(40, 123);
+
+    const vnl_convolve_method methods[] = { vnl_convolve_direct, vnl_convolve_fft };
+    for (vnl_convolve_method method : methods) {
+        vnl_vector<double> c = vnl_correlate(signal, kernel, method);
+        ASSERT_EQ(c.size(), signal.size() + kernel.size() - 1);
+        // the template matches at lag 123, i.e. at index 123 + kernel.size() - 1
+        unsigned best = 0;
+        for (unsigned k = 1; k < c.size(); ++k)
+            if (c[k] > c[best]) best = k;
+        EXPECT_EQ(best, 123u + kernel.size() - 1);
+        EXPECT_NEAR(c[best], kernel.squared_magnitude(), 1e-9);
+    }
+}
+
+TEST(vnl_convolve, cyclic)
+{
+    vnl_random rng(11);
+    const int n = 24;
+    vnl_vector<double> a = random_vector(rng, n);
+    vnl_vector<double> b = random_vector(rng, n);
+    vnl_vector<double> c = vnl_convolve_cyclic(a, b);
+    vnl_vector<double> x = vnl_convolve_cyclic(a, b, true);
+    ASSERT_EQ(int(c.size()), n);
+    for (int k = 0; k < n; ++k) {
+        double conv = 0.0, xcorr = 0.0;
+        for (int i = 0; i < n; ++i) {
+            conv += a[i] * b[(k - i + n) % n];
+            xcorr += a[(i + k) % n] * b[i];
+        }
+        ASSERT_NEAR(c[k], conv, 1e-10);
+        ASSERT_NEAR(x[k], xcorr, 1e-10);
+    }
+}
+
+TEST(vnl_convolve, speed)
+{
+    vnl_random rng(3);
+    const int kernels[] = { 8, 32, 128, 512 };
+    vnl_vector<double> a = random_vector(rng, 1 << 15);
+    for (int m : kernels) {
+        vnl_vector<double> b = random_vector(rng, m);
+        double t[2];
+        const vnl_convolve_method methods[] = { vnl_convolve_direct, vnl_convolve_fft };
+        for (int i = 0; i < 2; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            vnl_vector<double> r = vnl_convolve(a, b, methods[i]);
+            t[i] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+        std::cout << "n = " << a.size() << ", m = " << m << ": direct " << t[0] << " ms, fft " << t[1]
+                  << " ms, auto picks " << (vnl_convolve_detail::prefer_fft(int(a.size()), m) ? "fft" : "direct")
+                  << std::endl;
+    }
+}
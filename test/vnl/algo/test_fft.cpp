@@ -0,0 +1,148 @@
+// This is core/vnl/algo/tests/test_fft.cxx
+#include <iostream>
+#include <complex>
+#include <cmath>
+
+#include <vnl/vnl_vector.h>
+#include <vnl/vnl_matrix.h>
+#include <vnl/vnl_random.h>
+#include <vnl/algo/vnl_fft_1d.h>
+#include <vnl/algo/vnl_fft_2d.h>
+
+#include <gtest/gtest.h>
+
+typedef std::complex<double> complex_t;
+
+//: O(N^2) reference DFT
+static vnl_vector<complex_t> naive_dft(vnl_vector<complex_t> const& x, int dir)
+{
+    const int N = int(x.size());
+    const double pi = 3.14159265358979323846;
+    vnl_vector<complex_t> X(N);
+    for (int k = 0; k < N; ++k) {
+        complex_t acc(0.0, 0.0);
+        for (int n = 0; n < N; ++n)
+            acc += x[n] * std::polar(1.0, -dir * 2.0 * pi * double(k) * double(n) / N);
+        X[k] = acc;
+    }
+    return X;
+}
+
+static vnl_vector<complex_t> random_signal(vnl_random& rng, int N)
+{
+    vnl_vector<complex_t> x(N);
+    for (int i = 0; i < N; ++i)
+        x[i] = complex_t(rng.drand64(-1.0, 1.0), rng.drand64(-1.0, 1.0));
+    return x;
+}
+
+TEST(vnl_fft_1d, against_dft)
+{
+    vnl_random rng(1234);
+    const int sizes[] = { 1, 2, 3, 8, 12, 17, 64, 100 };
+    for (int N : sizes) {
+        vnl_fft_1d<double> fft(N);
+        EXPECT_EQ(fft.size(), N);
+        vnl_vector<complex_t> x = random_signal(rng, N);
+        vnl_vector<complex_t> X = x;
+        fft.fwd_transform(X);
+        vnl_vector<complex_t> ref = naive_dft(x, +1);
+        for (int k = 0; k < N; ++k)
+            ASSERT_NEAR(std::abs(X[k] - ref[k]), 0.0, 1e-10) << "N = " << N << ", k = " << k;
+
+        // backward transform is unscaled
+        fft.bwd_transform(X);
+        for (int k = 0; k < N; ++k)
+            ASSERT_NEAR(std::abs(X[k] - double(N) * x[k]), 0.0, 1e-10) << "N = " << N;
+    }
+}
+
+TEST(vnl_fft_1d, real_signal)
+{
+    vnl_random rng(42);
+    const int sizes[] = { 2, 7, 16, 30 };
+    for (int N : sizes) {
+        vnl_fft_1d<double> fft(N);
+        vnl_vector<double> x(N);
+        vnl_vector<complex_t> xc(N);
+        for (int i = 0; i < N; ++i) {
+            x[i] = rng.drand64(-1.0, 1.0);
+            xc[i] = x[i];
+        }
+        vnl_vector<complex_t> half;
+        fft.fwd_transform(x, half);
+        ASSERT_EQ(int(half.size()), N/2 + 1);
+        vnl_vector<complex_t> ref = naive_dft(xc, +1);
+        for (int k = 0; k <= N/2; ++k)
+            ASSERT_NEAR(std::abs(half[k] - ref[k]), 0.0, 1e-10) << "N = " << N;
+
+        vnl_vector<double> y;
+        fft.bwd_transform(half, y);
+        ASSERT_EQ(int(y.size()), N);
+        for (int i = 0; i < N; ++i)
+            ASSERT_NEAR(y[i], double(N) * x[i], 1e-10) << "N = " << N;
+    }
+}
+
+TEST(vnl_fft_2d, round_trip)
+{
+    vnl_random rng(7);
+    const int M = 6, N = 10;
+    vnl_matrix<complex_t> x(M, N);
+    for (int r = 0; r < M; ++r)
+        for (int c = 0; c < N; ++c)
+            x(r, c) = complex_t(rng.drand64(-1.0, 1.0), rng.drand64(-1.0, 1.0));
+
+    vnl_fft_2d<double> fft(M, N);
+    EXPECT_EQ(fft.rows(), M);
+    EXPECT_EQ(fft.cols(), N);
+
+    vnl_matrix<complex_t> X = x;
+    fft.fwd_transform(X);
+
+    // separable reference: DFT of the rows, then of the columns
+    vnl_matrix<complex_t> ref(M, N);
+    for (int r = 0; r < M; ++r) {
+        vnl_vector<complex_t> row(N);
+        for (int c = 0; c < N; ++c) row[c] = x(r, c);
+        row = naive_dft(row, +1);
+        for (int c = 0; c < N; ++c) ref(r, c) = row[c];
+    }
+    for (int c = 0; c < N; ++c) {
+        vnl_vector<complex_t> col(M);
+        for (int r = 0; r < M; ++r) col[r] = ref(r, c);
+        col = naive_dft(col, +1);
+        for (int r = 0; r < M; ++r) ref(r, c) = col[r];
+    }
+    for (int r = 0; r < M; ++r)
+        for (int c = 0; c < N; ++c)
+            ASSERT_NEAR(std::abs(X(r, c) - ref(r, c)), 0.0, 1e-10);
+
+    fft.bwd_transform(X);
+    for (int r = 0; r < M; ++r)
+        for (int c = 0; c < N; ++c)
+            ASSERT_NEAR(std::abs(X(r, c) - double(M * N) * x(r, c)), 0.0, 1e-10);
+}
+
+TEST(vnl_fft_2d, real_signal)
+{
+    vnl_random rng(99);
+    const int M = 5, N = 8;
+    vnl_matrix<double> x(M, N);
+    vnl_matrix<complex_t> xc(M, N);
+    for (int r = 0; r < M; ++r)
+        for (int c = 0; c < N; ++c) {
+            x(r, c) = rng.drand64(-1.0, 1.0);
+            xc(r, c) = x(r, c);
+        }
+
+    vnl_fft_2d<double> fft(M, N);
+    vnl_matrix<complex_t> X;
+    fft.fwd_transform(x, X);
+    fft.fwd_transform(xc);
+    ASSERT_EQ(int(X.rows()), M);
+    ASSERT_EQ(int(X.cols()), N);
+    for (int r = 0; r < M; ++r)
+        for (int c = 0; c < N; ++c)
+            ASSERT_NEAR(std::abs(X(r, c) - xc(r, c)), 0.0, 1e-10);
+}
@@ -1,6 +1,7 @@
 // This is core/vnl/algo/tests/test_qr.cxx
 #include <iostream>
 #include <complex>
+#include <algorithm>
 
 #include <vnl/vnl_matrix.h>
 #include <vnl/vnl_random.h>
@@ -217,3 +218,145 @@ TEST(vnl_qr, test_qr)
   new_test((std::complex<double> *)nullptr);
 }
 
+
+TEST(vnl_qr, pivoting_and_rank)
+{
+  vnl_random rng(77);
+  // 8x5 matrix of rank 3
+  vnl_matrix<double> B(8, 3), C(3, 5);
+  test_util_fill_random(B.begin(), B.end(), rng);
+  test_util_fill_random(C.begin(), C.end(), rng);
+  vnl_matrix<double> A = B * C;
+
+  vnl_qr<double> qr(A, true);
+  EXPECT_TRUE(qr.pivoting());
+  EXPECT_EQ(qr.rank(), 3u);
+  ASSERT_NEAR((qr.recompose() - A).fro_norm(), 0.0, 1e-12) << "||A - QRP'||\n";
+  vnl_matrix<double> const& R = qr.R();
+  for (unsigned i = 1; i < 5; ++i)
+    EXPECT_LE(std::abs(R(i, i)), std::abs(R(i-1, i-1)) + 1e-12) << "pivots are non-increasing\n";
+  std::vector<int> p = qr.permutation();
+  std::vector<int> sorted(p);
+  std::sort(sorted.begin(), sorted.end());
+  for (int k = 0; k < 5; ++k)
+    EXPECT_EQ(sorted[k], k);
+
+  // b in the range of A: the basic solution solves the system exactly
+  vnl_vector<double> x0(5);
+  test_util_fill_random(x0.begin(), x0.end(), rng);
+  vnl_vector<double> b = A * x0;
+  vnl_vector<double> x = qr.solve(b);
+  ASSERT_NEAR((A * x - b).two_norm(), 0.0, 1e-10) << "||Ax - b||, rank deficient\n";
+
+  // determinant agrees with the unpivoted factorisation
+  vnl_matrix<double> S(4, 4);
+  test_util_fill_random(S.begin(), S.end(), rng);
+  ASSERT_NEAR(vnl_qr<double>(S, true).determinant(), vnl_qr<double>(S).determinant(), 1e-12);
+}
+
+TEST(vnl_qr, multiple_rhs_and_inverse)
+{
+  vnl_random rng(78);
+  const unsigned m = 120, n = 60, k = 7;
+  vnl_matrix<double> A(m, n), B(m, k);
+  test_util_fill_random(A.begin(), A.end(), rng);
+  test_util_fill_random(B.begin(), B.end(), rng);
+
+  vnl_qr<double> qr(A);
+  vnl_matrix<double> X = qr.solve(B);
+  ASSERT_EQ(X.rows(), n);
+  ASSERT_EQ(X.cols(), k);
+  for (unsigned c = 0; c < k; ++c) {
+    vnl_vector<double> x = qr.solve(B.get_column(c));
+    for (unsigned r = 0; r < n; ++r)
+      ASSERT_NEAR(X(r, c), x[r], 1e-10);
+  }
+
+  vnl_matrix<double> S(n, n);
+  test_util_fill_random(S.begin(), S.end(), rng);
+  vnl_qr<double> qs(S);
+  vnl_matrix<double> I(n, n);
+  I.set_identity();
+  ASSERT_NEAR((qs.inverse() * S - I).fro_norm(), 0.0, 1e-9) << "inverse\n";
+  ASSERT_NEAR((qs.tinverse() - qs.inverse().transpose()).fro_norm(), 0.0, 1e-12) << "tinverse\n";
+}
+
+TEST(vnl_qr, in_place)
+{
+  vnl_random rng(79);
+  vnl_matrix<double> A(6, 4);
+  test_util_fill_random(A.begin(), A.end(), rng);
+  vnl_vector<double> b(6);
+  test_util_fill_random(b.begin(), b.end(), rng);
+
+  vnl_qr<double> copied(A);
+  vnl_matrix<double> storage(A);
+  double const* data = storage.data_block();
+  vnl_qr<double> in_place(&storage);
+  EXPECT_EQ(storage.data_block(), data);
+  ASSERT_NEAR((in_place.R() - copied.R()).fro_norm(), 0.0, 1e-14) << "R\n";
+  ASSERT_NEAR((in_place.solve(b) - copied.solve(b)).two_norm(), 0.0, 1e-14) << "solve\n";
+  // the caller's matrix now holds R in its upper triangle
+  ASSERT_NEAR(storage(0, 3), copied.R()(0, 3), 1e-14);
+}
+
+template <class T>
+static void
+test_update_downdate(T *)
+{
+  using abs_t = typename vnl_numeric_traits<T>::abs_t;
+  vnl_random rng(80);
+  const unsigned n = 4, m0 = 6, extra = 5;
+  vnl_matrix<T> A(m0 + extra, n);
+  vnl_vector<T> b(m0 + extra);
+  test_util_fill_random(A.begin(), A.end(), rng);
+  test_util_fill_random(b.begin(), b.end(), rng);
+
+  const bool pivots[] = { false, true };
+  for (bool pivot : pivots) {
+    vnl_qr<T> qr(A.extract(m0, n), pivot);
+    qr.set_rhs(b.extract(m0));
+    for (unsigned i = m0; i < m0 + extra; ++i) {
+      qr.add_row(A.get_row(i), b[i]);
+      ASSERT_EQ(qr.rows(), i + 1);
+      // same least squares solution as refactorising the grown system
+      vnl_qr<T> fresh(A.extract(i + 1, n));
+      vnl_vector<T> bi = b.extract(i + 1);
+      vnl_vector<T> x = fresh.solve(bi);
+      ASSERT_NEAR((qr.solution() - x).two_norm(), 0, 1e-10) << "add_row " << i << "\n";
+      ASSERT_NEAR(qr.residual_norm(), (A.extract(i + 1, n) * x - bi).two_norm(), 1e-10);
+    }
+    // remove the appended rows again, newest first
+    for (unsigned i = m0 + extra - 1; i >= m0; --i) {
+      ASSERT_TRUE(qr.remove_row(A.get_row(i), b[i])) << "remove_row " << i << "\n";
+      vnl_qr<T> fresh(A.extract(i, n));
+      vnl_vector<T> x = fresh.solve(b.extract(i));
+      ASSERT_NEAR((qr.solution() - x).two_norm(), 0, 1e-9) << "remove_row " << i << "\n";
+    }
+    // R'R = A'A for the original rows (R is unique up to row phases)
+    vnl_matrix<T> R = qr.R().extract(n, n);
+    vnl_matrix<T> A0 = A.extract(m0, n);
+    vnl_matrix<T> RtR = R.conjugate_transpose() * R;
+    vnl_matrix<T> AtA = A0.conjugate_transpose() * A0;
+    if (pivot) {
+      std::vector<int> p = qr.permutation();
+      vnl_matrix<T> AtAp(n, n);
+      for (unsigned i = 0; i < n; ++i)
+        for (unsigned j = 0; j < n; ++j)
+          AtAp(i, j) = AtA(p[i], p[j]);
+      AtA = AtAp;
+    }
+    ASSERT_NEAR(abs_t((RtR - AtA).fro_norm()), 0, 1e-10) << "R'R\n";
+  }
+
+  // a row that was never part of the system cannot be removed
+  vnl_qr<T> qr(A.extract(n, n));
+  vnl_vector<T> big(n, T(100));
+  EXPECT_FALSE(qr.remove_row(big));
+}
+
+TEST(vnl_qr, update_downdate)
+{
+  test_update_downdate((double *)nullptr);
+  test_update_downdate((std::complex<double> *)nullptr);
+}
@@ -0,0 +1,161 @@
+// This is core/vnl/algo/tests/test_real_polynomial_roots.cxx
+// Eigen asserts on any heap allocation while malloc is disallowed
+#define EIGEN_RUNTIME_NO_MALLOC
+#include <iostream>
+#include <vector>
+#include <algorithm>
+
+#include <vnl/vnl_real_polynomial.h>
+#include <vnl/vnl_random.h>
+#include <vnl/algo/vnl_real_polynomial_roots.h>
+
+#include <gtest/gtest.h>
+
+//: polynomial with the given (real) roots, leading coefficient lead
+static vnl_real_polynomial
+poly_from_roots(std::vector<double> const& r, double lead = 1.0)
+{
+    vnl_real_polynomial p(lead);
+    for (double x : r) {
+        double c[] = { 1.0, -x };
+        p *= vnl_real_polynomial(c, 2);
+    }
+    return p;
+}
+
+static void
+expect_roots(char const* name, int n, double const* roots, std::vector<double> expected, double tol)
+{
+    std::sort(expected.begin(), expected.end());
+    ASSERT_EQ(n, int(expected.size())) << name;
+    for (int i = 0; i < n; ++i)
+        ASSERT_NEAR(roots[i], expected[i], tol) << name << " root " << i;
+}
+
+TEST(vnl_real_polynomial_roots, quadratic)
+{
+    double r[2];
+    expect_roots("x^2-3x+2", vnl_solve_quadratic(1, -3, 2, r), r, {1, 2}, 1e-14);
+    expect_roots("x^2+1", vnl_solve_quadratic(1, 0, 1, r), r, {}, 0);
+    expect_roots("(x-3)^2", vnl_solve_quadratic(1, -6, 9, r), r, {3}, 1e-14);
+    expect_roots("linear", vnl_solve_quadratic(0, 2, -1, r), r, {0.5}, 1e-14);
+    // cancellation-prone: roots 1e-8 and 1e8
+    expect_roots("wide", vnl_solve_quadratic(1, -(1e8 + 1e-8), 1, r), r, {1e-8, 1e8}, 1e-20);
+    ASSERT_NEAR(r[1], 1e8, 1e-6);
+}
+
+TEST(vnl_real_polynomial_roots, cubic)
+{
+    double r[3];
+    expect_roots("three", vnl_solve_cubic(2, -12, 22, -12, r), r, {1, 2, 3}, 1e-12);
+    expect_roots("one", vnl_solve_cubic(1, 0, 1, 10, r), r, {-2}, 1e-12);
+    expect_roots("double", vnl_solve_cubic(1, -4, 5, -2, r), r, {1, 2}, 1e-7);
+    expect_roots("triple", vnl_solve_cubic(1, -3, 3, -1, r), r, {1}, 1e-5);
+    expect_roots("zero root", vnl_solve_cubic(1, -1, -2, 0, r), r, {-1, 0, 2}, 1e-12);
+}
+
+TEST(vnl_real_polynomial_roots, quartic)
+{
+    double r[4];
+    vnl_real_polynomial p = poly_from_roots({-2, 0.5, 1, 3});
+    expect_roots("four", vnl_solve_quartic(p[0], p[1], p[2], p[3], p[4], r), r, {-2, 0.5, 1, 3}, 1e-12);
+
+    // (x^2+1)(x-1)(x+4)
+    double c_x2p1[] = { 1, 0, 1 };
+    p = poly_from_roots({1, -4}) * vnl_real_polynomial(c_x2p1, 3);
+    expect_roots("two", vnl_solve_quartic(p[0], p[1], p[2], p[3], p[4], r), r, {-4, 1}, 1e-12);
+
+    // (x^2+1)(x^2+4)
+    double c_x2p4[] = { 1, 0, 4 };
+    p = vnl_real_polynomial(c_x2p1, 3) * vnl_real_polynomial(c_x2p4, 3);
+    expect_roots("none", vnl_solve_quartic(p[0], p[1], p[2], p[3], p[4], r), r, {}, 0);
+
+    // biquadratic x^4 - 5x^2 + 4
+    expect_roots("biquadratic", vnl_solve_quartic(1, 0, -5, 0, 4, r), r, {-2, -1, 1, 2}, 1e-12);
+
+    // double roots
+    p = poly_from_roots({1, 1, 2, 3});
+    expect_roots("double", vnl_solve_quartic(p[0], p[1], p[2], p[3], p[4], r), r, {1, 2, 3}, 1e-7);
+    p = poly_from_roots({-1, -1, 2, 2}, 3.0);
+    expect_roots("two doubles", vnl_solve_quartic(p[0], p[1], p[2], p[3], p[4], r), r, {-1, 2}, 1e-7);
+}
+
+TEST(vnl_real_polynomial_roots, sturm_and_companion)
+{
+    std::vector<double> expected = { -3.5, -1.25, -0.5, 0.1, 0.7, 2.0, 4.5 };
+    vnl_real_polynomial p = poly_from_roots(expected, -2.0);
+    double c[] = { 1, 0, 1 };
+    p *= vnl_real_polynomial(c, 3); // add a complex pair, degree 9
+
+    double r[vnl_real_polynomial_roots_max_degree];
+    expect_roots("automatic", vnl_real_polynomial_real_roots(p, r), r, expected, 1e-10);
+    expect_roots("sturm", vnl_real_polynomial_sturm_roots(p.coefficients().data_block(), p.degree(), -1e3, 1e3, r),
+                 r, expected, 1e-10);
+    expect_roots("companion", vnl_real_polynomial_companion_roots(p.coefficients().data_block(), p.degree(), r),
+                 r, expected, 1e-8);
+
+    // restricted to an interval, as for positive depths
+    expect_roots("positive", vnl_real_polynomial_real_roots(p, 0.0, 1e3, r), r, {0.1, 0.7, 2.0, 4.5}, 1e-10);
+    expect_roots("(0.5,2.5]", vnl_real_polynomial_real_roots(p, 0.5, 2.5, r), r, {0.7, 2.0}, 1e-10);
+
+    // multiple roots: the Sturm chain ends in gcd(p, p')
+    vnl_real_polynomial q = poly_from_roots({-1, 0.5, 0.5, 2, 2, 2, 3});
+    expect_roots("multiple", vnl_real_polynomial_real_roots(q, r), r, {-1, 0.5, 2, 3}, 1e-4);
+
+    // leading zeros and roots at the origin are stripped
+    double z[] = { 0, 0, 1, -6, 11, -6, 0, 0 };
+    expect_roots("zeros", vnl_real_polynomial_real_roots(z, 7, r), r, {0, 1, 2, 3}, 1e-12);
+    double zero[] = { 0, 0, 0 };
+    EXPECT_EQ(vnl_real_polynomial_real_roots(zero, 2, r), -1);
+    double constant[] = { 0, 0, 3 };
+    EXPECT_EQ(vnl_real_polynomial_real_roots(constant, 2, r), 0);
+}
+
+TEST(vnl_real_polynomial_roots, random)
+{
+    // degree-10 polynomials, as produced by the five-point relative pose solver
+    vnl_random rng(9667566ul);
+    double r1[vnl_real_polynomial_roots_max_degree], r2[vnl_real_polynomial_roots_max_degree];
+    for (int trial = 0; trial < 200; ++trial) {
+        std::vector<double> expected;
+        int nreal = trial % 11;
+        for (int i = 0; i < nreal; ++i)
+            expected.push_back(rng.drand64(-10.0, 10.0));
+        vnl_real_polynomial p = poly_from_roots(expected, rng.drand64(0.5, 2.0));
+        for (int i = nreal; i + 1 < 10; i += 2) {
+            double re = rng.drand64(-5.0, 5.0), im = rng.drand64(0.5, 3.0);
+            double c[] = { 1.0, -2.0 * re, re * re + im * im };
+            p *= vnl_real_polynomial(c, 3);
+        }
+        std::sort(expected.begin(), expected.end());
+        // skip draws with nearly coincident roots, which are merged by design
+        bool separated = true;
+        for (size_t i = 1; i < expected.size(); ++i)
+            separated = separated && expected[i] - expected[i-1] > 1e-3;
+        if (!separated) continue;
+
+        int n1 = vnl_real_polynomial_real_roots(p, r1);
+        int n2 = vnl_real_polynomial_companion_roots(p.coefficients().data_block(), p.degree(), r2);
+        ASSERT_EQ(n1, int(expected.size())) << "trial " << trial;
+        ASSERT_EQ(n2, int(expected.size())) << "trial " << trial;
+        for (int i = 0; i < n1; ++i) {
+            ASSERT_NEAR(r1[i], expected[i], 1e-6 * (1.0 + std::abs(expected[i]))) << "trial " << trial;
+            ASSERT_NEAR(r2[i], expected[i], 1e-6 * (1.0 + std::abs(expected[i]))) << "trial " << trial;
+        }
+    }
+}
+
+TEST(vnl_real_polynomial_roots, allocation_free)
+{
+    double c[] = { 1.44399, 2.68113, -40.2745, -11.7577, 287.241, -682.345,
+                   -1579.69, 1348.64, -30063.2, -3959.53, -174195 };
+    double r[10];
+    Eigen::internal::set_is_malloc_allowed(false);
+    int n1 = vnl_real_polynomial_real_roots(c, 10, r);
+    int n2 = vnl_real_polynomial_companion_roots(c, 10, r);
+    int n3 = vnl_solve_quartic(1, 0, -5, 0, 4, r);
+    Eigen::internal::set_is_malloc_allowed(true);
+    EXPECT_EQ(n1, 2);
+    EXPECT_EQ(n2, 2);
+    EXPECT_EQ(n3, 4);
+}
@@ -229,3 +229,39 @@ TEST(vnl_svd, nullvector)
     test_nullvector("std::complex<double>", 5e-15, (std::complex<double> *)nullptr, rng);
 }
 
+
+TEST(vnl_svd, tall_matrix_products)
+{
+  vnl_random rng(1234);
+  const unsigned m = 20, n = 4;
+  vnl_matrix<double> A(m, n);
+  test_util_fill_random(A.begin(), A.end(), rng);
+  vnl_svd<double> svd(A);
+
+  // pinverse is a left inverse of a full-rank tall matrix
+  vnl_matrix<double> I(n, n, 0.0);
+  I.fill_diagonal(1.0);
+  ASSERT_NEAR((svd.pinverse() * A - I).fro_norm(), 0, 1e-12) << "pinverse\n";
+  ASSERT_NEAR((svd.tinverse() - svd.pinverse().transpose()).fro_norm(), 0, 1e-12) << "tinverse\n";
+
+  // rank-2 recomposition against the dense expansion of W
+  vnl_matrix<double> W2(n, n, 0.0);
+  W2(0, 0) = svd.W(0);
+  W2(1, 1) = svd.W(1);
+  vnl_matrix<double> A2 = svd.U() * W2 * svd.V().transpose();
+  ASSERT_NEAR((svd.recompose(2) - A2).fro_norm(), 0, 1e-12) << "recompose(2)\n";
+
+  // matrix right hand side gives the same as solving column by column
+  vnl_matrix<double> B(m, 3);
+  test_util_fill_random(B.begin(), B.end(), rng);
+  vnl_matrix<double> X = svd.solve(B);
+  ASSERT_EQ(X.rows(), n);
+  ASSERT_EQ(X.cols(), 3u);
+  for (unsigned c = 0; c < 3; ++c) {
+    vnl_vector<double> b(m);
+    for (unsigned r = 0; r < m; ++r) b[r] = B(r, c);
+    vnl_vector<double> x = svd.solve(b);
+    for (unsigned r = 0; r < n; ++r)
+      ASSERT_NEAR(X(r, c), x[r], 1e-12) << "solve(matrix)\n";
+  }
+}
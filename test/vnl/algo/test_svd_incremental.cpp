@@ -0,0 +1,156 @@
+// This is core/vnl/algo/tests/test_svd_incremental.cxx
+#include <iostream>
+#include <complex>
+
+#include <vnl/vnl_matrix.h>
+#include <vnl/vnl_random.h>
+#include <vnl/algo/vnl_svd.h>
+#include <vnl/algo/vnl_svd_incremental.h>
+
+#include <gtest/gtest.h>
+
+template <typename T>
+static
+void fill_random(T * b, T * e, vnl_random & rng)
+{
+    for (T * p = b; p < e; ++p)
+        *p = (T)rng.drand64(-1.0, +1.0);
+}
+
+template <typename T>
+static
+void fill_random(std::complex<T> * b, std::complex<T> * e, vnl_random & rng)
+{
+    for (std::complex<T> * p = b; p < e; ++p)
+        *p = std::complex<T>((T)rng.drand64(-1.0, +1.0), (T)rng.drand64(-1.0, +1.0));
+}
+
+template <class T>
+static void
+test_add_rows(T *)
+{
+    using abs_t = typename vnl_numeric_traits<T>::abs_t;
+    vnl_random rng(31);
+    const unsigned m = 40, n = 6;
+    vnl_matrix<T> A(m, n);
+    vnl_vector<T> b(m);
+    fill_random(A.begin(), A.end(), rng);
+    fill_random(b.begin(), b.end(), rng);
+
+    vnl_svd_incremental<T> inc(n);
+    vnl_svd_incremental<T> lean(n, 0, false);
+    inc.set_reorthogonalize_interval(7);
+    for (unsigned i = 0; i < m; ++i) {
+        inc.add_row(A.get_row(i), b[i]);
+        lean.add_row(A.get_row(i), b[i]);
+        ASSERT_EQ(inc.rows(), i + 1);
+        ASSERT_EQ(inc.size(), std::min(i + 1, n));
+    }
+
+    vnl_svd<T> svd(A);
+    for (unsigned i = 0; i < n; ++i)
+        ASSERT_NEAR(inc.W()[i], svd.W(i), 1e-10) << "singular value " << i << '\n';
+    ASSERT_NEAR(abs_t((inc.recompose() - A).fro_norm()), 0, 1e-10) << "U W V' = A\n";
+    vnl_matrix<T> I(n, n);
+    I.set_identity();
+    ASSERT_NEAR(abs_t((inc.V().conjugate_transpose() * inc.V() - I).fro_norm()), 0, 1e-12) << "V'V = I\n";
+    ASSERT_NEAR(abs_t((inc.U().conjugate_transpose() * inc.U() - I).fro_norm()), 0, 1e-12) << "U'U = I\n";
+
+    vnl_vector<T> x = svd.solve(b);
+    ASSERT_NEAR(abs_t((inc.solution() - x).two_norm()), 0, 1e-10) << "tracked solution\n";
+    ASSERT_NEAR(abs_t((inc.solve(b) - x).two_norm()), 0, 1e-10) << "solve\n";
+    ASSERT_NEAR(abs_t((lean.solution() - x).two_norm()), 0, 1e-10) << "solution without U\n";
+    ASSERT_NEAR(abs_t((inc.pinverse() - svd.pinverse()).fro_norm()), 0, 1e-10) << "pinverse\n";
+
+    // the nullvector is the right singular vector of the smallest singular value
+    ASSERT_NEAR(abs_t((A * lean.nullvector()).two_norm()), svd.sigma_min(), 1e-10) << "nullvector\n";
+}
+
+TEST(vnl_svd_incremental, add_rows)
+{
+    test_add_rows((double *)nullptr);
+    test_add_rows((std::complex<double> *)nullptr);
+}
+
+TEST(vnl_svd_incremental, nullvector)
+{
+    // homogeneous points on the plane x + 2y - z = 3
+    vnl_random rng(32);
+    vnl_svd_incremental<double> inc(4);
+    vnl_vector<double> a(4);
+    a[0] = 1; a[1] = 2; a[2] = -1; a[3] = -3;
+    // before enough rows are seen the nullspace comes from the complement of V
+    vnl_vector<double> v(4);
+    for (int i = 0; i < 2; ++i) {
+        v[0] = rng.drand64(-1, 1); v[1] = rng.drand64(-1, 1);
+        v[2] = v[0] + 2 * v[1] - 3; v[3] = 1;
+        inc.add_row(v);
+    }
+    EXPECT_EQ(inc.rank(), 2u);
+    vnl_matrix<double> N = inc.nullspace();
+    ASSERT_EQ(N.cols(), 2u);
+    ASSERT_NEAR((inc.V().transpose() * N).fro_norm(), 0, 1e-12);
+    for (int i = 0; i < 20; ++i) {
+        v[0] = rng.drand64(-1, 1); v[1] = rng.drand64(-1, 1);
+        v[2] = v[0] + 2 * v[1] - 3; v[3] = 1;
+        inc.add_row(v);
+    }
+    EXPECT_EQ(inc.rank(), 3u);
+    vnl_vector<double> p = inc.nullvector();
+    p /= p[0];
+    ASSERT_NEAR((p - a).two_norm(), 0, 1e-10) << "plane from nullvector\n";
+}
+
+TEST(vnl_svd_incremental, rank_one_update)
+{
+    vnl_random rng(33);
+    const unsigned m = 12, n = 5;
+    vnl_matrix<double> A(m, n);
+    fill_random(A.begin(), A.end(), rng);
+    vnl_svd_incremental<double> inc(A);
+    for (int k = 0; k < 4; ++k) {
+        vnl_vector<double> x(m), y(n);
+        fill_random(x.begin(), x.end(), rng);
+        fill_random(y.begin(), y.end(), rng);
+        inc.update(x, y);
+        A += outer_product(x, y);
+        ASSERT_NEAR((inc.recompose() - A).fro_norm(), 0, 1e-10) << "update " << k << '\n';
+    }
+    vnl_svd<double> svd(A);
+    for (unsigned i = 0; i < n; ++i)
+        ASSERT_NEAR(inc.W()[i], svd.W(i), 1e-10);
+
+    // a rank-one matrix starting from zero
+    vnl_svd_incremental<double> z(vnl_matrix<double>(m, n, 0.0));
+    vnl_vector<double> x(m, 1.0), y(n, 2.0);
+    z.update(x, y);
+    EXPECT_EQ(z.rank(), 1u);
+    ASSERT_NEAR(z.sigma_max(), x.two_norm() * y.two_norm(), 1e-12);
+}
+
+TEST(vnl_svd_incremental, truncation)
+{
+    vnl_random rng(34);
+    // 30 x 8 matrix of rank 3: a rank 3 factorisation is exact
+    vnl_matrix<double> B(30, 3), C(3, 8);
+    fill_random(B.begin(), B.end(), rng);
+    fill_random(C.begin(), C.end(), rng);
+    vnl_matrix<double> A = B * C;
+
+    vnl_svd_incremental<double> inc(8, 3);
+    inc.add_rows(A);
+    EXPECT_EQ(inc.size(), 3u);
+    ASSERT_NEAR((inc.recompose() - A).fro_norm(), 0, 1e-10);
+
+    // truncate() keeps the dominant part of a full factorisation
+    vnl_matrix<double> M(20, 6);
+    fill_random(M.begin(), M.end(), rng);
+    vnl_svd_incremental<double> full(6);
+    full.add_rows(M);
+    full.truncate(2);
+    EXPECT_EQ(full.size(), 2u);
+    vnl_svd<double> svd(M);
+    ASSERT_NEAR((full.recompose() - svd.recompose(2)).fro_norm(), 0, 1e-10);
+    full.add_row(M.get_row(0));
+    EXPECT_EQ(full.size(), 2u);
+}
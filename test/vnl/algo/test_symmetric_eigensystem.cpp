@@ -0,0 +1,82 @@
+// This is core/vnl/algo/tests/test_symmetric_eigensystem.cxx
+#include <iostream>
+#include <cmath>
+
+#include <vnl/vnl_matrix_fixed.h>
+#include <vnl/vnl_vector_fixed.h>
+#include <vnl/vnl_random.h>
+#include <vnl/algo/vnl_symmetric_eigensystem.h>
+
+#include <gtest/gtest.h>
+
+TEST(vnl_symmetric_eigensystem, fixed)
+{
+  vnl_random rng(9667566);
+  for (unsigned trial = 0; trial < 20; ++trial) {
+    vnl_matrix_fixed<double, 4, 4> A;
+    for (unsigned r = 0; r < 4; ++r)
+      for (unsigned c = 0; c <= r; ++c)
+        A[r][c] = A[c][r] = rng.drand64(-1.0, 1.0);
+    vnl_matrix_fixed<double, 4, 4> V;
+    vnl_vector_fixed<double, 4> D;
+    ASSERT_TRUE(vnl_symmetric_eigensystem_compute(A, V, D));
+    for (unsigned i = 0; i < 4; ++i) {
+      if (i > 0) {
+        EXPECT_LE(D[i - 1], D[i]);
+      }
+      // A v = d v for the columns of V, which are orthonormal
+      for (unsigned r = 0; r < 4; ++r) {
+        double av = 0.0;
+        for (unsigned c = 0; c < 4; ++c)
+          av += A[r][c] * V[c][i];
+        EXPECT_NEAR(av, D[i] * V[r][i], 1e-12);
+      }
+      for (unsigned j = 0; j < 4; ++j) {
+        double dot = 0.0;
+        for (unsigned r = 0; r < 4; ++r)
+          dot += V[r][i] * V[r][j];
+        EXPECT_NEAR(dot, i == j ? 1.0 : 0.0, 1e-12);
+      }
+    }
+  }
+}
+
+TEST(vnl_symmetric_eigensystem, eigenvals_3x3)
+{
+  // diag(1, 2, 3) rotated about z
+  const double c = std::cos(0.3), s = std::sin(0.3);
+  const double M11 = c * c * 1 + s * s * 2, M12 = c * s * (2 - 1), M22 = s * s * 1 + c * c * 2;
+  float l1, l2, l3;
+  vnl_symmetric_eigensystem_compute_eigenvals(float(M11), float(M12), 0.0f, float(M22), 0.0f, 3.0f, l1, l2, l3);
+  EXPECT_NEAR(l1, 1.0f, 1e-5f);
+  EXPECT_NEAR(l2, 2.0f, 1e-5f);
+  EXPECT_NEAR(l3, 3.0f, 1e-5f);
+}
+
+TEST(vnl_symmetric_eigensystem, closed_form_3x3)
+{
+  vnl_random rng(1234);
+  for (unsigned trial = 0; trial < 50; ++trial) {
+    // a thin covariance, as of a noisy planar neighbourhood
+    vnl_matrix_fixed<double, 3, 3> A(0.0);
+    for (unsigned k = 0; k < 20; ++k) {
+      const double p[3] = { rng.drand64(-1.0, 1.0), rng.drand64(-1.0, 1.0), 1e-3 * rng.drand64(-1.0, 1.0) };
+      for (unsigned r = 0; r < 3; ++r)
+        for (unsigned c = 0; c < 3; ++c)
+          A[r][c] += p[r] * p[c];
+    }
+    vnl_matrix_fixed<double, 3, 3> V;
+    vnl_vector_fixed<double, 3> D;
+    ASSERT_TRUE(vnl_symmetric_eigensystem_compute(A, V, D));
+    EXPECT_LE(D[0], D[1]);
+    EXPECT_LE(D[1], D[2]);
+    EXPECT_NEAR(std::fabs(V[2][0]), 1.0, 1e-5);
+    for (unsigned i = 0; i < 3; ++i)
+      for (unsigned r = 0; r < 3; ++r) {
+        double av = 0.0;
+        for (unsigned c = 0; c < 3; ++c)
+          av += A[r][c] * V[c][i];
+        EXPECT_NEAR(av, D[i] * V[r][i], 1e-10);
+      }
+  }
+}
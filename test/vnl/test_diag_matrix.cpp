@@ -103,6 +103,35 @@ TEST(vnl_diag_matrix, simple)
 }
 
 
+TEST(vnl_diag_matrix, scale_rows_and_columns)
+{
+    vnl_diag_matrix<double> D(3);
+    D[0] = 2.0; D[1] = -1.0; D[2] = 0.5;
+
+    vnl_matrix<double> A(3, 4);
+    for (unsigned i = 0; i < 3; ++i)
+        for (unsigned j = 0; j < 4; ++j)
+            A(i, j) = 1.0 + i * 4 + j;
+
+    // reference products against the dense diagonal
+    vnl_matrix<double> DA = D.as_matrix() * A;
+    vnl_matrix<double> B(A);
+    D.scale_rows(B);
+    EXPECT_NEAR((B - DA).fro_norm(), 0.0, 1e-15) << "scale_rows\n";
+    EXPECT_NEAR(((D * A) - DA).fro_norm(), 0.0, 1e-15) << "diag * matrix\n";
+
+    vnl_matrix<double> At = A.transpose();
+    vnl_matrix<double> AtD = At * D.as_matrix();
+    vnl_matrix<double> C(At);
+    D.scale_columns(C);
+    EXPECT_NEAR((C - AtD).fro_norm(), 0.0, 1e-15) << "scale_columns\n";
+    EXPECT_NEAR(((At * D) - AtD).fro_norm(), 0.0, 1e-15) << "matrix * diag\n";
+
+    vnl_vector<double> v(3, 2.0);
+    D.scale_elements(v);
+    EXPECT_EQ(v(0) == 4.0 && v(1) == -2.0 && v(2) == 1.0, true) << "scale_elements\n";
+}
+
 /*
 void test_diag_matrix()
 {
@@ -0,0 +1,84 @@
+// This is core/vnl/tests/test_real_polynomial.cxx
+#include <iostream>
+#include <complex>
+
+#include <vnl/vnl_real_polynomial.h>
+
+#include <gtest/gtest.h>
+
+TEST(vnl_real_polynomial, evaluate)
+{
+    // f = 2x^2 - 3x + 1 = (2x - 1)(x - 1)
+    double c[] = { 2.0, -3.0, 1.0 };
+    vnl_real_polynomial f(c, 3);
+    std::cout << "f =" << f << std::endl;
+
+    EXPECT_EQ(f.degree(), 2);
+    ASSERT_NEAR(f.evaluate(0.0), 1.0, 1e-12);
+    ASSERT_NEAR(f.evaluate(0.5), 0.0, 1e-12);
+    ASSERT_NEAR(f.evaluate(1.0), 0.0, 1e-12);
+    ASSERT_NEAR(f.evaluate(3.0), 10.0, 1e-12);
+    ASSERT_NEAR(f.devaluate(3.0), 9.0, 1e-12);
+
+    double p, dp;
+    f.evaluate(-2.0, p, dp);
+    ASSERT_NEAR(p, 15.0, 1e-12);
+    ASSERT_NEAR(dp, -11.0, 1e-12);
+
+    // f(i) = -2 - 3i + 1 = -1 - 3i
+    std::complex<double> z = f.evaluate(std::complex<double>(0.0, 1.0));
+    ASSERT_NEAR(z.real(), -1.0, 1e-12);
+    ASSERT_NEAR(z.imag(), -3.0, 1e-12);
+
+    // integral of f over [0,1] = 2/3 - 3/2 + 1
+    ASSERT_NEAR(f.evaluate_integral(0.0, 1.0), 1.0/6.0, 1e-12);
+}
+
+TEST(vnl_real_polynomial, derivative_primitive)
+{
+    double c[] = { 1.0, 0.0, -4.0, 3.0 }; // x^3 - 4x + 3
+    vnl_real_polynomial f(c, 4);
+
+    vnl_real_polynomial df = f.derivative();
+    EXPECT_EQ(df.degree(), 2);
+    ASSERT_NEAR(df[0], 3.0, 1e-12);
+    ASSERT_NEAR(df[1], 0.0, 1e-12);
+    ASSERT_NEAR(df[2], -4.0, 1e-12);
+
+    vnl_real_polynomial F = f.primitive();
+    EXPECT_EQ(F.degree(), 4);
+    EXPECT_EQ(F.derivative(), f);
+    ASSERT_NEAR(F.evaluate(0.0), 0.0, 1e-12);
+
+    EXPECT_EQ(vnl_real_polynomial(5.0).derivative().degree(), 0);
+}
+
+TEST(vnl_real_polynomial, arithmetic)
+{
+    double c1[] = { 1.0, -1.0 };      // x - 1
+    double c2[] = { 1.0, 0.0, 1.0 };  // x^2 + 1
+    vnl_real_polynomial f1(c1, 2), f2(c2, 3);
+
+    vnl_real_polynomial sum = f1 + f2;  // x^2 + x
+    EXPECT_EQ(sum.degree(), 2);
+    ASSERT_NEAR(sum[0], 1.0, 1e-12);
+    ASSERT_NEAR(sum[1], 1.0, 1e-12);
+    ASSERT_NEAR(sum[2], 0.0, 1e-12);
+
+    vnl_real_polynomial diff = f1 - f2; // -x^2 + x - 2
+    ASSERT_NEAR(diff.evaluate(2.0), -4.0, 1e-12);
+
+    vnl_real_polynomial prod = f1 * f2; // x^3 - x^2 + x - 1
+    EXPECT_EQ(prod.degree(), 3);
+    for (double x = -2.0; x <= 2.0; x += 0.5)
+        ASSERT_NEAR(prod.evaluate(x), f1.evaluate(x) * f2.evaluate(x), 1e-12);
+
+    // cancelling the leading term leaves a zero coefficient that trim() removes
+    vnl_real_polynomial t = f2 - vnl_real_polynomial(c2, 3) + f1;
+    t.trim();
+    EXPECT_EQ(t.degree(), 1);
+    EXPECT_EQ(t, f1);
+
+    ASSERT_NEAR(f1.rms_difference(f1, 0.0, 1.0), 0.0, 1e-12);
+    ASSERT_NEAR(f1.rms_difference(f1 + vnl_real_polynomial(2.0), 0.0, 1.0), 2.0, 1e-12);
+}
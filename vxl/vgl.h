@@ -18,6 +18,8 @@
 #include "vgl/vgl_point_3d.h"
 #include "vgl/vgl_homg_point_3d.h"
 #include "vgl/vgl_pointset_3d.h"
+#include "vgl/vgl_kd_tree_3d.h"
+#include "vgl/vgl_pointset_3d_soa.h"
 
 // Lines
 #include "vgl/vgl_line_2d.h"
@@ -43,13 +45,18 @@
 // Spline
 #include "vgl/vgl_cubic_spline_2d.h"
 #include "vgl/vgl_cubic_spline_3d.h"
+#include "vgl/vgl_prepared_cubic_spline.h"
 
 // Functions
 #include "vgl/vgl_closest_point.h"
 #include "vgl/vgl_distance.h"
 #include "vgl/vgl_clip.h"
+#include "vgl/vgl_triangulate.h"
+#include "vgl/vgl_simplify.h"
 #include "vgl/vgl_area.h"
 #include "vgl/vgl_convex.h"
+#include "vgl/vgl_convex_hull_3d.h"
+#include "vgl/vgl_delaunay_2d.h"
 #include "vgl/vgl_intersection.h"
 #include "vgl/vgl_bounding_box.h"
 #include "vgl/vgl_oriented_box_2d.h"
@@ -58,10 +65,15 @@
 #include "vgl/vgl_lineseg_test.h"
 #include "vgl/vgl_triangle_test.h"
 #include "vgl/vgl_polygon_test.h"
+#include "vgl/vgl_prepared_polygon.h"
+#include "vgl/vgl_predicates.h"
 #include "vgl/vgl_frustum_3d.h"
+#include "vgl/vgl_octree_3d.h"
+#include "vgl/vgl_box_rtree.h"
 #include "vgl/vgl_affine_coordinates.h"
 
-//#include "vgl/vgl_region_scan_iterator.h"
+#include "vgl/vgl_region_scan_iterator.h"
+#include "vgl/vgl_polygon_scan_iterator.h"
 //#include "vgl/vgl_triangle_scan_iterator.h"
 
 
@@ -0,0 +1,240 @@
+// This is core/vgl/algo/vgl_estimate_normals_3d.h
+#ifndef vgl_estimate_normals_3d_h_
+#define vgl_estimate_normals_3d_h_
+//:
+// \file
+// \brief Normals of a vgl_pointset_3d from the principal axes of point neighbourhoods
+//
+//  The normal of a point is the direction of least variance of its
+//  neighbourhood: the eigenvector of the smallest eigenvalue of the 3x3
+//  covariance of the neighbours, found in closed form.  The neighbourhood is
+//  the k nearest points, optionally only those within a radius, found with
+//  vgl_kd_tree_3d.  The points are processed in parallel and the normals are
+//  written into the point set, which then has_normals().
+//
+//  PCA leaves the sign of a normal undefined.  vgl_orient_normals() turns
+//  them towards a viewpoint, e.g. the scanner position; without one,
+//  vgl_orient_normals_mst() makes them consistent by propagating the
+//  orientation along a minimum spanning tree of the k-nearest-neighbour
+//  graph, with weights 1 - |n_i.n_j|, as in H. Hoppe et al., "Surface
+//  reconstruction from unorganized points", SIGGRAPH 1992.
+//
+// \verbatim
+//  Modifications
+// \endverbatim
+
+#include <vector>
+#include <queue>
+#include <functional>
+#include <utility>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vnl/vnl_matrix_fixed.h>
+#include <vnl/vnl_vector_fixed.h>
+#include <vnl/algo/vnl_symmetric_eigensystem.h>
+#include <vgl/vgl_point_3d.h>
+#include <vgl/vgl_vector_3d.h>
+#include <vgl/vgl_pointset_3d.h>
+#include <vgl/vgl_kd_tree_3d.h>
+#include <vgl/vgl_parallel.h>
+
+//: Set the normal of every point of ptset from its neighbourhood in tree, a tree over ptset.
+//  The neighbourhood is the k nearest points, including the point itself;
+//  with radius > 0 only those within radius, and with k = 0 all of them.
+//  If surface_variation is given it receives l0 / (l0 + l1 + l2) for the
+//  eigenvalues l0 <= l1 <= l2, 0 on a plane and at most 1/3.  Points with
+//  fewer than 3 neighbours get a zero normal.  The normals are oriented
+//  arbitrarily; returns the number of points that got a zero normal.
+template <class T>
+std::size_t vgl_estimate_normals(vgl_pointset_3d<T>& ptset, vgl_kd_tree_3d<T> const& tree, unsigned k,
+                                 T radius = T(0), unsigned nthreads = 0,
+                                 std::vector<T>* surface_variation = nullptr)
+{
+  const std::size_t n = ptset.size();
+  ptset.init_normals();
+  if (surface_variation)
+    surface_variation->assign(n, T(0));
+  const unsigned nt = vgl_parallel_detail::thread_count(nthreads, n, 4096);
+  std::vector<std::size_t> degenerate(nt, 0);
+  std::vector<vgl_point_3d<T> > const& pts = ptset.points();
+  vgl_parallel_detail::parallel_for(n, nt, [&](unsigned t, std::size_t begin, std::size_t end) {
+    std::vector<unsigned> nbrs;
+    vnl_matrix_fixed<double, 3, 3> C, V;
+    vnl_vector_fixed<double, 3> D;
+    for (std::size_t i = begin; i < end; ++i) {
+      vgl_point_3d<T> const& p = pts[i];
+      if (radius > T(0)) {
+        tree.radius_search(p, radius, nbrs);
+        if (k > 0 && nbrs.size() > k) {
+          // the k nearest of them
+          std::vector<std::pair<double, unsigned> > byd(nbrs.size());
+          for (std::size_t j = 0; j < nbrs.size(); ++j)
+            byd[j] = std::make_pair(double((pts[nbrs[j]] - p).sqr_length()), nbrs[j]);
+          std::nth_element(byd.begin(), byd.begin() + k, byd.end());
+          nbrs.resize(k);
+          for (unsigned j = 0; j < k; ++j)
+            nbrs[j] = byd[j].second;
+        }
+      }
+      else
+        tree.k_nearest(p, k, nbrs);
+      const std::size_t m = nbrs.size();
+      if (m < 3) {
+        ptset.set_normal(unsigned(i), vgl_vector_3d<T>()); // a normal left from before is stale
+        ++degenerate[t];
+        continue;
+      }
+      // covariance about the centroid
+      double c[3] = { 0.0, 0.0, 0.0 };
+      for (std::size_t j = 0; j < m; ++j) {
+        vgl_point_3d<T> const& q = pts[nbrs[j]];
+        c[0] += q.x(); c[1] += q.y(); c[2] += q.z();
+      }
+      c[0] /= m; c[1] /= m; c[2] /= m;
+      double s[6] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+      for (std::size_t j = 0; j < m; ++j) {
+        vgl_point_3d<T> const& q = pts[nbrs[j]];
+        const double dx = q.x() - c[0], dy = q.y() - c[1], dz = q.z() - c[2];
+        s[0] += dx * dx; s[1] += dx * dy; s[2] += dx * dz;
+        s[3] += dy * dy; s[4] += dy * dz; s[5] += dz * dz;
+      }
+      C[0][0] = s[0]; C[0][1] = C[1][0] = s[1]; C[0][2] = C[2][0] = s[2];
+      C[1][1] = s[3]; C[1][2] = C[2][1] = s[4]; C[2][2] = s[5];
+      const double trace = s[0] + s[3] + s[5];
+      if (!(trace > 0.0) || !vnl_symmetric_eigensystem_compute(C, V, D)) {
+        ptset.set_normal(unsigned(i), vgl_vector_3d<T>());
+        ++degenerate[t];
+        continue;
+      }
+      ptset.set_normal(unsigned(i), normalized(vgl_vector_3d<T>(T(V[0][0]), T(V[1][0]), T(V[2][0]))));
+      if (surface_variation)
+        (*surface_variation)[i] = T(std::max(0.0, D[0]) / trace);
+    }
+  });
+  std::size_t total = 0;
+  for (unsigned t = 0; t < nt; ++t)
+    total += degenerate[t];
+  return total;
+}
+
+//: vgl_estimate_normals() with a kd-tree built over ptset.
+template <class T>
+std::size_t vgl_estimate_normals(vgl_pointset_3d<T>& ptset, unsigned k, T radius = T(0), unsigned nthreads = 0,
+                                 std::vector<T>* surface_variation = nullptr)
+{
+  vgl_kd_tree_3d<T> tree(ptset, 16, nthreads);
+  return vgl_estimate_normals(ptset, tree, k, radius, nthreads, surface_variation);
+}
+
+//: Flip the normals of ptset that point away from viewpoint.
+template <class T>
+void vgl_orient_normals(vgl_pointset_3d<T>& ptset, vgl_point_3d<T> const& viewpoint, unsigned nthreads = 0)
+{
+  if (!ptset.has_normals())
+    return;
+  const std::size_t n = ptset.size();
+  vgl_parallel_detail::parallel_for(
+    n, vgl_parallel_detail::thread_count(nthreads, n, 4096), [&](unsigned, std::size_t begin, std::size_t end) {
+      for (std::size_t i = begin; i < end; ++i) {
+        vgl_vector_3d<T> nrm = ptset.n(unsigned(i));
+        if (dot_product(nrm, viewpoint - ptset.p(unsigned(i))) < T(0))
+          ptset.set_normal(unsigned(i), -nrm);
+      }
+    });
+}
+
+//: Orient the normals of ptset consistently along a minimum spanning tree of its k-nearest-neighbour graph.
+//  Each connected component of the graph is rooted at its highest point, whose
+//  normal is turned upwards (+z), and every other normal is turned to agree
+//  with its parent in the tree.  Returns the number of components.
+template <class T>
+std::size_t vgl_orient_normals_mst(vgl_pointset_3d<T>& ptset, vgl_kd_tree_3d<T> const& tree, unsigned k = 8,
+                                   unsigned nthreads = 0)
+{
+  const std::size_t n = ptset.size();
+  if (!ptset.has_normals() || n == 0)
+    return 0;
+  // the symmetric k-nearest-neighbour graph, in compressed rows
+  std::vector<unsigned> knn(n * k, unsigned(-1));
+  std::vector<vgl_point_3d<T> > const& pts = ptset.points();
+  vgl_parallel_detail::parallel_for(
+    n, vgl_parallel_detail::thread_count(nthreads, n, 4096), [&](unsigned, std::size_t begin, std::size_t end) {
+      std::vector<unsigned> nbrs;
+      for (std::size_t i = begin; i < end; ++i) {
+        tree.k_nearest(pts[i], k + 1, nbrs);
+        unsigned m = 0;
+        for (std::size_t j = 0; j < nbrs.size() && m < k; ++j)
+          if (nbrs[j] != i)
+            knn[i * k + m++] = nbrs[j];
+      }
+    });
+  std::vector<std::size_t> start(n + 1, 0);
+  for (std::size_t i = 0; i < n; ++i)
+    for (unsigned j = 0; j < k; ++j)
+      if (knn[i * k + j] != unsigned(-1)) {
+        ++start[i + 1];
+        ++start[knn[i * k + j] + 1];
+      }
+  for (std::size_t i = 0; i < n; ++i)
+    start[i + 1] += start[i];
+  std::vector<unsigned> adj(start[n]);
+  std::vector<std::size_t> fill(start.begin(), start.end() - 1);
+  for (std::size_t i = 0; i < n; ++i)
+    for (unsigned j = 0; j < k; ++j) {
+      const unsigned o = knn[i * k + j];
+      if (o == unsigned(-1))
+        continue;
+      adj[fill[i]++] = o;
+      adj[fill[o]++] = unsigned(i);
+    }
+  std::vector<unsigned>().swap(knn);
+
+  // roots in decreasing height, then Prim's algorithm from each unvisited one
+  std::vector<unsigned> order(n);
+  for (std::size_t i = 0; i < n; ++i)
+    order[i] = unsigned(i);
+  std::sort(order.begin(), order.end(), [&pts](unsigned a, unsigned b) { return pts[a].z() > pts[b].z(); });
+  std::vector<unsigned char> done(n, 0);
+  typedef std::pair<T, std::pair<unsigned, unsigned> > edge; // (weight, (to, from))
+  std::priority_queue<edge, std::vector<edge>, std::greater<edge> > heap;
+  std::size_t components = 0;
+  for (std::size_t r = 0; r < n; ++r) {
+    const unsigned root = order[r];
+    if (done[root])
+      continue;
+    ++components;
+    vgl_vector_3d<T> nr = ptset.n(root);
+    if (nr.z() < T(0))
+      ptset.set_normal(root, -nr);
+    heap.push(edge(T(0), std::make_pair(root, root)));
+    while (!heap.empty()) {
+      const unsigned i = heap.top().second.first, from = heap.top().second.second;
+      heap.pop();
+      if (done[i])
+        continue;
+      done[i] = 1;
+      vgl_vector_3d<T> ni = ptset.n(i);
+      if (i != from && dot_product(ni, ptset.n(from)) < T(0)) {
+        ni = -ni;
+        ptset.set_normal(i, ni);
+      }
+      for (std::size_t e = start[i]; e < start[i + 1]; ++e) {
+        const unsigned j = adj[e];
+        if (!done[j])
+          heap.push(edge(T(1) - T(std::fabs(dot_product(ni, ptset.n(j)))), std::make_pair(j, i)));
+      }
+    }
+  }
+  return components;
+}
+
+//: vgl_orient_normals_mst() with a kd-tree built over ptset.
+template <class T>
+std::size_t vgl_orient_normals_mst(vgl_pointset_3d<T>& ptset, unsigned k = 8, unsigned nthreads = 0)
+{
+  vgl_kd_tree_3d<T> tree(ptset, 16, nthreads);
+  return vgl_orient_normals_mst(ptset, tree, k, nthreads);
+}
+
+#endif // vgl_estimate_normals_3d_h_
@@ -0,0 +1,203 @@
+// This is core/vgl/algo/vgl_fit_quadric_3d.h
+#ifndef vgl_fit_quadric_3d_h_
+#define vgl_fit_quadric_3d_h_
+//:
+// \file
+// \brief Algebraic least-squares fit of a vgl_quadric_3d to a stream of 3-d points
+//
+//  The quadric a x^2 + b y^2 + c z^2 + d xy + e xz + f yz + g x + h y + i z + j = 0
+//  minimising the sum of squared algebraic distances, with the coefficient
+//  vector of unit norm, is the eigenvector of the smallest eigenvalue of the
+//  10x10 scatter matrix of the monomials (x^2, y^2, z^2, xy, xz, yz, x, y, z, 1).
+//  The points are not stored: add_point() and add_points() only accumulate
+//  that scatter matrix, so any number of points can be fitted in constant
+//  memory, and accumulators filled separately (e.g. by threads) can be
+//  merged with add().
+//
+//  For numerical conditioning the points are accumulated relative to the
+//  first one, and the fit maps the scatter matrix to coordinates with the
+//  centroid at the origin and an rms distance of sqrt(3) from it, the same
+//  normalisation as vgl_norm_trans_3d, before solving.
+//
+// \verbatim
+//  Modifications
+// \endverbatim
+
+#include <iostream>
+#include <cmath>
+#include <cstddef>
+#include <algorithm>
+#include <vnl/vnl_matrix.h>
+#include <vnl/vnl_matrix_fixed.h>
+#include <vnl/vnl_vector.h>
+#include <vnl/algo/vnl_svd.h>
+#include <vgl/vgl_point_3d.h>
+#include <vgl/vgl_pointset_3d_soa.h>
+#include <vgl/vgl_quadric_3d.h>
+
+template <class T>
+class vgl_fit_quadric_3d
+{
+ public:
+  vgl_fit_quadric_3d() { clear(); }
+
+  //: add a point to the fit
+  void add_point(vgl_point_3d<T> const& p) { add_point(p.x(), p.y(), p.z()); }
+  void add_point(T x, T y, T z) { add_points(&x, &y, &z, 1); }
+
+  //: add the n points (x[k], y[k], z[k])
+  void add_points(T const* x, T const* y, T const* z, std::size_t n);
+
+  //: add all points of ptset
+  void add_points(vgl_pointset_3d_soa<T> const& ptset)
+  { add_points(ptset.x().data(), ptset.y().data(), ptset.z().data(), ptset.size()); }
+
+  //: add the points accumulated by another fitter
+  void add(vgl_fit_quadric_3d<T> const& other);
+
+  //: remove all points
+  void clear();
+
+  //: number of points added
+  std::size_t size() const { return static_cast<std::size_t>(S_[9][9]); }
+
+  //: the scatter matrix of the monomials, for points relative to origin()
+  vnl_matrix_fixed<double, 10, 10> const& scatter_matrix() const { return S_; }
+  vgl_point_3d<double> origin() const { return vgl_point_3d<double>(origin_[0], origin_[1], origin_[2]); }
+
+  //: Fit the quadric minimising the algebraic distance.
+  //  Returns the rms algebraic distance in the normalised frame, or -1 if
+  //  there are fewer than 9 points or they all coincide.
+  T fit_linear_algebraic(std::ostream* errstream = nullptr);
+
+  //: the quadric found by the last fit
+  vgl_quadric_3d<T> quadric_fit() const { return quadric_fit_; }
+
+ private:
+  //: The map M from the monomials of p to those of s (p - c): m(s (p - c)) = M m(p).
+  static vnl_matrix_fixed<double, 10, 10> monomial_map(double s, double const c[3]);
+
+  bool has_origin_;
+  double origin_[3];
+  vnl_matrix_fixed<double, 10, 10> S_;
+  vgl_quadric_3d<T> quadric_fit_;
+};
+
+// =================  methods  ===================
+
+template <class T>
+void vgl_fit_quadric_3d<T>::clear()
+{
+  has_origin_ = false;
+  origin_[0] = origin_[1] = origin_[2] = 0.0;
+  S_.fill(0.0);
+}
+
+template <class T>
+vnl_matrix_fixed<double, 10, 10> vgl_fit_quadric_3d<T>::monomial_map(double s, double const c[3])
+{
+  // monomial k is the product of coordinates u[k] and v[k], with 3 standing for 1
+  static const int u[10] = { 0, 1, 2, 0, 0, 1, 0, 1, 2, 3 };
+  static const int v[10] = { 0, 1, 2, 1, 2, 2, 3, 3, 3, 3 };
+  // index of the monomial of coordinates (p, q)
+  static const int mono[4][4] = { { 0, 3, 4, 6 }, { 3, 1, 5, 7 }, { 4, 5, 2, 8 }, { 6, 7, 8, 9 } };
+  vnl_matrix_fixed<double, 10, 10> M(0.0);
+  for (int k = 0; k < 10; ++k) {
+    // s (p_u - c_u) and s (p_v - c_v) as linear combinations of p_u, p_v and 1
+    const int a[2] = { u[k], 3 }, b[2] = { v[k], 3 };
+    const double ca[2] = { u[k] < 3 ? s : 1.0, u[k] < 3 ? -s * c[u[k]] : 0.0 };
+    const double cb[2] = { v[k] < 3 ? s : 1.0, v[k] < 3 ? -s * c[v[k]] : 0.0 };
+    for (int i = 0; i < 2; ++i)
+      for (int j = 0; j < 2; ++j) {
+        if ((i == 1 && a[0] == 3) || (j == 1 && b[0] == 3))
+          continue; // the constant factor 1 has no second term
+        M[k][mono[a[i]][b[j]]] += ca[i] * cb[j];
+      }
+  }
+  return M;
+}
+
+template <class T>
+void vgl_fit_quadric_3d<T>::add_points(T const* x, T const* y, T const* z, std::size_t n)
+{
+  if (n == 0)
+    return;
+  if (!has_origin_) {
+    origin_[0] = x[0]; origin_[1] = y[0]; origin_[2] = z[0];
+    has_origin_ = true;
+  }
+  // the monomials of a block of points, then the 55 sums of products of the block
+  const std::size_t block = 256;
+  double m[10][block];
+  for (std::size_t b = 0; b < n; b += block) {
+    const std::size_t nb = std::min(block, n - b);
+    for (std::size_t k = 0; k < nb; ++k) {
+      const double px = x[b + k] - origin_[0], py = y[b + k] - origin_[1], pz = z[b + k] - origin_[2];
+      m[0][k] = px * px; m[1][k] = py * py; m[2][k] = pz * pz;
+      m[3][k] = px * py; m[4][k] = px * pz; m[5][k] = py * pz;
+      m[6][k] = px; m[7][k] = py; m[8][k] = pz; m[9][k] = 1.0;
+    }
+    for (int r = 0; r < 10; ++r)
+      for (int c = r; c < 10; ++c) {
+        double sum = 0.0;
+        for (std::size_t k = 0; k < nb; ++k)
+          sum += m[r][k] * m[c][k];
+        S_[r][c] += sum;
+      }
+  }
+  for (int r = 0; r < 10; ++r)
+    for (int c = 0; c < r; ++c)
+      S_[r][c] = S_[c][r];
+}
+
+template <class T>
+void vgl_fit_quadric_3d<T>::add(vgl_fit_quadric_3d<T> const& other)
+{
+  if (!other.has_origin_)
+    return;
+  if (!has_origin_) {
+    *this = other;
+    return;
+  }
+  // the other points relative to this origin: p - o = (p - o') - (o - o')
+  const double c[3] = { origin_[0] - other.origin_[0], origin_[1] - other.origin_[1], origin_[2] - other.origin_[2] };
+  vnl_matrix_fixed<double, 10, 10> M = monomial_map(1.0, c);
+  vnl_matrix_fixed<double, 10, 10> S = M * other.S_ * M.transpose();
+  S_ += S;
+}
+
+template <class T>
+T vgl_fit_quadric_3d<T>::fit_linear_algebraic(std::ostream* errstream)
+{
+  const double n = S_[9][9];
+  if (n < 9) {
+    if (errstream)
+      *errstream << "vgl_fit_quadric_3d: need at least 9 points, have " << n << '\n';
+    return T(-1);
+  }
+  // centroid and rms distance from it, from the sums in the scatter matrix
+  const double c[3] = { S_[6][9] / n, S_[7][9] / n, S_[8][9] / n };
+  const double msd = (S_[0][9] + S_[1][9] + S_[2][9]) / n - (c[0] * c[0] + c[1] * c[1] + c[2] * c[2]);
+  if (!(msd > 0.0)) {
+    if (errstream)
+      *errstream << "vgl_fit_quadric_3d: the points coincide\n";
+    return T(-1);
+  }
+  vnl_matrix_fixed<double, 10, 10> M = monomial_map(std::sqrt(3.0 / msd), c);
+  vnl_matrix_fixed<double, 10, 10> Sn = M * S_ * M.transpose();
+
+  vnl_svd<double> svd(Sn.as_matrix());
+  vnl_vector<double> qn = svd.nullvector();
+  // q^t m(p - o) = qn^t M m(p - o), then undo the shift by the origin
+  vnl_matrix_fixed<double, 10, 10> MO = M * monomial_map(1.0, origin_);
+  double q[10];
+  for (int k = 0; k < 10; ++k) {
+    q[k] = 0.0;
+    for (int r = 0; r < 10; ++r)
+      q[k] += MO[r][k] * qn[r];
+  }
+  quadric_fit_.set(T(q[0]), T(q[1]), T(q[2]), T(q[3]), T(q[4]), T(q[5]), T(q[6]), T(q[7]), T(q[8]), T(q[9]));
+  return static_cast<T>(std::sqrt(std::max(0.0, double(svd.sigma_min())) / n));
+}
+
+#endif // vgl_fit_quadric_3d_h_
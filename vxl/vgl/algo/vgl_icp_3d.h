@@ -0,0 +1,425 @@
+// This is core/vgl/algo/vgl_icp_3d.h
+#ifndef vgl_icp_3d_h_
+#define vgl_icp_3d_h_
+//:
+// \file
+// \brief Rigid registration of a vgl_pointset_3d to another by iterative closest points
+//
+//  vgl_icp_3d finds the rotation and translation that move a source point set
+//  onto a target.  Each iteration pairs every source point, under the current
+//  transformation, with its nearest target point in a vgl_kd_tree_3d built
+//  once over the target, rejects doubtful pairs and updates the transformation:
+//
+//  - point_to_point minimises the sum of squared distances between the pairs,
+//    in closed form by Horn's quaternion method (B.K.P. Horn, "Closed-form
+//    solution of absolute orientation using unit quaternions", JOSA A 1987);
+//  - point_to_plane minimises the squared distances of the source points to
+//    the tangent planes of their targets, by a Gauss-Newton step on the 6x6
+//    normal equations of the linearised rotation and the translation (Chen &
+//    Medioni 1991).  It converges in far fewer iterations on smooth surfaces.
+//    Target normals are estimated by vgl_estimate_normals() if it has none.
+//
+//  Pairs are rejected beyond set_max_distance(), beyond set_rejection_sigma()
+//  robust standard deviations of the pair distances (1.4826 times their
+//  median), and, with set_trim_fraction(f) < 1, all but the fraction f of
+//  closest pairs (trimmed ICP, for partial overlap).
+//
+//  With set_levels(L) > 1 the registration runs coarse to fine: level l uses
+//  every 4^l-th source point, from level L-1 down to 0, each level starting
+//  from the result of the previous one.  The correspondence search and the
+//  accumulation of the normal equations are spread over threads.
+//
+//  The statistics() of every iteration give the level, number of pairs, rms
+//  error before the update and size of the update.
+//
+// \verbatim
+//  Modifications
+// \endverbatim
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vnl/vnl_matrix.h>
+#include <vnl/vnl_matrix_fixed.h>
+#include <vnl/vnl_vector.h>
+#include <vnl/vnl_vector_fixed.h>
+#include <vnl/vnl_quaternion.h>
+#include <vnl/algo/vnl_qr.h>
+#include <vnl/algo/vnl_symmetric_eigensystem.h>
+#include <vgl/vgl_point_3d.h>
+#include <vgl/vgl_vector_3d.h>
+#include <vgl/vgl_pointset_3d.h>
+#include <vgl/vgl_kd_tree_3d.h>
+#include <vgl/vgl_parallel.h>
+#include <vgl/algo/vgl_h_matrix_3d.h>
+#include <vgl/algo/vgl_rotation_3d.h>
+#include <vgl/algo/vgl_estimate_normals_3d.h>
+
+template <class T>
+class vgl_icp_3d
+{
+ public:
+  enum error_metric { point_to_point, point_to_plane };
+
+  //: what happened in one iteration
+  struct iteration_stats
+  {
+    unsigned level;        //!< coarse-to-fine level
+    std::size_t n_source;  //!< source points used at this level
+    std::size_t n_pairs;   //!< pairs kept after rejection
+    T rms;                 //!< rms error of the kept pairs before the update
+    T rotation;            //!< angle of the update's rotation, in radians
+    T translation;         //!< distance the update moved the centroid of the paired source points
+  };
+
+  //: Prepare to register point sets to target.
+  //  nthreads is the number of threads to use, 0 for all cores.
+  explicit vgl_icp_3d(vgl_pointset_3d<T> const& target, unsigned nthreads = 0);
+
+  void set_metric(error_metric m) { metric_ = m; }
+  //: maximum number of iterations per level (default 50)
+  void set_max_iterations(unsigned n) { max_iterations_ = n; }
+  //: number of coarse-to-fine levels (default 1)
+  void set_levels(unsigned n) { levels_ = n > 0 ? n : 1; }
+  //: reject pairs farther apart than d; 0 (the default) for no limit
+  void set_max_distance(T d) { max_distance_ = d; }
+  //: keep only the fraction f in (0, 1] of closest pairs (default 1)
+  void set_trim_fraction(T f) { trim_fraction_ = f; }
+  //: reject pairs farther apart than k robust standard deviations; 0 (the default) for no limit
+  void set_rejection_sigma(T k) { rejection_sigma_ = k; }
+  //: Stop a level when the update rotates less than tol radians and moves
+  //  less than tol times the source size, or the rms error changes by a fraction less than tol (default 1e-6).
+  void set_tolerance(T tol) { tolerance_ = tol; }
+
+  //: Register source to the target, starting from initial.
+  //  Returns false if too few pairs were left to determine the transformation.
+  bool register_points(vgl_pointset_3d<T> const& source,
+                       vgl_h_matrix_3d<T> const& initial = vgl_h_matrix_3d<T>().set_identity());
+
+  //: the transformation from source to target
+  vgl_h_matrix_3d<T> const& transform() const { return H_; }
+  vgl_rotation_3d<T> rotation() const { return vgl_rotation_3d<T>(H_.get_upper_3x3_matrix()); }
+  vgl_vector_3d<T> translation() const
+  { return vgl_vector_3d<T>(H_.get(0, 3), H_.get(1, 3), H_.get(2, 3)); }
+
+  //: rms error and number of pairs of the last iteration
+  T rms_error() const { return stats_.empty() ? T(-1) : stats_.back().rms; }
+  std::size_t n_pairs() const { return stats_.empty() ? 0 : stats_.back().n_pairs; }
+  //: true if the finest level stopped by the tolerance rather than max_iterations
+  bool converged() const { return converged_; }
+  unsigned iterations() const { return static_cast<unsigned>(stats_.size()); }
+  std::vector<iteration_stats> const& statistics() const { return stats_; }
+
+  //: the target, with normals if point_to_plane was used
+  vgl_pointset_3d<T> const& target() const { return target_; }
+
+ private:
+  //: pair the points src, transformed by H_, with their nearest target points; returns the number kept
+  std::size_t match(std::vector<vgl_point_3d<T> > const& src);
+  //: the value below which the fraction f of the squared distances d2_ of kept pairs lie
+  double quantile(double f) const;
+  //: one update of H_ from the kept pairs
+  bool update(iteration_stats& s);
+
+  vgl_pointset_3d<T> target_;
+  vgl_kd_tree_3d<T> tree_;
+  unsigned nthreads_;
+  error_metric metric_;
+  unsigned max_iterations_;
+  unsigned levels_;
+  T max_distance_;
+  T trim_fraction_;
+  T rejection_sigma_;
+  T tolerance_;
+
+  vgl_h_matrix_3d<T> H_;
+  bool converged_;
+  std::vector<iteration_stats> stats_;
+
+  // the pairs of the current iteration: transformed source point, target index, squared distance
+  std::vector<vgl_point_3d<double> > p_;
+  std::vector<unsigned> q_;
+  std::vector<double> d2_;
+  std::vector<unsigned char> keep_;
+};
+
+// =================  methods  ===================
+
+template <class T>
+vgl_icp_3d<T>::vgl_icp_3d(vgl_pointset_3d<T> const& target, unsigned nthreads)
+  : target_(target), tree_(target, 16, nthreads), nthreads_(nthreads), metric_(point_to_point),
+    max_iterations_(50), levels_(1), max_distance_(T(0)), trim_fraction_(T(1)), rejection_sigma_(T(0)),
+    tolerance_(T(1e-6)), converged_(false)
+{
+  H_.set_identity();
+}
+
+template <class T>
+std::size_t vgl_icp_3d<T>::match(std::vector<vgl_point_3d<T> > const& src)
+{
+  const std::size_t n = src.size();
+  p_.resize(n);
+  q_.resize(n);
+  d2_.resize(n);
+  keep_.assign(n, 0);
+  vnl_matrix_fixed<T, 4, 4> const& M = H_.get_matrix();
+  double A[3][4];
+  for (unsigned r = 0; r < 3; ++r)
+    for (unsigned c = 0; c < 4; ++c)
+      A[r][c] = M[r][c];
+  const bool planar = metric_ == point_to_plane;
+  const double maxd2 = max_distance_ > T(0) ? double(max_distance_) * max_distance_ : -1.0;
+  const unsigned nt = vgl_parallel_detail::thread_count(nthreads_, n, 2048);
+  vgl_parallel_detail::parallel_for(n, nt, [&](unsigned, std::size_t begin, std::size_t end) {
+    typename vgl_kd_tree_3d<T>::dist_t d2;
+    for (std::size_t i = begin; i < end; ++i) {
+      const double x = src[i].x(), y = src[i].y(), z = src[i].z();
+      vgl_point_3d<double> p(A[0][0] * x + A[0][1] * y + A[0][2] * z + A[0][3],
+                             A[1][0] * x + A[1][1] * y + A[1][2] * z + A[1][3],
+                             A[2][0] * x + A[2][1] * y + A[2][2] * z + A[2][3]);
+      p_[i] = p;
+      const int j = tree_.nearest(vgl_point_3d<T>(T(p.x()), T(p.y()), T(p.z())), &d2);
+      if (j < 0)
+        continue;
+      q_[i] = unsigned(j);
+      d2_[i] = double(d2);
+      if (maxd2 >= 0.0 && d2_[i] > maxd2)
+        continue;
+      if (planar && target_.n(unsigned(j)).sqr_length() == T(0))
+        continue;
+      keep_[i] = 1;
+    }
+  });
+  std::size_t kept = 0;
+  for (std::size_t i = 0; i < n; ++i)
+    kept += keep_[i];
+  // robust and trimmed rejection, on the squared distances
+  if (kept > 0 && rejection_sigma_ > T(0)) {
+    const double sigma = 1.4826 * std::sqrt(quantile(0.5));
+    const double lim = double(rejection_sigma_) * sigma;
+    for (std::size_t i = 0; i < n; ++i)
+      if (keep_[i] && d2_[i] > lim * lim) {
+        keep_[i] = 0;
+        --kept;
+      }
+  }
+  if (kept > 0 && trim_fraction_ < T(1)) {
+    const double lim = quantile(double(trim_fraction_));
+    for (std::size_t i = 0; i < n; ++i)
+      if (keep_[i] && d2_[i] > lim) {
+        keep_[i] = 0;
+        --kept;
+      }
+  }
+  return kept;
+}
+
+template <class T>
+double vgl_icp_3d<T>::quantile(double f) const
+{
+  std::vector<double> d;
+  for (std::size_t i = 0; i < d2_.size(); ++i)
+    if (keep_[i])
+      d.push_back(d2_[i]);
+  if (d.empty())
+    return 0.0;
+  std::size_t k = static_cast<std::size_t>(std::ceil(f * d.size()));
+  k = std::min(d.size() - 1, k > 0 ? k - 1 : 0);
+  std::nth_element(d.begin(), d.begin() + k, d.end());
+  return d[k];
+}
+
+template <class T>
+bool vgl_icp_3d<T>::update(iteration_stats& s)
+{
+  const std::size_t n = p_.size();
+  const unsigned nt = vgl_parallel_detail::thread_count(nthreads_, n, 2048);
+  std::vector<vgl_point_3d<T> > const& tp = target_.points();
+
+  // centroids of the kept pairs
+  std::vector<double> part(nt * 7, 0.0);
+  vgl_parallel_detail::parallel_for(n, nt, [&](unsigned t, std::size_t begin, std::size_t end) {
+    double* a = &part[t * 7];
+    for (std::size_t i = begin; i < end; ++i)
+      if (keep_[i]) {
+        vgl_point_3d<T> const& q = tp[q_[i]];
+        a[0] += p_[i].x(); a[1] += p_[i].y(); a[2] += p_[i].z();
+        a[3] += q.x(); a[4] += q.y(); a[5] += q.z();
+        a[6] += 1.0;
+      }
+  });
+  double c[7] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+  for (unsigned t = 0; t < nt; ++t)
+    for (unsigned k = 0; k < 7; ++k)
+      c[k] += part[t * 7 + k];
+  const double m = c[6];
+  for (unsigned k = 0; k < 6; ++k)
+    c[k] /= m;
+
+  vnl_matrix_fixed<double, 3, 3> R;
+  vnl_vector_fixed<double, 3> tr; // the update is x -> R (x - pc) + pc + tr
+  double sse = 0.0;
+  if (metric_ == point_to_point) {
+    // cross-covariance S[a][b] = sum (p - pc)_a (q - qc)_b and the sum of squared distances
+    std::vector<double> cov(nt * 10, 0.0);
+    vgl_parallel_detail::parallel_for(n, nt, [&](unsigned t, std::size_t begin, std::size_t end) {
+      double* a = &cov[t * 10];
+      for (std::size_t i = begin; i < end; ++i)
+        if (keep_[i]) {
+          vgl_point_3d<T> const& q = tp[q_[i]];
+          const double p3[3] = { p_[i].x() - c[0], p_[i].y() - c[1], p_[i].z() - c[2] };
+          const double q3[3] = { q.x() - c[3], q.y() - c[4], q.z() - c[5] };
+          for (unsigned r = 0; r < 3; ++r)
+            for (unsigned k = 0; k < 3; ++k)
+              a[r * 3 + k] += p3[r] * q3[k];
+          a[9] += d2_[i];
+        }
+    });
+    double S[3][3] = { { 0.0, 0.0, 0.0 }, { 0.0, 0.0, 0.0 }, { 0.0, 0.0, 0.0 } };
+    for (unsigned t = 0; t < nt; ++t) {
+      for (unsigned r = 0; r < 3; ++r)
+        for (unsigned k = 0; k < 3; ++k)
+          S[r][k] += cov[t * 10 + r * 3 + k];
+      sse += cov[t * 10 + 9];
+    }
+    // the rotation is the eigenvector of the largest eigenvalue of Horn's matrix N
+    vnl_matrix_fixed<double, 4, 4> N, V;
+    vnl_vector_fixed<double, 4> D;
+    N[0][0] = S[0][0] + S[1][1] + S[2][2];
+    N[1][1] = S[0][0] - S[1][1] - S[2][2];
+    N[2][2] = -S[0][0] + S[1][1] - S[2][2];
+    N[3][3] = -S[0][0] - S[1][1] + S[2][2];
+    N[0][1] = N[1][0] = S[1][2] - S[2][1];
+    N[0][2] = N[2][0] = S[2][0] - S[0][2];
+    N[0][3] = N[3][0] = S[0][1] - S[1][0];
+    N[1][2] = N[2][1] = S[0][1] + S[1][0];
+    N[1][3] = N[3][1] = S[2][0] + S[0][2];
+    N[2][3] = N[3][2] = S[1][2] + S[2][1];
+    if (!vnl_symmetric_eigensystem_compute(N, V, D))
+      return false;
+    vnl_quaternion<double> quat(V[1][3], V[2][3], V[3][3], V[0][3]);
+    quat.normalize();
+    R = vgl_rotation_3d<double>(quat).as_matrix();
+    tr[0] = c[3] - c[0]; tr[1] = c[4] - c[1]; tr[2] = c[5] - c[2];
+  }
+  else {
+    // normal equations of sum ((p - q).n + w.((p - pc) x n) + t.n)^2 in x = (w, t)
+    std::vector<double> ne(nt * 28, 0.0); // upper triangle of A, then b and the sum of squares
+    vgl_parallel_detail::parallel_for(n, nt, [&](unsigned t, std::size_t begin, std::size_t end) {
+      double* a = &ne[t * 28];
+      for (std::size_t i = begin; i < end; ++i)
+        if (keep_[i]) {
+          vgl_point_3d<T> const& q = tp[q_[i]];
+          vgl_vector_3d<T> const nv = target_.n(q_[i]);
+          const double nx = nv.x(), ny = nv.y(), nz = nv.z();
+          const double px = p_[i].x() - c[0], py = p_[i].y() - c[1], pz = p_[i].z() - c[2];
+          const double r = (p_[i].x() - q.x()) * nx + (p_[i].y() - q.y()) * ny + (p_[i].z() - q.z()) * nz;
+          const double J[6] = { py * nz - pz * ny, pz * nx - px * nz, px * ny - py * nx, nx, ny, nz };
+          unsigned k = 0;
+          for (unsigned u = 0; u < 6; ++u)
+            for (unsigned v = u; v < 6; ++v)
+              a[k++] += J[u] * J[v];
+          for (unsigned u = 0; u < 6; ++u)
+            a[21 + u] -= J[u] * r;
+          a[27] += r * r;
+        }
+    });
+    vnl_matrix<double> A(6, 6);
+    vnl_vector<double> b(6, 0.0);
+    std::vector<double> sum(28, 0.0);
+    for (unsigned t = 0; t < nt; ++t)
+      for (unsigned k = 0; k < 28; ++k)
+        sum[k] += ne[t * 28 + k];
+    unsigned k = 0;
+    for (unsigned u = 0; u < 6; ++u)
+      for (unsigned v = u; v < 6; ++v, ++k)
+        A(u, v) = A(v, u) = sum[k];
+    for (unsigned u = 0; u < 6; ++u)
+      b[u] = sum[21 + u];
+    sse = sum[27];
+    vnl_qr<double> qr(A, true);
+    if (qr.rank() < 6)
+      return false;
+    vnl_vector<double> x = qr.solve(b);
+    R = vgl_rotation_3d<double>(vnl_vector_fixed<double, 3>(x[0], x[1], x[2])).as_matrix();
+    tr[0] = x[3]; tr[1] = x[4]; tr[2] = x[5];
+  }
+
+  // compose the update x -> R x + (pc + tr - R pc) with H_
+  vnl_matrix_fixed<T, 4, 4> U;
+  U.set_identity();
+  for (unsigned r = 0; r < 3; ++r) {
+    double o = c[r] + tr[r];
+    for (unsigned k = 0; k < 3; ++k) {
+      U[r][k] = T(R[r][k]);
+      o -= R[r][k] * c[k];
+    }
+    U[r][3] = T(o);
+  }
+  H_.set(U * H_.get_matrix());
+
+  s.n_pairs = static_cast<std::size_t>(m);
+  s.rms = T(std::sqrt(sse / m));
+  const double cosa = std::max(-1.0, std::min(1.0, 0.5 * (R[0][0] + R[1][1] + R[2][2] - 1.0)));
+  s.rotation = T(std::acos(cosa));
+  s.translation = T(tr.magnitude());
+  return true;
+}
+
+template <class T>
+bool vgl_icp_3d<T>::register_points(vgl_pointset_3d<T> const& source, vgl_h_matrix_3d<T> const& initial)
+{
+  H_.set(initial.get_matrix());
+  converged_ = false;
+  stats_.clear();
+  const std::size_t n = source.size();
+  if (n == 0 || tree_.empty())
+    return false;
+  if (metric_ == point_to_plane && !target_.has_normals())
+    vgl_estimate_normals(target_, tree_, 10, T(0), nthreads_);
+  const std::size_t min_pairs = metric_ == point_to_plane ? 6 : 3;
+
+  // the size of the source, for the translation tolerance
+  std::vector<vgl_point_3d<T> > const& sp = source.points();
+  double lo[3] = { sp[0].x(), sp[0].y(), sp[0].z() }, hi[3] = { lo[0], lo[1], lo[2] };
+  for (std::size_t i = 1; i < n; ++i) {
+    const double v[3] = { double(sp[i].x()), double(sp[i].y()), double(sp[i].z()) };
+    for (unsigned k = 0; k < 3; ++k) {
+      lo[k] = std::min(lo[k], v[k]);
+      hi[k] = std::max(hi[k], v[k]);
+    }
+  }
+  const double size = std::sqrt((hi[0] - lo[0]) * (hi[0] - lo[0]) + (hi[1] - lo[1]) * (hi[1] - lo[1]) +
+                                (hi[2] - lo[2]) * (hi[2] - lo[2]));
+
+  std::vector<vgl_point_3d<T> > sub;
+  for (unsigned level = levels_; level-- > 0;) {
+    const std::size_t stride = std::size_t(1) << (2 * level);
+    if (level > 0 && n / stride < 8 * min_pairs)
+      continue; // too coarse to be useful
+    sub.clear();
+    for (std::size_t i = 0; i < n; i += stride)
+      sub.push_back(sp[i]);
+    double prev_rms = -1.0;
+    bool done = false;
+    for (unsigned it = 0; it < max_iterations_ && !done; ++it) {
+      if (match(sub) < min_pairs)
+        return false;
+      iteration_stats s;
+      s.level = level;
+      s.n_source = sub.size();
+      if (!update(s))
+        return false;
+      stats_.push_back(s);
+      const double rms = s.rms;
+      done = (s.rotation < tolerance_ && s.translation <= tolerance_ * size) ||
+             (prev_rms >= 0.0 && std::fabs(prev_rms - rms) <= tolerance_ * prev_rms);
+      prev_rms = rms;
+    }
+    converged_ = done;
+  }
+  return true;
+}
+
+#endif // vgl_icp_3d_h_
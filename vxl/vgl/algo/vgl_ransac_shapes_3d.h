@@ -0,0 +1,906 @@
+// This is core/vgl/algo/vgl_ransac_shapes_3d.h
+#ifndef vgl_ransac_shapes_3d_h_
+#define vgl_ransac_shapes_3d_h_
+//:
+// \file
+// \brief Multi-model RANSAC segmentation of a vgl_pointset_3d into planes, spheres and cylinders
+//
+//  Follows R. Schnabel, R. Wahl and R. Klein, "Efficient RANSAC for
+//  point-cloud shape detection", Computer Graphics Forum 26(2), 2007.
+//  Shapes are found one at a time, largest first, and their inliers removed
+//  from the set, until a shape of min_support points would have been found
+//  with the required probability if there were one.
+//
+//  - Hypotheses come from minimal samples: three points for a plane, four
+//    for a sphere, or, if the set has normals, three oriented points for
+//    every shape type, one of them only checking the other two.  Cylinders
+//    need normals and are not generated without them.
+//  - The samples of a hypothesis are drawn from one cell of an octree, so
+//    that they likely lie on the same surface.  The octree is implicit, a
+//    Morton-ordered index as in vgl_octree_3d, and the octree level is
+//    chosen with a probability that adapts to the levels that have produced
+//    shapes.
+//  - The points are kept in a random order, so any prefix of them is a
+//    random subset.  Hypotheses are scored on growing prefixes, in
+//    parallel, and are no longer scored once a confidence interval of their
+//    support falls below that of the best one, or is narrow enough to tell
+//    that they are about as good.  Only the winner is scored on all the
+//    points.
+//  - The winner is refitted to its inliers by least squares before its
+//    inliers are collected.
+//
+//  Unlike the paper, inliers are not restricted to a connected component
+//  of the shape.
+//
+// \verbatim
+//  Modifications
+// \endverbatim
+
+#include <vector>
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vnl/vnl_matrix_fixed.h>
+#include <vnl/vnl_vector_fixed.h>
+#include <vnl/vnl_det.h>
+#include <vnl/vnl_inverse.h>
+#include <vnl/algo/vnl_symmetric_eigensystem.h>
+#include <vgl/vgl_point_3d.h>
+#include <vgl/vgl_vector_3d.h>
+#include <vgl/vgl_box_3d.h>
+#include <vgl/vgl_plane_3d.h>
+#include <vgl/vgl_sphere_3d.h>
+#include <vgl/vgl_cylinder.h>
+#include <vgl/vgl_pointset_3d.h>
+#include <vgl/vgl_octree_3d.h>
+#include <vgl/vgl_parallel.h>
+
+template <class T>
+class vgl_ransac_shapes_3d
+{
+ public:
+  enum shape_type { plane = 1, sphere = 2, cylinder = 4 };
+
+  //: A detected shape and the indices of its inliers in the input point set.
+  //  Only the member of the shape's type is set.
+  struct shape
+  {
+    shape_type type;
+    vgl_plane_3d<T> plane;
+    vgl_sphere_3d<T> sphere;
+    vgl_cylinder<T> cylinder;
+    std::vector<unsigned> inliers;
+  };
+
+  //: Prepare the segmentation of ptset; nthreads = 0 uses std::thread::hardware_concurrency() threads.
+  //  The defaults are an inlier distance of 1% of the bounding box diagonal,
+  //  a normal deviation of at most 25 degrees, shapes of at least 0.5% of the
+  //  points (and 10), and a probability of 0.99.
+  explicit vgl_ransac_shapes_3d(vgl_pointset_3d<T> const& ptset, unsigned nthreads = 0);
+
+  //: largest distance of an inlier from its shape
+  void set_epsilon(T eps) { epsilon_ = eps; }
+  //: smallest |cos| of the angle between the normal of an inlier and that of the shape
+  void set_normal_threshold(T cos_angle) { normal_threshold_ = cos_angle; }
+  //: smallest number of inliers of a shape
+  void set_min_support(std::size_t n) { min_support_ = n; }
+  //: probability of detecting a shape of min_support points
+  void set_probability(double p) { probability_ = p; }
+  //: the shapes to look for, an or of shape_type values
+  void set_shape_types(unsigned types) { shape_types_ = types; }
+  //: stop after drawing this many minimal samples for one shape (0 for no limit)
+  void set_max_samples(std::size_t n) { max_samples_ = n; }
+  void set_seed(unsigned seed) { rng_.seed(seed); }
+
+  T epsilon() const { return epsilon_; }
+  std::size_t min_support() const { return min_support_; }
+  bool has_normals() const { return !nx_.empty(); }
+
+  //: Detect shapes in the points that are not yet assigned to one; returns the number found.
+  std::size_t detect();
+
+  //: the shapes found so far, in the order found
+  std::vector<shape> const& shapes() const { return shapes_; }
+
+  //: indices of the points not assigned to a shape, in increasing order
+  void unassigned(std::vector<unsigned>& indices) const;
+
+  //: distance of p from s
+  static T distance(shape const& s, vgl_point_3d<T> const& p);
+
+ private:
+  typedef typename vgl_octree_3d<T>::key_type key_type;
+
+  //: A hypothesis, with its support counted on the first bound(level) points.
+  //  plane: n.p + d = 0, par = (n, d); sphere: par = (c, r);
+  //  cylinder: axis through a with unit direction u, par = (a, u, r).
+  struct candidate
+  {
+    shape_type type;
+    T par[7];
+    unsigned sample[4];    // input indices of the sample points
+    unsigned nsample;
+    unsigned octree_level; // level of the cell the sample came from
+    unsigned level;        // scored on the first bound(level) points
+    std::size_t count;     // inliers among them
+  };
+
+  //: number of points a candidate at the given scoring level has been scored on
+  std::size_t bound(unsigned level) const
+  {
+    if (level == 0) return 0;
+    const std::size_t b = std::size_t(first_chunk) << (level - 1);
+    return level > 40 || b > n_ ? n_ : b;
+  }
+  bool fully_scored(candidate const& c) const { return bound(c.level) >= n_; }
+
+  //: confidence interval of the support of c among all n_ points
+  void support_bounds(candidate const& c, double& lower, double& upper) const;
+
+  //: probability of drawing a sample of a shape of m points within t samples
+  double detection_probability(double m, double t) const;
+
+  //: Draw a minimal sample and add the hypotheses it defines to pool; returns false if no sample was found.
+  bool generate(std::vector<candidate>& pool);
+  bool draw_sample(unsigned level, unsigned k, unsigned pos[4]);
+  bool make_plane(unsigned const pos[4], candidate& c) const;
+  bool make_sphere(unsigned const pos[4], unsigned k, candidate& c) const;
+  bool make_cylinder(unsigned const pos[4], candidate& c) const;
+  //: whether point i is an inlier of c; used to verify hypotheses
+  bool compatible(candidate const& c, unsigned i) const;
+
+  //: Index of the best candidate of pool, scoring candidates further until it stands out; -1 if pool is empty.
+  int best_candidate(std::vector<candidate>& pool);
+
+  //: Add the inliers among points [begin, end) of each candidate to its count.
+  void score(std::vector<candidate*> const& cands, std::size_t begin, std::size_t end);
+  //: counts[c] += inliers of cands[c] among points [begin, end), serially
+  void count_inliers(candidate* const* cands, std::size_t nc, std::size_t begin, std::size_t end,
+                     std::size_t* counts) const;
+  //: in[i - begin] = 1 if point i in [begin, end) is an inlier of c, else 0
+  void mark(candidate const& c, std::size_t begin, std::size_t end, unsigned char* in) const;
+  //: mask[i] = 1 for the inliers of c among the n_ points; returns their number
+  std::size_t inliers(candidate const& c, std::vector<unsigned char>& mask) const;
+  //: least squares fit of c to the points marked in mask
+  bool refit(candidate& c, std::vector<unsigned char> const& mask) const;
+
+  //: Score c on all points, refit it and, if it keeps min_support inliers, remove them as a new shape.
+  bool extract(candidate c);
+
+  //: number of points the first scoring level covers
+  static const unsigned first_chunk = 1024;
+  //: number of points below which scoring is not split over threads
+  static const unsigned min_chunk = 16384;
+
+  T epsilon_;
+  T normal_threshold_;
+  std::size_t min_support_;
+  double probability_;
+  unsigned shape_types_;
+  std::size_t max_samples_;
+  unsigned nthreads_;
+  std::mt19937 rng_;
+
+  //: the unassigned points, in random order, are the first n_ entries
+  std::size_t n_;
+  std::vector<T> x_, y_, z_, nx_, ny_, nz_;
+  std::vector<unsigned> index_;   // input index of each point
+  std::vector<key_type> key_;     // octree key of each point
+  //: (key, position) of the unassigned points, sorted by key
+  std::vector<std::pair<key_type, unsigned> > cells_;
+  unsigned depth_;
+  std::vector<double> level_score_; // support of the shapes found from each octree level
+  std::vector<unsigned char> assigned_; // by input index
+  std::vector<shape> shapes_;
+};
+
+// =================  implementation  ===================
+
+template <class T>
+vgl_ransac_shapes_3d<T>::vgl_ransac_shapes_3d(vgl_pointset_3d<T> const& ptset, unsigned nthreads)
+  : normal_threshold_(T(0.9)), probability_(0.99), shape_types_(plane | sphere | cylinder),
+    max_samples_(0), nthreads_(vgl_parallel_detail::thread_count(nthreads)), rng_(5489u), n_(ptset.size())
+{
+  const std::size_t n = n_;
+  min_support_ = std::max(std::size_t(10), n / 200);
+  assigned_.assign(n, 0);
+  vgl_box_3d<T> box;
+  for (std::size_t i = 0; i < n; ++i)
+    box.add(ptset.p(unsigned(i)));
+  epsilon_ = n ? T(0.01) * T(std::sqrt(double(box.width()) * box.width() + double(box.height()) * box.height() +
+                                       double(box.depth()) * box.depth()))
+               : T(0);
+
+  // random order, so that every prefix is a random subset
+  index_.resize(n);
+  for (std::size_t i = 0; i < n; ++i)
+    index_[i] = unsigned(i);
+  std::shuffle(index_.begin(), index_.end(), rng_);
+  x_.resize(n); y_.resize(n); z_.resize(n);
+  const bool normals = ptset.has_normals() && ptset.normals().size() == n;
+  if (normals) {
+    nx_.resize(n); ny_.resize(n); nz_.resize(n);
+  }
+  std::vector<vgl_point_3d<T> > const& pts = ptset.points();
+  for (std::size_t i = 0; i < n; ++i) {
+    vgl_point_3d<T> const& p = pts[index_[i]];
+    x_[i] = p.x(); y_[i] = p.y(); z_[i] = p.z();
+    if (normals) {
+      vgl_vector_3d<T> const& v = ptset.normals()[index_[i]];
+      const T len = T(v.length());
+      const T s = len > T(0) ? T(1) / len : T(0);
+      nx_[i] = v.x() * s; ny_[i] = v.y() * s; nz_[i] = v.z() * s;
+    }
+  }
+
+  // the octree: about 10 points per cell of the finest level on a surface
+  depth_ = 2;
+  while (depth_ < 20 && (std::size_t(10) << (2 * depth_)) < n)
+    ++depth_;
+  level_score_.assign(depth_ + 1, 0.1);
+  key_.resize(n);
+  cells_.resize(n);
+  if (n == 0)
+    return;
+  const double side = std::max(std::max(double(box.width()), double(box.height())), double(box.depth()));
+  const double scale = side > 0.0 ? double(1u << depth_) / side : 0.0;
+  const unsigned top = (1u << depth_) - 1;
+  for (std::size_t i = 0; i < n; ++i) {
+    const unsigned ci = std::min(top, unsigned((x_[i] - box.min_x()) * scale));
+    const unsigned cj = std::min(top, unsigned((y_[i] - box.min_y()) * scale));
+    const unsigned ck = std::min(top, unsigned((z_[i] - box.min_z()) * scale));
+    key_[i] = vgl_octree_3d<T>::morton_encode(ci, cj, ck);
+    cells_[i] = std::make_pair(key_[i], unsigned(i));
+  }
+  // sort slices in parallel, then merge them
+  const unsigned nt = vgl_parallel_detail::thread_count(nthreads_, n, min_chunk);
+  std::vector<std::size_t> cut(nt + 1);
+  for (unsigned t = 0; t <= nt; ++t)
+    cut[t] = n * t / nt;
+  vgl_parallel_detail::parallel_for(n, nt, [this](unsigned, std::size_t begin, std::size_t end) {
+    std::sort(cells_.begin() + begin, cells_.begin() + end);
+  });
+  for (unsigned w = 1; w < nt; w *= 2)
+    for (unsigned t = 0; t + w < nt; t += 2 * w)
+      std::inplace_merge(cells_.begin() + cut[t], cells_.begin() + cut[t + w],
+                         cells_.begin() + cut[std::min(nt, t + 2 * w)]);
+}
+
+template <class T>
+void vgl_ransac_shapes_3d<T>::unassigned(std::vector<unsigned>& indices) const
+{
+  indices.clear();
+  for (std::size_t i = 0; i < assigned_.size(); ++i)
+    if (!assigned_[i])
+      indices.push_back(unsigned(i));
+}
+
+template <class T>
+T vgl_ransac_shapes_3d<T>::distance(shape const& s, vgl_point_3d<T> const& p)
+{
+  switch (s.type) {
+    case plane: {
+      vgl_plane_3d<T> const& pl = s.plane;
+      const T len = T(std::sqrt(pl.a() * pl.a() + pl.b() * pl.b() + pl.c() * pl.c()));
+      return T(std::fabs(pl.a() * p.x() + pl.b() * p.y() + pl.c() * p.z() + pl.d())) / len;
+    }
+    case sphere:
+      return T(std::fabs((p - s.sphere.centre()).length() - s.sphere.radius()));
+    case cylinder: default: {
+      vgl_vector_3d<T> u = normalized(s.cylinder.orientation()), v = p - s.cylinder.center();
+      return T(std::fabs((v - dot_product(v, u) * u).length() - s.cylinder.radius()));
+    }
+  }
+}
+
+template <class T>
+void vgl_ransac_shapes_3d<T>::support_bounds(candidate const& c, double& lower, double& upper) const
+{
+  const double m = double(bound(c.level)), k = double(c.count), N = double(n_);
+  if (m >= N) {
+    lower = upper = k;
+    return;
+  }
+  // normal approximation of the hypergeometric distribution, two standard deviations
+  const double est = k * N / m;
+  const double sd = N / m * std::sqrt((k + 1.0) * (1.0 - k / (m + 1.0)) * (N - m) / N);
+  lower = std::max(k, est - 2.0 * sd);
+  upper = std::min(k + (N - m), est + 2.0 * sd);
+}
+
+template <class T>
+double vgl_ransac_shapes_3d<T>::detection_probability(double m, double t) const
+{
+  // a sample of k points is drawn from the shape with probability about m / (n d 2^(k-1))
+  // for d octree levels, as its first point lies on the shape with probability m / n and
+  // the others are drawn from a cell around it, on the right level with probability 1/d
+  const unsigned k = (has_normals() || !(shape_types_ & sphere)) ? 3 : 4;
+  const double p = std::min(1.0, m / (double(n_) * double(depth_) * double(1u << (k - 1))));
+  return 1.0 - std::pow(1.0 - p, t);
+}
+
+template <class T>
+bool vgl_ransac_shapes_3d<T>::draw_sample(unsigned level, unsigned k, unsigned pos[4])
+{
+  std::uniform_int_distribution<std::size_t> uniform(0, n_ - 1);
+  pos[0] = unsigned(uniform(rng_));
+  // the cell of pos[0] at the level: the keys that agree with its key above the level
+  const unsigned shift = 3 * (depth_ - level);
+  const key_type cell = key_[pos[0]] >> shift;
+  typedef std::pair<key_type, unsigned> entry;
+  typename std::vector<entry>::iterator lo = std::lower_bound(cells_.begin(), cells_.end(), entry(cell << shift, 0u));
+  typename std::vector<entry>::iterator hi = std::lower_bound(lo, cells_.end(), entry((cell + 1) << shift, 0u));
+  const std::size_t m = std::size_t(hi - lo);
+  if (m < k)
+    return false;
+  std::uniform_int_distribution<std::size_t> in_cell(0, m - 1);
+  for (unsigned j = 1; j < k; ++j) {
+    unsigned tries = 0;
+    bool repeated;
+    do {
+      pos[j] = lo[in_cell(rng_)].second;
+      repeated = false;
+      for (unsigned i = 0; i < j; ++i)
+        repeated = repeated || pos[i] == pos[j];
+    } while (repeated && ++tries < 8);
+    if (repeated)
+      return false;
+  }
+  return true;
+}
+
+template <class T>
+bool vgl_ransac_shapes_3d<T>::compatible(candidate const& c, unsigned i) const
+{
+  const T px = x_[i], py = y_[i], pz = z_[i];
+  T d, gx, gy, gz; // distance, and direction of the shape normal
+  if (c.type == plane) {
+    d = c.par[0] * px + c.par[1] * py + c.par[2] * pz + c.par[3];
+    gx = c.par[0]; gy = c.par[1]; gz = c.par[2];
+  }
+  else {
+    gx = px - c.par[0]; gy = py - c.par[1]; gz = pz - c.par[2];
+    T r = c.par[3];
+    if (c.type == cylinder) {
+      const T t = gx * c.par[3] + gy * c.par[4] + gz * c.par[5];
+      gx -= t * c.par[3]; gy -= t * c.par[4]; gz -= t * c.par[5];
+      r = c.par[6];
+    }
+    const T len = T(std::sqrt(gx * gx + gy * gy + gz * gz));
+    if (!(len > T(0)))
+      return false;
+    d = len - r;
+    gx /= len; gy /= len; gz /= len;
+  }
+  if (!(std::fabs(d) < epsilon_))
+    return false;
+  return !has_normals() || std::fabs(gx * nx_[i] + gy * ny_[i] + gz * nz_[i]) >= normal_threshold_;
+}
+
+template <class T>
+bool vgl_ransac_shapes_3d<T>::make_plane(unsigned const pos[4], candidate& c) const
+{
+  const T ux = x_[pos[1]] - x_[pos[0]], uy = y_[pos[1]] - y_[pos[0]], uz = z_[pos[1]] - z_[pos[0]];
+  const T vx = x_[pos[2]] - x_[pos[0]], vy = y_[pos[2]] - y_[pos[0]], vz = z_[pos[2]] - z_[pos[0]];
+  T nx = uy * vz - uz * vy, ny = uz * vx - ux * vz, nz = ux * vy - uy * vx;
+  const T len = T(std::sqrt(nx * nx + ny * ny + nz * nz));
+  if (!(len > T(0)))
+    return false;
+  nx /= len; ny /= len; nz /= len;
+  c.type = plane;
+  c.par[0] = nx; c.par[1] = ny; c.par[2] = nz;
+  c.par[3] = -(nx * x_[pos[0]] + ny * y_[pos[0]] + nz * z_[pos[0]]);
+  if (has_normals())
+    for (unsigned j = 0; j < 3; ++j)
+      if (!compatible(c, pos[j]))
+        return false;
+  return true;
+}
+
+template <class T>
+bool vgl_ransac_shapes_3d<T>::make_sphere(unsigned const pos[4], unsigned k, candidate& c) const
+{
+  double cx, cy, cz;
+  if (has_normals()) {
+    // the midpoint of the closest points of the normal lines of the first two points
+    const double p0[3] = { x_[pos[0]], y_[pos[0]], z_[pos[0]] }, p1[3] = { x_[pos[1]], y_[pos[1]], z_[pos[1]] };
+    const double n0[3] = { nx_[pos[0]], ny_[pos[0]], nz_[pos[0]] }, n1[3] = { nx_[pos[1]], ny_[pos[1]], nz_[pos[1]] };
+    const double w[3] = { p0[0] - p1[0], p0[1] - p1[1], p0[2] - p1[2] };
+    const double b = n0[0] * n1[0] + n0[1] * n1[1] + n0[2] * n1[2];
+    const double d0 = n0[0] * w[0] + n0[1] * w[1] + n0[2] * w[2], d1 = n1[0] * w[0] + n1[1] * w[1] + n1[2] * w[2];
+    const double den = 1.0 - b * b;
+    if (!(den > 1e-6))
+      return false;
+    const double s = (b * d1 - d0) / den, t = (d1 - b * d0) / den;
+    cx = 0.5 * (p0[0] + s * n0[0] + p1[0] + t * n1[0]);
+    cy = 0.5 * (p0[1] + s * n0[1] + p1[1] + t * n1[1]);
+    cz = 0.5 * (p0[2] + s * n0[2] + p1[2] + t * n1[2]);
+  }
+  else {
+    if (k < 4)
+      return false;
+    // the centre is equidistant from the four points: 2 (p_j - p_0).c = |p_j|^2 - |p_0|^2
+    vnl_matrix_fixed<double, 3, 3> A;
+    double rhs[3];
+    const double q0 = double(x_[pos[0]]) * x_[pos[0]] + double(y_[pos[0]]) * y_[pos[0]] + double(z_[pos[0]]) * z_[pos[0]];
+    for (unsigned j = 1; j < 4; ++j) {
+      A[j - 1][0] = 2.0 * (double(x_[pos[j]]) - x_[pos[0]]);
+      A[j - 1][1] = 2.0 * (double(y_[pos[j]]) - y_[pos[0]]);
+      A[j - 1][2] = 2.0 * (double(z_[pos[j]]) - z_[pos[0]]);
+      rhs[j - 1] = double(x_[pos[j]]) * x_[pos[j]] + double(y_[pos[j]]) * y_[pos[j]] + double(z_[pos[j]]) * z_[pos[j]] - q0;
+    }
+    const double det = vnl_det(A);
+    const double scale = A.array().abs().maxCoeff();
+    if (!(std::fabs(det) > 1e-9 * scale * scale * scale))
+      return false;
+    vnl_matrix_fixed<double, 3, 3> Ai = vnl_inverse(A);
+    cx = Ai[0][0] * rhs[0] + Ai[0][1] * rhs[1] + Ai[0][2] * rhs[2];
+    cy = Ai[1][0] * rhs[0] + Ai[1][1] * rhs[1] + Ai[1][2] * rhs[2];
+    cz = Ai[2][0] * rhs[0] + Ai[2][1] * rhs[1] + Ai[2][2] * rhs[2];
+  }
+  double r = 0.0;
+  for (unsigned j = 0; j < 2; ++j)
+    r += std::sqrt((x_[pos[j]] - cx) * (x_[pos[j]] - cx) + (y_[pos[j]] - cy) * (y_[pos[j]] - cy) +
+                   (z_[pos[j]] - cz) * (z_[pos[j]] - cz));
+  c.type = sphere;
+  c.par[0] = T(cx); c.par[1] = T(cy); c.par[2] = T(cz); c.par[3] = T(r / 2);
+  if (!(c.par[3] > epsilon_))
+    return false;
+  for (unsigned j = 0; j < k; ++j)
+    if (!compatible(c, pos[j]))
+      return false;
+  return true;
+}
+
+template <class T>
+bool vgl_ransac_shapes_3d<T>::make_cylinder(unsigned const pos[4], candidate& c) const
+{
+  if (!has_normals())
+    return false;
+  // the axis is normal to both normals, and passes through the closest points of the normal lines
+  const double p0[3] = { x_[pos[0]], y_[pos[0]], z_[pos[0]] }, p1[3] = { x_[pos[1]], y_[pos[1]], z_[pos[1]] };
+  const double n0[3] = { nx_[pos[0]], ny_[pos[0]], nz_[pos[0]] }, n1[3] = { nx_[pos[1]], ny_[pos[1]], nz_[pos[1]] };
+  double u[3] = { n0[1] * n1[2] - n0[2] * n1[1], n0[2] * n1[0] - n0[0] * n1[2], n0[0] * n1[1] - n0[1] * n1[0] };
+  const double ulen = std::sqrt(u[0] * u[0] + u[1] * u[1] + u[2] * u[2]);
+  if (!(ulen > 1e-3))
+    return false;
+  u[0] /= ulen; u[1] /= ulen; u[2] /= ulen;
+  const double w[3] = { p0[0] - p1[0], p0[1] - p1[1], p0[2] - p1[2] };
+  const double b = n0[0] * n1[0] + n0[1] * n1[1] + n0[2] * n1[2];
+  const double d0 = n0[0] * w[0] + n0[1] * w[1] + n0[2] * w[2], d1 = n1[0] * w[0] + n1[1] * w[1] + n1[2] * w[2];
+  const double den = 1.0 - b * b;
+  const double s = (b * d1 - d0) / den, t = (d1 - b * d0) / den;
+  c.type = cylinder;
+  for (unsigned i = 0; i < 3; ++i) {
+    c.par[i] = T(0.5 * (p0[i] + s * n0[i] + p1[i] + t * n1[i]));
+    c.par[3 + i] = T(u[i]);
+  }
+  // the radius is the distance of the first two points from the axis
+  double r = 0.0;
+  for (unsigned j = 0; j < 2; ++j) {
+    const double v[3] = { x_[pos[j]] - c.par[0], y_[pos[j]] - c.par[1], z_[pos[j]] - c.par[2] };
+    const double a = v[0] * u[0] + v[1] * u[1] + v[2] * u[2];
+    r += std::sqrt(std::max(0.0, v[0] * v[0] + v[1] * v[1] + v[2] * v[2] - a * a));
+  }
+  c.par[6] = T(r / 2);
+  if (!(c.par[6] > epsilon_))
+    return false;
+  for (unsigned j = 0; j < 3; ++j)
+    if (!compatible(c, pos[j]))
+      return false;
+  return true;
+}
+
+template <class T>
+bool vgl_ransac_shapes_3d<T>::generate(std::vector<candidate>& pool)
+{
+  // the octree level, favouring the levels that shapes have been found from
+  double total = 0.0;
+  for (unsigned l = 1; l <= depth_; ++l)
+    total += level_score_[l];
+  std::uniform_real_distribution<double> u01(0.0, 1.0);
+  double x = u01(rng_), acc = 0.0;
+  unsigned level = depth_;
+  for (unsigned l = 1; l <= depth_; ++l) {
+    acc += 0.9 * level_score_[l] / total + 0.1 / depth_;
+    if (x < acc) {
+      level = l;
+      break;
+    }
+  }
+  const unsigned k = (!has_normals() && (shape_types_ & sphere)) ? 4 : 3;
+  unsigned pos[4];
+  if (!draw_sample(level, k, pos))
+    return false;
+  candidate c;
+  c.nsample = k;
+  for (unsigned j = 0; j < k; ++j)
+    c.sample[j] = index_[pos[j]];
+  c.octree_level = level;
+  c.level = 0;
+  c.count = 0;
+  if ((shape_types_ & plane) && make_plane(pos, c))
+    pool.push_back(c);
+  if ((shape_types_ & sphere) && make_sphere(pos, k, c))
+    pool.push_back(c);
+  if ((shape_types_ & cylinder) && make_cylinder(pos, c))
+    pool.push_back(c);
+  return true;
+}
+
+template <class T>
+void vgl_ransac_shapes_3d<T>::mark(candidate const& c, std::size_t begin, std::size_t end, unsigned char* in) const
+{
+  const bool normals = has_normals();
+  const T eps = epsilon_, thr = normal_threshold_;
+  const T* x = x_.data(); const T* y = y_.data(); const T* z = z_.data();
+  const T* nx = nx_.data(); const T* ny = ny_.data(); const T* nz = nz_.data();
+  const T p0 = c.par[0], p1 = c.par[1], p2 = c.par[2], p3 = c.par[3];
+  // branch-free bodies, so that the loops vectorise
+  if (c.type == plane) {
+    for (std::size_t i = begin; i < end; ++i)
+      in[i - begin] = std::fabs(p0 * x[i] + p1 * y[i] + p2 * z[i] + p3) < eps;
+    if (normals)
+      for (std::size_t i = begin; i < end; ++i)
+        in[i - begin] &= std::fabs(p0 * nx[i] + p1 * ny[i] + p2 * nz[i]) >= thr;
+  }
+  else if (c.type == sphere) {
+    for (std::size_t i = begin; i < end; ++i) {
+      const T gx = x[i] - p0, gy = y[i] - p1, gz = z[i] - p2;
+      const T len = std::sqrt(gx * gx + gy * gy + gz * gz);
+      unsigned char ok = std::fabs(len - p3) < eps;
+      if (normals)
+        ok &= std::fabs(gx * nx[i] + gy * ny[i] + gz * nz[i]) >= thr * len;
+      in[i - begin] = ok;
+    }
+  }
+  else {
+    const T p4 = c.par[4], p5 = c.par[5], r = c.par[6];
+    for (std::size_t i = begin; i < end; ++i) {
+      T gx = x[i] - p0, gy = y[i] - p1, gz = z[i] - p2;
+      const T t = gx * p3 + gy * p4 + gz * p5;
+      gx -= t * p3; gy -= t * p4; gz -= t * p5;
+      const T len = std::sqrt(gx * gx + gy * gy + gz * gz);
+      unsigned char ok = std::fabs(len - r) < eps;
+      if (normals)
+        ok &= std::fabs(gx * nx[i] + gy * ny[i] + gz * nz[i]) >= thr * len;
+      in[i - begin] = ok;
+    }
+  }
+}
+
+template <class T>
+void vgl_ransac_shapes_3d<T>::count_inliers(candidate* const* cands, std::size_t nc, std::size_t begin,
+                                            std::size_t end, std::size_t* counts) const
+{
+  // candidates one after the other over a block of points that stays in cache
+  const std::size_t block = 1024;
+  unsigned char in[block];
+  for (std::size_t b = begin; b < end; b += block) {
+    const std::size_t e = std::min(end, b + block);
+    for (std::size_t ci = 0; ci < nc; ++ci) {
+      mark(*cands[ci], b, e, in);
+      std::size_t cnt = 0;
+      for (std::size_t i = 0; i < e - b; ++i)
+        cnt += in[i];
+      counts[ci] += cnt;
+    }
+  }
+}
+
+template <class T>
+void vgl_ransac_shapes_3d<T>::score(std::vector<candidate*> const& cands, std::size_t begin, std::size_t end)
+{
+  const std::size_t nc = cands.size();
+  if (nc == 0 || end <= begin)
+    return;
+  const unsigned nt = vgl_parallel_detail::thread_count(nthreads_, end - begin, min_chunk);
+  std::vector<std::size_t> counts(nc * nt, 0);
+  vgl_parallel_detail::parallel_for(end - begin, nt, [&](unsigned t, std::size_t b, std::size_t e) {
+    count_inliers(&cands[0], nc, begin + b, begin + e, &counts[nc * t]);
+  });
+  for (std::size_t ci = 0; ci < nc; ++ci)
+    for (unsigned t = 0; t < nt; ++t)
+      cands[ci]->count += counts[nc * t + ci];
+}
+
+template <class T>
+int vgl_ransac_shapes_3d<T>::best_candidate(std::vector<candidate>& pool)
+{
+  std::vector<double> lower, upper;
+  std::vector<std::vector<candidate*> > by_level;
+  while (true) {
+    // drop the candidates that cannot reach min_support
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < pool.size(); ++i) {
+      double lo, up;
+      support_bounds(pool[i], lo, up);
+      if (pool[i].level == 0 || up >= double(min_support_))
+        pool[kept++] = pool[i];
+    }
+    pool.resize(kept);
+    if (pool.empty())
+      return -1;
+    lower.resize(pool.size());
+    upper.resize(pool.size());
+    int best = -1;
+    for (std::size_t i = 0; i < pool.size(); ++i) {
+      support_bounds(pool[i], lower[i], upper[i]);
+      if (pool[i].level > 0 && (best < 0 || lower[i] > lower[best]))
+        best = int(i);
+    }
+    // Score further the unscored candidates, and those that might beat the best.
+    // Candidates of the same shape never separate, so the scoring stops once
+    // the confidence intervals are within precision of the best support.
+    const double precision = best >= 0 ? 0.1 * lower[best] : 0.0;
+    by_level.clear();
+    for (std::size_t i = 0; i < pool.size(); ++i) {
+      const bool advance = pool[i].level == 0 ||
+                           (upper[i] - lower[i] > precision && (int(i) == best || upper[i] > lower[best]));
+      if (!advance || fully_scored(pool[i]))
+        continue;
+      if (by_level.size() <= pool[i].level)
+        by_level.resize(pool[i].level + 1);
+      by_level[pool[i].level].push_back(&pool[i]);
+    }
+    if (by_level.empty())
+      return best;
+    for (unsigned l = 0; l < by_level.size(); ++l) {
+      if (by_level[l].empty())
+        continue;
+      score(by_level[l], bound(l), bound(l + 1));
+      for (std::size_t j = 0; j < by_level[l].size(); ++j)
+        by_level[l][j]->level = l + 1;
+    }
+  }
+}
+
+template <class T>
+std::size_t vgl_ransac_shapes_3d<T>::inliers(candidate const& c, std::vector<unsigned char>& mask) const
+{
+  mask.assign(n_, 0);
+  if (n_ == 0)
+    return 0;
+  const unsigned nt = vgl_parallel_detail::thread_count(nthreads_, n_, min_chunk);
+  std::vector<std::size_t> counts(nt, 0);
+  vgl_parallel_detail::parallel_for(n_, nt, [&](unsigned t, std::size_t begin, std::size_t end) {
+    mark(c, begin, end, &mask[begin]);
+    for (std::size_t i = begin; i < end; ++i)
+      counts[t] += mask[i];
+  });
+  std::size_t total = 0;
+  for (unsigned t = 0; t < nt; ++t)
+    total += counts[t];
+  return total;
+}
+
+template <class T>
+bool vgl_ransac_shapes_3d<T>::refit(candidate& c, std::vector<unsigned char> const& mask) const
+{
+  // centroid, for conditioning
+  double m[3] = { 0.0, 0.0, 0.0 };
+  std::size_t n = 0;
+  for (std::size_t i = 0; i < n_; ++i)
+    if (mask[i]) {
+      m[0] += x_[i]; m[1] += y_[i]; m[2] += z_[i];
+      ++n;
+    }
+  if (n < 4)
+    return false;
+  m[0] /= n; m[1] /= n; m[2] /= n;
+
+  if (c.type == plane) {
+    // the normal is the direction of least variance
+    vnl_matrix_fixed<double, 3, 3> C(0.0), V;
+    vnl_vector_fixed<double, 3> D;
+    for (std::size_t i = 0; i < n_; ++i)
+      if (mask[i]) {
+        const double v[3] = { x_[i] - m[0], y_[i] - m[1], z_[i] - m[2] };
+        for (unsigned r = 0; r < 3; ++r)
+          for (unsigned s = 0; s < 3; ++s)
+            C[r][s] += v[r] * v[s];
+      }
+    if (!vnl_symmetric_eigensystem_compute(C, V, D))
+      return false;
+    for (unsigned r = 0; r < 3; ++r)
+      c.par[r] = T(V[r][0]);
+    c.par[3] = T(-(V[0][0] * m[0] + V[1][0] * m[1] + V[2][0] * m[2]));
+    return true;
+  }
+  if (c.type == sphere) {
+    // algebraic fit |v|^2 + a.v + b = 0, v = p - m: the normal equations of (v, 1)
+    vnl_matrix_fixed<double, 4, 4> A(0.0);
+    double rhs[4] = { 0.0, 0.0, 0.0, 0.0 };
+    for (std::size_t i = 0; i < n_; ++i)
+      if (mask[i]) {
+        const double v[4] = { x_[i] - m[0], y_[i] - m[1], z_[i] - m[2], 1.0 };
+        const double q = v[0] * v[0] + v[1] * v[1] + v[2] * v[2];
+        for (unsigned r = 0; r < 4; ++r) {
+          for (unsigned s = 0; s < 4; ++s)
+            A[r][s] += v[r] * v[s];
+          rhs[r] -= q * v[r];
+        }
+      }
+    if (!(std::fabs(vnl_det(A)) > 0.0))
+      return false;
+    vnl_matrix_fixed<double, 4, 4> Ai = vnl_inverse(A);
+    double a[4];
+    for (unsigned r = 0; r < 4; ++r)
+      a[r] = Ai[r][0] * rhs[0] + Ai[r][1] * rhs[1] + Ai[r][2] * rhs[2] + Ai[r][3] * rhs[3];
+    const double cc[3] = { -a[0] / 2, -a[1] / 2, -a[2] / 2 };
+    const double r2 = cc[0] * cc[0] + cc[1] * cc[1] + cc[2] * cc[2] - a[3];
+    if (!(r2 > 0.0))
+      return false;
+    c.par[0] = T(cc[0] + m[0]); c.par[1] = T(cc[1] + m[1]); c.par[2] = T(cc[2] + m[2]);
+    c.par[3] = T(std::sqrt(r2));
+    return true;
+  }
+  // cylinder: the axis is the direction the normals vary least along,
+  // then a circle is fitted to the points projected along it
+  vnl_matrix_fixed<double, 3, 3> N(0.0), V;
+  vnl_vector_fixed<double, 3> D;
+  for (std::size_t i = 0; i < n_; ++i)
+    if (mask[i]) {
+      const double v[3] = { nx_[i], ny_[i], nz_[i] };
+      for (unsigned r = 0; r < 3; ++r)
+        for (unsigned s = 0; s < 3; ++s)
+          N[r][s] += v[r] * v[s];
+    }
+  if (!vnl_symmetric_eigensystem_compute(N, V, D))
+    return false;
+  const double u[3] = { V[0][0], V[1][0], V[2][0] };
+  // an orthonormal basis (e1, e2) of the plane normal to u
+  const double e1[3] = { V[0][1], V[1][1], V[2][1] }, e2[3] = { V[0][2], V[1][2], V[2][2] };
+  vnl_matrix_fixed<double, 3, 3> A(0.0);
+  double rhs[3] = { 0.0, 0.0, 0.0 };
+  for (std::size_t i = 0; i < n_; ++i)
+    if (mask[i]) {
+      const double v[3] = { x_[i] - m[0], y_[i] - m[1], z_[i] - m[2] };
+      const double w[3] = { v[0] * e1[0] + v[1] * e1[1] + v[2] * e1[2], v[0] * e2[0] + v[1] * e2[1] + v[2] * e2[2], 1.0 };
+      const double q = w[0] * w[0] + w[1] * w[1];
+      for (unsigned r = 0; r < 3; ++r) {
+        for (unsigned s = 0; s < 3; ++s)
+          A[r][s] += w[r] * w[s];
+        rhs[r] -= q * w[r];
+      }
+    }
+  if (!(std::fabs(vnl_det(A)) > 0.0))
+    return false;
+  vnl_matrix_fixed<double, 3, 3> Ai = vnl_inverse(A);
+  double a[3];
+  for (unsigned r = 0; r < 3; ++r)
+    a[r] = Ai[r][0] * rhs[0] + Ai[r][1] * rhs[1] + Ai[r][2] * rhs[2];
+  const double c1 = -a[0] / 2, c2 = -a[1] / 2, r2 = c1 * c1 + c2 * c2 - a[2];
+  if (!(r2 > 0.0))
+    return false;
+  for (unsigned i = 0; i < 3; ++i) {
+    c.par[i] = T(m[i] + c1 * e1[i] + c2 * e2[i]);
+    c.par[3 + i] = T(u[i]);
+  }
+  c.par[6] = T(std::sqrt(r2));
+  return true;
+}
+
+template <class T>
+bool vgl_ransac_shapes_3d<T>::extract(candidate c)
+{
+  std::vector<unsigned char> mask, refined_mask;
+  std::size_t count = inliers(c, mask);
+  if (count < min_support_)
+    return false;
+  candidate r = c;
+  if (refit(r, mask)) {
+    const std::size_t refined = inliers(r, refined_mask);
+    // the least squares shape, unless it loses more than 2% of the inliers
+    if (refined >= min_support_ && 50 * refined >= 49 * count) {
+      c = r;
+      count = refined;
+      mask.swap(refined_mask);
+    }
+  }
+
+  shape s;
+  s.type = c.type;
+  s.inliers.reserve(count);
+  for (std::size_t i = 0; i < n_; ++i)
+    if (mask[i])
+      s.inliers.push_back(index_[i]);
+  std::sort(s.inliers.begin(), s.inliers.end());
+  if (c.type == plane)
+    s.plane = vgl_plane_3d<T>(c.par[0], c.par[1], c.par[2], c.par[3]);
+  else if (c.type == sphere)
+    s.sphere = vgl_sphere_3d<T>(c.par[0], c.par[1], c.par[2], c.par[3]);
+  else {
+    // centre and length from the extent of the inliers along the axis
+    T tmin = std::numeric_limits<T>::max(), tmax = -std::numeric_limits<T>::max();
+    for (std::size_t i = 0; i < n_; ++i)
+      if (mask[i]) {
+        const T t = (x_[i] - c.par[0]) * c.par[3] + (y_[i] - c.par[1]) * c.par[4] + (z_[i] - c.par[2]) * c.par[5];
+        tmin = std::min(tmin, t);
+        tmax = std::max(tmax, t);
+      }
+    const T tc = (tmin + tmax) / 2;
+    vgl_vector_3d<T> u(c.par[3], c.par[4], c.par[5]);
+    s.cylinder = vgl_cylinder<T>(vgl_point_3d<T>(c.par[0], c.par[1], c.par[2]) + tc * u, c.par[6], tmax - tmin, u);
+  }
+  shapes_.push_back(s);
+  level_score_[c.octree_level] += double(count) / double(n_);
+
+  // remove the inliers, keeping the others in random order
+  std::vector<unsigned> moved(n_);
+  std::size_t kept = 0;
+  for (std::size_t i = 0; i < n_; ++i) {
+    if (mask[i]) {
+      assigned_[index_[i]] = 1;
+      continue;
+    }
+    moved[i] = unsigned(kept);
+    x_[kept] = x_[i]; y_[kept] = y_[i]; z_[kept] = z_[i];
+    if (has_normals()) {
+      nx_[kept] = nx_[i]; ny_[kept] = ny_[i]; nz_[kept] = nz_[i];
+    }
+    index_[kept] = index_[i];
+    key_[kept] = key_[i];
+    ++kept;
+  }
+  std::size_t kept_cells = 0;
+  for (std::size_t j = 0; j < n_; ++j)
+    if (!mask[cells_[j].second])
+      cells_[kept_cells++] = std::make_pair(cells_[j].first, moved[cells_[j].second]);
+  n_ = kept;
+  cells_.resize(n_);
+  return true;
+}
+
+template <class T>
+std::size_t vgl_ransac_shapes_3d<T>::detect()
+{
+  const std::size_t found = shapes_.size();
+  const std::size_t batch = 64; // samples drawn between selections
+  std::vector<candidate> pool;
+  std::size_t drawn = 0;
+  while (n_ >= min_support_ && n_ >= 4) {
+    for (std::size_t j = 0; j < batch; ++j, ++drawn)
+      generate(pool);
+    const int b = best_candidate(pool);
+    double lower = 0.0, upper = 0.0;
+    if (b >= 0)
+      support_bounds(pool[b], lower, upper);
+    if (b >= 0 && lower >= double(min_support_) && detection_probability(lower, double(drawn)) >= probability_) {
+      candidate c = pool[b];
+      const std::size_t before = n_;
+      pool.erase(pool.begin() + b);
+      if (extract(c)) {
+        // the other candidates are scored again on the remaining points,
+        // unless their sample has gone with the shape
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < pool.size(); ++i) {
+          bool valid = true;
+          for (unsigned j = 0; j < pool[i].nsample; ++j)
+            valid = valid && !assigned_[pool[i].sample[j]];
+          if (!valid)
+            continue;
+          pool[i].level = 0;
+          pool[i].count = 0;
+          pool[kept++] = pool[i];
+        }
+        pool.resize(kept);
+        // about a fraction removed / before of the samples drawn so far had a point on the shape
+        drawn = std::size_t(double(drawn) * double(n_) / double(before));
+        continue;
+      }
+    }
+    // no shape of min_support points is left, with the required probability
+    if (detection_probability(double(min_support_), double(drawn)) >= probability_)
+      break;
+    if (max_samples_ && drawn >= max_samples_)
+      break;
+  }
+  return shapes_.size() - found;
+}
+
+#endif // vgl_ransac_shapes_3d_h_
@@ -0,0 +1,582 @@
+// This is core/vgl/vgl_box_rtree.h
+#ifndef vgl_box_rtree_h_
+#define vgl_box_rtree_h_
+//:
+// \file
+// \brief A static, bulk-loaded R-tree over a collection of 2-d or 3-d boxes
+//
+//  vgl_box_rtree<T,2> indexes vgl_box_2d<T>s and vgl_box_rtree<T,3>
+//  vgl_box_3d<T>s (vgl_box_rtree_2d<T> and vgl_box_rtree_3d<T> for short).
+//  The tree is packed bottom-up with Sort-Tile-Recursive: the boxes are
+//  sorted into slices by the centre along x, each slice by y (and each of
+//  those by z), and consecutive runs of leaf_size boxes become leaves; the
+//  leaves are grouped into parents the same way, up to the root.  This gives
+//  full nodes with little overlap.
+//
+//  The nodes are kept in one array, root first and level by level, with the
+//  children of a node contiguous; the boxes are copied into a second array
+//  in leaf order.  Queries return indices into the collection the tree was
+//  built from; empty boxes are left out of the tree and never returned.
+//  Boxes are closed, so boxes that only touch do overlap, as with
+//  vgl_intersection(box, box).
+//
+//  The two arrays are written by write() as one block of plain data, which
+//  read() copies back, or attach() uses in place, e.g. from a memory-mapped
+//  file, as long as that memory outlives the tree.
+//
+// \verbatim
+//  Modifications
+// \endverbatim
+
+#include <vector>
+#include <queue>
+#include <utility>
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <type_traits>
+#include <vgl/vgl_point_2d.h>
+#include <vgl/vgl_point_3d.h>
+#include <vgl/vgl_box_2d.h>
+#include <vgl/vgl_box_3d.h>
+#include <vgl/vgl_parallel.h>
+
+namespace vgl_box_rtree_detail
+{
+  template <class T, unsigned D> struct types;
+
+  template <class T> struct types<T, 2>
+  {
+    using box_type = vgl_box_2d<T>;
+    using point_type = vgl_point_2d<T>;
+    static void bounds(box_type const& b, T* lo, T* hi)
+    { lo[0] = b.min_x(); lo[1] = b.min_y(); hi[0] = b.max_x(); hi[1] = b.max_y(); }
+    static void coords(point_type const& p, T* c) { c[0] = p.x(); c[1] = p.y(); }
+    static box_type make(T const* lo, T const* hi) { return box_type(lo[0], hi[0], lo[1], hi[1]); }
+  };
+
+  template <class T> struct types<T, 3>
+  {
+    using box_type = vgl_box_3d<T>;
+    using point_type = vgl_point_3d<T>;
+    static void bounds(box_type const& b, T* lo, T* hi)
+    {
+      lo[0] = b.min_x(); lo[1] = b.min_y(); lo[2] = b.min_z();
+      hi[0] = b.max_x(); hi[1] = b.max_y(); hi[2] = b.max_z();
+    }
+    static void coords(point_type const& p, T* c) { c[0] = p.x(); c[1] = p.y(); c[2] = p.z(); }
+    static box_type make(T const* lo, T const* hi) { return box_type(lo, hi); }
+  };
+}
+
+template <class T, unsigned D> class vgl_box_rtree;
+
+template <class T, unsigned D>
+void vgl_box_rtree_join(vgl_box_rtree<T, D> const& a, vgl_box_rtree<T, D> const& b,
+                        std::vector<std::pair<unsigned, unsigned> >& pairs, unsigned nthreads = 0);
+
+template <class T, unsigned D>
+class vgl_box_rtree
+{
+  using types = vgl_box_rtree_detail::types<T, D>;
+ public:
+  using box_type = typename types::box_type;
+  using point_type = typename types::point_type;
+  //: squared distances are computed in T for floating point T, otherwise in double
+  using dist_t = typename std::conditional<std::is_floating_point<T>::value, T, double>::type;
+
+  //: An empty tree.
+  vgl_box_rtree() { clear(); }
+
+  //: Build the tree over boxes; leaf_size is the number of boxes per leaf (and children per node).
+  explicit vgl_box_rtree(std::vector<box_type> const& boxes, unsigned leaf_size = 16);
+
+  vgl_box_rtree(vgl_box_rtree const& t) { *this = t; }
+  vgl_box_rtree& operator=(vgl_box_rtree const& t);
+
+  //: Rebuild the tree over boxes.
+  void build(std::vector<box_type> const& boxes, unsigned leaf_size = 16);
+
+  //: Make the tree empty.
+  void clear();
+
+  //: number of (non-empty) boxes in the tree
+  std::size_t size() const { return num_items_; }
+  bool empty() const { return num_items_ == 0; }
+
+  //: the bounding box of all boxes (empty if the tree is)
+  box_type bounds() const;
+
+  //: Indices of the boxes overlapping window, in leaf order.
+  unsigned query(box_type const& window, std::vector<unsigned>& indices) const;
+
+  //: Indices of the boxes containing p, in leaf order.
+  unsigned query(point_type const& p, std::vector<unsigned>& indices) const;
+
+  //: Index of the box nearest to p (at distance 0 if p is in it), or -1 if the tree is empty.
+  //  If dist2 is given, it receives the squared distance.
+  int nearest(point_type const& p, dist_t* dist2 = nullptr) const;
+
+  //: Indices of the k boxes nearest to p, by increasing distance.
+  //  Returns the number of boxes found, min(k, size()).
+  unsigned k_nearest(point_type const& p, unsigned k, std::vector<unsigned>& indices,
+                     std::vector<dist_t>* dist2 = nullptr) const;
+
+  //: Write the tree as one block of plain data (header, nodes, boxes).
+  void write(std::ostream& os) const;
+
+  //: Read a tree written by write(); returns false if the data does not fit this type.
+  bool read(std::istream& is);
+
+  //: Use size bytes at data, written by write(), without copying them.
+  //  data must be aligned for T and stay valid (e.g. mapped) while the tree uses it.
+  bool attach(void const* data, std::size_t size);
+
+ private:
+  friend void vgl_box_rtree_join<>(vgl_box_rtree const& a, vgl_box_rtree const& b,
+                                   std::vector<std::pair<unsigned, unsigned> >& pairs, unsigned nthreads);
+
+  //: A node covers nodes (or, in a leaf, boxes) [first, first+count).
+  struct node
+  {
+    T lo[D], hi[D];
+    std::uint32_t first, count;
+  };
+
+  //: A box and its index in the collection.
+  struct item
+  {
+    T lo[D], hi[D];
+    std::uint32_t index;
+  };
+
+  //: The header of the written form.
+  struct header
+  {
+    char magic[8];
+    std::uint32_t version, dim, scalar_size, node_size, item_size, byte_order;
+    std::uint64_t num_nodes, num_items, first_leaf, reserved;
+  };
+
+  //: Sort entries [b, e) into Sort-Tile-Recursive order from dimension d on.
+  template <class E>
+  static void str_sort(E* b, E* e, unsigned d, std::size_t cap);
+
+  template <class A, class B>
+  static bool overlap(A const& a, B const& b)
+  {
+    for (unsigned d = 0; d < D; ++d)
+      if (a.lo[d] > b.hi[d] || b.lo[d] > a.hi[d]) return false;
+    return true;
+  }
+
+  template <class A>
+  static dist_t box_dist2(A const& a, T const* c)
+  {
+    dist_t s = 0;
+    for (unsigned d = 0; d < D; ++d) {
+      dist_t t = c[d] < a.lo[d] ? dist_t(a.lo[d]) - dist_t(c[d]) : c[d] > a.hi[d] ? dist_t(c[d]) - dist_t(a.hi[d]) : dist_t(0);
+      s += t * t;
+    }
+    return s;
+  }
+
+  //: Visit the items overlapping the entry q (a window, or a point as a box).
+  template <class Q, class F>
+  void search(Q const& q, F f) const;
+
+  //: point the tree at the owned arrays
+  void bind();
+
+  std::vector<node> node_store_;
+  std::vector<item> item_store_;
+  node const* nodes_;
+  item const* items_;
+  std::size_t num_nodes_, num_items_, first_leaf_; // nodes [first_leaf_, num_nodes_) are leaves
+  bool attached_;
+};
+
+//: An R-tree over vgl_box_2d<T>s.
+template <class T> using vgl_box_rtree_2d = vgl_box_rtree<T, 2>;
+
+//: An R-tree over vgl_box_3d<T>s.
+template <class T> using vgl_box_rtree_3d = vgl_box_rtree<T, 3>;
+
+// implementation
+template <class T, unsigned D>
+vgl_box_rtree<T, D>::vgl_box_rtree(std::vector<box_type> const& boxes, unsigned leaf_size)
+{
+  build(boxes, leaf_size);
+}
+
+template <class T, unsigned D>
+vgl_box_rtree<T, D>& vgl_box_rtree<T, D>::operator=(vgl_box_rtree const& t)
+{
+  if (this == &t) return *this;
+  node_store_ = t.node_store_;
+  item_store_ = t.item_store_;
+  num_nodes_ = t.num_nodes_; num_items_ = t.num_items_; first_leaf_ = t.first_leaf_;
+  attached_ = t.attached_;
+  if (attached_) { nodes_ = t.nodes_; items_ = t.items_; }
+  else bind();
+  return *this;
+}
+
+template <class T, unsigned D>
+void vgl_box_rtree<T, D>::bind()
+{
+  nodes_ = node_store_.empty() ? nullptr : &node_store_[0];
+  items_ = item_store_.empty() ? nullptr : &item_store_[0];
+  attached_ = false;
+}
+
+template <class T, unsigned D>
+void vgl_box_rtree<T, D>::clear()
+{
+  node_store_.clear();
+  item_store_.clear();
+  num_nodes_ = num_items_ = first_leaf_ = 0;
+  bind();
+}
+
+template <class T, unsigned D>
+template <class E>
+void vgl_box_rtree<T, D>::str_sort(E* b, E* e, unsigned d, std::size_t cap)
+{
+  // sort by twice the centre along d, which avoids a division
+  std::sort(b, e, [d](E const& u, E const& v) { return u.lo[d] + u.hi[d] < v.lo[d] + v.hi[d]; });
+  if (d + 1 == D)
+    return;
+  const std::size_t n = std::size_t(e - b);
+  const std::size_t groups = (n + cap - 1) / cap;
+  const std::size_t slices = std::size_t(std::ceil(std::pow(double(groups), 1.0 / (D - d)) - 1e-9));
+  const std::size_t per = cap * ((groups + slices - 1) / slices);
+  for (std::size_t s = 0; s < n; s += per)
+    str_sort(b + s, b + std::min(n, s + per), d + 1, cap);
+}
+
+template <class T, unsigned D>
+void vgl_box_rtree<T, D>::build(std::vector<box_type> const& boxes, unsigned leaf_size)
+{
+  clear();
+  const std::size_t cap = std::max(2u, leaf_size);
+  for (std::size_t i = 0; i < boxes.size(); ++i) {
+    if (boxes[i].is_empty()) continue;
+    item it;
+    types::bounds(boxes[i], it.lo, it.hi);
+    it.index = std::uint32_t(i);
+    item_store_.push_back(it);
+  }
+  num_items_ = item_store_.size();
+  if (num_items_ == 0) { bind(); return; }
+
+  // pack the boxes into leaves, then each level into parents, up to a single root
+  str_sort(&item_store_[0], &item_store_[0] + num_items_, 0, cap);
+  std::vector<std::vector<node> > levels(1);
+  for (std::size_t s = 0; s < num_items_; s += cap) {
+    node nd;
+    nd.first = std::uint32_t(s);
+    nd.count = std::uint32_t(std::min(cap, num_items_ - s));
+    std::copy(item_store_[s].lo, item_store_[s].lo + D, nd.lo);
+    std::copy(item_store_[s].hi, item_store_[s].hi + D, nd.hi);
+    for (std::size_t k = s + 1; k < s + nd.count; ++k)
+      for (unsigned d = 0; d < D; ++d) {
+        nd.lo[d] = std::min(nd.lo[d], item_store_[k].lo[d]);
+        nd.hi[d] = std::max(nd.hi[d], item_store_[k].hi[d]);
+      }
+    levels[0].push_back(nd);
+  }
+  while (levels.back().size() > 1) {
+    std::vector<node>& below = levels.back();
+    str_sort(&below[0], &below[0] + below.size(), 0, cap);
+    std::vector<node> above;
+    for (std::size_t s = 0; s < below.size(); s += cap) {
+      node nd = below[s];
+      nd.first = std::uint32_t(s); // within the level below, fixed up when laying out
+      nd.count = std::uint32_t(std::min(cap, below.size() - s));
+      for (std::size_t k = s + 1; k < s + nd.count; ++k)
+        for (unsigned d = 0; d < D; ++d) {
+          nd.lo[d] = std::min(nd.lo[d], below[k].lo[d]);
+          nd.hi[d] = std::max(nd.hi[d], below[k].hi[d]);
+        }
+      above.push_back(nd);
+    }
+    levels.push_back(above);
+  }
+
+  // lay the levels out root first
+  std::size_t offset = 0;
+  for (std::size_t l = levels.size(); l-- > 0; ) {
+    const std::size_t below = offset + levels[l].size();
+    for (std::size_t i = 0; i < levels[l].size(); ++i) {
+      node nd = levels[l][i];
+      if (l > 0) nd.first += std::uint32_t(below);
+      node_store_.push_back(nd);
+    }
+    offset = below;
+  }
+  num_nodes_ = node_store_.size();
+  first_leaf_ = num_nodes_ - levels[0].size();
+  bind();
+}
+
+template <class T, unsigned D>
+typename vgl_box_rtree<T, D>::box_type vgl_box_rtree<T, D>::bounds() const
+{
+  if (num_nodes_ == 0) return box_type();
+  return types::make(nodes_[0].lo, nodes_[0].hi);
+}
+
+template <class T, unsigned D>
+template <class Q, class F>
+void vgl_box_rtree<T, D>::search(Q const& q, F f) const
+{
+  if (num_nodes_ == 0 || !overlap(nodes_[0], q)) return;
+  std::vector<std::uint32_t> stack(1, 0);
+  while (!stack.empty()) {
+    node const& nd = nodes_[stack.back()];
+    const bool leaf = stack.back() >= first_leaf_;
+    stack.pop_back();
+    if (leaf) {
+      for (std::uint32_t c = nd.first; c < nd.first + nd.count; ++c)
+        if (overlap(items_[c], q)) f(c);
+    }
+    else {
+      // pushed in reverse, so that the children are visited in order
+      for (std::uint32_t c = nd.first + nd.count; c-- > nd.first; )
+        if (overlap(nodes_[c], q)) stack.push_back(c);
+    }
+  }
+}
+
+template <class T, unsigned D>
+unsigned vgl_box_rtree<T, D>::query(box_type const& window, std::vector<unsigned>& indices) const
+{
+  indices.clear();
+  if (window.is_empty()) return 0;
+  item q;
+  types::bounds(window, q.lo, q.hi);
+  search(q, [&](std::uint32_t c) { indices.push_back(items_[c].index); });
+  return unsigned(indices.size());
+}
+
+template <class T, unsigned D>
+unsigned vgl_box_rtree<T, D>::query(point_type const& p, std::vector<unsigned>& indices) const
+{
+  indices.clear();
+  item q;
+  types::coords(p, q.lo);
+  std::copy(q.lo, q.lo + D, q.hi);
+  search(q, [&](std::uint32_t c) { indices.push_back(items_[c].index); });
+  return unsigned(indices.size());
+}
+
+template <class T, unsigned D>
+int vgl_box_rtree<T, D>::nearest(point_type const& p, dist_t* dist2) const
+{
+  std::vector<unsigned> idx;
+  std::vector<dist_t> d2;
+  if (k_nearest(p, 1, idx, &d2) == 0) return -1;
+  if (dist2) *dist2 = d2[0];
+  return int(idx[0]);
+}
+
+template <class T, unsigned D>
+unsigned vgl_box_rtree<T, D>::k_nearest(point_type const& p, unsigned k, std::vector<unsigned>& indices,
+                                        std::vector<dist_t>* dist2) const
+{
+  indices.clear();
+  if (dist2) dist2->clear();
+  if (num_nodes_ == 0 || k == 0) return 0;
+  T c[D];
+  types::coords(p, c);
+  // best first: nodes and boxes in one queue, a box being reported when it
+  // comes out ahead of everything still queued; boxes are entries >= num_nodes_
+  using entry = std::pair<dist_t, std::size_t>;
+  std::priority_queue<entry, std::vector<entry>, std::greater<entry> > queue;
+  queue.push(entry(box_dist2(nodes_[0], c), 0));
+  while (!queue.empty() && indices.size() < k) {
+    const entry top = queue.top();
+    queue.pop();
+    if (top.second >= num_nodes_) {
+      indices.push_back(items_[top.second - num_nodes_].index);
+      if (dist2) dist2->push_back(top.first);
+      continue;
+    }
+    node const& nd = nodes_[top.second];
+    const bool leaf = top.second >= first_leaf_;
+    for (std::uint32_t ch = nd.first; ch < nd.first + nd.count; ++ch)
+      queue.push(leaf ? entry(box_dist2(items_[ch], c), num_nodes_ + ch)
+                      : entry(box_dist2(nodes_[ch], c), ch));
+  }
+  return unsigned(indices.size());
+}
+
+template <class T, unsigned D>
+void vgl_box_rtree<T, D>::write(std::ostream& os) const
+{
+  header h;
+  std::memset(&h, 0, sizeof h);
+  std::memcpy(h.magic, "VGLRTREE", 8);
+  h.version = 1; h.dim = D; h.scalar_size = sizeof(T);
+  h.node_size = sizeof(node); h.item_size = sizeof(item);
+  h.byte_order = 0x01020304u;
+  h.num_nodes = num_nodes_; h.num_items = num_items_; h.first_leaf = first_leaf_;
+  os.write(reinterpret_cast<char const*>(&h), sizeof h);
+  // copy through zeroed records, so that padding is written as zeros
+  for (std::size_t i = 0; i < num_nodes_; ++i) {
+    node nd;
+    std::memset(&nd, 0, sizeof nd);
+    std::copy(nodes_[i].lo, nodes_[i].lo + D, nd.lo);
+    std::copy(nodes_[i].hi, nodes_[i].hi + D, nd.hi);
+    nd.first = nodes_[i].first; nd.count = nodes_[i].count;
+    os.write(reinterpret_cast<char const*>(&nd), sizeof nd);
+  }
+  for (std::size_t i = 0; i < num_items_; ++i) {
+    item it;
+    std::memset(&it, 0, sizeof it);
+    std::copy(items_[i].lo, items_[i].lo + D, it.lo);
+    std::copy(items_[i].hi, items_[i].hi + D, it.hi);
+    it.index = items_[i].index;
+    os.write(reinterpret_cast<char const*>(&it), sizeof it);
+  }
+}
+
+template <class T, unsigned D>
+bool vgl_box_rtree<T, D>::read(std::istream& is)
+{
+  header h;
+  if (!is.read(reinterpret_cast<char*>(&h), sizeof h)) return false;
+  if (std::memcmp(h.magic, "VGLRTREE", 8) != 0 || h.version != 1 || h.dim != D || h.scalar_size != sizeof(T) ||
+      h.node_size != sizeof(node) || h.item_size != sizeof(item) || h.byte_order != 0x01020304u)
+    return false;
+  std::vector<node> nodes(h.num_nodes);
+  std::vector<item> items(h.num_items);
+  if ((h.num_nodes && !is.read(reinterpret_cast<char*>(&nodes[0]), std::streamsize(h.num_nodes * sizeof(node)))) ||
+      (h.num_items && !is.read(reinterpret_cast<char*>(&items[0]), std::streamsize(h.num_items * sizeof(item)))))
+    return false;
+  node_store_.swap(nodes);
+  item_store_.swap(items);
+  num_nodes_ = h.num_nodes; num_items_ = h.num_items; first_leaf_ = h.first_leaf;
+  bind();
+  return true;
+}
+
+template <class T, unsigned D>
+bool vgl_box_rtree<T, D>::attach(void const* data, std::size_t size)
+{
+  if (size < sizeof(header)) return false;
+  header h;
+  std::memcpy(&h, data, sizeof h);
+  if (std::memcmp(h.magic, "VGLRTREE", 8) != 0 || h.version != 1 || h.dim != D || h.scalar_size != sizeof(T) ||
+      h.node_size != sizeof(node) || h.item_size != sizeof(item) || h.byte_order != 0x01020304u ||
+      size < sizeof(header) + h.num_nodes * sizeof(node) + h.num_items * sizeof(item))
+    return false;
+  node_store_.clear();
+  item_store_.clear();
+  char const* base = static_cast<char const*>(data);
+  nodes_ = reinterpret_cast<node const*>(base + sizeof(header));
+  items_ = reinterpret_cast<item const*>(base + sizeof(header) + h.num_nodes * sizeof(node));
+  num_nodes_ = h.num_nodes; num_items_ = h.num_items; first_leaf_ = h.first_leaf;
+  attached_ = true;
+  return true;
+}
+
+//: All pairs (i, j) with box i of a overlapping box j of b.
+//  The trees are descended together; the work is spread over nthreads
+//  threads (0: all cores), and the pairs come out in the same order for
+//  any number of threads.
+template <class T, unsigned D>
+void vgl_box_rtree_join(vgl_box_rtree<T, D> const& a, vgl_box_rtree<T, D> const& b,
+                        std::vector<std::pair<unsigned, unsigned> >& pairs, unsigned nthreads)
+{
+  using tree = vgl_box_rtree<T, D>;
+  pairs.clear();
+  if (a.num_nodes_ == 0 || b.num_nodes_ == 0 || !tree::overlap(a.nodes_[0], b.nodes_[0]))
+    return;
+
+  // descend the larger node of a pair, or the one that is not a leaf
+  using task = std::pair<std::uint32_t, std::uint32_t>;
+  auto a_leaf = [&](std::uint32_t i) { return i >= a.first_leaf_; };
+  auto b_leaf = [&](std::uint32_t j) { return j >= b.first_leaf_; };
+  auto extent = [](typename tree::node const& n) {
+    double e = 0;
+    for (unsigned d = 0; d < D; ++d) e += double(n.hi[d]) - double(n.lo[d]);
+    return e;
+  };
+  auto split_a = [&](task const& t) {
+    if (a_leaf(t.first)) return false;
+    if (b_leaf(t.second)) return true;
+    return extent(a.nodes_[t.first]) >= extent(b.nodes_[t.second]);
+  };
+  auto expand = [&](task const& t, std::vector<task>& out) {
+    if (split_a(t)) {
+      typename tree::node const& n = a.nodes_[t.first];
+      for (std::uint32_t c = n.first; c < n.first + n.count; ++c)
+        if (tree::overlap(a.nodes_[c], b.nodes_[t.second])) out.push_back(task(c, t.second));
+    }
+    else {
+      typename tree::node const& n = b.nodes_[t.second];
+      for (std::uint32_t c = n.first; c < n.first + n.count; ++c)
+        if (tree::overlap(a.nodes_[t.first], b.nodes_[c])) out.push_back(task(t.first, c));
+    }
+  };
+  auto run = [&](task const& t0, std::vector<std::pair<unsigned, unsigned> >& out) {
+    std::vector<task> stack(1, t0), next;
+    while (!stack.empty()) {
+      const task t = stack.back();
+      stack.pop_back();
+      if (a_leaf(t.first) && b_leaf(t.second)) {
+        typename tree::node const& na = a.nodes_[t.first];
+        typename tree::node const& nb = b.nodes_[t.second];
+        for (std::uint32_t i = na.first; i < na.first + na.count; ++i) {
+          if (!tree::overlap(a.items_[i], nb)) continue;
+          for (std::uint32_t j = nb.first; j < nb.first + nb.count; ++j)
+            if (tree::overlap(a.items_[i], b.items_[j]))
+              out.push_back(std::make_pair(unsigned(a.items_[i].index), unsigned(b.items_[j].index)));
+        }
+        continue;
+      }
+      next.clear();
+      expand(t, next);
+      stack.insert(stack.end(), next.rbegin(), next.rend());
+    }
+  };
+
+  // expand node pairs breadth first into a fixed number of tasks, so that
+  // the order of the pairs does not depend on the number of threads
+  std::vector<task> tasks(1, task(0, 0)), next;
+  while (tasks.size() < 256) {
+    next.clear();
+    bool grew = false;
+    for (std::size_t k = 0; k < tasks.size(); ++k) {
+      if (a_leaf(tasks[k].first) && b_leaf(tasks[k].second)) { next.push_back(tasks[k]); continue; }
+      expand(tasks[k], next);
+      grew = true;
+    }
+    tasks.swap(next);
+    if (!grew) break;
+  }
+  const std::size_t ntasks = tasks.size();
+  const unsigned nt = vgl_parallel_detail::thread_count(nthreads, ntasks);
+  if (nt <= 1) {
+    for (std::size_t k = 0; k < ntasks; ++k)
+      run(tasks[k], pairs);
+    return;
+  }
+  std::vector<std::vector<std::pair<unsigned, unsigned> > > out(ntasks);
+  vgl_parallel_detail::parallel_for(ntasks, nt, [&](unsigned, std::size_t begin, std::size_t end) {
+    for (std::size_t k = begin; k < end; ++k)
+      run(tasks[k], out[k]);
+  });
+  for (std::size_t k = 0; k < ntasks; ++k)
+    pairs.insert(pairs.end(), out[k].begin(), out[k].end());
+}
+
+#endif // vgl_box_rtree_h_
@@ -12,18 +12,25 @@
 //   14 Nov 2003: Peter Vanroose: made all functions templated
 //   27 May 2015: Scott Richardson: added another polygon clipper library (a wrapper
 //                around Angus Johnson's Clipper library)
+//   16 Oct 2026: replaced the GPC and Clipper wrappers by a native
+//                Martinez-Rueda sweep-line polygon boolean engine
 // \endverbatim
 
-#include <cstdlib>
-#include <cstdio>
 #include <algorithm>
-#include <limits>
 #include <cmath>
+#include <deque>
+#include <iterator>
+#include <limits>
+#include <queue>
+#include <set>
+#include <utility>
+#include <vector>
 
 #include "vgl_box_2d.h"
 #include "vgl_line_2d.h"
 #include "vgl_line_segment_2d.h"
 #include "vgl_polygon.h"
+#include "vgl_predicates.h"
 
 //: Type of polygon "clip" operations.
 enum vgl_clip_type
@@ -73,13 +80,17 @@ vgl_line_segment_2d<T> vgl_clip_line_to_box(vgl_line_2d<T> const& l,
 //: Clip a polygon against another polygon.
 // The two polygons poly1 and poly2 are combined with each other.
 // The operation (intersection, union, etc) is given by parameter op.
+// Each polygon may have several sheets, combined with the even-odd rule,
+// so holes and self-overlapping sheets are allowed.
 //
-// \note The implementation of this code is based on Alan Murta's GPC
-// library (http://www.cs.man.ac.uk/aig/staff/alan/software/gpc.html)
-// which is free for non-commercial use.
-//
-// In order to be able to use it, make sure to satisfy the copyright notice,
-// then activate the "BUILD_NONCOMMERCIAL" compiler option.
+// The implementation is the sweep-line algorithm of Martinez, Rueda and
+// Feito (2009): edges are split at their intersections as the sweep meets
+// them, each resulting edge is kept if it separates the result from its
+// complement, and the kept edges are joined into contours.  It runs in
+// O((n+k) log n) time for n edges and k intersections.  Orientation tests
+// are exact (vgl_orient_2d); only new intersection points are rounded.
+// Result sheets have the interior on their left: outer boundaries are
+// counterclockwise, holes clockwise.
 //
 // \relatesalso vgl_polygon
 template <class T>
@@ -91,15 +102,57 @@ vgl_clip( const vgl_polygon<T>& poly1, const vgl_polygon<T>& poly2,
 //  Same as vgl_clip( const vgl_polygon<T>& poly1, const vgl_polygon<T>& poly2,
 //                    vgl_clip_type op = vgl_clip_type_intersect );
 //  but where the fourth parameter is a return flag which is 1 if success,
-//  or 0 if the operation faced a geometric degeneracy which could not be
-//  handled. In this case, it might be necessary to perturb the input with
-//  a tiny amount of random noise and try again.
+//  or -1 if op is not a valid vgl_clip_type.
 //
 // \relatesalso vgl_polygon
 template <class T>
 vgl_polygon<T>
 vgl_clip(vgl_polygon<T> const& poly1, vgl_polygon<T> const& poly2, vgl_clip_type op, int *p_retval);
 
+//: Clip a polygon to a box, keeping the part of poly inside b.
+// Unlike the general vgl_clip this needs no sweep: each sheet is cut by
+// the two vertical and then the two horizontal box edges, Sutherland-
+// Hodgman style, in one pass over its edges per direction, so it takes
+// O(n) time for n vertices.  Clipping the sheets one by one is exact for
+// the even-odd rule, as intersection with the box distributes over it.
+// Where a sheet leaves the box and comes back, its piece follows the box
+// boundary in between; such runs along a box edge are reduced to their
+// ends, pieces without area are dropped, and pieces that only run round
+// the box are merged into one box, or none.  Pieces keep the orientation
+// of their sheets.
+//
+// \relatesalso vgl_polygon
+// \relatesalso vgl_box_2d
+template <class T>
+vgl_polygon<T>
+vgl_clip(vgl_polygon<T> const& poly, vgl_box_2d<T> const& b);
+
+//: Clip a polygon to each tile of a grid, in one pass.
+// The tiles are the boxes between consecutive values of xs and of ys,
+// both increasing: tile (i, j) is [xs[i], xs[i+1]] by [ys[j], ys[j+1]],
+// and its piece, as given by vgl_clip(poly, tile), goes to
+// tiles[j * (xs.size()-1) + i]; tiles missed by the polygon get an empty
+// one.  The polygon is cut into column strips and each strip into tiles,
+// each in a single pass over the edges, so the cost is O(n + m) for n
+// vertices and m output vertices, plus a binary search per edge, instead
+// of clipping the whole polygon once for every tile.
+//
+// \relatesalso vgl_polygon
+template <class T>
+void
+vgl_clip_to_grid(vgl_polygon<T> const& poly, std::vector<T> const& xs, std::vector<T> const& ys,
+                 std::vector<vgl_polygon<T> >& tiles);
+
+//: Clip a polygon to each tile of a grid of nx by ny equal tiles covering b.
+// Tile (i, j) has its piece in tiles[j * nx + i]; see above.
+//
+// \relatesalso vgl_polygon
+// \relatesalso vgl_box_2d
+template <class T>
+void
+vgl_clip_to_grid(vgl_polygon<T> const& poly, vgl_box_2d<T> const& b, unsigned nx, unsigned ny,
+                 std::vector<vgl_polygon<T> >& tiles);
+
 // copy from .cpp
 template <class T>
 bool vgl_clip_lineseg_to_line(T &x1, T &y1,
@@ -175,118 +228,517 @@ bool vgl_clip_line_to_box(T a, T b, T c, // line coefficients.
 }
 
 
-// This license is very restrictive, prefer Angus Johnson's more liberal Clipper library.
-#ifdef BUILD_NONCOMMERCIAL
+namespace vgl_clip_detail
+{
+  struct sweep_event;
 
-extern "C" {
-#include "internals/gpc.h"
-}
+  //: Order of the edges crossing the sweep line, from bottom to top.
+  struct segment_less
+  {
+    bool operator()(sweep_event const* le1, sweep_event const* le2) const;
+  };
+
+  typedef std::multiset<sweep_event*, segment_less> status_t;
+
+  //: The ends of an input edge.
+  struct line_t
+  {
+    double x0, y0, x1, y1;
+  };
+
+  //: One endpoint of an edge, as seen by the sweep line.
+  //  Every edge has a left and a right event, linked through other.
+  //  "Below" a vertical edge means on its right.
+  struct sweep_event
+  {
+    double x, y;
+    bool left;
+    bool subject;         // edge of poly1, otherwise of poly2
+    unsigned contour;
+    unsigned id;          // creation order, the final tie break
+    sweep_event* other;
+    line_t const* line;   // input edge this edge is a part of
+    bool flip1, flip2;    // crossing the edge toggles inside poly1 / poly2
+    bool in1, in2;        // region below the edge is inside poly1 / poly2
+    bool in_result;
+    bool result_below;    // region below the edge is in the result
+    bool in_status;
+    status_t::iterator pos;
+  };
+
+  //: An edge of the subdivision, left end first.
+  struct piece
+  {
+    double x0, y0, x1, y1;
+    bool flip1, flip2;
+  };
+
+  inline bool same_point(sweep_event const* a, sweep_event const* b)
+  {
+    return a->x == b->x && a->y == b->y;
+  }
+
+  inline double orient(sweep_event const* a, sweep_event const* b, sweep_event const* c)
+  {
+    return vgl_orient_2d(a->x, a->y, b->x, b->y, c->x, c->y);
+  }
 
-#define MALLOC(p, T, c, s) { if ((c) > 0) { \
-p= (T*)std::malloc(c * sizeof(T)); if (!(p)) { \
-std::fprintf(stderr, "vgl: gpc malloc failure: %s\n", s); \
-std::exit(0);}} else p=NULL; }
+  //: True if point (px,py) is strictly above the line of the edge of e.
+  inline bool is_below(sweep_event const* e, double px, double py)
+  {
+    return e->left ? vgl_orient_2d(e->x, e->y, e->other->x, e->other->y, px, py) > 0
+                   : vgl_orient_2d(e->other->x, e->other->y, e->x, e->y, px, py) > 0;
+  }
 
-#define FREE(p)            { if (p) { std::free(p); (p)= NULL; } }
+  inline bool is_vertical(sweep_event const* e) { return e->x == e->other->x; }
+
+  //: True if e1 is processed after e2: by x, then y, right events first,
+  //  then the lower edge first, and subject before clip edges.
+  inline bool event_after(sweep_event const* e1, sweep_event const* e2)
+  {
+    if (e1->x != e2->x) return e1->x > e2->x;
+    if (e1->y != e2->y) return e1->y > e2->y;
+    if (e1->left != e2->left) return e1->left;
+    if (orient(e1, e1->other, e2->other) != 0)
+      return !is_below(e1, e2->other->x, e2->other->y);
+    if (e1->subject != e2->subject) return !e1->subject;
+    return e1->id > e2->id;
+  }
+
+  //: Comparator for the event queue; its top is the next event.
+  struct event_later
+  {
+    bool operator()(sweep_event const* a, sweep_event const* b) const { return event_after(a, b); }
+  };
+
+  inline bool segment_less::operator()(sweep_event const* le1, sweep_event const* le2) const
+  {
+    if (le1 == le2) return false;
+    if (orient(le1, le1->other, le2) != 0 || orient(le1, le1->other, le2->other) != 0) {
+      // not collinear
+      if (same_point(le1, le2)) return is_below(le1, le2->other->x, le2->other->y);
+      if (le1->x == le2->x) return le1->y < le2->y;
+      if (event_after(le1, le2)) return !is_below(le2, le1->x, le1->y);
+      return is_below(le1, le2->x, le2->y);
+    }
+    // collinear
+    if (le1->subject != le2->subject) return le1->subject;
+    if (same_point(le1, le2) && le1->contour != le2->contour) return le1->contour < le2->contour;
+    return !event_after(le1, le2);
+  }
+
+  inline bool apply(vgl_clip_type op, bool in1, bool in2)
+  {
+    switch (op)
+    {
+      case vgl_clip_type_intersect:  return in1 && in2;
+      case vgl_clip_type_union:      return in1 || in2;
+      case vgl_clip_type_difference: return in1 && !in2;
+      case vgl_clip_type_xor:        return in1 != in2;
+      default:                       return false;
+    }
+  }
+
+  //: Set the inside flags of left event e from the edge just below it.
+  inline void compute_fields(sweep_event* e, sweep_event const* prev)
+  {
+    if (!prev) {
+      e->in1 = e->in2 = false;
+    }
+    else if (is_vertical(prev)) {
+      // e starts on prev, so it has prev's right side below it
+      e->in1 = prev->in1;
+      e->in2 = prev->in2;
+    }
+    else {
+      e->in1 = prev->in1 != prev->flip1;
+      e->in2 = prev->in2 != prev->flip2;
+    }
+  }
+
+  //: Decide whether the edge of left event e bounds the result, and on which side.
+  inline void compute_result(sweep_event* e, vgl_clip_type op)
+  {
+    const bool below = apply(op, e->in1, e->in2);
+    const bool above = apply(op, e->in1 != e->flip1, e->in2 != e->flip2);
+    e->in_result = below != above;
+    e->result_below = below;
+  }
+
+  typedef std::priority_queue<sweep_event*, std::vector<sweep_event*>, event_later> queue_t;
+
+  //: True if the edges of a and b are parts of the same line.
+  //  Their input edges are compared, since splitting at rounded points
+  //  moves an edge slightly off its line.
+  inline bool collinear(sweep_event const* a, sweep_event const* b)
+  {
+    line_t const* p = a->line;
+    line_t const* q = b->line;
+    return p == q ||
+           (vgl_orient_2d(p->x0, p->y0, p->x1, p->y1, q->x0, q->y0) == 0 &&
+            vgl_orient_2d(p->x0, p->y0, p->x1, p->y1, q->x1, q->y1) == 0);
+  }
+
+  //: A sweep over a set of edges, left to right.
+  struct sweep
+  {
+    std::deque<sweep_event> events;
+    std::deque<line_t> lines;
+    queue_t queue;
+    status_t status;
+    unsigned next_id = 0;
+    bool inexact = false;   // an edge was split at a rounded point
+
+    sweep_event* make(double x, double y, bool left, sweep_event* other, line_t const* line,
+                      bool subject, unsigned contour)
+    {
+      sweep_event e;
+      e.x = x; e.y = y; e.left = left; e.subject = subject; e.contour = contour;
+      e.id = next_id++; e.other = other; e.line = line;
+      e.flip1 = subject; e.flip2 = !subject;
+      e.in1 = e.in2 = e.in_result = e.result_below = e.in_status = false;
+      events.push_back(e);
+      return &events.back();
+    }
+
+    sweep_event* add_edge(double x0, double y0, double x1, double y1, bool subject, unsigned contour)
+    {
+      lines.push_back({ x0, y0, x1, y1 });
+      sweep_event* e0 = make(x0, y0, false, nullptr, &lines.back(), subject, contour);
+      sweep_event* e1 = make(x1, y1, false, e0, &lines.back(), subject, contour);
+      e0->other = e1;
+      sweep_event* le = event_after(e0, e1) ? e1 : e0;
+      le->left = true;
+      queue.push(e0); queue.push(e1);
+      return le;
+    }
 
-namespace {
-    //: Creates a gpc polygon from a vgl_polygon.
-    // The caller is responsible for freeing the gpc_polygon.
     template <class T>
-    gpc_polygon
-    vgl_to_gpc( const vgl_polygon<T>& vgl_poly )
+    void add_polygon(vgl_polygon<T> const& poly, bool subject, unsigned& contour)
     {
-        gpc_polygon gpc_poly;
-        gpc_poly.num_contours = vgl_poly.num_sheets();
-        MALLOC( gpc_poly.hole, int, gpc_poly.num_contours, "allocating hole array" );
-        MALLOC( gpc_poly.contour, gpc_vertex_list, gpc_poly.num_contours, "allocating contour array" );
-        for ( int s = 0; s < gpc_poly.num_contours; ++s ) {
-            gpc_poly.hole[s] = 0;
-            gpc_poly.contour[s].num_vertices = vgl_poly[s].size();
-            MALLOC( gpc_poly.contour[s].vertex, gpc_vertex, vgl_poly[s].size(), "allocating vertex list" );
-            for ( unsigned int p = 0; p < vgl_poly[s].size(); ++p ) {
-                gpc_poly.contour[s].vertex[p].x = vgl_poly[s][p].x();
-                gpc_poly.contour[s].vertex[p].y = vgl_poly[s][p].y();
-            }
+      for (unsigned s = 0; s < poly.num_sheets(); ++s, ++contour) {
+        typename vgl_polygon<T>::sheet_t const& sh = poly[s];
+        for (unsigned i = 0, n = (unsigned)sh.size(); i < n; ++i) {
+          const double x0 = double(sh[i].x()), y0 = double(sh[i].y());
+          const double x1 = double(sh[(i+1)%n].x()), y1 = double(sh[(i+1)%n].y());
+          if (x0 != x1 || y0 != y1) add_edge(x0, y0, x1, y1, subject, contour);
         }
-        
-        return gpc_poly;
+      }
     }
-    
-    //: Adds a gpc_polygon to a given vgl_polygon.
-    template <class T>
-    void
-    add_gpc_to_vgl( vgl_polygon<T>& vgl_poly, const gpc_polygon& gpc_poly )
+
+    //: Split the edge of left event le at (px,py).
+    void divide(sweep_event* le, double px, double py)
+    {
+      sweep_event* r = make(px, py, false, le, le->line, le->subject, le->contour);
+      sweep_event* l = make(px, py, true, le->other, le->line, le->subject, le->contour);
+      r->flip1 = l->flip1 = le->flip1;
+      r->flip2 = l->flip2 = le->flip2;
+      if (event_after(l, le->other)) { // rounding moved the split point past the right end
+        le->other->left = true;
+        l->left = false;
+      }
+      le->other->other = l;
+      le->other = r;
+      queue.push(l); queue.push(r);
+    }
+
+    //: Split the edges of left events le1 and le2 where they intersect.
+    void intersect(sweep_event* le1, sweep_event* le2)
     {
-        for ( int c=0; c < gpc_poly.num_contours; ++c ) {
-            vgl_poly.new_sheet();
-            for ( int p=0; p < gpc_poly.contour[c].num_vertices; ++p ) {
-                vgl_poly.push_back( T(gpc_poly.contour[c].vertex[p].x),
-                                   T(gpc_poly.contour[c].vertex[p].y) );
-            }
+      sweep_event* re1 = le1->other;
+      sweep_event* re2 = le2->other;
+      if (collinear(le1, le2)) {
+        // collinear: the edges overlap where their lexicographic ranges do
+        sweep_event const* lo = event_after(le1, le2) ? le1 : le2;
+        sweep_event const* hi = event_after(re1, re2) ? re2 : re1;
+        if (lo->x > hi->x || (lo->x == hi->x && lo->y >= hi->y)) return;
+        overlap(le1, le2);
+        return;
+      }
+      const double o1 = orient(le1, re1, le2), o2 = orient(le1, re1, re2);
+      const double o3 = orient(le2, re2, le1), o4 = orient(le2, re2, re1);
+      if ((o1 > 0 && o2 > 0) || (o1 < 0 && o2 < 0) || (o3 > 0 && o4 > 0) || (o3 < 0 && o4 < 0))
+        return;
+      if (same_point(le1, le2) || same_point(re1, re2)) return;
+      double px, py;
+      if      (o1 == 0) { px = le2->x; py = le2->y; }
+      else if (o2 == 0) { px = re2->x; py = re2->y; }
+      else if (o3 == 0) { px = le1->x; py = le1->y; }
+      else if (o4 == 0) { px = re1->x; py = re1->y; }
+      else {
+        // proper crossing
+        const double ux = re1->x - le1->x, uy = re1->y - le1->y;
+        const double vx = re2->x - le2->x, vy = re2->y - le2->y;
+        const double wx = le2->x - le1->x, wy = le2->y - le1->y;
+        const double den = ux * vy - uy * vx;
+        double t = den != 0 ? (wx * vy - wy * vx) / den : 0.5;
+        t = t < 0 ? 0 : t > 1 ? 1 : t;
+        px = le1->x + t * ux; py = le1->y + t * uy;
+        if (den == 0) {
+          // nearly parallel: take the endpoint closest to the other line
+          const double l1 = std::hypot(ux, uy), l2 = std::hypot(vx, vy);
+          const double d[4] = { std::fabs(o1) / l1, std::fabs(o2) / l1, std::fabs(o3) / l2, std::fabs(o4) / l2 };
+          sweep_event const* q[4] = { le2, re2, le1, re1 };
+          const int k = int(std::min_element(d, d + 4) - d);
+          px = q[k]->x; py = q[k]->y;
+        }
+        // a point within rounding error of an endpoint is that endpoint, as
+        // long as it still splits the other edge; otherwise split pieces may
+        // keep crossing each other ulp by ulp
+        sweep_event const* ends[4] = { le1, re1, le2, re2 };
+        double scale = 0;
+        for (sweep_event const* q : ends)
+          scale = std::max(scale, std::max(std::fabs(q->x), std::fabs(q->y)));
+        const double tol = 64 * std::numeric_limits<double>::epsilon() * scale;
+        for (int k = 0; k < 4; ++k) {
+          sweep_event const* q = ends[k];
+          sweep_event const* o = k < 2 ? le2 : le1;
+          if (std::fabs(q->x - px) <= tol && std::fabs(q->y - py) <= tol &&
+              !event_after(o, q) && !event_after(q, o->other)) { px = q->x; py = q->y; break; }
         }
+      }
+      if (vgl_orient_2d(le1->x, le1->y, re1->x, re1->y, px, py) != 0 ||
+          vgl_orient_2d(le2->x, le2->y, re2->x, re2->y, px, py) != 0)
+        inexact = true;
+      divide_run(le1, px, py);
+      divide_run(le2, px, py);
     }
-}
 
-#elif HAS_CLIPPER
+    //: Split the edge of left event le, and the edges coincident with it,
+    //  at (px,py) unless that is one of their ends.  Splitting them
+    //  together keeps them identical after the point is rounded.
+    void divide_run(sweep_event* le, double px, double py)
+    {
+      status_t::iterator first = le->pos, last = std::next(le->pos);
+      while (first != status.begin() && collinear(le, *std::prev(first))) --first;
+      while (last != status.end() && collinear(le, *last)) ++last;
+      std::vector<sweep_event*> run(first, last); // dividing le moves its line
+      for (sweep_event* e : run) {
+        const double x0 = e->x, y0 = e->y, x1 = e->other->x, y1 = e->other->y;
+        if ((x0 < px || (x0 == px && y0 < py)) && (px < x1 || (px == x1 && py < y1)))
+          divide(e, px, py);
+      }
+    }
 
-#include <clipper.hxx>
+    //: Split the overlapping collinear edges of le1 and le2 at each other's
+    //  ends, so that their common part becomes two identical edges.
+    void overlap(sweep_event* le1, sweep_event* le2)
+    {
+      sweep_event* ev[4];
+      int n = 0;
+      const bool left_coincide = same_point(le1, le2);
+      const bool right_coincide = same_point(le1->other, le2->other);
+      if (!left_coincide) {
+        if (event_after(le1, le2)) { ev[n++] = le2; ev[n++] = le1; }
+        else                       { ev[n++] = le1; ev[n++] = le2; }
+      }
+      if (!right_coincide) {
+        if (event_after(le1->other, le2->other)) { ev[n++] = le2->other; ev[n++] = le1->other; }
+        else                                     { ev[n++] = le1->other; ev[n++] = le2->other; }
+      }
+      if (left_coincide) {
+        if (!right_coincide) divide(ev[1]->other, ev[0]->x, ev[0]->y);
+      }
+      else if (right_coincide) {
+        divide(ev[0], ev[1]->x, ev[1]->y);
+      }
+      else if (ev[0] != ev[3]->other) {
+        // partial overlap
+        divide(ev[0], ev[1]->x, ev[1]->y);
+        divide(ev[1], ev[2]->x, ev[2]->y);
+      }
+      else {
+        // one edge contains the other
+        divide(ev[0], ev[1]->x, ev[1]->y);
+        divide(ev[3]->other, ev[2]->x, ev[2]->y);
+      }
+    }
 
-namespace {
-    //: Creates a Clipper polygon from a vgl_polygon.
-    template <class T>
-    ClipperLib::Paths
-    vgl_to_clipper( const vgl_polygon<T>& vgl_poly, double scale )
+    void add_pieces(std::vector<piece> const& pieces)
     {
-        ClipperLib::Paths clipper_poly;
-        for ( size_t s = 0; s < vgl_poly.num_sheets(); ++s ) {
-            ClipperLib::Path path;
-            for ( size_t p = 0; p < vgl_poly[s].size(); ++p ) {
-                ClipperLib::IntPoint pt((ClipperLib::cInt)((double)vgl_poly[s][p].x()*scale),
-                                        (ClipperLib::cInt)((double)vgl_poly[s][p].y()*scale));
-                path.push_back(pt);
-            }
-            clipper_poly.push_back(path);
+      for (unsigned i = 0; i < pieces.size(); ++i) {
+        piece const& p = pieces[i];
+        sweep_event* le = add_edge(p.x0, p.y0, p.x1, p.y1, p.flip1, i);
+        le->flip1 = le->other->flip1 = p.flip1;
+        le->flip2 = le->other->flip2 = p.flip2;
+      }
+    }
+
+    //: First pass: split the edges at all their intersections, up to stop_x.
+    //  Returns the resulting pieces, with coincident ones merged.
+    std::vector<piece> subdivide(double stop_x)
+    {
+      std::vector<sweep_event*> done;
+      while (!queue.empty()) {
+        sweep_event* e = queue.top();
+        queue.pop();
+        if (e->x > stop_x) break;
+        if (e->left) {
+          done.push_back(e);
+          e->pos = status.insert(e);
+          e->in_status = true;
+          status_t::iterator it = e->pos;
+          if (++it != status.end()) intersect(e, *it);
+          it = e->pos;
+          if (it != status.begin()) intersect(*std::prev(it), e);
         }
-        
-        return clipper_poly;
+        else if (e->other->in_status) {
+          status_t::iterator it = e->other->pos;
+          sweep_event* prev = it == status.begin() ? nullptr : *std::prev(it);
+          status_t::iterator nit = std::next(it);
+          sweep_event* next = nit == status.end() ? nullptr : *nit;
+          status.erase(it);
+          e->other->in_status = false;
+          if (prev && next) intersect(prev, next);
+        }
+      }
+
+      // coincident pieces cancel or add up, per polygon
+      std::vector<piece> pieces;
+      pieces.reserve(done.size());
+      for (sweep_event const* e : done)
+        if (e->left) // not turned into a right event by rounding
+          pieces.push_back({ e->x, e->y, e->other->x, e->other->y, e->flip1, e->flip2 });
+      std::sort(pieces.begin(), pieces.end(), [](piece const& a, piece const& b) {
+        return a.x0 != b.x0 ? a.x0 < b.x0 : a.y0 != b.y0 ? a.y0 < b.y0 : a.x1 != b.x1 ? a.x1 < b.x1 : a.y1 < b.y1; });
+      std::size_t m = 0;
+      for (std::size_t i = 0; i < pieces.size(); ) {
+        piece p = pieces[i];
+        for (++i; i < pieces.size() && pieces[i].x0 == p.x0 && pieces[i].y0 == p.y0 &&
+                  pieces[i].x1 == p.x1 && pieces[i].y1 == p.y1; ++i) {
+          p.flip1 = p.flip1 != pieces[i].flip1;
+          p.flip2 = p.flip2 != pieces[i].flip2;
+        }
+        if (p.flip1 || p.flip2) pieces[m++] = p;
+      }
+      pieces.resize(m);
+      return pieces;
     }
-    
-    //: Adds a Clipper polygon to a given vgl_polygon.
-    template <class T>
-    void
-    add_clipper_to_vgl( vgl_polygon<T>& vgl_poly, const ClipperLib::Paths& clipper_poly, double scale )
+
+    //: Second pass, over pieces that only meet at their ends: find the
+    //  regions on both sides of each and return the edges of the result.
+    std::vector<sweep_event*> classify(std::vector<piece> const& pieces, vgl_clip_type op)
     {
-        for (const auto & c : clipper_poly) {
-            vgl_poly.new_sheet();
-            for ( size_t p=0; p < c.size(); ++p ) {
-                vgl_poly.push_back( T((double)c[p].X/scale),
-                                   T((double)c[p].Y/scale) );
-            }
+      add_pieces(pieces);
+      std::vector<sweep_event*> result;
+      while (!queue.empty()) {
+        sweep_event* e = queue.top();
+        queue.pop();
+        if (e->left) {
+          e->pos = status.insert(e);
+          e->in_status = true;
+          compute_fields(e, e->pos == status.begin() ? nullptr : *std::prev(e->pos));
+          compute_result(e, op);
+          if (e->in_result) result.push_back(e);
+        }
+        else if (e->other->in_status) {
+          status.erase(e->other->pos);
+          e->other->in_status = false;
         }
+      }
+      return result;
     }
-}
+  };
 
-template <class T>
-void
-bounds(vgl_polygon<T> vgl_poly, T& min_x, T& max_x, T& min_y, T& max_y)
-{
-    for (size_t s=0; s < vgl_poly.num_sheets(); ++s) {
-        for (size_t p=0; p < vgl_poly[s].size(); ++p) {
-            if(s==0 && p==0) { // not the most ideal way to initilize this...
-                min_x = max_x = vgl_poly[0][0].x();
-                min_y = max_y = vgl_poly[0][0].y();
-            }
-            
-            min_x = std::min(vgl_poly[s][p].x(), min_x);
-            min_y = std::min(vgl_poly[s][p].y(), min_y);
-            max_x = std::max(vgl_poly[s][p].x(), max_x);
-            max_y = std::max(vgl_poly[s][p].y(), max_y);
+  //: Join the result edges into closed contours, interior on the left.
+  template <class T>
+  vgl_polygon<T> connect(std::vector<sweep_event*> const& edges)
+  {
+    typedef std::pair<double, double> pt;
+    std::vector<pt> nodes;
+    nodes.reserve(2 * edges.size());
+    for (sweep_event const* e : edges) {
+      nodes.emplace_back(e->x, e->y);
+      nodes.emplace_back(e->other->x, e->other->y);
+    }
+    std::sort(nodes.begin(), nodes.end());
+    nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+    auto node_of = [&nodes](double x, double y) {
+      return unsigned(std::lower_bound(nodes.begin(), nodes.end(), pt(x, y)) - nodes.begin());
+    };
+
+    // directed edges, grouped by start node and sorted by angle
+    struct dir_edge { unsigned from, to; double angle; };
+    std::vector<dir_edge> de;
+    de.reserve(edges.size());
+    for (sweep_event const* e : edges) {
+      sweep_event const* a = e->result_below ? e->other : e;
+      sweep_event const* b = e->result_below ? e : e->other;
+      de.push_back({ node_of(a->x, a->y), node_of(b->x, b->y), std::atan2(b->y - a->y, b->x - a->x) });
+    }
+    std::sort(de.begin(), de.end(), [](dir_edge const& p, dir_edge const& q) {
+      return p.from != q.from ? p.from < q.from : p.angle < q.angle; });
+    std::vector<unsigned> first(nodes.size() + 1, 0);
+    for (dir_edge const& d : de) ++first[d.from + 1];
+    for (unsigned i = 0; i < nodes.size(); ++i) first[i + 1] += first[i];
+    std::vector<char> used(de.size(), 0);
+
+    vgl_polygon<T> result;
+    std::vector<pt> loop, out;
+    for (unsigned start = 0; start < de.size(); ++start) {
+      if (used[start]) continue;
+      loop.clear();
+      unsigned cur = start;
+      used[cur] = 1;
+      while (true) {
+        loop.push_back(nodes[de[cur].from]);
+        // leave the end node by the first edge clockwise from the way back
+        const unsigned v = de[cur].to;
+        const pt& pu = nodes[de[cur].from];
+        const pt& pv = nodes[v];
+        const double back = std::atan2(pu.second - pv.second, pu.first - pv.first);
+        unsigned next = unsigned(-1), wrap = unsigned(-1);
+        for (unsigned k = first[v]; k < first[v + 1]; ++k) {
+          if (used[k] && k != start) continue;
+          if (de[k].angle < back) next = k;
+          wrap = k;
         }
+        if (next == unsigned(-1)) next = wrap;
+        if (next == unsigned(-1) || next == start) break;
+        used[next] = 1;
+        cur = next;
+      }
+      // drop collinear vertices
+      out.clear();
+      for (pt const& p : loop) {
+        while (out.size() >= 2 &&
+               vgl_orient_2d(out[out.size()-2].first, out[out.size()-2].second,
+                             out.back().first, out.back().second, p.first, p.second) == 0)
+          out.pop_back();
+        out.push_back(p);
+      }
+      std::size_t b = 0;
+      while (out.size() - b >= 3) {
+        const std::size_t n = out.size();
+        if (vgl_orient_2d(out[n-2].first, out[n-2].second, out[n-1].first, out[n-1].second,
+                          out[b].first, out[b].second) == 0)
+          out.pop_back();
+        else if (vgl_orient_2d(out[n-1].first, out[n-1].second, out[b].first, out[b].second,
+                               out[b+1].first, out[b+1].second) == 0)
+          ++b;
+        else
+          break;
+      }
+      if (out.size() - b < 3) continue;
+      result.new_sheet();
+      for (std::size_t i = b; i < out.size(); ++i)
+        result.push_back(T(out[i].first), T(out[i].second));
     }
-}
+    return result;
+  }
 
-#endif
+  template <class T>
+  void bounds(vgl_polygon<T> const& poly, double& min_x, double& max_x, double& min_y, double& max_y)
+  {
+    min_x = min_y = std::numeric_limits<double>::infinity();
+    max_x = max_y = -std::numeric_limits<double>::infinity();
+    for (unsigned s = 0; s < poly.num_sheets(); ++s)
+      for (auto const& p : poly[s]) {
+        min_x = std::min(min_x, double(p.x())); max_x = std::max(max_x, double(p.x()));
+        min_y = std::min(min_y, double(p.y())); max_y = std::max(max_y, double(p.y()));
+      }
+  }
+}
 
 template <class T>
 vgl_polygon<T>
@@ -315,103 +767,51 @@ vgl_clip(vgl_polygon<T> const& poly1, vgl_polygon<T> const& poly2, vgl_clip_type
             default:                         *p_retval = -1; return vgl_polygon<T>(); // this should not happen...
         }
     }
-    
-    vgl_polygon<T> result;
-    
-#ifdef BUILD_NONCOMMERCIAL
-    gpc_polygon p1 = vgl_to_gpc( poly1 );
-    gpc_polygon p2 = vgl_to_gpc( poly2 );
-    gpc_polygon p3;
-    
-    gpc_op g_op = GPC_INT;
-    switch ( op )
-    {
-        case vgl_clip_type_intersect:    g_op = GPC_INT;   break;
-        case vgl_clip_type_difference:   g_op = GPC_DIFF;  break;
-        case vgl_clip_type_union:        g_op = GPC_UNION; break;
-        case vgl_clip_type_xor:          g_op = GPC_XOR;   break;
-        default:                         break;
+    if ( op != vgl_clip_type_intersect && op != vgl_clip_type_union &&
+         op != vgl_clip_type_difference && op != vgl_clip_type_xor ) {
+        *p_retval = -1;
+        return vgl_polygon<T>();
     }
-    
-    int retval = gpc_polygon_clip( g_op, &p1, &p2, &p3 );
-    *p_retval = retval;
-    
-    if (retval == 0) {
-        gpc_free_polygon( &p1 );
-        gpc_free_polygon( &p2 );
-        return result;
-    }
-    add_gpc_to_vgl( result, p3 );
-    
-    gpc_free_polygon( &p1 );
-    gpc_free_polygon( &p2 );
-    gpc_free_polygon( &p3 );
-    
-#elif HAS_CLIPPER
-    ClipperLib::Clipper clpr;
-    // Clipper operates in fixed point space (because it is more robust), so we need
-    // to compute a scale factor to preserve precision.
-    // per Angus Johnson, "if any coordinate value exceeds +/-3.0e+9, large integer
-    // math slows clipping by about 10%"
-    int halfSignificantDigits = std::numeric_limits<ClipperLib::cInt>::digits10/2;
-    
-    T min_x, max_x, min_y, max_y;
-    bounds( poly1, min_x, max_x, min_y, max_y);
-    max_x = std::max(max_x, std::abs(min_x));
-    max_y = std::max(max_y, std::abs(min_y));
-    T max1 = std::max(max_x, max_y);
-    
-    bounds( poly2, min_x, max_x, min_y, max_y);
-    max_x = std::max(max_x, std::abs(min_x));
-    max_y = std::max(max_y, std::abs(min_y));
-    T max2 = std::max(max_x, max_y);
-    
-    T max = std::max(max1, max2);
-    double scale = std::pow(10.0, halfSignificantDigits) / max;
-    
-    
-    ClipperLib::Paths p1 = vgl_to_clipper( poly1, scale );
-    ClipperLib::Paths p2 = vgl_to_clipper( poly2, scale );
-    ClipperLib::Paths p3;
-    
-    ClipperLib::ClipType g_op = ClipperLib::ctIntersection;
-    switch ( op )
-    {
-        case vgl_clip_type_intersect:    g_op = ClipperLib::ctIntersection; break;
-        case vgl_clip_type_difference:   g_op = ClipperLib::ctDifference;   break;
-        case vgl_clip_type_union:        g_op = ClipperLib::ctUnion; break;
-        case vgl_clip_type_xor:          g_op = ClipperLib::ctXor;   break;
-        default:                         break;
-    }
-    
-    
-    clpr.AddPaths(p1, ClipperLib::ptSubject, true);
-    clpr.AddPaths(p2, ClipperLib::ptClip, true);
-    int retval = clpr.Execute(g_op, p3, ClipperLib::pftEvenOdd, ClipperLib::pftEvenOdd);
-    *p_retval = retval;
-    
-    add_clipper_to_vgl( result, p3, scale );
-    
-#else
-    *p_retval = -1;
-    std::fprintf(stdout,"WARNING: GPC is only free for non-commercial use -- assuming disjoint polygons.\n");
-    std::fprintf(stderr,"WARNING: GPC is only free for non-commercial use -- assuming disjoint polygons.\n");
-    switch ( op )
-    {
-        default:
-        case vgl_clip_type_intersect:    result = vgl_polygon<T>(); break; // empty
-        case vgl_clip_type_difference:   result = poly1; break;
-        case vgl_clip_type_union:
-        case vgl_clip_type_xor:
-            result = poly1;
+    *p_retval = 1;
+
+    // Disjoint bounding boxes need no sweep
+    double min_x1, max_x1, min_y1, max_y1, min_x2, max_x2, min_y2, max_y2;
+    vgl_clip_detail::bounds(poly1, min_x1, max_x1, min_y1, max_y1);
+    vgl_clip_detail::bounds(poly2, min_x2, max_x2, min_y2, max_y2);
+    if ( min_x1 > max_x2 || min_x2 > max_x1 || min_y1 > max_y2 || min_y2 > max_y1 ) {
+        if ( op == vgl_clip_type_intersect )
+            return vgl_polygon<T>();
+        vgl_polygon<T> result(poly1);
+        if ( op != vgl_clip_type_difference ) // union or xor
             for (unsigned int i=0; i<poly2.num_sheets(); ++i)
                 result.push_back(poly2[i]);
-            break;
+        return result;
     }
-    
-#endif
-    
-    return result;
+
+    vgl_clip_detail::sweep split;
+    unsigned contour = 0;
+    split.add_polygon(poly1, true, contour);
+    split.add_polygon(poly2, false, contour);
+
+    // Nothing contributes to the result right of these
+    const double stop_x = op == vgl_clip_type_intersect  ? std::min(max_x1, max_x2)
+                        : op == vgl_clip_type_difference ? max_x1
+                        : std::numeric_limits<double>::infinity();
+    std::vector<vgl_clip_detail::piece> pieces = split.subdivide(stop_x);
+
+    // Splitting at a rounded point turns an edge slightly, so that it may
+    // cross edges already passed; sweep the pieces again until it is exact
+    bool inexact = split.inexact;
+    for (int pass = 0; inexact && pass < 4; ++pass) {
+        vgl_clip_detail::sweep resplit;
+        resplit.add_pieces(pieces);
+        pieces = resplit.subdivide(stop_x);
+        inexact = resplit.inexact;
+    }
+
+    vgl_clip_detail::sweep classify;
+    std::vector<vgl_clip_detail::sweep_event*> edges = classify.classify(pieces, op);
+    return vgl_clip_detail::connect<T>(edges);
 }
 
 template <class T>
@@ -422,4 +822,159 @@ vgl_clip(vgl_polygon<T> const& poly1, vgl_polygon<T> const& poly2, vgl_clip_type
     return vgl_clip(poly1, poly2, op, &retval);
 }
 
+namespace vgl_clip_detail
+{
+  //: Append the pieces of the closed ring in the slabs between consecutive cuts, across x or, if along_y, across y.
+  //  The piece in slab k is appended to slabs[k] as a new ring; mark[k] == id tells it was started for this ring.
+  template <class T>
+  void split_ring(std::vector<vgl_point_2d<T> > const& ring, std::vector<T> const& cuts, bool along_y, unsigned id,
+                  std::vector<unsigned>& mark, std::vector<std::vector<std::vector<vgl_point_2d<T> > > >& slabs)
+  {
+    const std::size_t n = ring.size();
+    auto u = [along_y](vgl_point_2d<T> const& p) { return along_y ? p.y() : p.x(); };
+    auto emit = [&](std::size_t k, vgl_point_2d<T> const& p) {
+      if (mark[k] != id) {
+        mark[k] = id;
+        slabs[k].emplace_back();
+      }
+      std::vector<vgl_point_2d<T> >& piece = slabs[k].back();
+      if (piece.empty() || piece.back() != p)
+        piece.push_back(p);
+    };
+    // the point of the edge from p to q where u is c, which is exact at the cut
+    auto at = [&](vgl_point_2d<T> const& p, vgl_point_2d<T> const& q, T c) -> vgl_point_2d<T> {
+      if (c == u(p)) return p;
+      if (c == u(q)) return q;
+      const double t = (double(c) - double(u(p))) / (double(u(q)) - double(u(p)));
+      return along_y ? vgl_point_2d<T>(T(p.x() + t * (q.x() - p.x())), c)
+                     : vgl_point_2d<T>(c, T(p.y() + t * (q.y() - p.y())));
+    };
+    for (std::size_t i = 0; i < n; ++i) {
+      vgl_point_2d<T> const& p = ring[i];
+      vgl_point_2d<T> const& q = ring[i + 1 < n ? i + 1 : 0];
+      const T lo = std::min(u(p), u(q)), hi = std::max(u(p), u(q));
+      // the slabs [cuts[k], cuts[k+1]] that meet [lo, hi]
+      std::size_t k = std::upper_bound(cuts.begin(), cuts.end(), lo) - cuts.begin();
+      k = k > 0 ? k - 1 : 0;
+      for (; k + 1 < cuts.size() && cuts[k] <= hi; ++k) {
+        if (cuts[k + 1] < lo)
+          continue;
+        emit(k, at(p, q, std::min(std::max(u(p), cuts[k]), cuts[k + 1])));
+        emit(k, at(p, q, std::min(std::max(u(q), cuts[k]), cuts[k + 1])));
+      }
+    }
+  }
+
+  //: Tidy a piece clipped to the box [x0, x1] by [y0, y1] and add it to result, unless it has no area.
+  //  A piece that only runs round the box boundary is not added; its winding number is returned instead.
+  template <class T>
+  double finish_piece(std::vector<vgl_point_2d<T> > const& piece, T x0, T x1, T y0, T y1, vgl_polygon<T>& result)
+  {
+    // the box edges through both points: bit 0 x0, 1 x1, 2 y0, 3 y1
+    auto sides = [&](vgl_point_2d<T> const& p) {
+      return (p.x() == x0 ? 1 : 0) | (p.x() == x1 ? 2 : 0) | (p.y() == y0 ? 4 : 0) | (p.y() == y1 ? 8 : 0);
+    };
+    // drop repeated points, and the middle of three points along one box edge
+    std::vector<vgl_point_2d<T> > r;
+    for (auto const& p : piece) {
+      if (!r.empty() && r.back() == p)
+        continue;
+      while (r.size() >= 2 && (sides(r[r.size() - 2]) & sides(r.back()) & sides(p)))
+        r.pop_back();
+      r.push_back(p);
+    }
+    // and the same where the ring closes
+    std::size_t first = 0;
+    while (r.size() - first >= 3) {
+      if (r.back() == r[first] || (sides(r[r.size() - 2]) & sides(r.back()) & sides(r[first])))
+        r.pop_back();
+      else if (sides(r.back()) & sides(r[first]) & sides(r[first + 1]))
+        ++first;
+      else
+        break;
+    }
+    r.erase(r.begin(), r.begin() + first);
+    if (r.size() < 3)
+      return 0.0;
+    bool on_boundary = true;
+    for (std::size_t i = 0; i < r.size() && on_boundary; ++i)
+      on_boundary = (sides(r[i]) & sides(r[(i + 1) % r.size()])) != 0;
+    if (on_boundary) {
+      const double box_area = (double(x1) - double(x0)) * (double(y1) - double(y0));
+      return box_area > 0 ? std::floor(vgl_orient_2d(r) / 2 / box_area + 0.5) : 0.0;
+    }
+    result.push_back(r);
+    return 0.0;
+  }
+
+  //: Add the whole box, oriented by the sign of winding, if the winding number is odd (the even-odd rule).
+  template <class T>
+  void add_box(double winding, T x0, T x1, T y0, T y1, vgl_polygon<T>& result)
+  {
+    if (std::fmod(winding, 2.0) == 0.0)
+      return;
+    std::vector<vgl_point_2d<T> > r;
+    r.emplace_back(x0, y0); r.emplace_back(x1, y0); r.emplace_back(x1, y1); r.emplace_back(x0, y1);
+    if (winding < 0)
+      std::reverse(r.begin(), r.end());
+    result.push_back(r);
+  }
+}
+
+template <class T>
+void
+vgl_clip_to_grid(vgl_polygon<T> const& poly, std::vector<T> const& xs, std::vector<T> const& ys,
+                 std::vector<vgl_polygon<T> >& tiles)
+{
+  typedef std::vector<vgl_point_2d<T> > ring_t;
+  const std::size_t nx = xs.size() < 2 ? 0 : xs.size() - 1, ny = ys.size() < 2 ? 0 : ys.size() - 1;
+  tiles.assign(nx * ny, vgl_polygon<T>());
+  if (!nx || !ny)
+    return;
+  std::vector<std::vector<ring_t> > columns(nx), rows(ny);
+  std::vector<unsigned> column_mark(nx, unsigned(-1)), row_mark(ny, unsigned(-1));
+  unsigned id = 0;
+  for (unsigned s = 0; s < poly.num_sheets(); ++s, ++id)
+    if (poly[s].size() >= 3)
+      vgl_clip_detail::split_ring(poly[s], xs, false, id, column_mark, columns);
+  for (std::size_t i = 0; i < nx; ++i) {
+    for (ring_t const& strip : columns[i])
+      vgl_clip_detail::split_ring(strip, ys, true, id++, row_mark, rows);
+    for (std::size_t j = 0; j < ny; ++j) {
+      // pieces running round the whole tile are merged into one, or none
+      double winding = 0.0;
+      for (ring_t const& piece : rows[j])
+        winding += vgl_clip_detail::finish_piece(piece, xs[i], xs[i + 1], ys[j], ys[j + 1], tiles[j * nx + i]);
+      vgl_clip_detail::add_box(winding, xs[i], xs[i + 1], ys[j], ys[j + 1], tiles[j * nx + i]);
+      rows[j].clear();
+    }
+  }
+}
+
+template <class T>
+void
+vgl_clip_to_grid(vgl_polygon<T> const& poly, vgl_box_2d<T> const& b, unsigned nx, unsigned ny,
+                 std::vector<vgl_polygon<T> >& tiles)
+{
+  if (b.is_empty() || !nx || !ny) {
+    tiles.assign(std::size_t(nx) * ny, vgl_polygon<T>());
+    return;
+  }
+  std::vector<T> xs(nx + 1), ys(ny + 1);
+  for (unsigned i = 0; i <= nx; ++i)
+    xs[i] = i == nx ? b.max_x() : T(b.min_x() + (double(b.max_x()) - double(b.min_x())) * i / nx);
+  for (unsigned j = 0; j <= ny; ++j)
+    ys[j] = j == ny ? b.max_y() : T(b.min_y() + (double(b.max_y()) - double(b.min_y())) * j / ny);
+  vgl_clip_to_grid(poly, xs, ys, tiles);
+}
+
+template <class T>
+vgl_polygon<T>
+vgl_clip(vgl_polygon<T> const& poly, vgl_box_2d<T> const& b)
+{
+  std::vector<vgl_polygon<T> > tiles;
+  vgl_clip_to_grid(poly, b, 1, 1, tiles);
+  return tiles[0];
+}
+
 #endif // vgl_clip_h_
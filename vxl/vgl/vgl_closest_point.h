@@ -23,6 +23,7 @@
 // \endverbatim
 
 #include <utility>
+#include <algorithm>
 #include <limits>
 #include <cassert>
 #include <vgl/vgl_fwd.h> // forward declare various vgl classes
@@ -46,7 +47,8 @@
 //#include <vgl/vgl_polygon.h>
 #include <vgl/vgl_ray_3d.h>
 #include <vgl/vgl_pointset_3d.h>
-//#include <vgl/vgl_cubic_spline_3d.h>
+#include <vgl/vgl_pointset_3d_soa.h>
+#include <vgl/vgl_kd_tree_3d.h>
 //#include <vgl/vgl_infinite_line_3d.h>
 
 // @todo move square to other place
@@ -363,22 +365,28 @@ vgl_point_3d<T> vgl_closest_point(vgl_sphere_3d<T> const& s,
                                   vgl_point_3d<T> const& p);
  */
 
-/*
 //: Return the closest point on a pointset \a ptset to a point \a p in 3D
 // \relatesalso vgl_point_3d. If ptset has normals, the closest point on the plane
 // passing trough the closest point is returned. If that planar point is further than dist away from
 // the closest point in ptset then the closest point in the ptset is returned.
 //
+// If \a index is given it must be a vgl_kd_tree_3d built over ptset; it replaces
+// the linear scan over all points.
 template <class T>
 vgl_point_3d<T> vgl_closest_point(vgl_pointset_3d<T> const& ptset, vgl_point_3d<T> const& p,
-                                  T dist = std::numeric_limits<T>::max());
-*/
+                                  T dist = std::numeric_limits<T>::max(),
+                                  vgl_kd_tree_3d<T> const* index = nullptr);
 
-/*
-//: Return the closest point on a cubic spline
+//: Return the closest point on a structure-of-arrays pointset \a ptset to a point \a p in 3D
+//  Same as for vgl_pointset_3d; the search without \a index runs over the coordinate arrays in blocks.
 template <class T>
-vgl_point_3d<T> vgl_closest_point(vgl_cubic_spline_3d<T> const& cspl, vgl_point_3d<T> const& p);
-*/
+vgl_point_3d<T> vgl_closest_point(vgl_pointset_3d_soa<T> const& ptset, vgl_point_3d<T> const& p,
+                                  T dist = std::numeric_limits<T>::max(),
+                                  vgl_kd_tree_3d<T> const* index = nullptr);
+
+// The closest point on a cubic spline, vgl_closest_point(vgl_cubic_spline_3d<T>, vgl_point_3d<T>)
+// and its 2-d counterpart, is declared in vgl_prepared_cubic_spline.h, which this file cannot include
+// (vgl_cubic_spline_3d.h includes it through vgl_plane_3d.h).
 
 // copy from .cpp
 //using SMALL_DOUBLE = vgl_tolerance<double>::SMALL_DOUBLE;
@@ -973,28 +981,11 @@ vgl_point_3d<T> vgl_closest_point(vgl_sphere_3d<T> const& s,
 }
 */
 
-/*
+//: closest point to p on the plane through pc with normal norm, or pc itself if that is further than dist from p
 template <class T>
-vgl_point_3d<T> vgl_closest_point(vgl_pointset_3d<T> const& ptset,
-                                  vgl_point_3d<T> const& p, T dist){
-    unsigned n = ptset.npts();
-    if(n == 0)
-        return vgl_point_3d<T>();
-    unsigned iclose = 0;
-    double d_close = 1.0/vgl_tolerance<double>::SMALL_DOUBLE;
-    for(unsigned i = 0; i<n; ++i){
-        vgl_point_3d<T> pi = ptset.p(i);
-        double d = (pi-p).length();
-        if(d<d_close){
-            d_close = d;
-            iclose = i;
-        }
-    }
-    vgl_point_3d<T> pc = ptset.p(iclose);
-    if(!ptset.has_normals())
-        return pc;
-    const vgl_vector_3d<T>& norm = ptset.n(iclose);
-    //otherwise construct the plane and find closest point on that
+vgl_point_3d<T> vgl_closest_point_on_tangent_plane(vgl_point_3d<T> const& pc, vgl_vector_3d<T> const& norm,
+                                                   vgl_point_3d<T> const& p, T dist){
+    // construct the plane and find closest point on that
     if(std::numeric_limits<T>::is_integer){
         // closest point can be templated over int so cast to double for plane computations
         vgl_point_3d<double> pd(static_cast<double>(p.x()), static_cast<double>(p.y()), static_cast<double>(p.z()));
@@ -1017,98 +1008,73 @@ vgl_point_3d<T> vgl_closest_point(vgl_pointset_3d<T> const& ptset,
         return pc_plane;
     }
 }
-*/
 
-/*
 template <class T>
-vgl_point_3d<T> vgl_closest_point(vgl_cubic_spline_3d<T> const& cspl, vgl_point_3d<T> const& p){
-    // find the closest knot
-    std::vector<vgl_point_3d<T> > const& knots = cspl.const_knots();
-    unsigned n = cspl.n_knots();
-    double min_dist = std::numeric_limits<double>::max();
-    unsigned min_index = 0;
-    for(unsigned i = 0; i<n; ++i){
-        double d = vgl_distance(knots[i],p);
-        if(d<min_dist){
-            min_dist  = d;
-            min_index = i;
-        }
-    }
-    unsigned start_index = 0, end_index = 0;
-    // find the interval assuming that the closest knots span the closest point
-    // cases
-    if(min_index == 0){
-        if(cspl.closed()){
-            double dm = vgl_distance(knots[n-2], p);
-            double dp = vgl_distance(knots[1], p);
-            if(dp<dm){
-                start_index = 0;
-                end_index = 1;
-            }else{
-                start_index = n-2;
-                end_index = n-1;
-            }
-        }else{
-            start_index = 0;
-            end_index = 1;
-        }
-    }else if(min_index == n-1){
-        if(cspl.closed()){
-            double dm = vgl_distance(knots[n-2], p);
-            double dp = vgl_distance(knots[1], p);
-            if(dp<dm){
-                start_index = 0;
-                end_index = 1;
-            }else{
-                start_index = n-2;
-                end_index = n-1;
-            }
-        }else{
-            start_index = n-2;
-            end_index = n-1;
-        }
+vgl_point_3d<T> vgl_closest_point(vgl_pointset_3d<T> const& ptset,
+                                  vgl_point_3d<T> const& p, T dist,
+                                  vgl_kd_tree_3d<T> const* index){
+    unsigned n = ptset.npts();
+    if(n == 0)
+        return vgl_point_3d<T>();
+    unsigned iclose = 0;
+    if(index){
+        assert(index->size() == n);
+        iclose = static_cast<unsigned>(index->nearest(p));
     }else{
-        double dm = vgl_distance(knots[min_index-1], p);
-        double dp = vgl_distance(knots[min_index+1], p);
-        if(dp<dm){
-            start_index = min_index;
-            end_index = min_index+1;
-        }else{
-            start_index = min_index-1;
-            end_index = min_index;
+        double d_close = 1.0/vgl_tolerance<double>::SMALL_DOUBLE;
+        for(unsigned i = 0; i<n; ++i){
+            vgl_point_3d<T> pi = ptset.p(i);
+            double d = (pi-p).length();
+            if(d<d_close){
+                d_close = d;
+                iclose = i;
+            }
         }
     }
-    // iterate to fine closest point (within 1/1000 of the interval)
-    T sindx = static_cast<T>(start_index), eindx = static_cast<T>(end_index);
-    bool first = true;
-    unsigned iter = 0;
-    double tolerance = vgl_distance(knots[start_index],knots[end_index])/T(1000);
-    T t = (sindx+ eindx)/T(2);
-    vgl_point_3d<T> cp = cspl(t);
-    double dcm = vgl_distance(p, cp), dcm0 = 0.0 ;
-    unsigned max_iter = 100;
-    while(first || ((std::fabs(dcm - dcm0)>tolerance)&&iter<max_iter)){
-        dcm0 = dcm;
-        first = false;
-        T tp = (t+eindx)/T(2), tm = (t+sindx)/T(2);
-        double dp = vgl_distance(p, cspl(tp));
-        double dm = vgl_distance(p, cspl(tm));
-        if(dp<dm){
-            sindx = t;
-            t = tp;
-        }else{
-            eindx = t;
-            t = tm;
+    if(!ptset.has_normals())
+        return ptset.p(iclose);
+    return vgl_closest_point_on_tangent_plane(ptset.p(iclose), ptset.n(iclose), p, dist);
+}
+
+template <class T>
+vgl_point_3d<T> vgl_closest_point(vgl_pointset_3d_soa<T> const& ptset,
+                                  vgl_point_3d<T> const& p, T dist,
+                                  vgl_kd_tree_3d<T> const* index){
+    const std::size_t n = ptset.npts();
+    if(n == 0)
+        return vgl_point_3d<T>();
+    std::size_t iclose = 0;
+    if(index){
+        assert(index->size() == n);
+        iclose = static_cast<std::size_t>(index->nearest(p));
+    }else{
+        // squared distances of a block of points in a vectorisable loop, then the minimum of the block
+        using dist_t = typename vgl_kd_tree_3d<T>::dist_t;
+        const std::size_t block = 256;
+        dist_t d2[block];
+        dist_t d_close = std::numeric_limits<dist_t>::max();
+        T const* x = ptset.x().data();
+        T const* y = ptset.y().data();
+        T const* z = ptset.z().data();
+        const dist_t px = p.x(), py = p.y(), pz = p.z();
+        for(std::size_t b = 0; b<n; b += block){
+            const std::size_t m = std::min(block, n-b);
+            for(std::size_t i = 0; i<m; ++i){
+                const dist_t dx = dist_t(x[b+i])-px, dy = dist_t(y[b+i])-py, dz = dist_t(z[b+i])-pz;
+                d2[i] = dx*dx + dy*dy + dz*dz;
+            }
+            for(std::size_t i = 0; i<m; ++i)
+                if(d2[i]<d_close){
+                    d_close = d2[i];
+                    iclose = b+i;
+                }
         }
-        cp = cspl(t);
-        dcm = vgl_distance(p,cp);
-        iter++;
     }
-    if(iter>=max_iter)
-        std::cout << " Warning: exceeded num interations in closest point cubic_spline_3d\n";
-    return cp;
+    if(!ptset.has_normals())
+        return ptset.p(static_cast<unsigned>(iclose));
+    return vgl_closest_point_on_tangent_plane(ptset.p(static_cast<unsigned>(iclose)),
+                                              ptset.n(static_cast<unsigned>(iclose)), p, dist);
 }
- */
 
 
 #endif // vgl_closest_point_h_
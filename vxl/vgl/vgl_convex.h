@@ -8,96 +8,114 @@
 // \date 14 November 2003
 
 #include <vector>
-#include <limits>
+#include <algorithm>
 #include <cmath>
-#include <list>
+#include <cstddef>
 
 #include "vgl_point_2d.h"
 #include "vgl_polygon.h"
+#include "vgl_predicates.h"
+#include "vgl_parallel.h"
 
 //: Return a single-sheet polygon which is the smallest one containing all given points
+//  The vertices are listed clockwise, starting from the lowest of the leftmost points;
+//  points in the interior of hull edges are not vertices.  The hull is computed with
+//  Andrew's monotone chain after discarding the points inside the octagon of extreme
+//  points (Akl-Toussaint), with exact orientation tests; large inputs are split among
+//  nthreads threads (0: std::thread::hardware_concurrency()), whose partial hulls are
+//  merged at the end.
 // \relatesalso vgl_polygon
-template <class T> vgl_polygon<T> vgl_convex_hull(std::vector<vgl_point_2d<T> > const& points);
+template <class T> vgl_polygon<T> vgl_convex_hull(std::vector<vgl_point_2d<T> > const& points, unsigned nthreads = 0);
 
 // copy from .cpp
-//: Calculate the negative cosine of the angle from dir to next - current.
-// If next and current are on top of each other, pretend it is a high angle.
-// Use cosine because it is quicker to calculate and monotonic with angle
-// over [0 pi].
+//: Convex hull of pts, counterclockwise from the lowest of the leftmost points; pts is reordered.
 template <class T>
-static T get_nc_angle(const vgl_vector_2d<T> &last_dir,
-                      const vgl_point_2d<T> &current,
-                      const vgl_point_2d<T> &next)
+static void vgl_convex_hull_ccw(std::vector<vgl_point_2d<T> >& pts, std::vector<vgl_point_2d<T> >& hull)
 {
-    vgl_vector_2d<T> v = next - current;
-    double eps = std::sqrt(current.x() * current.x() + current.y() * current.y())
-    * std::numeric_limits<T>::epsilon();
-    
-    //if the two points are on top of each other, pretend it is a very bad angle.
-    // Use an illegal cosine value to indicate this.
-    if (v.length() <= eps) return (T)2.0;
-    return T(-cos_angle(last_dir, v));
+    hull.clear();
+    if (pts.empty()) return;
+    // Akl-Toussaint: the extreme points along x, y, x+y and x-y, in counterclockwise order
+    std::size_t ext[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+    for (std::size_t i = 1; i < pts.size(); ++i) {
+        const T x = pts[i].x(), y = pts[i].y();
+        if (x < pts[ext[0]].x()) ext[0] = i;
+        if (x + y < pts[ext[1]].x() + pts[ext[1]].y()) ext[1] = i;
+        if (y < pts[ext[2]].y()) ext[2] = i;
+        if (x - y > pts[ext[3]].x() - pts[ext[3]].y()) ext[3] = i;
+        if (x > pts[ext[4]].x()) ext[4] = i;
+        if (x + y > pts[ext[5]].x() + pts[ext[5]].y()) ext[5] = i;
+        if (y > pts[ext[6]].y()) ext[6] = i;
+        if (x - y < pts[ext[7]].x() - pts[ext[7]].y()) ext[7] = i;
+    }
+    std::vector<vgl_point_2d<T> > oct;
+    for (unsigned k = 0; k < 8; ++k)
+        if (oct.empty() || (pts[ext[k]] != oct.back() && pts[ext[k]] != oct.front()))
+            oct.push_back(pts[ext[k]]);
+    if (oct.size() >= 3) {
+        // drop the points strictly inside the octagon; they cannot be on the hull
+        std::size_t m = 0;
+        for (std::size_t i = 0; i < pts.size(); ++i) {
+            bool inside = true;
+            for (std::size_t k = 0; k < oct.size() && inside; ++k)
+                inside = vgl_orient_2d(oct[k], oct[(k + 1) % oct.size()], pts[i]) > 0;
+            if (!inside) pts[m++] = pts[i];
+        }
+        pts.resize(m);
+    }
+
+    std::sort(pts.begin(), pts.end(), [](vgl_point_2d<T> const& p, vgl_point_2d<T> const& q)
+              { return p.x() < q.x() || (p.x() == q.x() && p.y() < q.y()); });
+    pts.erase(std::unique(pts.begin(), pts.end()), pts.end());
+    const std::size_t n = pts.size();
+    if (n < 3) { hull = pts; return; }
+
+    // lower chain left to right, then upper chain right to left, popping non-left turns
+    hull.resize(2 * n);
+    std::size_t k = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        while (k >= 2 && vgl_orient_2d(hull[k - 2], hull[k - 1], pts[i]) <= 0) --k;
+        hull[k++] = pts[i];
+    }
+    for (std::size_t i = n - 1, t = k + 1; i-- > 0;) {
+        while (k >= t && vgl_orient_2d(hull[k - 2], hull[k - 1], pts[i]) <= 0) --k;
+        hull[k++] = pts[i];
+    }
+    hull.resize(k - 1);
 }
 
 template <class T>
-vgl_polygon<T> vgl_convex_hull(std::vector<vgl_point_2d<T> > const& points)
+vgl_polygon<T> vgl_convex_hull(std::vector<vgl_point_2d<T> > const& points, unsigned nthreads)
 {
     vgl_polygon<T> hull(1);
     if (points.empty()) return hull;
-    
-    typedef typename std::list<vgl_point_2d<T> >::iterator ITER;
-    
-    // A list of points still not used.
-    std::list<vgl_point_2d<T> > pts(points.begin(), points.end());
-    
-    // Find left most point.
-    ITER start = pts.begin();
-    for (ITER i=pts.begin(); i != pts.end(); ++i)
-        if (i->x() < start->x()) start=i;
-    
-    vgl_point_2d<T> first = *start; // Closing point on hull.
-    vgl_point_2d<T> current = first; // Current point on hull.
-    vgl_vector_2d<T> last_dir(0,1); // Direction of last segment added to hull.
-    hull.push_back(first);
-    pts.erase(start);
-    bool not_starting = false;
-    // iterate through remaining points
-    while (true)
-    {
-        // if we are out of points, then our poly is the answer.
-        if (pts.empty()) return hull;
-        
-        // Calculate angles to closing point, and all the remaining points.
-        double nc_angle_to_first = get_nc_angle(last_dir, current, first);
-        
-        // If the current point is not the closing point, but is very close to it,
-        // then we are done.
-        if (not_starting && nc_angle_to_first > 1.5) return hull;
-        not_starting=true;
-        
-        double best_nc_angle = 1.5;
-        ITER best;
-        
-        for (ITER i=pts.begin(); i != pts.end(); ++i)
-        {
-            double nc_angle = get_nc_angle(last_dir, current, *i);
-            if (nc_angle < best_nc_angle)
-            {
-                best_nc_angle = nc_angle;
-                best = i;
-            }
-        }
-        
-        // If the closing angle is lowest, the our hull is the answer.
-        if (nc_angle_to_first <= best_nc_angle) return hull;
-        
-        
-        // Add best point to hull, remove from list, update invariant.
-        hull.push_back(*best);
-        last_dir=*best - current;
-        current = * best;
-        pts.erase(best);
+
+    // below this size a thread costs more than it saves
+    const std::size_t min_chunk = 1 << 16;
+    nthreads = vgl_parallel_detail::thread_count(nthreads, points.size(), min_chunk);
+
+    std::vector<vgl_point_2d<T> > ccw;
+    if (nthreads <= 1) {
+        std::vector<vgl_point_2d<T> > pts(points);
+        vgl_convex_hull_ccw(pts, ccw);
+    }
+    else {
+        // the hull of the union of the partial hulls is the hull of all points
+        std::vector<std::vector<vgl_point_2d<T> > > parts(nthreads);
+        vgl_parallel_detail::parallel_for(points.size(), nthreads, [&points, &parts](unsigned t, std::size_t b, std::size_t e) {
+            std::vector<vgl_point_2d<T> > pts(points.begin() + b, points.begin() + e);
+            vgl_convex_hull_ccw(pts, parts[t]);
+        });
+        std::vector<vgl_point_2d<T> > pts;
+        for (unsigned t = 0; t < nthreads; ++t)
+            pts.insert(pts.end(), parts[t].begin(), parts[t].end());
+        vgl_convex_hull_ccw(pts, ccw);
     }
+
+    // clockwise, keeping the first vertex
+    hull.push_back(ccw[0]);
+    for (std::size_t i = ccw.size(); --i > 0;)
+        hull.push_back(ccw[i]);
+    return hull;
 }
 
 
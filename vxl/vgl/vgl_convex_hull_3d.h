@@ -0,0 +1,467 @@
+// This is core/vgl/vgl_convex_hull_3d.h
+#ifndef vgl_convex_hull_3d_h_
+#define vgl_convex_hull_3d_h_
+//:
+// \file
+// \brief The convex hull of a set of 3-d points, as a triangle half-edge mesh
+//
+//  The hull is built by incremental Quickhull: starting from a tetrahedron
+//  of extreme points, each point outside the current hull is kept in the
+//  conflict list of one face it lies above, and the farthest point of a face
+//  is added by removing the faces it sees and coning the horizon to it.  The
+//  conflict points of the removed faces are redistributed among the new
+//  faces, the others being inside for good.  Points within a rounding
+//  tolerance of a face plane count as on the hull, so the mesh has no
+//  slivers, but coplanar hull facets are split into several triangles.
+//
+//  For large inputs the points are split among threads, each computes the
+//  hull of its share, and the hull of the union of those vertices is the
+//  result.
+//
+//  The mesh is stored compactly: triangle f is made of the half-edges
+//  3f, 3f+1, 3f+2, counterclockwise seen from outside, so next() and face()
+//  are implicit and only the origin vertex and twin of each half-edge are
+//  stored.  With fewer than four points, or coplanar points, the hull has no
+//  faces and is_valid() is false.
+//
+// \verbatim
+//  Modifications
+// \endverbatim
+
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <cstddef>
+#include <vgl/vgl_point_3d.h>
+#include <vgl/vgl_vector_3d.h>
+#include <vgl/vgl_box_3d.h>
+#include <vgl/vgl_plane_3d.h>
+#include <vgl/vgl_pointset_3d.h>
+#include <vgl/vgl_parallel.h>
+
+template <class T>
+class vgl_convex_hull_3d
+{
+ public:
+  //: Default constructor: the hull of no points
+  vgl_convex_hull_3d() = default;
+
+  //: The hull of pts.
+  //  Inputs of more than 64k points are split among nthreads threads (0: std::thread::hardware_concurrency()).
+  explicit vgl_convex_hull_3d(std::vector<vgl_point_3d<T> > const& pts, unsigned nthreads = 0);
+
+  //: The hull of the points of ptset.
+  explicit vgl_convex_hull_3d(vgl_pointset_3d<T> const& ptset, unsigned nthreads = 0)
+    : vgl_convex_hull_3d(ptset.points(), nthreads) {}
+
+  //: false if the hull has no faces, i.e. the points are fewer than four, or coplanar
+  bool is_valid() const { return !he_vertex_.empty(); }
+
+  //: hull vertices
+  std::size_t n_vertices() const { return vertices_.size(); }
+  vgl_point_3d<T> const& vertex(unsigned v) const { return vertices_[v]; }
+  std::vector<vgl_point_3d<T> > const& vertices() const { return vertices_; }
+  //: index of hull vertex v in the input points
+  unsigned input_index(unsigned v) const { return input_index_[v]; }
+
+  //: triangles
+  std::size_t n_faces() const { return he_vertex_.size() / 3; }
+  //: vertex k (0, 1 or 2) of face f, counterclockwise seen from outside
+  unsigned face_vertex(unsigned f, unsigned k) const { return he_vertex_[3 * f + k]; }
+  //: the plane of face f, normal pointing out of the hull
+  vgl_plane_3d<T> plane(unsigned f) const { return vgl_plane_3d<T>(T(nx_[f]), T(ny_[f]), T(nz_[f]), T(d_[f])); }
+
+  //: half-edges; half-edge h runs from origin(h) to origin(next(h)) along face(h)
+  std::size_t n_half_edges() const { return he_vertex_.size(); }
+  unsigned origin(unsigned h) const { return he_vertex_[h]; }
+  unsigned twin(unsigned h) const { return he_twin_[h]; }
+  unsigned next(unsigned h) const { return h % 3 == 2 ? h - 2 : h + 1; }
+  unsigned prev(unsigned h) const { return h % 3 == 0 ? h + 2 : h - 1; }
+  unsigned face(unsigned h) const { return h / 3; }
+
+  //: true if p is inside the hull or within tol of its boundary
+  bool contains(vgl_point_3d<T> const& p, T tol = T(0)) const;
+
+  //: contains() for a batch of points
+  std::vector<bool> contains(std::vector<vgl_point_3d<T> > const& pts, T tol = T(0)) const;
+
+  //: the enclosed volume
+  double volume() const;
+
+  //: the surface area
+  double area() const;
+
+  //: the bounding box of the hull, which is that of the input points
+  vgl_box_3d<T> bounding_box() const { return box_; }
+
+ private:
+  std::vector<vgl_point_3d<T> > vertices_;
+  std::vector<unsigned> input_index_;
+  std::vector<unsigned> he_vertex_;
+  std::vector<unsigned> he_twin_;
+  //: unit outward normal and offset of each face, as separate arrays for contains()
+  std::vector<double> nx_, ny_, nz_, d_;
+  vgl_box_3d<T> box_;
+
+  //: Quickhull of the points P[idx[i]].
+  //  On return idx holds the indices in P of the hull vertices, tri three positions in idx
+  //  per face, and adj, if given, the face across each of the three edges.
+  static void quickhull(std::vector<vgl_point_3d<T> > const& P, std::vector<unsigned>& idx,
+                        std::vector<unsigned>& tri, std::vector<unsigned>* adj = nullptr);
+};
+
+template <class T>
+void vgl_convex_hull_3d<T>::quickhull(std::vector<vgl_point_3d<T> > const& P, std::vector<unsigned>& idx,
+                                      std::vector<unsigned>& tri, std::vector<unsigned>* adj)
+{
+  tri.clear();
+  if (adj) adj->clear();
+  const std::size_t n = idx.size();
+  if (n < 4) { idx.clear(); return; }
+  // local copy of the coordinates in double, in the order of idx and interleaved,
+  // since the distance tests read all three coordinates of scattered points
+  std::vector<double> C(3 * n);
+  double mx = 0, my = 0, mz = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    C[3 * i] = P[idx[i]].x(); C[3 * i + 1] = P[idx[i]].y(); C[3 * i + 2] = P[idx[i]].z();
+    mx = std::max(mx, std::fabs(C[3 * i])); my = std::max(my, std::fabs(C[3 * i + 1])); mz = std::max(mz, std::fabs(C[3 * i + 2]));
+  }
+  auto X = [&C](std::size_t i) { return C[3 * i]; };
+  auto Y = [&C](std::size_t i) { return C[3 * i + 1]; };
+  auto Z = [&C](std::size_t i) { return C[3 * i + 2]; };
+  // the rounding tolerance of a point-plane distance, as in qhull
+  const double eps = 3 * std::numeric_limits<double>::epsilon() * (mx + my + mz);
+
+  struct face
+  {
+    unsigned v[3];
+    unsigned nb[3];              // neighbour across edge v[k] -> v[k+1]
+    double n[3], d;
+    std::vector<unsigned> outside;
+    unsigned far;
+    double far_d;
+    unsigned mark;
+    bool alive;
+  };
+  std::vector<face> F;
+  std::vector<unsigned> free_faces;
+  // faces whose conflict lists have become non-empty; may hold stale entries
+  std::vector<unsigned> pending;
+  auto dist = [&](face const& f, unsigned p) { return f.n[0] * X(p) + f.n[1] * Y(p) + f.n[2] * Z(p) + f.d; };
+  auto make_face = [&](unsigned a, unsigned b, unsigned c) {
+    face f = face();
+    f.v[0] = a; f.v[1] = b; f.v[2] = c;
+    const double ux = X(b) - X(a), uy = Y(b) - Y(a), uz = Z(b) - Z(a);
+    const double vx = X(c) - X(a), vy = Y(c) - Y(a), vz = Z(c) - Z(a);
+    double nx = uy * vz - uz * vy, ny = uz * vx - ux * vz, nz = ux * vy - uy * vx;
+    const double len = std::sqrt(nx * nx + ny * ny + nz * nz);
+    if (len > 0) { nx /= len; ny /= len; nz /= len; }
+    f.n[0] = nx; f.n[1] = ny; f.n[2] = nz;
+    f.d = -(nx * X(a) + ny * Y(a) + nz * Z(a));
+    f.far_d = eps; f.mark = 0; f.alive = true;
+    // reuse the slot of a removed face, keeping the capacity of its conflict list
+    if (!free_faces.empty()) {
+      const unsigned id = free_faces.back();
+      free_faces.pop_back();
+      f.outside.swap(F[id].outside);
+      F[id] = std::move(f);
+      return id;
+    }
+    F.push_back(std::move(f));
+    return unsigned(F.size() - 1);
+  };
+  auto add_outside = [&](unsigned fid, unsigned p, double dp) {
+    face& f = F[fid];
+    if (f.outside.empty()) pending.push_back(fid);
+    f.outside.push_back(p);
+    if (dp > f.far_d) { f.far_d = dp; f.far = p; }
+  };
+
+  // initial tetrahedron: the most distant pair of axis extremes, then the points
+  // farthest from their line and from the plane of the three
+  unsigned ext[6] = { 0, 0, 0, 0, 0, 0 };
+  for (unsigned i = 1; i < n; ++i) {
+    if (X(i) < X(ext[0])) ext[0] = i;
+    if (X(i) > X(ext[1])) ext[1] = i;
+    if (Y(i) < Y(ext[2])) ext[2] = i;
+    if (Y(i) > Y(ext[3])) ext[3] = i;
+    if (Z(i) < Z(ext[4])) ext[4] = i;
+    if (Z(i) > Z(ext[5])) ext[5] = i;
+  }
+  auto d2 = [&](unsigned a, unsigned b) {
+    return (X(a) - X(b)) * (X(a) - X(b)) + (Y(a) - Y(b)) * (Y(a) - Y(b)) + (Z(a) - Z(b)) * (Z(a) - Z(b));
+  };
+  unsigned i0 = ext[0], i1 = ext[1];
+  for (unsigned a = 0; a < 6; ++a)
+    for (unsigned b = a + 1; b < 6; ++b)
+      if (d2(ext[a], ext[b]) > d2(i0, i1)) { i0 = ext[a]; i1 = ext[b]; }
+  if (std::sqrt(d2(i0, i1)) <= eps) { idx.clear(); return; }
+  unsigned i2 = i0;
+  double best = 0;
+  {
+    const double ux = X(i1) - X(i0), uy = Y(i1) - Y(i0), uz = Z(i1) - Z(i0);
+    for (unsigned i = 0; i < n; ++i) {
+      const double wx = X(i) - X(i0), wy = Y(i) - Y(i0), wz = Z(i) - Z(i0);
+      const double cx = uy * wz - uz * wy, cy = uz * wx - ux * wz, cz = ux * wy - uy * wx;
+      const double c = cx * cx + cy * cy + cz * cz;
+      if (c > best) { best = c; i2 = i; }
+    }
+    if (std::sqrt(best / d2(i0, i1)) <= eps) { idx.clear(); return; }
+  }
+  unsigned f0 = make_face(i0, i1, i2);
+  unsigned i3 = i0;
+  best = 0;
+  for (unsigned i = 0; i < n; ++i) {
+    const double di = std::fabs(dist(F[f0], i));
+    if (di > best) { best = di; i3 = i; }
+  }
+  if (best <= eps) { idx.clear(); return; }
+  if (dist(F[f0], i3) > 0) {
+    // orient the base away from the apex
+    F.clear();
+    std::swap(i1, i2);
+    f0 = make_face(i0, i1, i2);
+  }
+  make_face(i0, i3, i1);
+  make_face(i1, i3, i2);
+  make_face(i2, i3, i0);
+  // neighbours of the tetrahedron: the face holding the reversed edge
+  for (unsigned f = 0; f < 4; ++f)
+    for (unsigned k = 0; k < 3; ++k)
+      for (unsigned g = 0; g < 4; ++g)
+        for (unsigned j = 0; j < 3; ++j)
+          if (F[g].v[j] == F[f].v[(k + 1) % 3] && F[g].v[(j + 1) % 3] == F[f].v[k])
+            F[f].nb[k] = g;
+
+  // initial conflict lists: each point goes to the first face it is above
+  for (unsigned i = 0; i < n; ++i) {
+    if (i == i0 || i == i1 || i == i2 || i == i3) continue;
+    for (unsigned f = 0; f < 4; ++f) {
+      const double di = dist(F[f], i);
+      if (di > eps) { add_outside(f, i, di); break; }
+    }
+  }
+
+  // first new face of each horizon edge's start and end vertex, for linking the cone
+  std::vector<unsigned> start_of(n), end_of(n);
+  std::vector<unsigned> stack, visible, created, pts;
+  std::vector<unsigned> horizon;   // triples a, b, neighbour face behind edge a -> b
+  unsigned iteration = 0;
+  while (!pending.empty()) {
+    const unsigned fi = pending.back();
+    pending.pop_back();
+    if (!F[fi].alive || F[fi].outside.empty()) continue;
+    const unsigned eye = F[fi].far;
+    ++iteration;
+
+    // faces visible from eye, by a search from fi; the edges to hidden faces form the horizon
+    visible.clear(); horizon.clear(); stack.clear();
+    F[fi].mark = iteration;
+    stack.push_back(fi);
+    while (!stack.empty()) {
+      const unsigned g = stack.back();
+      stack.pop_back();
+      visible.push_back(g);
+      for (unsigned k = 0; k < 3; ++k) {
+        const unsigned h = F[g].nb[k];
+        if (F[h].mark == iteration) continue;
+        if (dist(F[h], eye) > eps) {
+          F[h].mark = iteration;
+          stack.push_back(h);
+        }
+        else {
+          horizon.push_back(F[g].v[k]);
+          horizon.push_back(F[g].v[(k + 1) % 3]);
+          horizon.push_back(h);
+        }
+      }
+    }
+
+    // cone the horizon to eye
+    created.clear();
+    for (std::size_t e = 0; e < horizon.size(); e += 3) {
+      const unsigned a = horizon[e], b = horizon[e + 1], h = horizon[e + 2];
+      const unsigned nf = make_face(a, b, eye);
+      created.push_back(nf);
+      F[nf].nb[0] = h;
+      for (unsigned k = 0; k < 3; ++k)
+        if (F[h].v[k] == b && F[h].v[(k + 1) % 3] == a) F[h].nb[k] = nf;
+      start_of[a] = nf;
+      end_of[b] = nf;
+    }
+    for (unsigned nf : created) {
+      F[nf].nb[1] = start_of[F[nf].v[1]];   // edge b -> eye is shared with the face starting at b
+      F[nf].nb[2] = end_of[F[nf].v[0]];     // edge eye -> a with the face ending at a
+    }
+
+    // hand the conflict points of the removed faces to the new ones
+    for (unsigned g : visible) {
+      pts.clear();
+      pts.swap(F[g].outside);
+      F[g].alive = false;
+      for (unsigned p : pts) {
+        if (p == eye) continue;
+        for (unsigned nf : created) {
+          const double dp = dist(F[nf], p);
+          if (dp > eps) { add_outside(nf, p, dp); break; }
+        }
+      }
+      // give the slot an empty list with the capacity of the old one
+      pts.clear();
+      pts.swap(F[g].outside);
+      free_faces.push_back(g);
+    }
+  }
+
+  // compact: renumber the hull vertices in order of first use
+  std::vector<unsigned> remap(n, unsigned(-1));
+  std::vector<unsigned> hull_idx;
+  std::vector<unsigned> face_id(F.size(), unsigned(-1));
+  unsigned nfaces = 0;
+  for (std::size_t f = 0; f < F.size(); ++f)
+    if (F[f].alive) face_id[f] = nfaces++;
+  tri.reserve(3 * nfaces);
+  if (adj) adj->reserve(3 * nfaces);
+  for (std::size_t f = 0; f < F.size(); ++f) {
+    if (!F[f].alive) continue;
+    for (unsigned k = 0; k < 3; ++k) {
+      unsigned& r = remap[F[f].v[k]];
+      if (r == unsigned(-1)) { r = unsigned(hull_idx.size()); hull_idx.push_back(idx[F[f].v[k]]); }
+      tri.push_back(r);
+      if (adj) adj->push_back(face_id[F[f].nb[k]]);
+    }
+  }
+  idx.swap(hull_idx);
+}
+
+template <class T>
+vgl_convex_hull_3d<T>::vgl_convex_hull_3d(std::vector<vgl_point_3d<T> > const& pts, unsigned nthreads)
+{
+  for (std::size_t i = 0; i < pts.size(); ++i)
+    box_.add(pts[i]);
+  const std::size_t n = pts.size();
+  // below this size a thread costs more than it saves
+  const std::size_t min_chunk = 1 << 16;
+  nthreads = vgl_parallel_detail::thread_count(nthreads, n, min_chunk);
+
+  std::vector<unsigned> idx, tri, adj;
+  if (nthreads > 1) {
+    // the hull of the union of the partial hull vertices is the hull of all points
+    std::vector<std::vector<unsigned> > parts(nthreads);
+    vgl_parallel_detail::parallel_for(n, nthreads, [&pts, &parts](unsigned t, std::size_t b, std::size_t e) {
+      std::vector<unsigned> part_tri;
+      for (std::size_t i = b; i < e; ++i) parts[t].push_back(unsigned(i));
+      std::vector<unsigned> all(parts[t]);
+      quickhull(pts, parts[t], part_tri);
+      // a degenerate share keeps all its points
+      if (parts[t].empty()) parts[t].swap(all);
+    });
+    for (unsigned t = 0; t < nthreads; ++t)
+      idx.insert(idx.end(), parts[t].begin(), parts[t].end());
+  }
+  else {
+    idx.resize(n);
+    for (std::size_t i = 0; i < n; ++i) idx[i] = unsigned(i);
+  }
+  quickhull(pts, idx, tri, &adj);
+  if (tri.empty()) return;
+
+  input_index_.swap(idx);
+  vertices_.reserve(input_index_.size());
+  for (unsigned v : input_index_) vertices_.push_back(pts[v]);
+  he_vertex_.swap(tri);
+
+  // twin of half-edge k of face f: the half-edge of the adjacent face that starts where it ends
+  const std::size_t nh = he_vertex_.size();
+  he_twin_.resize(nh);
+  for (unsigned h = 0; h < nh; ++h) {
+    const unsigned g = adj[h], end = he_vertex_[next(h)];
+    he_twin_[h] = he_vertex_[3 * g] == end ? 3 * g : he_vertex_[3 * g + 1] == end ? 3 * g + 1 : 3 * g + 2;
+  }
+
+  // face planes
+  const std::size_t nf = n_faces();
+  nx_.resize(nf); ny_.resize(nf); nz_.resize(nf); d_.resize(nf);
+  for (std::size_t f = 0; f < nf; ++f) {
+    vgl_point_3d<T> const& a = vertices_[he_vertex_[3 * f]];
+    vgl_point_3d<T> const& b = vertices_[he_vertex_[3 * f + 1]];
+    vgl_point_3d<T> const& c = vertices_[he_vertex_[3 * f + 2]];
+    const double ux = double(b.x()) - a.x(), uy = double(b.y()) - a.y(), uz = double(b.z()) - a.z();
+    const double vx = double(c.x()) - a.x(), vy = double(c.y()) - a.y(), vz = double(c.z()) - a.z();
+    double x = uy * vz - uz * vy, y = uz * vx - ux * vz, z = ux * vy - uy * vx;
+    const double len = std::sqrt(x * x + y * y + z * z);
+    if (len > 0) { x /= len; y /= len; z /= len; }
+    nx_[f] = x; ny_[f] = y; nz_[f] = z;
+    d_[f] = -(x * a.x() + y * a.y() + z * a.z());
+  }
+}
+
+template <class T>
+bool vgl_convex_hull_3d<T>::contains(vgl_point_3d<T> const& p, T tol) const
+{
+  if (!is_valid())
+    return false;
+  const double x = p.x(), y = p.y(), z = p.z(), t = tol;
+  if (x < box_.min_x() - t || x > box_.max_x() + t || y < box_.min_y() - t || y > box_.max_y() + t ||
+      z < box_.min_z() - t || z > box_.max_z() + t)
+    return false;
+  // blocks of faces in a vectorisable loop, leaving at the first block with p outside
+  const std::size_t nf = nx_.size(), block = 32;
+  for (std::size_t b = 0; b < nf; b += block) {
+    const std::size_t e = std::min(nf, b + block);
+    double dmax = -std::numeric_limits<double>::max();
+    for (std::size_t f = b; f < e; ++f)
+      dmax = std::max(dmax, nx_[f] * x + ny_[f] * y + nz_[f] * z + d_[f]);
+    if (dmax > t)
+      return false;
+  }
+  return true;
+}
+
+template <class T>
+std::vector<bool> vgl_convex_hull_3d<T>::contains(std::vector<vgl_point_3d<T> > const& pts, T tol) const
+{
+  std::vector<bool> in(pts.size());
+  for (std::size_t i = 0; i < pts.size(); ++i)
+    in[i] = contains(pts[i], tol);
+  return in;
+}
+
+template <class T>
+double vgl_convex_hull_3d<T>::volume() const
+{
+  if (!is_valid())
+    return 0.0;
+  // tetrahedra from the first vertex to every face
+  vgl_point_3d<T> const& o = vertices_[0];
+  double v = 0.0;
+  for (std::size_t f = 0; f < n_faces(); ++f) {
+    vgl_point_3d<T> const& a = vertices_[he_vertex_[3 * f]];
+    vgl_point_3d<T> const& b = vertices_[he_vertex_[3 * f + 1]];
+    vgl_point_3d<T> const& c = vertices_[he_vertex_[3 * f + 2]];
+    const double ax = double(a.x()) - o.x(), ay = double(a.y()) - o.y(), az = double(a.z()) - o.z();
+    const double bx = double(b.x()) - o.x(), by = double(b.y()) - o.y(), bz = double(b.z()) - o.z();
+    const double cx = double(c.x()) - o.x(), cy = double(c.y()) - o.y(), cz = double(c.z()) - o.z();
+    v += ax * (by * cz - bz * cy) + ay * (bz * cx - bx * cz) + az * (bx * cy - by * cx);
+  }
+  return v / 6.0;
+}
+
+template <class T>
+double vgl_convex_hull_3d<T>::area() const
+{
+  double s = 0.0;
+  for (std::size_t f = 0; f < n_faces(); ++f) {
+    vgl_point_3d<T> const& a = vertices_[he_vertex_[3 * f]];
+    vgl_point_3d<T> const& b = vertices_[he_vertex_[3 * f + 1]];
+    vgl_point_3d<T> const& c = vertices_[he_vertex_[3 * f + 2]];
+    const double ux = double(b.x()) - a.x(), uy = double(b.y()) - a.y(), uz = double(b.z()) - a.z();
+    const double vx = double(c.x()) - a.x(), vy = double(c.y()) - a.y(), vz = double(c.z()) - a.z();
+    const double x = uy * vz - uz * vy, y = uz * vx - ux * vz, z = ux * vy - uy * vx;
+    s += std::sqrt(x * x + y * y + z * z);
+  }
+  return s / 2.0;
+}
+
+#endif // vgl_convex_hull_3d_h_
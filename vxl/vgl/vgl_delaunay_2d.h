@@ -0,0 +1,809 @@
+// This is core/vgl/vgl_delaunay_2d.h
+#ifndef vgl_delaunay_2d_h_
+#define vgl_delaunay_2d_h_
+//:
+// \file
+// \brief Incremental (constrained) Delaunay triangulation of 2-d points, and its Voronoi dual
+//
+//  Points are inserted by Bowyer-Watson: the triangle containing the new
+//  point is found by a walk from the last triangle created, the triangles
+//  whose circumcircles contain the point are removed, and the hole is
+//  filled with a fan of triangles to the point.  A batch of points is
+//  inserted in biased randomised order (BRIO, Amenta, Choi & Rote 2003):
+//  the points are split at random into rounds of doubling size, each
+//  sorted along a Hilbert curve, so that the walks are short and the
+//  expected work stays linear.  Internally the vertices are numbered in
+//  that order, so that the coordinates read by one insertion are close in
+//  memory.  All decisions use the exact predicates of
+//  vgl_predicates.h, so any input, however degenerate, gives a valid
+//  triangulation.  Repeated points are inserted once; the others are
+//  recorded as duplicates of it.
+//
+//  The triangles are kept in two arrays: three vertex indices per triangle,
+//  counterclockwise, and for each of its edges the index 3u+j of the same
+//  edge in the triangle u across it.  Edge k of a triangle is the one
+//  opposite its vertex k.  The outside of the convex hull is covered by
+//  triangles with a vertex at infinity, one per hull edge, so that points
+//  outside the hull need no special case; they are not reported.
+//
+//  insert_constraint() forces an edge between two vertices into the
+//  triangulation, which becomes the constrained Delaunay triangulation:
+//  the edges crossing it are flipped away (Sloan 1993) and the Delaunay
+//  property is restored by flips that do not cross constrained edges.
+//  Points inserted later do not remove constrained edges, and a point on
+//  one splits it.  Constrained edges may share end points or be split by
+//  vertices on them, but must not cross; insert_polygon() inserts the
+//  vertices and boundary edges of a vgl_polygon.
+//
+//  voronoi() gives the dual Voronoi diagram: the circumcentres of the
+//  triangles and, for each vertex, its cell as the counterclockwise list of
+//  those circumcentres.  With constraints it is the dual of the constrained
+//  triangulation, not a Voronoi diagram.
+//
+// \verbatim
+//  Modifications
+// \endverbatim
+
+#include <vector>
+#include <deque>
+#include <utility>
+#include <algorithm>
+#include <random>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <vgl/vgl_point_2d.h>
+#include <vgl/vgl_polygon.h>
+#include <vgl/vgl_predicates.h>
+
+template <class T>
+class vgl_delaunay_2d
+{
+ public:
+  //: The Voronoi diagram of the vertices
+  //  The cell of vertex v is the polygon of vertices[cells[i]] for i in
+  //  [cell_start[v], cell_start[v+1]), counterclockwise.  The cells of
+  //  vertices on the convex hull are not bounded: they extend to infinity
+  //  from their first and last vertex, perpendicular to the two hull edges at v.
+  //  Duplicates and vertices not in the triangulation have empty cells.
+  struct voronoi_diagram
+  {
+    std::vector<vgl_point_2d<T> > vertices; //!< circumcentres, in the order of triangles()
+    std::vector<unsigned> cell_start;
+    std::vector<unsigned> cells;
+    std::vector<unsigned char> bounded;     //!< 0 for the open cells of hull vertices
+  };
+
+  vgl_delaunay_2d() = default;
+  //: the Delaunay triangulation of pts
+  explicit vgl_delaunay_2d(std::vector<vgl_point_2d<T> > const& pts) { insert(pts); }
+
+  //: Insert the points pts, in biased randomised order.
+  //  They become vertices num_vertices(), num_vertices()+1, ... in the order of pts.
+  void insert(std::vector<vgl_point_2d<T> > const& pts);
+
+  //: Insert the point p; returns its vertex index.
+  unsigned insert(vgl_point_2d<T> const& p);
+
+  //: Force the edge between vertices a and b into the triangulation.
+  //  Returns false if it would cross a constrained edge; no part of it is then
+  //  constrained, not even the parts up to a vertex on it before the crossing.
+  bool insert_constraint(unsigned a, unsigned b);
+
+  //: Insert the vertices of poly and constrain its boundary edges.
+  //  Returns false if some edge crossed an earlier constrained edge, and was left out.
+  bool insert_polygon(vgl_polygon<T> const& poly);
+
+  std::size_t num_vertices() const { return rep_.size(); }
+  vgl_point_2d<T> vertex(unsigned v) const { return vgl_point_2d<T>(T(X(int_[v])), T(Y(int_[v]))); }
+  //: the vertex that v repeats, or v itself
+  unsigned representative(unsigned v) const { return rep_[v]; }
+  //: false for duplicates and while all points are collinear
+  bool in_triangulation(unsigned v) const { return vtri_[int_[v]] != none(); }
+
+  //: number of (finite) triangles
+  std::size_t num_triangles() const { return n_finite_; }
+
+  //: The triangles as three counterclockwise vertex indices each.
+  //  If given, adjacency receives for each edge k of triangle t, opposite
+  //  vertex k, the triangle across it or -1 on the hull, and constrained
+  //  whether the edge is constrained.
+  void triangles(std::vector<unsigned>& tri, std::vector<int>* adjacency = nullptr,
+                 std::vector<unsigned char>* constrained = nullptr) const;
+
+  //: The vertices of the triangle containing p, false if p is outside the convex hull.
+  bool locate(vgl_point_2d<T> const& p, unsigned& a, unsigned& b, unsigned& c) const;
+
+  //: The vertex nearest to p, -1 if there is none.
+  //  Found by a greedy walk on the triangulation, exact without constraints.
+  int nearest_vertex(vgl_point_2d<T> const& p) const;
+
+  //: the Voronoi dual of the triangulation
+  void voronoi(voronoi_diagram& vd) const;
+
+ private:
+  static unsigned none() { return unsigned(-1); }
+  static unsigned infinite() { return unsigned(-2); }
+
+  double X(unsigned v) const { return xy_[2 * v]; }
+  double Y(unsigned v) const { return xy_[2 * v + 1]; }
+  bool is_ghost(unsigned t) const
+  { return tri_[3 * t] == infinite() || tri_[3 * t + 1] == infinite() || tri_[3 * t + 2] == infinite(); }
+  bool is_free(unsigned t) const { return tri_[3 * t] == none(); }
+  double orient(unsigned a, unsigned b, double px, double py) const
+  { return vgl_orient_2d(X(a), Y(a), X(b), Y(b), px, py); }
+  //: true if (px, py), collinear with a and b, lies strictly between them
+  bool between(unsigned a, unsigned b, double px, double py) const;
+  //: true if the circumcircle of t contains (px, py); for an infinite t, its open half plane and hull edge
+  bool conflict(unsigned t, double px, double py) const;
+  //: a triangle containing (px, py), or in conflict with it if it is outside the hull
+  unsigned walk(double px, double py, unsigned start) const;
+
+  unsigned new_triangle(unsigned a, unsigned b, unsigned c);
+  //: make the first triangle from three non-collinear pending vertices and insert the others; false if all are collinear
+  bool start();
+  //: the biased randomised insertion order of pts
+  void brio_order(std::vector<vgl_point_2d<T> > const& pts, std::vector<unsigned>& order);
+  void drop_pending_duplicates();
+  //: insert vertex v into the triangulation; returns the vertex it duplicates, or v
+  unsigned insert_vertex(unsigned v);
+  //: the half-edge from a to b, none() if there is none
+  unsigned find_edge(unsigned a, unsigned b) const;
+  void set_constrained(unsigned h)
+  {
+    constrained_[h] = 1;
+    constrained_[twin_[h]] = 1;
+  }
+  //: flip the edge h, the diagonal of a convex quadrilateral
+  void flip(unsigned h);
+  //: constrain the edge from a to b, both on the segment, whose crossing edges are crossing
+  void force_edge(unsigned a, unsigned b, std::deque<std::pair<unsigned, unsigned> >& crossing);
+  //: Lawson flips from the edges (as vertex pairs) in edges, until all are locally Delaunay; empties edges
+  void legalize(std::vector<std::pair<unsigned, unsigned> >& edges);
+  unsigned& fan_slot(unsigned v) { return v == infinite() ? fan_inf_ : fan_[v]; }
+
+  // the vertices, in the internal numbering unless noted
+  std::vector<double> xy_;              //!< interleaved coordinates
+  std::vector<unsigned> ext_;           //!< the number of each vertex given to the user
+  std::vector<unsigned> int_;           //!< the internal number of each user vertex
+  std::vector<unsigned> rep_;           //!< the user vertex each user vertex duplicates, or itself
+  std::vector<unsigned> vtri_;          //!< a triangle at each vertex, none() if not in the triangulation
+  std::vector<unsigned> tri_;           //!< three vertices per triangle, counterclockwise; none() if free
+  std::vector<unsigned> twin_;          //!< the same edge in the triangle across
+  std::vector<unsigned char> constrained_;
+  std::vector<unsigned> free_;          //!< free triangle slots
+  std::vector<unsigned> pending_;       //!< vertices waiting for three non-collinear points
+  std::size_t n_finite_ = 0;
+  unsigned last_ = 0;                   //!< the walks start here
+  std::mt19937 rng_;
+
+  // scratch space of insert_vertex()
+  std::vector<unsigned> mark_;
+  unsigned stamp_ = 0;
+  std::vector<unsigned> stack_, cavity_, fan_;
+  unsigned fan_inf_ = 0;
+  struct boundary_edge { unsigned a, b, outer; unsigned char constrained; };
+  std::vector<boundary_edge> boundary_;
+};
+
+// =================  methods  ===================
+
+template <class T>
+bool vgl_delaunay_2d<T>::between(unsigned a, unsigned b, double px, double py) const
+{
+  if (X(a) != X(b))
+    return (X(a) < px && px < X(b)) || (X(b) < px && px < X(a));
+  return (Y(a) < py && py < Y(b)) || (Y(b) < py && py < Y(a));
+}
+
+template <class T>
+bool vgl_delaunay_2d<T>::conflict(unsigned t, double px, double py) const
+{
+  unsigned const* v = &tri_[3 * t];
+  for (unsigned k = 0; k < 3; ++k)
+    if (v[k] == infinite()) {
+      const unsigned a = v[(k + 1) % 3], b = v[(k + 2) % 3];
+      const double o = orient(a, b, px, py);
+      return o > 0 || (o == 0 && between(a, b, px, py));
+    }
+  return vgl_incircle(X(v[0]), Y(v[0]), X(v[1]), Y(v[1]), X(v[2]), Y(v[2]), px, py) > 0;
+}
+
+template <class T>
+unsigned vgl_delaunay_2d<T>::walk(double px, double py, unsigned t) const
+{
+  unsigned prev = none();
+  // a cheap random choice of the first edge tested, which keeps the walk from cycling
+  std::uint32_t r = 2463534242u;
+  for (;;) {
+    unsigned const* v = &tri_[3 * t];
+    unsigned g = 3;
+    for (unsigned k = 0; k < 3; ++k)
+      if (v[k] == infinite()) g = k;
+    if (g < 3) {
+      const unsigned a = v[(g + 1) % 3], b = v[(g + 2) % 3];
+      const double o = orient(a, b, px, py);
+      if (o > 0)
+        return t;
+      prev = t;
+      if (o < 0 || (px == X(a) && py == Y(a)) || (px == X(b) && py == Y(b))) {
+        t = twin_[3 * t + g] / 3; // into the hull
+        continue;
+      }
+      if (between(a, b, px, py))
+        return t;
+      // on the line of the hull edge, beyond b or beyond a: along the hull
+      const bool beyond_b = (px - X(b)) * (X(b) - X(a)) + (py - Y(b)) * (Y(b) - Y(a)) > 0;
+      t = twin_[3 * t + (beyond_b ? (g + 1) % 3 : (g + 2) % 3)] / 3;
+      continue;
+    }
+    r ^= r << 13; r ^= r >> 17; r ^= r << 5;
+    const unsigned k0 = r % 3;
+    unsigned next = none();
+    for (unsigned i = 0; i < 3; ++i) {
+      const unsigned k = (k0 + i) % 3;
+      const unsigned u = twin_[3 * t + k] / 3;
+      if (u == prev)
+        continue;
+      if (orient(v[(k + 1) % 3], v[(k + 2) % 3], px, py) < 0) {
+        next = u;
+        break;
+      }
+    }
+    if (next == none())
+      return t;
+    prev = t;
+    t = next;
+  }
+}
+
+template <class T>
+unsigned vgl_delaunay_2d<T>::new_triangle(unsigned a, unsigned b, unsigned c)
+{
+  unsigned t;
+  if (!free_.empty()) {
+    t = free_.back();
+    free_.pop_back();
+  }
+  else {
+    t = unsigned(tri_.size() / 3);
+    tri_.push_back(a); tri_.push_back(b); tri_.push_back(c);
+    twin_.push_back(none()); twin_.push_back(none()); twin_.push_back(none());
+    constrained_.push_back(0); constrained_.push_back(0); constrained_.push_back(0);
+    mark_.push_back(0);
+  }
+  tri_[3 * t] = a; tri_[3 * t + 1] = b; tri_[3 * t + 2] = c;
+  constrained_[3 * t] = constrained_[3 * t + 1] = constrained_[3 * t + 2] = 0;
+  if (a != infinite()) vtri_[a] = t;
+  if (b != infinite()) vtri_[b] = t;
+  if (c != infinite()) vtri_[c] = t;
+  if (a != infinite() && b != infinite() && c != infinite()) ++n_finite_;
+  return t;
+}
+
+template <class T>
+bool vgl_delaunay_2d<T>::start()
+{
+  if (pending_.size() < 3)
+    return false;
+  const unsigned a = pending_[0];
+  unsigned b = none(), c = none();
+  for (unsigned v : pending_)
+    if (b == none()) {
+      if (X(v) != X(a) || Y(v) != Y(a)) b = v;
+    }
+    else if (orient(a, b, X(v), Y(v)) != 0) {
+      c = v;
+      break;
+    }
+  if (c == none())
+    return false;
+  if (orient(a, b, X(c), Y(c)) < 0)
+    std::swap(b, c);
+  const unsigned t = new_triangle(a, b, c);
+  unsigned g[3];
+  for (unsigned k = 0; k < 3; ++k) {
+    // the infinite triangle across edge k, from v[k+1] to v[k+2], has it the other way
+    g[k] = new_triangle(tri_[3 * t + (k + 2) % 3], tri_[3 * t + (k + 1) % 3], infinite());
+    twin_[3 * t + k] = 3 * g[k] + 2;
+    twin_[3 * g[k] + 2] = 3 * t + k;
+  }
+  // (x, y, inf) meets (y, z, inf) along (y, inf): its edge 0 is their edge 1
+  for (unsigned k = 0; k < 3; ++k)
+    for (unsigned j = 0; j < 3; ++j)
+      if (tri_[3 * g[j]] == tri_[3 * g[k] + 1]) {
+        twin_[3 * g[k]] = 3 * g[j] + 1;
+        twin_[3 * g[j] + 1] = 3 * g[k];
+      }
+  last_ = t;
+  std::vector<unsigned> rest;
+  rest.swap(pending_);
+  for (unsigned v : rest)
+    if (v != a && v != b && v != c)
+      insert_vertex(v);
+  return true;
+}
+
+template <class T>
+void vgl_delaunay_2d<T>::brio_order(std::vector<vgl_point_2d<T> > const& pts, std::vector<unsigned>& order)
+{
+  const std::size_t n = pts.size();
+  order.resize(n);
+  if (n == 0)
+    return;
+  // Hilbert keys on a 2^16 grid over the bounding box
+  double lo[2] = { double(pts[0].x()), double(pts[0].y()) }, hi[2] = { lo[0], lo[1] };
+  for (vgl_point_2d<T> const& p : pts) {
+    lo[0] = std::min(lo[0], double(p.x())); hi[0] = std::max(hi[0], double(p.x()));
+    lo[1] = std::min(lo[1], double(p.y())); hi[1] = std::max(hi[1], double(p.y()));
+  }
+  const double side = std::max(hi[0] - lo[0], hi[1] - lo[1]);
+  const double scale = side > 0 ? 65535.0 / side : 0.0;
+  // each point goes to round r < 32 with probability 2^(r-32), the last holding half of them;
+  // the key is the round, then the Hilbert index on 13.5 bits per axis
+  std::vector<std::uint64_t> key(n), tmp(n); // the key, then the point
+  for (std::size_t i = 0; i < n; ++i) {
+    std::uint32_t x = std::uint32_t((double(pts[i].x()) - lo[0]) * scale);
+    std::uint32_t y = std::uint32_t((double(pts[i].y()) - lo[1]) * scale);
+    std::uint32_t d = 0;
+    for (int bit = 15; bit >= 0; --bit) {
+      // the quadrant, then reflect and transpose without branches, which the random bits defeat
+      const std::uint32_t rx = (x >> bit) & 1, ry = (y >> bit) & 1;
+      d = (d << 2) | ((3 * rx) ^ ry);
+      const std::uint32_t flip = (0u - (rx & (ry ^ 1))) & 0xffffu, swap = (0u - (ry ^ 1)) & (x ^ y);
+      x ^= flip ^ swap;
+      y ^= flip ^ swap;
+    }
+    int round; // the highest bit of a random number
+    std::frexp(double(std::uint32_t(rng_()) | 1u), &round);
+    key[i] = (std::uint64_t((std::uint32_t(round - 1) << 27) | (d >> 5)) << 32) | i;
+  }
+  // radix sort on the key, 11 bits at a time
+  for (unsigned shift = 32; shift < 64; shift += 11) {
+    std::vector<std::size_t> count(2049, 0);
+    for (std::uint64_t k : key)
+      ++count[((k >> shift) & 2047) + 1];
+    for (unsigned b = 0; b < 2048; ++b)
+      count[b + 1] += count[b];
+    for (std::uint64_t k : key)
+      tmp[count[(k >> shift) & 2047]++] = k;
+    key.swap(tmp);
+  }
+  for (std::size_t i = 0; i < n; ++i)
+    order[i] = unsigned(key[i]);
+}
+
+template <class T>
+unsigned vgl_delaunay_2d<T>::insert_vertex(unsigned v)
+{
+  const double px = X(v), py = Y(v);
+  const unsigned t = walk(px, py, last_);
+  for (unsigned k = 0; k < 3; ++k) {
+    const unsigned w = tri_[3 * t + k];
+    if (w != infinite() && X(w) == px && Y(w) == py) {
+      if (ext_[v] < ext_[w]) {
+        // the first of the user vertices stays in the triangulation
+        std::swap(ext_[v], ext_[w]);
+        int_[ext_[v]] = v;
+        int_[ext_[w]] = w;
+      }
+      rep_[ext_[v]] = ext_[w];
+      return w;
+    }
+  }
+  if (fan_.size() < vtri_.size())
+    fan_.resize(vtri_.size());
+
+  // the cavity: the triangles in conflict with v reachable from t without crossing constrained edges
+  ++stamp_;
+  stack_.assign(1, t);
+  cavity_.clear();
+  boundary_.clear();
+  mark_[t] = stamp_;
+  unsigned split_a = none(), split_b = none();
+  while (!stack_.empty()) {
+    const unsigned c = stack_.back();
+    stack_.pop_back();
+    cavity_.push_back(c);
+    for (unsigned k = 0; k < 3; ++k) {
+      const unsigned h = 3 * c + k, u = twin_[h] / 3;
+      if (mark_[u] == stamp_)
+        continue;
+      const unsigned a = tri_[3 * c + (k + 1) % 3], b = tri_[3 * c + (k + 2) % 3];
+      bool in;
+      if (constrained_[h]) {
+        // a vertex on a constrained edge splits it
+        in = orient(a, b, px, py) == 0 && between(a, b, px, py);
+        if (in) { split_a = a; split_b = b; }
+      }
+      else
+        in = conflict(u, px, py);
+      if (in) {
+        mark_[u] = stamp_;
+        stack_.push_back(u);
+      }
+      else {
+        boundary_edge e = { a, b, twin_[h], constrained_[h] };
+        boundary_.push_back(e);
+      }
+    }
+  }
+  // fill it with the fan of triangles (a, b, v) over its boundary edges
+  for (unsigned c : cavity_) {
+    if (!is_ghost(c)) --n_finite_;
+    tri_[3 * c] = none();
+    free_.push_back(c);
+  }
+  unsigned first = none();
+  for (boundary_edge const& e : boundary_) {
+    const unsigned u = new_triangle(e.a, e.b, v);
+    twin_[3 * u + 2] = e.outer;
+    twin_[e.outer] = 3 * u + 2;
+    constrained_[3 * u + 2] = e.constrained;
+    fan_slot(e.a) = u;
+    if (first == none() && e.a != infinite() && e.b != infinite()) first = u;
+  }
+  // (a, b, v) meets (b, c, v) along (b, v): its edge 0 is their edge 1
+  for (boundary_edge const& e : boundary_) {
+    const unsigned u = fan_slot(e.a), w = fan_slot(e.b);
+    twin_[3 * u] = 3 * w + 1;
+    twin_[3 * w + 1] = 3 * u;
+    if (e.b == split_a || e.b == split_b)
+      set_constrained(3 * u);
+  }
+  vtri_[v] = first != none() ? first : fan_slot(boundary_[0].a);
+  last_ = vtri_[v];
+  return v;
+}
+
+template <class T>
+void vgl_delaunay_2d<T>::insert(std::vector<vgl_point_2d<T> > const& pts)
+{
+  const std::size_t n0 = rep_.size();
+  if (pts.size() > n0) {
+    // a batch at least doubling the size: about two triangles per vertex
+    const std::size_t n = n0 + pts.size();
+    xy_.reserve(2 * n); ext_.reserve(n); int_.reserve(n); rep_.reserve(n); vtri_.reserve(n); fan_.reserve(n);
+    tri_.reserve(6 * n + 12); twin_.reserve(6 * n + 12); constrained_.reserve(6 * n + 12); mark_.reserve(2 * n + 4);
+  }
+  std::vector<unsigned> order;
+  brio_order(pts, order);
+  int_.resize(n0 + pts.size());
+  for (unsigned i : order) {
+    int_[n0 + i] = unsigned(ext_.size());
+    ext_.push_back(unsigned(n0 + i));
+    xy_.push_back(double(pts[i].x()));
+    xy_.push_back(double(pts[i].y()));
+    vtri_.push_back(none());
+  }
+  for (std::size_t i = 0; i < pts.size(); ++i)
+    rep_.push_back(unsigned(n0 + i));
+  if (n_finite_ > 0) {
+    for (std::size_t v = n0; v < ext_.size(); ++v)
+      insert_vertex(unsigned(v));
+  }
+  else {
+    // no triangle yet: start one, or drop the duplicates among the collinear points
+    for (std::size_t v = n0; v < ext_.size(); ++v)
+      pending_.push_back(unsigned(v));
+    if (!start())
+      drop_pending_duplicates();
+  }
+  // a representative may have been replaced by an earlier copy of it
+  for (std::size_t e = n0; e < rep_.size(); ++e)
+    rep_[e] = rep_[rep_[e]];
+}
+
+template <class T>
+void vgl_delaunay_2d<T>::drop_pending_duplicates()
+{
+  std::sort(pending_.begin(), pending_.end(), [this](unsigned a, unsigned b) {
+    return X(a) < X(b) || (X(a) == X(b) && (Y(a) < Y(b) || (Y(a) == Y(b) && ext_[a] < ext_[b])));
+  });
+  std::vector<unsigned> unique;
+  for (unsigned v : pending_)
+    if (!unique.empty() && X(unique.back()) == X(v) && Y(unique.back()) == Y(v))
+      rep_[ext_[v]] = ext_[unique.back()];
+    else
+      unique.push_back(v);
+  pending_.swap(unique);
+}
+
+template <class T>
+unsigned vgl_delaunay_2d<T>::insert(vgl_point_2d<T> const& p)
+{
+  insert(std::vector<vgl_point_2d<T> >(1, p));
+  return rep_.back();
+}
+
+template <class T>
+unsigned vgl_delaunay_2d<T>::find_edge(unsigned a, unsigned b) const
+{
+  const unsigned t0 = vtri_[a];
+  if (t0 == none())
+    return none();
+  unsigned t = t0;
+  do {
+    unsigned i = 0;
+    while (tri_[3 * t + i] != a) ++i;
+    if (tri_[3 * t + (i + 1) % 3] == b)
+      return 3 * t + (i + 2) % 3;
+    t = twin_[3 * t + (i + 1) % 3] / 3; // counterclockwise about a
+  } while (t != t0);
+  return none();
+}
+
+template <class T>
+void vgl_delaunay_2d<T>::flip(unsigned h)
+{
+  // t = (p, a, b) and u = (q, b, a) become (p, a, q) and (q, b, p)
+  const unsigned t = h / 3, k = h % 3, o = twin_[h], u = o / 3, j = o % 3;
+  const unsigned p = tri_[h], a = tri_[3 * t + (k + 1) % 3], b = tri_[3 * t + (k + 2) % 3], q = tri_[o];
+  const unsigned bp = twin_[3 * t + (k + 1) % 3], pa = twin_[3 * t + (k + 2) % 3];
+  const unsigned aq = twin_[3 * u + (j + 1) % 3], qb = twin_[3 * u + (j + 2) % 3];
+  const unsigned char cbp = constrained_[3 * t + (k + 1) % 3], cpa = constrained_[3 * t + (k + 2) % 3];
+  const unsigned char caq = constrained_[3 * u + (j + 1) % 3], cqb = constrained_[3 * u + (j + 2) % 3];
+  tri_[3 * t] = p; tri_[3 * t + 1] = a; tri_[3 * t + 2] = q;
+  tri_[3 * u] = q; tri_[3 * u + 1] = b; tri_[3 * u + 2] = p;
+  const unsigned link[6][2] = { { 3 * t, aq }, { 3 * t + 1, 3 * u + 1 }, { 3 * t + 2, pa },
+                                { 3 * u, bp }, { 3 * u + 2, qb }, { 3 * u + 1, 3 * t + 1 } };
+  for (unsigned i = 0; i < 6; ++i) {
+    twin_[link[i][0]] = link[i][1];
+    twin_[link[i][1]] = link[i][0];
+  }
+  constrained_[3 * t] = caq; constrained_[3 * t + 1] = 0; constrained_[3 * t + 2] = cpa;
+  constrained_[3 * u] = cbp; constrained_[3 * u + 1] = 0; constrained_[3 * u + 2] = cqb;
+  vtri_[p] = vtri_[a] = t;
+  vtri_[q] = vtri_[b] = u;
+}
+
+template <class T>
+void vgl_delaunay_2d<T>::force_edge(unsigned a, unsigned b, std::deque<std::pair<unsigned, unsigned> >& crossing)
+{
+  // flip the crossing edges away
+  std::vector<std::pair<unsigned, unsigned> > created;
+  while (!crossing.empty()) {
+    const std::pair<unsigned, unsigned> e = crossing.front();
+    crossing.pop_front();
+    const unsigned h = find_edge(e.first, e.second);
+    const unsigned p = tri_[h], q = tri_[twin_[h]];
+    const double o1 = orient(p, q, X(e.first), Y(e.first)), o2 = orient(p, q, X(e.second), Y(e.second));
+    if (!((o1 > 0 && o2 < 0) || (o1 < 0 && o2 > 0))) {
+      crossing.push_back(e); // not convex yet
+      continue;
+    }
+    flip(h);
+    const double op = orient(a, b, X(p), Y(p)), oq = orient(a, b, X(q), Y(q));
+    if ((op > 0 && oq < 0) || (op < 0 && oq > 0))
+      crossing.push_back(std::make_pair(p, q));
+    else
+      created.push_back(std::make_pair(p, q));
+  }
+  set_constrained(find_edge(a, b));
+  // restore the Delaunay property, starting from the new edges
+  legalize(created);
+}
+
+template <class T>
+void vgl_delaunay_2d<T>::legalize(std::vector<std::pair<unsigned, unsigned> >& edges)
+{
+  while (!edges.empty()) {
+    const std::pair<unsigned, unsigned> e = edges.back();
+    edges.pop_back();
+    const unsigned h = find_edge(e.first, e.second);
+    if (h == none() || constrained_[h] || is_ghost(h / 3) || is_ghost(twin_[h] / 3))
+      continue;
+    unsigned const* v = &tri_[3 * (h / 3)];
+    const unsigned p = tri_[h], q = tri_[twin_[h]], s = v[(h + 1) % 3], r = v[(h + 2) % 3];
+    if (vgl_incircle(X(v[0]), Y(v[0]), X(v[1]), Y(v[1]), X(v[2]), Y(v[2]), X(q), Y(q)) > 0) {
+      flip(h);
+      edges.push_back(std::make_pair(p, s));
+      edges.push_back(std::make_pair(s, q));
+      edges.push_back(std::make_pair(q, r));
+      edges.push_back(std::make_pair(r, p));
+    }
+  }
+}
+
+template <class T>
+bool vgl_delaunay_2d<T>::insert_constraint(unsigned a, unsigned b)
+{
+  if (a >= rep_.size() || b >= rep_.size())
+    return false;
+  a = int_[rep_[a]];
+  b = int_[rep_[b]];
+  if (vtri_[a] == none() || vtri_[b] == none())
+    return false;
+  std::deque<std::pair<unsigned, unsigned> > crossing;
+  std::vector<std::pair<unsigned, unsigned> > forced; // the parts constrained here
+  while (a != b) {
+    // about a: the edge to b, a vertex on the segment, or the first edge crossing it
+    unsigned next = none(), t = vtri_[a];
+    crossing.clear();
+    for (;;) {
+      unsigned i = 0;
+      while (tri_[3 * t + i] != a) ++i;
+      const unsigned c = tri_[3 * t + (i + 1) % 3], d = tri_[3 * t + (i + 2) % 3];
+      if (c != infinite() && d != infinite()) {
+        if (c == b || d == b) { next = b; break; }
+        const double oc = orient(a, b, X(c), Y(c)), od = orient(a, b, X(d), Y(d));
+        const double bx = X(b) - X(a), by = Y(b) - Y(a);
+        if (oc == 0 && (X(c) - X(a)) * bx + (Y(c) - Y(a)) * by > 0) { next = c; break; }
+        if (od == 0 && (X(d) - X(a)) * bx + (Y(d) - Y(a)) * by > 0) { next = d; break; }
+        if (oc < 0 && od > 0) {
+          // walk along the segment, collecting the crossed edges as (right, left)
+          unsigned right = c, left = d, h = 3 * t + i;
+          for (;;) {
+            if (constrained_[h]) {
+              // take out the parts forced in so far
+              for (std::size_t k = 0; k < forced.size(); ++k) {
+                const unsigned g = find_edge(forced[k].first, forced[k].second);
+                constrained_[g] = constrained_[twin_[g]] = 0;
+              }
+              legalize(forced);
+              return false;
+            }
+            crossing.push_back(std::make_pair(right, left));
+            const unsigned o = twin_[h], w = tri_[o], u = o / 3, j = o % 3;
+            if (w == b) { next = b; break; }
+            const double ow = orient(a, b, X(w), Y(w));
+            if (ow == 0) { next = w; break; }
+            if (ow > 0) { left = w; h = 3 * u + (j + 1) % 3; }
+            else { right = w; h = 3 * u + (j + 2) % 3; }
+          }
+          break;
+        }
+      }
+      t = twin_[3 * t + (i + 1) % 3] / 3;
+    }
+    if (crossing.empty()) {
+      const unsigned h = find_edge(a, next);
+      if (!constrained_[h]) forced.push_back(std::make_pair(a, next));
+      set_constrained(h);
+    }
+    else {
+      force_edge(a, next, crossing);
+      forced.push_back(std::make_pair(a, next));
+    }
+    a = next;
+  }
+  return true;
+}
+
+template <class T>
+bool vgl_delaunay_2d<T>::insert_polygon(vgl_polygon<T> const& poly)
+{
+  const unsigned first = unsigned(rep_.size());
+  std::vector<vgl_point_2d<T> > pts;
+  for (unsigned s = 0; s < poly.num_sheets(); ++s)
+    pts.insert(pts.end(), poly[s].begin(), poly[s].end());
+  insert(pts);
+  bool ok = true;
+  unsigned v = first;
+  for (unsigned s = 0; s < poly.num_sheets(); ++s) {
+    const unsigned m = unsigned(poly[s].size());
+    for (unsigned i = 0; m > 1 && i < m; ++i)
+      ok = insert_constraint(v + i, v + (i + 1) % m) && ok;
+    v += m;
+  }
+  return ok;
+}
+
+template <class T>
+void vgl_delaunay_2d<T>::triangles(std::vector<unsigned>& tri, std::vector<int>* adjacency,
+                                   std::vector<unsigned char>* constrained) const
+{
+  const unsigned nslots = unsigned(tri_.size() / 3);
+  std::vector<int> id(nslots, -1);
+  tri.clear();
+  for (unsigned t = 0; t < nslots; ++t)
+    if (!is_free(t) && !is_ghost(t)) {
+      id[t] = int(tri.size() / 3);
+      for (unsigned k = 0; k < 3; ++k)
+        tri.push_back(ext_[tri_[3 * t + k]]);
+    }
+  if (adjacency) adjacency->clear();
+  if (constrained) constrained->clear();
+  for (unsigned t = 0; t < nslots; ++t)
+    if (id[t] >= 0)
+      for (unsigned k = 0; k < 3; ++k) {
+        if (adjacency) adjacency->push_back(id[twin_[3 * t + k] / 3]);
+        if (constrained) constrained->push_back(constrained_[3 * t + k]);
+      }
+}
+
+template <class T>
+bool vgl_delaunay_2d<T>::locate(vgl_point_2d<T> const& p, unsigned& a, unsigned& b, unsigned& c) const
+{
+  if (n_finite_ == 0)
+    return false;
+  const unsigned t = walk(double(p.x()), double(p.y()), last_);
+  if (is_ghost(t))
+    return false;
+  a = ext_[tri_[3 * t]]; b = ext_[tri_[3 * t + 1]]; c = ext_[tri_[3 * t + 2]];
+  return true;
+}
+
+template <class T>
+int vgl_delaunay_2d<T>::nearest_vertex(vgl_point_2d<T> const& p) const
+{
+  const double px = double(p.x()), py = double(p.y());
+  auto d2 = [&](unsigned v) { return (X(v) - px) * (X(v) - px) + (Y(v) - py) * (Y(v) - py); };
+  if (n_finite_ == 0) {
+    int best = -1;
+    for (unsigned v : pending_)
+      if (best < 0 || d2(v) < d2(unsigned(best))) best = int(v);
+    return best < 0 ? best : int(ext_[best]);
+  }
+  const unsigned t = walk(px, py, last_);
+  unsigned best = none();
+  for (unsigned k = 0; k < 3; ++k) {
+    const unsigned v = tri_[3 * t + k];
+    if (v != infinite() && (best == none() || d2(v) < d2(best))) best = v;
+  }
+  // greedy descent over the neighbours
+  for (bool moved = true; moved;) {
+    moved = false;
+    const unsigned t0 = vtri_[best];
+    unsigned s = t0;
+    do {
+      unsigned i = 0;
+      while (tri_[3 * s + i] != best) ++i;
+      const unsigned w = tri_[3 * s + (i + 1) % 3];
+      if (w != infinite() && d2(w) < d2(best)) {
+        best = w;
+        moved = true;
+        break;
+      }
+      s = twin_[3 * s + (i + 1) % 3] / 3;
+    } while (s != t0);
+  }
+  return int(ext_[best]);
+}
+
+template <class T>
+void vgl_delaunay_2d<T>::voronoi(voronoi_diagram& vd) const
+{
+  const unsigned nslots = unsigned(tri_.size() / 3);
+  std::vector<unsigned> id(nslots, none());
+  vd.vertices.clear();
+  for (unsigned t = 0; t < nslots; ++t)
+    if (!is_free(t) && !is_ghost(t)) {
+      id[t] = unsigned(vd.vertices.size());
+      unsigned const* v = &tri_[3 * t];
+      const double bx = X(v[1]) - X(v[0]), by = Y(v[1]) - Y(v[0]);
+      const double cx = X(v[2]) - X(v[0]), cy = Y(v[2]) - Y(v[0]);
+      const double d = 2 * (bx * cy - by * cx), b2 = bx * bx + by * by, c2 = cx * cx + cy * cy;
+      vd.vertices.push_back(vgl_point_2d<T>(T(X(v[0]) + (cy * b2 - by * c2) / d),
+                                            T(Y(v[0]) + (bx * c2 - cx * b2) / d)));
+    }
+  const unsigned nv = unsigned(rep_.size());
+  vd.cell_start.assign(1, 0);
+  vd.cells.clear();
+  vd.bounded.assign(nv, 0);
+  for (unsigned e = 0; e < nv; ++e) {
+    const unsigned v = int_[e];
+    if (vtri_[v] != none()) {
+      // counterclockwise about v, starting after the infinite triangle if v is on the hull
+      unsigned t0 = vtri_[v], t = t0;
+      bool hull = false;
+      do {
+        if (is_ghost(t)) { hull = true; t0 = t; break; }
+        unsigned i = 0;
+        while (tri_[3 * t + i] != v) ++i;
+        t = twin_[3 * t + (i + 1) % 3] / 3;
+      } while (t != t0);
+      t = t0;
+      do {
+        unsigned i = 0;
+        while (tri_[3 * t + i] != v) ++i;
+        if (!is_ghost(t)) vd.cells.push_back(id[t]);
+        t = twin_[3 * t + (i + 1) % 3] / 3;
+      } while (t != t0);
+      vd.bounded[e] = hull ? 0 : 1;
+    }
+    vd.cell_start.push_back(unsigned(vd.cells.size()));
+  }
+}
+
+#endif // vgl_delaunay_2d_h_
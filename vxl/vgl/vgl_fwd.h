@@ -26,6 +26,7 @@ template <class T> class vgl_box_3d;
 template <class T> class vgl_conic;
 template <class Type> class vgl_conic_segment_2d;
 template <class T> class vgl_polygon;
+template <class T> class vgl_prepared_polygon;
 template <class Type> class vgl_sphere_3d;
 template <class Type> class vgl_cylinder;
 class vgl_region_scan_iterator;
@@ -35,6 +36,13 @@ template <class T> class vgl_triangle_scan_iterator;
 template <class T> class vgl_window_scan_iterator;
 template <class T> class vgl_cubic_spline_3d;
 template <class T> class vgl_cubic_spline_2d;
+template <class T, unsigned D> class vgl_prepared_cubic_spline;
 template <class T> class vgl_pointset_3d;
+template <class T> class vgl_pointset_3d_soa;
+template <class T> class vgl_kd_tree_3d;
+template <class T> class vgl_octree_3d;
+template <class T, unsigned D> class vgl_box_rtree;
+template <class T> class vgl_convex_hull_3d;
+template <class T> class vgl_delaunay_2d;
 
 #endif // vgl_fwd_h_
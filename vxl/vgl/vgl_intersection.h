@@ -30,6 +30,7 @@
 #include "vgl_line_segment_3d.h"
 #include "vgl_infinite_line_3d.h"
 #include "vgl_pointset_3d.h"
+#include "vgl_pointset_3d_soa.h"
 
 
 #include "vgl_point_2d.h"
@@ -340,6 +341,22 @@ template <class T>
 vgl_pointset_3d<T> vgl_intersection(vgl_pointset_3d<T> const& ptset, vgl_box_3d<T> const& box){
   return vgl_intersection(box, ptset);}
 
+//: The same for structure-of-arrays pointsets.
+//  The tests run over the coordinate arrays in a vectorisable loop; the selected points are gathered afterwards.
+template <class T>
+vgl_pointset_3d_soa<T> vgl_intersection(vgl_plane_3d<T> const& plane, vgl_pointset_3d_soa<T> const& ptset, T tol);
+
+template <class T>
+vgl_pointset_3d_soa<T> vgl_intersection(vgl_pointset_3d_soa<T> const& ptset, vgl_plane_3d<T> const& plane, T tol){
+  return vgl_intersection(plane, ptset, tol);}
+
+template <class T>
+vgl_pointset_3d_soa<T> vgl_intersection(vgl_box_3d<T> const& box, vgl_pointset_3d_soa<T> const& ptset);
+
+template <class T>
+vgl_pointset_3d_soa<T> vgl_intersection(vgl_pointset_3d_soa<T> const& ptset, vgl_box_3d<T> const& box){
+  return vgl_intersection(box, ptset);}
+
 
 template <class T>
 vgl_pointset_3d<T> vgl_intersection(vgl_plane_3d<T> const& plane, vgl_pointset_3d<T> const& ptset, T tol);
@@ -1462,4 +1479,33 @@ vgl_pointset_3d<T> vgl_intersection(vgl_box_3d<T> const& box, vgl_pointset_3d<T>
     return vgl_pointset_3d<T>(pts);
 }
 
+//: distance in double, as (p-cp).length() in the vgl_pointset_3d version
+template <class T>
+vgl_pointset_3d_soa<T> vgl_intersection(vgl_plane_3d<T> const& plane, vgl_pointset_3d_soa<T> const& ptset, T tol){
+    const std::size_t n = ptset.npts();
+    const double len = std::sqrt(double(plane.a())*plane.a() + double(plane.b())*plane.b() + double(plane.c())*plane.c());
+    const double a = plane.a()/len, b = plane.b()/len, c = plane.c()/len, d = plane.d()/len;
+    const double t = double(tol);
+    T const* x = ptset.x().data();
+    T const* y = ptset.y().data();
+    T const* z = ptset.z().data();
+    std::vector<unsigned char> mask(n);
+    for(std::size_t i = 0; i<n; ++i)
+        mask[i] = std::fabs(a*x[i] + b*y[i] + c*z[i] + d) < t;
+    return ptset.select(mask);
+}
+
+template <class T>
+vgl_pointset_3d_soa<T> vgl_intersection(vgl_box_3d<T> const& box, vgl_pointset_3d_soa<T> const& ptset){
+    const std::size_t n = ptset.npts();
+    const T x0 = box.min_x(), x1 = box.max_x(), y0 = box.min_y(), y1 = box.max_y(), z0 = box.min_z(), z1 = box.max_z();
+    T const* x = ptset.x().data();
+    T const* y = ptset.y().data();
+    T const* z = ptset.z().data();
+    std::vector<unsigned char> mask(n);
+    for(std::size_t i = 0; i<n; ++i)
+        mask[i] = (x[i] >= x0) & (x[i] <= x1) & (y[i] >= y0) & (y[i] <= y1) & (z[i] >= z0) & (z[i] <= z1);
+    return ptset.select(mask);
+}
+
 #endif // vgl_intersection_h_
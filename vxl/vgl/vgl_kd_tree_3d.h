@@ -0,0 +1,342 @@
+// This is core/vgl/vgl_kd_tree_3d.h
+#ifndef vgl_kd_tree_3d_h_
+#define vgl_kd_tree_3d_h_
+//:
+// \file
+// \brief A k-d tree over 3-d points for nearest neighbour and radius queries
+//
+//  The tree is balanced (median split along the axis of largest extent) and
+//  stored flat: the nodes are kept in one array in pre-order, so the left
+//  child of node i is node i+1, and the points (coordinates and original
+//  index) are copied into one array in leaf order, so both the median splits
+//  of the build and the leaf scans of a query read contiguous memory.  Because the
+//  shape of the tree only depends on the number of points, the position of
+//  every subtree in the node array is known in advance and the two halves of
+//  a split are built by separate threads.
+//
+//  Queries return indices into the point set the tree was built from.  A
+//  query with max_leaf_visits > 0 is approximate: the search stops after that
+//  many leaves, which bounds its cost; the nearest leaves are visited first.
+//
+// \verbatim
+//  Modifications
+// \endverbatim
+
+#include <vector>
+#include <map>
+#include <limits>
+#include <algorithm>
+#include <type_traits>
+#include <thread>
+#include <cstddef>
+#include <cassert>
+#include <vgl/vgl_point_3d.h>
+#include <vgl/vgl_pointset_3d.h>
+#include <vgl/vgl_parallel.h>
+
+template <class T>
+class vgl_kd_tree_3d
+{
+ public:
+  //: squared distances are computed in T for floating point T, otherwise in double
+  using dist_t = typename std::conditional<std::is_floating_point<T>::value, T, double>::type;
+
+  //: Build the tree over the points of ptset.
+  //  leaf_size is the maximum number of points in a leaf; nthreads = 0 uses
+  //  std::thread::hardware_concurrency() threads.
+  explicit vgl_kd_tree_3d(vgl_pointset_3d<T> const& ptset, unsigned leaf_size = 16, unsigned nthreads = 0);
+
+  //: Build the tree over pts.
+  explicit vgl_kd_tree_3d(std::vector<vgl_point_3d<T> > const& pts, unsigned leaf_size = 16, unsigned nthreads = 0);
+
+  //: Build the tree over the n points (x[i], y[i], z[i]), e.g. the columns of a vgl_pointset_3d_soa.
+  vgl_kd_tree_3d(T const* x, T const* y, T const* z, std::size_t n, unsigned leaf_size = 16, unsigned nthreads = 0);
+
+  //: number of points in the tree
+  std::size_t size() const { return items_.size(); }
+  bool empty() const { return items_.empty(); }
+
+  //: Index of the point nearest to p, or -1 if the tree is empty.
+  //  If dist2 is given, it receives the squared distance.
+  int nearest(vgl_point_3d<T> const& p, dist_t* dist2 = nullptr, unsigned max_leaf_visits = 0) const;
+
+  //: Indices of the k points nearest to p, sorted by increasing distance.
+  //  Returns the number of points found, min(k, size()).
+  unsigned k_nearest(vgl_point_3d<T> const& p, unsigned k, std::vector<unsigned>& indices,
+                     std::vector<dist_t>* dist2 = nullptr, unsigned max_leaf_visits = 0) const;
+
+  //: Indices of all points within distance r of p, in no particular order.
+  unsigned radius_search(vgl_point_3d<T> const& p, T r, std::vector<unsigned>& indices,
+                         std::vector<dist_t>* dist2 = nullptr) const;
+
+  //: nearest() for a batch of queries, spread over nthreads threads (0: all cores).
+  void nearest(std::vector<vgl_point_3d<T> > const& queries, std::vector<int>& indices,
+               unsigned max_leaf_visits = 0, unsigned nthreads = 0) const;
+
+ private:
+  //: An inner node splits [begin, end) at the median along dim; a leaf has dim == 3.
+  struct node
+  {
+    T split;
+    unsigned right;      // index of the right child; the left child follows the node
+    unsigned begin, end; // range of the node's points in items_
+    unsigned char dim;
+  };
+
+  //: A point and its index in the original point set.
+  struct item
+  {
+    T c[3];
+    unsigned index;
+  };
+
+  //: Orders items along dim.
+  struct axis_less
+  {
+    unsigned char dim;
+    bool operator()(item const& a, item const& b) const { return a.c[dim] < b.c[dim]; }
+  };
+
+  void build(unsigned nthreads);
+  void build_node(unsigned id, unsigned begin, unsigned end, unsigned nthreads);
+  unsigned count_nodes(unsigned n) const;
+
+  //: Depth-first search, nearest child first; Visitor has bound() and add(i, d2).
+  template <class Visitor>
+  void search(vgl_point_3d<T> const& p, Visitor& v, unsigned max_leaf_visits) const;
+
+  unsigned leaf_size_;
+  std::vector<node> nodes_;       // pre-order
+  std::vector<item> items_;       // points in leaf order
+  std::map<unsigned, unsigned> subtree_nodes_; // node count of a subtree by number of points
+};
+
+// implementation
+template <class T>
+vgl_kd_tree_3d<T>::vgl_kd_tree_3d(vgl_pointset_3d<T> const& ptset, unsigned leaf_size, unsigned nthreads)
+  : vgl_kd_tree_3d(ptset.points(), leaf_size, nthreads)
+{
+}
+
+template <class T>
+vgl_kd_tree_3d<T>::vgl_kd_tree_3d(std::vector<vgl_point_3d<T> > const& pts, unsigned leaf_size, unsigned nthreads)
+  : leaf_size_(leaf_size), items_(pts.size())
+{
+  for (std::size_t i = 0; i < items_.size(); ++i) {
+    item& it = items_[i];
+    it.c[0] = pts[i].x(); it.c[1] = pts[i].y(); it.c[2] = pts[i].z();
+    it.index = static_cast<unsigned>(i);
+  }
+  build(nthreads);
+}
+
+template <class T>
+vgl_kd_tree_3d<T>::vgl_kd_tree_3d(T const* x, T const* y, T const* z, std::size_t n,
+                                  unsigned leaf_size, unsigned nthreads)
+  : leaf_size_(leaf_size), items_(n)
+{
+  for (std::size_t i = 0; i < n; ++i) {
+    item& it = items_[i];
+    it.c[0] = x[i]; it.c[1] = y[i]; it.c[2] = z[i];
+    it.index = static_cast<unsigned>(i);
+  }
+  build(nthreads);
+}
+
+template <class T>
+unsigned vgl_kd_tree_3d<T>::count_nodes(unsigned n) const
+{
+  return subtree_nodes_.find(n)->second;
+}
+
+template <class T>
+void vgl_kd_tree_3d<T>::build(unsigned nthreads)
+{
+  const unsigned leaf_size = leaf_size_;
+  assert(leaf_size > 0);
+  const unsigned n = static_cast<unsigned>(items_.size());
+  if (n == 0) return;
+
+  // node counts of all subtree sizes that occur; sizes halve at each level
+  // and take at most two values per level, so the table stays small
+  std::vector<unsigned> sizes(1, n);
+  for (std::size_t i = 0; i < sizes.size(); ++i) {
+    unsigned s = sizes[i];
+    if (subtree_nodes_.count(s)) continue;
+    subtree_nodes_[s] = 0;
+    if (s > leaf_size) { sizes.push_back(s / 2); sizes.push_back(s - s / 2); }
+  }
+  for (std::map<unsigned, unsigned>::iterator it = subtree_nodes_.begin(); it != subtree_nodes_.end(); ++it)
+    it->second = it->first <= leaf_size ? 1u
+               : 1u + subtree_nodes_[it->first / 2] + subtree_nodes_[it->first - it->first / 2];
+
+  nodes_.resize(count_nodes(n));
+  build_node(0, 0, n, vgl_parallel_detail::thread_count(nthreads));
+}
+
+template <class T>
+void vgl_kd_tree_3d<T>::build_node(unsigned id, unsigned begin, unsigned end, unsigned nthreads)
+{
+  node& nd = nodes_[id];
+  nd.begin = begin; nd.end = end;
+  if (end - begin <= leaf_size_) {
+    nd.dim = 3; nd.right = 0; nd.split = T(0);
+    return;
+  }
+
+  // split along the axis of largest extent
+  T lo[3] = { items_[begin].c[0], items_[begin].c[1], items_[begin].c[2] };
+  T hi[3] = { lo[0], lo[1], lo[2] };
+  for (unsigned i = begin + 1; i < end; ++i) {
+    for (unsigned char d = 0; d < 3; ++d) {
+      T c = items_[i].c[d];
+      if (c < lo[d]) lo[d] = c; else if (c > hi[d]) hi[d] = c;
+    }
+  }
+  unsigned char dim = 0;
+  for (unsigned char d = 1; d < 3; ++d)
+    if (hi[d] - lo[d] > hi[dim] - lo[dim]) dim = d;
+
+  const unsigned mid = begin + (end - begin) / 2;
+  axis_less less = { dim };
+  std::nth_element(items_.begin() + begin, items_.begin() + mid, items_.begin() + end, less);
+  nd.dim = dim;
+  nd.split = items_[mid].c[dim];
+  nd.right = id + 1 + count_nodes(mid - begin);
+
+  // the halves write disjoint parts of nodes_ and items_
+  const unsigned right = nd.right;
+  if (nthreads > 1) {
+    std::thread left(&vgl_kd_tree_3d<T>::build_node, this, id + 1, begin, mid, nthreads / 2);
+    build_node(right, mid, end, nthreads - nthreads / 2);
+    left.join();
+  }
+  else {
+    build_node(id + 1, begin, mid, 1);
+    build_node(right, mid, end, 1);
+  }
+}
+
+template <class T>
+template <class Visitor>
+void vgl_kd_tree_3d<T>::search(vgl_point_3d<T> const& p, Visitor& v, unsigned max_leaf_visits) const
+{
+  if (nodes_.empty()) return;
+  const dist_t q[3] = { dist_t(p.x()), dist_t(p.y()), dist_t(p.z()) };
+
+  // pending far children: their squared distance to q is at least rd, where
+  // off holds the per-axis offsets of q from the cell (Arya & Mount)
+  struct entry { unsigned id; dist_t rd; dist_t off[3]; };
+  entry stack[64];
+  int top = 0;
+  stack[top++] = entry{ 0, dist_t(0), { dist_t(0), dist_t(0), dist_t(0) } };
+  unsigned leaves = 0;
+
+  while (top > 0) {
+    entry e = stack[--top];
+    if (e.rd > v.bound()) continue;
+    unsigned id = e.id;
+    while (nodes_[id].dim < 3) {
+      node const& nd = nodes_[id];
+      const dist_t diff = q[nd.dim] - dist_t(nd.split);
+      const unsigned near_id = diff <= 0 ? id + 1 : nd.right;
+      const unsigned far_id  = diff <= 0 ? nd.right : id + 1;
+      const dist_t far_rd = e.rd - e.off[nd.dim] * e.off[nd.dim] + diff * diff;
+      if (far_rd <= v.bound()) {
+        entry f = e;
+        f.id = far_id; f.rd = far_rd; f.off[nd.dim] = diff;
+        stack[top++] = f;
+      }
+      id = near_id;
+    }
+    node const& leaf = nodes_[id];
+    for (unsigned i = leaf.begin; i < leaf.end; ++i) {
+      const T* c = items_[i].c;
+      const dist_t dx = dist_t(c[0]) - q[0], dy = dist_t(c[1]) - q[1], dz = dist_t(c[2]) - q[2];
+      const dist_t d2 = dx*dx + dy*dy + dz*dz;
+      if (d2 <= v.bound()) v.add(items_[i].index, d2);
+    }
+    if (max_leaf_visits && ++leaves >= max_leaf_visits) return;
+  }
+}
+
+template <class T>
+int vgl_kd_tree_3d<T>::nearest(vgl_point_3d<T> const& p, dist_t* dist2, unsigned max_leaf_visits) const
+{
+  struct visitor
+  {
+    dist_t best; int i;
+    dist_t bound() const { return best; }
+    void add(unsigned j, dist_t d2) { if (d2 < best || i < 0) { best = d2; i = int(j); } }
+  } v = { std::numeric_limits<dist_t>::max(), -1 };
+  search(p, v, max_leaf_visits);
+  if (v.i < 0) return -1;
+  if (dist2) *dist2 = v.best;
+  return v.i;
+}
+
+template <class T>
+unsigned vgl_kd_tree_3d<T>::k_nearest(vgl_point_3d<T> const& p, unsigned k, std::vector<unsigned>& indices,
+                                      std::vector<dist_t>* dist2, unsigned max_leaf_visits) const
+{
+  // max-heap on distance of the best k so far
+  struct visitor
+  {
+    std::vector<std::pair<dist_t, unsigned> > heap; unsigned k;
+    dist_t bound() const { return heap.size() < k ? std::numeric_limits<dist_t>::max() : heap.front().first; }
+    void add(unsigned j, dist_t d2)
+    {
+      if (heap.size() == k) {
+        if (d2 >= heap.front().first) return;
+        std::pop_heap(heap.begin(), heap.end());
+        heap.pop_back();
+      }
+      heap.push_back(std::make_pair(d2, j));
+      std::push_heap(heap.begin(), heap.end());
+    }
+  } v;
+  v.k = k;
+  indices.clear();
+  if (dist2) dist2->clear();
+  if (k == 0) return 0;
+  v.heap.reserve(k + 1);
+  search(p, v, max_leaf_visits);
+  std::sort_heap(v.heap.begin(), v.heap.end());
+  for (std::size_t i = 0; i < v.heap.size(); ++i) {
+    indices.push_back(v.heap[i].second);
+    if (dist2) dist2->push_back(v.heap[i].first);
+  }
+  return static_cast<unsigned>(indices.size());
+}
+
+template <class T>
+unsigned vgl_kd_tree_3d<T>::radius_search(vgl_point_3d<T> const& p, T r, std::vector<unsigned>& indices,
+                                          std::vector<dist_t>* dist2) const
+{
+  struct visitor
+  {
+    dist_t r2; std::vector<unsigned>* out; std::vector<dist_t>* d;
+    dist_t bound() const { return r2; }
+    void add(unsigned j, dist_t d2) { out->push_back(j); if (d) d->push_back(d2); }
+  } v = { dist_t(r) * dist_t(r), &indices, dist2 };
+  indices.clear();
+  if (dist2) dist2->clear();
+  if (r < T(0)) return 0;
+  search(p, v, 0);
+  return static_cast<unsigned>(indices.size());
+}
+
+template <class T>
+void vgl_kd_tree_3d<T>::nearest(std::vector<vgl_point_3d<T> > const& queries, std::vector<int>& indices,
+                                unsigned max_leaf_visits, unsigned nthreads) const
+{
+  const std::size_t nq = queries.size();
+  indices.resize(nq);
+  vgl_parallel_detail::parallel_for(nq, vgl_parallel_detail::thread_count(nthreads, nq),
+                                    [&](unsigned, std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i)
+      indices[i] = nearest(queries[i], nullptr, max_leaf_visits);
+  });
+}
+
+#endif // vgl_kd_tree_3d_h_
@@ -10,6 +10,7 @@
 //   Sep.2005 - Peter Vanroose - bug fix: collinear line segments always "true"
 //   Mar.2008 - Ibrahim Eden - bug fix: bool vgl_lineseg_test_line(vgl_line_2d<T> const& l1,vgl_line_segment_2d<T> const& l2)
 //   Mar.2009 - Dirk Steckhan - bug fix in vgl_lineseg_test_point (missing sqrt)
+//   Oct.2026 - vgl_lineseg_test_lineseg decides with exact orientations
 // \endverbatim
 
 #include <cmath>
@@ -93,41 +94,17 @@ bool inbetween(T x1, T y1, T x2, T y2, T x3, T y3)
 template <class T>
 bool vgl_lineseg_test_lineseg(T x1, T y1, T x2, T y2, T x3, T y3, T x4, T y4)
 {
-    // reduce precision of inputs so that signs of vgl_triangle_test_discriminants
-    // `a', `b', `c', and `d' are more stable when they are very close to zero.
-    
-    double px1 = x1;
-    double py1 = y1;
-    double px2 = x2;
-    double py2 = y2;
-    double px3 = x3;
-    double py3 = y3;
-    double px4 = x4;
-    double py4 = y4;
-    
-    px1 = (px1 + px1*1e4) - px1*1e4;
-    py1 = (py1 + py1*1e4) - py1*1e4;
-    px2 = (px2 + px2*1e4) - px2*1e4;
-    py2 = (py2 + py2*1e4) - py2*1e4;
-    px3 = (px3 + px3*1e4) - px3*1e4;
-    py3 = (py3 + py3*1e4) - py3*1e4;
-    px4 = (px4 + px4*1e4) - px4*1e4;
-    py4 = (py4 + py4*1e4) - py4*1e4;
-    
     // two lines intersect if p1 and p2 are on two opposite sides of the line p3-p4
-    // and p3 and p4 are on two opposite sides of line p1-p2
-    // degenerate cases (collinear points) are tricky to handle
-    
-    double a = vgl_triangle_test_discriminant(px1, py1, px2, py2, px3, py3);
-    double b = vgl_triangle_test_discriminant(px1, py1, px2, py2, px4, py4);
-    double c = vgl_triangle_test_discriminant(px3, py3, px4, py4, px1, py1);
-    double d = vgl_triangle_test_discriminant(px3, py3, px4, py4, px2, py2);
+    // and p3 and p4 are on two opposite sides of line p1-p2.
+    // The signs of the discriminants are exact (vgl_orient_2d), so collinear
+    // points are recognised as such without a tolerance.
+    const double px1 = x1, py1 = y1, px2 = x2, py2 = y2;
+    const double px3 = x3, py3 = y3, px4 = x4, py4 = y4;
     
-    // force to be zero when they're close to zero
-    a = (std::abs(a) < 1e-12) ? 0 : a;
-    b = (std::abs(b) < 1e-12) ? 0 : b;
-    c = (std::abs(c) < 1e-12) ? 0 : c;
-    d = (std::abs(d) < 1e-12) ? 0 : d;
+    const double a = vgl_orient_2d(px1, py1, px2, py2, px3, py3);
+    const double b = vgl_orient_2d(px1, py1, px2, py2, px4, py4);
+    const double c = vgl_orient_2d(px3, py3, px4, py4, px1, py1);
+    const double d = vgl_orient_2d(px3, py3, px4, py4, px2, py2);
     
     return
     ( ( (a<=0 && b>0) || (a>=0 && b<0) || (a<0 && b>=0) || (a>0 && b<=0) ) &&
@@ -0,0 +1,414 @@
+// This is core/vgl/vgl_octree_3d.h
+#ifndef vgl_octree_3d_h_
+#define vgl_octree_3d_h_
+//:
+// \file
+// \brief A sparse voxel grid, organised as a linear octree, for streams of 3-d points
+//
+//  Space is divided into cubic voxels of side voxel_size, 2^depth of them
+//  along each axis starting at origin.  Only occupied voxels are stored.
+//  Each voxel is identified by the Morton code of its integer coordinates
+//  (the bits of i, j and k interleaved), and the points are kept sorted by
+//  that key.  Sorting by Morton code puts the voxels of every octree node in
+//  one contiguous range, so the octree is implicit: the children of a node
+//  are found by binary search, and points that are close in space are close
+//  in memory.
+//
+//  Points are inserted one at a time or in bulk; new points are appended
+//  unsorted and merged into place by consolidate(), which every query calls
+//  first.  Queries are therefore not safe to run from several threads unless
+//  consolidate() has been called after the last insertion.
+//
+//  With keep_points false, the grid only keeps the centroid and the number
+//  of points of each voxel, which bounds its memory by the number of occupied
+//  voxels however many points are streamed in; downsample() then returns
+//  the voxel-grid downsampled point set.
+//
+// \verbatim
+//  Modifications
+// \endverbatim
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+#include <cassert>
+#include <vgl/vgl_point_3d.h>
+#include <vgl/vgl_box_3d.h>
+#include <vgl/vgl_plane_3d.h>
+#include <vgl/vgl_pointset_3d.h>
+#include <vgl/vgl_frustum_3d.h>
+#include <vgl/vgl_tolerance.h>
+
+template <class T>
+class vgl_octree_3d
+{
+ public:
+  using key_type = std::uint64_t;
+
+  //: the largest depth; three 21-bit coordinates fill a 63-bit key
+  static const unsigned max_depth = 21;
+
+  //: Grid with its lowest corner at origin and 2^depth voxels of side voxel_size along each axis.
+  //  With keep_points false only the centroid and point count of each voxel are kept.
+  vgl_octree_3d(vgl_point_3d<T> const& origin, T voxel_size, unsigned depth = max_depth, bool keep_points = true);
+
+  //: The smallest grid with its lowest corner at bounds.min_point() that covers bounds.
+  vgl_octree_3d(vgl_box_3d<T> const& bounds, T voxel_size, bool keep_points = true);
+
+  //: Insert p; returns false, and ignores p, if it lies outside the grid.
+  bool insert(vgl_point_3d<T> const& p);
+
+  //: Insert the points of ptset; returns the number inside the grid.
+  std::size_t insert(vgl_pointset_3d<T> const& ptset);
+
+  //: Insert the n points (x[i], y[i], z[i]); returns the number inside the grid.
+  std::size_t insert(T const* x, T const* y, T const* z, std::size_t n);
+
+  //: Merge the points inserted since the last call into Morton order.
+  void consolidate() const;
+
+  //: number of points inserted (inside the grid)
+  std::size_t size() const { return npts_; }
+  bool empty() const { return npts_ == 0; }
+  //: number of occupied voxels
+  std::size_t n_cells() const;
+  void clear() { entries_.clear(); nsorted_ = 0; npts_ = 0; }
+
+  vgl_point_3d<T> const& origin() const { return origin_; }
+  T voxel_size() const { return voxel_size_; }
+  unsigned depth() const { return depth_; }
+  bool keep_points() const { return keep_points_; }
+  //: the region covered by the grid
+  vgl_box_3d<T> bounding_box() const { return cell_box(0, depth_); }
+
+  //: Key of the voxel containing p; returns false if p lies outside the grid.
+  bool key(vgl_point_3d<T> const& p, key_type& k) const { return key(p.x(), p.y(), p.z(), k); }
+  bool key(T x, T y, T z, key_type& k) const;
+
+  //: The box of the octree node at the given level containing voxel k (level 0 is the voxel itself).
+  vgl_box_3d<T> cell_box(key_type k, unsigned level = 0) const;
+
+  //: Morton code of voxel (i, j, k), and its inverse; coordinates have at most 21 bits.
+  static key_type morton_encode(unsigned i, unsigned j, unsigned k)
+  { return split3(i) | (split3(j) << 1) | (split3(k) << 2); }
+  static void morton_decode(key_type key, unsigned& i, unsigned& j, unsigned& k)
+  { i = compact3(key); j = compact3(key >> 1); k = compact3(key >> 2); }
+
+  //: The points inside box (boundary included), in Morton order.
+  //  Without keep_points these are the centroids of the voxels.
+  vgl_pointset_3d<T> points_in(vgl_box_3d<T> const& box) const;
+
+  //: The points inside frustum, which is assumed convex, in Morton order.
+  vgl_pointset_3d<T> points_in(vgl_frustum_3d<T> const& frustum) const;
+
+  //: One point per occupied voxel, the centroid of the points inserted into it, in Morton order.
+  //  If with_counts is true the number of points of each voxel is returned as its scalar.
+  vgl_pointset_3d<T> downsample(bool with_counts = false) const;
+
+ private:
+  //: a point, or without keep_points the centroid of count points in the voxel
+  struct entry
+  {
+    key_type key;
+    T x, y, z;
+    std::size_t count;
+    bool operator<(entry const& e) const { return key < e.key; }
+  };
+
+  vgl_point_3d<T> origin_;
+  T voxel_size_;
+  unsigned depth_;
+  bool keep_points_;
+  std::size_t npts_;
+  //: entries_[0, nsorted_) are sorted by key, the rest are pending insertions
+  mutable std::vector<entry> entries_;
+  mutable std::size_t nsorted_;
+
+  static key_type split3(key_type a)
+  {
+    a &= 0x1fffff;
+    a = (a | a << 32) & 0x1f00000000ffffULL;
+    a = (a | a << 16) & 0x1f0000ff0000ffULL;
+    a = (a | a << 8) & 0x100f00f00f00f00fULL;
+    a = (a | a << 4) & 0x10c30c30c30c30c3ULL;
+    a = (a | a << 2) & 0x1249249249249249ULL;
+    return a;
+  }
+  static unsigned compact3(key_type a)
+  {
+    a &= 0x1249249249249249ULL;
+    a = (a ^ (a >> 2)) & 0x10c30c30c30c30c3ULL;
+    a = (a ^ (a >> 4)) & 0x100f00f00f00f00fULL;
+    a = (a ^ (a >> 8)) & 0x1f0000ff0000ffULL;
+    a = (a ^ (a >> 16)) & 0x1f00000000ffffULL;
+    a = (a ^ (a >> 32)) & 0x1fffff;
+    return static_cast<unsigned>(a);
+  }
+
+  void push(key_type k, T x, T y, T z);
+
+  //: Visit the entries of the octree node (prefix, level) holding entries_[b, e).
+  //  classify(box) returns 0 if box is outside the query, 2 if inside and 1 otherwise;
+  //  inside(e) is the test of a single entry, used where the node straddles the query boundary.
+  template <class Classify, class Inside>
+  void query(std::size_t b, std::size_t e, key_type prefix, unsigned level,
+             Classify const& classify, Inside const& inside, std::vector<vgl_point_3d<T> >& out) const;
+};
+
+template <class T>
+vgl_octree_3d<T>::vgl_octree_3d(vgl_point_3d<T> const& origin, T voxel_size, unsigned depth, bool keep_points)
+  : origin_(origin), voxel_size_(voxel_size), depth_(depth), keep_points_(keep_points), npts_(0), nsorted_(0)
+{
+  assert(voxel_size > T(0));
+  assert(depth <= max_depth);
+}
+
+template <class T>
+vgl_octree_3d<T>::vgl_octree_3d(vgl_box_3d<T> const& bounds, T voxel_size, bool keep_points)
+  : origin_(bounds.min_point()), voxel_size_(voxel_size), depth_(0), keep_points_(keep_points), npts_(0), nsorted_(0)
+{
+  assert(voxel_size > T(0));
+  double extent = std::max(std::max(bounds.width(), bounds.height()), bounds.depth());
+  // the grid is half open, so the far side of bounds needs a voxel too
+  while (depth_ < max_depth && double(voxel_size) * double(key_type(1) << depth_) <= extent)
+    ++depth_;
+  assert(double(voxel_size) * double(key_type(1) << depth_) > extent);
+}
+
+template <class T>
+bool vgl_octree_3d<T>::key(T x, T y, T z, key_type& k) const
+{
+  const double n = double(key_type(1) << depth_);
+  const double fi = (double(x) - origin_.x()) / voxel_size_;
+  const double fj = (double(y) - origin_.y()) / voxel_size_;
+  const double fk = (double(z) - origin_.z()) / voxel_size_;
+  // written so that NaN coordinates are rejected too
+  if (!(fi >= 0.0 && fi < n && fj >= 0.0 && fj < n && fk >= 0.0 && fk < n))
+    return false;
+  k = morton_encode(unsigned(fi), unsigned(fj), unsigned(fk));
+  return true;
+}
+
+template <class T>
+vgl_box_3d<T> vgl_octree_3d<T>::cell_box(key_type k, unsigned level) const
+{
+  unsigned i, j, l;
+  morton_decode(k >> (3 * level) << (3 * level), i, j, l);
+  const T side = voxel_size_ * T(key_type(1) << level);
+  vgl_point_3d<T> lo(origin_.x() + voxel_size_ * T(i), origin_.y() + voxel_size_ * T(j), origin_.z() + voxel_size_ * T(l));
+  vgl_point_3d<T> hi(lo.x() + side, lo.y() + side, lo.z() + side);
+  return vgl_box_3d<T>(lo, hi);
+}
+
+template <class T>
+void vgl_octree_3d<T>::push(key_type k, T x, T y, T z)
+{
+  entry e = { k, x, y, z, 1 };
+  entries_.push_back(e);
+  ++npts_;
+  // without points, fold the pending insertions into the voxels before they
+  // outgrow them, so memory stays proportional to the occupied voxels
+  if (!keep_points_ && entries_.size() - nsorted_ > std::max<std::size_t>(65536, nsorted_))
+    consolidate();
+}
+
+template <class T>
+bool vgl_octree_3d<T>::insert(vgl_point_3d<T> const& p)
+{
+  key_type k;
+  if (!key(p, k))
+    return false;
+  push(k, p.x(), p.y(), p.z());
+  return true;
+}
+
+template <class T>
+std::size_t vgl_octree_3d<T>::insert(vgl_pointset_3d<T> const& ptset)
+{
+  std::vector<vgl_point_3d<T> > const& pts = ptset.points();
+  if (keep_points_) entries_.reserve(entries_.size() + pts.size());
+  std::size_t n = 0;
+  for (std::size_t i = 0; i < pts.size(); ++i)
+    n += insert(pts[i]);
+  return n;
+}
+
+template <class T>
+std::size_t vgl_octree_3d<T>::insert(T const* x, T const* y, T const* z, std::size_t n)
+{
+  if (keep_points_) entries_.reserve(entries_.size() + n);
+  std::size_t m = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    key_type k;
+    if (!key(x[i], y[i], z[i], k))
+      continue;
+    push(k, x[i], y[i], z[i]);
+    ++m;
+  }
+  return m;
+}
+
+template <class T>
+void vgl_octree_3d<T>::consolidate() const
+{
+  if (nsorted_ == entries_.size())
+    return;
+  // stable, so the points of a voxel stay in insertion order
+  typename std::vector<entry>::iterator mid = entries_.begin() + nsorted_;
+  std::stable_sort(mid, entries_.end());
+  std::inplace_merge(entries_.begin(), mid, entries_.end());
+  if (!keep_points_) {
+    // replace each run of equal keys by its weighted centroid
+    std::size_t out = 0;
+    for (std::size_t b = 0; b < entries_.size();) {
+      std::size_t e = b + 1;
+      while (e < entries_.size() && entries_[e].key == entries_[b].key) ++e;
+      if (e - b == 1) {
+        entries_[out++] = entries_[b];
+      }
+      else {
+        double sx = 0, sy = 0, sz = 0;
+        std::size_t count = 0;
+        for (std::size_t i = b; i < e; ++i) {
+          const double w = double(entries_[i].count);
+          sx += w * entries_[i].x; sy += w * entries_[i].y; sz += w * entries_[i].z;
+          count += entries_[i].count;
+        }
+        entry c = { entries_[b].key, T(sx / count), T(sy / count), T(sz / count), count };
+        entries_[out++] = c;
+      }
+      b = e;
+    }
+    entries_.resize(out);
+  }
+  nsorted_ = entries_.size();
+}
+
+template <class T>
+std::size_t vgl_octree_3d<T>::n_cells() const
+{
+  consolidate();
+  if (!keep_points_)
+    return entries_.size();
+  std::size_t n = 0;
+  for (std::size_t i = 0; i < entries_.size(); ++i)
+    n += (i == 0 || entries_[i].key != entries_[i - 1].key);
+  return n;
+}
+
+template <class T>
+template <class Classify, class Inside>
+void vgl_octree_3d<T>::query(std::size_t b, std::size_t e, key_type prefix, unsigned level,
+                             Classify const& classify, Inside const& inside,
+                             std::vector<vgl_point_3d<T> >& out) const
+{
+  const int c = classify(cell_box(prefix << (3 * level), level));
+  if (c == 0)
+    return;
+  if (c == 2) {
+    for (std::size_t i = b; i < e; ++i)
+      out.push_back(vgl_point_3d<T>(entries_[i].x, entries_[i].y, entries_[i].z));
+    return;
+  }
+  if (level == 0) {
+    for (std::size_t i = b; i < e; ++i)
+      if (inside(entries_[i]))
+        out.push_back(vgl_point_3d<T>(entries_[i].x, entries_[i].y, entries_[i].z));
+    return;
+  }
+  // split [b, e) among the children; child ch holds keys below (prefix*8 + ch + 1) << 3(level-1)
+  entry bound;
+  for (unsigned ch = 0; ch < 8 && b < e; ++ch) {
+    const key_type child = prefix * 8 + ch;
+    std::size_t ce = e;
+    if (ch < 7) {
+      bound.key = (child + 1) << (3 * (level - 1));
+      ce = std::lower_bound(entries_.begin() + b, entries_.begin() + e, bound) - entries_.begin();
+    }
+    if (ce > b)
+      query(b, ce, child, level - 1, classify, inside, out);
+    b = ce;
+  }
+}
+
+template <class T>
+vgl_pointset_3d<T> vgl_octree_3d<T>::points_in(vgl_box_3d<T> const& box) const
+{
+  consolidate();
+  std::vector<vgl_point_3d<T> > pts;
+  if (box.is_empty() || entries_.empty())
+    return vgl_pointset_3d<T>(std::move(pts));
+  auto classify = [&box](vgl_box_3d<T> const& cell) {
+    if (cell.max_x() < box.min_x() || cell.min_x() > box.max_x() ||
+        cell.max_y() < box.min_y() || cell.min_y() > box.max_y() ||
+        cell.max_z() < box.min_z() || cell.min_z() > box.max_z())
+      return 0;
+    if (box.contains(cell))
+      return 2;
+    return 1;
+  };
+  auto inside = [&box](entry const& e) { return box.contains(e.x, e.y, e.z); };
+  query(0, entries_.size(), 0, depth_, classify, inside, pts);
+  return vgl_pointset_3d<T>(std::move(pts));
+}
+
+template <class T>
+vgl_pointset_3d<T> vgl_octree_3d<T>::points_in(vgl_frustum_3d<T> const& frustum) const
+{
+  consolidate();
+  std::vector<vgl_point_3d<T> > pts;
+  if (entries_.empty())
+    return vgl_pointset_3d<T>(std::move(pts));
+  std::vector<vgl_plane_3d<T> > const& planes = frustum.surface_planes();
+  // the surface plane normals point out of the frustum
+  auto classify = [&planes](vgl_box_3d<T> const& cell) {
+    const T tol = vgl_tolerance<T>::position;
+    bool all_in = true;
+    for (std::size_t p = 0; p < planes.size(); ++p) {
+      const T a = planes[p].a(), b = planes[p].b(), c = planes[p].c(), d = planes[p].d();
+      // extreme values of a x + b y + c z + d over the box
+      const T vmin = (a > 0 ? a * cell.min_x() : a * cell.max_x()) + (b > 0 ? b * cell.min_y() : b * cell.max_y()) +
+                     (c > 0 ? c * cell.min_z() : c * cell.max_z()) + d;
+      const T vmax = (a > 0 ? a * cell.max_x() : a * cell.min_x()) + (b > 0 ? b * cell.max_y() : b * cell.min_y()) +
+                     (c > 0 ? c * cell.max_z() : c * cell.min_z()) + d;
+      if (vmin >= tol)
+        return 0;
+      if (vmax >= tol)
+        all_in = false;
+    }
+    return all_in ? 2 : 1;
+  };
+  auto inside = [&frustum](entry const& e) { return frustum.contains(e.x, e.y, e.z); };
+  query(0, entries_.size(), 0, depth_, classify, inside, pts);
+  return vgl_pointset_3d<T>(std::move(pts));
+}
+
+template <class T>
+vgl_pointset_3d<T> vgl_octree_3d<T>::downsample(bool with_counts) const
+{
+  consolidate();
+  std::vector<vgl_point_3d<T> > pts;
+  std::vector<T> counts;
+  for (std::size_t b = 0; b < entries_.size();) {
+    std::size_t e = b + 1;
+    while (e < entries_.size() && entries_[e].key == entries_[b].key) ++e;
+    double sx = 0, sy = 0, sz = 0;
+    std::size_t count = 0;
+    for (std::size_t i = b; i < e; ++i) {
+      const double w = double(entries_[i].count);
+      sx += w * entries_[i].x; sy += w * entries_[i].y; sz += w * entries_[i].z;
+      count += entries_[i].count;
+    }
+    pts.push_back(vgl_point_3d<T>(T(sx / count), T(sy / count), T(sz / count)));
+    counts.push_back(T(count));
+    b = e;
+  }
+  if (with_counts)
+    return vgl_pointset_3d<T>(std::move(pts), std::move(counts));
+  return vgl_pointset_3d<T>(std::move(pts));
+}
+
+#endif // vgl_octree_3d_h_
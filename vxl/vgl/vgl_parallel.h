@@ -0,0 +1,52 @@
+// This is core/vgl/vgl_parallel.h
+#ifndef vgl_parallel_h_
+#define vgl_parallel_h_
+//:
+// \file
+// \brief Splitting work over threads, for the vgl classes and functions with an nthreads argument
+//
+//  An implementation detail of those headers rather than a public interface:
+//  nthreads = 0 means one thread per core, and no thread is started for less
+//  than a chunk of work.
+//
+// \verbatim
+//  Modifications
+// \endverbatim
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace vgl_parallel_detail
+{
+//: nthreads, or the number of cores if 0, but at most one per min_chunk of the n items, and at least 1.
+inline unsigned thread_count(unsigned nthreads, std::size_t n = std::size_t(-1), std::size_t min_chunk = 1)
+{
+  if (!nthreads) {
+    nthreads = std::thread::hardware_concurrency();
+    if (!nthreads) nthreads = 1;
+  }
+  const std::size_t chunks = n / min_chunk + (n % min_chunk ? 1 : 0);
+  return static_cast<unsigned>(std::max<std::size_t>(1, std::min<std::size_t>(nthreads, chunks)));
+}
+
+//: Run f(t, begin, end) over [0, n) split into nt contiguous ranges, range t in thread t.
+//  Range 0 runs in the calling thread.
+template <class F>
+void parallel_for(std::size_t n, unsigned nt, F const& f)
+{
+  if (nt <= 1) {
+    f(0u, std::size_t(0), n);
+    return;
+  }
+  std::vector<std::thread> threads;
+  for (unsigned t = 1; t < nt; ++t)
+    threads.push_back(std::thread([&f, n, nt, t]() { f(t, n * t / nt, n * (t + 1) / nt); }));
+  f(0u, std::size_t(0), n / nt);
+  for (std::size_t t = 0; t < threads.size(); ++t)
+    threads[t].join();
+}
+} // namespace vgl_parallel_detail
+
+#endif // vgl_parallel_h_
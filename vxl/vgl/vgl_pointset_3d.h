@@ -72,9 +72,10 @@ class vgl_pointset_3d
   {if(has_normals_) return normals_[i]; return vgl_vector_3d<Type>();}
   Type sc(unsigned i) const {if(has_scalars_) return scalars_[i]; return Type(0);}
 
-  std::vector<vgl_point_3d<Type> > points() const {return points_;}
-  std::vector<vgl_vector_3d<Type> > normals() const {return normals_;}
-  std::vector< Type > scalars() const {return scalars_;}
+  //: the stored vectors, without copying; see vgl_pointset_3d_soa for contiguous coordinate arrays
+  std::vector<vgl_point_3d<Type> > const& points() const {return points_;}
+  std::vector<vgl_vector_3d<Type> > const& normals() const {return normals_;}
+  std::vector< Type > const& scalars() const {return scalars_;}
   void clear(){points_.clear(); normals_.clear();}
   void set_points(std::vector<vgl_point_3d<Type> > const& points)
   { points_ = points; has_normals_=false; has_scalars_ = false;}
@@ -113,6 +114,13 @@ class vgl_pointset_3d
     if(i>=static_cast<unsigned>(points_.size())) return false;
     points_[i].set(p.x(), p.y(), p.z()); return true;
   }
+  //: give every point a normal, zero unless it had one, to be filled in with set_normal()
+  //  The storage is not reallocated by set_normal(), so threads may set the normals of different points.
+  void init_normals(){
+    if(has_normals_) normals_.resize(points_.size());
+    else normals_.assign(points_.size(), vgl_vector_3d<Type>());
+    has_normals_ = true;}
+
   bool set_normal(unsigned i, vgl_vector_3d<Type> const& n){
     if(has_normals_&& i<static_cast<unsigned>(normals_.size())){
                 normals_[i].set(n.x(), n.y(), n.z()); return true;}
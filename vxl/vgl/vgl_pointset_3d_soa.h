@@ -0,0 +1,278 @@
+// This is core/vgl/vgl_pointset_3d_soa.h
+#ifndef vgl_pointset_3d_soa_h_
+#define vgl_pointset_3d_soa_h_
+//:
+// \file
+// \brief A 3-d pointset stored as structure of arrays
+//
+//  vgl_pointset_3d_soa holds the same data as vgl_pointset_3d (points with
+//  optional normals and scalars) in separate contiguous arrays x, y, z,
+//  nx, ny, nz and sc, each aligned to 64 bytes.  Loops over one coordinate
+//  of all points then read consecutive memory and vectorise, which is what
+//  the vgl_intersection() and vgl_closest_point() overloads for this type do.
+//  The arrays are exposed without copying through const_span accessors, and
+//  whole columns can be moved in with set_coordinates(), set_normals() and
+//  set_scalars().
+//
+// \verbatim
+//  Modifications
+// \endverbatim
+
+#include <vector>
+#include <cstdlib>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+#include <cassert>
+#include <vgl/vgl_point_3d.h>
+#include <vgl/vgl_vector_3d.h>
+#include <vgl/vgl_pointset_3d.h>
+
+//: Allocator returning storage aligned to Align bytes (a cache line by default)
+template <class T, std::size_t Align = 64>
+struct vgl_aligned_allocator
+{
+  using value_type = T;
+  template <class U> struct rebind { using other = vgl_aligned_allocator<U, Align>; };
+
+  vgl_aligned_allocator() = default;
+  template <class U> vgl_aligned_allocator(vgl_aligned_allocator<U, Align> const&) {}
+
+  T* allocate(std::size_t n)
+  {
+    // over-allocate, and keep the pointer from malloc just before the aligned block
+    void* raw = std::malloc(n * sizeof(T) + Align + sizeof(void*));
+    if (!raw) throw std::bad_alloc();
+    std::uintptr_t p = (reinterpret_cast<std::uintptr_t>(raw) + sizeof(void*) + Align - 1) & ~std::uintptr_t(Align - 1);
+    reinterpret_cast<void**>(p)[-1] = raw;
+    return reinterpret_cast<T*>(p);
+  }
+  void deallocate(T* p, std::size_t) { if (p) std::free(reinterpret_cast<void**>(p)[-1]); }
+
+  template <class U> bool operator==(vgl_aligned_allocator<U, Align> const&) const { return true; }
+  template <class U> bool operator!=(vgl_aligned_allocator<U, Align> const&) const { return false; }
+};
+
+template <class Type>
+class vgl_pointset_3d_soa
+{
+ public:
+  //: storage of one coordinate (or normal component, or scalar) of all points
+  using column = std::vector<Type, vgl_aligned_allocator<Type> >;
+
+  //: read-only view of a column
+  class const_span
+  {
+    Type const* data_;
+    std::size_t size_;
+   public:
+    const_span(Type const* data, std::size_t size) : data_(data), size_(size) {}
+    Type const* data() const { return data_; }
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    Type const* begin() const { return data_; }
+    Type const* end() const { return data_ + size_; }
+    Type const& operator[](std::size_t i) const { return data_[i]; }
+  };
+
+ private:
+  //: members
+  bool has_normals_;
+  bool has_scalars_;
+  column x_, y_, z_;
+  column nx_, ny_, nz_;
+  column sc_;
+
+ public:
+  //: Default constructor
+  vgl_pointset_3d_soa() : has_normals_(false), has_scalars_(false) {}
+
+  //: Construct from a vgl_pointset_3d
+  explicit vgl_pointset_3d_soa(vgl_pointset_3d<Type> const& ptset) : has_normals_(false), has_scalars_(false)
+  { append(ptset); }
+
+  //: Move in the coordinate columns, which must have equal sizes
+  vgl_pointset_3d_soa(column&& x, column&& y, column&& z) : has_normals_(false), has_scalars_(false)
+  { set_coordinates(std::move(x), std::move(y), std::move(z)); }
+
+  //: accessors
+  bool has_normals() const { return has_normals_; }
+  bool has_scalars() const { return has_scalars_; }
+  std::size_t npts() const { return x_.size(); }
+  std::size_t size() const { return x_.size(); }
+  bool empty() const { return x_.empty(); }
+  vgl_point_3d<Type> p(unsigned i) const { return vgl_point_3d<Type>(x_[i], y_[i], z_[i]); }
+  vgl_vector_3d<Type> n(unsigned i) const
+  { if (has_normals_) return vgl_vector_3d<Type>(nx_[i], ny_[i], nz_[i]); return vgl_vector_3d<Type>(); }
+  Type sc(unsigned i) const { if (has_scalars_) return sc_[i]; return Type(0); }
+
+  //: zero-copy views of the columns; the normal and scalar views are empty if absent
+  const_span x() const { return const_span(x_.data(), x_.size()); }
+  const_span y() const { return const_span(y_.data(), y_.size()); }
+  const_span z() const { return const_span(z_.data(), z_.size()); }
+  const_span nx() const { return const_span(nx_.data(), nx_.size()); }
+  const_span ny() const { return const_span(ny_.data(), ny_.size()); }
+  const_span nz() const { return const_span(nz_.data(), nz_.size()); }
+  const_span scalars() const { return const_span(sc_.data(), sc_.size()); }
+
+  //: Reserve storage for n points in all present columns.
+  void reserve(std::size_t n)
+  {
+    x_.reserve(n); y_.reserve(n); z_.reserve(n);
+    if (has_normals_) { nx_.reserve(n); ny_.reserve(n); nz_.reserve(n); }
+    if (has_scalars_) sc_.reserve(n);
+  }
+
+  void clear()
+  {
+    x_.clear(); y_.clear(); z_.clear(); nx_.clear(); ny_.clear(); nz_.clear(); sc_.clear();
+    has_normals_ = false; has_scalars_ = false;
+  }
+
+  //: incrementally grow points; as in vgl_pointset_3d this drops normals and scalars
+  void add_point(vgl_point_3d<Type> const& p)
+  { drop_normals(); drop_scalars(); push_point(p); }
+  //: incrementally grow points and normals; drops scalars
+  void add_point_with_normal(vgl_point_3d<Type> const& p, vgl_vector_3d<Type> const& normal)
+  { drop_scalars(); start_normals(); push_point(p); push_normal(normal); }
+  //: incrementally grow points and scalars; keeps normals if present
+  void add_point_with_scalar(vgl_point_3d<Type> const& p, Type sc)
+  {
+    start_scalars(); push_point(p); sc_.push_back(sc);
+    if (has_normals_) push_normal(vgl_vector_3d<Type>());
+  }
+  void add_point_with_normal_and_scalar(vgl_point_3d<Type> const& p, vgl_vector_3d<Type> const& normal, Type sc)
+  { start_normals(); start_scalars(); push_point(p); push_normal(normal); sc_.push_back(sc); }
+
+  //: Append n points given by coordinate arrays; normals (nx, ny, nz all given) and scalars are optional.
+  //  The appended points must carry the same attributes as the points already in the set, unless it is empty.
+  void append(Type const* x, Type const* y, Type const* z, std::size_t n,
+              Type const* nx = nullptr, Type const* ny = nullptr, Type const* nz = nullptr,
+              Type const* sc = nullptr)
+  {
+    const bool with_normals = nx && ny && nz;
+    const bool with_scalars = sc != nullptr;
+    if (empty()) { has_normals_ = with_normals; has_scalars_ = with_scalars; }
+    assert(with_normals == has_normals_ && with_scalars == has_scalars_);
+    x_.insert(x_.end(), x, x + n); y_.insert(y_.end(), y, y + n); z_.insert(z_.end(), z, z + n);
+    if (has_normals_) { nx_.insert(nx_.end(), nx, nx + n); ny_.insert(ny_.end(), ny, ny + n); nz_.insert(nz_.end(), nz, nz + n); }
+    if (has_scalars_) sc_.insert(sc_.end(), sc, sc + n);
+  }
+
+  //: Append another point set with the same attributes (anything to an empty set).
+  void append(vgl_pointset_3d_soa<Type> const& ptset)
+  {
+    append(ptset.x_.data(), ptset.y_.data(), ptset.z_.data(), ptset.size(),
+           ptset.has_normals_ ? ptset.nx_.data() : nullptr,
+           ptset.has_normals_ ? ptset.ny_.data() : nullptr,
+           ptset.has_normals_ ? ptset.nz_.data() : nullptr,
+           ptset.has_scalars_ ? ptset.sc_.data() : nullptr);
+  }
+
+  //: Append a vgl_pointset_3d with the same attributes (anything to an empty set).
+  void append(vgl_pointset_3d<Type> const& ptset)
+  {
+    if (empty()) { has_normals_ = ptset.has_normals(); has_scalars_ = ptset.has_scalars(); }
+    assert(ptset.has_normals() == has_normals_ && ptset.has_scalars() == has_scalars_);
+    const std::size_t n = ptset.npts();
+    reserve(size() + n);
+    std::vector<vgl_point_3d<Type> > const& pts = ptset.points();
+    for (std::size_t i = 0; i < n; ++i) push_point(pts[i]);
+    if (has_normals_) {
+      std::vector<vgl_vector_3d<Type> > const& normals = ptset.normals();
+      for (std::size_t i = 0; i < n; ++i) push_normal(normals[i]);
+    }
+    if (has_scalars_) {
+      std::vector<Type> const& scalars = ptset.scalars();
+      sc_.insert(sc_.end(), scalars.begin(), scalars.begin() + n);
+    }
+  }
+
+  //: Move in the coordinate columns; normals and scalars are dropped.
+  void set_coordinates(column&& x, column&& y, column&& z)
+  {
+    assert(x.size() == y.size() && x.size() == z.size());
+    x_ = std::move(x); y_ = std::move(y); z_ = std::move(z);
+    drop_normals(); drop_scalars();
+  }
+  //: Move in the normal columns, one entry per point.
+  void set_normals(column&& nx, column&& ny, column&& nz)
+  {
+    assert(nx.size() == size() && ny.size() == size() && nz.size() == size());
+    nx_ = std::move(nx); ny_ = std::move(ny); nz_ = std::move(nz);
+    has_normals_ = true;
+  }
+  //: Move in the scalar column, one entry per point.
+  void set_scalars(column&& sc)
+  {
+    assert(sc.size() == size());
+    sc_ = std::move(sc);
+    has_scalars_ = true;
+  }
+
+  bool set_point(unsigned i, vgl_point_3d<Type> const& p)
+  {
+    if (i >= size()) return false;
+    x_[i] = p.x(); y_[i] = p.y(); z_[i] = p.z(); return true;
+  }
+
+  //: The points i with mask[i] != 0, with their normals and scalars.
+  template <class Mask>
+  vgl_pointset_3d_soa<Type> select(Mask const& mask) const
+  {
+    const std::size_t n = size();
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < n; ++i) count += mask[i] ? 1 : 0;
+    vgl_pointset_3d_soa<Type> ret;
+    ret.has_normals_ = has_normals_; ret.has_scalars_ = has_scalars_;
+    ret.reserve(count);
+    for (std::size_t i = 0; i < n; ++i) {
+      if (!mask[i]) continue;
+      ret.x_.push_back(x_[i]); ret.y_.push_back(y_[i]); ret.z_.push_back(z_[i]);
+      if (has_normals_) { ret.nx_.push_back(nx_[i]); ret.ny_.push_back(ny_[i]); ret.nz_.push_back(nz_[i]); }
+      if (has_scalars_) ret.sc_.push_back(sc_[i]);
+    }
+    return ret;
+  }
+
+  //: Convert to the array-of-structures point set.
+  vgl_pointset_3d<Type> to_pointset() const
+  {
+    const std::size_t n = size();
+    std::vector<vgl_point_3d<Type> > pts(n);
+    for (std::size_t i = 0; i < n; ++i) pts[i].set(x_[i], y_[i], z_[i]);
+    std::vector<vgl_vector_3d<Type> > normals;
+    if (has_normals_) {
+      normals.resize(n);
+      for (std::size_t i = 0; i < n; ++i) normals[i].set(nx_[i], ny_[i], nz_[i]);
+    }
+    std::vector<Type> scalars(sc_.begin(), sc_.end());
+    if (has_normals_ && has_scalars_) return vgl_pointset_3d<Type>(std::move(pts), std::move(normals), std::move(scalars));
+    if (has_normals_) return vgl_pointset_3d<Type>(std::move(pts), std::move(normals));
+    if (has_scalars_) return vgl_pointset_3d<Type>(std::move(pts), std::move(scalars));
+    return vgl_pointset_3d<Type>(std::move(pts));
+  }
+
+ private:
+  void push_point(vgl_point_3d<Type> const& p) { x_.push_back(p.x()); y_.push_back(p.y()); z_.push_back(p.z()); }
+  void push_normal(vgl_vector_3d<Type> const& v) { nx_.push_back(v.x()); ny_.push_back(v.y()); nz_.push_back(v.z()); }
+  void drop_normals() { nx_.clear(); ny_.clear(); nz_.clear(); has_normals_ = false; }
+  void drop_scalars() { sc_.clear(); has_scalars_ = false; }
+  //: points added before the first normal get a zero normal
+  void start_normals()
+  {
+    if (has_normals_) return;
+    nx_.assign(size(), Type(0)); ny_.assign(size(), Type(0)); nz_.assign(size(), Type(0));
+    has_normals_ = true;
+  }
+  //: points added before the first scalar get scalar 0
+  void start_scalars()
+  {
+    if (has_scalars_) return;
+    sc_.assign(size(), Type(0));
+    has_scalars_ = true;
+  }
+};
+
+#endif // vgl_pointset_3d_soa_h_
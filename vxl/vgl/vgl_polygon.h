@@ -13,23 +13,26 @@
 //   Nov.2003 - Peter Vanroose - made vgl_polygon a templated class and added lost of documentation
 //   Nov.2003 - Peter Vanroose - added constructor (to replace new_polygon from test_driver)
 //   May.2009 - Matt Leotta - added a function to find self-intersections
+//   Oct.2026 - vgl_selfintersections tests only edges sharing a grid cell
+//   Oct.2026 - exact orientation signs in vgl_selfintersections and vgl_polygon_sheet_is_counter_clockwise
 // \endverbatim
 
 #include <iosfwd>
 #include <utility>
 #include <vector>
 #include <iostream>
-#include <set>
 #include <cmath>
 #include <algorithm>
 #include <numeric>
 #include <string>
 #include <cassert>
+#include <limits>
 
 #include "vgl_point_2d.h" // needed for std::vector instantiations
 #include "vgl_intersection.h"
 #include "vgl_line_2d.h"
 #include "vgl_tolerance.h"
+#include "vgl_predicates.h"
 
 
 //#include <vnl/vnl_math.h>
@@ -85,6 +88,9 @@ class vgl_polygon
   // Copy constructor
   vgl_polygon(vgl_polygon const& a) : sheets_(a.sheets_) {}
 
+  // Copy assignment
+  vgl_polygon& operator=(vgl_polygon const&) = default;
+
   // Destructor
   ~vgl_polygon() = default;
 
@@ -387,6 +393,11 @@ vgl_polygon_sheet_as_array<T>::~vgl_polygon_sheet_as_array()
 // involved in the k-th intersection.  Similarly, e2[k] indexes the other
 // edge involved in the k-th intersection.  The corresponding intersection
 // point is returned in ip[k].
+//
+// Only edges sharing a cell of a uniform grid are tested, each edge being
+// entered in the cells within tolerance of it.  The candidate pairs are
+// sorted into the order in which the former all-pairs loop met them, so
+// the result is the same.
 template <class T>
 void vgl_selfintersections(vgl_polygon<T> const& p,
                            std::vector<std::pair<unsigned int,unsigned int> >& e1,
@@ -394,102 +405,193 @@ void vgl_selfintersections(vgl_polygon<T> const& p,
                            std::vector<vgl_point_2d<T> >& ip)
 {
     const T tol = std::sqrt(vgl_tolerance<T>::position);
-    std::vector<unsigned int> offsets(p.num_sheets()+1,0);
-    for (unsigned int s = 0; s < p.num_sheets(); ++s) {
-        offsets[s+1] = offsets[s]+(unsigned int)(p[s].size());
-    }
     e1.clear();
     e2.clear();
     ip.clear();
     
-    typedef std::pair<unsigned int, unsigned int> upair;
-    std::set<upair> isect_set;
-    for (unsigned int s1 = 0; s1 < p.num_sheets(); ++s1)
-    {
-        const typename vgl_polygon<T>::sheet_t& sheet1 = p[s1];
-        if (sheet1.size() < 2)
-            continue;
-        for (unsigned int i1=(unsigned int)(sheet1.size()-1), i1n=0; i1n < sheet1.size(); i1=i1n, ++i1n)
-        {
-            const vgl_point_2d<T>& v1 = sheet1[i1];
-            const vgl_point_2d<T>& v2 = sheet1[i1n];
-            // coefficients for linear equation for testing intersections
-            // for (x,y) if cx*x+cy*y+c changes sign then we have intersection
-            T cx = v1.y()-v2.y();
-            T cy = v2.x()-v1.x();
-            T c = v1.x()*v2.y()-v2.x()*v1.y();
-            T norm = 1/std::sqrt(cx*cx+cy*cy);
-            cx *= norm;
-            cy *= norm;
-            c *= norm;
-            
-            unsigned int idx1 = offsets[s1]+i1;
+    // edge offsets[s]+i is edge (i,i+1) of sheet s
+    const unsigned int ns = p.num_sheets();
+    std::vector<unsigned int> offsets(ns+1,0);
+    for (unsigned int s = 0; s < ns; ++s) {
+        offsets[s+1] = offsets[s]+(p[s].size() < 2 ? 0 : (unsigned int)(p[s].size()));
+    }
+    const unsigned int n = offsets[ns];
+    if (n == 0)
+        return;
+    std::vector<unsigned int> sheet_of(n);
+    for (unsigned int s = 0; s < ns; ++s)
+        std::fill(sheet_of.begin()+offsets[s], sheet_of.begin()+offsets[s+1], s);
+    
+    // coefficients for linear equation for testing intersections
+    // for (x,y) if cx*x+cy*y+c changes sign then we have intersection
+    std::vector<T> cx(n), cy(n), c(n);
+    std::vector<double> box(4*n); // min x, min y, max x, max y
+    double len = 0;
+    for (unsigned int s = 0; s < ns; ++s) {
+        const typename vgl_polygon<T>::sheet_t& sheet = p[s];
+        const unsigned int m = offsets[s+1]-offsets[s];
+        for (unsigned int i = 0, e = offsets[s]; i < m; ++i, ++e) {
+            const vgl_point_2d<T>& v1 = sheet[i];
+            const vgl_point_2d<T>& v2 = sheet[(i+1)%m];
+            cx[e] = v1.y()-v2.y();
+            cy[e] = v2.x()-v1.x();
+            c[e] = v1.x()*v2.y()-v2.x()*v1.y();
+            T norm = 1/std::sqrt(cx[e]*cx[e]+cy[e]*cy[e]);
+            cx[e] *= norm;
+            cy[e] *= norm;
+            c[e] *= norm;
             
-            // inner loop - compare against self
-            for (unsigned int s2 = 0; s2 < p.num_sheets(); ++s2)
-            {
-                const typename vgl_polygon<T>::sheet_t& sheet2 = p[s2];
-                const unsigned int size2 = (unsigned int)(sheet2.size());
-                if (size2 < 2)
-                    continue;
-                unsigned int start = 0, end = 0;
-                if (s1 == s2) {
-                    start = (i1n+1)%size2;
-                    end = (i1+size2-1)%size2;
+            double* b = &box[4*e];
+            b[0] = std::min(double(v1.x()), double(v2.x())); b[2] = std::max(double(v1.x()), double(v2.x()));
+            b[1] = std::min(double(v1.y()), double(v2.y())); b[3] = std::max(double(v1.y()), double(v2.y()));
+            len += std::max(b[2]-b[0], b[3]-b[1]);
+        }
+    }
+    double min_x = box[0], min_y = box[1], max_x = box[2], max_y = box[3];
+    for (unsigned int e = 1; e < n; ++e) {
+        min_x = std::min(min_x, box[4*e]);   min_y = std::min(min_y, box[4*e+1]);
+        max_x = std::max(max_x, box[4*e+2]); max_y = std::max(max_y, box[4*e+3]);
+    }
+    
+    // Edges further apart than tol cannot intersect; the margin adds rounding slack
+    const double scale = std::max(std::max(std::abs(min_x), std::abs(max_x)),
+                                  std::max(std::abs(min_y), std::abs(max_y)));
+    const double margin = 2*double(tol) + 64*std::numeric_limits<double>::epsilon()*scale;
+    
+    // cells about as large as an average edge, but not many more than edges
+    double h = std::max(len/n, std::sqrt((max_x-min_x)*(max_y-min_y)/n));
+    if (!(h > 0)) h = 1;
+    unsigned int cols = 1, rows = 1;
+    while (true) {
+        const double nc = std::floor((max_x-min_x)/h)+1, nr = std::floor((max_y-min_y)/h)+1;
+        if (nc*nr <= 4.0*n+16) { cols = (unsigned int)nc; rows = (unsigned int)nr; break; }
+        h *= 2;
+    }
+    auto cell_x = [&](double x) {
+        const double f = std::floor((x-min_x)/h);
+        return f < 0 ? 0u : f >= cols ? cols-1 : (unsigned int)f;
+    };
+    auto cell_y = [&](double y) {
+        const double f = std::floor((y-min_y)/h);
+        return f < 0 ? 0u : f >= rows ? rows-1 : (unsigned int)f;
+    };
+    
+    // Enter each edge in the cells within margin of it: in each row of cells,
+    // the columns spanned by the part of the edge in that row.  The first
+    // pass counts, the second fills the cells back to front.
+    std::vector<unsigned int> cell_start(rows*cols+1, 0), cell_edges;
+    for (int pass = 0; pass < 2; ++pass) {
+        for (unsigned int e = 0; e < n; ++e) {
+            const unsigned int s = sheet_of[e], m = offsets[s+1]-offsets[s], i = e-offsets[s];
+            double x0 = double(p[s][i].x()), y0 = double(p[s][i].y());
+            double x1 = double(p[s][(i+1)%m].x()), y1 = double(p[s][(i+1)%m].y());
+            if (y0 > y1) { std::swap(x0,x1); std::swap(y0,y1); }
+            for (unsigned int r = cell_y(y0-margin), r1 = cell_y(y1+margin); r <= r1; ++r) {
+                double xa = std::min(x0,x1), xb = std::max(x0,x1);
+                if (y1 > y0) {
+                    const double t0 = ((min_y+r*h-margin)-y0)/(y1-y0);
+                    const double t1 = ((min_y+(r+1)*h+margin)-y0)/(y1-y0);
+                    xa = x0+std::max(0.0,t0)*(x1-x0);
+                    xb = x0+std::min(1.0,t1)*(x1-x0);
+                    if (xa > xb) std::swap(xa,xb);
                 }
-                
-                T dist = cx*sheet2[start].x()+cy*sheet2[start].y()+c;
-                bool last_sign = dist > 0;
-                bool last_zero = std::abs(dist) <= tol;
-                bool first = true;
-                for (unsigned int i2=start, i2n=(start+1)%size2; i2!=end || first; i2=i2n, i2n=(i2n+1)%size2)
-                {
-                    const vgl_point_2d<T>& v3 = sheet2[i2];
-                    const vgl_point_2d<T>& v4 = sheet2[i2n];
-                    dist = cx*v4.x()+cy*v4.y()+c;
-                    bool sign = dist > 0;
-                    bool zero = std::abs(dist) <= tol;
-                    if (sign != last_sign || zero || last_zero)
-                    {
-                        unsigned int idx2 = offsets[s2]+i2;
-                        upair pair_idx(idx1,idx2);
-                        if (pair_idx.first > pair_idx.second) {
-                            pair_idx = upair(idx2,idx1);
-                        }
-                        std::set<upair>::iterator f = isect_set.find(pair_idx);
-                        if (f == isect_set.end())
-                            isect_set.insert(pair_idx);
-                        // use vgl_intersection to verify some degenerate false positives
-                        else if (vgl_intersection(v1,v2,v3,v4,tol)) {
-                            // make intersection point
-                            vgl_point_2d<T> ipt;
-                            if (!vgl_intersection(vgl_line_2d<T>(v1,v2),vgl_line_2d<T>(v3,v4),ipt)
-                                || parallel(v2-v1,v4-v3,tol)) // vgl_intersection test is not accurate enough
-                            {
-                                // use the median point when lines are parallel
-                                vgl_vector_2d<T> dir = v2-v1;
-                                normalize(dir);
-                                T t1 = 0;
-                                T t2 = dot_product(dir,v2-v1);
-                                T t3 = dot_product(dir,v3-v1);
-                                T t4 = dot_product(dir,v4-v1);
-                                T t = t1+t2+t3+t4;
-                                t -= std::min(std::min(t1,t2),std::min(t3,t4));
-                                t -= std::max(std::max(t1,t2),std::max(t3,t4));
-                                t /= 2;
-                                ipt = v1 + t*dir;
-                            }
-                            e1.emplace_back(s2,i2);
-                            e2.emplace_back(s1,i1);
-                            ip.push_back(ipt);
-                        }
-                    }
-                    last_sign = sign;
-                    last_zero = zero;
-                    first = false;
+                for (unsigned int q = cell_x(xa-margin), q1 = cell_x(xb+margin); q <= q1; ++q) {
+                    if (pass == 0) ++cell_start[r*cols+q];
+                    else cell_edges[--cell_start[r*cols+q]] = e;
                 }
             }
         }
+        if (pass == 0) {
+            std::partial_sum(cell_start.begin(), cell_start.end(), cell_start.begin());
+            cell_edges.resize(cell_start.back());
+        }
+    }
+    
+    // The former loop took each edge B in turn, in the order (n-1, 0, 1, ..., n-2)
+    // within each sheet, and met every pair {A,B} the second time with A among the
+    // edges after B+1 in its sheet or in any other sheet.  Pack that order in a key.
+    auto order = [&](unsigned int e) {
+        const unsigned int s = sheet_of[e], m = offsets[s+1]-offsets[s];
+        return offsets[s]+(e-offsets[s]+1)%m;
+    };
+    std::vector<unsigned long long> keys;
+    for (unsigned int k = 0; k+1 < cell_start.size(); ++k) {
+        for (unsigned int u = cell_start[k]; u < cell_start[k+1]; ++u) {
+            for (unsigned int v = u+1; v < cell_start[k+1]; ++v) {
+                unsigned int a = cell_edges[u], b = cell_edges[v];
+                if (box[4*a] > box[4*b+2]+margin || box[4*b] > box[4*a+2]+margin ||
+                    box[4*a+1] > box[4*b+3]+margin || box[4*b+1] > box[4*a+3]+margin)
+                    continue;
+                if (order(a) > order(b)) std::swap(a,b);
+                const unsigned int sa = sheet_of[a], sb = sheet_of[b];
+                const unsigned int ia = a-offsets[sa], ib = b-offsets[sb];
+                unsigned int pos = ia;
+                if (sa == sb) {
+                    // adjacent edges are not tested, except in a triangle,
+                    // where the former loop went round the whole sheet
+                    const unsigned int m = offsets[sb+1]-offsets[sb];
+                    if (m != 3 && ((ia+1)%m == ib || (ib+1)%m == ia))
+                        continue;
+                    pos = (ia+2*m-ib-2)%m;
+                }
+                keys.push_back((static_cast<unsigned long long>(order(b)) << 32) | (offsets[sa]+pos));
+            }
+        }
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    
+    for (unsigned long long key : keys)
+    {
+        const unsigned int ob = (unsigned int)(key >> 32), pa = (unsigned int)(key & 0xffffffffu);
+        const unsigned int s1 = sheet_of[ob], m1 = offsets[s1+1]-offsets[s1];
+        const unsigned int i1 = (ob-offsets[s1]+m1-1)%m1;
+        const unsigned int s2 = sheet_of[pa], m2 = offsets[s2+1]-offsets[s2];
+        const unsigned int i2 = s1 == s2 ? (pa-offsets[s2]+i1+2)%m2 : pa-offsets[s2];
+        const unsigned int b = offsets[s1]+i1, a = offsets[s2]+i2;
+        const vgl_point_2d<T>& v1 = p[s1][i1];
+        const vgl_point_2d<T>& v2 = p[s1][(i1+1)%m1];
+        const vgl_point_2d<T>& v3 = p[s2][i2];
+        const vgl_point_2d<T>& v4 = p[s2][(i2+1)%m2];
+        
+        // the line of each edge must separate the ends of the other, or pass within tol of one;
+        // which side an end is on is decided exactly, the distances only for the tolerance
+        const bool side3 = vgl_orient_2d(v1,v2,v3) > 0, side4 = vgl_orient_2d(v1,v2,v4) > 0;
+        if (side3 == side4) {
+            T d3 = cx[b]*v3.x()+cy[b]*v3.y()+c[b], d4 = cx[b]*v4.x()+cy[b]*v4.y()+c[b];
+            if (!(std::abs(d3) <= tol || std::abs(d4) <= tol))
+                continue;
+        }
+        const bool side1 = vgl_orient_2d(v3,v4,v1) > 0, side2 = vgl_orient_2d(v3,v4,v2) > 0;
+        if (side1 == side2) {
+            T d1 = cx[a]*v1.x()+cy[a]*v1.y()+c[a], d2 = cx[a]*v2.x()+cy[a]*v2.y()+c[a];
+            if (!(std::abs(d1) <= tol || std::abs(d2) <= tol))
+                continue;
+        }
+        // use vgl_intersection to verify some degenerate false positives
+        if (!vgl_intersection(v1,v2,v3,v4,tol))
+            continue;
+        // make intersection point
+        vgl_point_2d<T> ipt;
+        if (!vgl_intersection(vgl_line_2d<T>(v1,v2),vgl_line_2d<T>(v3,v4),ipt)
+            || parallel(v2-v1,v4-v3,tol)) // vgl_intersection test is not accurate enough
+        {
+            // use the median point when lines are parallel
+            vgl_vector_2d<T> dir = v2-v1;
+            normalize(dir);
+            T t1 = 0;
+            T t2 = dot_product(dir,v2-v1);
+            T t3 = dot_product(dir,v3-v1);
+            T t4 = dot_product(dir,v4-v1);
+            T t = t1+t2+t3+t4;
+            t -= std::min(std::min(t1,t2),std::min(t3,t4));
+            t -= std::max(std::max(t1,t2),std::max(t3,t4));
+            t /= 2;
+            ipt = v1 + t*dir;
+        }
+        e1.emplace_back(s2,i2);
+        e2.emplace_back(s1,i1);
+        ip.push_back(ipt);
     }
 }
 
@@ -532,24 +634,8 @@ vgl_polygon<T> vgl_reorient_polygon(vgl_polygon<T> const &p)
 template <class T>
 bool vgl_polygon_sheet_is_counter_clockwise(std::vector<vgl_point_2d<T> > verts)
 {
-    double sum = 0.0;
-    vgl_point_2d<T> v1;
-    vgl_point_2d<T> v2;
-    double term1, term2;
-    for(size_t x = 1; x <verts.size(); x++)
-    {
-        v1 = verts.at(x-1);
-        v2 = verts.at(x);
-        term1 = double(v2.x())-double(v1.x());
-        term2 = double(v2.y())+double(v1.y());
-        sum += term1*term2;
-    }
-    v1 = verts.at(verts.size()-1);
-    v2 = verts.at(0);
-    term1 = double(v2.x())-double(v1.x());
-    term2 = double(v2.y())+double(v1.y());
-    sum += term1*term2;
-    return sum < 0.0;
+    // exact sign of the signed area
+    return vgl_orient_2d(verts) > 0.0;
 }
 
 #endif // vgl_polygon_h_
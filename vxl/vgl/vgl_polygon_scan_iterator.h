@@ -0,0 +1,362 @@
+// This is core/vgl/vgl_polygon_scan_iterator.h
+#ifndef vgl_polygon_scan_iterator_h_
+#define vgl_polygon_scan_iterator_h_
+//:
+// \file
+// \brief Scan conversion of a vgl_polygon into spans of pixels
+//
+//  vgl_polygon_scan_iterator visits the pixels covered by a polygon, row by
+//  row and span by span, with an active edge table: the edges are sorted once
+//  by their lowest point, and each scan line only looks at the edges crossing
+//  its row, so the cost is that of the sort plus the crossings and the spans.
+//  All sheets of the polygon are scanned together, under the even-odd or the
+//  non-zero winding rule.
+//
+//  Pixel (x,y) is the unit square centred on (x,y).  Without boundary, a
+//  pixel is covered if its centre is inside (a centre on a left or lower edge
+//  is inside, on a right or upper edge outside, so polygons sharing an edge
+//  share no pixel).  With boundary, a pixel is covered if any point of its
+//  square is inside or on the polygon.
+//
+//  vgl_polygon_scan_spans() hands the spans to a callback,
+//  vgl_polygon_rasterize() sets the covered pixels of a vbl_array_2d, and
+//  vgl_polygon_coverage() writes the covered fraction of each pixel, found
+//  on several scan lines per row with exact horizontal coverage.
+//
+// \verbatim
+//  Modifications
+// \endverbatim
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <cstddef>
+#include <vgl/vgl_polygon.h>
+#include <vgl/vgl_box_2d.h>
+#include <vgl/vgl_region_scan_iterator.h>
+#include <vbl/vbl_array_2d.h>
+
+//: Which points are inside a polygon whose sheets overlap or self-intersect
+enum vgl_fill_rule
+{
+  vgl_fill_rule_even_odd, // crossed by an odd number of boundaries
+  vgl_fill_rule_non_zero  // non-zero winding number
+};
+
+namespace vgl_polygon_scan_detail
+{
+  //: An edge with y0 <= y1; dir is +1 if its sheet runs upwards along it.
+  struct edge
+  {
+    double x0, y0, x1, y1;
+    int dir;
+    bool operator<(edge const& e) const { return y0 < e.y0; }
+  };
+
+  //: The edges of a polygon sorted by lowest point, and those active in a band of rows.
+  class edge_table
+  {
+   public:
+    template <class T>
+    explicit edge_table(vgl_polygon<T> const& face)
+      : min_x(std::numeric_limits<double>::max()), max_x(-std::numeric_limits<double>::max()),
+        min_y(std::numeric_limits<double>::max()), max_y(-std::numeric_limits<double>::max()), next_(0)
+    {
+      for (unsigned int s = 0; s < face.num_sheets(); ++s) {
+        typename vgl_polygon<T>::sheet_t const& sheet = face[s];
+        const std::size_t n = sheet.size();
+        for (std::size_t i = 0; i < n; ++i) {
+          vgl_point_2d<T> const& a = sheet[i];
+          vgl_point_2d<T> const& b = sheet[(i + 1) % n];
+          edge e = { double(a.x()), double(a.y()), double(b.x()), double(b.y()), 1 };
+          if (e.y0 > e.y1) { std::swap(e.x0, e.x1); std::swap(e.y0, e.y1); e.dir = -1; }
+          edges_.push_back(e);
+          min_x = std::min(min_x, double(a.x())); max_x = std::max(max_x, double(a.x()));
+          min_y = std::min(min_y, double(a.y())); max_y = std::max(max_y, double(a.y()));
+        }
+      }
+      std::stable_sort(edges_.begin(), edges_.end());
+    }
+
+    //: bounding box of the vertices (empty if min > max)
+    double min_x, max_x, min_y, max_y;
+
+    void reset() { next_ = 0; active_.clear(); }
+
+    //: Make the active edges those meeting rows [lo, hi]; lo and hi may not decrease between calls.
+    void advance(double lo, double hi)
+    {
+      while (next_ < edges_.size() && edges_[next_].y0 <= hi)
+        active_.push_back(next_++);
+      std::size_t k = 0;
+      for (std::size_t a = 0; a < active_.size(); ++a)
+        if (!(edges_[active_[a]].y1 < lo))
+          active_[k++] = active_[a];
+      active_.resize(k);
+    }
+
+    //: The intervals [iv[2i], iv[2i+1]] of scan line y inside the polygon, left to right.
+    //  An edge crosses the scan line if y0 <= y < y1.
+    void intervals(double y, vgl_fill_rule rule, std::vector<double>& iv)
+    {
+      xs_.clear();
+      for (std::size_t a = 0; a < active_.size(); ++a) {
+        edge const& e = edges_[active_[a]];
+        if (e.y0 <= y && y < e.y1)
+          xs_.push_back(std::make_pair(e.x0 + (y - e.y0) * (e.x1 - e.x0) / (e.y1 - e.y0), e.dir));
+      }
+      std::sort(xs_.begin(), xs_.end());
+      iv.clear();
+      int w = 0;
+      for (std::size_t i = 0; i < xs_.size(); ++i) {
+        const int before = w;
+        w = rule == vgl_fill_rule_even_odd ? 1 - w : w + xs_[i].second;
+        if ((before == 0) != (w == 0))
+          iv.push_back(xs_[i].first);
+      }
+    }
+
+    //: The x ranges [ex[2i], ex[2i+1]] of the active edges within rows [lo, hi].
+    void extents(double lo, double hi, std::vector<double>& ex) const
+    {
+      ex.clear();
+      for (std::size_t a = 0; a < active_.size(); ++a) {
+        edge const& e = edges_[active_[a]];
+        if (e.y1 < lo || e.y0 > hi)
+          continue;
+        double xa = e.x0, xb = e.x1;
+        if (e.y1 > e.y0) {
+          const double s = (e.x1 - e.x0) / (e.y1 - e.y0);
+          if (e.y0 < lo) xa = e.x0 + (lo - e.y0) * s;
+          if (e.y1 > hi) xb = e.x0 + (hi - e.y0) * s;
+        }
+        ex.push_back(std::min(xa, xb));
+        ex.push_back(std::max(xa, xb));
+      }
+    }
+
+   private:
+    std::vector<edge> edges_;
+    std::size_t next_;
+    std::vector<std::size_t> active_;
+    std::vector<std::pair<double, int> > xs_;
+  };
+}
+
+//: Iterates over the pixels of a polygon, span by span.
+//  \relatesalso vgl_polygon
+template <class T>
+class vgl_polygon_scan_iterator : public vgl_region_scan_iterator
+{
+ public:
+  //: Scan face.  boundaryp: also include the pixels touched by the boundary.
+  explicit vgl_polygon_scan_iterator(vgl_polygon<T> const& face, bool boundaryp = true,
+                                     vgl_fill_rule rule = vgl_fill_rule_even_odd);
+
+  //: Scan the part of face in the pixels with centres in window.
+  vgl_polygon_scan_iterator(vgl_polygon<T> const& face, bool boundaryp, vgl_box_2d<T> const& window,
+                            vgl_fill_rule rule = vgl_fill_rule_even_odd);
+
+  void reset() override;
+  bool next() override;
+  int scany() const override { return y_; }
+  int startx() const override { return spans_[2 * cur_]; }
+  int endx() const override { return spans_[2 * cur_ + 1]; }
+
+ private:
+  void init(double wx0, double wx1, double wy0, double wy1);
+  //: compute spans_ for row y_
+  void scan_row();
+  //: clamp to the columns in the window
+  int clamp_x(double x) const { return int(std::max(double(x0_) - 1, std::min(double(x1_) + 1, x))); }
+
+  vgl_polygon_scan_detail::edge_table table_;
+  bool boundary_;
+  vgl_fill_rule rule_;
+  int x0_, x1_, y0_, y1_;   // columns and rows to scan
+  int y_;
+  std::vector<int> spans_;  // first and last column of each span of row y_
+  std::size_t cur_, done_;  // current span; spans of the row returned
+  std::vector<double> iv_, ex_;
+  std::vector<std::pair<int, int> > runs_;
+};
+
+// implementation
+template <class T>
+vgl_polygon_scan_iterator<T>::vgl_polygon_scan_iterator(vgl_polygon<T> const& face, bool boundaryp,
+                                                        vgl_fill_rule rule)
+  : table_(face), boundary_(boundaryp), rule_(rule)
+{
+  const double big = double(std::numeric_limits<int>::max() / 2);
+  init(-big, big, -big, big);
+}
+
+template <class T>
+vgl_polygon_scan_iterator<T>::vgl_polygon_scan_iterator(vgl_polygon<T> const& face, bool boundaryp,
+                                                        vgl_box_2d<T> const& window, vgl_fill_rule rule)
+  : table_(face), boundary_(boundaryp), rule_(rule)
+{
+  if (window.is_empty())
+    init(1, 0, 1, 0);
+  else
+    init(double(window.min_x()), double(window.max_x()), double(window.min_y()), double(window.max_y()));
+}
+
+template <class T>
+void vgl_polygon_scan_iterator<T>::init(double wx0, double wx1, double wy0, double wy1)
+{
+  const double grow = boundary_ ? 0.5 : 0.0;
+  x0_ = int(std::ceil(wx0));
+  x1_ = int(std::floor(wx1));
+  y0_ = int(std::ceil(std::max(wy0, table_.min_y - grow)));
+  y1_ = int(std::floor(std::min(wy1, table_.max_y + grow)));
+  if (!(table_.min_y <= table_.max_y) || x0_ > x1_)
+    y1_ = y0_ - 1;
+  reset();
+}
+
+template <class T>
+void vgl_polygon_scan_iterator<T>::reset()
+{
+  table_.reset();
+  y_ = y0_ - 1;
+  spans_.clear();
+  cur_ = done_ = 0;
+}
+
+template <class T>
+bool vgl_polygon_scan_iterator<T>::next()
+{
+  while (2 * done_ >= spans_.size()) {
+    if (y_ >= y1_)
+      return false;
+    ++y_;
+    scan_row();
+    done_ = 0;
+  }
+  cur_ = done_++;
+  return true;
+}
+
+template <class T>
+void vgl_polygon_scan_iterator<T>::scan_row()
+{
+  const double y = y_;
+  runs_.clear();
+  if (boundary_) {
+    // centres inside or on the boundary, and the squares the boundary passes through
+    table_.advance(y - 0.5, y + 0.5);
+    table_.intervals(y, rule_, iv_);
+    for (std::size_t i = 0; i < iv_.size(); i += 2)
+      runs_.push_back(std::make_pair(clamp_x(std::ceil(iv_[i])), clamp_x(std::floor(iv_[i + 1]))));
+    table_.extents(y - 0.5, y + 0.5, ex_);
+    for (std::size_t i = 0; i < ex_.size(); i += 2)
+      runs_.push_back(std::make_pair(clamp_x(std::ceil(ex_[i] - 0.5)), clamp_x(std::floor(ex_[i + 1] + 0.5))));
+    std::sort(runs_.begin(), runs_.end());
+  }
+  else {
+    // centres in [left, right) of each interval; the intervals come sorted
+    table_.advance(y, y);
+    table_.intervals(y, rule_, iv_);
+    for (std::size_t i = 0; i < iv_.size(); i += 2)
+      runs_.push_back(std::make_pair(clamp_x(std::ceil(iv_[i])), clamp_x(std::ceil(iv_[i + 1])) - 1));
+  }
+  // clip to the window, and merge overlapping or adjacent runs
+  spans_.clear();
+  for (std::size_t i = 0; i < runs_.size(); ++i) {
+    const int a = std::max(runs_[i].first, x0_), b = std::min(runs_[i].second, x1_);
+    if (a > b)
+      continue;
+    if (!spans_.empty() && a <= spans_.back() + 1)
+      spans_.back() = std::max(spans_.back(), b);
+    else {
+      spans_.push_back(a);
+      spans_.push_back(b);
+    }
+  }
+}
+
+//: Call f(y, x0, x1) for each span of pixels (x0 .. x1 inclusive, in row y) of face.
+//  \relatesalso vgl_polygon
+template <class T, class F>
+void vgl_polygon_scan_spans(vgl_polygon<T> const& face, F f, bool boundaryp = true,
+                            vgl_fill_rule rule = vgl_fill_rule_even_odd)
+{
+  vgl_polygon_scan_iterator<T> it(face, boundaryp, rule);
+  while (it.next())
+    f(it.scany(), it.startx(), it.endx());
+}
+
+//: Set image(y, x) to value for each pixel (x,y) of image covered by face.
+//  Other pixels are left unchanged.
+//  \relatesalso vgl_polygon
+template <class T, class P>
+void vgl_polygon_rasterize(vgl_polygon<T> const& face, vbl_array_2d<P>& image, P const& value,
+                           bool boundaryp = true, vgl_fill_rule rule = vgl_fill_rule_even_odd)
+{
+  if (image.rows() == 0 || image.cols() == 0)
+    return;
+  vgl_box_2d<T> window(T(0), T(image.cols() - 1), T(0), T(image.rows() - 1));
+  vgl_polygon_scan_iterator<T> it(face, boundaryp, window, rule);
+  while (it.next()) {
+    P* row = image[it.scany()];
+    std::fill(row + it.startx(), row + it.endx() + 1, value);
+  }
+}
+
+//: Set coverage(y, x) to the fraction of pixel (x,y) covered by face, for each pixel it meets.
+//  The fraction is measured exactly along subsamples scan lines per row.
+//  Pixels face does not meet are left unchanged.
+//  \relatesalso vgl_polygon
+template <class T, class C>
+void vgl_polygon_coverage(vgl_polygon<T> const& face, vbl_array_2d<C>& coverage, unsigned subsamples = 4,
+                          vgl_fill_rule rule = vgl_fill_rule_even_odd)
+{
+  vgl_polygon_scan_detail::edge_table table(face);
+  const int cols = int(coverage.cols()), rows = int(coverage.rows());
+  if (cols == 0 || rows == 0 || subsamples == 0 || !(table.min_y <= table.max_y))
+    return;
+  const double w = 1.0 / subsamples;
+  const int j0 = int(std::max(0.0, std::ceil(table.min_y - 0.5)));
+  const int j1 = int(std::min(double(rows - 1), std::floor(table.max_y + 0.5)));
+  // per row: partial coverage of the end pixels of each interval, and
+  // the number of scan lines crossing the others, as differences
+  std::vector<double> part(cols, 0.0), iv;
+  std::vector<int> full(cols + 1, 0);
+  for (int j = j0; j <= j1; ++j) {
+    table.advance(j - 0.5, j + 0.5);
+    int lo = cols, hi = -1;
+    for (unsigned s = 0; s < subsamples; ++s) {
+      table.intervals(j - 0.5 + (s + 0.5) * w, rule, iv);
+      for (std::size_t i = 0; i < iv.size(); i += 2) {
+        const double xl = std::max(iv[i], -0.5), xr = std::min(iv[i + 1], cols - 0.5);
+        if (!(xl < xr))
+          continue;
+        const int c0 = int(std::floor(xl + 0.5)), c1 = std::min(cols - 1, int(std::floor(xr + 0.5)));
+        if (c0 == c1)
+          part[c0] += (xr - xl) * w;
+        else {
+          part[c0] += (c0 + 0.5 - xl) * w;
+          part[c1] += (xr - c1 + 0.5) * w;
+          ++full[c0 + 1];
+          --full[c1];
+        }
+        lo = std::min(lo, c0);
+        hi = std::max(hi, c1);
+      }
+    }
+    int n = 0;
+    for (int c = lo; c <= hi; ++c) {
+      n += full[c];
+      const double v = n * w + part[c];
+      if (v > 0)
+        coverage(j, c) = C(std::min(1.0, v));
+      full[c] = 0;
+      part[c] = 0;
+    }
+  }
+}
+
+#endif // vgl_polygon_scan_iterator_h_
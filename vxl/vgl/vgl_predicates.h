@@ -0,0 +1,494 @@
+// This is core/vgl/vgl_predicates.h
+#ifndef vgl_predicates_h_
+#define vgl_predicates_h_
+//:
+// \file
+// \brief Geometric predicates with exact signs
+//
+//  vgl_orient_2d(a, b, c) is twice the signed area of the triangle a, b, c:
+//  positive if the points are in counterclockwise order, negative if
+//  clockwise and zero if they are collinear.  vgl_orient_3d(a, b, c, d) is
+//  six times the signed volume of the tetrahedron a, b, c, d: positive if d
+//  lies below the plane of a, b, c, seen from above which a, b, c are
+//  counterclockwise.  vgl_incircle(a, b, c, d), for counterclockwise a, b, c,
+//  is positive if d lies inside their circumcircle, and vgl_insphere(a, b, c,
+//  d, e), for positively oriented a, b, c, d, if e lies inside their
+//  circumsphere.  Both are zero for cocircular or cospherical points.
+//
+//  The signs are always exact for double input.  Each predicate follows the
+//  staged evaluation of J.R. Shewchuk, "Adaptive precision floating-point
+//  arithmetic and fast robust geometric predicates" (1997):
+//  - A: the determinant in double, accepted if it exceeds a bound on its
+//    rounding error, which is the case for all but nearly degenerate input;
+//  - B: the determinant of the rounded coordinate differences, exactly, as an
+//    expansion (a sum of non-overlapping doubles); exact if the differences
+//    were, otherwise accepted if it exceeds a smaller bound;
+//  - C (not for vgl_insphere): B corrected by the first-order terms of the
+//    rounding errors of the differences, against a still smaller bound;
+//  - D: the determinant exactly.
+//  The expansions live in fixed-size arrays on the stack; the largest, in
+//  stage D of vgl_insphere, take about 100 kB.  Products are split with fma.
+//  The value returned by a stage is the sum of its expansion, or its most
+//  significant component in stage D; either has the sign of the result.
+//
+// \verbatim
+//  Modifications
+// \endverbatim
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <vgl/vgl_point_2d.h>
+#include <vgl/vgl_point_3d.h>
+
+namespace vgl_predicates_detail
+{
+//: the unit roundoff of double, 2^-53
+constexpr double epsilon = 1.1102230246251565e-16;
+
+//: x + y = a * b exactly, x the rounded product
+inline void two_product(double a, double b, double& x, double& y)
+{
+  x = a * b;
+  y = std::fma(a, b, -x);
+}
+
+//: x + y = a + b exactly, x the rounded sum
+inline void two_sum(double a, double b, double& x, double& y)
+{
+  x = a + b;
+  const double bv = x - a, av = x - bv;
+  y = (a - av) + (b - bv);
+}
+
+//: the rounding error of x = a - b
+inline double diff_tail(double a, double b, double x)
+{
+  const double bv = a - x, av = x + bv;
+  return (a - av) + (bv - b);
+}
+
+//: h = e + f, for expansions of increasing magnitude; returns the length of h, at most elen + flen.
+//  Zero components are dropped, but h has at least one component.
+inline int sum(int elen, double const* e, int flen, double const* f, double* h)
+{
+  // merge by magnitude, carrying the running sum up
+  int i = 0, j = 0, n = 0;
+  double q = 0.0, hh;
+  while (i < elen || j < flen) {
+    const double g = j == flen || (i < elen && std::fabs(e[i]) < std::fabs(f[j])) ? e[i++] : f[j++];
+    two_sum(q, g, q, hh);
+    if (hh != 0.0) h[n++] = hh;
+  }
+  if (q != 0.0 || n == 0) h[n++] = q;
+  return n;
+}
+
+//: h = b e; returns the length of h, at most 2 elen.
+inline int scale(int elen, double const* e, double b, double* h)
+{
+  int n = 0;
+  double q, hh, p1, p0, s;
+  two_product(e[0], b, q, hh);
+  if (hh != 0.0) h[n++] = hh;
+  for (int i = 1; i < elen; ++i) {
+    two_product(e[i], b, p1, p0);
+    two_sum(q, p0, s, hh);
+    if (hh != 0.0) h[n++] = hh;
+    two_sum(p1, s, q, hh);
+    if (hh != 0.0) h[n++] = hh;
+  }
+  if (q != 0.0 || n == 0) h[n++] = q;
+  return n;
+}
+
+//: h = e f, where e has at most E components and h room for N; returns the length of h.
+template <int E, int N>
+int product(int elen, double const* e, int flen, double const* f, double* h)
+{
+  double t[2 * E], u[N];
+  int n = scale(elen, e, f[0], h);
+  for (int j = 1; j < flen; ++j) {
+    const int m = scale(elen, e, f[j], t);
+    n = sum(n, h, m, t, u);
+    std::copy(u, u + n, h);
+  }
+  return n;
+}
+
+//: h = ax by - ay bx; returns the length of h, at most 4.
+inline int cross(double ax, double ay, double bx, double by, double* h)
+{
+  double l[2], r[2];
+  two_product(ax, by, l[1], l[0]);
+  two_product(-ay, bx, r[1], r[0]);
+  return sum(2, l, 2, r, h);
+}
+
+//: h = x^2 + y^2; returns the length of h, at most 4.
+inline int lift(double x, double y, double* h)
+{
+  double a[2], b[2];
+  two_product(x, x, a[1], a[0]);
+  two_product(y, y, b[1], b[0]);
+  return sum(2, a, 2, b, h);
+}
+
+//: h = x^2 + y^2 + z^2; returns the length of h, at most 6.
+inline int lift(double x, double y, double z, double* h)
+{
+  double ab[4], c[2];
+  two_product(z, z, c[1], c[0]);
+  return sum(lift(x, y, ab), ab, 2, c, h);
+}
+
+//: e = -e; returns n
+inline int negate(int n, double* e)
+{
+  for (int i = 0; i < n; ++i)
+    e[i] = -e[i];
+  return n;
+}
+
+//: the sum of the components of e, with the sign of e
+inline double estimate(int n, double const* e)
+{
+  double q = e[0];
+  for (int i = 1; i < n; ++i)
+    q += e[i];
+  return q;
+}
+
+//: h = |px py 1; qx qy 1; rx ry 1| = twice the signed area of p, q, r; at most 12 components.
+inline int det3_2d(double const* p, double const* q, double const* r, double* h)
+{
+  double pq[4], qr[4], rp[4], t[8];
+  const int n1 = cross(p[0], p[1], q[0], q[1], pq);
+  const int n2 = cross(q[0], q[1], r[0], r[1], qr);
+  const int n3 = cross(r[0], r[1], p[0], p[1], rp);
+  return sum(sum(n1, pq, n2, qr, t), t, n3, rp, h);
+}
+
+//: h = |p; q; r| for points p, q, r of 3-space; at most 24 components.
+inline int det3_3d(double const* p, double const* q, double const* r, double* h)
+{
+  double m[4], a[8], b[8], c[8], ab[16];
+  const int na = scale(cross(q[0], q[1], r[0], r[1], m), m, p[2], a);
+  const int nb = scale(cross(r[0], r[1], p[0], p[1], m), m, q[2], b);
+  const int nc = scale(cross(p[0], p[1], q[0], q[1], m), m, r[2], c);
+  return sum(sum(na, a, nb, b, ab), ab, nc, c, h);
+}
+
+//: h = |p 1; q 1; r 1; s 1| for points of 3-space = vgl_orient_3d(p, q, r, s); at most 96 components.
+inline int det4_3d(double const* p, double const* q, double const* r, double const* s, double* h)
+{
+  double a[24], b[24], c[24], d[24], ab[48], cd[48];
+  const int na = det3_3d(p, r, s, a), nb = det3_3d(r, q, s, b);
+  const int nc = det3_3d(q, p, s, c), nd = det3_3d(p, q, r, d);
+  return sum(sum(na, a, nb, b, ab), ab, sum(nc, c, nd, d, cd), cd, h);
+}
+
+//: Stage D of vgl_insphere: |x y z x^2+y^2+z^2 1| expanded along the fourth column.
+//  A function of its own, so that its buffers are only on the stack when needed.
+inline double insphere_exact(double ax, double ay, double az, double bx, double by, double bz,
+                             double cx, double cy, double cz, double dx, double dy, double dz,
+                             double ex, double ey, double ez)
+{
+  const double pa[3] = { ax, ay, az }, pb[3] = { bx, by, bz }, pc[3] = { cx, cy, cz };
+  const double pd[3] = { dx, dy, dz }, pe[3] = { ex, ey, ez };
+  const double* rows[5][4] = { { pc, pb, pd, pe }, { pa, pc, pd, pe }, { pb, pa, pd, pe },
+                               { pa, pb, pc, pe }, { pb, pa, pc, pd } };
+  const double* lifted[5] = { pa, pb, pc, pd, pe };
+  double w[6], m4[96], term[1152], acc[2][5760];
+  int n = 0, cur = 0;
+  for (int r = 0; r < 5; ++r) {
+    const int nw = lift(lifted[r][0], lifted[r][1], lifted[r][2], w);
+    const int nt = product<96, 1152>(det4_3d(rows[r][0], rows[r][1], rows[r][2], rows[r][3], m4), m4, nw, w, term);
+    n = sum(n, acc[cur], nt, term, acc[1 - cur]);
+    cur = 1 - cur;
+  }
+  return acc[cur][n - 1];
+}
+} // namespace vgl_predicates_detail
+
+//: Twice the signed area of triangle (a, b, c), with exact sign.
+inline double vgl_orient_2d(double ax, double ay, double bx, double by, double cx, double cy)
+{
+  using namespace vgl_predicates_detail;
+  const double acx = ax - cx, bcx = bx - cx, acy = ay - cy, bcy = by - cy;
+  const double l = acx * bcy, r = acy * bcx;
+  double det = l - r;
+  const double permanent = std::fabs(l) + std::fabs(r);
+  double bound = (3.0 + 16.0 * epsilon) * epsilon * permanent;
+  if (det > bound || -det > bound) return det;
+  if (permanent == 0.0) return 0.0;
+
+  // B: exact for the rounded differences
+  double B[4];
+  const int nb = cross(acx, acy, bcx, bcy, B);
+  det = estimate(nb, B);
+  bound = (2.0 + 12.0 * epsilon) * epsilon * permanent;
+  if (det >= bound || -det >= bound) return det;
+  const double acxt = diff_tail(ax, cx, acx), bcxt = diff_tail(bx, cx, bcx);
+  const double acyt = diff_tail(ay, cy, acy), bcyt = diff_tail(by, cy, bcy);
+  if (acxt == 0.0 && acyt == 0.0 && bcxt == 0.0 && bcyt == 0.0) return det;
+
+  // C: first-order correction
+  bound = (9.0 + 64.0 * epsilon) * epsilon * epsilon * permanent + (3.0 + 8.0 * epsilon) * epsilon * std::fabs(det);
+  det += (acx * bcyt + bcy * acxt) - (acy * bcxt + bcx * acyt);
+  if (det >= bound || -det >= bound) return det;
+
+  // D: add the products with the tails to B
+  double u[4], C1[8], C2[12], D[16];
+  const int n1 = sum(nb, B, cross(acxt, acyt, bcx, bcy, u), u, C1);
+  const int n2 = sum(n1, C1, cross(acx, acy, bcxt, bcyt, u), u, C2);
+  const int n3 = sum(n2, C2, cross(acxt, acyt, bcxt, bcyt, u), u, D);
+  return D[n3 - 1];
+}
+
+template <class T>
+inline double vgl_orient_2d(vgl_point_2d<T> const& a, vgl_point_2d<T> const& b, vgl_point_2d<T> const& c)
+{
+  return vgl_orient_2d(double(a.x()), double(a.y()), double(b.x()), double(b.y()), double(c.x()), double(c.y()));
+}
+
+//: Twice the signed area of the closed polygon with vertices verts, with exact sign.
+//  Positive if the vertices go round counterclockwise.
+template <class T>
+double vgl_orient_2d(std::vector<vgl_point_2d<T> > const& verts)
+{
+  const std::size_t n = verts.size();
+  double sum = 0.0, bound = 0.0;
+  for (std::size_t i = 0, j = n - 1; i < n; j = i++) {
+    const double l = double(verts[j].x()) * double(verts[i].y()), r = double(verts[i].x()) * double(verts[j].y());
+    sum += l - r;
+    bound += std::fabs(l) + std::fabs(r);
+  }
+  // each of the 2n products and 2n sums adds at most eps (1 + eps) times the bound
+  bound *= (2.0 * n + 1.0) * (1.0 + 4.0 * n * vgl_predicates_detail::epsilon) * vgl_predicates_detail::epsilon;
+  if (sum > bound || -sum > bound) return sum;
+  if (bound == 0.0) return 0.0;
+  // exactly, in buffers of 4 n components allocated once
+  std::vector<double> e(4 * n + 1), h(4 * n + 1);
+  int m = 0;
+  for (std::size_t i = 0, j = n - 1; i < n; j = i++) {
+    double c[4];
+    const int k = vgl_predicates_detail::cross(double(verts[j].x()), double(verts[j].y()),
+                                               double(verts[i].x()), double(verts[i].y()), c);
+    m = vgl_predicates_detail::sum(m, e.data(), k, c, h.data());
+    e.swap(h);
+  }
+  return e[m - 1];
+}
+
+//: Six times the signed volume of tetrahedron (a, b, c, d), with exact sign.
+//  Positive if d lies below the plane of a, b, c, seen from above which they are counterclockwise.
+inline double vgl_orient_3d(double ax, double ay, double az, double bx, double by, double bz,
+                            double cx, double cy, double cz, double dx, double dy, double dz)
+{
+  const double adx = ax - dx, bdx = bx - dx, cdx = cx - dx;
+  const double ady = ay - dy, bdy = by - dy, cdy = cy - dy;
+  const double adz = az - dz, bdz = bz - dz, cdz = cz - dz;
+  const double bdxcdy = bdx * cdy, cdxbdy = cdx * bdy;
+  const double cdxady = cdx * ady, adxcdy = adx * cdy;
+  const double adxbdy = adx * bdy, bdxady = bdx * ady;
+  const double det = adz * (bdxcdy - cdxbdy) + bdz * (cdxady - adxcdy) + cdz * (adxbdy - bdxady);
+  const double permanent = (std::fabs(bdxcdy) + std::fabs(cdxbdy)) * std::fabs(adz) +
+                           (std::fabs(cdxady) + std::fabs(adxcdy)) * std::fabs(bdz) +
+                           (std::fabs(adxbdy) + std::fabs(bdxady)) * std::fabs(cdz);
+  using namespace vgl_predicates_detail;
+  const double eps = epsilon;
+  double bound = (7.0 + 56.0 * eps) * eps * permanent;
+  if (det > bound || -det > bound) return det;
+  if (permanent == 0.0) return 0.0;
+
+  // B: exact for the rounded differences
+  double m[4], a[8], b[8], c[8], ab[16], B[24];
+  const int na = scale(cross(bdx, bdy, cdx, cdy, m), m, adz, a);
+  const int nb = scale(cross(cdx, cdy, adx, ady, m), m, bdz, b);
+  const int nc = scale(cross(adx, ady, bdx, bdy, m), m, cdz, c);
+  double exact = estimate(sum(sum(na, a, nb, b, ab), ab, nc, c, B), B);
+  bound = (3.0 + 28.0 * eps) * eps * permanent;
+  if (exact >= bound || -exact >= bound) return exact;
+  const double adxt = diff_tail(ax, dx, adx), bdxt = diff_tail(bx, dx, bdx), cdxt = diff_tail(cx, dx, cdx);
+  const double adyt = diff_tail(ay, dy, ady), bdyt = diff_tail(by, dy, bdy), cdyt = diff_tail(cy, dy, cdy);
+  const double adzt = diff_tail(az, dz, adz), bdzt = diff_tail(bz, dz, bdz), cdzt = diff_tail(cz, dz, cdz);
+  if (adxt == 0.0 && bdxt == 0.0 && cdxt == 0.0 && adyt == 0.0 && bdyt == 0.0 && cdyt == 0.0 &&
+      adzt == 0.0 && bdzt == 0.0 && cdzt == 0.0)
+    return exact;
+
+  // C: first-order correction
+  bound = (26.0 + 288.0 * eps) * eps * eps * permanent + (3.0 + 8.0 * eps) * eps * std::fabs(exact);
+  exact += (adz * ((bdx * cdyt + cdy * bdxt) - (bdy * cdxt + cdx * bdyt)) + adzt * (bdx * cdy - bdy * cdx)) +
+           (bdz * ((cdx * adyt + ady * cdxt) - (cdy * adxt + adx * cdyt)) + bdzt * (cdx * ady - cdy * adx)) +
+           (cdz * ((adx * bdyt + bdy * adxt) - (ady * bdxt + bdx * adyt)) + cdzt * (adx * bdy - ady * bdx));
+  if (exact >= bound || -exact >= bound) return exact;
+
+  // D: from the coordinates
+  const double pa[3] = { ax, ay, az }, pb[3] = { bx, by, bz }, pc[3] = { cx, cy, cz }, pd[3] = { dx, dy, dz };
+  double D[96];
+  return D[det4_3d(pa, pb, pc, pd, D) - 1];
+}
+
+template <class T>
+inline double vgl_orient_3d(vgl_point_3d<T> const& a, vgl_point_3d<T> const& b,
+                            vgl_point_3d<T> const& c, vgl_point_3d<T> const& d)
+{
+  return vgl_orient_3d(double(a.x()), double(a.y()), double(a.z()), double(b.x()), double(b.y()), double(b.z()),
+                       double(c.x()), double(c.y()), double(c.z()), double(d.x()), double(d.y()), double(d.z()));
+}
+
+//: Positive if d lies inside the circle through the counterclockwise a, b, c, with exact sign.
+//  Negative outside, zero on the circle; the sign is reversed if a, b, c are clockwise.
+inline double vgl_incircle(double ax, double ay, double bx, double by, double cx, double cy, double dx, double dy)
+{
+  const double adx = ax - dx, bdx = bx - dx, cdx = cx - dx;
+  const double ady = ay - dy, bdy = by - dy, cdy = cy - dy;
+  const double bdxcdy = bdx * cdy, cdxbdy = cdx * bdy;
+  const double cdxady = cdx * ady, adxcdy = adx * cdy;
+  const double adxbdy = adx * bdy, bdxady = bdx * ady;
+  const double alift = adx * adx + ady * ady, blift = bdx * bdx + bdy * bdy, clift = cdx * cdx + cdy * cdy;
+  const double det = alift * (bdxcdy - cdxbdy) + blift * (cdxady - adxcdy) + clift * (adxbdy - bdxady);
+  const double permanent = (std::fabs(bdxcdy) + std::fabs(cdxbdy)) * alift +
+                           (std::fabs(cdxady) + std::fabs(adxcdy)) * blift +
+                           (std::fabs(adxbdy) + std::fabs(bdxady)) * clift;
+  using namespace vgl_predicates_detail;
+  const double eps = epsilon;
+  double bound = (10.0 + 96.0 * eps) * eps * permanent;
+  if (det > bound || -det > bound) return det;
+  if (permanent == 0.0) return 0.0;
+
+  // B: exact for the rounded differences
+  double m[4], t[8], x[16], y[16], a[32], b[32], c[32], ab[64], B[96];
+  int k = cross(bdx, bdy, cdx, cdy, m);
+  const int na = sum(scale(scale(k, m, adx, t), t, adx, x), x, scale(scale(k, m, ady, t), t, ady, y), y, a);
+  k = cross(cdx, cdy, adx, ady, m);
+  const int nb = sum(scale(scale(k, m, bdx, t), t, bdx, x), x, scale(scale(k, m, bdy, t), t, bdy, y), y, b);
+  k = cross(adx, ady, bdx, bdy, m);
+  const int nc = sum(scale(scale(k, m, cdx, t), t, cdx, x), x, scale(scale(k, m, cdy, t), t, cdy, y), y, c);
+  double exact = estimate(sum(sum(na, a, nb, b, ab), ab, nc, c, B), B);
+  bound = (4.0 + 48.0 * eps) * eps * permanent;
+  if (exact >= bound || -exact >= bound) return exact;
+  const double adxt = diff_tail(ax, dx, adx), bdxt = diff_tail(bx, dx, bdx), cdxt = diff_tail(cx, dx, cdx);
+  const double adyt = diff_tail(ay, dy, ady), bdyt = diff_tail(by, dy, bdy), cdyt = diff_tail(cy, dy, cdy);
+  if (adxt == 0.0 && bdxt == 0.0 && cdxt == 0.0 && adyt == 0.0 && bdyt == 0.0 && cdyt == 0.0)
+    return exact;
+
+  // C: first-order correction
+  bound = (44.0 + 576.0 * eps) * eps * eps * permanent + (3.0 + 8.0 * eps) * eps * std::fabs(exact);
+  exact += (alift * ((bdx * cdyt + cdy * bdxt) - (bdy * cdxt + cdx * bdyt)) +
+            2.0 * (adx * adxt + ady * adyt) * (bdx * cdy - bdy * cdx)) +
+           (blift * ((cdx * adyt + ady * cdxt) - (cdy * adxt + adx * cdyt)) +
+            2.0 * (bdx * bdxt + bdy * bdyt) * (cdx * ady - cdy * adx)) +
+           (clift * ((adx * bdyt + bdy * adxt) - (ady * bdxt + bdx * adyt)) +
+            2.0 * (cdx * cdxt + cdy * cdyt) * (adx * bdy - ady * bdx));
+  if (exact >= bound || -exact >= bound) return exact;
+
+  // D: from the coordinates, |x y x^2+y^2 1| expanded along the third column
+  const double pa[2] = { ax, ay }, pb[2] = { bx, by }, pc[2] = { cx, cy }, pd[2] = { dx, dy };
+  double w[4], m3[12], d[4][96], h[2][192], D[384];
+  const double* rows[4][3] = { { pb, pc, pd }, { pc, pa, pd }, { pa, pb, pd }, { pb, pa, pc } };
+  const double* lifted[4] = { pa, pb, pc, pd };
+  int n[4];
+  for (int r = 0; r < 4; ++r) {
+    const int nw = lift(lifted[r][0], lifted[r][1], w);
+    n[r] = product<12, 96>(det3_2d(rows[r][0], rows[r][1], rows[r][2], m3), m3, nw, w, d[r]);
+  }
+  const int nd = sum(sum(n[0], d[0], n[1], d[1], h[0]), h[0], sum(n[2], d[2], n[3], d[3], h[1]), h[1], D);
+  return D[nd - 1];
+}
+
+template <class T>
+inline double vgl_incircle(vgl_point_2d<T> const& a, vgl_point_2d<T> const& b,
+                           vgl_point_2d<T> const& c, vgl_point_2d<T> const& d)
+{
+  return vgl_incircle(double(a.x()), double(a.y()), double(b.x()), double(b.y()),
+                      double(c.x()), double(c.y()), double(d.x()), double(d.y()));
+}
+
+//: Positive if e lies inside the sphere through a, b, c, d, with exact sign, if vgl_orient_3d(a, b, c, d) > 0.
+//  Negative outside, zero on the sphere; the sign is reversed if vgl_orient_3d(a, b, c, d) < 0.
+inline double vgl_insphere(double ax, double ay, double az, double bx, double by, double bz,
+                           double cx, double cy, double cz, double dx, double dy, double dz,
+                           double ex, double ey, double ez)
+{
+  const double aex = ax - ex, bex = bx - ex, cex = cx - ex, dex = dx - ex;
+  const double aey = ay - ey, bey = by - ey, cey = cy - ey, dey = dy - ey;
+  const double aez = az - ez, bez = bz - ez, cez = cz - ez, dez = dz - ez;
+  const double aexbey = aex * bey, bexaey = bex * aey, bexcey = bex * cey, cexbey = cex * bey;
+  const double cexdey = cex * dey, dexcey = dex * cey, dexaey = dex * aey, aexdey = aex * dey;
+  const double aexcey = aex * cey, cexaey = cex * aey, bexdey = bex * dey, dexbey = dex * bey;
+  const double ab = aexbey - bexaey, bc = bexcey - cexbey, cd = cexdey - dexcey;
+  const double da = dexaey - aexdey, ac = aexcey - cexaey, bd = bexdey - dexbey;
+  const double abc = aez * bc - bez * ac + cez * ab;
+  const double bcd = bez * cd - cez * bd + dez * bc;
+  const double cda = cez * da + dez * ac + aez * cd;
+  const double dab = dez * ab + aez * bd + bez * da;
+  const double alift = aex * aex + aey * aey + aez * aez, blift = bex * bex + bey * bey + bez * bez;
+  const double clift = cex * cex + cey * cey + cez * cez, dlift = dex * dex + dey * dey + dez * dez;
+  const double det = (dlift * abc - clift * dab) + (blift * cda - alift * bcd);
+  const double aezp = std::fabs(aez), bezp = std::fabs(bez), cezp = std::fabs(cez), dezp = std::fabs(dez);
+  const double abp = std::fabs(aexbey) + std::fabs(bexaey), bcp = std::fabs(bexcey) + std::fabs(cexbey);
+  const double cdp = std::fabs(cexdey) + std::fabs(dexcey), dap = std::fabs(dexaey) + std::fabs(aexdey);
+  const double acp = std::fabs(aexcey) + std::fabs(cexaey), bdp = std::fabs(bexdey) + std::fabs(dexbey);
+  const double permanent = (cdp * bezp + bdp * cezp + bcp * dezp) * alift +
+                           (dap * cezp + acp * dezp + cdp * aezp) * blift +
+                           (abp * dezp + bdp * aezp + dap * bezp) * clift +
+                           (bcp * aezp + acp * bezp + abp * cezp) * dlift;
+  using namespace vgl_predicates_detail;
+  const double eps = epsilon;
+  double bound = (16.0 + 224.0 * eps) * eps * permanent;
+  if (det > bound || -det > bound) return det;
+  if (permanent == 0.0) return 0.0;
+
+  // B: exact for the rounded differences
+  double eab[4], ebc[4], ecd[4], eda[4], eac[4], ebd[4];
+  const int nab = cross(aex, aey, bex, bey, eab), nbc = cross(bex, bey, cex, cey, ebc);
+  const int ncd = cross(cex, cey, dex, dey, ecd), nda = cross(dex, dey, aex, aey, eda);
+  const int nac = cross(aex, aey, cex, cey, eac), nbd = cross(bex, bey, dex, dey, ebd);
+  // the 3x3 minors abc, bcd, cda and dab, along their z column
+  double t[3][8], t16[16], m[4][24];
+  int n3[4];
+  n3[0] = sum(sum(scale(nbc, ebc, aez, t[0]), t[0], scale(nac, eac, -bez, t[1]), t[1], t16), t16,
+              scale(nab, eab, cez, t[2]), t[2], m[0]);
+  n3[1] = sum(sum(scale(ncd, ecd, bez, t[0]), t[0], scale(nbd, ebd, -cez, t[1]), t[1], t16), t16,
+              scale(nbc, ebc, dez, t[2]), t[2], m[1]);
+  n3[2] = sum(sum(scale(nda, eda, cez, t[0]), t[0], scale(nac, eac, dez, t[1]), t[1], t16), t16,
+              scale(ncd, ecd, aez, t[2]), t[2], m[2]);
+  n3[3] = sum(sum(scale(nab, eab, dez, t[0]), t[0], scale(nbd, ebd, aez, t[1]), t[1], t16), t16,
+              scale(nda, eda, bez, t[2]), t[2], m[3]);
+  negate(n3[1], m[1]);
+  negate(n3[3], m[3]);
+  // dlift abc - clift dab + blift cda - alift bcd
+  const double l[4][3] = { { dex, dey, dez }, { cex, cey, cez }, { bex, bey, bez }, { aex, aey, aez } };
+  const int mk[4] = { 0, 3, 2, 1 };
+  double w[6], p[4][288], h[2][576], B[1152];
+  int np[4];
+  for (int r = 0; r < 4; ++r) {
+    const int nw = lift(l[r][0], l[r][1], l[r][2], w);
+    np[r] = product<24, 288>(n3[mk[r]], m[mk[r]], nw, w, p[r]);
+  }
+  const int nb = sum(sum(np[0], p[0], np[1], p[1], h[0]), h[0], sum(np[2], p[2], np[3], p[3], h[1]), h[1], B);
+  const double exact = estimate(nb, B);
+  bound = (5.0 + 72.0 * eps) * eps * permanent;
+  if (exact >= bound || -exact >= bound) return exact;
+  if (diff_tail(ax, ex, aex) == 0.0 && diff_tail(ay, ey, aey) == 0.0 && diff_tail(az, ez, aez) == 0.0 &&
+      diff_tail(bx, ex, bex) == 0.0 && diff_tail(by, ey, bey) == 0.0 && diff_tail(bz, ez, bez) == 0.0 &&
+      diff_tail(cx, ex, cex) == 0.0 && diff_tail(cy, ey, cey) == 0.0 && diff_tail(cz, ez, cez) == 0.0 &&
+      diff_tail(dx, ex, dex) == 0.0 && diff_tail(dy, ey, dey) == 0.0 && diff_tail(dz, ez, dez) == 0.0)
+    return exact;
+
+  // D: from the coordinates
+  return insphere_exact(ax, ay, az, bx, by, bz, cx, cy, cz, dx, dy, dz, ex, ey, ez);
+}
+
+template <class T>
+inline double vgl_insphere(vgl_point_3d<T> const& a, vgl_point_3d<T> const& b, vgl_point_3d<T> const& c,
+                           vgl_point_3d<T> const& d, vgl_point_3d<T> const& e)
+{
+  return vgl_insphere(double(a.x()), double(a.y()), double(a.z()), double(b.x()), double(b.y()), double(b.z()),
+                      double(c.x()), double(c.y()), double(c.z()), double(d.x()), double(d.y()), double(d.z()),
+                      double(e.x()), double(e.y()), double(e.z()));
+}
+
+#endif // vgl_predicates_h_
@@ -0,0 +1,691 @@
+// This is core/vgl/vgl_prepared_cubic_spline.h
+#ifndef vgl_prepared_cubic_spline_h_
+#define vgl_prepared_cubic_spline_h_
+//:
+// \file
+// \brief A cubic spline curve prepared for fast evaluation and closest-point queries
+//
+//  vgl_prepared_cubic_spline<T,2> is built once from a vgl_cubic_spline_2d<T>
+//  and vgl_prepared_cubic_spline<T,3> from a vgl_cubic_spline_3d<T>
+//  (vgl_prepared_cubic_spline_2d<T> and vgl_prepared_cubic_spline_3d<T> for
+//  short).  It gives the same curve, parameter t from 0 to n-1 for n knots,
+//  but keeps the polynomial coefficients of every segment, so evaluation
+//  does not go through knot_indices() and coefficients() each time.  The
+//  coefficients are stored coordinate by coordinate and power by power, so
+//  the batch evaluate(), derivatives() and tangents() run over blocks of
+//  parameters in vectorisable loops.
+//
+//  For closest-point queries the exact bounding box of each segment is kept
+//  in a balanced binary hierarchy over the segments.  The hierarchy is
+//  searched depth first, nearer child first, skipping boxes farther than the
+//  best point found so far; in a segment the distance is minimised exactly,
+//  over the end points and the real roots of its (quintic) derivative.  The
+//  result is the global minimum over the whole curve.
+//
+//  A table of arc lengths at arc_samples parameters per segment, each
+//  integrated by Gauss-Legendre quadrature, gives arc_length(t), its inverse
+//  and resampling at equal arc length.
+//
+// \verbatim
+//  Modifications
+// \endverbatim
+
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <cstddef>
+#include <cassert>
+#include <vgl/vgl_point_2d.h>
+#include <vgl/vgl_point_3d.h>
+#include <vgl/vgl_vector_2d.h>
+#include <vgl/vgl_vector_3d.h>
+#include <vgl/vgl_cubic_spline_2d.h>
+#include <vgl/vgl_cubic_spline_3d.h>
+#include <vgl/vgl_parallel.h>
+
+namespace vgl_prepared_cubic_spline_detail
+{
+  template <class T, unsigned D> struct types;
+
+  template <class T> struct types<T, 2>
+  {
+    using spline_type = vgl_cubic_spline_2d<T>;
+    using point_type = vgl_point_2d<T>;
+    using vector_type = vgl_vector_2d<T>;
+    template <class V> static void coords(point_type const& p, V* c) { c[0] = p.x(); c[1] = p.y(); }
+    static point_type point(T const* c) { return point_type(c[0], c[1]); }
+    static vector_type vector(T const* c) { return vector_type(c[0], c[1]); }
+  };
+
+  template <class T> struct types<T, 3>
+  {
+    using spline_type = vgl_cubic_spline_3d<T>;
+    using point_type = vgl_point_3d<T>;
+    using vector_type = vgl_vector_3d<T>;
+    template <class V> static void coords(point_type const& p, V* c) { c[0] = p.x(); c[1] = p.y(); c[2] = p.z(); }
+    static point_type point(T const* c) { return point_type(c[0], c[1], c[2]); }
+    static vector_type vector(T const* c) { return vector_type(c[0], c[1], c[2]); }
+  };
+
+  //: a[0] + a[1] x + ... + a[deg] x^deg
+  inline double poly_eval(double const* a, int deg, double x)
+  {
+    double v = a[deg];
+    for (int j = deg - 1; j >= 0; --j)
+      v = v * x + a[j];
+    return v;
+  }
+
+  //: The real roots in [lo, hi] of a[0] + a[1] x + ... + a[deg] x^deg, deg <= 5.
+  //  The roots of the derivative cut [lo, hi] into pieces on which the
+  //  polynomial is monotone; a piece with a sign change holds one root, found
+  //  by Newton iteration kept inside the bracket.  Returns the number of
+  //  roots written (at most deg + 1, a double root may be reported twice).
+  inline int poly_roots(double const* a, int deg, double lo, double hi, double* roots)
+  {
+    while (deg > 0 && a[deg] == 0)
+      --deg;
+    if (deg <= 0)
+      return 0;
+    if (deg == 1) {
+      const double r = -a[0] / a[1];
+      if (r >= lo && r <= hi) {
+        roots[0] = r;
+        return 1;
+      }
+      return 0;
+    }
+    double d[5];
+    for (int j = 1; j <= deg; ++j)
+      d[j - 1] = j * a[j];
+    double x[8];
+    const int nc = poly_roots(d, deg - 1, lo, hi, x + 1);
+    x[0] = lo;
+    x[nc + 1] = hi;
+    int n = 0;
+    double f0 = poly_eval(a, deg, lo);
+    for (int i = 0; i <= nc; ++i) {
+      double x0 = x[i], x1 = x[i + 1];
+      const double f1 = poly_eval(a, deg, x1);
+      if (f0 == 0) {
+        roots[n++] = x0;
+      }
+      else if (f1 != 0 && (f0 < 0) != (f1 < 0) && x0 < x1) {
+        const bool rising = f0 < 0;
+        double r = 0.5 * (x0 + x1);
+        for (int iter = 0; iter < 100; ++iter) {
+          const double f = poly_eval(a, deg, r);
+          if (f == 0)
+            break;
+          if ((f < 0) == rising) x0 = r; else x1 = r;
+          const double df = poly_eval(d, deg - 1, r);
+          const double tol = 4 * std::numeric_limits<double>::epsilon() * std::max(1.0, std::abs(r));
+          double rn = df != 0 ? r - f / df : x0;
+          if (std::abs(rn - r) <= tol) {
+            r = std::min(std::max(rn, x0), x1);
+            break;
+          }
+          if (!(rn > x0 && rn < x1))
+            rn = 0.5 * (x0 + x1);
+          if (x1 - x0 <= tol)
+            break;
+          r = rn;
+        }
+        roots[n++] = r;
+      }
+      f0 = f1;
+    }
+    if (f0 == 0)
+      roots[n++] = hi;
+    return n;
+  }
+}
+
+template <class T, unsigned D>
+class vgl_prepared_cubic_spline
+{
+  using types = vgl_prepared_cubic_spline_detail::types<T, D>;
+ public:
+  using spline_type = typename types::spline_type;
+  using point_type = typename types::point_type;
+  using vector_type = typename types::vector_type;
+
+  //: An empty curve.
+  vgl_prepared_cubic_spline() : n_seg_(0), max_t_(0), leaves_(0), arc_samples_(0) {}
+
+  //: Prepare spl; arc_samples is the number of arc length samples per segment.
+  explicit vgl_prepared_cubic_spline(spline_type const& spl, unsigned arc_samples = 8) { build(spl, arc_samples); }
+
+  //: Prepare spl again.
+  void build(spline_type const& spl, unsigned arc_samples = 8);
+
+  //: number of segments, one less than the number of knots (0 if there are fewer than 2)
+  unsigned num_segments() const { return n_seg_; }
+
+  //: maximum value of the spline parameter
+  T max_t() const { return max_t_; }
+
+  //: The point at parameter t, 0 <= t <= max_t(); same as vgl_cubic_spline::operator().
+  point_type operator()(T t) const;
+
+  //: The derivative of the curve with respect to t at t, computed exactly.
+  vector_type derivative(T t) const;
+
+  //: The unit tangent at t (zero where the derivative vanishes).
+  //  Unlike vgl_cubic_spline::tangent() this is the exact derivative, not a finite difference.
+  vector_type tangent(T t) const;
+
+  //: The points at the n parameters t[i], written to the coordinate arrays x, y (and z).
+  //  Parameters outside [0, max_t()] are clamped; z is only used for 3-d curves.
+  void evaluate(T const* t, std::size_t n, T* x, T* y, T* z = nullptr) const;
+
+  //: The derivatives at the n parameters t[i], as for evaluate().
+  void derivatives(T const* t, std::size_t n, T* dx, T* dy, T* dz = nullptr) const;
+
+  //: The unit tangents at the n parameters t[i], as for evaluate().
+  void tangents(T const* t, std::size_t n, T* tx, T* ty, T* tz = nullptr) const;
+
+  //: The parameter of the point of the curve closest to p.
+  //  If dist2 is given it receives the squared distance (infinite for an empty curve).
+  T closest_parameter(point_type const& p, T* dist2 = nullptr) const;
+
+  //: The point of the curve closest to p; if t is given it receives its parameter.
+  point_type closest_point(point_type const& p, T* t = nullptr) const;
+
+  //: closest_parameter() for every point of pts, spread over nthreads threads (0: all cores).
+  void closest_parameters(std::vector<point_type> const& pts, std::vector<T>& t, unsigned nthreads = 0) const;
+
+  //: length of the whole curve
+  T length() const { return arc_.empty() ? T(0) : T(arc_.back()); }
+
+  //: The length of the curve from parameter 0 to t.
+  T arc_length(T t) const;
+
+  //: The parameter at which the arc length from parameter 0 is s (clamped to [0, length()]).
+  T parameter(T s) const;
+
+  //: n parameters at equal arc length steps, from 0 to max_t().
+  void uniform_parameters(unsigned n, std::vector<T>& t) const;
+
+  //: n points at equal arc length steps along the curve, from its start to its end.
+  void resample(unsigned n, std::vector<point_type>& pts) const;
+
+ private:
+  //: number of parameters per block of the batch functions
+  static const std::size_t block_ = 256;
+
+  //: coefficient j (of u^j) of coordinate k of segment s
+  T coef(unsigned k, unsigned j, unsigned s) const { return coef_[(4 * k + j) * n_seg_ + s]; }
+
+  //: segment s and local parameter u of t, with t clamped to [0, max_t_]
+  void locate(T t, unsigned& s, T& u) const
+  {
+    T v = t > T(0) ? t : T(0);
+    v = v < max_t_ ? v : max_t_;
+    s = std::min(static_cast<unsigned>(v), n_seg_ - 1);
+    u = v - static_cast<T>(s);
+  }
+
+  //: locate() for a block of m parameters
+  void locate(T const* t, std::size_t m, unsigned* seg, T* u) const
+  {
+    for (std::size_t i = 0; i < m; ++i)
+      locate(t[i], seg[i], u[i]);
+  }
+
+  //: |dP/du| in segment s
+  double speed(unsigned s, double u) const;
+
+  //: arc length over [u0, u1] of segment s, by 5-point Gauss-Legendre
+  double segment_length(unsigned s, double u0, double u1) const;
+
+  //: local parameter u in table interval idx at which the length from the start of the interval is r
+  double invert_length(std::size_t idx, double r) const;
+
+  //: squared distance from q to the box of hierarchy node i
+  double box_dist2(unsigned i, double const* q) const;
+
+  //: the closest point of segment s to q, if closer than best
+  void segment_closest(unsigned s, double const* q, double& best, double& best_t) const;
+
+  //: closest_parameter() for pts [begin, end)
+  void closest_range(std::vector<point_type> const& pts, std::size_t begin, std::size_t end, T* t) const;
+
+  unsigned n_seg_;
+  T max_t_;
+  std::vector<T> coef_;         // 4*D arrays of n_seg_ coefficients, coordinate by coordinate
+  unsigned leaves_;             // number of leaves of the hierarchy, a power of 2 >= n_seg_
+  std::vector<double> lo_, hi_; // node boxes, D values per node; node 1 is the root, i has children 2i, 2i+1
+  unsigned arc_samples_;
+  std::vector<double> arc_;     // arc length at t = s + j/arc_samples_, index s*arc_samples_ + j
+};
+
+template <class T>
+using vgl_prepared_cubic_spline_2d = vgl_prepared_cubic_spline<T, 2>;
+
+template <class T>
+using vgl_prepared_cubic_spline_3d = vgl_prepared_cubic_spline<T, 3>;
+
+// =================  methods  ===================
+
+template <class T, unsigned D>
+void vgl_prepared_cubic_spline<T, D>::build(spline_type const& spl, unsigned arc_samples)
+{
+  std::vector<point_type> knots = spl.knots();
+  n_seg_ = knots.size() < 2 ? 0u : static_cast<unsigned>(knots.size() - 1);
+  max_t_ = static_cast<T>(n_seg_);
+  arc_samples_ = std::max(arc_samples, 1u);
+  coef_.assign(4 * D * n_seg_, T(0));
+  leaves_ = 0;
+  lo_.clear(); hi_.clear(); arc_.clear();
+  if (n_seg_ == 0)
+    return;
+
+  // the coefficients, from the knots the spline itself would use
+  for (unsigned s = 0; s < n_seg_; ++s) {
+    unsigned im1, i0, i1, i2;
+    T u;
+    spl.knot_indices(static_cast<T>(s), im1, i0, i1, i2, u);
+    T cm1[D], c0[D], c1[D], c2[D];
+    types::coords(knots[im1], cm1);
+    types::coords(knots[i0], c0);
+    types::coords(knots[i1], c1);
+    types::coords(knots[i2], c2);
+    for (unsigned k = 0; k < D; ++k) {
+      T a[4];
+      spl.coefficients(cm1[k], c0[k], c1[k], c2[k], a[0], a[1], a[2], a[3]);
+      for (unsigned j = 0; j < 4; ++j)
+        coef_[(4 * k + j) * n_seg_ + s] = a[j];
+    }
+  }
+
+  // the segment boxes, from the end points and the extrema in between
+  leaves_ = 1;
+  while (leaves_ < n_seg_)
+    leaves_ *= 2;
+  lo_.assign(2 * leaves_ * D, std::numeric_limits<double>::infinity());
+  hi_.assign(2 * leaves_ * D, -std::numeric_limits<double>::infinity());
+  for (unsigned s = 0; s < n_seg_; ++s)
+    for (unsigned k = 0; k < D; ++k) {
+      const double a[4] = { coef(k, 0, s), coef(k, 1, s), coef(k, 2, s), coef(k, 3, s) };
+      const double da[3] = { a[1], 2 * a[2], 3 * a[3] };
+      double u[5] = { 0.0, 1.0 };
+      const int nu = 2 + vgl_prepared_cubic_spline_detail::poly_roots(da, 2, 0.0, 1.0, u + 2);
+      double lo = std::numeric_limits<double>::infinity(), hi = -lo;
+      for (int i = 0; i < nu; ++i) {
+        const double v = vgl_prepared_cubic_spline_detail::poly_eval(a, 3, u[i]);
+        lo = std::min(lo, v);
+        hi = std::max(hi, v);
+      }
+      // allow for rounding in the evaluation of the extrema
+      const double pad = 1e-12 * (std::abs(lo) + std::abs(hi));
+      lo_[(leaves_ + s) * D + k] = lo - pad;
+      hi_[(leaves_ + s) * D + k] = hi + pad;
+    }
+  for (unsigned i = leaves_ - 1; i >= 1; --i)
+    for (unsigned k = 0; k < D; ++k) {
+      lo_[i * D + k] = std::min(lo_[2 * i * D + k], lo_[(2 * i + 1) * D + k]);
+      hi_[i * D + k] = std::max(hi_[2 * i * D + k], hi_[(2 * i + 1) * D + k]);
+    }
+
+  // the arc length table
+  const std::size_t na = std::size_t(n_seg_) * arc_samples_;
+  arc_.resize(na + 1);
+  arc_[0] = 0.0;
+  for (std::size_t idx = 0; idx < na; ++idx) {
+    const unsigned s = static_cast<unsigned>(idx / arc_samples_), j = static_cast<unsigned>(idx % arc_samples_);
+    arc_[idx + 1] = arc_[idx] + segment_length(s, double(j) / arc_samples_, double(j + 1) / arc_samples_);
+  }
+}
+
+template <class T, unsigned D>
+typename vgl_prepared_cubic_spline<T, D>::point_type vgl_prepared_cubic_spline<T, D>::operator()(T t) const
+{
+  if (n_seg_ == 0)
+    return point_type();
+  assert(t >= T(0) && t <= max_t_);
+  unsigned s;
+  T u, c[D];
+  locate(t, s, u);
+  for (unsigned k = 0; k < D; ++k)
+    c[k] = ((coef(k, 3, s) * u + coef(k, 2, s)) * u + coef(k, 1, s)) * u + coef(k, 0, s);
+  return types::point(c);
+}
+
+template <class T, unsigned D>
+typename vgl_prepared_cubic_spline<T, D>::vector_type vgl_prepared_cubic_spline<T, D>::derivative(T t) const
+{
+  if (n_seg_ == 0)
+    return vector_type();
+  unsigned s;
+  T u, c[D];
+  locate(t, s, u);
+  for (unsigned k = 0; k < D; ++k)
+    c[k] = (3 * coef(k, 3, s) * u + 2 * coef(k, 2, s)) * u + coef(k, 1, s);
+  return types::vector(c);
+}
+
+template <class T, unsigned D>
+typename vgl_prepared_cubic_spline<T, D>::vector_type vgl_prepared_cubic_spline<T, D>::tangent(T t) const
+{
+  vector_type d = derivative(t);
+  const T len = static_cast<T>(d.length());
+  return len > T(0) ? d / len : d;
+}
+
+template <class T, unsigned D>
+void vgl_prepared_cubic_spline<T, D>::evaluate(T const* t, std::size_t n, T* x, T* y, T* z) const
+{
+  T* out[3] = { x, y, z };
+  assert(D == 2 || z);
+  if (n_seg_ == 0) {
+    for (unsigned k = 0; k < D; ++k)
+      std::fill(out[k], out[k] + n, T(0));
+    return;
+  }
+  unsigned seg[block_];
+  T u[block_];
+  for (std::size_t b = 0; b < n; b += block_) {
+    const std::size_t m = n - b < block_ ? n - b : block_;
+    locate(t + b, m, seg, u);
+    for (unsigned k = 0; k < D; ++k) {
+      T const* a0 = &coef_[4 * k * n_seg_];
+      T const* a1 = a0 + n_seg_;
+      T const* a2 = a1 + n_seg_;
+      T const* a3 = a2 + n_seg_;
+      T* o = out[k] + b;
+      for (std::size_t i = 0; i < m; ++i) {
+        const unsigned s = seg[i];
+        const T v = u[i];
+        o[i] = ((a3[s] * v + a2[s]) * v + a1[s]) * v + a0[s];
+      }
+    }
+  }
+}
+
+template <class T, unsigned D>
+void vgl_prepared_cubic_spline<T, D>::derivatives(T const* t, std::size_t n, T* dx, T* dy, T* dz) const
+{
+  T* out[3] = { dx, dy, dz };
+  assert(D == 2 || dz);
+  if (n_seg_ == 0) {
+    for (unsigned k = 0; k < D; ++k)
+      std::fill(out[k], out[k] + n, T(0));
+    return;
+  }
+  unsigned seg[block_];
+  T u[block_];
+  for (std::size_t b = 0; b < n; b += block_) {
+    const std::size_t m = n - b < block_ ? n - b : block_;
+    locate(t + b, m, seg, u);
+    for (unsigned k = 0; k < D; ++k) {
+      T const* a1 = &coef_[(4 * k + 1) * n_seg_];
+      T const* a2 = a1 + n_seg_;
+      T const* a3 = a2 + n_seg_;
+      T* o = out[k] + b;
+      for (std::size_t i = 0; i < m; ++i) {
+        const unsigned s = seg[i];
+        const T v = u[i];
+        o[i] = (3 * a3[s] * v + 2 * a2[s]) * v + a1[s];
+      }
+    }
+  }
+}
+
+template <class T, unsigned D>
+void vgl_prepared_cubic_spline<T, D>::tangents(T const* t, std::size_t n, T* tx, T* ty, T* tz) const
+{
+  derivatives(t, n, tx, ty, tz);
+  T* out[3] = { tx, ty, tz };
+  for (std::size_t b = 0; b < n; b += block_) {
+    const std::size_t m = n - b < block_ ? n - b : block_;
+    T len[block_];
+    for (std::size_t i = 0; i < m; ++i)
+      len[i] = T(0);
+    for (unsigned k = 0; k < D; ++k)
+      for (std::size_t i = 0; i < m; ++i)
+        len[i] += out[k][b + i] * out[k][b + i];
+    for (std::size_t i = 0; i < m; ++i)
+      len[i] = len[i] > T(0) ? T(1) / std::sqrt(len[i]) : T(0);
+    for (unsigned k = 0; k < D; ++k)
+      for (std::size_t i = 0; i < m; ++i)
+        out[k][b + i] *= len[i];
+  }
+}
+
+template <class T, unsigned D>
+double vgl_prepared_cubic_spline<T, D>::box_dist2(unsigned i, double const* q) const
+{
+  double d2 = 0.0;
+  for (unsigned k = 0; k < D; ++k) {
+    const double d = std::max(0.0, std::max(lo_[i * D + k] - q[k], q[k] - hi_[i * D + k]));
+    d2 += d * d;
+  }
+  return d2;
+}
+
+template <class T, unsigned D>
+void vgl_prepared_cubic_spline<T, D>::segment_closest(unsigned s, double const* q, double& best, double& best_t) const
+{
+  // half the derivative of |P(u) - q|^2, a quintic in u
+  double g[6] = { 0, 0, 0, 0, 0, 0 };
+  double c[D][4];
+  for (unsigned k = 0; k < D; ++k) {
+    const double c0 = coef(k, 0, s) - q[k], c1 = coef(k, 1, s), c2 = coef(k, 2, s), c3 = coef(k, 3, s);
+    c[k][0] = c0; c[k][1] = c1; c[k][2] = c2; c[k][3] = c3;
+    g[5] += 3 * c3 * c3;
+    g[4] += 5 * c2 * c3;
+    g[3] += 4 * c1 * c3 + 2 * c2 * c2;
+    g[2] += 3 * (c0 * c3 + c1 * c2);
+    g[1] += c1 * c1 + 2 * c0 * c2;
+    g[0] += c0 * c1;
+  }
+  double u[8] = { 0.0, 1.0 };
+  const int nu = 2 + vgl_prepared_cubic_spline_detail::poly_roots(g, 5, 0.0, 1.0, u + 2);
+  for (int i = 0; i < nu; ++i) {
+    double d2 = 0.0;
+    for (unsigned k = 0; k < D; ++k) {
+      const double d = vgl_prepared_cubic_spline_detail::poly_eval(c[k], 3, u[i]);
+      d2 += d * d;
+    }
+    if (d2 < best) {
+      best = d2;
+      best_t = s + u[i];
+    }
+  }
+}
+
+template <class T, unsigned D>
+T vgl_prepared_cubic_spline<T, D>::closest_parameter(point_type const& p, T* dist2) const
+{
+  double q[D];
+  types::coords(p, q);
+  double best = std::numeric_limits<double>::infinity(), best_t = 0.0;
+  if (n_seg_ > 0) {
+    // depth first, nearer child on top; the depth is at most 32, so is the stack
+    unsigned stack[64];
+    int top = 0;
+    stack[top++] = 1;
+    while (top > 0) {
+      const unsigned i = stack[--top];
+      if (box_dist2(i, q) >= best)
+        continue;
+      if (i >= leaves_) {
+        segment_closest(i - leaves_, q, best, best_t);
+        continue;
+      }
+      unsigned near = 2 * i, far = 2 * i + 1;
+      double dn = box_dist2(near, q), df = box_dist2(far, q);
+      if (df < dn) {
+        std::swap(near, far);
+        std::swap(dn, df);
+      }
+      if (df < best) stack[top++] = far;
+      if (dn < best) stack[top++] = near;
+    }
+  }
+  if (dist2)
+    *dist2 = static_cast<T>(best);
+  return std::min(static_cast<T>(best_t), max_t_);
+}
+
+template <class T, unsigned D>
+typename vgl_prepared_cubic_spline<T, D>::point_type
+vgl_prepared_cubic_spline<T, D>::closest_point(point_type const& p, T* t) const
+{
+  const T tc = closest_parameter(p);
+  if (t)
+    *t = tc;
+  return (*this)(tc);
+}
+
+template <class T, unsigned D>
+void vgl_prepared_cubic_spline<T, D>::closest_range(std::vector<point_type> const& pts, std::size_t begin,
+                                                    std::size_t end, T* t) const
+{
+  for (std::size_t i = begin; i < end; ++i)
+    t[i] = closest_parameter(pts[i]);
+}
+
+template <class T, unsigned D>
+void vgl_prepared_cubic_spline<T, D>::closest_parameters(std::vector<point_type> const& pts, std::vector<T>& t,
+                                                         unsigned nthreads) const
+{
+  const std::size_t n = pts.size();
+  t.resize(n);
+  if (n == 0)
+    return;
+  // a query costs a few microseconds, so a thread is worth starting for a few hundred
+  const std::size_t min_chunk = 256;
+  vgl_parallel_detail::parallel_for(n, vgl_parallel_detail::thread_count(nthreads, n, min_chunk),
+                                    [&](unsigned, std::size_t begin, std::size_t end) { closest_range(pts, begin, end, &t[0]); });
+}
+
+template <class T, unsigned D>
+double vgl_prepared_cubic_spline<T, D>::speed(unsigned s, double u) const
+{
+  double v2 = 0.0;
+  for (unsigned k = 0; k < D; ++k) {
+    const double d = (3 * double(coef(k, 3, s)) * u + 2 * double(coef(k, 2, s))) * u + coef(k, 1, s);
+    v2 += d * d;
+  }
+  return std::sqrt(v2);
+}
+
+template <class T, unsigned D>
+double vgl_prepared_cubic_spline<T, D>::segment_length(unsigned s, double u0, double u1) const
+{
+  static const double x[5] = { -0.9061798459386640, -0.5384693101056831, 0.0,
+                               0.5384693101056831, 0.9061798459386640 };
+  static const double w[5] = { 0.2369268850561891, 0.4786286704993665, 0.5688888888888889,
+                               0.4786286704993665, 0.2369268850561891 };
+  const double h = 0.5 * (u1 - u0), m = 0.5 * (u0 + u1);
+  double sum = 0.0;
+  for (int i = 0; i < 5; ++i)
+    sum += w[i] * speed(s, m + h * x[i]);
+  return sum * h;
+}
+
+template <class T, unsigned D>
+T vgl_prepared_cubic_spline<T, D>::arc_length(T t) const
+{
+  if (n_seg_ == 0)
+    return T(0);
+  unsigned s;
+  T u;
+  locate(t, s, u);
+  const unsigned j = std::min(static_cast<unsigned>(u * arc_samples_), arc_samples_ - 1);
+  const double u0 = double(j) / arc_samples_;
+  return static_cast<T>(arc_[std::size_t(s) * arc_samples_ + j] + segment_length(s, u0, u));
+}
+
+template <class T, unsigned D>
+double vgl_prepared_cubic_spline<T, D>::invert_length(std::size_t idx, double r) const
+{
+  const unsigned s = static_cast<unsigned>(idx / arc_samples_), j = static_cast<unsigned>(idx % arc_samples_);
+  const double u0 = double(j) / arc_samples_, u1 = double(j + 1) / arc_samples_;
+  const double len = arc_[idx + 1] - arc_[idx];
+  if (!(len > 0.0))
+    return u0;
+  // Newton on the length from u0, kept inside [lo, hi]
+  double lo = u0, hi = u1, u = u0 + (u1 - u0) * std::min(1.0, std::max(0.0, r / len));
+  for (int iter = 0; iter < 20; ++iter) {
+    const double f = segment_length(s, u0, u) - r;
+    if (f == 0)
+      return u;
+    if (f < 0) lo = u; else hi = u;
+    const double v = speed(s, u);
+    double un = v > 0.0 ? u - f / v : 0.5 * (lo + hi);
+    if (std::abs(un - u) <= 1e-15)
+      return std::min(std::max(un, lo), hi);
+    if (!(un > lo && un < hi))
+      un = 0.5 * (lo + hi);
+    u = un;
+  }
+  return u;
+}
+
+template <class T, unsigned D>
+T vgl_prepared_cubic_spline<T, D>::parameter(T s) const
+{
+  if (n_seg_ == 0)
+    return T(0);
+  const double len = std::min(std::max(double(s), 0.0), arc_.back());
+  const std::size_t na = arc_.size() - 1;
+  std::size_t idx = std::upper_bound(arc_.begin(), arc_.end(), len) - arc_.begin();
+  idx = idx == 0 ? 0 : std::min(idx - 1, na - 1);
+  return std::min(static_cast<T>(idx / arc_samples_ + invert_length(idx, len - arc_[idx])), max_t_);
+}
+
+template <class T, unsigned D>
+void vgl_prepared_cubic_spline<T, D>::uniform_parameters(unsigned n, std::vector<T>& t) const
+{
+  t.resize(n);
+  if (n == 0)
+    return;
+  if (n == 1 || n_seg_ == 0) {
+    std::fill(t.begin(), t.end(), T(0));
+    return;
+  }
+  // the arc lengths increase, so the table is walked once
+  const std::size_t na = arc_.size() - 1;
+  const double step = arc_.back() / (n - 1);
+  std::size_t idx = 0;
+  t[0] = T(0);
+  for (unsigned i = 1; i + 1 < n; ++i) {
+    const double len = i * step;
+    while (idx + 1 < na && arc_[idx + 1] <= len)
+      ++idx;
+    t[i] = std::min(static_cast<T>(idx / arc_samples_ + invert_length(idx, len - arc_[idx])), max_t_);
+  }
+  t[n - 1] = max_t_;
+}
+
+template <class T, unsigned D>
+void vgl_prepared_cubic_spline<T, D>::resample(unsigned n, std::vector<point_type>& pts) const
+{
+  std::vector<T> t;
+  uniform_parameters(n, t);
+  pts.resize(n);
+  for (unsigned i = 0; i < n; ++i)
+    pts[i] = (*this)(t[i]);
+}
+//: Return the closest point on a cubic spline to p
+//  The whole curve is searched, so this is the global minimum of the distance.
+//  The spline is prepared on every call; to snap many points to one spline,
+//  build a vgl_prepared_cubic_spline_3d once and use its closest_point().
+template <class T>
+vgl_point_3d<T> vgl_closest_point(vgl_cubic_spline_3d<T> const& cspl, vgl_point_3d<T> const& p)
+{
+  return vgl_prepared_cubic_spline_3d<T>(cspl, 1).closest_point(p);
+}
+
+//: Return the closest point on a 2-d cubic spline to p, as for the 3-d one
+template <class T>
+vgl_point_2d<T> vgl_closest_point(vgl_cubic_spline_2d<T> const& cspl, vgl_point_2d<T> const& p)
+{
+  return vgl_prepared_cubic_spline_2d<T>(cspl, 1).closest_point(p);
+}
+
+#endif // vgl_prepared_cubic_spline_h_
@@ -0,0 +1,318 @@
+// This is core/vgl/vgl_prepared_polygon.h
+#ifndef vgl_prepared_polygon_h_
+#define vgl_prepared_polygon_h_
+//:
+// \file
+// \brief A vgl_polygon indexed for fast point-in-polygon queries
+//
+//  vgl_prepared_polygon is built once from a vgl_polygon and answers
+//  contains(x,y) with the same result as vgl_polygon::contains(), boundary
+//  points included, without walking every edge.  The bounding box is cut
+//  into a uniform grid of square cells; each cell keeps (in one array, cell
+//  after cell) the edges passing within rounding distance of it (within a
+//  unit for integer T, whose crossing test truncates), and the parity of the
+//  crossings of the other edges with a ray starting on the right side of
+//  the cell.  Together those other edges cross the ray from any point of
+//  the cell as often, mod 2, as the ray from the right side at the same
+//  height, so a query tests only the few edges of its cell, and none at all
+//  in cells away from the boundary.
+//
+//  For integer T the products of coordinate differences must fit in T, as
+//  for vgl_polygon::contains().
+//
+//  The batch contains() classifies arrays of coordinates into a mask, in
+//  blocks whose cell lookup is a branch-free loop, spread over threads.
+//
+// \verbatim
+//  Modifications
+// \endverbatim
+
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <limits>
+#include <cmath>
+#include <cstddef>
+#include <vgl/vgl_point_2d.h>
+#include <vgl/vgl_polygon.h>
+#include <vgl/vgl_parallel.h>
+
+template <class T>
+class vgl_prepared_polygon
+{
+ public:
+  //: Index the edges of poly.
+  //  The grid gets about cells_per_edge cells per polygon edge.
+  explicit vgl_prepared_polygon(vgl_polygon<T> const& poly, double cells_per_edge = 4);
+
+  //: Is (x,y) inside the polygon, or on its boundary?  Same as vgl_polygon::contains().
+  bool contains(T x, T y) const;
+  bool contains(vgl_point_2d<T> const& p) const { return contains(p.x(), p.y()); }
+
+  //: contains() for the n points (x[i], y[i]); mask[i] is set to 1 or 0.
+  //  The points are spread over nthreads threads (0: all cores).
+  void contains(T const* x, T const* y, std::size_t n, unsigned char* mask, unsigned nthreads = 0) const;
+
+  //: number of edges of the polygon
+  std::size_t num_edges() const { return num_edges_; }
+
+  //: number of grid cells in x and y
+  unsigned cols() const { return cols_; }
+  unsigned rows() const { return rows_; }
+
+ private:
+  //: The edge from vertex i to its predecessor j, as visited by vgl_polygon::contains().
+  struct edge
+  {
+    T xi, yi, xj, yj;
+  };
+
+  //: cell of a point in the bounding box
+  unsigned cell(T x, T y) const
+  {
+    double fx = std::floor((double(x) - gx_) / h_), fy = std::floor((double(y) - gy_) / h_);
+    fx = std::min(std::max(fx, 0.0), double(cols_ - 1));
+    fy = std::min(std::max(fy, 0.0), double(rows_ - 1));
+    return unsigned(fy) * cols_ + unsigned(fx);
+  }
+
+  //: the per-edge test of vgl_polygon::contains(): returns true if (x,y) is on e,
+  //  and flips c if the ray from (x,y) towards +x crosses e
+  static bool test(edge const& e, T x, T y, bool& c)
+  {
+    if ((e.xj - x) * (e.yi - y) == (e.xi - x) * (e.yj - y) &&
+        (((e.xi <= x) && (x <= e.xj)) || ((e.xj <= x) && (x <= e.xi))) &&
+        (((e.yi <= y) && (y <= e.yj)) || ((e.yj <= y) && (y <= e.yi))))
+      return true;
+    if ((((e.yi <= y) && (y < e.yj)) || ((e.yj <= y) && (y < e.yi))) &&
+        (x < (e.xj - e.xi) * (y - e.yi) / (e.yj - e.yi) + e.xi))
+      c = !c;
+    return false;
+  }
+
+  //: classify points [begin, end)
+  void contains_range(T const* x, T const* y, std::size_t begin, std::size_t end, unsigned char* mask) const;
+
+  std::size_t num_edges_;
+  T min_x_, min_y_, max_x_, max_y_;   // bounding box of the vertices
+  double gx_, gy_, h_;                // grid origin and cell size
+  unsigned cols_, rows_;
+  std::vector<unsigned> cell_start_;  // edges of cell k are edges_[cell_start_[k] .. cell_start_[k+1])
+  std::vector<edge> edges_;
+  std::vector<unsigned char> parity_; // crossings with the ray from the right side of each cell, mod 2
+};
+
+// implementation
+template <class T>
+vgl_prepared_polygon<T>::vgl_prepared_polygon(vgl_polygon<T> const& poly, double cells_per_edge)
+  : num_edges_(0), min_x_(0), min_y_(0), max_x_(0), max_y_(0),
+    gx_(0), gy_(0), h_(1), cols_(0), rows_(0)
+{
+  std::vector<edge> all;
+  std::vector<unsigned> next, prev; // edges sharing vertex i, and vertex j
+  for (unsigned int s = 0; s < poly.num_sheets(); ++s) {
+    typename vgl_polygon<T>::sheet_t const& sheet = poly[s];
+    const unsigned int n = (unsigned int)(sheet.size()), o = (unsigned int)(all.size());
+    for (unsigned int i = 0, j = n - 1; i < n; j = i++) {
+      edge e = { sheet[i].x(), sheet[i].y(), sheet[j].x(), sheet[j].y() };
+      all.push_back(e);
+      next.push_back(o + (i + 1) % n);
+      prev.push_back(o + j);
+    }
+  }
+  num_edges_ = all.size();
+  if (all.empty())
+    return; // cols_ == 0: nothing is inside
+
+  min_x_ = max_x_ = all[0].xi; min_y_ = max_y_ = all[0].yi;
+  for (std::size_t k = 1; k < all.size(); ++k) {
+    min_x_ = std::min(min_x_, all[k].xi); max_x_ = std::max(max_x_, all[k].xi);
+    min_y_ = std::min(min_y_, all[k].yi); max_y_ = std::max(max_y_, all[k].yi);
+  }
+  gx_ = double(min_x_); gy_ = double(min_y_);
+  const double w = double(max_x_) - gx_, ht = double(max_y_) - gy_;
+
+  // edges further than margin from a cell are on one side of it for test(),
+  // despite rounding in T (or truncation of the crossing, for integer T)
+  const double scale = std::max(std::max(std::abs(gx_), std::abs(double(max_x_))),
+                                std::max(std::abs(gy_), std::abs(double(max_y_))));
+  const double eps = std::max(double(std::numeric_limits<T>::epsilon()), std::numeric_limits<double>::epsilon());
+  const double margin = 64 * eps * scale + (std::numeric_limits<T>::is_integer ? 1 : 0);
+
+  const double target = std::max(1.0, cells_per_edge * double(all.size()));
+  h_ = std::sqrt(w * ht / target);
+  if (!(h_ > 0)) h_ = std::max(w, ht) / target;
+  if (!(h_ > 0)) h_ = 1;
+  while (true) {
+    const double nc = std::floor(w / h_) + 1, nr = std::floor(ht / h_) + 1;
+    if (nc * nr <= 2 * target + 16) { cols_ = unsigned(nc); rows_ = unsigned(nr); break; }
+    h_ *= 2;
+  }
+  auto col = [&](double x) {
+    const double f = std::floor((x - gx_) / h_);
+    return f < 0 ? 0u : f >= cols_ ? cols_ - 1 : unsigned(f);
+  };
+  auto row = [&](double y) {
+    const double f = std::floor((y - gy_) / h_);
+    return f < 0 ? 0u : f >= rows_ ? rows_ - 1 : unsigned(f);
+  };
+
+  // Enter each edge in the cells within margin of it: in each row of cells,
+  // the columns spanned by the part of the edge in that row.  The first pass
+  // counts, the second fills the cells back to front.
+  const unsigned ncells = cols_ * rows_;
+  cell_start_.assign(ncells + 1, 0);
+  std::vector<unsigned> ids;
+  for (int pass = 0; pass < 2; ++pass) {
+    for (unsigned k = 0; k < all.size(); ++k) {
+      double x0 = double(all[k].xi), y0 = double(all[k].yi), x1 = double(all[k].xj), y1 = double(all[k].yj);
+      if (y0 > y1) { std::swap(x0, x1); std::swap(y0, y1); }
+      for (unsigned r = row(y0 - margin), r1 = row(y1 + margin); r <= r1; ++r) {
+        double xa = std::min(x0, x1), xb = std::max(x0, x1);
+        if (y1 > y0) {
+          const double t0 = ((gy_ + r * h_ - margin) - y0) / (y1 - y0);
+          const double t1 = ((gy_ + (r + 1) * h_ + margin) - y0) / (y1 - y0);
+          xa = x0 + std::max(0.0, t0) * (x1 - x0);
+          xb = x0 + std::min(1.0, t1) * (x1 - x0);
+          if (xa > xb) std::swap(xa, xb);
+        }
+        for (unsigned q = col(xa - margin), q1 = col(xb + margin); q <= q1; ++q) {
+          if (pass == 0) ++cell_start_[r * cols_ + q];
+          else ids[--cell_start_[r * cols_ + q]] = k;
+        }
+      }
+    }
+    if (pass == 0) {
+      std::partial_sum(cell_start_.begin(), cell_start_.end(), cell_start_.begin());
+      ids.resize(cell_start_.back());
+    }
+  }
+
+  // An edge not entered in a cell lies, across the row, wholly to the left or
+  // to the right of the cell, so whether it crosses the ray from a point of
+  // the cell only depends on the height of the point.  Summed over all those
+  // edges, the crossings change with the height only at a vertex in the row
+  // right of the cell joining an entered edge to one not entered; enter that
+  // edge too, until no such vertex is left.
+  std::vector<unsigned> stamp(all.size(), unsigned(-1)), list, closed_start(ncells + 1, 0), closed;
+  for (unsigned k = 0; k < ncells; ++k) {
+    const double xlo = gx_ + (k % cols_) * h_ - margin;
+    const double ylo = gy_ + (k / cols_) * h_ - margin, yhi = gy_ + (k / cols_ + 1) * h_ + margin;
+    list.assign(ids.begin() + cell_start_[k], ids.begin() + cell_start_[k + 1]);
+    for (std::size_t w = 0; w < list.size(); ++w)
+      stamp[list[w]] = k;
+    for (std::size_t w = 0; w < list.size(); ++w) {
+      const unsigned e = list[w];
+      for (int end = 0; end < 2; ++end) {
+        const double vx = double(end ? all[e].xj : all[e].xi), vy = double(end ? all[e].yj : all[e].yi);
+        const unsigned nb = end ? prev[e] : next[e];
+        if (stamp[nb] != k && vy >= ylo && vy <= yhi && vx >= xlo) {
+          stamp[nb] = k;
+          list.push_back(nb);
+        }
+      }
+    }
+    closed.insert(closed.end(), list.begin(), list.end());
+    closed_start[k + 1] = unsigned(closed.size());
+  }
+  cell_start_.swap(closed_start);
+  ids.swap(closed);
+  edges_.resize(ids.size());
+  for (std::size_t u = 0; u < ids.size(); ++u)
+    edges_[u] = all[ids[u]];
+
+  // The parity of a cell counts the edges not entered in it that cross the
+  // ray from its right side at mid-height, i.e. all crossing edges (found in
+  // the cells of the row) less the crossing edges of the cell.
+  auto crosses = [](edge const& e, double x, double y) {
+    const double xi = double(e.xi), yi = double(e.yi), xj = double(e.xj), yj = double(e.yj);
+    return ((yi <= y && y < yj) || (yj <= y && y < yi)) && x < (xj - xi) * (y - yi) / (yj - yi) + xi;
+  };
+  parity_.assign(ncells, 0);
+  std::vector<unsigned> seen(all.size(), unsigned(-1));
+  std::vector<double> xs;
+  for (unsigned r = 0; r < rows_; ++r) {
+    const double ym = gy_ + (r + 0.5) * h_;
+    xs.clear();
+    for (unsigned u = cell_start_[r * cols_]; u < cell_start_[(r + 1) * cols_]; ++u) {
+      const unsigned k = ids[u];
+      if (seen[k] == r) continue;
+      seen[k] = r;
+      edge const& e = all[k];
+      const double xi = double(e.xi), yi = double(e.yi), xj = double(e.xj), yj = double(e.yj);
+      if ((yi <= ym && ym < yj) || (yj <= ym && ym < yi))
+        xs.push_back((xj - xi) * (ym - yi) / (yj - yi) + xi);
+    }
+    std::sort(xs.begin(), xs.end());
+    std::size_t left = 0;
+    for (unsigned q = 0; q < cols_; ++q) {
+      const double xr = gx_ + (q + 1) * h_;
+      while (left < xs.size() && !(xr < xs[left])) ++left;
+      std::size_t count = xs.size() - left;
+      const unsigned k = r * cols_ + q;
+      for (unsigned u = cell_start_[k]; u < cell_start_[k + 1]; ++u)
+        if (crosses(edges_[u], xr, ym)) --count;
+      parity_[k] = (unsigned char)(count & 1);
+    }
+  }
+}
+
+template <class T>
+bool vgl_prepared_polygon<T>::contains(T x, T y) const
+{
+  if (!(cols_ > 0 && x >= min_x_ && x <= max_x_ && y >= min_y_ && y <= max_y_))
+    return false;
+  const unsigned k = cell(x, y);
+  bool c = parity_[k] != 0;
+  for (unsigned u = cell_start_[k]; u < cell_start_[k + 1]; ++u)
+    if (test(edges_[u], x, y, c))
+      return true;
+  return c;
+}
+
+template <class T>
+void vgl_prepared_polygon<T>::contains_range(T const* x, T const* y, std::size_t begin, std::size_t end,
+                                             unsigned char* mask) const
+{
+  const std::size_t block = 256;
+  unsigned cells[block];
+  unsigned char in_box[block];
+  const double cmax = double(cols_ - 1), rmax = double(rows_ - 1);
+  for (std::size_t b = begin; b < end; b += block) {
+    const std::size_t m = std::min(block, end - b);
+    // cell lookup without branches, so that it vectorises
+    for (std::size_t i = 0; i < m; ++i) {
+      const T xi = x[b + i], yi = y[b + i];
+      in_box[i] = (unsigned char)((xi >= min_x_) & (xi <= max_x_) & (yi >= min_y_) & (yi <= max_y_));
+      double fx = std::floor((double(xi) - gx_) / h_), fy = std::floor((double(yi) - gy_) / h_);
+      fx = fx < 0 ? 0 : fx > cmax ? cmax : fx;
+      fy = fy < 0 ? 0 : fy > rmax ? rmax : fy;
+      cells[i] = in_box[i] ? unsigned(fy) * cols_ + unsigned(fx) : 0;
+    }
+    for (std::size_t i = 0; i < m; ++i) {
+      if (!in_box[i]) { mask[b + i] = 0; continue; }
+      const unsigned k = cells[i];
+      bool c = parity_[k] != 0;
+      bool on = false;
+      for (unsigned u = cell_start_[k]; u < cell_start_[k + 1] && !on; ++u)
+        on = test(edges_[u], x[b + i], y[b + i], c);
+      mask[b + i] = (unsigned char)(on || c);
+    }
+  }
+}
+
+template <class T>
+void vgl_prepared_polygon<T>::contains(T const* x, T const* y, std::size_t n, unsigned char* mask,
+                                       unsigned nthreads) const
+{
+  if (cols_ == 0) {
+    std::fill(mask, mask + n, (unsigned char)0);
+    return;
+  }
+  // a thread is only worth starting for a few thousand points
+  const std::size_t min_chunk = 4096;
+  vgl_parallel_detail::parallel_for(n, vgl_parallel_detail::thread_count(nthreads, n, min_chunk),
+                                    [&](unsigned, std::size_t begin, std::size_t end) { contains_range(x, y, begin, end, mask); });
+}
+
+#endif // vgl_prepared_polygon_h_
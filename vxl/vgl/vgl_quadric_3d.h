@@ -8,22 +8,27 @@
 // \date June 4, 2017
 // \verbatim
 // Modifications
-// none
+//  Oct.2026 - coefficient matrices as vnl_matrix_fixed; batch sampson_dist() and on()
 // \endverbatim
 //
 //-----------------------------------------------------------------------------
 
 #include <list>
 #include <string>
+#include <vector>
+#include <cmath>
+#include <cstddef>
 #include <iosfwd>
 #include <iostream>
 #include <algorithm>
 #include <functional>
 
-//#include <vnl/vnl_math.h>
+#include <vnl/vnl_matrix_fixed.h>
+#include <vnl/vnl_vector_fixed.h>
 
 #include "vgl_homg_point_3d.h"
 #include "vgl_point_3d.h"
+#include "vgl_pointset_3d_soa.h"
 #include "vgl_tolerance.h"
 
 
@@ -133,7 +138,7 @@ class vgl_quadric_3d
   vgl_quadric_3d(T const coeff[]);
 
   //: constructor from a matix of polynomial coefficients (see below)
-  vgl_quadric_3d(std::vector<std::vector<T> > const& Q);
+  vgl_quadric_3d(vnl_matrix_fixed<T, 4, 4> const& Q);
 
   //: return a matrix of quadric coefficients of the form:
   //       _                  _
@@ -144,7 +149,7 @@ class vgl_quadric_3d
   //       -                  -
   //  Note that X^t Q X = 0 , where X^t =[x y z w] is the same as implicit equation 1) above.
   //
-  std::vector<std::vector<T> > coef_matrix() const;
+  vnl_matrix_fixed<T, 4, 4> coef_matrix() const;
 
   //: constructor from a canonical 4x4 quadric coefficient matrix and a 4x4 homogeneous matrix, H
   // representing the Euclidean transformation from the canonical frame to the global frame
@@ -153,17 +158,17 @@ class vgl_quadric_3d
   //             H = |      |  0^t is a 1x3 zero vector.
   //                 |0^t  1|
   //                  -    -
-  vgl_quadric_3d(std::vector<std::vector<T> > const& canonical_quadric, std::vector<std::vector<T> > const& H);
+  vgl_quadric_3d(vnl_matrix_fixed<T, 4, 4> const& canonical_quadric, vnl_matrix_fixed<T, 4, 4> const& H);
 
   //: constructor for central quadrics e.g. ellipsoid, ax^2+ by^2+ cz*2 + j = 0, where diag = [a,b,c,j]
   // are the diagonal elements of the 4x4 quadric coefficient matrix and a 4x4 homogeneous matrix, and
   //  H represents the Euclidean transformation from the canonical frame to the global frame (see above)
-  vgl_quadric_3d(std::vector<T> const& diag, std::vector<std::vector<T> > const& H);
+  vgl_quadric_3d(vnl_vector_fixed<T, 4> const& diag, vnl_matrix_fixed<T, 4, 4> const& H);
 
   //: set or reset the quadric using polynomial coefficients.
   void set(T a, T b, T c, T d, T e, T f, T g, T h, T i, T j);
 
-  void set(std::vector<std::vector<T> > const& Q);
+  void set(vnl_matrix_fixed<T, 4, 4> const& Q);
 
   //: comparison operator.
   //  Comparison is on the quadric, not the equation coefficients.  Hence two
@@ -184,28 +189,45 @@ class vgl_quadric_3d
   //  I.e., if it  satisfies the quadric equation within algebraic distance, i.e. pt^t Q pt < tol;
   bool on(vgl_homg_point_3d<T> const& pt, T tol = T(0)) const;
 
+  //: sampson_dist() of the n points (x[k], y[k], z[k]), with w = 1, written to dist.
+  //  The loop over the coordinate arrays allocates nothing and vectorises.
+  void sampson_dist(T const* x, T const* y, T const* z, std::size_t n, T* dist) const;
+
+  //: on() for the n points (x[k], y[k], z[k]); mask[k] is set to 1 or 0.
+  void on(T const* x, T const* y, T const* z, std::size_t n, unsigned char* mask, T tol = T(0)) const;
+
+  //: sampson_dist() of every point of ptset
+  void sampson_dist(vgl_pointset_3d_soa<T> const& ptset, std::vector<T>& dist) const;
+
+  //: on() for every point of ptset
+  void on(vgl_pointset_3d_soa<T> const& ptset, std::vector<unsigned char>& mask, T tol = T(0)) const;
+
   //: if the upper 3x3 submatrix of Q is full rank then the center of the quadric can be defined
   // otherwise the center is not defined for degenerate quadrics
   bool center(vgl_point_3d<T>& center) const;
 
   //:: eigenvalues and eigenvectors of the upper 3x3 quadric matrix
-  void upper_3x3_eigensystem(std::vector<T>& eigenvalues, std::vector<std::vector<T> >& eigenvectors) const;
+  // the eigenvectors are the rows of \a eigenvectors
+  void upper_3x3_eigensystem(vnl_vector_fixed<T, 3>& eigenvalues, vnl_matrix_fixed<T, 3, 3>& eigenvectors) const;
 
   //:: The quadric in its canonical frame if the center is defined, i.e. the upper 3x3 quadric matrix is full rank
   // In this case the quadric coefficient matrix in the canonical frame is
   // a 4x4 diagonal matrix, e.g. ax^2 + by^2 + cz^2 + j = 0. Note that the canonical frame is not unique as
   // alignment of quadric axes with the orthogonal frame has numerous possible arrangements.
   // H is a homogenous(4x4)transformation from canonical coordinate space back to the original space.
-  bool canonical_central_quadric(std::vector<T>& diag, std::vector<std::vector<T> >& H) const;
+  bool canonical_central_quadric(vnl_vector_fixed<T, 4>& diag, vnl_matrix_fixed<T, 4, 4>& H) const;
 
   //: The quadric coefficient matrix in the canonical frame, whether or not the quadric is central
   // H is a homogenous(4x4)transformation from canonical coordinate space back to the original space.
-  std::vector<std::vector<T> > canonical_quadric(std::vector<std::vector<T> >& H) const;
+  vnl_matrix_fixed<T, 4, 4> canonical_quadric(vnl_matrix_fixed<T, 4, 4>& H) const;
  private:
   //--------------------------------------------------------------------------
   //: set quadric type from polynomial coefficients and store in member type_
   void compute_type();
 
+  //: the rank of the n eigenvalues l, relative to the largest, and whether the non-zero ones have the same sign
+  static std::size_t rank_and_sign(T const* l, std::size_t n, T rank_tol, bool& same_sign);
+
 };
 
 // \relatesalso vgl_quadric_3d
@@ -274,21 +296,19 @@ vgl_quadric_3d<T>::vgl_quadric_3d(T const coeff[]):det_zero_(false){
 //       -                  -
 //
 template <class T>
-vgl_quadric_3d<T>::vgl_quadric_3d(std::vector<std::vector<T> > const& Q):det_zero_(false){
+vgl_quadric_3d<T>::vgl_quadric_3d(vnl_matrix_fixed<T, 4, 4> const& Q):det_zero_(false){
     this->set(Q[0][0], Q[1][1], Q[2][2], T(2)*Q[0][1], T(2)*Q[0][2],
               T(2)*Q[1][2], T(2)*Q[0][3], T(2)*Q[1][3], T(2)*Q[2][3], Q[3][3]);
 }
 template <class T>
-vgl_quadric_3d<T>::vgl_quadric_3d(std::vector<std::vector<T> > const& canonical_quadric,
-                                  std::vector<std::vector<T> > const& H){
+vgl_quadric_3d<T>::vgl_quadric_3d(vnl_matrix_fixed<T, 4, 4> const& canonical_quadric,
+                                  vnl_matrix_fixed<T, 4, 4> const& H){
     //The 4x4 coefficient matrix, Qg,  in the globa frame is given by
     // Qg =  H^-t Qc H^-1
     // where Qc = canonical_quadric;
-    std::vector<std::vector<T> > R(3,std::vector<T>(3, T(0)));
-    std::vector<std::vector<T> > Qg(4, std::vector<T>(4, T(0)));
-    std::vector<std::vector<T> > qr(3,std::vector<T>(3, T(0)));
-    std::vector<T> qu(3,T(0)), t(3, T(0)), c(3,T(0)), Rc(3,T(0)),
-    RqRt(3, T(0)), Rtrt(3,T(0));
+    T R[3][3], qr[3][3];
+    vnl_matrix_fixed<T, 4, 4> Qg(T(0));
+    T qu[3], t[3], c[3], Rc[3], RqRt[3], Rtrt[3];
     for(size_t r = 0; r<3; ++r){
         t[r]=H[r][3];
         qu[r] = canonical_quadric[r][r];
@@ -302,7 +322,7 @@ vgl_quadric_3d<T>::vgl_quadric_3d(std::vector<std::vector<T> > const& canonical_
     qr[1][1]=R[1][0]*qu[0]*R[1][0] +R[1][1]*qu[1]*R[1][1] +R[1][2]*qu[2]*R[1][2];
     qr[2][1]=R[2][0]*qu[0]*R[1][0] +R[2][1]*qu[1]*R[1][1] +R[2][2]*qu[2]*R[1][2];
     qr[2][2]=R[2][0]*qu[0]*R[2][0] +R[2][1]*qu[1]*R[2][1] +R[2][2]*qu[2]*R[2][2];
-    qr[0][1]=qr[1][0]; qr[0][2]=qr[2][0]; qr[2][1]=qr[1][2];
+    qr[0][1]=qr[1][0]; qr[0][2]=qr[2][0]; qr[1][2]=qr[2][1];
     
     Rc[0] = R[0][0]*c[0] + R[0][1]*c[1] + R[0][2]*c[2];
     Rc[1] = R[1][0]*c[0] + R[1][1]*c[1] + R[1][2]*c[2];
@@ -334,9 +354,9 @@ vgl_quadric_3d<T>::vgl_quadric_3d(std::vector<std::vector<T> > const& canonical_
     *this = vgl_quadric_3d<T>(Qg);
 }
 template <class T>
-vgl_quadric_3d<T>::vgl_quadric_3d(std::vector<T> const& diag,
-                                  std::vector<std::vector<T> > const& H){
-    std::vector<std::vector<T> > Qg(4, std::vector<T>(4, T(0)));
+vgl_quadric_3d<T>::vgl_quadric_3d(vnl_vector_fixed<T, 4> const& diag,
+                                  vnl_matrix_fixed<T, 4, 4> const& H){
+    vnl_matrix_fixed<T, 4, 4> Qg(T(0));
     Qg[0][0] = diag[0];Qg[1][1] = diag[1];Qg[2][2] = diag[2];Qg[3][3] = diag[3];
     *this = vgl_quadric_3d<T>(Qg, H);
 }
@@ -347,14 +367,14 @@ void vgl_quadric_3d<T>::set(T a, T b, T c, T d, T e, T f, T g, T h, T i, T j){
     this->compute_type();
 }
 template <class T>
-void vgl_quadric_3d<T>::set(std::vector<std::vector<T> > const& Q){
+void vgl_quadric_3d<T>::set(vnl_matrix_fixed<T, 4, 4> const& Q){
     this->set(Q[0][0], Q[1][1], Q[2][2],  T(2)*Q[0][1],
               T(2)*Q[0][2], T(2)*Q[1][2], T(2)*Q[0][3],
               T(2)*Q[1][3], T(2)*Q[2][3], Q[3][3]);
 }
 template <class T>
-std::vector<std::vector<T> > vgl_quadric_3d<T>::coef_matrix() const{
-    std::vector<std::vector<T> > Q(4,std::vector<T>(4,T(0)));
+vnl_matrix_fixed<T, 4, 4> vgl_quadric_3d<T>::coef_matrix() const{
+    vnl_matrix_fixed<T, 4, 4> Q;
     Q[0][0]=a_;Q[1][1]=b_; Q[2][2]=c_; Q[3][3]=j_;
     Q[0][1]= Q[1][0]=d_/T(2); Q[0][2]= Q[2][0]=e_/T(2);
     Q[0][3]= Q[3][0]=g_/T(2); Q[1][2]= Q[2][1]=f_/T(2);
@@ -365,9 +385,9 @@ template <class T>
 T vgl_quadric_3d<T>::sampson_dist(vgl_homg_point_3d<T> const& pt) const{
     T x = pt.x(), y = pt.y(), z = pt.z(), w = pt.w();
     T algebraic_dist = a_*x*x + b_*y*y + c_*z*z + d_*x*y + e_*x*z + f_*y*z + g_*x*w + h_*y*w + i_*z*w +j_*w*w;
-    T grad_x = (T(2)*a_*x + d_*y * e_*z + g_*w);
-    T grad_y = (T(2)*b_*y + d_*x * f_*z + h_*w);
-    T grad_z = (T(2)*c_*z + e_*x * f_*y + i_*w );
+    T grad_x = (T(2)*a_*x + d_*y + e_*z + g_*w);
+    T grad_y = (T(2)*b_*y + d_*x + f_*z + h_*w);
+    T grad_z = (T(2)*c_*z + e_*x + f_*y + i_*w );
     T grad_mag_sqrd = grad_x*grad_x + grad_y*grad_y + grad_z*grad_z;
     T sampson_dist_sqrd = (algebraic_dist*algebraic_dist)/grad_mag_sqrd;
     return sqrt(sampson_dist_sqrd);
@@ -380,6 +400,43 @@ bool vgl_quadric_3d<T>::on(vgl_homg_point_3d<T> const& pt, T tol) const{
     return false;
 }
 template <class T>
+void vgl_quadric_3d<T>::sampson_dist(T const* x, T const* y, T const* z, std::size_t n, T* dist) const{
+    // the coefficients in locals, so that the loop needs no loads from *this
+    const T a = a_, b = b_, c = c_, d = d_, e = e_, f = f_, g = g_, h = h_, i = i_, j = j_;
+    for(std::size_t k = 0; k<n; ++k){
+        const T px = x[k], py = y[k], pz = z[k];
+        const T algebraic_dist = a*px*px + b*py*py + c*pz*pz + d*px*py + e*px*pz + f*py*pz + g*px + h*py + i*pz + j;
+        const T grad_x = T(2)*a*px + d*py + e*pz + g;
+        const T grad_y = T(2)*b*py + d*px + f*pz + h;
+        const T grad_z = T(2)*c*pz + e*px + f*py + i;
+        dist[k] = std::abs(algebraic_dist)/std::sqrt(grad_x*grad_x + grad_y*grad_y + grad_z*grad_z);
+    }
+}
+template <class T>
+void vgl_quadric_3d<T>::on(T const* x, T const* y, T const* z, std::size_t n, unsigned char* mask, T tol) const{
+    // distances of a block of points, then the comparison
+    const std::size_t block = 256;
+    T dist[block];
+    for(std::size_t b = 0; b<n; b+=block){
+        const std::size_t m = std::min(block, n-b);
+        this->sampson_dist(x+b, y+b, z+b, m, dist);
+        for(std::size_t k = 0; k<m; ++k)
+            mask[b+k] = (unsigned char)(dist[k] < tol);
+    }
+}
+template <class T>
+void vgl_quadric_3d<T>::sampson_dist(vgl_pointset_3d_soa<T> const& ptset, std::vector<T>& dist) const{
+    dist.resize(ptset.size());
+    if(!dist.empty())
+        this->sampson_dist(ptset.x().data(), ptset.y().data(), ptset.z().data(), ptset.size(), &dist[0]);
+}
+template <class T>
+void vgl_quadric_3d<T>::on(vgl_pointset_3d_soa<T> const& ptset, std::vector<unsigned char>& mask, T tol) const{
+    mask.resize(ptset.size());
+    if(!mask.empty())
+        this->on(ptset.x().data(), ptset.y().data(), ptset.z().data(), ptset.size(), &mask[0], tol);
+}
+template <class T>
 bool vgl_quadric_3d<T>::center(vgl_point_3d<T>& center) const{
     if(!(type_ == real_ellipsoid || type_==real_elliptic_cone ||
          type_ == hyperboloid_of_one_sheet || type_ == hyperboloid_of_two_sheets)
@@ -419,10 +476,27 @@ bool vgl_quadric_3d<T>::center(vgl_point_3d<T>& center) const{
     return true;
 }
 template <class T>
+std::size_t vgl_quadric_3d<T>::rank_and_sign(T const* l, std::size_t n, T rank_tol, bool& same_sign){
+    T largest_eig_val = T(0);
+    for(std::size_t i = 0; i<n; ++i)
+        largest_eig_val = std::max(largest_eig_val, T(fabs(l[i])));
+    std::size_t rank = 0, npos = 0;
+    for(std::size_t i = 0; i<n; ++i){
+        if(!(fabs(l[i])/largest_eig_val > rank_tol))
+            continue;
+        ++rank;
+        if(l[i]>T(0))
+            ++npos;
+    }
+    same_sign = npos == 0 || npos == rank;
+    return rank;
+}
+template <class T>
 void vgl_quadric_3d<T>::compute_type(){
     type_ = no_type;
+    det_zero_ = false;
     T tol = vgl_tolerance<T>::position;
-    std::vector<std::vector<T> > Q = this->coef_matrix();
+    vnl_matrix_fixed<T, 4, 4> Q = this->coef_matrix();
     T m[4][4]; T l[4]; T vc[4][4];
     for(size_t r = 0; r<4; ++r)
         for(size_t c = 0; c<4; ++c)
@@ -435,78 +509,20 @@ void vgl_quadric_3d<T>::compute_type(){
     
     // the vector l contains the eigenvalues of the coeficient matrix
     eigen<T, 4>( m, l, vc);
-    std::vector<T> lv;
-    //determine the rank of Q
+    //determine the rank of Q, and whether its non-zero eigenvalues have the same sign
     T rank_tol = T(RANK_FACTOR)*tol;
-    std::vector<T> eig_vals;
-    for(auto & i : l){
-        eig_vals.push_back(fabs(i));
-        lv.push_back(i);
-    }
-    
-    std::sort(eig_vals.begin(), eig_vals.end(), std::greater<T>());
-    T largest_eig_val = eig_vals[0];
-    size_t r4 = 0;
-    for (size_t i = 0; i < 4; ++i) {
-        eig_vals[i] /= largest_eig_val;
-        if (eig_vals[i] > rank_tol)
-            r4++;
-    }
-    std::vector<T> non_zero_vals;
-    for(size_t i = 0 ; i<4; ++i){
-        if(fabs(lv[i])/largest_eig_val <= rank_tol)
-            continue;
-        non_zero_vals.push_back(lv[i]);
-    }
-    T z = T(0);
-    size_t nz = non_zero_vals.size();
-    if(nz == 0)
-        return;
     bool sign = true;
-    if(nz == 2)
-        sign =(non_zero_vals[0]>z && non_zero_vals[1]>z)||
-        (non_zero_vals[0]<z && non_zero_vals[1]<z);
-    else if(nz == 3)
-        sign = (non_zero_vals[0]>z && non_zero_vals[1]>z && non_zero_vals[2]>z) ||
-        (non_zero_vals[0]<z&& non_zero_vals[1]< z&& non_zero_vals[2]< z);
-    else if(nz == 4)
-        sign=(non_zero_vals[0]>z&&non_zero_vals[1]>z&&non_zero_vals[2]>z&&non_zero_vals[3]>z)||
-        (non_zero_vals[0]<z&& non_zero_vals[1]< z&& non_zero_vals[2]< z&& non_zero_vals[3]< z);
-    
+    size_t r4 = rank_and_sign(l, 4, rank_tol, sign);
+    if(r4 == 0)
+        return;
     
     //determine the rank of upper 3x3 of Q
-    std::vector<T> lvu;
     eigen<T, 3>( mu, lu, vcu);
-    std::vector<T> upper_eig_vals;
-    for(auto & i : lu){
-        upper_eig_vals.push_back(fabs(i));
-        lvu.push_back(i);
-    }
-    std::sort(upper_eig_vals.begin(), upper_eig_vals.end(), std::greater<T>());
-    largest_eig_val = upper_eig_vals[0];
-    size_t r3 = 0;
-    for (size_t i = 0; i < 3; ++i) {
-        upper_eig_vals[i] /= largest_eig_val;
-        if (upper_eig_vals[i] > rank_tol){
-            r3++;
-        }
-    }
-    std::vector<T> non_zero_uvals;
-    for(size_t i = 0 ; i<3; ++i){
-        if(fabs(lvu[i])/largest_eig_val <= rank_tol)
-            continue;
-        non_zero_uvals.push_back(lvu[i]);
-    }
-    nz = non_zero_uvals.size();
-    if(nz == 0)
-        return;
     bool signu = true;
-    if(nz == 2)
-        signu =(non_zero_uvals[0]>z && non_zero_uvals[1]>z)||
-        (non_zero_uvals[0]<z && non_zero_uvals[1]<z);
-    else if(nz == 3)
-        signu = (non_zero_uvals[0]>z && non_zero_uvals[1]>z && non_zero_uvals[2]>z) ||
-        (non_zero_uvals[0]<z&& non_zero_uvals[1]< z&& non_zero_uvals[2]< z);
+    size_t r3 = rank_and_sign(lu, 3, rank_tol, signu);
+    if(r3 == 0)
+        return;
+    T z = T(0);
     
     //compute the determinant of Q
     T det =  Q[0][0]*Q[1][1]*Q[2][2]*Q[3][3]
@@ -595,26 +611,24 @@ bool vgl_quadric_3d<T>::operator==(vgl_quadric_3d<T> const& that) const
     fabs(j_*mag_coefs_that - that.j()*mag_coefs)<tol;
 }
 template <class T>
-void vgl_quadric_3d<T>::upper_3x3_eigensystem(std::vector<T>& eigenvalues, std::vector<std::vector<T> >& eigenvectors) const{
-    std::vector<std::vector<T> > Q = this->coef_matrix();
+void vgl_quadric_3d<T>::upper_3x3_eigensystem(vnl_vector_fixed<T, 3>& eigenvalues, vnl_matrix_fixed<T, 3, 3>& eigenvectors) const{
+    vnl_matrix_fixed<T, 4, 4> Q = this->coef_matrix();
     T mu[3][3]; T lu[3]; T vcu[3][3];
     for(size_t r = 0; r<3; ++r)
         for(size_t c = 0; c<3; ++c)
             mu[r][c] = Q[r][c];
     
     eigen<T, 3>( mu, lu, vcu);
-    for(auto & i : lu){
-        eigenvalues.push_back(i);
-    }
-    eigenvectors.resize(3, std::vector<T>(3, T(0)));
-    for(size_t r = 0; r<3; ++r)
+    for(size_t r = 0; r<3; ++r){
+        eigenvalues[r] = lu[r];
         for(size_t c = 0; c<3; ++c)
             eigenvectors[r][c]=vcu[r][c];
+    }
 }
 template <class T>
-bool vgl_quadric_3d<T>::canonical_central_quadric(std::vector<T>& diag, std::vector<std::vector<T> >& H) const{
-    diag.resize(4, T(0));
-    H.resize(4, std::vector<T>(4, T(0)));
+bool vgl_quadric_3d<T>::canonical_central_quadric(vnl_vector_fixed<T, 4>& diag, vnl_matrix_fixed<T, 4, 4>& H) const{
+    diag.fill(T(0));
+    H.fill(T(0));
     vgl_point_3d<T> cent;
     bool good = this->center(cent);//the quadric origin
     if(!good)
@@ -624,8 +638,8 @@ bool vgl_quadric_3d<T>::canonical_central_quadric(std::vector<T>& diag, std::vec
     // the constant term in the centered coordinate frame
     T centered_j = j_ + (cent.x()*g_ + cent.y()*h_ + cent.z()*i_)/T(2);
     // find the upper 3x3 coordinate system
-    std::vector<T> eigenvalues;
-    std::vector<std::vector<T> > eigenvectors;
+    vnl_vector_fixed<T, 3> eigenvalues;
+    vnl_matrix_fixed<T, 3, 3> eigenvectors;
     this->upper_3x3_eigensystem(eigenvalues, eigenvectors);
     
     for(size_t r = 0; r<3; ++r)
@@ -638,9 +652,10 @@ bool vgl_quadric_3d<T>::canonical_central_quadric(std::vector<T>& diag, std::vec
     return true;
 }
 template <class T>
-std::vector<std::vector<T> > vgl_quadric_3d<T>::canonical_quadric(std::vector<std::vector<T> >& H) const{
-    std::vector<std::vector<T> > ret(4, std::vector<T>(4, T(0)));
-    std::vector<T> tr(3, T(0));
+vnl_matrix_fixed<T, 4, 4> vgl_quadric_3d<T>::canonical_quadric(vnl_matrix_fixed<T, 4, 4>& H) const{
+    vnl_matrix_fixed<T, 4, 4> ret(T(0));
+    T tr[3] = {T(0), T(0), T(0)};
+    H.fill(T(0));
     if(type_ == no_type){
         std::cout << "Invalid quadric" << std::endl;
         return ret;
@@ -648,7 +663,7 @@ std::vector<std::vector<T> > vgl_quadric_3d<T>::canonical_quadric(std::vector<st
     //check first for a central quadric
     if(type_ == real_ellipsoid || type_==real_elliptic_cone ||
        type_ == hyperboloid_of_one_sheet || type_ == hyperboloid_of_two_sheets){
-        std::vector<T> diag;
+        vnl_vector_fixed<T, 4> diag;
         if(canonical_central_quadric(diag, H)){
             for(size_t i = 0; i<4; ++i)
                 ret[i][i] = diag[i];
@@ -659,11 +674,10 @@ std::vector<std::vector<T> > vgl_quadric_3d<T>::canonical_quadric(std::vector<st
         }
     }
     
-    H.resize(4, std::vector<T>(4, T(0)));
-    
     // not a central quadric get the eigensystem for the upper 3x3
-    std::vector<T> lambda, sorted_eigenvalues(3,T(0));
-    std::vector<std::vector<T> > E;
+    vnl_vector_fixed<T, 3> lambda;
+    vnl_matrix_fixed<T, 3, 3> E;
+    T sorted_eigenvalues[3];
     this->upper_3x3_eigensystem(lambda, E);
     
     // to rotate the canonical form back to the original frame
@@ -674,7 +688,7 @@ std::vector<std::vector<T> > vgl_quadric_3d<T>::canonical_quadric(std::vector<st
     
     for(size_t i = 0; i<3; ++i)
         sorted_eigenvalues[i]=fabs(lambda[i]);
-    std::sort(sorted_eigenvalues.begin(), sorted_eigenvalues.end(), std::greater<T>());
+    std::sort(sorted_eigenvalues, sorted_eigenvalues + 3, std::greater<T>());
     T largest_eigenval = sorted_eigenvalues[0];
     T rtol = T(RANK_FACTOR)*vgl_tolerance<T>::position;
     size_t rank = 3;
@@ -700,7 +714,7 @@ std::vector<std::vector<T> > vgl_quadric_3d<T>::canonical_quadric(std::vector<st
     T hp = (E[1][0]*g_ + E[1][1]*h_ + E[1][2]*i_)/T(2);
     T ip = (E[2][0]*g_ + E[2][1]*h_ + E[2][2]*i_)/T(2);
     
-    std::vector<bool> t_known(3, false);
+    bool t_known[3] = {false, false, false};
     T sum = T(0);
     if(lambda[0] != T(0)){
         tr[0] = gp/lambda[0];
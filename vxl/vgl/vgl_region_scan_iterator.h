@@ -0,0 +1,40 @@
+// This is core/vgl/vgl_region_scan_iterator.h
+#ifndef vgl_region_scan_iterator_h_
+#define vgl_region_scan_iterator_h_
+//:
+// \file
+// \brief Abstract base for iterators over the pixels of a region, span by span
+//
+//  A region is visited as a sequence of horizontal spans of pixels: for each
+//  span, scany() is its row and startx() .. endx() its columns, inclusive.
+//  Pixel (x,y) is the unit square centred on the integer point (x,y).
+//
+// \verbatim
+//  Modifications
+// \endverbatim
+
+class vgl_region_scan_iterator
+{
+ public:
+  virtual ~vgl_region_scan_iterator() {}
+
+  //: Resets the scan iterator to before the first span.
+  // After calling this function, next() needs to be called before
+  // startx(), endx() and scany() return anything meaningful.
+  virtual void reset() = 0;
+
+  //: Tries to move to the next span.
+  // If there are no more spans in the region, returns false.
+  virtual bool next() = 0;
+
+  //: Returns the row of the current span.
+  virtual int scany() const = 0;
+
+  //: Returns the first column of the current span.
+  virtual int startx() const = 0;
+
+  //: Returns the last column of the current span (inclusive).
+  virtual int endx() const = 0;
+};
+
+#endif // vgl_region_scan_iterator_h_
@@ -0,0 +1,682 @@
+// This is core/vgl/vgl_simplify.h
+#ifndef vgl_simplify_h_
+#define vgl_simplify_h_
+//:
+// \file
+// \brief Simplification of polylines and polygons by Douglas-Peucker or Visvalingam-Whyatt
+//
+//  vgl_simplify() drops vertices of a chain of 2-d or 3-d points, open or
+//  closed, or of the sheets of a vgl_polygon, while the shape stays within
+//  a tolerance of the original:
+//  - vgl_simplify_douglas_peucker keeps the vertex farthest from the
+//    segment between two kept vertices, recursively, while that distance
+//    exceeds the tolerance (Douglas & Peucker 1973).  The recursion runs on
+//    an explicit stack, so long chains cannot overflow the call stack.
+//  - vgl_simplify_visvalingam repeatedly drops the vertex whose triangle
+//    with its two neighbours has the least area, while that area is below
+//    the tolerance, which is then an area (Visvalingam & Whyatt 1993).  The
+//    candidates are kept in a heap, for O(n log n) time; an entry whose area
+//    grew is only refreshed when it comes to the top.
+//  Open chains keep their end points and closed rings keep at least three
+//  vertices.
+//
+//  With preserve_topology, 2-d results gain no intersections that the input
+//  did not have, between or within sheets, and no sheet moves to the other
+//  side of another.  Visvalingam-Whyatt then refuses to drop a vertex
+//  whose triangle contains another remaining vertex (which, for a simple
+//  input, is exactly when the shortcut would cross or swallow something).
+//  Douglas-Peucker refines its result instead: a shortcut that crosses or
+//  touches another segment, or has a remaining vertex between itself and
+//  the part of the original it replaces, gets back its farthest vertex,
+//  until there is none.  Both look candidates up in a grid with cells about
+//  as large as the edges.  For 3-d chains the flag has no effect.
+//
+//  vgl_simplify_batch() simplifies many shapes, spread over threads.
+//
+// \verbatim
+//  Modifications
+// \endverbatim
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vgl/vgl_point_2d.h>
+#include <vgl/vgl_point_3d.h>
+#include <vgl/vgl_polygon.h>
+#include <vgl/vgl_predicates.h>
+#include <vgl/vgl_parallel.h>
+
+//: Simplification algorithm
+enum vgl_simplify_method
+{
+  vgl_simplify_douglas_peucker, // the tolerance is the largest distance of a dropped vertex
+  vgl_simplify_visvalingam      // the tolerance is the least triangle area of a kept vertex
+};
+
+//: The indices of the vertices of chain that the simplification keeps, increasing.
+//  P is vgl_point_2d<T> or vgl_point_3d<T>; closed chains are rings.
+template <class P>
+std::vector<unsigned> vgl_simplify_indices(std::vector<P> const& chain, double tolerance,
+                                           vgl_simplify_method method = vgl_simplify_douglas_peucker,
+                                           bool closed = false, bool preserve_topology = false);
+
+//: the simplified chain
+template <class P>
+std::vector<P> vgl_simplify(std::vector<P> const& chain, double tolerance,
+                            vgl_simplify_method method = vgl_simplify_douglas_peucker,
+                            bool closed = false, bool preserve_topology = false);
+
+//: the polygon with its sheets simplified as rings
+// \relatesalso vgl_polygon
+template <class T>
+vgl_polygon<T> vgl_simplify(vgl_polygon<T> const& poly, double tolerance,
+                            vgl_simplify_method method = vgl_simplify_douglas_peucker,
+                            bool preserve_topology = false);
+
+//: Simplify each of the polygons in, into out, on nthreads threads (0: all cores).
+// \relatesalso vgl_polygon
+template <class T>
+void vgl_simplify_batch(std::vector<vgl_polygon<T> > const& in, std::vector<vgl_polygon<T> >& out,
+                        double tolerance, vgl_simplify_method method = vgl_simplify_douglas_peucker,
+                        bool preserve_topology = false, unsigned nthreads = 0);
+
+//: Simplify each of the chains in, into out, on nthreads threads (0: all cores).
+template <class P>
+void vgl_simplify_batch(std::vector<std::vector<P> > const& in, std::vector<std::vector<P> >& out,
+                        double tolerance, vgl_simplify_method method = vgl_simplify_douglas_peucker,
+                        bool closed = false, bool preserve_topology = false, unsigned nthreads = 0);
+
+namespace vgl_simplify_detail
+{
+template <class T>
+inline double sqr_distance_to_segment(vgl_point_2d<T> const& p, vgl_point_2d<T> const& a, vgl_point_2d<T> const& b)
+{
+  const double dx = double(b.x()) - double(a.x()), dy = double(b.y()) - double(a.y());
+  const double px = double(p.x()) - double(a.x()), py = double(p.y()) - double(a.y());
+  const double l2 = dx * dx + dy * dy;
+  const double t = l2 > 0 ? std::min(1.0, std::max(0.0, (px * dx + py * dy) / l2)) : 0.0;
+  return (px - t * dx) * (px - t * dx) + (py - t * dy) * (py - t * dy);
+}
+
+template <class T>
+inline double sqr_distance_to_segment(vgl_point_3d<T> const& p, vgl_point_3d<T> const& a, vgl_point_3d<T> const& b)
+{
+  const double d[3] = { double(b.x()) - double(a.x()), double(b.y()) - double(a.y()), double(b.z()) - double(a.z()) };
+  const double q[3] = { double(p.x()) - double(a.x()), double(p.y()) - double(a.y()), double(p.z()) - double(a.z()) };
+  const double l2 = d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+  const double t = l2 > 0 ? std::min(1.0, std::max(0.0, (q[0] * d[0] + q[1] * d[1] + q[2] * d[2]) / l2)) : 0.0;
+  double s = 0.0;
+  for (int k = 0; k < 3; ++k)
+    s += (q[k] - t * d[k]) * (q[k] - t * d[k]);
+  return s;
+}
+
+template <class T>
+inline double triangle_area(vgl_point_2d<T> const& a, vgl_point_2d<T> const& b, vgl_point_2d<T> const& c)
+{
+  return std::abs((double(b.x()) - double(a.x())) * (double(c.y()) - double(a.y())) -
+                  (double(b.y()) - double(a.y())) * (double(c.x()) - double(a.x()))) / 2;
+}
+
+template <class T>
+inline double triangle_area(vgl_point_3d<T> const& a, vgl_point_3d<T> const& b, vgl_point_3d<T> const& c)
+{
+  const double u[3] = { double(b.x()) - double(a.x()), double(b.y()) - double(a.y()), double(b.z()) - double(a.z()) };
+  const double v[3] = { double(c.x()) - double(a.x()), double(c.y()) - double(a.y()), double(c.z()) - double(a.z()) };
+  const double n[3] = { u[1] * v[2] - u[2] * v[1], u[2] * v[0] - u[0] * v[2], u[0] * v[1] - u[1] * v[0] };
+  return std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]) / 2;
+}
+
+//: A chain of n points, a ring if closed; its point i is pts[i % n].
+template <class P>
+struct chain
+{
+  P const* pts;
+  std::size_t n;
+  bool closed;
+  P const& operator[](std::size_t i) const { return pts[i < n ? i : i - n]; }
+};
+
+//: The vertex strictly between i and j farthest from the segment between them, and its squared distance; j if none.
+template <class P>
+std::size_t farthest(chain<P> const& c, std::size_t i, std::size_t j, double& d2)
+{
+  std::size_t best = j;
+  d2 = -1.0;
+  for (std::size_t m = i + 1; m < j; ++m) {
+    const double d = sqr_distance_to_segment(c[m], c[i], c[j]);
+    if (d > d2) {
+      d2 = d;
+      best = m;
+    }
+  }
+  return best;
+}
+
+//: Douglas-Peucker on chain c, marking the kept vertices in keep.
+template <class P>
+void douglas_peucker(chain<P> const& c, double tolerance, std::vector<unsigned char>& keep)
+{
+  const std::size_t n = c.n;
+  keep.assign(n, 1);
+  if (n <= (c.closed ? 3u : 2u))
+    return;
+  std::fill(keep.begin(), keep.end(), 0);
+  const double tol2 = tolerance * tolerance;
+  std::vector<std::pair<std::size_t, std::size_t> > stack;
+  std::size_t k = n - 1;
+  if (c.closed) {
+    // split the ring at the vertex farthest from vertex 0; index n is vertex 0 again
+    double d2 = -1.0;
+    for (std::size_t m = 1; m < n; ++m) {
+      const double d = sqr_distance_to_segment(c[m], c[0], c[0]);
+      if (d > d2) { d2 = d; k = m; }
+    }
+    stack.push_back(std::make_pair(k, n));
+  }
+  keep[0] = keep[k] = 1;
+  stack.push_back(std::make_pair(std::size_t(0), k));
+  while (!stack.empty()) {
+    const std::pair<std::size_t, std::size_t> s = stack.back();
+    stack.pop_back();
+    double d2;
+    const std::size_t m = farthest(c, s.first, s.second, d2);
+    if (m != s.second && d2 > tol2) {
+      keep[m] = 1;
+      stack.push_back(std::make_pair(s.first, m));
+      stack.push_back(std::make_pair(m, s.second));
+    }
+  }
+  if (c.closed && std::count(keep.begin(), keep.end(), 1) < 3) {
+    // a ring keeps a triangle: the vertex farthest from the chord
+    double d0, d1;
+    const std::size_t m0 = farthest(c, 0, k, d0), m1 = farthest(c, k, n, d1);
+    keep[d0 >= d1 ? m0 : m1 % n] = 1;
+  }
+}
+
+//: The vertices, or segments, of a shape binned in a uniform grid.
+//  Only the occupied cells are stored, sorted by row and column, so the
+//  cells can be as small as the items even when these follow thin curves
+//  across a large box; a query searches once per row.
+class grid
+{
+ public:
+  //: bin n boxes, given as (x0, y0, x1, y1) per item, in square cells of the given size at most
+  void build(std::vector<double> const& boxes, double const* box, double cell)
+  {
+    const std::size_t n = boxes.size() / 4;
+    x0_ = box[0];
+    y0_ = box[1];
+    // at most 2^30 cells across
+    const double extent = std::max(box[2] - box[0], box[3] - box[1]);
+    cell = std::min(cell, std::sqrt((box[2] - box[0]) * (box[3] - box[1]) / double(std::max<std::size_t>(n, 1))));
+    s_ = 1.0 / std::max(cell, extent * 1e-9 + 1e-300);
+    cells_.clear();
+    for (std::size_t i = 0; i < n; ++i) {
+      std::uint32_t cx0, cy0, cx1, cy1;
+      cells(&boxes[4 * i], cx0, cy0, cx1, cy1);
+      for (std::uint32_t cy = cy0; cy <= cy1; ++cy)
+        for (std::uint32_t cx = cx0; cx <= cx1; ++cx)
+          cells_.push_back(std::make_pair(key(cx, cy), unsigned(i)));
+    }
+    std::sort(cells_.begin(), cells_.end());
+    seen_.assign(n, 0);
+    stamp_ = 0;
+  }
+
+  //: call f(i) once for each item whose cells meet the box (x0, y0, x1, y1); stops when f returns true
+  template <class F>
+  bool any(double const* b, F f)
+  {
+    if (++stamp_ == 0) {
+      std::fill(seen_.begin(), seen_.end(), 0);
+      stamp_ = 1;
+    }
+    std::uint32_t cx0, cy0, cx1, cy1;
+    cells(b, cx0, cy0, cx1, cy1);
+    for (std::uint32_t cy = cy0; cy <= cy1; ++cy) {
+      const std::uint64_t last = key(cx1, cy);
+      for (auto it = std::lower_bound(cells_.begin(), cells_.end(), std::make_pair(key(cx0, cy), 0u));
+           it != cells_.end() && it->first <= last; ++it) {
+        const unsigned i = it->second;
+        if (seen_[i] == stamp_)
+          continue;
+        seen_[i] = stamp_;
+        if (f(i))
+          return true;
+      }
+    }
+    return false;
+  }
+
+ private:
+  static std::uint64_t key(std::uint32_t cx, std::uint32_t cy) { return (std::uint64_t(cy) << 32) | cx; }
+  void cells(double const* b, std::uint32_t& cx0, std::uint32_t& cy0, std::uint32_t& cx1, std::uint32_t& cy1) const
+  {
+    cx0 = clamp((b[0] - x0_) * s_);
+    cy0 = clamp((b[1] - y0_) * s_);
+    cx1 = clamp((b[2] - x0_) * s_);
+    cy1 = clamp((b[3] - y0_) * s_);
+  }
+  static std::uint32_t clamp(double v) { return v <= 0 ? 0u : v >= 1073741823.0 ? 1073741823u : std::uint32_t(v); }
+
+  double x0_ = 0, y0_ = 0, s_ = 1;
+  std::vector<std::pair<std::uint64_t, unsigned> > cells_;
+  std::vector<unsigned> seen_;
+  unsigned stamp_ = 0;
+};
+
+//: Topology checks, which only 2-d shapes have; this one accepts everything.
+template <class P>
+struct topology_guard
+{
+  explicit topology_guard(std::vector<chain<P> > const&) {}
+  void build(std::vector<std::size_t> const&) {}
+  bool blocks(std::size_t, std::size_t, std::size_t) { return false; }
+  void remove(std::size_t) {}
+  void refine(std::vector<std::vector<unsigned char> >&) {}
+};
+
+template <class T>
+struct topology_guard<vgl_point_2d<T> >
+{
+  typedef vgl_point_2d<T> point;
+  std::vector<chain<point> > const& chains;
+  std::vector<std::size_t> offset;            //!< global number of the first vertex of each chain
+  std::vector<std::pair<std::size_t, std::size_t> > where; //!< chain and index of each global vertex
+  std::vector<unsigned char> alive;
+  double box[4];
+  grid vertices;
+  std::vector<std::size_t> ids; //!< the global vertex of each grid item
+
+  explicit topology_guard(std::vector<chain<point> > const& c) : chains(c)
+  {
+    std::size_t n = 0;
+    for (std::size_t k = 0; k < c.size(); ++k) {
+      offset.push_back(n);
+      for (std::size_t i = 0; i < c[k].n; ++i)
+        where.push_back(std::make_pair(k, i));
+      n += c[k].n;
+    }
+    alive.assign(n, 1);
+    box[0] = box[1] = std::numeric_limits<double>::infinity();
+    box[2] = box[3] = -std::numeric_limits<double>::infinity();
+    for (std::size_t v = 0; v < n; ++v) {
+      box[0] = std::min(box[0], x(v)); box[2] = std::max(box[2], x(v));
+      box[1] = std::min(box[1], y(v)); box[3] = std::max(box[3], y(v));
+    }
+  }
+
+  point const& pt(std::size_t v) const { return chains[where[v].first][where[v].second]; }
+  double x(std::size_t v) const { return double(pt(v).x()); }
+  double y(std::size_t v) const { return double(pt(v).y()); }
+
+  //: bin the remaining vertices, in cells twice the mean length of the edges to their successors in next
+  void build(std::vector<std::size_t> const& next)
+  {
+    std::vector<double> boxes;
+    double length = 0.0;
+    ids.clear();
+    for (std::size_t v = 0; v < where.size(); ++v)
+      if (alive[v]) {
+        const double b[4] = { x(v), y(v), x(v), y(v) };
+        boxes.insert(boxes.end(), b, b + 4);
+        ids.push_back(v);
+        length += std::sqrt((x(next[v]) - x(v)) * (x(next[v]) - x(v)) + (y(next[v]) - y(v)) * (y(next[v]) - y(v)));
+      }
+    vertices.build(boxes, box, 2 * length / double(std::max<std::size_t>(ids.size(), 1)));
+  }
+
+  //: true if a remaining vertex other than a, b and c is inside or on the triangle abc (global numbers)
+  bool blocks(std::size_t a, std::size_t b, std::size_t c)
+  {
+    point const& pa = pt(a);
+    point const& pb = pt(b);
+    point const& pc = pt(c);
+    const double o = vgl_orient_2d(pa, pb, pc);
+    const double q[4] = { std::min(x(a), std::min(x(b), x(c))), std::min(y(a), std::min(y(b), y(c))),
+                          std::max(x(a), std::max(x(b), x(c))), std::max(y(a), std::max(y(b), y(c))) };
+    return vertices.any(q, [&](unsigned i) {
+      const std::size_t w = ids[i];
+      if (!alive[w] || w == a || w == b || w == c)
+        return false;
+      point const& p = pt(w);
+      if (x(w) < q[0] || x(w) > q[2] || y(w) < q[1] || y(w) > q[3])
+        return false;
+      if (o == 0) // a spike or a straight run: block what lies along it
+        return vgl_orient_2d(pa, pc, p) == 0;
+      const double s = o > 0 ? 1.0 : -1.0;
+      return s * vgl_orient_2d(pa, pb, p) >= 0 && s * vgl_orient_2d(pb, pc, p) >= 0 && s * vgl_orient_2d(pc, pa, p) >= 0;
+    });
+  }
+  void remove(std::size_t v) { alive[v] = 0; }
+
+  static bool on_segment(point const& p, point const& q, point const& r) // q, collinear, between p and r
+  {
+    return std::min(p.x(), r.x()) <= q.x() && q.x() <= std::max(p.x(), r.x()) &&
+           std::min(p.y(), r.y()) <= q.y() && q.y() <= std::max(p.y(), r.y());
+  }
+  static int sign(double v) { return v > 0 ? 1 : v < 0 ? -1 : 0; }
+  static bool intersect(point const& p1, point const& q1, point const& p2, point const& q2)
+  {
+    const int o1 = sign(vgl_orient_2d(p1, q1, p2)), o2 = sign(vgl_orient_2d(p1, q1, q2));
+    const int o3 = sign(vgl_orient_2d(p2, q2, p1)), o4 = sign(vgl_orient_2d(p2, q2, q1));
+    return (o1 * o2 < 0 && o3 * o4 < 0) || (o1 == 0 && on_segment(p1, p2, q1)) || (o2 == 0 && on_segment(p1, q2, q1)) ||
+           (o3 == 0 && on_segment(p2, p1, q2)) || (o4 == 0 && on_segment(p2, q1, q2));
+  }
+
+  //: Douglas-Peucker refinement: restore the farthest vertex of each conflicting shortcut, until none is left.
+  void refine(std::vector<std::vector<unsigned char> >& keep)
+  {
+    struct segment { std::size_t c, i, j; }; // chain, and end indices along it (j may be n in a ring)
+    for (;;) {
+      std::vector<segment> segs;
+      std::vector<double> seg_boxes, vertex_boxes;
+      std::vector<std::size_t> kept; // global vertices
+      for (std::size_t k = 0; k < chains.size(); ++k) {
+        chain<point> const& c = chains[k];
+        std::size_t first = c.n, prev = c.n;
+        for (std::size_t i = 0; i < c.n; ++i)
+          if (keep[k][i]) {
+            kept.push_back(offset[k] + i);
+            const double b[4] = { double(c[i].x()), double(c[i].y()), double(c[i].x()), double(c[i].y()) };
+            vertex_boxes.insert(vertex_boxes.end(), b, b + 4);
+            if (prev < c.n) { segment s = { k, prev, i }; segs.push_back(s); }
+            else first = i;
+            prev = i;
+          }
+        if (c.closed && first < c.n && prev != first) { segment s = { k, prev, first + c.n }; segs.push_back(s); }
+      }
+      double length = 0.0;
+      for (segment const& s : segs) {
+        point const& p = chains[s.c][s.i];
+        point const& q = chains[s.c][s.j];
+        const double b[4] = { std::min(double(p.x()), double(q.x())), std::min(double(p.y()), double(q.y())),
+                              std::max(double(p.x()), double(q.x())), std::max(double(p.y()), double(q.y())) };
+        seg_boxes.insert(seg_boxes.end(), b, b + 4);
+        length += (q - p).length();
+      }
+      const double cell = 2 * length / double(std::max<std::size_t>(segs.size(), 1));
+      grid seg_grid, vertex_grid;
+      seg_grid.build(seg_boxes, box, cell);
+      vertex_grid.build(vertex_boxes, box, cell);
+
+      bool split = false;
+      for (std::size_t si = 0; si < segs.size(); ++si) {
+        segment const& s = segs[si];
+        chain<point> const& c = chains[s.c];
+        if (s.j - s.i < 2)
+          continue; // an edge of the input
+        point const& p = c[s.i];
+        point const& q = c[s.j];
+        const std::size_t ei = s.i, ej = s.j % c.n;
+        // crossing or touching another segment
+        bool conflict = seg_grid.any(&seg_boxes[4 * si], [&](unsigned ti) {
+          if (ti == si)
+            return false;
+          segment const& t = segs[ti];
+          point const& a = chains[t.c][t.i];
+          point const& b = chains[t.c][t.j];
+          const std::size_t ti0 = t.i, tj0 = t.j % chains[t.c].n;
+          if (t.c == s.c && (ti0 == ej || tj0 == ei)) {
+            // neighbours along the chain: only a fold back along s is a conflict
+            point const& o = ti0 == ej ? b : a;
+            return vgl_orient_2d(p, q, o) == 0 && on_segment(p, o, q);
+          }
+          return intersect(p, q, a, b);
+        });
+        if (!conflict) {
+          // a remaining vertex between the shortcut and the part it replaces
+          double b[4] = { double(p.x()), double(p.y()), double(p.x()), double(p.y()) };
+          for (std::size_t m = s.i + 1; m <= s.j; ++m) {
+            b[0] = std::min(b[0], double(c[m].x())); b[2] = std::max(b[2], double(c[m].x()));
+            b[1] = std::min(b[1], double(c[m].y())); b[3] = std::max(b[3], double(c[m].y()));
+          }
+          conflict = vertex_grid.any(b, [&](unsigned vi) {
+            const std::size_t w = kept[vi];
+            if (where[w].first == s.c && (where[w].second == ei || where[w].second == ej))
+              return false;
+            const double px = x(w), py = y(w);
+            bool inside = false;
+            for (std::size_t m = s.i, l = s.j; m <= s.j; l = m++) {
+              const double xm = double(c[m].x()), ym = double(c[m].y()), xl = double(c[l].x()), yl = double(c[l].y());
+              if ((ym > py) != (yl > py) && px < (xl - xm) * (py - ym) / (yl - ym) + xm)
+                inside = !inside;
+            }
+            return inside;
+          });
+        }
+        if (conflict) {
+          double d2;
+          keep[s.c][farthest(c, s.i, s.j, d2) % c.n] = 1;
+          split = true;
+        }
+      }
+      if (!split)
+        return;
+    }
+  }
+};
+
+//: Visvalingam-Whyatt on all chains at once, so that the guard sees every removal.
+template <class P>
+void visvalingam(std::vector<chain<P> > const& chains, double tolerance, std::vector<std::vector<unsigned char> >& keep,
+                 topology_guard<P>* guard)
+{
+  std::vector<std::size_t> offset, chain_of;
+  std::size_t n = 0;
+  for (std::size_t k = 0; k < chains.size(); ++k) {
+    offset.push_back(n);
+    n += chains[k].n;
+    chain_of.resize(n, k);
+  }
+  std::vector<std::size_t> prev(n), next(n), left(chains.size());
+  std::vector<double> area(n, std::numeric_limits<double>::infinity());
+  // whether the heap has an entry for the vertex no larger than its area; if it grows, that entry
+  // is refreshed only when it comes up, which saves most of the heap traffic
+  std::vector<unsigned char> alive(n, 1), queued(n, 0);
+  auto point = [&](std::size_t v) -> P const& { std::size_t k = chain_of[v]; return chains[k].pts[v - offset[k]]; };
+  // the vertices that may go: not the ends of open chains
+  auto removable = [&](std::size_t v) {
+    chain<P> const& c = chains[chain_of[v]];
+    const std::size_t i = v - offset[chain_of[v]];
+    return c.closed || (i > 0 && i + 1 < c.n);
+  };
+  typedef std::pair<double, std::uint32_t> entry; // area and vertex
+  std::vector<entry> heap;
+  auto least_on_top = [](entry const& x, entry const& y) { return x.first > y.first; };
+  auto push = [&](std::size_t v) {
+    heap.push_back(entry(area[v], std::uint32_t(v)));
+    std::push_heap(heap.begin(), heap.end(), least_on_top);
+  };
+  auto update = [&](std::size_t v) {
+    const double a = triangle_area(point(prev[v]), point(v), point(next[v]));
+    const bool refresh = !queued[v] || a < area[v];
+    area[v] = a;
+    if (refresh && a < tolerance) {
+      push(v);
+      queued[v] = 1;
+    }
+  };
+  for (std::size_t k = 0; k < chains.size(); ++k) {
+    const std::size_t m = chains[k].n, o = offset[k];
+    left[k] = m;
+    for (std::size_t i = 0; i < m; ++i) {
+      prev[o + i] = o + (i == 0 ? m - 1 : i - 1);
+      next[o + i] = o + (i + 1 == m ? 0 : i + 1);
+    }
+  }
+  for (std::size_t v = 0; v < n; ++v)
+    if (removable(v) && chains[chain_of[v]].n > (chains[chain_of[v]].closed ? 3u : 2u)) {
+      area[v] = triangle_area(point(prev[v]), point(v), point(next[v]));
+      if (area[v] < tolerance) {
+        heap.push_back(entry(area[v], std::uint32_t(v)));
+        queued[v] = 1;
+      }
+    }
+  std::make_heap(heap.begin(), heap.end(), least_on_top);
+  // the guard's grid is rebuilt, with larger cells, whenever half of its vertices are gone
+  std::size_t remaining = n, binned = n;
+  if (guard) guard->build(next);
+  while (!heap.empty()) {
+    const entry e = heap.front();
+    std::pop_heap(heap.begin(), heap.end(), least_on_top);
+    heap.pop_back();
+    const std::size_t v = e.second, k = chain_of[v];
+    if (!alive[v] || e.first > area[v])
+      continue; // stale: a smaller entry came before
+    if (e.first < area[v]) {
+      // the area grew since this entry was made
+      if (area[v] < tolerance) push(v);
+      else queued[v] = 0;
+      continue;
+    }
+    queued[v] = 0;
+    if (left[k] <= (chains[k].closed ? 3u : 2u))
+      continue;
+    const std::size_t a = prev[v], c = next[v];
+    if (guard && guard->blocks(a, v, c))
+      continue; // stays, unless a neighbour goes and the triangle changes
+    alive[v] = 0;
+    --left[k];
+    next[a] = c;
+    prev[c] = a;
+    if (guard) {
+      guard->remove(v);
+      if (2 * --remaining < binned) {
+        guard->build(next);
+        binned = remaining;
+      }
+    }
+    if (removable(a)) update(a);
+    if (removable(c)) update(c);
+  }
+  keep.resize(chains.size());
+  for (std::size_t k = 0; k < chains.size(); ++k)
+    keep[k].assign(alive.begin() + offset[k], alive.begin() + offset[k] + chains[k].n);
+}
+
+//: Simplify the chains of one shape, marking the kept vertices in keep.
+template <class P>
+void simplify(std::vector<chain<P> > const& chains, double tolerance, vgl_simplify_method method,
+              bool preserve_topology, std::vector<std::vector<unsigned char> >& keep)
+{
+  keep.resize(chains.size());
+  if (method == vgl_simplify_visvalingam) {
+    if (preserve_topology) {
+      topology_guard<P> guard(chains);
+      visvalingam(chains, tolerance, keep, &guard);
+    }
+    else
+      visvalingam(chains, tolerance, keep, static_cast<topology_guard<P>*>(nullptr));
+    return;
+  }
+  for (std::size_t k = 0; k < chains.size(); ++k)
+    douglas_peucker(chains[k], tolerance, keep[k]);
+  if (preserve_topology) {
+    topology_guard<P> guard(chains);
+    guard.refine(keep);
+  }
+}
+
+//: run f(i) for i in [0, n) on nthreads threads (0: all cores), handing out the items one by one
+template <class F>
+void parallel_for_each(std::size_t n, unsigned nthreads, F f)
+{
+  const unsigned nt = vgl_parallel_detail::thread_count(nthreads, n);
+  std::atomic<std::size_t> next(0);
+  vgl_parallel_detail::parallel_for(nt, nt, [&](unsigned, std::size_t, std::size_t) {
+    for (std::size_t i; (i = next++) < n;)
+      f(i);
+  });
+}
+} // namespace vgl_simplify_detail
+
+template <class P>
+std::vector<unsigned> vgl_simplify_indices(std::vector<P> const& pts, double tolerance, vgl_simplify_method method,
+                                           bool closed, bool preserve_topology)
+{
+  std::vector<vgl_simplify_detail::chain<P> > chains(1);
+  chains[0].pts = pts.data();
+  chains[0].n = pts.size();
+  chains[0].closed = closed;
+  std::vector<std::vector<unsigned char> > keep;
+  vgl_simplify_detail::simplify(chains, tolerance, method, preserve_topology, keep);
+  std::vector<unsigned> kept;
+  for (std::size_t i = 0; i < pts.size(); ++i)
+    if (keep[0][i])
+      kept.push_back(unsigned(i));
+  return kept;
+}
+
+template <class P>
+std::vector<P> vgl_simplify(std::vector<P> const& pts, double tolerance, vgl_simplify_method method,
+                            bool closed, bool preserve_topology)
+{
+  std::vector<P> out;
+  for (unsigned i : vgl_simplify_indices(pts, tolerance, method, closed, preserve_topology))
+    out.push_back(pts[i]);
+  return out;
+}
+
+namespace vgl_simplify_detail
+{
+//: vgl_simplify(poly, ...), written into the empty polygon out
+template <class T>
+void simplify_polygon(vgl_polygon<T> const& poly, double tolerance, vgl_simplify_method method,
+                      bool preserve_topology, vgl_polygon<T>& out)
+{
+  std::vector<chain<vgl_point_2d<T> > > chains(poly.num_sheets());
+  for (unsigned s = 0; s < poly.num_sheets(); ++s) {
+    chains[s].pts = poly[s].data();
+    chains[s].n = poly[s].size();
+    chains[s].closed = true;
+  }
+  std::vector<std::vector<unsigned char> > keep;
+  simplify(chains, tolerance, method, preserve_topology, keep);
+  for (unsigned s = 0; s < poly.num_sheets(); ++s) {
+    out.new_sheet();
+    for (std::size_t i = 0; i < poly[s].size(); ++i)
+      if (keep[s][i])
+        out.push_back(poly[s][i]);
+  }
+}
+} // namespace vgl_simplify_detail
+
+template <class T>
+vgl_polygon<T> vgl_simplify(vgl_polygon<T> const& poly, double tolerance, vgl_simplify_method method,
+                            bool preserve_topology)
+{
+  vgl_polygon<T> out;
+  vgl_simplify_detail::simplify_polygon(poly, tolerance, method, preserve_topology, out);
+  return out;
+}
+
+template <class T>
+void vgl_simplify_batch(std::vector<vgl_polygon<T> > const& in, std::vector<vgl_polygon<T> >& out,
+                        double tolerance, vgl_simplify_method method, bool preserve_topology, unsigned nthreads)
+{
+  out.assign(in.size(), vgl_polygon<T>());
+  vgl_simplify_detail::parallel_for_each(in.size(), nthreads, [&](std::size_t i) {
+    vgl_simplify_detail::simplify_polygon(in[i], tolerance, method, preserve_topology, out[i]);
+  });
+}
+
+template <class P>
+void vgl_simplify_batch(std::vector<std::vector<P> > const& in, std::vector<std::vector<P> >& out,
+                        double tolerance, vgl_simplify_method method, bool closed, bool preserve_topology,
+                        unsigned nthreads)
+{
+  out.assign(in.size(), std::vector<P>());
+  vgl_simplify_detail::parallel_for_each(in.size(), nthreads, [&](std::size_t i) {
+    out[i] = vgl_simplify(in[i], tolerance, method, closed, preserve_topology);
+  });
+}
+
+#endif // vgl_simplify_h_
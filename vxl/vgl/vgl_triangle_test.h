@@ -7,8 +7,13 @@
 // \verbatim
 //  Modifications
 //   Nov.2003 - Peter Vanroose - made functions templated
+//   Oct.2026 - exact sign for floating point input, with vgl_orient_2d
 // \endverbatim
 
+#include <limits>
+#include <type_traits>
+#include "vgl_predicates.h"
+
 //: Compute discriminant function
 // Returns determinant of
 // \verbatim
@@ -16,6 +21,9 @@
 // [ y1 y2 y3 ]
 // [ 1  1  1  ]
 // \endverbatim
+// For float and double the sign is exact, see vgl_predicates.h, even where
+// the value underflows T.  The predicates work on doubles, so a long double
+// wider than double is evaluated directly, without that guarantee.
 
 template <class T>
 T vgl_triangle_test_discriminant(T x1, T y1,
@@ -37,6 +45,14 @@ T vgl_triangle_test_discriminant(T x1, T y1,
                                  T x2, T y2,
                                  T x3, T y3)
 {
+    if (std::is_floating_point<T>::value && sizeof(T) <= sizeof(double)) {
+        const double d = vgl_orient_2d(double(x1), double(y1), double(x2), double(y2), double(x3), double(y3));
+        const T t = static_cast<T>(d);
+        // a value that underflows T keeps its sign
+        if (t == 0 && d != 0)
+            return d > 0 ? std::numeric_limits<T>::min() : -std::numeric_limits<T>::min();
+        return t;
+    }
     return x1*(y2-y3) - x2*(y1-y3) + x3*(y1-y2);
 }
 
@@ -0,0 +1,613 @@
+// This is core/vgl/vgl_triangulate.h
+#ifndef vgl_triangulate_h_
+#define vgl_triangulate_h_
+//:
+// \file
+// \brief Triangulation of a vgl_polygon by ear clipping
+//
+//  vgl_triangulate() splits the area inside a polygon, by the even-odd rule
+//  of vgl_polygon::contains(), into triangles whose corners are polygon
+//  vertices.  The sheets are sorted by nesting: a sheet inside an odd
+//  number of others is a hole of the innermost sheet around it, and the
+//  others are outer rings, so islands inside holes are triangulated too.
+//  Each hole is bridged into its outer ring by a pair of coincident edges
+//  to a vertex visible from its leftmost point (Eberly 2002), and the ring
+//  is then clipped ear by ear.
+//
+//  An ear is a convex corner whose triangle holds no reflex vertex.  For
+//  rings of more than 80 vertices the candidates are found through a
+//  z-order (Morton) index of the vertices, so only those inside the bounding
+//  box of the triangle are visited and the clipping is close to O(n log n)
+//  on typical input.  When no ear is left, which happens with
+//  self-touching or self-intersecting rings, the ring is cleaned of
+//  collinear and repeated vertices, then local self-intersections are cut
+//  off, and finally it is split along a valid diagonal; the scheme is that
+//  of the earcut library (Agafonkin 2016).  The corner and inside tests use
+//  the exact vgl_orient_2d(), so near-collinear vertices are never
+//  misclassified; exactly collinear ones are dropped.
+//
+//  The vertices are numbered sheet after sheet: poly[s][j] is vertex
+//  j + poly[0].size() + ... + poly[s-1].size().  The triangles are
+//  returned as index triples in a flat buffer, counterclockwise.
+//
+// \verbatim
+//  Modifications
+// \endverbatim
+
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <cstdint>
+#include <vgl/vgl_polygon.h>
+#include <vgl/vgl_predicates.h>
+
+//: Triangulate poly; triangles receives three vertex indices per triangle.
+// \relatesalso vgl_polygon
+template <class T>
+void vgl_triangulate(vgl_polygon<T> const& poly, std::vector<unsigned>& triangles);
+
+//: the triangles of poly, three vertex indices each
+// \relatesalso vgl_polygon
+template <class T>
+std::vector<unsigned> vgl_triangulate(vgl_polygon<T> const& poly)
+{
+  std::vector<unsigned> triangles;
+  vgl_triangulate(poly, triangles);
+  return triangles;
+}
+
+namespace vgl_triangulate_detail
+{
+//: Ear clipping of one outer ring with its holes, on a doubly linked list of vertices.
+//  The rings are kept counterclockwise for outer rings and clockwise for
+//  holes, so that the inside is always to the left.
+class ear_clipper
+{
+ public:
+  explicit ear_clipper(std::vector<unsigned>& triangles) : out_(triangles) {}
+
+  //: Triangulate the ring with vertices ring[k], indexed by ids[k], and the given holes.
+  //  The ring must be counterclockwise and the holes clockwise.
+  void run(std::vector<double> const& ring, std::vector<unsigned> const& ids,
+           std::vector<std::vector<double> > const& hole_xy, std::vector<std::vector<unsigned> > const& hole_ids)
+  {
+    nodes_.clear();
+    int outer = link_ring(ring, ids);
+    if (outer < 0 || nodes_[outer].next == nodes_[outer].prev)
+      return;
+    std::vector<int> queue;
+    for (std::size_t h = 0; h < hole_xy.size(); ++h) {
+      const int list = link_ring(hole_xy[h], hole_ids[h]);
+      if (list < 0)
+        continue;
+      if (nodes_[list].next == list)
+        nodes_[list].steiner = true;
+      queue.push_back(leftmost(list));
+    }
+    std::sort(queue.begin(), queue.end(), [this](int a, int b) { return nodes_[a].x < nodes_[b].x; });
+    for (int h : queue)
+      outer = eliminate_hole(h, outer);
+
+    inv_size_ = 0.0;
+    if (nodes_.size() > 80) {
+      double hi_x = nodes_[0].x, hi_y = nodes_[0].y;
+      min_x_ = hi_x;
+      min_y_ = hi_y;
+      for (node const& p : nodes_) {
+        min_x_ = std::min(min_x_, p.x); hi_x = std::max(hi_x, p.x);
+        min_y_ = std::min(min_y_, p.y); hi_y = std::max(hi_y, p.y);
+      }
+      const double size = std::max(hi_x - min_x_, hi_y - min_y_);
+      inv_size_ = size > 0 ? 32767.0 / size : 0.0;
+    }
+    clip(outer, 0);
+  }
+
+ private:
+  struct node
+  {
+    unsigned i;              //!< the polygon vertex
+    double x, y;
+    int prev, next;          //!< along the ring
+    int prev_z, next_z;      //!< in z-order, -1 at the ends
+    std::uint32_t z;
+    bool steiner;            //!< a single-vertex hole, never removed as redundant
+  };
+
+  std::vector<unsigned>& out_;
+  std::vector<node> nodes_;
+  double min_x_ = 0.0, min_y_ = 0.0, inv_size_ = 0.0;
+
+  double orient(int p, int q, int r) const
+  { return vgl_orient_2d(nodes_[p].x, nodes_[p].y, nodes_[q].x, nodes_[q].y, nodes_[r].x, nodes_[r].y); }
+  bool equals(int p, int q) const { return nodes_[p].x == nodes_[q].x && nodes_[p].y == nodes_[q].y; }
+  //: true if (px, py) is inside or on the counterclockwise triangle abc
+  static bool in_triangle(double ax, double ay, double bx, double by, double cx, double cy, double px, double py)
+  {
+    return vgl_orient_2d(ax, ay, bx, by, px, py) >= 0 && vgl_orient_2d(bx, by, cx, cy, px, py) >= 0 &&
+           vgl_orient_2d(cx, cy, ax, ay, px, py) >= 0;
+  }
+  bool in_triangle(int a, int b, int c, int p) const
+  {
+    return in_triangle(nodes_[a].x, nodes_[a].y, nodes_[b].x, nodes_[b].y, nodes_[c].x, nodes_[c].y,
+                       nodes_[p].x, nodes_[p].y);
+  }
+
+  int insert_node(unsigned i, double x, double y, int last)
+  {
+    node n = { i, x, y, -1, -1, -1, -1, 0, false };
+    const int p = int(nodes_.size());
+    nodes_.push_back(n);
+    if (last < 0) {
+      nodes_[p].prev = nodes_[p].next = p;
+    }
+    else {
+      nodes_[p].next = nodes_[last].next;
+      nodes_[p].prev = last;
+      nodes_[nodes_[last].next].prev = p;
+      nodes_[last].next = p;
+    }
+    return p;
+  }
+
+  void remove_node(int p)
+  {
+    node& n = nodes_[p];
+    nodes_[n.next].prev = n.prev;
+    nodes_[n.prev].next = n.next;
+    if (n.prev_z >= 0) nodes_[n.prev_z].next_z = n.next_z;
+    if (n.next_z >= 0) nodes_[n.next_z].prev_z = n.prev_z;
+  }
+
+  //: a ring of the interleaved coordinates xy
+  int link_ring(std::vector<double> const& xy, std::vector<unsigned> const& ids)
+  {
+    int last = -1;
+    for (std::size_t k = 0; k < ids.size(); ++k)
+      last = insert_node(ids[k], xy[2 * k], xy[2 * k + 1], last);
+    if (last >= 0 && equals(last, nodes_[last].next)) {
+      const int next = nodes_[last].next;
+      remove_node(last);
+      last = next;
+    }
+    return last;
+  }
+
+  //: remove repeated and collinear vertices from start to end
+  int filter(int start, int end = -1)
+  {
+    if (start < 0)
+      return start;
+    if (end < 0)
+      end = start;
+    int p = start;
+    bool again;
+    do {
+      again = false;
+      node const& n = nodes_[p];
+      if (!n.steiner && (equals(p, n.next) || orient(n.prev, p, n.next) == 0)) {
+        remove_node(p);
+        p = end = n.prev;
+        if (p == nodes_[p].next)
+          break;
+        again = true;
+      }
+      else
+        p = n.next;
+    } while (again || p != end);
+    return end;
+  }
+
+  int leftmost(int start) const
+  {
+    int p = start, best = start;
+    do {
+      if (nodes_[p].x < nodes_[best].x || (nodes_[p].x == nodes_[best].x && nodes_[p].y < nodes_[best].y))
+        best = p;
+      p = nodes_[p].next;
+    } while (p != start);
+    return best;
+  }
+
+  //: true if the diagonal from a to b starts into the inside at a
+  bool locally_inside(int a, int b) const
+  {
+    node const& n = nodes_[a];
+    return orient(n.prev, a, n.next) > 0 ? orient(a, b, n.next) <= 0 && orient(a, n.prev, b) <= 0
+                                         : orient(a, b, n.prev) > 0 || orient(a, n.next, b) > 0;
+  }
+
+  //: true if the midpoint of the diagonal from a to b is inside the ring
+  bool middle_inside(int a, int b) const
+  {
+    int p = a;
+    bool inside = false;
+    const double px = (nodes_[a].x + nodes_[b].x) / 2, py = (nodes_[a].y + nodes_[b].y) / 2;
+    do {
+      node const& n = nodes_[p];
+      node const& m = nodes_[n.next];
+      if ((n.y > py) != (m.y > py) && m.y != n.y && px < (m.x - n.x) * (py - n.y) / (m.y - n.y) + n.x)
+        inside = !inside;
+      p = n.next;
+    } while (p != a);
+    return inside;
+  }
+
+  static int sign(double v) { return v > 0 ? 1 : v < 0 ? -1 : 0; }
+  //: for q collinear with p and r, true if q lies on the segment pr
+  bool on_segment(int p, int q, int r) const
+  {
+    return nodes_[q].x <= std::max(nodes_[p].x, nodes_[r].x) && nodes_[q].x >= std::min(nodes_[p].x, nodes_[r].x) &&
+           nodes_[q].y <= std::max(nodes_[p].y, nodes_[r].y) && nodes_[q].y >= std::min(nodes_[p].y, nodes_[r].y);
+  }
+  //: true if the segments p1q1 and p2q2 meet
+  bool intersects(int p1, int q1, int p2, int q2) const
+  {
+    const int o1 = sign(orient(p1, q1, p2)), o2 = sign(orient(p1, q1, q2));
+    const int o3 = sign(orient(p2, q2, p1)), o4 = sign(orient(p2, q2, q1));
+    return (o1 != o2 && o3 != o4) || (o1 == 0 && on_segment(p1, p2, q1)) || (o2 == 0 && on_segment(p1, q2, q1)) ||
+           (o3 == 0 && on_segment(p2, p1, q2)) || (o4 == 0 && on_segment(p2, q1, q2));
+  }
+  //: true if the diagonal ab crosses an edge of the ring not incident to a or b
+  bool intersects_ring(int a, int b) const
+  {
+    const unsigned ia = nodes_[a].i, ib = nodes_[b].i;
+    int p = a;
+    do {
+      const int q = nodes_[p].next;
+      if (nodes_[p].i != ia && nodes_[q].i != ia && nodes_[p].i != ib && nodes_[q].i != ib && intersects(p, q, a, b))
+        return true;
+      p = q;
+    } while (p != a);
+    return false;
+  }
+  //: true if the diagonal ab splits the ring into two valid rings
+  bool valid_diagonal(int a, int b) const
+  {
+    node const& na = nodes_[a];
+    node const& nb = nodes_[b];
+    if (nodes_[na.next].i == nb.i || nodes_[na.prev].i == nb.i || intersects_ring(a, b))
+      return false;
+    if (locally_inside(a, b) && locally_inside(b, a) && middle_inside(a, b) &&
+        (orient(na.prev, a, nb.prev) != 0 || orient(a, nb.prev, b) != 0)) // no opposite-facing sectors
+      return true;
+    // a zero-length diagonal between two convex corners
+    return equals(a, b) && orient(na.prev, a, na.next) < 0 && orient(nb.prev, b, nb.next) < 0;
+  }
+
+  //: Link a to b by two coincident edges, splitting the ring in two; returns the copy of b.
+  int split(int a, int b)
+  {
+    const int a2 = insert_node(nodes_[a].i, nodes_[a].x, nodes_[a].y, -1);
+    const int b2 = insert_node(nodes_[b].i, nodes_[b].x, nodes_[b].y, -1);
+    const int an = nodes_[a].next, bp = nodes_[b].prev;
+    nodes_[a].next = b;   nodes_[b].prev = a;
+    nodes_[a2].next = an; nodes_[an].prev = a2;
+    nodes_[b2].next = a2; nodes_[a2].prev = b2;
+    nodes_[bp].next = b2; nodes_[b2].prev = bp;
+    return b2;
+  }
+
+  //: the vertex of the outer ring to bridge the hole to, from its leftmost vertex h
+  int hole_bridge(int h, int outer) const
+  {
+    const double hx = nodes_[h].x, hy = nodes_[h].y;
+    double qx = -std::numeric_limits<double>::infinity();
+    int m = -1, p = outer;
+    // the nearest edge to the left crossed by the horizontal through h
+    do {
+      node const& n = nodes_[p];
+      node const& nn = nodes_[n.next];
+      if (hy <= n.y && hy >= nn.y && nn.y != n.y) {
+        const double x = n.x + (hy - n.y) * (nn.x - n.x) / (nn.y - n.y);
+        if (x <= hx && x > qx) {
+          qx = x;
+          m = n.x < nn.x ? p : n.next;
+          if (x == hx)
+            return m; // the hole touches the edge
+        }
+      }
+      p = n.next;
+    } while (p != outer);
+    if (m < 0)
+      return -1;
+    // a reflex vertex inside the triangle of h, the crossing and m hides m: take the one of least angle
+    const int stop = m;
+    const double mx = nodes_[m].x, my = nodes_[m].y;
+    double tan_min = std::numeric_limits<double>::infinity();
+    p = m;
+    do {
+      node const& n = nodes_[p];
+      if (hx >= n.x && n.x >= mx && hx != n.x &&
+          in_triangle(hy < my ? hx : qx, hy, mx, my, hy < my ? qx : hx, hy, n.x, n.y)) {
+        const double tan = std::abs(hy - n.y) / (hx - n.x);
+        if (locally_inside(p, h) &&
+            (tan < tan_min || (tan == tan_min && (n.x > nodes_[m].x || (n.x == nodes_[m].x && sector_contains(m, p)))))) {
+          m = p;
+          tan_min = tan;
+        }
+      }
+      p = n.next;
+    } while (p != stop);
+    return m;
+  }
+  //: whether the sector of m contains the sector of p, both at the same point
+  bool sector_contains(int m, int p) const
+  { return orient(nodes_[m].prev, m, nodes_[p].prev) > 0 && orient(nodes_[p].next, m, nodes_[m].next) > 0; }
+
+  int eliminate_hole(int h, int outer)
+  {
+    const int bridge = hole_bridge(h, outer);
+    if (bridge < 0)
+      return outer;
+    const int reverse = split(bridge, h);
+    filter(reverse, nodes_[reverse].next);
+    return filter(bridge, nodes_[bridge].next);
+  }
+
+  //: interleave the bits of the 15-bit grid coordinates of (x, y)
+  std::uint32_t z_order(double x, double y) const
+  {
+    std::uint32_t ix = std::uint32_t((x - min_x_) * inv_size_), iy = std::uint32_t((y - min_y_) * inv_size_);
+    ix = (ix | (ix << 8)) & 0x00FF00FFu; ix = (ix | (ix << 4)) & 0x0F0F0F0Fu;
+    ix = (ix | (ix << 2)) & 0x33333333u; ix = (ix | (ix << 1)) & 0x55555555u;
+    iy = (iy | (iy << 8)) & 0x00FF00FFu; iy = (iy | (iy << 4)) & 0x0F0F0F0Fu;
+    iy = (iy | (iy << 2)) & 0x33333333u; iy = (iy | (iy << 1)) & 0x55555555u;
+    return ix | (iy << 1);
+  }
+
+  //: link the ring into z-order, by a merge sort of the list
+  void index_curve(int start)
+  {
+    int p = start;
+    do {
+      node& n = nodes_[p];
+      n.z = z_order(n.x, n.y);
+      n.prev_z = n.prev;
+      n.next_z = n.next;
+      p = n.next;
+    } while (p != start);
+    nodes_[nodes_[p].prev_z].next_z = -1;
+    nodes_[p].prev_z = -1;
+
+    int list = p;
+    for (std::size_t in_size = 1;; in_size *= 2) {
+      int q = list, tail = -1;
+      list = -1;
+      std::size_t merges = 0;
+      while (q >= 0) {
+        ++merges;
+        int r = q;
+        std::size_t q_size = 0;
+        for (std::size_t k = 0; k < in_size && r >= 0; ++k, ++q_size)
+          r = nodes_[r].next_z;
+        std::size_t r_size = in_size;
+        while (q_size > 0 || (r_size > 0 && r >= 0)) {
+          int e;
+          if (q_size != 0 && (r_size == 0 || r < 0 || nodes_[q].z <= nodes_[r].z)) {
+            e = q; q = nodes_[q].next_z; --q_size;
+          }
+          else {
+            e = r; r = nodes_[r].next_z; --r_size;
+          }
+          if (tail >= 0) nodes_[tail].next_z = e;
+          else list = e;
+          nodes_[e].prev_z = tail;
+          tail = e;
+        }
+        q = r;
+      }
+      nodes_[tail].next_z = -1;
+      if (merges <= 1)
+        return;
+    }
+  }
+
+  //: true if p is a reflex or flat vertex inside or on the triangle abc, other than a, c or a copy of a
+  bool blocks(int a, int b, int c, int p, double x0, double y0, double x1, double y1) const
+  {
+    node const& n = nodes_[p];
+    return n.x >= x0 && n.x <= x1 && n.y >= y0 && n.y <= y1 && p != a && p != c && !equals(p, a) &&
+           in_triangle(a, b, c, p) && orient(n.prev, p, n.next) <= 0;
+  }
+
+  bool is_ear(int ear) const
+  {
+    const int a = nodes_[ear].prev, b = ear, c = nodes_[ear].next;
+    if (orient(a, b, c) <= 0)
+      return false; // reflex
+    const double x0 = std::min(nodes_[a].x, std::min(nodes_[b].x, nodes_[c].x));
+    const double y0 = std::min(nodes_[a].y, std::min(nodes_[b].y, nodes_[c].y));
+    const double x1 = std::max(nodes_[a].x, std::max(nodes_[b].x, nodes_[c].x));
+    const double y1 = std::max(nodes_[a].y, std::max(nodes_[b].y, nodes_[c].y));
+    if (inv_size_ == 0.0) {
+      for (int p = nodes_[c].next; p != a; p = nodes_[p].next)
+        if (blocks(a, b, c, p, x0, y0, x1, y1))
+          return false;
+      return true;
+    }
+    // only the vertices with z-order in that of the bounding box can be inside
+    const std::uint32_t min_z = z_order(x0, y0), max_z = z_order(x1, y1);
+    int p = nodes_[ear].prev_z, n = nodes_[ear].next_z;
+    while (p >= 0 && nodes_[p].z >= min_z && n >= 0 && nodes_[n].z <= max_z) {
+      if (blocks(a, b, c, p, x0, y0, x1, y1)) return false;
+      p = nodes_[p].prev_z;
+      if (blocks(a, b, c, n, x0, y0, x1, y1)) return false;
+      n = nodes_[n].next_z;
+    }
+    for (; p >= 0 && nodes_[p].z >= min_z; p = nodes_[p].prev_z)
+      if (blocks(a, b, c, p, x0, y0, x1, y1)) return false;
+    for (; n >= 0 && nodes_[n].z <= max_z; n = nodes_[n].next_z)
+      if (blocks(a, b, c, n, x0, y0, x1, y1)) return false;
+    return true;
+  }
+
+  void emit(int a, int b, int c)
+  {
+    out_.push_back(nodes_[a].i);
+    out_.push_back(nodes_[b].i);
+    out_.push_back(nodes_[c].i);
+  }
+
+  //: cut off the triangles of local self-intersections, where edges p.prev-p and p.next-p.next.next cross
+  int cure_local_intersections(int start)
+  {
+    int p = start;
+    do {
+      const int a = nodes_[p].prev, pn = nodes_[p].next, b = nodes_[pn].next;
+      if (!equals(a, b) && intersects(a, p, pn, b) && locally_inside(a, b) && locally_inside(b, a)) {
+        emit(a, p, b);
+        remove_node(p);
+        remove_node(pn);
+        p = start = b;
+      }
+      p = nodes_[p].next;
+    } while (p != start);
+    return filter(p);
+  }
+
+  //: split the ring along a valid diagonal and triangulate both parts
+  void split_clip(int start)
+  {
+    int a = start;
+    do {
+      for (int b = nodes_[nodes_[a].next].next; b != nodes_[a].prev; b = nodes_[b].next)
+        if (nodes_[a].i != nodes_[b].i && valid_diagonal(a, b)) {
+          int c = split(a, b);
+          a = filter(a, nodes_[a].next);
+          c = filter(c, nodes_[c].next);
+          clip(a, 0);
+          clip(c, 0);
+          return;
+        }
+      a = nodes_[a].next;
+    } while (a != start);
+  }
+
+  //: Clip the ears of the ring from ear on.
+  //  Pass 0 is plain clipping, then 1 after removing redundant vertices,
+  //  2 after curing local self-intersections, and last the split.
+  void clip(int ear, int pass)
+  {
+    if (ear < 0)
+      return;
+    if (pass == 0 && inv_size_ != 0.0)
+      index_curve(ear);
+    int stop = ear;
+    while (nodes_[ear].prev != nodes_[ear].next) {
+      const int prev = nodes_[ear].prev, next = nodes_[ear].next;
+      if (is_ear(ear)) {
+        emit(prev, ear, next);
+        remove_node(ear);
+        ear = stop = nodes_[next].next;
+        continue;
+      }
+      ear = next;
+      if (ear == stop) {
+        if (pass == 0)
+          clip(filter(ear), 1);
+        else if (pass == 1)
+          clip(cure_local_intersections(filter(ear)), 2);
+        else
+          split_clip(ear);
+        return;
+      }
+    }
+  }
+};
+
+//: true if (x, y) is inside the ring of n interleaved coordinates xy, by crossings
+inline bool ring_contains(std::vector<double> const& xy, double x, double y)
+{
+  const std::size_t n = xy.size() / 2;
+  bool inside = false;
+  for (std::size_t i = 0, j = n - 1; i < n; j = i++) {
+    const double xi = xy[2 * i], yi = xy[2 * i + 1], xj = xy[2 * j], yj = xy[2 * j + 1];
+    if ((yi > y) != (yj > y) && x < (xj - xi) * (y - yi) / (yj - yi) + xi)
+      inside = !inside;
+  }
+  return inside;
+}
+
+inline void reverse_ring(std::vector<double>& xy, std::vector<unsigned>& ids)
+{
+  const std::size_t n = ids.size();
+  for (std::size_t i = 0, j = n - 1; i < j; ++i, --j) {
+    std::swap(xy[2 * i], xy[2 * j]);
+    std::swap(xy[2 * i + 1], xy[2 * j + 1]);
+    std::swap(ids[i], ids[j]);
+  }
+}
+} // namespace vgl_triangulate_detail
+
+template <class T>
+void vgl_triangulate(vgl_polygon<T> const& poly, std::vector<unsigned>& triangles)
+{
+  using vgl_triangulate_detail::reverse_ring;
+  triangles.clear();
+  const unsigned ns = poly.num_sheets();
+  std::vector<std::vector<double> > xy(ns);
+  std::vector<std::vector<unsigned> > ids(ns);
+  std::vector<double> box(4 * ns);
+  std::vector<unsigned> rings; // the sheets of non-zero area
+  unsigned first = 0;
+  for (unsigned s = 0; s < ns; ++s) {
+    const unsigned m = unsigned(poly[s].size());
+    for (unsigned j = 0; j < m; ++j) {
+      xy[s].push_back(double(poly[s][j].x()));
+      xy[s].push_back(double(poly[s][j].y()));
+      ids[s].push_back(first + j);
+    }
+    first += m;
+    const double area2 = m < 3 ? 0.0 : vgl_orient_2d(poly[s]);
+    if (area2 == 0.0)
+      continue;
+    rings.push_back(s);
+    if (area2 < 0) // make it counterclockwise
+      reverse_ring(xy[s], ids[s]);
+    double* b = &box[4 * s];
+    b[0] = b[2] = xy[s][0];
+    b[1] = b[3] = xy[s][1];
+    for (unsigned j = 1; j < m; ++j) {
+      b[0] = std::min(b[0], xy[s][2 * j]); b[2] = std::max(b[2], xy[s][2 * j]);
+      b[1] = std::min(b[1], xy[s][2 * j + 1]); b[3] = std::max(b[3], xy[s][2 * j + 1]);
+    }
+  }
+  // nesting depth of each ring, from its first vertex; the parent of a hole is the enclosing ring one level up
+  std::vector<unsigned> depth(ns, 0);
+  std::vector<std::vector<unsigned> > around(ns);
+  for (unsigned s : rings) {
+    const double x = xy[s][0], y = xy[s][1];
+    for (unsigned t : rings) {
+      double const* b = &box[4 * t];
+      if (t != s && x >= b[0] && x <= b[2] && y >= b[1] && y <= b[3] &&
+          vgl_triangulate_detail::ring_contains(xy[t], x, y))
+        around[s].push_back(t);
+    }
+    depth[s] = unsigned(around[s].size());
+  }
+  std::vector<std::vector<unsigned> > holes(ns);
+  for (unsigned s : rings)
+    if (depth[s] % 2 == 1)
+      for (unsigned t : around[s])
+        if (depth[t] + 1 == depth[s])
+          holes[t].push_back(s);
+
+  vgl_triangulate_detail::ear_clipper clipper(triangles);
+  std::vector<std::vector<double> > hole_xy;
+  std::vector<std::vector<unsigned> > hole_ids;
+  for (unsigned s : rings)
+    if (depth[s] % 2 == 0) {
+      hole_xy.clear();
+      hole_ids.clear();
+      for (unsigned h : holes[s]) {
+        hole_xy.push_back(xy[h]);
+        hole_ids.push_back(ids[h]);
+        reverse_ring(hole_xy.back(), hole_ids.back()); // clockwise
+      }
+      clipper.run(xy[s], ids[s], hole_xy, hole_ids);
+    }
+}
+
+#endif // vgl_triangulate_h_
@@ -0,0 +1,205 @@
+// This is core/vnl/algo/vnl_convolve.h
+#ifndef vnl_convolve_h_
+#define vnl_convolve_h_
+//:
+// \file
+// \brief Linear and cyclic convolution and correlation of real signals
+//
+//  vnl_convolve() and vnl_correlate() evaluate either directly, in
+//  O(n*m) for signal length n and kernel length m, or by overlap-add FFT
+//  in O(n log m).  By default the cheaper of the two is chosen from the
+//  sizes, so short smoothing kernels stay on the direct loop while long
+//  kernels and template matching go through the FFT.
+//
+//  The FFT path keeps one Eigen::FFT object per thread and scalar type,
+//  which caches the twiddle factors of every transform size it has seen.
+//
+// \verbatim
+//  Modifications
+// \endverbatim
+
+#include <vector>
+#include <complex>
+#include <algorithm>
+#include <cmath>
+#include <cassert>
+
+#include <vnl/vnl_vector.h>
+#include <vnl/algo/vnl_fft_1d.h>
+
+#include <unsupported/Eigen/FFT>
+
+//: How vnl_convolve() and vnl_correlate() evaluate the result
+enum vnl_convolve_method
+{
+  vnl_convolve_auto,   //!< choose from the signal and kernel sizes
+  vnl_convolve_direct, //!< direct summation, O(n*m)
+  vnl_convolve_fft     //!< overlap-add FFT, O(n log m)
+};
+
+//: Linear convolution of two vectors; the result has v1.size()+v2.size()-1 elements.
+//  result[k] = sum_i v1[i] * v2[k-i]
+template <class T>
+vnl_vector<T> vnl_convolve(vnl_vector<T> const& v1, vnl_vector<T> const& v2,
+                           vnl_convolve_method method = vnl_convolve_auto);
+
+//: Linear cross-correlation of \a signal with \a kernel; the result has signal.size()+kernel.size()-1 elements.
+//  result[k] = sum_i signal[i + k - (kernel.size()-1)] * kernel[i],
+//  i.e. element k corresponds to shifting the kernel by k-(kernel.size()-1).
+template <class T>
+vnl_vector<T> vnl_correlate(vnl_vector<T> const& signal, vnl_vector<T> const& kernel,
+                            vnl_convolve_method method = vnl_convolve_auto);
+
+//: Cyclic convolution of two vectors of the same length, computed by FFT.
+//  If xcorr is true, the cyclic cross-correlation sum_i v1[i+k] v2[i] is returned instead.
+template <class T>
+vnl_vector<T> vnl_convolve_cyclic(vnl_vector<T> const& v1, vnl_vector<T> const& v2, bool xcorr = false);
+
+// copy from .cpp
+namespace vnl_convolve_detail
+{
+  inline int next_pow2(int n)
+  {
+    int p = 1;
+    while (p < n) p <<= 1;
+    return p;
+  }
+
+  //: FFT length for overlap-add of a signal of length n with a kernel of length m <= n
+  //  A whole-signal transform is used when that is not much longer than a block.
+  inline int fft_size(int n, int m)
+  {
+    const int whole = std::max(2, next_pow2(n + m - 1)); // kissfft cannot do length 1
+    const int block = std::max(64, next_pow2(4 * m));
+    return std::min(whole, block);
+  }
+
+  //: true if overlap-add is expected to be cheaper than direct summation
+  inline bool prefer_fft(int n, int m)
+  {
+    if (m <= 16) return false;
+    const int nfft = fft_size(n, m);
+    const int blocks = (n + nfft - m) / (nfft - m + 1);
+    const double direct_cost = double(n) * double(m);
+    // two real transforms of length nfft and a spectrum product per block
+    const double fft_cost = double(blocks) * double(nfft) * (3.0 * std::log2(double(nfft)) + 4.0);
+    return fft_cost < direct_cost;
+  }
+
+  //: the per-thread FFT object; it caches one plan per transform size
+  template <class T>
+  Eigen::FFT<T>& fft()
+  {
+    static thread_local Eigen::FFT<T> instance;
+    return instance;
+  }
+
+  //: out[0..n+m-1) = a[0..n) * b[0..m), direct summation
+  template <class T>
+  void convolve_direct(T const* a, int n, T const* b, int m, T* out)
+  {
+    std::fill(out, out + n + m - 1, T(0));
+    for (int i = 0; i < n; ++i) {
+      const T ai = a[i];
+      T* o = out + i;
+      for (int j = 0; j < m; ++j)
+        o[j] += ai * b[j];
+    }
+  }
+
+  //: out[0..n+m-1) = a[0..n) * b[0..m) by overlap-add, with m <= n
+  template <class T>
+  void convolve_fft(T const* a, int n, T const* b, int m, T* out)
+  {
+    using complex_t = std::complex<T>;
+    Eigen::FFT<T>& f = fft<T>();
+    f.SetFlag(Eigen::FFT<T>::HalfSpectrum);
+    f.ClearFlag(Eigen::FFT<T>::Unscaled);
+
+    const int nfft = fft_size(n, m);
+    const int L = nfft - m + 1; // useful output samples per block
+    const int nspec = nfft / 2 + 1;
+    std::vector<T> block(nfft);
+    std::vector<complex_t> H(nspec), X(nspec);
+
+    std::fill(block.begin(), block.end(), T(0));
+    std::copy(b, b + m, block.begin());
+    f.fwd(H.data(), block.data(), nfft);
+
+    const int nout = n + m - 1;
+    std::fill(out, out + nout, T(0));
+    for (int start = 0; start < n; start += L) {
+      const int len = std::min(L, n - start);
+      std::copy(a + start, a + start + len, block.begin());
+      std::fill(block.begin() + len, block.end(), T(0));
+      f.fwd(X.data(), block.data(), nfft);
+      for (int k = 0; k < nspec; ++k)
+        X[k] *= H[k];
+      f.inv(block.data(), X.data(), nfft);
+      const int stop = std::min(nfft, nout - start);
+      T* o = out + start;
+      for (int k = 0; k < stop; ++k)
+        o[k] += block[k];
+    }
+    f.ClearFlag(Eigen::FFT<T>::HalfSpectrum);
+  }
+
+  template <class T>
+  void convolve(T const* a, int n, T const* b, int m, T* out, vnl_convolve_method method)
+  {
+    if (n < m) { std::swap(a, b); std::swap(n, m); }
+    bool use_fft = (method == vnl_convolve_fft) ||
+                   (method == vnl_convolve_auto && prefer_fft(n, m));
+    if (use_fft) convolve_fft(a, n, b, m, out);
+    else         convolve_direct(a, n, b, m, out);
+  }
+} // namespace vnl_convolve_detail
+
+template <class T>
+vnl_vector<T> vnl_convolve(vnl_vector<T> const& v1, vnl_vector<T> const& v2, vnl_convolve_method method)
+{
+  if (v1.empty() || v2.empty())
+    return vnl_vector<T>();
+  vnl_vector<T> result(v1.size() + v2.size() - 1);
+  vnl_convolve_detail::convolve(v1.data_block(), int(v1.size()), v2.data_block(), int(v2.size()),
+                                result.data_block(), method);
+  return result;
+}
+
+template <class T>
+vnl_vector<T> vnl_correlate(vnl_vector<T> const& signal, vnl_vector<T> const& kernel, vnl_convolve_method method)
+{
+  if (signal.empty() || kernel.empty())
+    return vnl_vector<T>();
+  vnl_vector<T> flipped(kernel);
+  flipped.flip();
+  return vnl_convolve(signal, flipped, method);
+}
+
+template <class T>
+vnl_vector<T> vnl_convolve_cyclic(vnl_vector<T> const& v1, vnl_vector<T> const& v2, bool xcorr)
+{
+  assert(v1.size() == v2.size());
+  const int n = int(v1.size());
+  if (n == 0)
+    return vnl_vector<T>();
+  if (n == 1)
+    return vnl_vector<T>(1, v1[0] * v2[0]);
+  using complex_t = std::complex<T>;
+  Eigen::FFT<T>& f = vnl_convolve_detail::fft<T>();
+  f.SetFlag(Eigen::FFT<T>::HalfSpectrum);
+  f.ClearFlag(Eigen::FFT<T>::Unscaled);
+
+  const int nspec = n / 2 + 1;
+  std::vector<complex_t> X1(nspec), X2(nspec);
+  f.fwd(X1.data(), v1.data_block(), n);
+  f.fwd(X2.data(), v2.data_block(), n);
+  for (int k = 0; k < nspec; ++k)
+    X1[k] *= xcorr ? std::conj(X2[k]) : X2[k];
+  vnl_vector<T> result(n);
+  f.inv(result.data_block(), X1.data(), n);
+  f.ClearFlag(Eigen::FFT<T>::HalfSpectrum);
+  return result;
+}
+
+#endif // vnl_convolve_h_
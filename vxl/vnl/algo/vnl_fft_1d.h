@@ -0,0 +1,110 @@
+// This is core/vnl/algo/vnl_fft_1d.h
+#ifndef vnl_fft_1d_h_
+#define vnl_fft_1d_h_
+//:
+// \file
+// \brief In-place 1D fast Fourier transform
+//
+//  The transform is computed by the kissfft backend of Eigen's unsupported
+//  FFT module.  A vnl_fft_1d object is a "plan" for one signal length: the
+//  scratch buffer is allocated by the constructor and the twiddle factors by
+//  the first transform, and both are reused by every later transform, so keep
+//  the object around when many signals of the same length are transformed.
+//
+//  As in VXL, the backward transform is not normalised: bwd(fwd(x)) == N*x.
+//
+// \verbatim
+//  Modifications
+// \endverbatim
+
+#include <vector>
+#include <complex>
+#include <cassert>
+
+#include <vnl/vnl_vector.h>
+
+#include <unsupported/Eigen/FFT>
+
+//: In-place 1D fast Fourier transform
+//  The forward transform is X[k] = sum_n x[n] exp(-2 pi i k n / N).
+
+template <class T>
+class vnl_fft_1d
+{
+ public:
+  using complex_t = std::complex<T>;
+
+  //: constructor takes length of signal.
+  vnl_fft_1d(int N) : n_(N), buf_(N)
+  {
+    assert(N > 0);
+    fft_.SetFlag(Eigen::FFT<T>::Unscaled);
+  }
+
+  //: return size of signal.
+  int size() const { return n_; }
+
+  //: dir = +1/-1 according to direction of transform.
+  void transform(complex_t* signal, int dir)
+  {
+    if (n_ == 1) return; // kissfft does not handle the trivial length
+    if (dir > 0) fft_.fwd(buf_.data(), signal, n_);
+    else         fft_.inv(buf_.data(), signal, n_);
+    std::copy(buf_.begin(), buf_.end(), signal);
+  }
+
+  //: dir = +1/-1 according to direction of transform.
+  void transform(vnl_vector<complex_t>& signal, int dir)
+  {
+    assert(int(signal.size()) == n_);
+    transform(signal.data_block(), dir);
+  }
+
+  //: forward FFT
+  void fwd_transform(vnl_vector<complex_t>& signal) { transform(signal, +1); }
+
+  //: backward (inverse) FFT, not scaled by 1/N
+  void bwd_transform(vnl_vector<complex_t>& signal) { transform(signal, -1); }
+
+  //: forward FFT of a real signal.
+  //  Only the non-redundant half of the (Hermitian) spectrum is returned,
+  //  i.e. \a spectrum has size()/2+1 elements.
+  void fwd_transform(vnl_vector<T> const& signal, vnl_vector<complex_t>& spectrum)
+  {
+    assert(int(signal.size()) == n_);
+    spectrum.resize(n_/2 + 1);
+    fwd_real(signal.data_block(), spectrum.data_block());
+  }
+
+  //: backward FFT of a Hermitian spectrum into a real signal, not scaled by 1/N.
+  //  \a spectrum holds the size()/2+1 non-redundant coefficients.
+  void bwd_transform(vnl_vector<complex_t> const& spectrum, vnl_vector<T>& signal)
+  {
+    assert(int(spectrum.size()) == n_/2 + 1);
+    signal.resize(n_);
+    bwd_real(spectrum.data_block(), signal.data_block());
+  }
+
+  //: forward real-to-complex FFT on raw storage; \a spectrum receives size()/2+1 values
+  void fwd_real(T const* signal, complex_t* spectrum)
+  {
+    if (n_ == 1) { spectrum[0] = signal[0]; return; }
+    fft_.SetFlag(Eigen::FFT<T>::HalfSpectrum);
+    fft_.fwd(spectrum, signal, n_);
+    fft_.ClearFlag(Eigen::FFT<T>::HalfSpectrum);
+  }
+
+  //: backward complex-to-real FFT on raw storage, not scaled by 1/N
+  void bwd_real(complex_t const* spectrum, T* signal)
+  {
+    if (n_ == 1) { signal[0] = spectrum[0].real(); return; }
+    fft_.inv(signal, spectrum, n_);
+  }
+
+ private:
+  int n_;
+  Eigen::FFT<T> fft_;
+  std::vector<complex_t> buf_;
+};
+
+#endif // vnl_fft_1d_h_
@@ -0,0 +1,94 @@
+// This is core/vnl/algo/vnl_fft_2d.h
+#ifndef vnl_fft_2d_h_
+#define vnl_fft_2d_h_
+//:
+// \file
+// \brief In-place 2D fast Fourier transform
+//
+//  Row-column decomposition on top of vnl_fft_1d: every row is transformed
+//  in place (vnl_matrix is row-major, so rows are contiguous), then every
+//  column is gathered into a scratch buffer, transformed and scattered back.
+//  The row and column plans are built once per object.
+//
+//  As in VXL, the backward transform is not normalised: bwd(fwd(X)) == M*N*X.
+//
+// \verbatim
+//  Modifications
+// \endverbatim
+
+#include <vector>
+#include <complex>
+#include <cassert>
+
+#include <vnl/vnl_matrix.h>
+#include <vnl/algo/vnl_fft_1d.h>
+
+//: In-place 2D fast Fourier transform
+
+template <class T>
+class vnl_fft_2d
+{
+ public:
+  using complex_t = std::complex<T>;
+
+  //: constructor takes size of signal.
+  vnl_fft_2d(int M, int N) : row_plan_(N), col_plan_(M), column_(M) {}
+
+  //: dir = +1/-1 according to direction of transform.
+  void transform(vnl_matrix<complex_t>& signal, int dir)
+  {
+    assert(int(signal.rows()) == rows() && int(signal.cols()) == cols());
+    for (int r = 0; r < rows(); ++r)
+      row_plan_.transform(signal[r], dir);
+    transform_columns(signal, dir);
+  }
+
+  //: forward FFT
+  void fwd_transform(vnl_matrix<complex_t>& signal) { transform(signal, +1); }
+
+  //: backward (inverse) FFT, not scaled by 1/(M*N)
+  void bwd_transform(vnl_matrix<complex_t>& signal) { transform(signal, -1); }
+
+  //: forward FFT of a real signal into its full rows() x cols() spectrum.
+  //  The row pass uses the real-to-complex transform.
+  void fwd_transform(vnl_matrix<T> const& signal, vnl_matrix<complex_t>& spectrum)
+  {
+    assert(int(signal.rows()) == rows() && int(signal.cols()) == cols());
+    const int N = cols();
+    spectrum.resize(rows(), N);
+    for (int r = 0; r < rows(); ++r) {
+      complex_t* out = spectrum[r];
+      row_plan_.fwd_real(signal[r], out);
+      // restore the redundant half from Hermitian symmetry
+      for (int c = N/2 + 1; c < N; ++c)
+        out[c] = std::conj(out[N - c]);
+    }
+    transform_columns(spectrum, +1);
+  }
+
+  //: return number of rows.
+  int rows() const { return col_plan_.size(); }
+
+  //: return number of columns.
+  int cols() const { return row_plan_.size(); }
+
+ private:
+  void transform_columns(vnl_matrix<complex_t>& signal, int dir)
+  {
+    const int M = rows(), N = cols();
+    complex_t* col = column_.data();
+    for (int c = 0; c < N; ++c) {
+      for (int r = 0; r < M; ++r) col[r] = signal(r, c);
+      col_plan_.transform(col, dir);
+      for (int r = 0; r < M; ++r) signal(r, c) = col[r];
+    }
+  }
+
+  //: plan for the rows, of length cols()
+  vnl_fft_1d<T> row_plan_;
+  //: plan for the columns, of length rows()
+  vnl_fft_1d<T> col_plan_;
+  std::vector<complex_t> column_;
+};
+
+#endif // vnl_fft_2d_h_
@@ -18,51 +18,75 @@
 //   28/03/2001 - dac (Manchester) - tidied up documentation
 //   13 Jan.2003 - Peter Vanroose - added missing implementation for inverse(),
 //                                tinverse(), solve(matrix), extract_q_and_r().
+//   header-only port: factorise in place (optionally in caller storage),
+//                     column pivoting, blocked multi-rhs solve, and
+//                     LINPACK dchud/dchdd style row update/downdate.
 // \endverbatim
 
 #include <iosfwd>
 #include <iostream>
 #include <complex>
+#include <vector>
+#include <cmath>
 #include <cassert>
 
+#include <vnl/vnl_numeric_traits.h>
 #include <vnl/vnl_vector.h>
 #include <vnl/vnl_matrix.h>
 #include <vnl/vnl_math.h>
 
 #include <Eigen/Dense>
 
-//#include <vnl/algo/vnl_algo_export.h>
-//#include <vnl/vnl_complex.h>  // vnl_math::squared_magnitude()
-//#include <vnl/vnl_matlab_print.h>
-//#include <vnl/vnl_complex_traits.h>
-//#include <vnl/algo/vnl_netlib.h> // dqrdc_(), dqrsl_()
-
 //: Extract the Q*R decomposition of matrix M.
 //  M: m x n, Q: mxm, R:mxn
 //
 //  The decomposition is stored in a compact and time-efficient
 // packed form, which is most easily used via the "solve" and
 // "determinant" methods.
+//
+//  With column pivoting the factorisation is M P = Q R, where the diagonal
+// of R is non-increasing in magnitude, so rank() is reliable.  Without
+// pivoting P is the identity.
+//
+//  The packed form lives either in a copy owned by the object or, with the
+// vnl_qr(vnl_matrix<T>*) constructor, in the caller's matrix, which is
+// overwritten and must outlive the vnl_qr object.
+//
+//  For least squares problems that grow (or slide) row by row, set_rhs(),
+// add_row(), remove_row() and solution() update R and Q'b in O(n^2) per
+// row instead of refactorising in O(m n^2).  Q() is no longer available
+// once the factorisation has been updated.
 
 template <class T>
 class vnl_qr
 {
     using RowMajorMatrix = Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+    using ColumnVector = Eigen::Matrix<T, Eigen::Dynamic, 1>;
+    using PackedMap = Eigen::Map<RowMajorMatrix>;
+    using ConstPackedMap = Eigen::Map<const RowMajorMatrix>;
+    using HouseholderSequence = Eigen::HouseholderSequence<ConstPackedMap,
+        typename Eigen::internal::remove_all<typename ColumnVector::ConjugateReturnType>::type>;
+    using Reflectors = Eigen::HouseholderSequence<ConstPackedMap, ColumnVector>;
  public:
-    vnl_qr(vnl_matrix<T> const & M);
+    using abs_t = typename vnl_numeric_traits<T>::abs_t;
+
+    //: Factorise a copy of M.  If pivot is true, use column pivoting.
+    vnl_qr(vnl_matrix<T> const & M, bool pivot = false);
+
+    //: Factorise *M in place; *M is overwritten by the packed factorisation.
+    //  No copy of M is made, so *M must outlive this object and must not be resized.
+    vnl_qr(vnl_matrix<T> * M, bool pivot = false);
     ~vnl_qr();
-    
-    /*
+
     //: return the inverse matrix of M
     vnl_matrix<T> inverse () const;
     //: return the transpose of the inverse matrix of M
     vnl_matrix<T> tinverse () const;
-     */
     //: return the original matrix M
     vnl_matrix<T> recompose () const;
-     
 
     //: Solve equation M x = rhs for x using the computed decomposition.
+    //  All columns of rhs are solved together, with blocked application of Q'.
     vnl_matrix<T> solve (const vnl_matrix<T>& rhs) const;
     //: Solve equation M x = rhs for x using the computed decomposition.
     vnl_vector<T> solve (const vnl_vector<T>& rhs) const;
@@ -75,23 +99,83 @@ class vnl_qr
     T determinant() const;
 
     //: Return residual vector d of M x = b -> d = Q'b
-    //vnl_vector<T> QtB(const vnl_vector<T>& b) const;
+    vnl_vector<T> QtB(const vnl_vector<T>& b) const;
 
     //: Unpack and return unitary part Q.
     vnl_matrix<T> const& Q() const;
     //: Unpack and return R.
     vnl_matrix<T> const& R() const;
-    //void extract_q_and_r(vnl_matrix<T>* q, vnl_matrix<T>* r) const { *q = Q(); *r = R(); }
-    
+    void extract_q_and_r(vnl_matrix<T>* q, vnl_matrix<T>* r) const { *q = Q(); *r = R(); }
+
+    //: Numerical rank: the number of diagonal elements of R larger than
+    //  eps * max(rows, cols) * max|r_ii|.  Only reliable with column pivoting.
+    unsigned rank() const;
+
+    //: true if the factorisation was computed with column pivoting
+    bool pivoting() const { return pivoting_; }
+
+    //: Column permutation P of M P = Q R: column k of R belongs to column permutation()[k] of M.
+    std::vector<int> permutation() const;
+
+    // Updating -----------------------------------------------------------------
+
+    //: Start tracking the right hand side b for add_row() and remove_row().
+    //  Stores the leading n elements of Q'b and the residual norm of the least squares solution.
+    void set_rhs(vnl_vector<T> const& b);
+
+    //: Append the row a to M and the element beta to the tracked right hand side.
+    //  R and Q'b are updated by n Givens rotations (LINPACK dchud).  Requires rows() >= cols().
+    void add_row(vnl_vector<T> const& a, T beta = T(0));
+
+    //: Remove the row a from M and the element beta from the tracked right hand side.
+    //  Uses the LINPACK dchdd downdate.  Returns false, leaving the factorisation
+    //  unchanged, if the downdated matrix would not have full column rank or the
+    //  residual would become negative, i.e. if (a, beta) was not a row of the system.
+    bool remove_row(vnl_vector<T> const& a, T beta = T(0));
+
+    //: Least squares solution of the tracked system (see set_rhs(), add_row()).
+    vnl_vector<T> solution() const;
+
+    //: Residual norm ||M x - b|| of the tracked system at x = solution().
+    abs_t residual_norm() const { return rho_; }
+
+    //: Number of rows of M, including appended rows.
+    unsigned rows() const { return m_; }
+    //: Number of columns of M.
+    unsigned cols() const { return n_; }
+
  private:
-    
+    void factorise(bool pivot);
+    //: switch from the Householder form to an explicit n x n R in the top of the packed storage
+    void make_updatable();
+    //: y := R11^{-1} y(0:r) with y(r:n) = 0, then x := P y
+    template <class Mat>
+    vnl_matrix<T> back_substitute(Mat& c, unsigned ncols) const;
+    void clear_cache() const { delete Q_; Q_ = nullptr; delete R_; R_ = nullptr; }
+
+    //: Q as a product of the Householder reflectors in the packed storage
+    HouseholderSequence householder() const { return HouseholderSequence(packed(), hcoeffs_.conjugate()); }
+    //: Q' = (H_0 H_1 ...)^T, as in Eigen's own solvers
+    Reflectors householder_adjoint() const { return Reflectors(packed(), hcoeffs_).transpose(); }
+    PackedMap packed() { return PackedMap(qr_, packed_rows_, n_); }
+    ConstPackedMap packed() const { return ConstPackedMap(qr_, packed_rows_, n_); }
+
     int m_; // rows of input matrix
     int n_; // cols of input matrix
-    
+    int packed_rows_; // rows of the packed storage, m_ until the first update
+
+    RowMajorMatrix own_; // packed storage when factorising a copy
+    T* qr_;              // packed storage: own_ or the caller's matrix
+    ColumnVector hcoeffs_;
+    Eigen::PermutationMatrix<Eigen::Dynamic, Eigen::Dynamic, int> perm_;
+    bool pivoting_;
+    bool updated_; // Householder vectors have been discarded by add_row()/remove_row()
+
+    ColumnVector qtb_; // leading n elements of Q'b for the tracked rhs
+    abs_t rho_;        // residual norm of the tracked rhs
+
     mutable vnl_matrix<T>* Q_;
     mutable vnl_matrix<T>* R_;
-    
-    Eigen::HouseholderQR<RowMajorMatrix> qr_;
 
     // Disallow assignment.
     vnl_qr(const vnl_qr<T> &) { }
@@ -110,24 +194,38 @@ std::ostream& operator<<(std::ostream&, vnl_qr<T> const & qr);
 
 // copy from .cpp
 template <class T>
-vnl_qr<T>::vnl_qr(vnl_matrix<T> const& M):
+vnl_qr<T>::vnl_qr(vnl_matrix<T> const& M, bool pivot):
 m_(M.rows()),
 n_(M.columns()),
+packed_rows_(m_),
+own_(M),
+qr_(own_.data()),
+pivoting_(pivot),
+updated_(false),
+qtb_(ColumnVector::Zero(n_)),
+rho_(0),
 Q_(nullptr),
 R_(nullptr)
 {
     assert(! M.empty());
-    
-    RowMajorMatrix M_copy = M;
-    qr_ = Eigen::HouseholderQR<RowMajorMatrix>(M_copy);
-    
-    //Eigen::ComputationInfo info = qr_.info();
-    //if(info != Eigen::Success) {
-    //    std::cerr <<"Error: QR decomposition failed\n";
-    //}
-    
-    //std::cout<<"column permutation: \n"<<qr_.colsPermutation()<<std::endl;
-    
+    factorise(pivot);
+}
+
+template <class T>
+vnl_qr<T>::vnl_qr(vnl_matrix<T> * M, bool pivot):
+m_(M->rows()),
+n_(M->columns()),
+packed_rows_(m_),
+qr_(M->data_block()),
+pivoting_(pivot),
+updated_(false),
+qtb_(ColumnVector::Zero(n_)),
+rho_(0),
+Q_(nullptr),
+R_(nullptr)
+{
+    assert(! M->empty());
+    factorise(pivot);
 }
 
 template <class T>
@@ -137,6 +235,25 @@ vnl_qr<T>::~vnl_qr()
     delete R_;
 }
 
+//: Householder factorisation of the packed storage, in place.
+template <class T>
+void vnl_qr<T>::factorise(bool pivot)
+{
+    PackedMap A = packed();
+    Eigen::Ref<RowMajorMatrix> ref(A);
+    if (pivot) {
+        Eigen::ColPivHouseholderQR<Eigen::Ref<RowMajorMatrix> > qr(ref);
+        hcoeffs_ = qr.hCoeffs();
+        perm_ = qr.colsPermutation();
+    }
+    else {
+        // blocked Householder for large matrices
+        Eigen::HouseholderQR<Eigen::Ref<RowMajorMatrix> > qr(ref);
+        hcoeffs_ = qr.hCoeffs();
+        perm_.setIdentity(n_);
+    }
+}
+
 //: Return the determinant of M.  This is computed from M = Q R as follows:
 // |M| = |Q| |R|
 // |R| is the product of the diagonal elements.
@@ -145,39 +262,31 @@ vnl_qr<T>::~vnl_qr()
 template <class T>
 T vnl_qr<T>::determinant() const
 {
-    vnl_matrix<T> R = this->R();
-    
+    ConstPackedMap R = packed();
+
     int m = std::min(m_, n_);
     T det = R(0,0);
 
     for (int i = 1; i < m; ++i)
         det *= -R(i,i);
 
+    if (pivoting_ && perm_.determinant() < 0)
+        det = -det;
     return det;
-    
 }
 
 //: Unpack and return unitary part Q.
 template <class T>
 vnl_matrix<T> const& vnl_qr<T>::Q() const
 {
+    assert(!updated_); // Householder vectors are discarded by add_row()/remove_row()
     if(!Q_) {
         int m = m_;
-        RowMajorMatrix thinQ(m, m);
-        thinQ.setIdentity();
-        RowMajorMatrix Q = qr_.householderQ()*thinQ;
-        assert(Q.rows() == m);
-        assert(Q.cols() == m);
-        
-        Q_ = new vnl_matrix<T>(m, m);
-        
-        for(int i = 0; i<m; ++i) {
-            for(int j = 0; j<m; ++j) {
-                (*Q_)(i, j) = Q(i, j);
-            }
-        }
+        RowMajorMatrix Q = RowMajorMatrix::Identity(m, m);
+        householder().applyThisOnTheLeft(Q);
+        Q_ = new vnl_matrix<T>(Q);
     }
-    
+
     return *Q_;
 }
 
@@ -188,127 +297,254 @@ vnl_matrix<T> const& vnl_qr<T>::R() const
     if (!R_) {
         int m = m_;
         int n = n_;
-        RowMajorMatrix R = qr_.matrixQR().template triangularView<Eigen::Upper>();
-        assert(R.rows() == m);
-        assert(R.cols() == n);
-        
-        R_ = new vnl_matrix<T>(m, n);
-        for(int i = 0; i<m; ++i) {
-            for(int j = 0; j<n; ++j) {
-                (*R_)(i, j) = R(i, j);
+        ConstPackedMap A = packed();
+        R_ = new vnl_matrix<T>(m, n, T(0));
+        int k = std::min(packed_rows_, n);
+        for(int i = 0; i<k; ++i) {
+            for(int j = i; j<n; ++j) {
+                (*R_)(i, j) = A(i, j);
             }
         }
     }
-    
+
     return *R_;
 }
 
 template <class T>
 vnl_matrix<T> vnl_qr<T>::recompose() const
 {
-    return Q() * R();
+    vnl_matrix<T> QR = Q() * R();
+    if (!pivoting_)
+        return QR;
+    vnl_matrix<T> M(m_, n_);
+    for (int k = 0; k < n_; ++k)
+        M.col(perm_.indices()[k]) = QR.col(k);
+    return M;
 }
 
-// JOB: ABCDE decimal
-// A     B     C     D              E
-// ---   ---   ---   ---            ---
-// Qb    Q'b   x     norm(A*x - b)  A*x
+template <class T>
+unsigned vnl_qr<T>::rank() const
+{
+    ConstPackedMap A = packed();
+    const int k = std::min(m_, n_);
+    abs_t maxpivot(0);
+    for (int i = 0; i < k; ++i)
+        maxpivot = std::max(maxpivot, abs_t(std::abs(A(i, i))));
+    const abs_t thresh = abs_t(vnl_math::eps) * abs_t(std::max(m_, n_)) * maxpivot;
+    unsigned r = 0;
+    for (int i = 0; i < k; ++i)
+        if (std::abs(A(i, i)) > thresh) ++r;
+    return r;
+}
 
+template <class T>
+std::vector<int> vnl_qr<T>::permutation() const
+{
+    return std::vector<int>(perm_.indices().data(), perm_.indices().data() + n_);
+}
+
+//: Given c = Q'b (at least min(m,n) rows), solve the triangular system and undo the pivoting.
+template <class T>
+template <class Mat>
+vnl_matrix<T> vnl_qr<T>::back_substitute(Mat& c, unsigned ncols) const
+{
+    // with pivoting the trailing (numerically zero) part of R is ignored, giving the basic solution
+    const int r = pivoting_ ? int(rank()) : std::min(m_, n_);
+    ConstPackedMap A = packed();
+    auto top = c.topRows(r);
+    A.topLeftCorner(r, r).template triangularView<Eigen::Upper>().solveInPlace(top);
+
+    vnl_matrix<T> x(n_, ncols, T(0));
+    for (int k = 0; k < r; ++k)
+        x.row(perm_.indices()[k]) = c.row(k);
+    return x;
+}
 
 //: Solve equation M x = b for x using the computed decomposition.
 template <class T>
 vnl_vector<T> vnl_qr<T>::solve(const vnl_vector<T>& b) const
 {
-    vnl_vector<T> x = qr_.solve(b);
-    return x;
+    assert(!updated_); // use solution() after add_row()/remove_row()
+    assert(int(b.size()) == m_);
+    ColumnVector c = b;
+    c.applyOnTheLeft(householder_adjoint());
+    if (m_ < n_) c.conservativeResize(n_);
+    vnl_matrix<T> x = back_substitute(c, 1);
+    return vnl_vector<T>(x.data_block(), n_);
 }
 
-/*
 //: Return residual vector d of M x = b -> d = Q'b
 template <class T>
 vnl_vector<T> vnl_qr<T>::QtB(const vnl_vector<T>& b) const
 {
-    long n = qrdc_out_.columns();
-    long p = qrdc_out_.rows();
-    const T* b_data = b.data_block();
-    vnl_vector<T> Qt_B(n);
-    
-    // see comment above
-    long JOB = 1000;
-    
-    long info = 0;
-    vnl_linpack_qrsl(qrdc_out_.data_block(),
-                     &n, &n, &p,
-                     qraux_.data_block(),
-                     b_data,
-                     (T*)nullptr,               // A: Qb
-                     Qt_B.data_block(),   // B: Q'b
-                     (T*)nullptr,               // C: x
-                     (T*)nullptr,               // D: residual
-                     (T*)nullptr,               // E: Ax
-                     &JOB,
-                     &info);
-    
-    if (info > 0)
-        std::cerr << __FILE__ ": vnl_qr<T>::QtB() -- matrix is rank-deficient by "
-        << info << '\n';
-    
-    return Qt_B;
+    assert(!updated_);
+    assert(int(b.size()) == m_);
+    ColumnVector c = b;
+    c.applyOnTheLeft(householder_adjoint());
+    return vnl_vector<T>(c.data(), m_);
+}
+
+template <class T>
+vnl_matrix<T> vnl_qr<T>::solve(vnl_matrix<T> const& rhs) const
+{
+    assert(!updated_);
+    assert(int(rhs.rows()) == m_);
+    // column-major copy, so that each reflector updates contiguous rows of all
+    // right hand sides; Eigen applies the reflectors in blocks of 48 (compact WY)
+    Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic> c = rhs;
+    c.applyOnTheLeft(householder_adjoint());
+    if (m_ < n_) c.conservativeResize(n_, Eigen::NoChange);
+    return back_substitute(c, rhs.columns());
 }
 
 template <class T>
 vnl_matrix<T> vnl_qr<T>::inverse() const
 {
-    unsigned int r = qrdc_out_.columns();
-    assert(r > 0 && r == qrdc_out_.rows());
-    vnl_matrix<T> inv(r,r);
-    
-    // Use solve() to compute the inverse matrix, using (00..010..00) as rhs
-    vnl_vector<T> rhs(r,T(0));
-    for (unsigned int i=0; i<r; ++i)
-    {
-        rhs(i) = T(1);
-        vnl_vector<T> col = this->solve(rhs); // returns i-th column of inverse
-        inv.set_column(i,col);
-        rhs(i) = T(0);
-    }
-    return inv;
+    assert(m_ == n_);
+    vnl_matrix<T> I(m_, m_);
+    I.set_identity();
+    return solve(I);
 }
 
 template <class T>
 vnl_matrix<T> vnl_qr<T>::tinverse() const
 {
-    unsigned int r = qrdc_out_.columns();
-    assert(r > 0 && r == qrdc_out_.rows());
-    vnl_matrix<T> tinv(r,r);
-    
-    // Use solve() to compute the inverse matrix, using (00..010..00) as rhs
-    vnl_vector<T> rhs(r,T(0));
-    for (unsigned int i=0; i<r; ++i)
-    {
-        rhs(i) = T(1);
-        vnl_vector<T> col = this->solve(rhs); // returns i-th column of inverse
-        tinv.set_row(i,col);
-        rhs(i) = T(0);
+    return inverse().transpose();
+}
+
+// Updating -------------------------------------------------------------------
+
+template <class T>
+void vnl_qr<T>::set_rhs(vnl_vector<T> const& b)
+{
+    vnl_vector<T> c = QtB(b);
+    qtb_ = Eigen::Map<const ColumnVector>(c.data_block(), std::min(m_, n_));
+    if (m_ < n_) qtb_.conservativeResize(n_);
+    abs_t rho2(0);
+    for (int i = n_; i < m_; ++i)
+        rho2 += std::norm(c[i]);
+    rho_ = std::sqrt(rho2);
+}
+
+template <class T>
+void vnl_qr<T>::make_updatable()
+{
+    if (updated_) return;
+    assert(m_ >= n_);
+    PackedMap A = packed();
+    A.topRows(n_).template triangularView<Eigen::StrictlyLower>().setZero();
+    packed_rows_ = n_;
+    updated_ = true;
+}
+
+//: LINPACK dchud, with zrotg-style rotations so that complex T works too.
+template <class T>
+void vnl_qr<T>::add_row(vnl_vector<T> const& a, T beta)
+{
+    assert(int(a.size()) == n_);
+    make_updatable();
+    clear_cache();
+    PackedMap R = packed();
+    std::vector<abs_t> c(n_);
+    std::vector<T> s(n_);
+    for (int j = 0; j < n_; ++j) {
+        T xj = a[perm_.indices()[j]];
+        // apply the previous rotations to column j
+        for (int i = 0; i < j; ++i) {
+            T t = c[i] * R(i, j) + s[i] * xj;
+            xj = c[i] * xj - Eigen::numext::conj(s[i]) * R(i, j);
+            R(i, j) = t;
+        }
+        // rotation annihilating xj against R(j,j)
+        T& rjj = R(j, j);
+        const abs_t ar = std::abs(rjj);
+        if (ar == abs_t(0)) {
+            c[j] = abs_t(0); s[j] = T(1); rjj = xj;
+        }
+        else {
+            const abs_t scale = ar + std::abs(xj);
+            const abs_t norm = scale * std::sqrt(std::norm(rjj / scale) + std::norm(xj / scale));
+            const T alpha = rjj / ar;
+            c[j] = ar / norm;
+            s[j] = alpha * Eigen::numext::conj(xj) / norm;
+            rjj = alpha * norm;
+        }
+    }
+    // the same rotations on (Q'b, beta)
+    T zeta = beta;
+    for (int i = 0; i < n_; ++i) {
+        T t = c[i] * qtb_[i] + s[i] * zeta;
+        zeta = c[i] * zeta - Eigen::numext::conj(s[i]) * qtb_[i];
+        qtb_[i] = t;
     }
-    return tinv;
+    rho_ = std::hypot(rho_, abs_t(std::abs(zeta)));
+    ++m_;
 }
 
+//: LINPACK dchdd.
 template <class T>
-vnl_matrix<T> vnl_qr<T>::solve(vnl_matrix<T> const& rhs) const
+bool vnl_qr<T>::remove_row(vnl_vector<T> const& a, T beta)
 {
-    assert(rhs.rows() == qrdc_out_.columns()); // column-major storage
-    int c = qrdc_out_.rows();
-    int n = rhs.columns();
-    vnl_matrix<T> result(c,n);
-    
-    for (int i=0; i<n; ++i)
-    {
-        vnl_vector<T> b = rhs.get_column(i);
-        vnl_vector<T> col = this->solve(b); // returns i-th column of result
-        result.set_column(i,col);
+    assert(int(a.size()) == n_);
+    make_updatable();
+    PackedMap R = packed();
+
+    // solve R' s = conj(a P)
+    ColumnVector sv(n_);
+    for (int j = 0; j < n_; ++j)
+        sv[j] = Eigen::numext::conj(a[perm_.indices()[j]]);
+    for (int j = 0; j < n_; ++j)
+        if (R(j, j) == T(0)) return false;
+    R.topLeftCorner(n_, n_).template triangularView<Eigen::Upper>().adjoint().solveInPlace(sv);
+    abs_t norm = sv.norm();
+    if (norm >= abs_t(1)) return false;
+
+    // rotations that turn (R, 0) into (R_new, a)
+    std::vector<abs_t> c(n_);
+    std::vector<T> s(n_);
+    abs_t alpha = std::sqrt(abs_t(1) - norm * norm);
+    for (int i = n_ - 1; i >= 0; --i) {
+        const abs_t scale = alpha + std::abs(sv[i]);
+        const abs_t ra = alpha / scale;
+        const T rb = sv[i] / scale;
+        norm = std::sqrt(ra * ra + std::norm(rb));
+        c[i] = ra / norm;
+        s[i] = Eigen::numext::conj(rb) / norm;
+        alpha = scale * norm;
+    }
+
+    // the tracked rhs first, so that failure leaves everything unchanged
+    ColumnVector z = qtb_;
+    T zeta = beta;
+    for (int i = 0; i < n_; ++i) {
+        z[i] = (z[i] - Eigen::numext::conj(s[i]) * zeta) / c[i];
+        zeta = c[i] * zeta - s[i] * z[i];
+    }
+    const abs_t azeta = std::abs(zeta);
+    if (azeta > rho_ * (abs_t(1) + abs_t(1e3) * abs_t(vnl_math::eps)))
+        return false;
+    rho_ = azeta >= rho_ ? abs_t(0) : rho_ * std::sqrt(abs_t(1) - (azeta / rho_) * (azeta / rho_));
+    qtb_ = z;
+
+    clear_cache();
+    for (int j = n_ - 1; j >= 0; --j) {
+        T xx(0);
+        for (int i = j; i >= 0; --i) {
+            T t = c[i] * xx + s[i] * R(i, j);
+            R(i, j) = c[i] * R(i, j) - Eigen::numext::conj(s[i]) * xx;
+            xx = t;
+        }
     }
-    return result;
+    --m_;
+    return true;
 }
-*/
+
+template <class T>
+vnl_vector<T> vnl_qr<T>::solution() const
+{
+    ColumnVector c = qtb_;
+    vnl_matrix<T> x = back_substitute(c, 1);
+    return vnl_vector<T>(x.data_block(), n_);
+}
+
 #endif // vnl_qr_h_
@@ -0,0 +1,557 @@
+// This is core/vnl/algo/vnl_real_polynomial_roots.h
+#ifndef vnl_real_polynomial_roots_h_
+#define vnl_real_polynomial_roots_h_
+//:
+// \file
+// \brief Real roots of real polynomials, for minimal geometric solvers
+//
+//  All functions in this file write the distinct real roots, sorted in
+//  increasing order, into a caller-supplied array and return their number.
+//  Nothing is allocated on the heap, so the solvers can be called from the
+//  inner loop of a RANSAC or other hypothesise-and-test scheme.
+//
+//  Coefficients follow the vnl_real_polynomial convention: a[0] is the
+//  coefficient of the highest power, a[degree] is the constant term.
+//
+//  Roots closer to each other than about sqrt(eps) (relative) are reported once.
+//
+//  Strategy used by vnl_real_polynomial_real_roots():
+//  - degree <= 4: closed-form (Cardano / Ferrari), polished by Newton;
+//  - higher degree: Sturm-sequence bisection isolates each root, which is then
+//    refined by safeguarded Newton iteration;
+//  - if the Sturm chain turns out to be numerically inconsistent, the
+//    eigenvalues of the companion matrix are used instead.
+//
+// \verbatim
+//  Modifications
+// \endverbatim
+
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include <cassert>
+
+#include <vnl/vnl_math.h>
+#include <vnl/vnl_real_polynomial.h>
+
+#include <Eigen/Dense>
+
+//: Largest degree handled by the fixed-size workspace of the solvers below.
+constexpr int vnl_real_polynomial_roots_max_degree = 32;
+
+//: Real roots of a x^2 + b x + c. Returns the number of distinct roots (0, 1 or 2).
+inline int vnl_solve_quadratic(double a, double b, double c, double roots[2]);
+
+//: Real roots of a x^3 + b x^2 + c x + d. Returns the number of distinct roots.
+inline int vnl_solve_cubic(double a, double b, double c, double d, double roots[3]);
+
+//: Real roots of a x^4 + b x^3 + c x^2 + d x + e. Returns the number of distinct roots.
+inline int vnl_solve_quartic(double a, double b, double c, double d, double e, double roots[4]);
+
+//: Real roots of a[0] x^degree + ... + a[degree] in the half-open interval (lo, hi].
+//  Uses Sturm sequences for isolation and safeguarded Newton for refinement.
+//  A root lying within rounding error of \a lo or \a hi may fall on either side.
+//  Returns -1 if the polynomial is identically zero, or if the Sturm chain
+//  fails a consistency check (the caller may then use the companion matrix).
+inline int vnl_real_polynomial_sturm_roots(double const* a, int degree, double lo, double hi, double* roots);
+
+//: Real roots of a[0] x^degree + ... + a[degree] from the eigenvalues of the companion matrix.
+//  Returns -1 if the polynomial is identically zero.
+inline int vnl_real_polynomial_companion_roots(double const* a, int degree, double* roots);
+
+//: Real roots of a[0] x^degree + ... + a[degree].
+//  \a roots must have room for \a degree values.
+//  Returns -1 if the polynomial is identically zero (every x is a root).
+inline int vnl_real_polynomial_real_roots(double const* a, int degree, double* roots);
+
+//: Real roots of \a p.  \a roots must have room for p.degree() values.
+inline int vnl_real_polynomial_real_roots(vnl_real_polynomial const& p, double* roots)
+{
+  return vnl_real_polynomial_real_roots(p.coefficients().data_block(), p.degree(), roots);
+}
+
+//: Real roots of \a p in the interval (lo, hi].
+inline int vnl_real_polynomial_real_roots(vnl_real_polynomial const& p, double lo, double hi, double* roots)
+{
+  return vnl_real_polynomial_sturm_roots(p.coefficients().data_block(), p.degree(), lo, hi, roots);
+}
+
+// copy from .cpp
+namespace vnl_real_polynomial_roots_detail
+{
+  constexpr int max_coeffs = vnl_real_polynomial_roots_max_degree + 1;
+
+  //: Relative distance below which two roots are considered to be the same.
+  constexpr double merge_tol = 4.0 * vnl_math::sqrteps;
+
+  //: p(x) and p'(x) by Horner's scheme
+  inline void horner(double const* a, int n, double x, double& p, double& dp)
+  {
+    p = a[0];
+    dp = 0.0;
+    for (int i = 1; i <= n; ++i) {
+      dp = dp * x + p;
+      p = p * x + a[i];
+    }
+  }
+
+  inline double horner(double const* a, int n, double x)
+  {
+    double p = a[0];
+    for (int i = 1; i <= n; ++i)
+      p = p * x + a[i];
+    return p;
+  }
+
+  //: A few Newton steps; a step is only taken if it does not increase |p(x)|,
+  //  so that a root can never jump to a neighbouring one.
+  inline double polish(double const* a, int n, double x, int max_iter = 8)
+  {
+    double p, dp;
+    horner(a, n, x, p, dp);
+    for (int it = 0; it < max_iter && p != 0.0 && dp != 0.0; ++it) {
+      double xn = x - p / dp;
+      double pn, dpn;
+      horner(a, n, xn, pn, dpn);
+      if (!vnl_math::isfinite(xn) || std::abs(pn) >= std::abs(p))
+        break;
+      bool converged = std::abs(xn - x) <= 2.0 * vnl_math::eps * std::abs(xn);
+      x = xn; p = pn; dp = dpn;
+      if (converged)
+        break;
+    }
+    return x;
+  }
+
+  //: Sort roots[0..n) and merge near duplicates; returns the new count.
+  inline int sort_unique(double* roots, int n)
+  {
+    std::sort(roots, roots + n);
+    int k = 0;
+    for (int i = 0; i < n; ++i) {
+      if (k > 0 && std::abs(roots[i] - roots[k-1]) <= merge_tol * (1.0 + std::abs(roots[i])))
+        continue;
+      roots[k++] = roots[i];
+    }
+    return k;
+  }
+
+  //: Strip leading and trailing zero coefficients of a[0..degree] into b (made monic).
+  //  Returns the reduced degree, sets zero_root if x=0 was a root, and -1 for the zero polynomial.
+  inline int reduce(double const* a, int degree, double* b, bool& zero_root)
+  {
+    int first = 0;
+    while (first <= degree && a[first] == 0.0) ++first;
+    if (first > degree) return -1;
+    int last = degree;
+    while (a[last] == 0.0) --last;
+    zero_root = last < degree;
+    const int n = last - first;
+    const double lead = a[first];
+    for (int i = 0; i <= n; ++i)
+      b[i] = a[first + i] / lead;
+    return n;
+  }
+
+  //: Cauchy bound: all roots of the monic b satisfy |x| < bound
+  inline double root_bound(double const* b, int n)
+  {
+    double m = 0.0;
+    for (int i = 1; i <= n; ++i)
+      m = std::max(m, std::abs(b[i]));
+    return 1.0 + m;
+  }
+
+  //: Distinct real roots of a monic polynomial of degree <= 4.
+  inline int closed_form(double const* b, int n, double* roots)
+  {
+    switch (n)
+    {
+      case 0: return 0;
+      case 1: roots[0] = -b[1]; return 1;
+      case 2: return vnl_solve_quadratic(1.0, b[1], b[2], roots);
+      case 3: return vnl_solve_cubic(1.0, b[1], b[2], b[3], roots);
+      case 4: return vnl_solve_quartic(1.0, b[1], b[2], b[3], b[4], roots);
+      default: return -1;
+    }
+  }
+
+  //: Fixed-size Sturm chain p0 = p, p1 = p', p_{k+1} = -rem(p_{k-1}, p_k)
+  struct sturm_chain
+  {
+    double c[max_coeffs][max_coeffs];
+    int deg[max_coeffs];
+    int len;
+
+    bool build(double const* b, int n)
+    {
+      for (int i = 0; i <= n; ++i) c[0][i] = b[i];
+      deg[0] = n;
+      normalize(0);
+      for (int i = 0; i < n; ++i) c[1][i] = b[i] * double(n - i);
+      deg[1] = n - 1;
+      normalize(1);
+      len = 2;
+      while (deg[len-1] > 0) {
+        double const* u = c[len-2];
+        double const* v = c[len-1];
+        const int du = deg[len-2], dv = deg[len-1];
+        double r[max_coeffs];
+        for (int i = 0; i <= du; ++i) r[i] = u[i];
+        for (int k = 0; k <= du - dv; ++k) {
+          const double q = r[k] / v[0];
+          for (int j = 0; j <= dv; ++j)
+            r[k + j] -= q * v[j];
+        }
+        // remainder is r[du-dv+1 .. du], of degree at most dv-1
+        double scale = 0.0;
+        for (int i = 0; i <= du; ++i) scale = std::max(scale, std::abs(u[i]));
+        const double tol = 64.0 * vnl_math::eps * scale * double(du + 1);
+        int first = du - dv + 1;
+        while (first <= du && std::abs(r[first]) <= tol) ++first;
+        if (first > du)
+          break; // exact division: the last element is gcd(p, p')
+        double* w = c[len];
+        deg[len] = du - first;
+        for (int i = first; i <= du; ++i) w[i - first] = -r[i];
+        normalize(len);
+        ++len;
+      }
+      for (int k = 0; k < len; ++k)
+        for (int i = 0; i <= deg[k]; ++i)
+          if (!vnl_math::isfinite(c[k][i])) return false;
+      return true;
+    }
+
+    //: scale by a positive factor so that the largest coefficient has magnitude 1
+    void normalize(int k)
+    {
+      double m = 0.0;
+      for (int i = 0; i <= deg[k]; ++i) m = std::max(m, std::abs(c[k][i]));
+      if (m > 0.0)
+        for (int i = 0; i <= deg[k]; ++i) c[k][i] /= m;
+    }
+
+    //: number of sign changes of the chain at x
+    int sign_changes(double x) const
+    {
+      int changes = 0;
+      double last = 0.0;
+      for (int k = 0; k < len; ++k) {
+        const double v = horner(c[k], deg[k], x);
+        if (v == 0.0) continue;
+        if ((last < 0.0 && v > 0.0) || (last > 0.0 && v < 0.0)) ++changes;
+        last = v;
+      }
+      return changes;
+    }
+  };
+
+  //: Safeguarded Newton (rtsafe) for the single root of b in (lo, hi] where b changes sign.
+  //  A bisection step is taken whenever Newton would leave the bracket or is
+  //  converging slowly, e.g. far away from the root of a high-degree polynomial.
+  inline double refine(double const* b, int n, double lo, double hi, double flo)
+  {
+    double x = 0.5 * (lo + hi);
+    double dx_old = hi - lo, dx = dx_old;
+    for (int it = 0; it < 200; ++it) {
+      double p, dp;
+      horner(b, n, x, p, dp);
+      if (p == 0.0) return x;
+      if ((p < 0.0) == (flo < 0.0)) lo = x; else hi = x;
+      double xn = x - p / dp;
+      if (dp == 0.0 || !(xn > lo && xn < hi) || std::abs(2.0 * p) > std::abs(dx_old * dp)) {
+        dx_old = dx;
+        xn = 0.5 * (lo + hi);
+      }
+      else
+        dx_old = dx;
+      dx = xn - x;
+      if (std::abs(dx) <= 2.0 * vnl_math::eps * std::abs(xn) || hi - lo <= 2.0 * vnl_math::eps * std::abs(xn))
+        return xn;
+      x = xn;
+    }
+    return x;
+  }
+
+  //: True if |p(x)| is at the level of the rounding error of Horner's scheme.
+  inline bool is_root(double const* a, int n, double x)
+  {
+    double p = a[0], bound = std::abs(a[0]);
+    const double ax = std::abs(x);
+    for (int i = 1; i <= n; ++i) {
+      p = p * x + a[i];
+      bound = bound * ax + std::abs(a[i]);
+    }
+    return std::abs(p) <= 1e3 * double(n) * vnl_math::eps * bound;
+  }
+
+  struct sturm_solver
+  {
+    sturm_chain chain;
+    double const* b;
+    int n;
+    double* roots;
+    int count;
+    bool failed;
+
+    //: accept a root, unless the sign counts of the chain were wrong
+    void add(double x)
+    {
+      if (is_root(b, n, x)) roots[count++] = x;
+      else failed = true;
+    }
+
+    //: isolate roots in (lo, hi], given the sign change counts at both ends
+    void isolate(double lo, double hi, int vlo, int vhi, int depth)
+    {
+      const int k = vlo - vhi;
+      if (k <= 0) return;
+      const double width_tol = 4.0 * vnl_math::eps * std::max(std::abs(lo), std::abs(hi));
+      if (k == 1) {
+        double flo = horner(b, n, lo), fhi = horner(b, n, hi);
+        if (fhi == 0.0)
+          roots[count++] = hi;
+        else if ((flo < 0.0) != (fhi < 0.0) && flo != 0.0)
+          add(refine(b, n, lo, hi, flo));
+        else if (depth >= 200 || hi - lo <= width_tol)
+          add(0.5 * (lo + hi)); // root of even multiplicity
+        else {
+          const double mid = 0.5 * (lo + hi);
+          const int vmid = chain.sign_changes(mid);
+          isolate(lo, mid, vlo, vmid, depth + 1);
+          isolate(mid, hi, vmid, vhi, depth + 1);
+        }
+        return;
+      }
+      if (depth >= 200 || hi - lo <= width_tol) {
+        add(0.5 * (lo + hi)); // cluster which cannot be separated in double precision
+        return;
+      }
+      const double mid = 0.5 * (lo + hi);
+      const int vmid = chain.sign_changes(mid);
+      isolate(lo, mid, vlo, vmid, depth + 1);
+      isolate(mid, hi, vmid, vhi, depth + 1);
+    }
+  };
+} // namespace vnl_real_polynomial_roots_detail
+
+//: Real roots of a x^2 + b x + c. Returns the number of distinct roots (0, 1 or 2).
+inline int vnl_solve_quadratic(double a, double b, double c, double roots[2])
+{
+  if (a == 0.0) {
+    if (b == 0.0) return 0;
+    roots[0] = -c / b;
+    return 1;
+  }
+  double disc = b * b - 4.0 * a * c;
+  if (disc < 0.0) {
+    // a tiny negative discriminant is rounding noise around a double root
+    if (disc < -16.0 * vnl_math::eps * (b * b + std::abs(4.0 * a * c)))
+      return 0;
+    disc = 0.0;
+  }
+  if (disc == 0.0) {
+    roots[0] = -b / (2.0 * a);
+    return 1;
+  }
+  // numerically stable form, avoids cancellation between -b and sqrt(disc)
+  const double q = -0.5 * (b + (b < 0.0 ? -std::sqrt(disc) : std::sqrt(disc)));
+  double r0 = q / a;
+  double r1 = (q != 0.0) ? c / q : -r0;
+  if (r0 > r1) std::swap(r0, r1);
+  roots[0] = r0;
+  roots[1] = r1;
+  return (r0 == r1) ? 1 : 2;
+}
+
+//: Real roots of a x^3 + b x^2 + c x + d. Returns the number of distinct roots.
+inline int vnl_solve_cubic(double a, double b, double c, double d, double roots[3])
+{
+  if (a == 0.0)
+    return vnl_solve_quadratic(b, c, d, roots);
+  if (d == 0.0) {
+    int n = vnl_solve_quadratic(a, b, c, roots);
+    roots[n++] = 0.0;
+    return vnl_real_polynomial_roots_detail::sort_unique(roots, n);
+  }
+  const double A = b / a, B = c / a, C = d / a;
+  const double coeffs[4] = { 1.0, A, B, C };
+  const double Q = (A * A - 3.0 * B) / 9.0;
+  const double R = (2.0 * A * A * A - 9.0 * A * B + 27.0 * C) / 54.0;
+  const double R2 = R * R, Q3 = Q * Q * Q;
+  int n = 0;
+  if (R2 < Q3) {
+    // three real roots, trigonometric form
+    const double sq = std::sqrt(Q);
+    double ct = R / (sq * sq * sq);
+    ct = std::max(-1.0, std::min(1.0, ct));
+    const double theta = std::acos(ct);
+    roots[n++] = -2.0 * sq * std::cos(theta / 3.0) - A / 3.0;
+    roots[n++] = -2.0 * sq * std::cos((theta + vnl_math::twopi) / 3.0) - A / 3.0;
+    roots[n++] = -2.0 * sq * std::cos((theta - vnl_math::twopi) / 3.0) - A / 3.0;
+  }
+  else {
+    // one simple real root (Cardano), plus possibly a double one when R^2 == Q^3
+    const double s = std::cbrt(std::abs(R) + std::sqrt(R2 - Q3));
+    const double U = (R > 0.0) ? -s : s;
+    const double V = (U != 0.0) ? Q / U : 0.0;
+    roots[n++] = (U + V) - A / 3.0;
+    if (R2 - Q3 <= 16.0 * vnl_math::eps * (R2 + std::abs(Q3)) && Q != 0.0)
+      roots[n++] = -0.5 * (U + V) - A / 3.0;
+  }
+  for (int i = 0; i < n; ++i)
+    roots[i] = vnl_real_polynomial_roots_detail::polish(coeffs, 3, roots[i]);
+  return vnl_real_polynomial_roots_detail::sort_unique(roots, n);
+}
+
+//: Real roots of a x^4 + b x^3 + c x^2 + d x + e. Returns the number of distinct roots.
+//  Ferrari's method on the depressed quartic, with the largest root of the
+//  resolvent cubic, followed by Newton polishing on the original polynomial.
+inline int vnl_solve_quartic(double a, double b, double c, double d, double e, double roots[4])
+{
+  if (a == 0.0)
+    return vnl_solve_cubic(b, c, d, e, roots);
+  if (e == 0.0) {
+    int n = vnl_solve_cubic(a, b, c, d, roots);
+    roots[n++] = 0.0;
+    return vnl_real_polynomial_roots_detail::sort_unique(roots, n);
+  }
+  const double A = b / a, B = c / a, C = d / a, D = e / a;
+  const double coeffs[5] = { 1.0, A, B, C, D };
+  // depressed quartic y^4 + p y^2 + q y + r with x = y - A/4
+  const double A2 = A * A;
+  const double p = B - 3.0 * A2 / 8.0;
+  const double q = C - A * B / 2.0 + A2 * A / 8.0;
+  const double r = D - A * C / 4.0 + A2 * B / 16.0 - 3.0 * A2 * A2 / 256.0;
+  const double shift = -A / 4.0;
+
+  int n = 0;
+  double tmp[3];
+  // q is rounding noise if it is small compared to the terms it was computed from
+  const double q_scale = std::max(std::abs(C), std::max(std::abs(A * B) / 2.0, std::abs(A2 * A) / 8.0));
+  bool biquadratic = std::abs(q) <= 16.0 * vnl_math::eps * q_scale;
+  if (!biquadratic) {
+    // resolvent cubic m^3 + p m^2 + (p^2/4 - r) m - q^2/8 = 0 always has a positive root
+    int nm = vnl_solve_cubic(1.0, p, p * p / 4.0 - r, -q * q / 8.0, tmp);
+    double m = (nm > 0) ? tmp[nm-1] : 0.0;
+    if (m > 0.0) {
+      const double s = std::sqrt(2.0 * m);
+      const double t = q / (2.0 * s);
+      int n1 = vnl_solve_quadratic(1.0, -s, p / 2.0 + m + t, tmp);
+      for (int i = 0; i < n1; ++i) roots[n++] = tmp[i] + shift;
+      int n2 = vnl_solve_quadratic(1.0, s, p / 2.0 + m - t, tmp);
+      for (int i = 0; i < n2; ++i) roots[n++] = tmp[i] + shift;
+    }
+    else
+      biquadratic = true;
+  }
+  if (biquadratic) {
+    // z^2 + p z + r = 0 with z = y^2
+    int nz = vnl_solve_quadratic(1.0, p, r, tmp);
+    for (int i = 0; i < nz; ++i) {
+      if (tmp[i] < 0.0) continue;
+      const double y = std::sqrt(tmp[i]);
+      roots[n++] = y + shift;
+      roots[n++] = -y + shift;
+    }
+  }
+  for (int i = 0; i < n; ++i)
+    roots[i] = vnl_real_polynomial_roots_detail::polish(coeffs, 4, roots[i]);
+  return vnl_real_polynomial_roots_detail::sort_unique(roots, n);
+}
+
+inline int vnl_real_polynomial_sturm_roots(double const* a, int degree, double lo, double hi, double* roots)
+{
+  using namespace vnl_real_polynomial_roots_detail;
+  assert(degree <= vnl_real_polynomial_roots_max_degree);
+  if (degree > vnl_real_polynomial_roots_max_degree) return -1;
+
+  sturm_solver s;
+  double b[max_coeffs];
+  bool zero_root = false;
+  const int n = reduce(a, degree, b, zero_root);
+  if (n < 0) return -1;
+  int count = 0;
+  if (zero_root && lo < 0.0 && 0.0 <= hi)
+    roots[count++] = 0.0;
+  if (n == 0)
+    return count;
+
+  // never search beyond the Cauchy bound
+  const double bound = root_bound(b, n);
+  lo = std::max(lo, -bound);
+  hi = std::min(hi, bound);
+  if (!(lo < hi))
+    return count;
+
+  if (!s.chain.build(b, n)) return -1;
+  s.b = b; s.n = n; s.roots = roots + count; s.count = 0; s.failed = false;
+  const int vlo = s.chain.sign_changes(lo), vhi = s.chain.sign_changes(hi);
+  if (vlo - vhi > n) return -1;
+  s.isolate(lo, hi, vlo, vhi, 0);
+  if (s.failed || s.count != vlo - vhi) return -1;
+  for (int i = 0; i < s.count; ++i)
+    s.roots[i] = polish(b, n, s.roots[i]);
+  return sort_unique(roots, count + s.count);
+}
+
+inline int vnl_real_polynomial_companion_roots(double const* a, int degree, double* roots)
+{
+  using namespace vnl_real_polynomial_roots_detail;
+  constexpr int maxd = vnl_real_polynomial_roots_max_degree;
+  using companion_matrix = Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::ColMajor, maxd, maxd>;
+  assert(degree <= maxd);
+  if (degree > maxd) return -1;
+
+  double b[max_coeffs];
+  bool zero_root = false;
+  const int n = reduce(a, degree, b, zero_root);
+  if (n < 0) return -1;
+  int count = 0;
+  if (zero_root) roots[count++] = 0.0;
+  if (n == 0)
+    return count;
+  if (n == 1) {
+    roots[count++] = -b[1];
+    return sort_unique(roots, count);
+  }
+
+  // the storage of a max-size-bounded Eigen matrix lives on the stack
+  companion_matrix M = companion_matrix::Zero(n, n);
+  for (int j = 0; j < n; ++j) M(0, j) = -b[j + 1];
+  for (int i = 1; i < n; ++i) M(i, i - 1) = 1.0;
+  Eigen::EigenSolver<companion_matrix> es(M, false);
+  if (es.info() != Eigen::Success) return -1;
+  for (int i = 0; i < n; ++i) {
+    const std::complex<double> z = es.eigenvalues()[i];
+    // complex pairs close to the real axis are split multiple roots
+    if (std::abs(z.imag()) <= 8.0 * vnl_math::sqrteps * (1.0 + std::abs(z)))
+      roots[count++] = polish(b, n, z.real());
+  }
+  return sort_unique(roots, count);
+}
+
+inline int vnl_real_polynomial_real_roots(double const* a, int degree, double* roots)
+{
+  using namespace vnl_real_polynomial_roots_detail;
+  assert(degree <= vnl_real_polynomial_roots_max_degree);
+  if (degree > vnl_real_polynomial_roots_max_degree) return -1;
+
+  double b[max_coeffs];
+  bool zero_root = false;
+  const int n = reduce(a, degree, b, zero_root);
+  if (n < 0) return -1;
+  if (n <= 4) {
+    int count = closed_form(b, n, roots);
+    if (zero_root) roots[count++] = 0.0;
+    return sort_unique(roots, count);
+  }
+  const double inf = std::numeric_limits<double>::infinity();
+  int count = vnl_real_polynomial_sturm_roots(a, degree, -inf, inf, roots);
+  if (count < 0)
+    count = vnl_real_polynomial_companion_roots(a, degree, roots);
+  return count;
+}
+
+#endif // vnl_real_polynomial_roots_h_
@@ -104,10 +104,9 @@ public:
     //: Recompose SVD to U*W*V', using desired rank.
     vnl_matrix<T> recompose (unsigned int rank = ~0u) const; // ~0u == (unsigned int)-1
     
-    /*
     //: Solve the matrix equation M X = B, returning X
     vnl_matrix<T> solve (vnl_matrix<T> const& B) const;
-    */
+
     //: Solve the matrix-vector system M x = y, returning x.
     vnl_vector<T> solve (vnl_vector<T> const& y) const;
     /*
@@ -143,6 +142,8 @@ public:
     
     
 private:
+    //: copy of D keeping only the first min(rnk, rank()) entries
+    vnl_diag_matrix<singval_t> truncated(vnl_diag_matrix<singval_t> const& D, unsigned int rnk) const;
     
     Eigen::JacobiSVD<RowMajorMatrix> svd_;
     
@@ -273,43 +274,60 @@ void vnl_svd<T>::zero_out_relative(double tol) // sqrt(machine epsilon)
 }
 
 //: Calculate pseudo-inverse.
+// V * Winverse * U' is formed by scaling the columns of a copy of V,
+// so the diagonal is never expanded into a dense matrix.
 template <typename T>
 vnl_matrix<T> vnl_svd<T>::pinverse(unsigned int rnk) const
 {
-    if (rnk > rank_) rnk=rank_;
-    vnl_matrix<T> W_inverse(Winverse_.rows(), Winverse_.cols());
-    W_inverse.fill(T(0));
-    for (unsigned int i=0;i<rnk;++i)
-        W_inverse(i,i)=Winverse_(i,i);
-    
-    return V_ * W_inverse * U_.conjugate_transpose();
+    vnl_matrix<T> VW(V_);
+    truncated(Winverse_, rnk).scale_columns(VW);
+    return VW * U_.adjoint();
 }
 
 //: Calculate inverse of transpose, using desired rank.
 template <typename T>
 vnl_matrix<T> vnl_svd<T>::tinverse (unsigned int rnk) const // ~0u == (unsigned int)-1
 {
-    if (rnk > rank_) rnk=rank_;
-    vnl_matrix<T> W_inverse(Winverse_.rows(),Winverse_.columns());
-    W_inverse.fill(T(0));
-    for (unsigned int i=0;i<rnk;++i)
-        W_inverse(i,i)=Winverse_(i,i);
-    
-    return U_ * W_inverse * V_.conjugate_transpose();
-    
+    vnl_matrix<T> UW(U_);
+    truncated(Winverse_, rnk).scale_columns(UW);
+    return UW * V_.adjoint();
 }
 
 //: Recompose SVD to U*W*V', using desired rank.
 template <typename T>
 vnl_matrix<T> vnl_svd<T>::recompose (unsigned int rnk) const // ~0u == (unsigned int)-1
+{
+    vnl_matrix<T> UW(U_);
+    truncated(W_, rnk).scale_columns(UW);
+    return UW * V_.adjoint();
+}
+
+//: Copy of the diagonal D with the entries beyond the first rnk (and beyond rank()) set to zero.
+template <typename T>
+vnl_diag_matrix<typename vnl_svd<T>::singval_t>
+vnl_svd<T>::truncated(vnl_diag_matrix<singval_t> const& D, unsigned int rnk) const
 {
     if (rnk > rank_) rnk=rank_;
-    vnl_matrix<T> Wmatr(W_.rows(), W_.cols());
-    Wmatr.fill(T(0));
-    for (unsigned int i=0;i<rnk;++i)
-        Wmatr(i,i)=W_(i,i);
-    
-    return U_*Wmatr*V_.conjugate_transpose();
+    vnl_diag_matrix<singval_t> ret(D);
+    for (unsigned int i=rnk;i<ret.size();++i)
+        ret[i] = singval_t(0);
+    return ret;
+}
+
+//: Solve the matrix equation M X = B, returning X
+template <typename T>
+vnl_matrix<T> vnl_svd<T>::solve(vnl_matrix<T> const& B)  const
+{
+    vnl_matrix<T> x;                                      // solution matrix
+    if (U_.rows() < U_.columns()) {                       // augment y with extra rows of
+        vnl_matrix<T> yy(U_.rows(), B.columns(), T(0));   // zeros, so that it matches
+        yy.update(B);                                     // cols of u.transpose.
+        x = U_.conjugate_transpose() * yy;
+    }
+    else
+        x = U_.conjugate_transpose() * B;
+    Winverse_.scale_rows(x);                              // premultiply with diagonal 1/W
+    return V_ * x;                                        // premultiply with v.
 }
 
 //: Solve the matrix-vector system M x = y, returning x.
@@ -342,13 +360,7 @@ vnl_vector<T> vnl_svd<T>::solve(vnl_vector<T> const& y)  const
     else
         x = U_.conjugate_transpose() * y;
     
-    for (unsigned i = 0; i < x.size(); i++) {        // multiply with diagonal 1/W
-        T weight = W_(i, i), zero_(0);
-        if (weight != zero_)
-            x[i] /= weight;
-        else
-            x[i] = zero_;
-    }
+    Winverse_.scale_elements(x);                  // multiply with diagonal 1/W
     return V_ * x;                                // premultiply with v.
 }
 
@@ -0,0 +1,497 @@
+// This is core/vnl/algo/vnl_svd_incremental.h
+#ifndef vnl_svd_incremental_h_
+#define vnl_svd_incremental_h_
+//:
+// \file
+// \brief Thin SVD that is updated by appended rows and rank-one modifications
+//
+//  Implements the updates of M. Brand, "Fast low-rank modifications of the
+//  thin singular value decomposition", Linear Algebra and its Applications
+//  415 (2006).  Appending a row or adding x y' to M reduces to the SVD of a
+//  small (k+1) x (k+1) matrix, so an update costs O((m + n) k^2 + k^3) for a
+//  rank-k factorisation of an m x n matrix, instead of the O(m n^2) of a new
+//  vnl_svd.  If U is not kept, appending a row costs O(n k^2 + k^3),
+//  independent of the number of rows already seen.
+//
+// \verbatim
+//  Modifications
+// \endverbatim
+
+#include <iostream>
+#include <cmath>
+#include <cassert>
+#include <algorithm>
+
+#include <vnl/vnl_numeric_traits.h>
+#include <vnl/vnl_vector.h>
+#include <vnl/vnl_matrix.h>
+#include <vnl/vnl_diag_matrix.h>
+#include <vnl/vnl_math.h>
+
+#include <Eigen/Dense>
+
+//: Incrementally updated thin SVD M = U W V' of a matrix that grows by rows.
+//  Typical use is a least squares problem or a nullvector that is re-estimated
+//  every frame while rows are appended:
+// \code
+//   vnl_svd_incremental<double> svd(9);      // 0 x 9, U not needed
+//   for (...) { svd.add_row(a); x = svd.nullvector(); }
+// \endcode
+//  At most max_rank singular triplets are kept; when an update would exceed it,
+//  the smallest one is discarded, so W, V (and U) describe the best rank-max_rank
+//  approximation of the updated factorisation.  Rounding errors make U and V lose
+//  orthogonality slowly; they are re-orthogonalised every
+//  reorthogonalize_interval() updates.
+//
+//  U is only stored if keep_u is true.  Without it, add_row() still tracks
+//  U'b for the right hand side b, so solution() is available, but U(),
+//  update(), solve(), pinverse() and recompose() are not.
+
+template <class T>
+class vnl_svd_incremental
+{
+    using ColumnVector = Eigen::Matrix<T, Eigen::Dynamic, 1>;
+    using Matrix = Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic>;
+ public:
+    //: The singular values of a matrix of complex<T> are of type T, not complex<T>
+    using singval_t = typename vnl_numeric_traits<T>::abs_t;
+
+    //: Start from the empty 0 x n matrix.  max_rank = 0 means n.
+    explicit vnl_svd_incremental(unsigned n, unsigned max_rank = 0, bool keep_u = true);
+
+    //: Start from the SVD of M, with right hand side zero.
+    vnl_svd_incremental(vnl_matrix<T> const& M, unsigned max_rank = 0, bool keep_u = true);
+
+    //: Start from the SVD of M, with right hand side b (for solution()).
+    vnl_svd_incremental(vnl_matrix<T> const& M, vnl_vector<T> const& b,
+                        unsigned max_rank = 0, bool keep_u = true);
+
+    // Updating -----------------------------------------------------------------
+
+    //: Append the row a to M, and beta to the right hand side.
+    void add_row(vnl_vector<T> const& a, T beta = T(0));
+
+    //: Append the rows of A to M (and b to the right hand side, if given).
+    void add_rows(vnl_matrix<T> const& A);
+    void add_rows(vnl_matrix<T> const& A, vnl_vector<T> const& b);
+
+    //: M := M + x y'.  Requires keep_u.  The right hand side is unchanged.
+    void update(vnl_vector<T> const& x, vnl_vector<T> const& y);
+
+    //: Discard all but the largest r singular triplets, and keep at most r from now on.
+    void truncate(unsigned r);
+
+    //: Restore orthonormality of U and V (done automatically, see reorthogonalize_interval()).
+    void reorthogonalize();
+
+    //: Number of updates between automatic re-orthogonalisations; 0 disables them.
+    unsigned reorthogonalize_interval() const { return reortho_interval_; }
+    void set_reorthogonalize_interval(unsigned i) { reortho_interval_ = i; }
+
+    // Data Access---------------------------------------------------------------
+
+    //: Number of rows of M.
+    unsigned rows() const { return m_; }
+    //: Number of columns of M.
+    unsigned cols() const { return n_; }
+    //: Number of singular triplets kept, k; W is k x k, V is n x k and U is m x k.
+    unsigned size() const { return W_.size(); }
+    //: Upper bound on size().
+    unsigned max_rank() const { return max_rank_; }
+
+    //: Number of singular values larger than eps * max(m,n) * sigma_max().
+    unsigned rank() const;
+
+    //: Get at DiagMatrix (q.v.) of the kept singular values, sorted from largest to smallest
+    vnl_diag_matrix<singval_t> const& W() const { return W_; }
+    singval_t sigma_max() const { return size() ? W_[0] : singval_t(0); }
+    //: smallest singular value of M; zero if fewer than n are kept
+    singval_t sigma_min() const { return size() == n_ ? W_[n_-1] : singval_t(0); }
+    singval_t well_condition() const { return sigma_max() > 0 ? sigma_min()/sigma_max() : singval_t(0); }
+
+    //: Return the matrix U (m x k).  Requires keep_u.
+    vnl_matrix<T> const& U() const { assert(keep_u_); return U_; }
+    //: Return the matrix V (n x k).
+    vnl_matrix<T> const& V() const { return V_; }
+
+    //: Recompose U*W*V', using desired rank.  Requires keep_u.
+    vnl_matrix<T> recompose(unsigned int rank = ~0u) const;
+    //: pseudo-inverse of desired rank.  Requires keep_u.
+    vnl_matrix<T> pinverse(unsigned int rank = ~0u) const;
+    //: Solve M x = y in the least squares sense.  Requires keep_u.
+    vnl_vector<T> solve(vnl_vector<T> const& y) const;
+
+    //: Least squares solution of M x = b for the right hand side given to add_row().
+    vnl_vector<T> solution() const;
+
+    //: Return N such that M * N = 0, i.e. the n - rank() last right singular vectors.
+    vnl_matrix<T> nullspace() const { return nullspace(n_ - rank()); }
+    //: Return the last required_nullspace_dimension right singular vectors.
+    vnl_matrix<T> nullspace(int required_nullspace_dimension) const;
+    //: Return the last right singular vector.
+    //  Does not check to see whether or not the matrix actually was rank-deficient.
+    vnl_vector<T> nullvector() const;
+
+ private:
+    void init(vnl_matrix<T> const& M, vnl_vector<T> const& b);
+    //: Keep the first r triplets.
+    void shrink(unsigned r);
+    //: x = B p + r with r orthogonal to range(B), using two Gram-Schmidt passes.
+    static void split(vnl_matrix<T> const& B, ColumnVector const& x, ColumnVector& p, ColumnVector& r);
+    //: Count an update and re-orthogonalise if it is due.
+    void updated();
+    //: Solution of M x = y given c = U'y, using the triplets above the rank threshold.
+    vnl_vector<T> back_substitute(ColumnVector const& c, unsigned rnk) const;
+    //: Orthonormal basis of the complement of range(V), n x (n-k).
+    Matrix complement() const;
+
+    unsigned m_;               // rows of M
+    unsigned n_;               // cols of M
+    unsigned max_rank_;
+    bool keep_u_;
+    vnl_matrix<T> U_;          // m x k, empty unless keep_u_
+    vnl_diag_matrix<singval_t> W_; // k singular values, decreasing
+    vnl_matrix<T> V_;          // n x k
+    ColumnVector c_;           // U'b
+    vnl_vector<T> b_;          // right hand side, only stored with U_
+    unsigned reortho_interval_;
+    unsigned since_reortho_;
+};
+
+// implementation
+template <class T>
+vnl_svd_incremental<T>::vnl_svd_incremental(unsigned n, unsigned max_rank, bool keep_u):
+m_(0), n_(n),
+max_rank_(max_rank == 0 ? n : std::min(max_rank, n)),
+keep_u_(keep_u),
+U_(0, 0), W_(0), V_(n, 0), c_(0), b_(0),
+reortho_interval_(64), since_reortho_(0)
+{
+    assert(n > 0);
+}
+
+template <class T>
+vnl_svd_incremental<T>::vnl_svd_incremental(vnl_matrix<T> const& M, unsigned max_rank, bool keep_u):
+m_(M.rows()), n_(M.cols()),
+max_rank_(max_rank == 0 ? n_ : std::min(max_rank, n_)),
+keep_u_(keep_u),
+reortho_interval_(64), since_reortho_(0)
+{
+    init(M, vnl_vector<T>(m_, T(0)));
+}
+
+template <class T>
+vnl_svd_incremental<T>::vnl_svd_incremental(vnl_matrix<T> const& M, vnl_vector<T> const& b,
+                                            unsigned max_rank, bool keep_u):
+m_(M.rows()), n_(M.cols()),
+max_rank_(max_rank == 0 ? n_ : std::min(max_rank, n_)),
+keep_u_(keep_u),
+reortho_interval_(64), since_reortho_(0)
+{
+    assert(b.size() == m_);
+    init(M, b);
+}
+
+template <class T>
+void vnl_svd_incremental<T>::init(vnl_matrix<T> const& M, vnl_vector<T> const& b)
+{
+    assert(n_ > 0);
+    Eigen::JacobiSVD<Matrix> svd(M, Eigen::ComputeThinU | Eigen::ComputeThinV);
+    const unsigned k = std::min(unsigned(svd.singularValues().size()), max_rank_);
+    W_.set_diagonal(vnl_vector<singval_t>(svd.singularValues().head(k)));
+    V_ = svd.matrixV().leftCols(k);
+    c_ = svd.matrixU().leftCols(k).adjoint() * b;
+    if (keep_u_) {
+        U_ = svd.matrixU().leftCols(k);
+        b_ = b;
+    }
+}
+
+template <class T>
+void vnl_svd_incremental<T>::shrink(unsigned r)
+{
+    if (r >= size()) return;
+    W_.set_diagonal(vnl_vector<singval_t>(W_.diagonal().head(r)));
+    V_ = V_.leftCols(r).eval();
+    c_.conservativeResize(r);
+    if (keep_u_)
+        U_ = U_.leftCols(r).eval();
+}
+
+template <class T>
+void vnl_svd_incremental<T>::truncate(unsigned r)
+{
+    max_rank_ = std::min(max_rank_, r);
+    shrink(max_rank_);
+}
+
+//: A single pass leaves r with a component of size eps*|x|/|r| along range(B); when
+//  x is almost in range(B), q = r/|r| would then be far from orthogonal to B.
+template <class T>
+void vnl_svd_incremental<T>::split(vnl_matrix<T> const& B, ColumnVector const& x, ColumnVector& p, ColumnVector& r)
+{
+    p = B.adjoint() * x;
+    r = x - B * p;
+    ColumnVector d = B.adjoint() * r;
+    r -= B * d;
+    p += d;
+}
+
+template <class T>
+void vnl_svd_incremental<T>::updated()
+{
+    if (reortho_interval_ && ++since_reortho_ >= reortho_interval_)
+        reorthogonalize();
+}
+
+//: With V = Qv Rv and U = Qu Ru, M = Qu (Ru W Rv') Qv'; the SVD of the k x k middle factor
+//  gives the new W, and rotates Qu and Qv into the new U and V.
+template <class T>
+void vnl_svd_incremental<T>::reorthogonalize()
+{
+    since_reortho_ = 0;
+    const unsigned k = size();
+    if (k == 0) return;
+
+    Eigen::HouseholderQR<Matrix> qrv(V_);
+    Matrix Qv = qrv.householderQ() * Matrix::Identity(n_, k);
+    Matrix Rv = qrv.matrixQR().topRows(k).template triangularView<Eigen::Upper>();
+    Matrix B = W_.diagonal().template cast<T>().asDiagonal() * Rv.adjoint();
+
+    Matrix Qu;
+    if (keep_u_) {
+        Eigen::HouseholderQR<Matrix> qru(U_);
+        Qu = qru.householderQ() * Matrix::Identity(m_, k);
+        B = Matrix(qru.matrixQR().topRows(k).template triangularView<Eigen::Upper>()) * B;
+    }
+
+    Eigen::JacobiSVD<Matrix> svd(B, Eigen::ComputeFullU | Eigen::ComputeFullV);
+    W_.set_diagonal(vnl_vector<singval_t>(svd.singularValues()));
+    V_ = Qv * svd.matrixV();
+    if (keep_u_) {
+        U_ = Qu * svd.matrixU();
+        c_ = U_.adjoint() * b_;
+    }
+    else {
+        // U is not stored: U := U Ub, so U'b := Ub' U'b
+        c_ = svd.matrixU().adjoint() * c_;
+    }
+}
+
+template <class T>
+void vnl_svd_incremental<T>::add_row(vnl_vector<T> const& a, T beta)
+{
+    assert(a.size() == n_);
+    const unsigned k = size();
+
+    // In terms of M' = V W U': append the column a* = conj(a) = V p + rho q.
+    ColumnVector ac = a.conjugate();
+    ColumnVector p, r;
+    split(V_, ac, p, r);
+    singval_t rho = r.norm();
+    const singval_t scale = std::max(sigma_max(), singval_t(ac.norm()));
+    const bool extend = k < n_ && rho > singval_t(vnl_math::eps) * singval_t(n_) * scale;
+
+    // K = [W p; 0 rho] and M'' = [V q] K [U 0;0 1]', so that [M; a] = [U 0;0 1] K' [V q]'
+    const unsigned kr = extend ? k + 1 : k;
+    Matrix K = Matrix::Zero(kr, k + 1);
+    K.topLeftCorner(k, k).diagonal() = W_.diagonal().template cast<T>();
+    K.topRightCorner(k, 1) = p;
+    if (extend) K(k, k) = rho;
+
+    Eigen::JacobiSVD<Matrix> svd(K, Eigen::ComputeThinU | Eigen::ComputeThinV);
+    const unsigned kk = svd.singularValues().size();
+
+    // V := [V q] Uk
+    if (extend) {
+        Matrix V(n_, k + 1);
+        V.leftCols(k) = V_;
+        V.col(k) = r / rho;
+        V_ = V * svd.matrixU();
+    }
+    else
+        V_ = (V_ * svd.matrixU()).eval();
+
+    // U := [U 0;0 1] Vk, U'b := Vk' [U'b; beta]
+    Matrix const& Vk = svd.matrixV();
+    ColumnVector cb(k + 1);
+    cb << c_, beta;
+    c_ = Vk.adjoint() * cb;
+    if (keep_u_) {
+        Matrix U(m_ + 1, kk);
+        U.topRows(m_) = U_ * Vk.topRows(k);
+        U.row(m_) = Vk.row(k);
+        U_ = U;
+        b_.conservativeResize(m_ + 1);
+        b_[m_] = beta;
+    }
+    ++m_;
+
+    W_.set_diagonal(vnl_vector<singval_t>(svd.singularValues()));
+    shrink(max_rank_);
+    updated();
+}
+
+template <class T>
+void vnl_svd_incremental<T>::add_rows(vnl_matrix<T> const& A)
+{
+    for (unsigned i = 0; i < A.rows(); ++i)
+        add_row(A.get_row(i));
+}
+
+template <class T>
+void vnl_svd_incremental<T>::add_rows(vnl_matrix<T> const& A, vnl_vector<T> const& b)
+{
+    assert(b.size() == A.rows());
+    for (unsigned i = 0; i < A.rows(); ++i)
+        add_row(A.get_row(i), b[i]);
+}
+
+//: M + x y' = [U P] K [V Q]' with K = [W 0;0 0] + [U'x; ||rx||] [V'y; ||ry||]',
+//  where rx = x - U U'x = ||rx|| P and ry = y - V V'y = ||ry|| Q.
+template <class T>
+void vnl_svd_incremental<T>::update(vnl_vector<T> const& x, vnl_vector<T> const& y)
+{
+    assert(keep_u_);
+    assert(x.size() == m_ && y.size() == n_);
+    const unsigned k = size();
+
+    ColumnVector px, rx, py, ry;
+    split(U_, x, px, rx);
+    split(V_, y, py, ry);
+    singval_t ra = rx.norm(), rb = ry.norm();
+    const singval_t tol = singval_t(vnl_math::eps) * singval_t(std::max(m_, n_))
+                        * std::max(sigma_max(), singval_t(x.norm() * y.norm()));
+    const bool extend_u = k < m_ && ra * singval_t(y.norm()) > tol;
+    const bool extend_v = k < n_ && rb * singval_t(x.norm()) > tol;
+    if (!extend_u) ra = 0;
+    if (!extend_v) rb = 0;
+
+    ColumnVector a(k + 1), bb(k + 1);
+    a << px, T(ra);
+    bb << py, T(rb);
+    Matrix K = Matrix::Zero(k + 1, k + 1);
+    K.topLeftCorner(k, k).diagonal() = W_.diagonal().template cast<T>();
+    K += a * bb.adjoint();
+
+    const unsigned ku = extend_u ? k + 1 : k;
+    const unsigned kv = extend_v ? k + 1 : k;
+    Eigen::JacobiSVD<Matrix> svd(K.topLeftCorner(ku, kv), Eigen::ComputeThinU | Eigen::ComputeThinV);
+
+    Matrix U(m_, ku);
+    U.leftCols(k) = U_;
+    if (extend_u) U.col(k) = rx / ra;
+    U_ = U * svd.matrixU();
+
+    Matrix V(n_, kv);
+    V.leftCols(k) = V_;
+    if (extend_v) V.col(k) = ry / rb;
+    V_ = V * svd.matrixV();
+
+    W_.set_diagonal(vnl_vector<singval_t>(svd.singularValues()));
+    c_ = U_.adjoint() * b_;
+    shrink(max_rank_);
+    updated();
+}
+
+template <class T>
+unsigned vnl_svd_incremental<T>::rank() const
+{
+    const singval_t thresh = singval_t(vnl_math::eps) * singval_t(std::max(m_, n_)) * sigma_max();
+    unsigned r = 0;
+    while (r < size() && W_[r] > thresh) ++r;
+    return r;
+}
+
+template <class T>
+vnl_vector<T> vnl_svd_incremental<T>::back_substitute(ColumnVector const& c, unsigned rnk) const
+{
+    rnk = std::min(rnk, rank());
+    ColumnVector y = c.head(rnk);
+    for (unsigned i = 0; i < rnk; ++i)
+        y[i] /= W_[i];
+    return vnl_vector<T>(V_.leftCols(rnk) * y);
+}
+
+template <class T>
+vnl_vector<T> vnl_svd_incremental<T>::solution() const
+{
+    return back_substitute(c_, ~0u);
+}
+
+template <class T>
+vnl_vector<T> vnl_svd_incremental<T>::solve(vnl_vector<T> const& y) const
+{
+    assert(keep_u_);
+    assert(y.size() == m_);
+    return back_substitute(U_.adjoint() * y, ~0u);
+}
+
+template <class T>
+vnl_matrix<T> vnl_svd_incremental<T>::recompose(unsigned int rnk) const
+{
+    assert(keep_u_);
+    rnk = std::min(rnk, size());
+    vnl_matrix<T> UW(U_.leftCols(rnk));
+    vnl_diag_matrix<singval_t>(vnl_vector<singval_t>(W_.diagonal().head(rnk))).scale_columns(UW);
+    return UW * V_.leftCols(rnk).adjoint();
+}
+
+template <class T>
+vnl_matrix<T> vnl_svd_incremental<T>::pinverse(unsigned int rnk) const
+{
+    assert(keep_u_);
+    rnk = std::min(rnk, rank());
+    vnl_vector<singval_t> winv(rnk);
+    for (unsigned i = 0; i < rnk; ++i)
+        winv[i] = singval_t(1) / W_[i];
+    vnl_matrix<T> VW(V_.leftCols(rnk));
+    vnl_diag_matrix<singval_t>(winv).scale_columns(VW);
+    return VW * U_.leftCols(rnk).adjoint();
+}
+
+//: The last n - k columns of the full Q of V = Q R.
+template <class T>
+typename vnl_svd_incremental<T>::Matrix vnl_svd_incremental<T>::complement() const
+{
+    const unsigned k = size();
+    if (k == n_) return Matrix(n_, 0);
+    if (k == 0) return Matrix::Identity(n_, n_);
+    Eigen::HouseholderQR<Matrix> qr(V_);
+    Matrix E = Matrix::Zero(n_, n_ - k);
+    E.bottomRows(n_ - k).setIdentity();
+    return qr.householderQ() * E;
+}
+
+template <class T>
+vnl_matrix<T> vnl_svd_incremental<T>::nullspace(int required_nullspace_dimension) const
+{
+    const int d = required_nullspace_dimension;
+    assert(d >= 0 && d <= int(n_));
+    const int k = size();
+    const int from_v = std::max(0, d - (int(n_) - k)); // columns of V with small singular values
+    Matrix N(n_, d);
+    N.leftCols(from_v) = V_.rightCols(from_v);
+    N.rightCols(d - from_v) = complement().rightCols(d - from_v);
+    return N;
+}
+
+template <class T>
+vnl_vector<T> vnl_svd_incremental<T>::nullvector() const
+{
+    if (size() == n_)
+        return V_.get_column(n_ - 1);
+    return vnl_vector<T>(complement().col(n_ - size() - 1));
+}
+
+template <class T>
+std::ostream& operator<<(std::ostream& s, vnl_svd_incremental<T> const& svd)
+{
+    s << "vnl_svd_incremental<T>: " << svd.rows() << 'x' << svd.cols() << '\n'
+      << "W = " << svd.W() << '\n'
+      << "V = [\n" << svd.V() << "]\n"
+      << "rank = " << svd.rank() << std::endl;
+    return s;
+}
+
+#endif // vnl_svd_incremental_h_
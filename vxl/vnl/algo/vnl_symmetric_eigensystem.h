@@ -0,0 +1,79 @@
+// This is core/vnl/algo/vnl_symmetric_eigensystem.h
+#ifndef vnl_symmetric_eigensystem_h_
+#define vnl_symmetric_eigensystem_h_
+//:
+// \file
+// \brief Eigensystem of a small real symmetric matrix of fixed size
+//
+//  Solves A = V D V' for a symmetric n x n A held in a vnl_matrix_fixed.
+//  The eigenvalues D are in increasing order and the eigenvectors are the
+//  columns of V, as in vxl's vnl_symmetric_eigensystem, so the column of the
+//  smallest eigenvalue, V.get_column(0), is the least squares normal of a
+//  point covariance.  The solve works on fixed-size storage and allocates
+//  nothing, so it can be called per point from inner loops and threads.
+//  3x3 matrices are solved in closed form, from the roots of the
+//  characteristic cubic, which is several times faster than the iteration.
+//
+// \verbatim
+//  Modifications
+// \endverbatim
+
+#include <vnl/vnl_matrix_fixed.h>
+#include <vnl/vnl_vector_fixed.h>
+
+#include <Eigen/Dense>
+
+//: Eigenvalues D (increasing) and eigenvectors, the columns of V, of the symmetric matrix A.
+//  Only the lower triangle of A is read.  Returns false if the iteration did not converge.
+template <class T, unsigned int n>
+bool vnl_symmetric_eigensystem_compute(vnl_matrix_fixed<T, n, n> const& A,
+                                       vnl_matrix_fixed<T, n, n>& V,
+                                       vnl_vector_fixed<T, n>& D)
+{
+  using matrix_type = Eigen::Matrix<T, n, n, Eigen::RowMajor>;
+  Eigen::SelfAdjointEigenSolver<matrix_type> solver(static_cast<matrix_type const&>(A));
+  if (solver.info() != Eigen::Success)
+    return false;
+  for (unsigned int r = 0; r < n; ++r) {
+    D[r] = solver.eigenvalues()[r];
+    for (unsigned int c = 0; c < n; ++c)
+      V[r][c] = solver.eigenvectors()(r, c);
+  }
+  return true;
+}
+
+//: vnl_symmetric_eigensystem_compute() for 3x3 matrices, in closed form.
+template <class T>
+bool vnl_symmetric_eigensystem_compute(vnl_matrix_fixed<T, 3, 3> const& A,
+                                       vnl_matrix_fixed<T, 3, 3>& V,
+                                       vnl_vector_fixed<T, 3>& D)
+{
+  using matrix_type = Eigen::Matrix<T, 3, 3, Eigen::RowMajor>;
+  Eigen::SelfAdjointEigenSolver<matrix_type> solver;
+  solver.computeDirect(static_cast<matrix_type const&>(A));
+  if (solver.info() != Eigen::Success)
+    return false;
+  for (unsigned int r = 0; r < 3; ++r) {
+    D[r] = solver.eigenvalues()[r];
+    for (unsigned int c = 0; c < 3; ++c)
+      V[r][c] = solver.eigenvectors()(r, c);
+  }
+  return true;
+}
+
+//: Eigenvalues l1 <= l2 <= l3 of the symmetric 3x3 matrix [M11 M12 M13; M12 M22 M23; M13 M23 M33].
+//  Closed form, from the roots of the characteristic cubic.
+template <class T>
+void vnl_symmetric_eigensystem_compute_eigenvals(T M11, T M12, T M13, T M22, T M23, T M33,
+                                                 T& l1, T& l2, T& l3)
+{
+  Eigen::Matrix<T, 3, 3> A;
+  A << M11, M12, M13, M12, M22, M23, M13, M23, M33;
+  Eigen::SelfAdjointEigenSolver<Eigen::Matrix<T, 3, 3> > solver;
+  solver.computeDirect(A, Eigen::EigenvaluesOnly);
+  l1 = solver.eigenvalues()[0];
+  l2 = solver.eigenvalues()[1];
+  l3 = solver.eigenvalues()[2];
+}
+
+#endif // vnl_symmetric_eigensystem_h_
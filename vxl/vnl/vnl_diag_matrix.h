@@ -78,6 +78,20 @@ public:
     
     vnl_diag_matrix& invert_in_place();
     T determinant() const;
+
+    //: Replace A by D*A, i.e. scale row i of A by D(i,i).  mn flops, no temporaries.
+    //  The element type of A may differ from T, e.g. real singular values and a complex U.
+    template <class S>
+    vnl_matrix<S>& scale_rows(vnl_matrix<S>& A) const;
+
+    //: Replace A by A*D, i.e. scale column j of A by D(j,j).  mn flops, no temporaries.
+    template <class S>
+    vnl_matrix<S>& scale_columns(vnl_matrix<S>& A) const;
+
+    //: Replace v by D*v.  n flops, no temporaries.
+    template <class S>
+    vnl_vector<S>& scale_elements(vnl_vector<S>& v) const;
+
     vnl_vector<T> solve(vnl_vector<T> const& b) const;
     void solve(vnl_vector<T> const& b, vnl_vector<T>* out) const;
 
@@ -123,7 +137,7 @@ public:
     //: Sets the diagonal elements of this matrix to the specified list of values.
     inline vnl_diag_matrix& set_diagonal(vnl_vector<T> const& v) {
         this->resize(v.size());
-        std::copy(v.data(), v.data()+v.size(), this->data());
+        std::copy(v.data(), v.data()+v.size(), base_class::diagonal().data());
         return *this;
     }
     
@@ -253,6 +267,52 @@ inline T vnl_diag_matrix<T>::determinant() const
     return det;
 }
 
+//: Replace A by D*A, i.e. scale row i of A by D(i,i).
+template <class T>
+template <class S>
+inline vnl_matrix<S>& vnl_diag_matrix<T>::scale_rows(vnl_matrix<S>& A) const
+{
+    assert(A.rows() == this->size());
+    const unsigned nc = A.cols();
+    T const* d = this->data_block();
+    for (unsigned i = 0; i < A.rows(); ++i) {
+        S* row = A[i];
+        const T di = d[i];
+        for (unsigned j = 0; j < nc; ++j)
+            row[j] *= di;
+    }
+    return A;
+}
+
+//: Replace A by A*D, i.e. scale column j of A by D(j,j).
+template <class T>
+template <class S>
+inline vnl_matrix<S>& vnl_diag_matrix<T>::scale_columns(vnl_matrix<S>& A) const
+{
+    assert(A.cols() == this->size());
+    const unsigned nc = A.cols();
+    T const* d = this->data_block();
+    for (unsigned i = 0; i < A.rows(); ++i) {
+        S* row = A[i]; // vnl_matrix is row-major, so walk each row against d
+        for (unsigned j = 0; j < nc; ++j)
+            row[j] *= d[j];
+    }
+    return A;
+}
+
+//: Replace v by D*v.
+template <class T>
+template <class S>
+inline vnl_vector<S>& vnl_diag_matrix<T>::scale_elements(vnl_vector<S>& v) const
+{
+    assert(v.size() == this->size());
+    T const* d = this->data_block();
+    S* x = v.data_block();
+    for (unsigned i = 0; i < this->size(); ++i)
+        x[i] *= d[i];
+    return v;
+}
+
 //: Add two vnl_diag_matrices.  Just add the diag elements - n flops
 // \relatesalso vnl_diag_matrix
 template <class T>
@@ -359,11 +419,8 @@ template <class T>
 inline vnl_matrix<T> operator* (vnl_matrix<T> const& A, vnl_diag_matrix<T> const& D)
 {
     assert(A.cols() == D.size());
-    vnl_matrix<T> ret(A.rows(), A.cols());
-    for (unsigned i = 0; i < A.rows(); ++i)
-        for (unsigned j = 0; j < A.cols(); ++j)
-            ret(i,j) = A(i,j) * D(j,j);
-    return ret;
+    vnl_matrix<T> ret(A);
+    return D.scale_columns(ret);
 }
 
 //: Multiply a vnl_diag_matrix by a vnl_matrix.  Just scales the rows - mn flops
@@ -373,12 +430,8 @@ template <class T>
 inline vnl_matrix<T> operator* (vnl_diag_matrix<T> const& D, vnl_matrix<T> const& A)
 {
     assert(A.rows() == D.size());
-    vnl_matrix<T> ret(A.rows(), A.cols());
-    T const* d = D.data_block();
-    for (unsigned i = 0; i < A.rows(); ++i)
-        for (unsigned j = 0; j < A.cols(); ++j)
-            ret(i,j) = A(i,j) * d[i];
-    return ret;
+    vnl_matrix<T> ret(A);
+    return D.scale_rows(ret);
 }
 
 
@@ -389,8 +442,8 @@ template <class T>
 inline vnl_vector<T> operator* (vnl_diag_matrix<T> const& D, vnl_vector<T> const& A)
 {
     assert(A.size() == D.size());
-    
-    return element_product(D.diagonal(), A);
+    vnl_vector<T> ret(A);
+    return D.scale_elements(ret);
 }
 
 //: Multiply a vnl_vector by a vnl_diag_matrix.  n flops.
@@ -400,7 +453,8 @@ template <class T>
 inline vnl_vector<T> operator* (vnl_vector<T> const& A, vnl_diag_matrix<T> const& D)
 {
     assert(A.size() == D.size());
-    return element_product(D.diagonal(), A);
+    vnl_vector<T> ret(A);
+    return D.scale_elements(ret);
 }
 
 
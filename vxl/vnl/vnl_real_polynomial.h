@@ -0,0 +1,316 @@
+// This is core/vnl/vnl_real_polynomial.h
+#ifndef vnl_real_polynomial_h_
+#define vnl_real_polynomial_h_
+//:
+// \file
+// \brief Evaluation of real polynomials
+// \author Andrew W. Fitzgibbon, Oxford RRG
+// \date   23 Aug 96
+//
+// \verbatim
+//  Modifications
+//   25/11/2001 Peter Vanroose - added operator==(), derivative(), primitive(), print()
+//   header-only port, added trim() and the combined p/p' Horner evaluation
+// \endverbatim
+
+#include <iostream>
+#include <complex>
+#include <cassert>
+#include <vnl/vnl_vector.h>
+
+//:Evaluation of real polynomials at real and complex points.
+//    vnl_real_polynomial represents a univariate polynomial with real
+//    coefficients, stored as a vector of doubles.  This allows
+//    evaluation of the polynomial $p(x)$ at given values of $x$,
+//    or of its derivative $p'(x)$ or primitive function $\int p$.
+//
+//    The coefficients (coeffs_) are stored so that coeffs_[0] is the
+//    highest-order term, which is the convention of the root finders
+//    in vnl/algo/vnl_real_polynomial_roots.h.
+
+class vnl_real_polynomial
+{
+ public:
+  //: Initialize polynomial.
+  // The polynomial is $ a[0] x^d + a[1] x^{d-1} + \cdots + a[d] = 0 $.
+  vnl_real_polynomial(vnl_vector<double> const & a): coeffs_(a)
+  {
+    if (a.empty()) coeffs_ = vnl_vector<double>(1, 0.0);
+  }
+
+  //: Initialize polynomial from C vector.
+  // The parameter len is the number of coefficients, one greater than the degree.
+  vnl_real_polynomial(double const * a, unsigned len): coeffs_(a, len)
+  {
+    if (len==0) coeffs_ = vnl_vector<double>(1, 0.0);
+  }
+
+  //: Initialize polynomial from double.
+  // Useful when adding or multiplying a polynomial and a number.
+  vnl_real_polynomial(double a): coeffs_(1, a) {}
+
+  //: Initialize polynomial of a given degree.
+  // The coefficients are all zero.
+  explicit vnl_real_polynomial(int d): coeffs_(d+1, 0.0) { assert(d>=0); }
+
+  //: comparison operator
+  bool operator==(vnl_real_polynomial const& p) const { return p.coefficients() == coeffs_; }
+  bool operator!=(vnl_real_polynomial const& p) const { return !operator==(p); }
+
+  //: Evaluate polynomial at value x
+  double evaluate(double x) const;
+
+  //: Evaluate integral at x (assuming constant of integration is zero)
+  double evaluate_integral(double x) const;
+
+  //: Evaluate integral between x1 and x2
+  double evaluate_integral(double x1, double x2) const;
+
+  //: Evaluate derivative at value x
+  double devaluate(double x) const;
+
+  //: Evaluate polynomial and its derivative at x in a single Horner pass
+  void evaluate(double x, double& p, double& dp) const;
+
+  //: Evaluate polynomial at complex value x
+  std::complex<double> evaluate(std::complex<double> const& x) const;
+
+  //: Evaluate derivative at complex value x
+  std::complex<double> devaluate(std::complex<double> const& x) const;
+
+  //: Return derivative of this polynomial
+  vnl_real_polynomial derivative() const;
+
+  //: Return primitive function (inverse derivative) of this polynomial
+  // Since a primitive function is not unique, the one with constant = 0 is returned
+  vnl_real_polynomial primitive() const;
+
+  // Arithmetic ---------------------------------------------------------------
+
+  //: Add rhs to this polynomial
+  vnl_real_polynomial& operator+=(vnl_real_polynomial const& rhs);
+
+  //: Subtract rhs from this polynomial
+  vnl_real_polynomial& operator-=(vnl_real_polynomial const& rhs);
+
+  //: Multiply this polynomial by rhs
+  vnl_real_polynomial& operator*=(vnl_real_polynomial const& rhs);
+
+  //: Scale this polynomial by a constant
+  vnl_real_polynomial& operator*=(double s) { coeffs_ *= s; return *this; }
+
+  //: Negate the polynomial
+  vnl_real_polynomial operator-() const;
+
+  vnl_real_polynomial operator+(vnl_real_polynomial const& f) const { vnl_real_polynomial r(*this); return r += f; }
+  vnl_real_polynomial operator-(vnl_real_polynomial const& f) const { vnl_real_polynomial r(*this); return r -= f; }
+  vnl_real_polynomial operator*(vnl_real_polynomial const& f) const { vnl_real_polynomial r(*this); return r *= f; }
+
+  //: Returns RMS difference between this and poly2 on interval [x1,x2]
+  double rms_difference(vnl_real_polynomial const& poly2, double x1, double x2) const;
+
+  // Data Access---------------------------------------------------------------
+
+  //: Return the degree (highest power of x) of the polynomial.
+  int     degree() const { return int(coeffs_.size()) - 1; }
+
+  //: Access to the polynomial coefficients
+  double& operator [] (int i)       { return coeffs_[i]; }
+  //: Access to the polynomial coefficients
+  double  operator [] (int i) const { return coeffs_[i]; }
+
+  //: Return the vector of coefficients
+  vnl_vector<double> const& coefficients() const { return coeffs_; }
+  //: Return the vector of coefficients
+  vnl_vector<double>& coefficients()       { return coeffs_; }
+
+  void set_coefficients(vnl_vector<double> const& coeffs) { coeffs_ = coeffs; }
+
+  //: Remove leading zero coefficients, so that degree() is the true degree.
+  // The zero polynomial keeps a single zero coefficient.
+  vnl_real_polynomial& trim();
+
+  //: Print this polynomial to stream
+  void print(std::ostream& os) const;
+
+ protected:
+  //: The coefficients of the polynomial.
+  // coeffs_[0] is the coefficient of the x^d term,
+  // coeffs_[d] is the constant term, where d=coeffs_.size()-1
+  vnl_vector<double> coeffs_;
+};
+
+// copy from .cpp
+
+//: Evaluate polynomial at value x
+inline double vnl_real_polynomial::evaluate(double x) const
+{
+  const int d = degree();
+  double acc = coeffs_[0];
+  for (int i = 1; i <= d; ++i)
+    acc = acc * x + coeffs_[i];
+  return acc;
+}
+
+//: Evaluate polynomial and its derivative at x in a single Horner pass
+inline void vnl_real_polynomial::evaluate(double x, double& p, double& dp) const
+{
+  const int d = degree();
+  p = coeffs_[0];
+  dp = 0.0;
+  for (int i = 1; i <= d; ++i) {
+    dp = dp * x + p;
+    p = p * x + coeffs_[i];
+  }
+}
+
+//: Evaluate derivative at value x
+inline double vnl_real_polynomial::devaluate(double x) const
+{
+  double p, dp;
+  evaluate(x, p, dp);
+  return dp;
+}
+
+//: Evaluate polynomial at complex value x
+inline std::complex<double> vnl_real_polynomial::evaluate(std::complex<double> const& x) const
+{
+  const int d = degree();
+  std::complex<double> acc = coeffs_[0];
+  for (int i = 1; i <= d; ++i)
+    acc = acc * x + coeffs_[i];
+  return acc;
+}
+
+//: Evaluate derivative at complex value x
+inline std::complex<double> vnl_real_polynomial::devaluate(std::complex<double> const& x) const
+{
+  const int d = degree();
+  std::complex<double> p = coeffs_[0], dp = 0.0;
+  for (int i = 1; i <= d; ++i) {
+    dp = dp * x + p;
+    p = p * x + coeffs_[i];
+  }
+  return dp;
+}
+
+//: Evaluate integral at x (assuming constant of integration is zero)
+inline double vnl_real_polynomial::evaluate_integral(double x) const
+{
+  const int d = degree();
+  double acc = 0.0;
+  for (int i = 0; i <= d; ++i)
+    acc = (acc + coeffs_[i] / double(d - i + 1)) * x;
+  return acc;
+}
+
+//: Evaluate integral between x1 and x2
+inline double vnl_real_polynomial::evaluate_integral(double x1, double x2) const
+{
+  return evaluate_integral(x2) - evaluate_integral(x1);
+}
+
+//: Return derivative of this polynomial
+inline vnl_real_polynomial vnl_real_polynomial::derivative() const
+{
+  const int d = degree();
+  if (d == 0) return vnl_real_polynomial(0.0);
+  vnl_vector<double> cd(d);
+  for (int i = 0; i < d; ++i)
+    cd[i] = coeffs_[i] * double(d - i);
+  return vnl_real_polynomial(cd);
+}
+
+//: Return primitive function (inverse derivative) of this polynomial
+// Since a primitive function is not unique, the one with constant = 0 is returned
+inline vnl_real_polynomial vnl_real_polynomial::primitive() const
+{
+  const int d = degree();
+  vnl_vector<double> cd(d + 2);
+  for (int i = 0; i <= d; ++i)
+    cd[i] = coeffs_[i] / double(d - i + 1);
+  cd[d+1] = 0.0;
+  return vnl_real_polynomial(cd);
+}
+
+inline vnl_real_polynomial& vnl_real_polynomial::operator+=(vnl_real_polynomial const& rhs)
+{
+  const int d1 = degree(), d2 = rhs.degree();
+  if (d2 > d1) {
+    vnl_vector<double> c(d2 + 1, 0.0);
+    for (int i = 0; i <= d1; ++i) c[d2 - d1 + i] = coeffs_[i];
+    coeffs_ = c;
+  }
+  const int d = degree();
+  for (int i = 0; i <= d2; ++i)
+    coeffs_[d - d2 + i] += rhs.coeffs_[i];
+  return *this;
+}
+
+inline vnl_real_polynomial& vnl_real_polynomial::operator-=(vnl_real_polynomial const& rhs)
+{
+  return *this += -rhs;
+}
+
+inline vnl_real_polynomial& vnl_real_polynomial::operator*=(vnl_real_polynomial const& rhs)
+{
+  const int d1 = degree(), d2 = rhs.degree();
+  vnl_vector<double> c(d1 + d2 + 1, 0.0);
+  for (int i = 0; i <= d1; ++i)
+    for (int j = 0; j <= d2; ++j)
+      c[i + j] += coeffs_[i] * rhs.coeffs_[j];
+  coeffs_ = c;
+  return *this;
+}
+
+inline vnl_real_polynomial vnl_real_polynomial::operator-() const
+{
+  return vnl_real_polynomial(-coeffs_);
+}
+
+//: Returns RMS difference between this and poly2 on interval [x1,x2]
+inline double vnl_real_polynomial::rms_difference(vnl_real_polynomial const& poly2, double x1, double x2) const
+{
+  if (x1 == x2) return 0.0;
+  vnl_real_polynomial diff = *this - poly2;
+  vnl_real_polynomial sq = diff * diff;
+  double dx = x2 - x1;
+  return std::sqrt(std::abs(sq.evaluate_integral(x1, x2) / dx));
+}
+
+inline vnl_real_polynomial& vnl_real_polynomial::trim()
+{
+  const int d = degree();
+  int k = 0;
+  while (k < d && coeffs_[k] == 0.0) ++k;
+  if (k > 0)
+    coeffs_ = coeffs_.extract(d + 1 - k, k);
+  return *this;
+}
+
+//: Print this polynomial to stream
+inline void vnl_real_polynomial::print(std::ostream& os) const
+{
+  const int d = degree();
+  bool first_coeff = true;
+  for (int i = 0; i <= d; ++i) {
+    if (coeffs_[i] == 0.0) continue;
+    os << ' ';
+    if (coeffs_[i] > 0.0 && !first_coeff) os << '+';
+    if (i == d) os << coeffs_[i]; // the 0-degree coeff should always be output if not zero
+    else if (coeffs_[i] == -1.0) os << '-';
+    else if (coeffs_[i] != 1.0) os << coeffs_[i] << ' ';
+    if (i < d-1) os << "X^" << d-i;
+    else if (i == d-1) os << 'X';
+    first_coeff = false;
+  }
+  if (first_coeff) os << " 0";
+}
+
+inline std::ostream& operator<<(std::ostream& os, vnl_real_polynomial const& p)
+{
+  p.print(os);
+  return os;
+}
+
+#endif // vnl_real_polynomial_h_